@@ -0,0 +1,10 @@
+-- Add track_event column to detections table
+-- With on-host object tracking enabled, the detection pipeline stores one
+-- row per track lifecycle event ('start', 'update', 'end') instead of one
+-- row per box per analyzed frame. NULL for untracked detections.
+
+-- migrate:up
+ALTER TABLE detections ADD COLUMN track_event TEXT DEFAULT NULL;
+
+-- migrate:down
+-- SQLite does not support DROP COLUMN in older versions; migration is left intentionally empty.
@@ -0,0 +1,45 @@
+-- Per-recording detection summary
+--
+-- detection_count and max_confidence on recordings, and one row per label in
+-- recording_detection_labels, are kept up to date when detections are stored
+-- and when a recording completes. The recordings list and timeline filter on
+-- them instead of searching the detections table for every recording.
+--
+-- A recording's detections are those linked to it by recording_id plus those
+-- of the same stream inside its time range, as the old filters matched them.
+-- Existing recordings are counted here, one recording at a time (CROSS JOIN
+-- keeps SQLite from scanning all detections per recording).
+
+-- migrate:up
+ALTER TABLE recordings ADD COLUMN detection_count INTEGER NOT NULL DEFAULT 0;
+ALTER TABLE recordings ADD COLUMN max_confidence REAL NOT NULL DEFAULT 0;
+
+CREATE TABLE IF NOT EXISTS recording_detection_labels (
+    recording_id INTEGER NOT NULL,
+    label TEXT NOT NULL,
+    count INTEGER NOT NULL DEFAULT 0,
+    max_confidence REAL NOT NULL DEFAULT 0,
+    PRIMARY KEY (recording_id, label),
+    FOREIGN KEY (recording_id) REFERENCES recordings(id) ON DELETE CASCADE
+) WITHOUT ROWID;
+
+CREATE INDEX IF NOT EXISTS idx_recording_detection_labels_label ON recording_detection_labels(label);
+CREATE INDEX IF NOT EXISTS idx_recordings_detection_count ON recordings(detection_count);
+
+INSERT OR REPLACE INTO recording_detection_labels (recording_id, label, count, max_confidence)
+SELECT r.id, d.label, COUNT(*), MAX(d.confidence)
+FROM recordings r
+CROSS JOIN detections d
+  ON d.recording_id = r.id
+  OR (d.stream_name = r.stream_name AND d.timestamp >= r.start_time AND d.timestamp <= r.end_time)
+GROUP BY r.id, d.label;
+
+UPDATE recordings
+SET detection_count = (SELECT SUM(l.count) FROM recording_detection_labels l WHERE l.recording_id = recordings.id),
+    max_confidence = (SELECT MAX(l.max_confidence) FROM recording_detection_labels l WHERE l.recording_id = recordings.id)
+WHERE id IN (SELECT recording_id FROM recording_detection_labels);
+
+-- migrate:down
+DROP INDEX IF EXISTS idx_recordings_detection_count;
+DROP INDEX IF EXISTS idx_recording_detection_labels_label;
+DROP TABLE IF EXISTS recording_detection_labels;
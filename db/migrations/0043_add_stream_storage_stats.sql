@@ -0,0 +1,67 @@
+-- Per-stream storage counters
+--
+-- stream_storage_stats holds the number of completed recordings and their
+-- total size for each stream. Triggers on recordings keep it exact on every
+-- insert, update and delete, so storage usage and quota checks read one row
+-- per stream instead of summing the recordings table. The storage manager
+-- reconciles it against recordings during deep maintenance.
+--
+-- recording_count counts complete recordings with an end time, total_bytes
+-- sums all complete recordings, matching the queries they replace.
+
+-- migrate:up
+CREATE TABLE IF NOT EXISTS stream_storage_stats (
+    stream_name TEXT PRIMARY KEY,
+    recording_count INTEGER NOT NULL DEFAULT 0,
+    total_bytes INTEGER NOT NULL DEFAULT 0
+) WITHOUT ROWID;
+
+INSERT OR REPLACE INTO stream_storage_stats (stream_name, recording_count, total_bytes)
+SELECT stream_name, SUM(end_time IS NOT NULL), COALESCE(SUM(size_bytes), 0)
+FROM recordings
+WHERE is_complete = 1
+GROUP BY stream_name;
+
+CREATE TRIGGER IF NOT EXISTS trg_recordings_storage_stats_insert
+AFTER INSERT ON recordings
+WHEN NEW.is_complete = 1
+BEGIN
+    INSERT INTO stream_storage_stats (stream_name, recording_count, total_bytes)
+    VALUES (NEW.stream_name, NEW.end_time IS NOT NULL, COALESCE(NEW.size_bytes, 0))
+    ON CONFLICT(stream_name) DO UPDATE SET
+        recording_count = recording_count + excluded.recording_count,
+        total_bytes = total_bytes + excluded.total_bytes;
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_recordings_storage_stats_update
+AFTER UPDATE OF stream_name, is_complete, end_time, size_bytes ON recordings
+WHEN OLD.is_complete = 1 OR NEW.is_complete = 1
+BEGIN
+    UPDATE stream_storage_stats SET
+        recording_count = recording_count - (OLD.is_complete = 1 AND OLD.end_time IS NOT NULL),
+        total_bytes = total_bytes - (CASE WHEN OLD.is_complete = 1 THEN COALESCE(OLD.size_bytes, 0) ELSE 0 END)
+    WHERE stream_name = OLD.stream_name;
+    INSERT INTO stream_storage_stats (stream_name, recording_count, total_bytes)
+    VALUES (NEW.stream_name,
+            NEW.is_complete = 1 AND NEW.end_time IS NOT NULL,
+            CASE WHEN NEW.is_complete = 1 THEN COALESCE(NEW.size_bytes, 0) ELSE 0 END)
+    ON CONFLICT(stream_name) DO UPDATE SET
+        recording_count = recording_count + excluded.recording_count,
+        total_bytes = total_bytes + excluded.total_bytes;
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_recordings_storage_stats_delete
+AFTER DELETE ON recordings
+WHEN OLD.is_complete = 1
+BEGIN
+    UPDATE stream_storage_stats SET
+        recording_count = recording_count - (OLD.end_time IS NOT NULL),
+        total_bytes = total_bytes - COALESCE(OLD.size_bytes, 0)
+    WHERE stream_name = OLD.stream_name;
+END;
+
+-- migrate:down
+DROP TRIGGER IF EXISTS trg_recordings_storage_stats_delete;
+DROP TRIGGER IF EXISTS trg_recordings_storage_stats_update;
+DROP TRIGGER IF EXISTS trg_recordings_storage_stats_insert;
+DROP TABLE IF EXISTS stream_storage_stats;
@@ -0,0 +1,33 @@
+-- Time-bucketed detection rollups
+--
+-- detection_rollups holds, per stream and label, the number of detections
+-- and their highest confidence for each minute (bucket_seconds = 60) and
+-- each hour (bucket_seconds = 3600). Both are updated when detections are
+-- stored and trimmed with them by retention, so timeline density and label
+-- histograms over long ranges read a few rows per bucket instead of every
+-- detection. bucket_start is the Unix time of the start of the bucket.
+
+-- migrate:up
+CREATE TABLE IF NOT EXISTS detection_rollups (
+    stream_name TEXT NOT NULL,
+    bucket_seconds INTEGER NOT NULL,
+    bucket_start INTEGER NOT NULL,
+    label TEXT NOT NULL,
+    count INTEGER NOT NULL DEFAULT 0,
+    max_confidence REAL NOT NULL DEFAULT 0,
+    PRIMARY KEY (stream_name, bucket_seconds, bucket_start, label)
+) WITHOUT ROWID;
+
+INSERT OR REPLACE INTO detection_rollups (stream_name, bucket_seconds, bucket_start, label, count, max_confidence)
+SELECT stream_name, 60, timestamp - timestamp % 60, label, COUNT(*), MAX(confidence)
+FROM detections
+GROUP BY stream_name, timestamp - timestamp % 60, label;
+
+INSERT OR REPLACE INTO detection_rollups (stream_name, bucket_seconds, bucket_start, label, count, max_confidence)
+SELECT stream_name, 3600, bucket_start - bucket_start % 3600, label, SUM(count), MAX(max_confidence)
+FROM detection_rollups
+WHERE bucket_seconds = 60
+GROUP BY stream_name, bucket_start - bucket_start % 3600, label;
+
+-- migrate:down
+DROP TABLE IF EXISTS detection_rollups;
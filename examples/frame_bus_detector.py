@@ -0,0 +1,114 @@
+#!/usr/bin/env python3
+"""Reference detector for the lightNVR frame bus.
+
+Attaches to one stream's shared-memory frame ring, runs detect() on every
+new frame and posts the detections back to lightNVR. See
+include/video/frame_bus.h for the protocol and the ring layout.
+
+Enable the bus in lightnvr.ini:
+
+    [frame_bus]
+    enabled = true
+
+set the stream's detection model to "frame-bus", then run:
+
+    python3 frame_bus_detector.py --stream front_door
+
+Replace detect() with a call into your model. It receives the frame as
+packed RGB24 bytes and must return boxes with coordinates normalized to
+[0, 1]. Requires Python 3.9+ and no third-party packages.
+"""
+
+import argparse
+import json
+import mmap
+import os
+import select
+import socket
+import struct
+import sys
+
+HEADER_FMT = "=IIIIII Q 64s"     # frame_bus_header_t
+SLOT_FMT = "=II QQ IIII 24x"     # frame_bus_slot_t
+HEADER_SIZE = 4096               # FRAME_BUS_HEADER_SIZE
+MAGIC = 0x4246564C
+VERSION = 1
+FORMAT_RGB24 = 1
+MAX_MESSAGE = 65536
+
+
+def detect(rgb, width, height):
+    """Run the model on one frame. Returns a list of detections."""
+    # Example of the expected shape:
+    # return [{"label": "person", "confidence": 0.87,
+    #          "x_min": 0.10, "y_min": 0.20, "x_max": 0.30, "y_max": 0.90}]
+    return []
+
+
+def attach(sock_path, stream):
+    sock = socket.socket(socket.AF_UNIX, socket.SOCK_SEQPACKET)
+    sock.connect(sock_path)
+    sock.send(f"ATTACH {stream}".encode())
+    msg, fds, _, _ = socket.recv_fds(sock, 256, 2)
+    reply = msg.decode(errors="replace")
+    if not reply.startswith("OK ") or len(fds) != 2:
+        for fd in fds:
+            os.close(fd)
+        raise RuntimeError(f"attach failed: {reply}")
+    memfd, event_fd = fds
+    return sock, memfd, event_fd
+
+
+def read_newest_frame(ring, slot_count, slot_stride):
+    """Copy the newest complete frame out of the ring, or return None."""
+    write_seq = struct.unpack_from("=Q", ring, 24)[0]
+    if write_seq == 0:
+        return None
+    offset = HEADER_SIZE + (write_seq % slot_count) * slot_stride
+    gen = struct.unpack_from("=I", ring, offset)[0]
+    if gen & 1:
+        return None  # Being rewritten right now; the next wakeup brings a newer frame
+    (_, fmt, seq, ts_us, width, height, stride, size) = struct.unpack_from(SLOT_FMT, ring, offset)
+    data_off = offset + struct.calcsize(SLOT_FMT)
+    pixels = bytes(ring[data_off:data_off + size])
+    if struct.unpack_from("=I", ring, offset)[0] != gen or fmt != FORMAT_RGB24:
+        return None  # Overwritten while copying
+    return seq, width, height, pixels
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--socket", default="/var/run/lightnvr/frame_bus.sock")
+    parser.add_argument("--stream", required=True)
+    args = parser.parse_args()
+
+    sock, memfd, event_fd = attach(args.socket, args.stream)
+    size = os.fstat(memfd).st_size
+    ring = mmap.mmap(memfd, size, prot=mmap.PROT_READ)
+    magic, version, slot_count, slot_stride, _, _, _, _ = struct.unpack_from(HEADER_FMT, ring, 0)
+    if magic != MAGIC or version != VERSION:
+        sys.exit("unsupported frame bus ring")
+    print(f"attached to {args.stream}: {slot_count} slots", file=sys.stderr)
+
+    poller = select.poll()
+    poller.register(event_fd, select.POLLIN)
+    poller.register(sock.fileno(), select.POLLIN)
+    while True:
+        for fd, _ in poller.poll():
+            if fd == sock.fileno():
+                msg = sock.recv(MAX_MESSAGE)
+                if not msg:
+                    sys.exit("lightnvr closed the connection")
+                print(msg.decode(errors="replace"), file=sys.stderr)
+                continue
+            os.read(event_fd, 8)  # Reset the counter; only the newest frame matters
+            frame = read_newest_frame(ring, slot_count, slot_stride)
+            if frame is None:
+                continue
+            seq, width, height, pixels = frame
+            body = json.dumps({"detections": detect(pixels, width, height)})
+            sock.send(f"RESULT {seq} {body}".encode())
+
+
+if __name__ == "__main__":
+    main()
@@ -137,6 +137,8 @@ typedef struct {
     uint64_t max_storage_size; // in bytes
     int retention_days;
     bool auto_delete_oldest;
+    int cleanup_workers;             // Threads that unlink recordings for retention cleanup
+    int cleanup_io_priority;         // I/O priority of those threads (cleanup_io_priority_t)
 
     // Thumbnail/grid view settings
     bool generate_thumbnails;        // Enable grid view with thumbnail previews on recordings page
@@ -150,10 +152,28 @@ typedef struct {
     
     // Models settings
     char models_path[MAX_PATH_LENGTH]; // Path to detection models directory
+    int sod_batch_max_size;            // Max frames per batched SOD CNN pass across streams (1 = no batching)
+    int sod_batch_max_latency_ms;      // Max time a frame waits for a batch to fill (ms)
+    int sod_threads;                   // Threads per SOD CNN convolution or RealNet scan (0 = all CPUs)
+    bool roi_cropping;                 // Run models on crops around zones / motion regions
+    int roi_max_regions;               // Max crops per frame before falling back to the full frame
+    int roi_padding;                   // Margin added around each region (% of its size)
+    int roi_max_coverage;              // Crops covering more of the frame than this (%) use the full frame
+    bool mmap_model_weights;           // Map model weights read-only from the file instead of copying them
+    int model_reload_interval;         // Seconds between checks for changed model files (0 = never)
     
     // API detection settings
     char api_detection_url[MAX_URL_LENGTH]; // URL for the detection API
     char api_detection_backend[32];        // Backend to use: onnx, tflite, opencv (default: onnx)
+    bool api_detection_async;              // Don't block detection threads on the HTTP round trip
+    int api_detection_max_inflight;        // Max outstanding API requests per stream
+
+    // Shared-memory frame bus for detectors on the same host ("frame-bus" model)
+    bool frame_bus_enabled;                // Listen for local detectors
+    char frame_bus_socket_path[MAX_PATH_LENGTH]; // Unix socket detectors attach to
+    int frame_bus_slots;                   // Frame slots per stream ring
+    int frame_bus_max_width;               // Published frames are downscaled to fit
+    int frame_bus_max_height;
 
     // Global detection defaults (used when per-stream settings are not specified)
     int default_detection_threshold;       // Default confidence threshold for detection (0-100)
@@ -161,11 +181,36 @@ typedef struct {
     int default_post_detection_buffer;     // Default seconds to keep after detection (0-300)
     char default_buffer_strategy[32];      // Default buffer strategy: auto, go2rtc, hls_segment, memory_packet, mmap_hybrid
 
+    // Object tracking (store track start/update/end events instead of every box)
+    bool tracking_enabled;                 // Track objects across frames and store only track events
+    int track_update_interval;             // Seconds between stored updates of an unchanged track
+    int track_max_misses;                  // Analyzed frames a track may go unmatched before it ends
+
+    // Adaptive detection rate (analyze quiet streams less often)
+    bool adaptive_detection_interval;      // Stretch detection_interval while a stream is quiet
+    int adaptive_quiet_period;             // Seconds without activity before the interval grows
+    int adaptive_max_factor;               // Upper bound of the stretch (x detection_interval)
+
     // Database settings
     char db_path[MAX_PATH_LENGTH];
     int db_backup_interval_minutes;        // Periodic backup cadence in minutes (0 = disabled)
     int db_backup_retention_count;         // Number of timestamped backups to retain (0 = latest .bak only)
     char db_post_backup_script[MAX_PATH_LENGTH]; // Optional executable path run after a verified backup
+    int db_backup_step_pages;              // Pages copied per backup step before yielding to writers
+    int db_backup_step_sleep_ms;           // Pause between backup steps
+    int db_backup_max_mb_per_sec;          // Backup read/write rate cap in MB/s (0 = only the step pause)
+    bool db_backup_compress;               // Gzip timestamped backups (the latest .bak stays uncompressed)
+    int db_checkpoint_interval_seconds;    // Scheduled WAL checkpoint / incremental vacuum cadence (0 = disabled)
+    int db_checkpoint_idle_writes;         // Rows written since the last run at or below which the database counts as idle
+    int db_checkpoint_max_deferrals;       // Busy runs skipped in a row before one runs anyway (0 = skip forever)
+    int db_wal_truncate_mb;                // WAL size above which the scheduled checkpoint truncates the file
+    int db_wal_autocheckpoint_pages;       // SQLite's own checkpoint threshold while the scheduler runs (0 = off)
+    int db_incremental_vacuum_pages;       // Free pages released per scheduled run (0 = disabled)
+    int db_read_connections;               // Read-only connections for queries (0 = share the writer connection)
+    bool db_write_queue;                   // Group-commit detections, events and recording updates off the caller's thread
+    int db_write_batch_interval_ms;        // Longest a queued write waits for its group commit
+    int db_write_batch_max_rows;           // Commit as soon as this many writes are queued
+    int db_write_queue_capacity;           // Queued writes before producers wait for room
     
     // Web server settings
     int web_thread_pool_size; // libuv UV_THREADPOOL_SIZE (default: 2x CPU cores, requires restart)
@@ -181,6 +226,7 @@ typedef struct {
     int auth_timeout_hours; // Session idle timeout in hours (default: 24)
     int auth_absolute_timeout_hours; // Absolute session lifetime in hours (default: 168)
     int trusted_device_days; // Remember-device lifetime in days (default: 30, 0 disables)
+    int auth_cache_ttl_seconds; // How long a verified credential, session or API key is reused (default: 30, 0 disables)
     char trusted_proxy_cidrs[WEB_TRUSTED_PROXY_CIDRS_MAX]; // Trusted reverse-proxy CIDRs for X-Forwarded-For handling
     bool demo_mode;         // Demo mode: allows unauthenticated viewer access while still allowing login
 
@@ -228,6 +274,7 @@ typedef struct {
     int go2rtc_rtsp_port;                 // RTSP listen port (default: 8554)
     bool go2rtc_force_native_hls;         // Force native HLS instead of go2rtc HLS (default: false)
     int go2rtc_proxy_max_inflight;        // Max concurrent proxy requests (default: 16)
+    int go2rtc_snapshot_max_age_ms;       // Reuse a cached snapshot younger than this (0 = always fetch)
 
     // go2rtc WebRTC settings for NAT traversal
     bool go2rtc_webrtc_enabled;           // Enable WebRTC (default: true)
@@ -7,6 +7,7 @@
 #include "database/db_recordings.h"
 #include "database/db_detections.h"
 #include "database/db_streams.h"
+#include "database/db_stream_cache.h"
 #include "database/db_schema.h"
 #include "database/db_motion_config.h"
 
@@ -0,0 +1,107 @@
+/**
+ * @file db_auth_cache.h
+ * @brief Short-lived cache of verified credentials, sessions and API keys
+ *
+ * Every authenticated request would otherwise run PBKDF2 (basic auth) or
+ * look the session or API key up in SQLite. After a successful check the
+ * resolved user is remembered for auth_cache_ttl_seconds under a keyed
+ * digest of the secret; the secret itself is never stored.
+ *
+ * db_auth.c drops the entries of a user whenever the user, its password,
+ * API key or sessions change, so a cached result never outlives the
+ * credential that produced it.
+ */
+
+#ifndef LIGHTNVR_DB_AUTH_CACHE_H
+#define LIGHTNVR_DB_AUTH_CACHE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "database/db_auth.h"
+
+/**
+ * Maximum number of cached entries; the entry closest to expiry is replaced
+ * when the cache is full
+ */
+#define AUTH_CACHE_MAX_ENTRIES 256
+
+/**
+ * Kind of credential an entry was verified from
+ */
+typedef enum {
+    AUTH_CACHE_BASIC = 0,   // Username and password
+    AUTH_CACHE_SESSION,     // Session token
+    AUTH_CACHE_API_KEY      // API key
+} auth_cache_kind_t;
+
+/**
+ * Cache counters
+ */
+typedef struct {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t invalidations;
+    int entries;
+} auth_cache_stats_t;
+
+/**
+ * Look up a verified credential
+ *
+ * @param kind Credential kind
+ * @param secret Password (with username as context), session token or API key
+ * @param context Request details the result depends on, e.g. the client IP
+ *                and the username or user agent; may be NULL
+ * @param user Filled with the cached user on a hit
+ * @return true on a hit, false if the credential must be verified again
+ */
+bool db_auth_cache_lookup(auth_cache_kind_t kind, const char *secret, const char *context, user_t *user);
+
+/**
+ * Get the invalidation generation
+ *
+ * Read this before verifying a credential against the database and pass it
+ * to db_auth_cache_store(), so a result verified before a concurrent
+ * invalidation is not cached after it.
+ *
+ * @return Counter bumped by every invalidation and clear
+ */
+uint64_t db_auth_cache_generation(void);
+
+/**
+ * Remember a successfully verified credential
+ *
+ * Does nothing when auth_cache_ttl_seconds is 0, or when an invalidation
+ * ran since the caller read the generation.
+ *
+ * @param kind Credential kind
+ * @param secret Secret that was verified
+ * @param context Context passed to db_auth_cache_lookup()
+ * @param user The authenticated user
+ * @param generation Value of db_auth_cache_generation() read before the
+ *                   credential was verified
+ */
+void db_auth_cache_store(auth_cache_kind_t kind, const char *secret, const char *context, const user_t *user,
+                         uint64_t generation);
+
+/**
+ * Drop every entry of a user
+ */
+void db_auth_cache_invalidate_user(int64_t user_id);
+
+/**
+ * Drop the entries verified from one secret, e.g. a session token on logout
+ */
+void db_auth_cache_invalidate_secret(auth_cache_kind_t kind, const char *secret);
+
+/**
+ * Drop all entries
+ */
+void db_auth_cache_clear(void);
+
+/**
+ * Get cache counters
+ */
+void db_auth_cache_get_stats(auth_cache_stats_t *stats);
+
+#endif /* LIGHTNVR_DB_AUTH_CACHE_H */
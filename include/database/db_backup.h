@@ -10,6 +10,29 @@
  */
 int backup_database(const char *source_path, const char *dest_path);
 
+/**
+ * Back up the open database while it stays in use
+ *
+ * Copies db_backup_step_pages pages per step through the writer connection,
+ * holding the writer lock only for the step and pausing between steps
+ * (db_backup_step_sleep_ms, db_backup_max_mb_per_sec). Writes made between
+ * steps are carried into the copy, so the backup does not restart. The
+ * copy is verified with PRAGMA quick_check before it is published.
+ *
+ * @param dest_path Path to the destination backup file
+ * @return 0 on success, non-zero on failure
+ */
+int backup_live_database(const char *dest_path);
+
+/**
+ * Gzip a finished backup file, honoring db_backup_max_mb_per_sec
+ *
+ * @param source_path Path to the uncompressed backup
+ * @param dest_path Path to the compressed file to create
+ * @return 0 on success, non-zero on failure or when built without zlib
+ */
+int compress_backup_file(const char *source_path, const char *dest_path);
+
 /**
  * Restore database from backup
  * 
@@ -3,6 +3,7 @@
 
 #include <sqlite3.h>
 #include <pthread.h>
+#include <stdint.h>
 
 // Include other database module headers
 #include "database/db_transaction.h"
@@ -36,6 +37,112 @@ sqlite3 *get_db_handle(void);
  */
 pthread_mutex_t *get_db_mutex(void);
 
+/**
+ * Lock the writer connection
+ *
+ * Same as locking get_db_mutex(), but the time spent waiting is counted in
+ * the lock statistics.
+ */
+void db_writer_lock(void);
+
+/**
+ * Unlock the writer connection
+ */
+void db_writer_unlock(void);
+
+/**
+ * Borrow a read-only connection for queries
+ *
+ * The database is in WAL mode, so readers see the last committed data and
+ * neither block nor wait for the writer. With [database] read_connections
+ * = 0, when WAL mode is not available, while the pool is closing, or when
+ * every read connection stays busy for a couple of seconds, this locks the
+ * writer connection and returns it instead.
+ *
+ * @return Connection to be returned with db_reader_release(), or NULL if
+ *         the database is not initialized or was closed meanwhile
+ */
+sqlite3 *db_reader_acquire(void);
+
+/**
+ * Return a connection borrowed with db_reader_acquire()
+ */
+void db_reader_release(sqlite3 *conn);
+
+/**
+ * Lock wait counters
+ */
+typedef struct {
+    uint64_t acquires;
+    uint64_t waits;             // Acquisitions that found the lock taken
+    uint64_t wait_us;           // Total time spent waiting
+} db_lock_stats_t;
+
+/**
+ * Connection pool counters
+ */
+typedef struct {
+    db_lock_stats_t writer;
+    db_lock_stats_t reader;
+    int read_connections;       // Open read-only connections
+    int read_connections_busy;
+} db_pool_stats_t;
+
+/**
+ * Get the connection pool counters
+ */
+void db_pool_get_stats(db_pool_stats_t *stats);
+
+/**
+ * Prepared statement cache counters
+ */
+typedef struct {
+    uint64_t prepares;          // Statements compiled by db_prepare_cached()
+    uint64_t reuses;            // Prepares avoided by handing out a cached statement
+    uint64_t invalidations;     // Cache flushes (schema migrations, restore, shutdown)
+    int cached;                 // Statements currently held by the cache
+} db_stmt_cache_stats_t;
+
+/**
+ * Get a prepared statement for an SQL text from the statement cache
+ *
+ * Returns a reset statement with cleared bindings that the caller owns
+ * until db_release_cached(). Each cached statement is handed to one caller
+ * at a time; concurrent callers of the same SQL get another copy. Use it
+ * for fixed SQL texts on hot paths, not for SQL built at run time from
+ * user input.
+ *
+ * @param sql SQL text, also the cache key
+ * @return Statement, or NULL if it could not be prepared
+ */
+sqlite3_stmt *db_prepare_cached(const char *sql);
+
+/**
+ * Like db_prepare_cached(), for a connection from db_reader_acquire()
+ */
+sqlite3_stmt *db_prepare_cached_on(sqlite3 *conn, const char *sql);
+
+/**
+ * Give a statement from db_prepare_cached() back to the cache
+ *
+ * Resets it and clears its bindings. Must be called instead of
+ * sqlite3_finalize().
+ */
+void db_release_cached(sqlite3_stmt *stmt);
+
+/**
+ * Finalize all cached statements
+ *
+ * Called after schema migrations and before the database is closed.
+ * Statements handed out at that moment are finalized on release.
+ */
+void db_stmt_cache_invalidate(void);
+
+/**
+ * Get the statement cache counters
+ */
+void db_stmt_cache_get_stats(db_stmt_cache_stats_t *stats);
+
 /**
  * Checkpoint the database WAL file
  * This ensures all changes are written to the main database file
@@ -44,6 +151,41 @@ pthread_mutex_t *get_db_mutex(void);
  */
 int checkpoint_database(void);
 
+/**
+ * Run scheduled WAL checkpoints and incremental vacuum when they are due
+ *
+ * Every [database] checkpoint_interval_seconds, if no more than
+ * checkpoint_idle_writes rows were written since the previous run, copies
+ * the WAL back into the database with a PASSIVE checkpoint, shrinks the
+ * WAL once it exceeds wal_truncate_mb, and releases up to
+ * incremental_vacuum_pages free pages. Busy periods are skipped, but no
+ * more than checkpoint_max_deferrals times in a row; SQLite's own
+ * checkpoint at wal_autocheckpoint_pages bounds the WAL meanwhile.
+ *
+ * @return 0 on success or no-op, non-zero on failure
+ */
+int maybe_run_database_maintenance(void);
+
+/**
+ * WAL checkpoint and vacuum counters
+ */
+typedef struct {
+    uint64_t passive;           // PASSIVE checkpoints
+    uint64_t truncate;          // TRUNCATE checkpoints
+    uint64_t full;              // FULL checkpoints (checkpoint_database)
+    uint64_t busy;              // Checkpoints cut short by active readers or writers
+    uint64_t skipped;           // Scheduled runs skipped because of write load
+    uint64_t duration_us;       // Total time spent checkpointing
+    uint64_t last_duration_us;
+    int64_t wal_bytes;          // WAL file size after the last checkpoint or run
+    uint64_t vacuum_pages;      // Pages released by incremental vacuum
+} db_maintenance_stats_t;
+
+/**
+ * Get the checkpoint and vacuum counters
+ */
+void db_maintenance_get_stats(db_maintenance_stats_t *stats);
+
 /**
  * Run periodic database backup work when the configured interval is due.
  *
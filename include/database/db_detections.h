@@ -18,6 +18,17 @@
 int store_detections_in_db(const char *stream_name, const detection_result_t *result,
                            time_t timestamp, uint64_t recording_id);
 
+/**
+ * Queue detection results for the next group commit of the write queue
+ *
+ * Same as store_detections_in_db() but returns without waiting for the
+ * database. Used by the detection threads.
+ *
+ * @return 0 if the detections were queued, non-zero on failure
+ */
+int queue_detections_for_db(const char *stream_name, const detection_result_t *result,
+                            time_t timestamp, uint64_t recording_id);
+
 /**
  * Get detection results from the database with time range filtering
  * 
@@ -89,8 +100,24 @@ int delete_old_detections(uint64_t max_age);
 typedef struct {
     char label[MAX_LABEL_LENGTH];  // Detection label (e.g., "person", "car")
     int count;                      // Number of times this label was detected
+    float max_confidence;           // Highest confidence of those detections
 } detection_label_summary_t;
 
+/**
+ * Bucket sizes of the detection rollups, in seconds
+ */
+#define DETECTION_ROLLUP_MINUTE 60
+#define DETECTION_ROLLUP_HOUR 3600
+
+/**
+ * Detections of a stream in one rollup bucket
+ */
+typedef struct {
+    time_t bucket_start;            // Start of the bucket
+    int count;                      // Detections in the bucket
+    float max_confidence;           // Highest confidence in the bucket
+} detection_bucket_t;
+
 /**
  * Get a summary of detection labels for a stream within a time range
  * Returns unique labels with their counts, sorted by count descending
@@ -105,6 +132,40 @@ typedef struct {
 int get_detection_labels_summary(const char *stream_name, time_t start_time, time_t end_time,
                                  detection_label_summary_t *labels, int max_labels);
 
+/**
+ * Get the number of detections of a stream per minute or per hour
+ *
+ * Read from the rollups maintained when detections are stored. Buckets
+ * overlapping the range are returned in time order; buckets without
+ * detections are left out.
+ *
+ * @param stream_name Stream name
+ * @param start_time Start time (inclusive)
+ * @param end_time End time (inclusive)
+ * @param bucket_seconds DETECTION_ROLLUP_MINUTE or DETECTION_ROLLUP_HOUR
+ * @param label Only count this label (NULL for all labels)
+ * @param buckets Array to store the buckets
+ * @param max_buckets Maximum number of buckets to return
+ * @return Number of buckets found, or -1 on error
+ */
+int get_detection_density(const char *stream_name, time_t start_time, time_t end_time,
+                          int bucket_seconds, const char *label,
+                          detection_bucket_t *buckets, int max_buckets);
+
+/**
+ * Get the detection labels of a recording from its maintained summary
+ * Returns labels with their counts, sorted by count descending. Covers
+ * detections linked to the recording and those of its stream inside its
+ * time range.
+ *
+ * @param recording_id Recording ID
+ * @param labels Array to store label summaries
+ * @param max_labels Maximum number of labels to return
+ * @return Number of labels found, or -1 on error
+ */
+int get_recording_detection_labels(uint64_t recording_id,
+                                   detection_label_summary_t *labels, int max_labels);
+
 /**
  * Get all unique detection labels across all detections.
  *
@@ -630,6 +630,128 @@ static const char migration_0040_up[] =
 static const char migration_0040_down[] =
     "SELECT 1;";
 
+static const char migration_0041_up[] =
+    "ALTER TABLE detections ADD COLUMN track_event TEXT DEFAULT NULL;";
+
+static const char migration_0041_down[] =
+    "SELECT 1;";
+
+static const char migration_0042_up[] =
+    "ALTER TABLE recordings ADD COLUMN detection_count INTEGER NOT NULL DEFAULT 0;\n"
+    "ALTER TABLE recordings ADD COLUMN max_confidence REAL NOT NULL DEFAULT 0;\n"
+    "\n"
+    "CREATE TABLE IF NOT EXISTS recording_detection_labels (\n"
+    "    recording_id INTEGER NOT NULL,\n"
+    "    label TEXT NOT NULL,\n"
+    "    count INTEGER NOT NULL DEFAULT 0,\n"
+    "    max_confidence REAL NOT NULL DEFAULT 0,\n"
+    "    PRIMARY KEY (recording_id, label),\n"
+    "    FOREIGN KEY (recording_id) REFERENCES recordings(id) ON DELETE CASCADE\n"
+    ") WITHOUT ROWID;\n"
+    "\n"
+    "CREATE INDEX IF NOT EXISTS idx_recording_detection_labels_label ON recording_detection_labels(label);\n"
+    "CREATE INDEX IF NOT EXISTS idx_recordings_detection_count ON recordings(detection_count);\n"
+    "\n"
+    "INSERT OR REPLACE INTO recording_detection_labels (recording_id, label, count, max_confidence)\n"
+    "SELECT r.id, d.label, COUNT(*), MAX(d.confidence)\n"
+    "FROM recordings r\n"
+    "CROSS JOIN detections d\n"
+    "  ON d.recording_id = r.id\n"
+    "  OR (d.stream_name = r.stream_name AND d.timestamp >= r.start_time AND d.timestamp <= r.end_time)\n"
+    "GROUP BY r.id, d.label;\n"
+    "\n"
+    "UPDATE recordings\n"
+    "SET detection_count = (SELECT SUM(l.count) FROM recording_detection_labels l WHERE l.recording_id = recordings.id),\n"
+    "    max_confidence = (SELECT MAX(l.max_confidence) FROM recording_detection_labels l WHERE l.recording_id = recordings.id)\n"
+    "WHERE id IN (SELECT recording_id FROM recording_detection_labels);";
+
+static const char migration_0042_down[] =
+    "DROP INDEX IF EXISTS idx_recordings_detection_count;\n"
+    "DROP INDEX IF EXISTS idx_recording_detection_labels_label;\n"
+    "DROP TABLE IF EXISTS recording_detection_labels;";
+
+static const char migration_0043_up[] =
+    "CREATE TABLE IF NOT EXISTS stream_storage_stats (\n"
+    "    stream_name TEXT PRIMARY KEY,\n"
+    "    recording_count INTEGER NOT NULL DEFAULT 0,\n"
+    "    total_bytes INTEGER NOT NULL DEFAULT 0\n"
+    ") WITHOUT ROWID;\n"
+    "\n"
+    "INSERT OR REPLACE INTO stream_storage_stats (stream_name, recording_count, total_bytes)\n"
+    "SELECT stream_name, SUM(end_time IS NOT NULL), COALESCE(SUM(size_bytes), 0)\n"
+    "FROM recordings\n"
+    "WHERE is_complete = 1\n"
+    "GROUP BY stream_name;\n"
+    "\n"
+    "CREATE TRIGGER IF NOT EXISTS trg_recordings_storage_stats_insert\n"
+    "AFTER INSERT ON recordings\n"
+    "WHEN NEW.is_complete = 1\n"
+    "BEGIN\n"
+    "    INSERT INTO stream_storage_stats (stream_name, recording_count, total_bytes)\n"
+    "    VALUES (NEW.stream_name, NEW.end_time IS NOT NULL, COALESCE(NEW.size_bytes, 0))\n"
+    "    ON CONFLICT(stream_name) DO UPDATE SET\n"
+    "        recording_count = recording_count + excluded.recording_count,\n"
+    "        total_bytes = total_bytes + excluded.total_bytes;\n"
+    "END;\n"
+    "\n"
+    "CREATE TRIGGER IF NOT EXISTS trg_recordings_storage_stats_update\n"
+    "AFTER UPDATE OF stream_name, is_complete, end_time, size_bytes ON recordings\n"
+    "WHEN OLD.is_complete = 1 OR NEW.is_complete = 1\n"
+    "BEGIN\n"
+    "    UPDATE stream_storage_stats SET\n"
+    "        recording_count = recording_count - (OLD.is_complete = 1 AND OLD.end_time IS NOT NULL),\n"
+    "        total_bytes = total_bytes - (CASE WHEN OLD.is_complete = 1 THEN COALESCE(OLD.size_bytes, 0) ELSE 0 END)\n"
+    "    WHERE stream_name = OLD.stream_name;\n"
+    "    INSERT INTO stream_storage_stats (stream_name, recording_count, total_bytes)\n"
+    "    VALUES (NEW.stream_name,\n"
+    "            NEW.is_complete = 1 AND NEW.end_time IS NOT NULL,\n"
+    "            CASE WHEN NEW.is_complete = 1 THEN COALESCE(NEW.size_bytes, 0) ELSE 0 END)\n"
+    "    ON CONFLICT(stream_name) DO UPDATE SET\n"
+    "        recording_count = recording_count + excluded.recording_count,\n"
+    "        total_bytes = total_bytes + excluded.total_bytes;\n"
+    "END;\n"
+    "\n"
+    "CREATE TRIGGER IF NOT EXISTS trg_recordings_storage_stats_delete\n"
+    "AFTER DELETE ON recordings\n"
+    "WHEN OLD.is_complete = 1\n"
+    "BEGIN\n"
+    "    UPDATE stream_storage_stats SET\n"
+    "        recording_count = recording_count - (OLD.end_time IS NOT NULL),\n"
+    "        total_bytes = total_bytes - COALESCE(OLD.size_bytes, 0)\n"
+    "    WHERE stream_name = OLD.stream_name;\n"
+    "END;";
+
+static const char migration_0043_down[] =
+    "DROP TRIGGER IF EXISTS trg_recordings_storage_stats_delete;\n"
+    "DROP TRIGGER IF EXISTS trg_recordings_storage_stats_update;\n"
+    "DROP TRIGGER IF EXISTS trg_recordings_storage_stats_insert;\n"
+    "DROP TABLE IF EXISTS stream_storage_stats;";
+
+static const char migration_0044_up[] =
+    "CREATE TABLE IF NOT EXISTS detection_rollups (\n"
+    "    stream_name TEXT NOT NULL,\n"
+    "    bucket_seconds INTEGER NOT NULL,\n"
+    "    bucket_start INTEGER NOT NULL,\n"
+    "    label TEXT NOT NULL,\n"
+    "    count INTEGER NOT NULL DEFAULT 0,\n"
+    "    max_confidence REAL NOT NULL DEFAULT 0,\n"
+    "    PRIMARY KEY (stream_name, bucket_seconds, bucket_start, label)\n"
+    ") WITHOUT ROWID;\n"
+    "\n"
+    "INSERT OR REPLACE INTO detection_rollups (stream_name, bucket_seconds, bucket_start, label, count, max_confidence)\n"
+    "SELECT stream_name, 60, timestamp - timestamp % 60, label, COUNT(*), MAX(confidence)\n"
+    "FROM detections\n"
+    "GROUP BY stream_name, timestamp - timestamp % 60, label;\n"
+    "\n"
+    "INSERT OR REPLACE INTO detection_rollups (stream_name, bucket_seconds, bucket_start, label, count, max_confidence)\n"
+    "SELECT stream_name, 3600, bucket_start - bucket_start % 3600, label, SUM(count), MAX(max_confidence)\n"
+    "FROM detection_rollups\n"
+    "WHERE bucket_seconds = 60\n"
+    "GROUP BY stream_name, bucket_start - bucket_start % 3600, label;";
+
+static const char migration_0044_down[] =
+    "DROP TABLE IF EXISTS detection_rollups;";
+
 static const migration_t embedded_migrations_data[] = {
     {
         .version = "0001",
@@ -911,8 +1033,36 @@ static const migration_t embedded_migrations_data[] = {
         .sql_down = migration_0040_down,
         .is_embedded = true
     },
+    {
+        .version = "0041",
+        .description = "add_detection_track_event",
+        .sql_up = migration_0041_up,
+        .sql_down = migration_0041_down,
+        .is_embedded = true
+    },
+    {
+        .version = "0042",
+        .description = "add_recording_detection_summary",
+        .sql_up = migration_0042_up,
+        .sql_down = migration_0042_down,
+        .is_embedded = true
+    },
+    {
+        .version = "0043",
+        .description = "add_stream_storage_stats",
+        .sql_up = migration_0043_up,
+        .sql_down = migration_0043_down,
+        .is_embedded = true
+    },
+    {
+        .version = "0044",
+        .description = "add_detection_rollups",
+        .sql_up = migration_0044_up,
+        .sql_down = migration_0044_down,
+        .is_embedded = true
+    },
 };
 
-#define EMBEDDED_MIGRATIONS_COUNT 40
+#define EMBEDDED_MIGRATIONS_COUNT 44
 
 #endif /* DB_EMBEDDED_MIGRATIONS_H */
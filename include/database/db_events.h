@@ -43,6 +43,17 @@ typedef struct {
 uint64_t add_event(event_type_t type, const char *stream_name, 
                   const char *description, const char *details);
 
+/**
+ * Queue an event for the next group commit of the write queue
+ *
+ * Same as add_event() for callers that do not need the event ID. The
+ * event keeps the time of the call as its timestamp.
+ *
+ * @return 0 if the event was queued, -1 on failure
+ */
+int queue_event(event_type_t type, const char *stream_name,
+                const char *description, const char *details);
+
 /**
  * Get events from the database
  * 
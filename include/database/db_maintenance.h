@@ -12,11 +12,26 @@ int64_t get_database_size(void);
 
 /**
  * Vacuum the database to reclaim space
+ *
+ * Rewrites the whole file under the writer lock. Also switches the database
+ * to auto_vacuum=INCREMENTAL so later space is reclaimed in small steps.
  * 
  * @return 0 on success, non-zero on failure
  */
 int vacuum_database(void);
 
+/**
+ * Release up to max_pages free pages back to the filesystem
+ *
+ * Only has an effect when the database uses auto_vacuum=INCREMENTAL, which
+ * new databases do; vacuum_database() converts an older one. The writer lock
+ * is held for the duration, so keep max_pages small.
+ *
+ * @param max_pages Upper bound on pages released in this call
+ * @return Pages released, or -1 on error
+ */
+int incremental_vacuum_database(int max_pages);
+
 /**
  * Check database integrity
  * 
@@ -27,6 +27,16 @@ typedef struct {
     bool disk_pressure_eligible;  // If true, recording can be deleted under disk pressure
 } recording_metadata_t;
 
+// Position in a sorted recordings list, used for keyset pagination
+typedef struct {
+    uint64_t id;            // Id of the last row returned (breaks ties)
+    int64_t sort_int;       // Sort column value for numeric sort fields
+    char sort_text[64];     // Sort column value when sorting by stream_name
+} recording_cursor_t;
+
+// Large enough for any token produced by recording_cursor_encode()
+#define RECORDING_CURSOR_TOKEN_SIZE 256
+
 // Retention tier constants
 #define RETENTION_TIER_CRITICAL   0
 #define RETENTION_TIER_IMPORTANT  1
@@ -43,6 +53,12 @@ uint64_t add_recording_metadata(const recording_metadata_t *metadata);
 
 /**
  * Update recording metadata in the database
+ *
+ * Progress updates are committed by the write queue when [database]
+ * write_queue is enabled; a newer update of the same recording is merged
+ * into a queued one, and fields passed as 0 keep their queued value. A
+ * completion (is_complete = true) is committed before returning. Once a
+ * recording is complete, later progress updates only change its size.
  * 
  * @param id Recording ID
  * @param end_time New end time
@@ -53,6 +69,19 @@ uint64_t add_recording_metadata(const recording_metadata_t *metadata);
 int update_recording_metadata(uint64_t id, time_t end_time, 
                              uint64_t size_bytes, bool is_complete);
 
+/**
+ * Recount the detection summary of a recording
+ *
+ * detection_count, max_confidence and the recording's rows in
+ * recording_detection_labels are kept up to date as detections are stored
+ * and when the recording completes. Call this after changing which
+ * detections belong to a recording some other way.
+ *
+ * @param id Recording ID
+ * @return 0 on success, -1 on error
+ */
+int refresh_recording_detection_summary(uint64_t id);
+
 /**
  * Correct the start_time of an existing recording.
  *
@@ -131,6 +160,57 @@ int get_recording_metadata_paginated(time_t start_time, time_t end_time,
                                    const char * const *allowed_streams, int allowed_streams_count,
                                    const char *tag_filter, const char *capture_method_filter);
 
+/**
+ * Get the page of recordings that follows a cursor
+ *
+ * Same filters and sorting as get_recording_metadata_paginated(), but the
+ * page starts after the row the cursor points at instead of skipping
+ * offset rows, so deep pages cost the same as the first one. Rows with
+ * equal sort values are ordered by id.
+ *
+ * @param after Cursor from recording_cursor_decode(), or NULL for the first page
+ * @return Number of recordings found, or -1 on error
+ */
+int get_recording_metadata_after(time_t start_time, time_t end_time,
+                                 const char *stream_name, int has_detection,
+                                 const char *detection_label,
+                                 int protected_filter,
+                                 const char *sort_field, const char *sort_order,
+                                 const recording_cursor_t *after,
+                                 recording_metadata_t *metadata, int limit,
+                                 const char * const *allowed_streams, int allowed_streams_count,
+                                 const char *tag_filter, const char *capture_method_filter);
+
+/**
+ * Encode the position of a row as an opaque cursor token
+ *
+ * The token records the sort field and order and is only accepted back for
+ * the same sort.
+ *
+ * @param last Last recording of the current page
+ * @param sort_field Sort field the page was queried with
+ * @param sort_order Sort order the page was queried with
+ * @param token Buffer for the token (RECORDING_CURSOR_TOKEN_SIZE bytes)
+ * @param token_size Size of the buffer
+ * @return 0 on success, -1 on error
+ */
+int recording_cursor_encode(const recording_metadata_t *last,
+                            const char *sort_field, const char *sort_order,
+                            char *token, size_t token_size);
+
+/**
+ * Decode a cursor token
+ *
+ * @param token Token from recording_cursor_encode()
+ * @param sort_field Sort field of the current request
+ * @param sort_order Sort order of the current request
+ * @param cursor Decoded position
+ * @return 0 on success, -1 if the token is malformed or was made for another sort
+ */
+int recording_cursor_decode(const char *token,
+                            const char *sort_field, const char *sort_order,
+                            recording_cursor_t *cursor);
+
 /**
  * Get recording metadata by ID
  *
@@ -157,6 +237,18 @@ int get_recording_metadata_by_path(const char *file_path, recording_metadata_t *
  */
 int delete_recording_metadata(uint64_t id);
 
+/**
+ * Delete the metadata of several recordings in one transaction
+ *
+ * Clears detection references and deletes each recording row. Nothing is
+ * deleted if any statement fails.
+ *
+ * @param ids Recording IDs
+ * @param count Number of IDs
+ * @return Number of recordings deleted, or -1 on error
+ */
+int delete_recordings_metadata_batch(const uint64_t *ids, int count);
+
 /**
  * Delete old recording metadata from the database
  *
@@ -278,6 +370,39 @@ int get_recordings_for_pressure_cleanup(recording_metadata_t *recordings,
  */
 int64_t get_stream_storage_bytes(const char *stream_name);
 
+/**
+ * Storage counters for one stream
+ *
+ * Kept exact by triggers on the recordings table. recording_count counts
+ * complete recordings with an end time, total_bytes sums complete recordings.
+ */
+typedef struct {
+    char stream_name[64];
+    int64_t recording_count;
+    int64_t total_bytes;
+} stream_storage_stats_t;
+
+/**
+ * Get the storage counters of a stream
+ *
+ * A stream without recordings reports zero counters.
+ *
+ * @param stream_name Stream name (NULL for the totals of all streams)
+ * @param stats Filled with the counters
+ * @return 0 on success, -1 on error
+ */
+int get_stream_storage_stats(const char *stream_name, stream_storage_stats_t *stats);
+
+/**
+ * Check the storage counters against the recordings table and rebuild them
+ * if any stream drifted
+ *
+ * Scans the recordings table; meant for periodic maintenance only.
+ *
+ * @return Number of streams whose counters were wrong, or -1 on error
+ */
+int reconcile_stream_storage_stats(void);
+
 /**
  * Set retention tier for a recording
  *
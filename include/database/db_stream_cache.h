@@ -0,0 +1,160 @@
+/**
+ * @file db_stream_cache.h
+ * @brief In-memory copy of the streams table with change notifications
+ *
+ * Stream configurations are loaded from the database when it is initialized
+ * and republished by db_streams.c after every write, so the cache is the
+ * authoritative source for reads. get_stream_config_by_name() and
+ * get_all_stream_configs() are served from it once it is loaded. Code that
+ * writes the streams table without going through db_streams.c must call
+ * load_stream_config_cache() afterwards, or readers keep the old rows.
+ *
+ * Readers never take a lock: they pick up the current snapshot, an
+ * immutable array of configurations, and announce themselves in a reader
+ * counter for the current epoch. A writer publishes a new snapshot, advances
+ * the epoch and frees the old snapshot once every reader of the previous
+ * epoch has left, the same grace period RCU uses.
+ *
+ * Subscribers are called after each change with the old and new
+ * configuration and a mask of the field groups that changed. The recording
+ * and detection threads use them to apply changes while running.
+ */
+
+#ifndef LIGHTNVR_DB_STREAM_CACHE_H
+#define LIGHTNVR_DB_STREAM_CACHE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "core/config.h"
+
+/**
+ * Field groups reported to subscribers
+ */
+#define STREAM_CONFIG_CHANGED_ADDED      (1u << 0)   // Stream was added
+#define STREAM_CONFIG_CHANGED_REMOVED    (1u << 1)   // Stream was deleted
+#define STREAM_CONFIG_CHANGED_STATE      (1u << 2)   // enabled, streaming_enabled, privacy_mode
+#define STREAM_CONFIG_CHANGED_SOURCE     (1u << 3)   // URLs, protocol, ONVIF, go2rtc override
+#define STREAM_CONFIG_CHANGED_VIDEO      (1u << 4)   // width, height, fps, codec
+#define STREAM_CONFIG_CHANGED_RECORDING  (1u << 5)   // record, segments, audio, schedule, motion trigger
+#define STREAM_CONFIG_CHANGED_DETECTION  (1u << 6)   // Detection model, thresholds, buffers, filters
+#define STREAM_CONFIG_CHANGED_RETENTION  (1u << 7)   // Retention days, quota, tiers, storage priority
+#define STREAM_CONFIG_CHANGED_PTZ        (1u << 8)   // PTZ settings
+#define STREAM_CONFIG_CHANGED_OTHER      (1u << 9)   // Tags, admin URL, priority
+#define STREAM_CONFIG_CHANGED_ALL        0xffffffffu
+
+/**
+ * Called after a stream configuration changed
+ *
+ * Runs on the thread that wrote the change, after the new snapshot is
+ * visible to readers. The listener may read the cache but must not write
+ * stream configurations.
+ *
+ * @param name Stream name
+ * @param old_config Configuration before the change (NULL if added)
+ * @param new_config Configuration after the change (NULL if removed)
+ * @param changed STREAM_CONFIG_CHANGED_* bits
+ * @param user_data Pointer passed to stream_config_subscribe()
+ */
+typedef void (*stream_config_listener_fn)(const char *name, const stream_config_t *old_config,
+                                          const stream_config_t *new_config, uint32_t changed,
+                                          void *user_data);
+
+/**
+ * Called with a configuration inside a read section
+ *
+ * The pointer is only valid during the call; the function must not block.
+ */
+typedef void (*stream_config_reader_fn)(const stream_config_t *config, void *user_data);
+
+/**
+ * Replace the cached configurations
+ *
+ * Subscribers are told about every stream that was added, removed or
+ * changed compared to the previous contents.
+ *
+ * @param streams Configurations, at most MAX_STREAMS
+ * @param count Number of configurations
+ * @return 0 on success, -1 on error
+ */
+int stream_config_cache_load(const stream_config_t *streams, int count);
+
+/**
+ * Drop the cached configurations; reads fall back to the database
+ */
+void stream_config_cache_clear(void);
+
+/**
+ * Check whether the cache has been loaded
+ */
+bool stream_config_cache_loaded(void);
+
+/**
+ * Publish the configuration of one stream
+ *
+ * @param name Stream name
+ * @param config New configuration, or NULL if the stream was deleted
+ * @return 0 on success, -1 on error
+ */
+int stream_config_cache_publish(const char *name, const stream_config_t *config);
+
+/**
+ * Copy the configuration of a stream
+ *
+ * @return 0 on success, -1 if the stream is not cached
+ */
+int stream_config_cache_get(const char *name, stream_config_t *config);
+
+/**
+ * Call a function with the configuration of a stream without copying it
+ *
+ * @return 0 if the function was called, -1 if the stream is not cached
+ */
+int stream_config_cache_read(const char *name, stream_config_reader_fn fn, void *user_data);
+
+/**
+ * Copy all cached configurations, ordered by name
+ *
+ * @return Number of configurations copied
+ */
+int stream_config_cache_get_all(stream_config_t *streams, int max_count);
+
+/**
+ * Get the number of cached configurations
+ */
+int stream_config_cache_count(void);
+
+/**
+ * Get the cache version
+ *
+ * Increases with every published change; 0 while the cache is not loaded.
+ * Callers that poll the configuration can skip the copy while it is unchanged.
+ */
+uint64_t stream_config_cache_version(void);
+
+/**
+ * Register a listener for configuration changes
+ *
+ * @param mask STREAM_CONFIG_CHANGED_* bits the listener is interested in
+ * @param fn Listener
+ * @param user_data Passed to the listener
+ * @return Subscription id (> 0), or -1 if no slot is free
+ */
+int stream_config_subscribe(uint32_t mask, stream_config_listener_fn fn, void *user_data);
+
+/**
+ * Remove a listener
+ *
+ * Waits for a running notification to finish, so the listener is not
+ * called after this returns. Must not be called from a listener.
+ */
+void stream_config_unsubscribe(int id);
+
+/**
+ * Compare two configurations
+ *
+ * @return STREAM_CONFIG_CHANGED_* bits of the field groups that differ
+ */
+uint32_t stream_config_diff(const stream_config_t *a, const stream_config_t *b);
+
+#endif /* LIGHTNVR_DB_STREAM_CACHE_H */
@@ -74,6 +74,28 @@ int get_all_stream_configs(stream_config_t *streams, int max_count);
  */
 int count_stream_configs(void);
 
+/**
+ * Load every stream configuration into the configuration cache
+ *
+ * Called once the database is initialized; afterwards
+ * get_stream_config_by_name(), get_all_stream_configs() and
+ * count_stream_configs() are served from the cache.
+ *
+ * @return 0 on success, -1 on error
+ */
+int load_stream_config_cache(void);
+
+/**
+ * Re-read one stream configuration into the configuration cache
+ *
+ * Must be called after any write to the streams table that does not go
+ * through the functions in this file. Does nothing if the cache is not loaded.
+ *
+ * @param name Stream name
+ * @return 0 on success, -1 on error
+ */
+int reload_stream_config(const char *name);
+
 /**
  * Count the number of enabled stream configurations in the database
  *
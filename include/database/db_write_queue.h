@@ -0,0 +1,118 @@
+/**
+ * @file db_write_queue.h
+ * @brief Write-behind queue for high-rate database writes
+ *
+ * Detection inserts, events and recording progress updates used to run in
+ * their own transaction on the detection, recording and MQTT threads, each
+ * waiting for the writer connection and the commit. Producers now hand a
+ * copy of the row to this queue and return. One thread commits the queued
+ * writes in groups every [database] write_batch_interval_ms or once
+ * write_batch_max_rows are waiting, whichever comes first.
+ *
+ * Durability: a queued write is lost if the process dies before its group
+ * commits, so at most one batch interval of rows. With [database]
+ * write_queue = false every write commits on the caller's thread before
+ * returning, as before. The queue is flushed when the database shuts down.
+ *
+ * The queue holds at most write_queue_capacity writes. When it is full the
+ * producer waits for room instead of dropping the write.
+ */
+
+#ifndef LIGHTNVR_DB_WRITE_QUEUE_H
+#define LIGHTNVR_DB_WRITE_QUEUE_H
+
+#include <sqlite3.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Apply one queued write
+ *
+ * Called with the writer connection locked and a transaction open.
+ *
+ * @param db Writer connection
+ * @param payload Copy of the payload passed to db_write_queue_submit()
+ * @return 0 on success, non-zero on failure
+ */
+typedef int (*db_write_fn)(sqlite3 *db, const void *payload);
+
+/**
+ * Fold a newer keyed write into the queued one
+ *
+ * Called under the queue lock; must not touch the database.
+ *
+ * @param queued Payload of the write still in the queue, updated in place
+ * @param incoming Payload of the newer write
+ */
+typedef void (*db_write_merge_fn)(void *queued, const void *incoming);
+
+/**
+ * Write queue counters
+ */
+typedef struct {
+    uint64_t submitted;         // Writes handed to the queue
+    uint64_t coalesced;         // Writes that replaced a queued write with the same key
+    uint64_t committed;         // Writes committed by the queue thread
+    uint64_t failed;            // Writes whose apply function failed
+    uint64_t batches;           // Group commits
+    uint64_t overflows;         // Writes that waited for room in a full queue
+    uint64_t commit_us;         // Time spent in group commits
+    int depth;                  // Writes waiting now
+    int max_depth;
+} db_write_queue_stats_t;
+
+/**
+ * Start the queue thread if [database] write_queue is enabled
+ *
+ * @return 0 on success, -1 if the thread could not be started (writes are
+ *         then done synchronously)
+ */
+int db_write_queue_init(void);
+
+/**
+ * Commit everything still queued and stop the queue thread
+ */
+void db_write_queue_shutdown(void);
+
+/**
+ * Queue a write
+ *
+ * The payload is copied. Without a running queue the write is applied on
+ * the caller's thread; when the queue is full the caller waits for room.
+ *
+ * @param apply Function that performs the write
+ * @param payload Data for the write
+ * @param size Size of the payload
+ * @return 0 if the write was queued or applied, -1 on failure
+ */
+int db_write_queue_submit(db_write_fn apply, const void *payload, size_t size);
+
+/**
+ * Queue a write that folds into a queued write with the same function and key
+ *
+ * Used for updates where only the newest values matter, such as the size of
+ * a recording in progress. A matching queued write is updated by merge, or
+ * has its payload replaced when merge is NULL, instead of adding another one.
+ *
+ * Readers do not see a queued write until it commits; callers that need
+ * read-after-write consistency flush the queue or use db_write_now().
+ */
+int db_write_queue_submit_keyed(db_write_fn apply, db_write_merge_fn merge, uint64_t key,
+                                const void *payload, size_t size);
+
+/**
+ * Apply a write in its own transaction on the caller's thread
+ */
+int db_write_now(db_write_fn apply, const void *payload);
+
+/**
+ * Wait until every write queued before the call has been committed
+ */
+void db_write_queue_flush(void);
+
+/**
+ * Get the queue counters
+ */
+void db_write_queue_get_stats(db_write_queue_stats_t *stats);
+
+#endif /* LIGHTNVR_DB_WRITE_QUEUE_H */
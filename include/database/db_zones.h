@@ -2,6 +2,7 @@
 #define DB_ZONES_H
 
 #include <stdbool.h>
+#include <stdint.h>
 #include "core/config.h"
 
 #define MAX_ZONE_NAME 64
@@ -72,5 +73,16 @@ int delete_detection_zone(const char *zone_id);
  */
 int update_zone_enabled(const char *zone_id, bool enabled);
 
+/**
+ * Get the zone table generation
+ *
+ * The counter increases after every successful save, delete or enable/disable
+ * above, so callers that keep zones in memory can detect stale copies without
+ * querying the database.
+ *
+ * @return Current generation (never 0)
+ */
+uint64_t get_detection_zones_generation(void);
+
 #endif /* DB_ZONES_H */
 
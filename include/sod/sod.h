@@ -171,6 +171,11 @@ typedef void (*ProcRnnCallback)(const char *, size_t, void *);
 * The documentation is available to consult at https://sod.pixlab.io/c_api/sod_cnn_config.html.
 */
 typedef void(*ProcLogCallback)(const char *, size_t, void *);
+/*
+* Per-image consumer used by `sod_cnn_predict_batch()`: receives the zero-based index of the image
+* in the submitted set, its detected boxes (valid only during the call), the box count and the user pointer.
+*/
+typedef void(*ProcBatchCallback)(int, sod_box *, int, void *);
 /* 
  * Macros to be used in conjunction with the `sod_img_load_from_file()` or `sod_img_load_from_mem()` interfaces.
  */
@@ -234,11 +239,30 @@ typedef enum {
  * The interfaces are documented at https://sod.pixlab.io/api.html#cnn.
  */
 SOD_APIEXPORT int  sod_cnn_create(sod_cnn **ppOut, const char *zArch, const char *zModelPath, const char **pzErr);
+/*
+ * Create a network on the weights of pShare (same architecture, not recurrent).
+ * Each such network owns only its activations, so several may predict at once.
+ * pShare must outlive them.
+ */
+SOD_APIEXPORT int  sod_cnn_create_shared(sod_cnn **ppOut, const char *zArch, const sod_cnn *pShare, const char **pzErr);
 SOD_APIEXPORT int  sod_cnn_config(sod_cnn *pNet, SOD_CNN_CONFIG conf, ...);
 SOD_APIEXPORT int  sod_cnn_predict(sod_cnn *pNet, float *pInput, sod_box **paBox, int *pnBox);
+SOD_APIEXPORT int  sod_cnn_predict_batch(sod_cnn *pNet, const sod_img *aIn, int nIn, ProcBatchCallback xConsumer, void *pUserData);
+SOD_APIEXPORT int  sod_cnn_quantize(sod_cnn *pNet, const sod_img *aCalib, int nCalib, const char *zPath);
 SOD_APIEXPORT void sod_cnn_destroy(sod_cnn *pNet);
 SOD_APIEXPORT float *  sod_cnn_prepare_image(sod_cnn *pNet, sod_img in);
 SOD_APIEXPORT int sod_cnn_get_network_size(sod_cnn *pNet, int *pWidth, int *pHeight, int *pChannels);
+/*
+ * Number of threads (caller included) a single convolution may be spread over.
+ * Process wide; values < 1 use every online CPU. Defaults to 1.
+ */
+SOD_APIEXPORT void sod_cnn_set_threads(int nThreads);
+/*
+ * When enabled, float weights are used in place from a read-only memory view
+ * of the model file instead of being copied. The file must then not be
+ * modified in place while a network uses it. Process wide; defaults to off.
+ */
+SOD_APIEXPORT void sod_cnn_set_weight_mapping(int bEnable);
 #endif /* SOD_DISABLE_CNN */
 #ifndef SOD_DISABLE_REALNET
 /*
@@ -253,6 +277,7 @@ SOD_APIEXPORT int sod_realnet_load_model_from_disk(sod_realnet *pNet, const char
 #endif
 SOD_APIEXPORT int sod_realnet_model_config(sod_realnet *pNet, sod_realnet_model_handle handle, SOD_REALNET_MODEL_CONFIG conf, ...);
 SOD_APIEXPORT int sod_realnet_detect(sod_realnet *pNet, const unsigned char *zGrayImg, int width, int height, sod_box **apBox, int *pnBox);
+SOD_APIEXPORT int sod_realnet_detect_strided(sod_realnet *pNet, const unsigned char *zGrayImg, int width, int height, int nStride, sod_box **apBox, int *pnBox);
 SOD_APIEXPORT void sod_realnet_destroy(sod_realnet *pNet);
 #endif /* SOD_DISABLE_REALNET */
 #ifdef SOD_ENABLE_NET_TRAIN
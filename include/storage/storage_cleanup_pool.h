@@ -0,0 +1,80 @@
+/**
+ * @file storage_cleanup_pool.h
+ * @brief Worker threads that remove recording files for retention cleanup
+ *
+ * Retention and emergency cleanup pick their victims in bulk. The files of
+ * a batch are unlinked in parallel by a few workers running at a reduced
+ * I/O priority, and the storage thread then deletes the metadata of the
+ * removed files in a single transaction, and their thumbnails once it has
+ * committed.
+ */
+
+#ifndef LIGHTNVR_STORAGE_CLEANUP_POOL_H
+#define LIGHTNVR_STORAGE_CLEANUP_POOL_H
+
+#include <stdint.h>
+
+/**
+ * Maximum number of cleanup workers
+ */
+#define CLEANUP_POOL_MAX_WORKERS 32
+
+/**
+ * I/O priority of the cleanup workers ([storage] cleanup_io_priority)
+ */
+typedef enum {
+    CLEANUP_IO_PRIORITY_NORMAL = 0,   // Inherit the process priority
+    CLEANUP_IO_PRIORITY_LOW,          // Lowest best-effort level
+    CLEANUP_IO_PRIORITY_IDLE          // Only when the disk is otherwise idle
+} cleanup_io_priority_t;
+
+/**
+ * One file to remove
+ */
+typedef struct {
+    const char *path;           // File to unlink; NULL or "" = no file
+    uint64_t size_bytes;        // Counted as freed when the unlink succeeds
+    int result;                 // Set by the pool: 0, or the errno of the failed unlink
+} cleanup_job_t;
+
+/**
+ * Cleanup pool counters
+ */
+typedef struct {
+    uint64_t files_removed;
+    uint64_t bytes_freed;       // Updated as each file is removed
+    uint64_t failures;          // Unlinks that failed for a reason other than ENOENT
+    int workers;
+} cleanup_pool_stats_t;
+
+/**
+ * Start the cleanup workers
+ *
+ * @param workers Number of worker threads (1 to CLEANUP_POOL_MAX_WORKERS)
+ * @param io_priority I/O priority applied to each worker thread
+ * @return 0 on success, -1 if no worker could be started
+ */
+int cleanup_pool_start(int workers, cleanup_io_priority_t io_priority);
+
+/**
+ * Finish the batch in progress and stop the workers
+ */
+void cleanup_pool_stop(void);
+
+/**
+ * Remove the files of a batch and wait until every job has a result
+ *
+ * Runs the jobs on the calling thread when the pool is not started.
+ * Batches from different threads run one after another.
+ *
+ * @param jobs Jobs to run; result is filled in for each
+ * @param count Number of jobs
+ */
+void cleanup_pool_run(cleanup_job_t *jobs, int count);
+
+/**
+ * Get the cleanup pool counters
+ */
+void cleanup_pool_get_stats(cleanup_pool_stats_t *stats);
+
+#endif /* LIGHTNVR_STORAGE_CLEANUP_POOL_H */
@@ -4,6 +4,7 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include "video/detection_result.h"
+#include "video/api_detection_client.h"
 
 // Model type for API-based detection
 #define MODEL_TYPE_API "api"
@@ -71,4 +72,48 @@ bool api_detection_should_use_go2rtc_snapshot(const unsigned char *frame_data,
 int detect_objects_api_snapshot(const char *api_url, const char *stream_name,
                                 detection_result_t *result, float threshold, uint64_t recording_id);
 
+/**
+ * Queue an API detection for a go2rtc snapshot without waiting for the answer
+ *
+ * The snapshot is fetched on the calling thread, then sent through the shared
+ * API detection client. The callback runs on the client worker thread with
+ * the raw response; parse it with api_detection_parse_response() and run it
+ * through api_detection_process_result() on the caller's own thread.
+ *
+ * @param api_url The URL of the detection API (or "api-detection")
+ * @param stream_name The name of the stream (required for go2rtc snapshot)
+ * @param threshold Confidence threshold for detection (0.0-1.0, use negative for default)
+ * @param callback Completion callback
+ * @param user_data Passed to the callback
+ * @return 0 if queued, API_DETECTION_CLIENT_BUSY if the stream already has
+ *         `max_inflight` requests outstanding, -2 if the go2rtc snapshot
+ *         failed (caller should fall back), -1 on other errors
+ */
+int detect_objects_api_snapshot_async(const char *api_url, const char *stream_name, float threshold,
+                                      api_detection_complete_cb callback, void *user_data);
+
+/**
+ * Parse the JSON body of a detection API response
+ *
+ * @param body Response body
+ * @param body_len Length of the body in bytes
+ * @param result Output: parsed detections (cleared first)
+ * @return 0 on success, -1 if the body is not a valid detection response
+ */
+int api_detection_parse_response(const char *body, size_t body_len, detection_result_t *result);
+
+/**
+ * Run parsed API detections through the per-stream pipeline
+ *
+ * Applies zone and object filters, feeds the object tracker, stores and
+ * publishes the resulting track events and updates the MQTT motion state.
+ *
+ * @param stream_name Stream the detections belong to
+ * @param result Detections (filtered in place)
+ * @param recording_id Recording ID to link detections to (0 for no link)
+ * @return 0 on success, -1 on error (result is then emptied)
+ */
+int api_detection_process_result(const char *stream_name, detection_result_t *result,
+                                 uint64_t recording_id);
+
 #endif /* LIGHTNVR_API_DETECTION_H */
@@ -0,0 +1,170 @@
+/**
+ * @file api_detection_client.h
+ * @brief Shared asynchronous HTTP client for API-based detection
+ *
+ * All requests to external detection APIs go through one worker thread that
+ * drives a curl multi handle. Easy handles are pooled and the multi handle
+ * keeps its connections alive, so consecutive requests to the same detection
+ * server reuse a warm TCP/TLS connection instead of reconnecting per frame.
+ *
+ * Callers submit a JPEG and get a completion callback on the worker thread.
+ * The number of requests a single stream may have in flight is bounded by
+ * `[api_detection] max_inflight`; further submissions return
+ * API_DETECTION_CLIENT_BUSY until one completes.
+ *
+ * Every completed request is added to a per-backend latency histogram
+ * (exposed on /api/metrics).
+ */
+
+#ifndef LIGHTNVR_API_DETECTION_CLIENT_H
+#define LIGHTNVR_API_DETECTION_CLIENT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Return value of api_detection_client_submit() when the stream is at its in-flight limit
+#define API_DETECTION_CLIENT_BUSY 1
+
+// Number of backends that get their own latency histogram
+#define API_DETECTION_LATENCY_MAX_BACKENDS 8
+
+// Latency histogram buckets: upper bounds in milliseconds, plus one +Inf bucket
+#define API_DETECTION_LATENCY_BUCKETS 11
+
+/**
+ * Outcome of one detection request, passed to the completion callback
+ *
+ * `body` is only valid for the duration of the callback.
+ */
+typedef struct {
+    int status;             // 0 = HTTP exchange completed, -1 = transport error or cancelled
+    long http_code;         // HTTP status code (0 if no response)
+    const char *body;       // NUL-terminated response body (may be NULL)
+    size_t body_len;        // Response body length in bytes
+    double latency_ms;      // Time from submission to completion
+} api_detection_response_t;
+
+/**
+ * Completion callback, invoked on the client worker thread
+ *
+ * Keep it short: it delays every other in-flight request.
+ */
+typedef void (*api_detection_complete_cb)(const char *stream_name,
+                                          const api_detection_response_t *response,
+                                          void *user_data);
+
+/**
+ * Snapshot of one backend's latency histogram
+ */
+typedef struct {
+    char backend[32];
+    uint64_t buckets[API_DETECTION_LATENCY_BUCKETS];  // Non-cumulative counts per bucket
+    uint64_t count;         // Completed requests (including errors)
+    uint64_t errors;        // Transport errors and non-200 responses
+    double sum_ms;          // Sum of all latencies
+} api_detection_latency_t;
+
+/**
+ * Start the client worker thread
+ *
+ * @return 0 on success (or if already running), -1 on error
+ */
+int api_detection_client_init(void);
+
+/**
+ * Stop the worker thread, abort outstanding requests and free all handles
+ *
+ * Outstanding requests complete with status -1 before this returns.
+ */
+void api_detection_client_shutdown(void);
+
+/**
+ * Check whether the worker thread is running
+ */
+bool api_detection_client_is_running(void);
+
+/**
+ * Queue a multipart detection request
+ *
+ * The JPEG is copied into the request, so the caller keeps ownership.
+ *
+ * @param stream_name Stream the request belongs to (used for the in-flight limit)
+ * @param url Full request URL including query parameters
+ * @param backend Backend name used to pick the latency histogram
+ * @param jpeg_data JPEG image to send as the "file" form field
+ * @param jpeg_size Size of the JPEG in bytes
+ * @param callback Completion callback (required)
+ * @param user_data Passed to the callback
+ * @return 0 if queued, API_DETECTION_CLIENT_BUSY if the stream is at its
+ *         in-flight limit, -1 on error
+ */
+int api_detection_client_submit(const char *stream_name, const char *url, const char *backend,
+                                const unsigned char *jpeg_data, size_t jpeg_size,
+                                api_detection_complete_cb callback, void *user_data);
+
+/**
+ * Send a request through the shared client and wait for the answer
+ *
+ * Not subject to the per-stream in-flight limit. The response body is
+ * returned in a malloc'd buffer the caller must free.
+ *
+ * @param stream_name Stream the request belongs to (may be NULL)
+ * @param url Full request URL including query parameters
+ * @param backend Backend name used to pick the latency histogram
+ * @param jpeg_data JPEG image to send
+ * @param jpeg_size Size of the JPEG in bytes
+ * @param http_code Output: HTTP status code
+ * @param body Output: NUL-terminated response body (caller frees)
+ * @param body_len Output: response body length
+ * @return 0 if the HTTP exchange completed, -1 on error
+ */
+int api_detection_client_perform(const char *stream_name, const char *url, const char *backend,
+                                 const unsigned char *jpeg_data, size_t jpeg_size,
+                                 long *http_code, char **body, size_t *body_len);
+
+/**
+ * Drop all queued and in-flight requests of a stream
+ *
+ * No callback for the stream runs after this returns, so the caller may
+ * free the callback's user_data.
+ *
+ * @param stream_name Stream name
+ */
+void api_detection_client_cancel(const char *stream_name);
+
+/**
+ * Get the number of requests a stream currently has queued or in flight
+ */
+int api_detection_client_inflight(const char *stream_name);
+
+/**
+ * Get the upper bound (in ms) of a latency histogram bucket
+ *
+ * @param bucket Bucket index
+ * @return Bound in ms, or a negative value for the final +Inf bucket
+ */
+double api_detection_latency_bucket_bound_ms(int bucket);
+
+/**
+ * Record one request latency for a backend
+ *
+ * Called by the worker for every completed request; exposed for callers
+ * that talk to a backend outside the client.
+ *
+ * @param backend Backend name
+ * @param latency_ms Request latency
+ * @param failed Whether the request failed
+ */
+void api_detection_client_record_latency(const char *backend, double latency_ms, bool failed);
+
+/**
+ * Copy the latency histograms of all backends seen so far
+ *
+ * @param out Output array
+ * @param max_entries Capacity of out
+ * @return Number of entries written
+ */
+int api_detection_client_get_latency_stats(api_detection_latency_t *out, int max_entries);
+
+#endif /* LIGHTNVR_API_DETECTION_CLIENT_H */
@@ -0,0 +1,124 @@
+/**
+ * @file detection_cascade.h
+ * @brief Multi-stage detection cascades in which cheap stages gate expensive ones
+ *
+ * A stream opts into a cascade through its detection model string:
+ *
+ *   cascade:motion,person-tiny.sod,api-detection
+ *
+ * Stages run in order on the same decoded keyframe and each one only runs
+ * when the previous stage fired. Built-in motion marks the active regions;
+ * detections of the model stage that follows are only kept when they
+ * overlap one of those regions. Stage rules:
+ *
+ *   - "motion" may only be the first stage
+ *   - "api-detection", http(s) URLs and "frame-bus" answer asynchronously
+ *     and may only be the last stage
+ *   - anything else is a model file, relative to [models] path unless absolute
+ *
+ * Per-stage run, hit and time counters are kept for every stream.
+ */
+
+#ifndef LIGHTNVR_DETECTION_CASCADE_H
+#define LIGHTNVR_DETECTION_CASCADE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "core/config.h"
+#include "video/detection_result.h"
+
+#define DETECTION_CASCADE_PREFIX "cascade:"
+#define DETECTION_CASCADE_MAX_STAGES 4
+
+typedef enum {
+    CASCADE_STAGE_MOTION = 0,   // Built-in motion detection
+    CASCADE_STAGE_MODEL,        // Local model file (SOD, SOD RealNet, TFLite)
+    CASCADE_STAGE_API,          // HTTP detection API ("api-detection" or a URL)
+    CASCADE_STAGE_FRAME_BUS     // Local detector on the frame bus
+} cascade_stage_kind_t;
+
+typedef struct {
+    cascade_stage_kind_t kind;
+    char model_path[MAX_PATH_LENGTH];   // Resolved model path, API URL or keyword
+    char name[64];                      // Stage name used in stats
+} cascade_stage_t;
+
+typedef struct {
+    int stage_count;
+    cascade_stage_t stages[DETECTION_CASCADE_MAX_STAGES];
+} detection_cascade_t;
+
+/**
+ * Counters of one cascade stage
+ */
+typedef struct {
+    char name[64];
+    uint64_t runs;              // Frames the stage analyzed
+    uint64_t hits;              // Frames on which the stage fired
+    uint64_t total_us;          // Time spent in the stage
+} cascade_stage_stats_t;
+
+/**
+ * Check whether a detection model string describes a cascade
+ */
+bool is_detection_cascade(const char *model_path);
+
+/**
+ * Parse a "cascade:stage,stage,..." model string
+ *
+ * @param model_path Detection model string
+ * @param models_dir Directory relative model file names are resolved against
+ * @param cascade Output
+ * @return 0 on success, -1 if the string is not a valid cascade
+ */
+int detection_cascade_parse(const char *model_path, const char *models_dir,
+                            detection_cascade_t *cascade);
+
+/**
+ * Check whether a cascade contains a stage of the given kind
+ */
+bool detection_cascade_has_stage(const detection_cascade_t *cascade, cascade_stage_kind_t kind);
+
+/**
+ * Drop detections that do not overlap any region of the previous stage
+ *
+ * @param result Detections to filter in place
+ * @param regions Regions reported by the previous stage
+ * @return Number of detections kept
+ */
+int detection_cascade_filter_by_regions(detection_result_t *result, const detection_result_t *regions);
+
+/**
+ * Count one run of a stage
+ *
+ * @param stream_name Stream name
+ * @param cascade The stream's cascade (names the stats slots)
+ * @param stage Stage index
+ * @param fired Whether the stage fired
+ * @param elapsed_us Time spent in the stage
+ */
+void detection_cascade_record_run(const char *stream_name, const detection_cascade_t *cascade,
+                                  int stage, bool fired, uint64_t elapsed_us);
+
+/**
+ * Count a hit of a stage that answered asynchronously
+ */
+void detection_cascade_record_hit(const char *stream_name, int stage);
+
+/**
+ * Copy a stream's per-stage counters
+ *
+ * @param stream_name Stream name
+ * @param out Output array
+ * @param max_stages Capacity of out
+ * @return Number of stages written (0 if the stream has no cascade stats)
+ */
+int detection_cascade_get_stats(const char *stream_name, cascade_stage_stats_t *out, int max_stages);
+
+/**
+ * Forget a stream's counters (NULL forgets all streams)
+ */
+void detection_cascade_reset_stats(const char *stream_name);
+
+#endif /* LIGHTNVR_DETECTION_CASCADE_H */
@@ -35,6 +35,9 @@ const char* get_model_type(const char *model_path);
 /**
  * Load a detection model
  *
+ * Returns a handle owned by the calling thread. Handles for the same local
+ * model file share its weights (see model_registry.h).
+ *
  * @param model_path Path to the model file
  * @param threshold Detection confidence threshold (0.0-1.0)
  * @return Model handle or NULL on failure
@@ -75,10 +78,10 @@ const char* get_model_type_from_handle(detection_model_t model);
 /**
  * Clean up old models in the global cache
  *
- * This function is kept for API compatibility but does nothing in the thread-local model approach
- * Each thread is responsible for managing its own model
+ * This function is kept for API compatibility and does nothing: shared model
+ * weights are freed when their last handle is unloaded
  *
- * @param max_age Maximum age in seconds (ignored in thread-local approach)
+ * @param max_age Maximum age in seconds (ignored)
  */
 void cleanup_old_detection_models(time_t max_age);
 
@@ -97,8 +100,8 @@ void shutdown_detection_model_system(void);
 /**
  * Force cleanup of all models in the global cache
  *
- * This function is kept for API compatibility but does nothing in the thread-local model approach
- * Each thread is responsible for managing its own model
+ * This function is kept for API compatibility and does nothing: shared model
+ * weights are freed when their last handle is unloaded
  */
 void force_cleanup_model_cache(void);
 
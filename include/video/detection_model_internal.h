@@ -43,6 +43,8 @@ typedef struct {
     };
     float threshold;        /* Detection confidence threshold          */
     char  path[MAX_PATH_LENGTH]; /* Path to the model file            */
+    void *version;          /* model_version_t the handle runs on, when
+                               its weights come from the model registry */
 } model_t;
 
 #endif /* DETECTION_MODEL_INTERNAL_H */
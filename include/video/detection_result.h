@@ -5,6 +5,14 @@
 #define MAX_LABEL_LENGTH 32
 #define MAX_ZONE_ID_LENGTH 32
 
+// Track lifecycle event carried by a detection (see video/object_tracker.h)
+typedef enum {
+    TRACK_EVENT_NONE = 0,          // Raw detection, not produced by the tracker
+    TRACK_EVENT_START,
+    TRACK_EVENT_UPDATE,
+    TRACK_EVENT_END
+} track_event_t;
+
 // Structure to hold a single detection
 typedef struct {
     char label[MAX_LABEL_LENGTH];  // Object class label
@@ -12,6 +20,7 @@ typedef struct {
     float x, y, width, height;     // Bounding box (normalized 0.0-1.0)
     int track_id;                  // Tracking ID (-1 if not tracked)
     char zone_id[MAX_ZONE_ID_LENGTH]; // Zone ID (empty if not in zone)
+    track_event_t track_event;     // Track lifecycle event (TRACK_EVENT_NONE if untracked)
 } detection_t;
 
 // Structure to hold multiple detections from a single frame
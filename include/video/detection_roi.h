@@ -0,0 +1,80 @@
+/**
+ * @file detection_roi.h
+ * @brief Region-of-interest cropping for detection models
+ *
+ * When a stream's zones or motion cover only part of the frame, the model
+ * runs on crops around those regions instead of the whole image. A model
+ * that scales its input to a fixed size then sees small objects at a
+ * higher effective resolution, and scanning models have less to scan.
+ * Boxes found in a crop are mapped back into frame coordinates.
+ *
+ * Controlled by the roi_* options of the [models] section.
+ */
+
+#ifndef LIGHTNVR_DETECTION_ROI_H
+#define LIGHTNVR_DETECTION_ROI_H
+
+#include <stdint.h>
+
+#include "video/detection_result.h"
+
+// Upper bound of [models] roi_max_regions
+#define DETECTION_ROI_MAX_REGIONS 8
+
+/**
+ * Crop rectangle in frame pixels
+ */
+typedef struct {
+    int x;
+    int y;
+    int width;
+    int height;
+} detection_roi_t;
+
+/**
+ * Plan the crops for a frame
+ *
+ * Pads every region, grows tiny ones to a minimum size and merges
+ * overlapping crops. Returns 0, meaning "use the whole frame", when
+ * cropping is disabled, there are no regions, or the crops would cover
+ * more than [models] roi_max_coverage of the frame.
+ *
+ * @param regions Regions in normalized 0-1 coordinates (zone boxes or motion)
+ * @param frame_width Frame width in pixels
+ * @param frame_height Frame height in pixels
+ * @param rois Output array of DETECTION_ROI_MAX_REGIONS entries
+ * @return Number of crops
+ */
+int detection_roi_plan(const detection_result_t *regions, int frame_width, int frame_height,
+                       detection_roi_t *rois);
+
+/**
+ * Copy a crop out of a packed frame
+ *
+ * @param frame Packed frame, frame_width * channels bytes per row
+ * @param frame_width Frame width in pixels
+ * @param channels Bytes per pixel
+ * @param roi Crop rectangle
+ * @param dst Output buffer of roi->width * roi->height * channels bytes
+ */
+void detection_roi_crop(const uint8_t *frame, int frame_width, int channels,
+                        const detection_roi_t *roi, uint8_t *dst);
+
+/**
+ * Map boxes normalized to a crop into boxes normalized to the frame
+ */
+void detection_roi_map_to_frame(detection_result_t *result, const detection_roi_t *roi,
+                                int frame_width, int frame_height);
+
+/**
+ * Append the detections of one crop to the frame's result
+ *
+ * Crops may overlap, so a detection of the same label that mostly
+ * overlaps one already in dst replaces it only if it is more confident.
+ *
+ * @param dst Frame result
+ * @param src Detections of one crop, already mapped to the frame
+ */
+void detection_roi_merge(detection_result_t *dst, const detection_result_t *src);
+
+#endif /* LIGHTNVR_DETECTION_ROI_H */
@@ -0,0 +1,159 @@
+/**
+ * @file frame_bus.h
+ * @brief Shared-memory frame bus for detectors running on the same host
+ *
+ * Instead of JPEG-encoding each frame and uploading it over HTTP, streams
+ * whose detection model is "frame-bus" publish decoded RGB24 frames into a
+ * per-stream ring in a memfd. A local detector connects to the bus's Unix
+ * socket, attaches to a stream and receives the ring's memfd plus an eventfd
+ * that is signalled after every published frame. It reads the newest slot
+ * straight out of shared memory and sends its detections back on the same
+ * socket, in the JSON format of the HTTP detection API.
+ *
+ * Control protocol (AF_UNIX, SOCK_SEQPACKET, one text message per packet):
+ *
+ *   detector -> lightnvr   "ATTACH <stream>"
+ *   lightnvr -> detector   "OK <slot_count> <slot_stride> <max_frame_bytes>"
+ *                          with SCM_RIGHTS { memfd, eventfd }
+ *                          or "ERR <reason>"
+ *   detector -> lightnvr   "RESULT <seq> {\"detections\":[...]}"
+ *
+ * A connection is attached to one stream; a detector that serves several
+ * streams opens one connection per stream. Box coordinates in results are
+ * normalized to [0, 1] like the HTTP API.
+ *
+ * Ring layout (all integers in host byte order):
+ *
+ *   offset 0                          frame_bus_header_t
+ *   FRAME_BUS_HEADER_SIZE + i*stride  frame_bus_slot_t, pixel data follows
+ *
+ * Frame N is written to slot N % slot_count. Each slot is guarded by a
+ * seqlock: `gen` is odd while the publisher writes the slot. A reader loads
+ * `gen`, copies the slot, and discards the copy if `gen` changed meanwhile.
+ * `write_seq` in the header is the sequence number of the newest complete
+ * frame.
+ */
+
+#ifndef LIGHTNVR_FRAME_BUS_H
+#define LIGHTNVR_FRAME_BUS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define FRAME_BUS_MAGIC        0x4246564Cu  // "LVFB"
+#define FRAME_BUS_VERSION      1
+#define FRAME_BUS_HEADER_SIZE  4096         // Offset of the first slot
+#define FRAME_BUS_FORMAT_RGB24 1
+
+// Largest control message (RESULT messages carry the detection JSON)
+#define FRAME_BUS_MAX_MESSAGE  65536
+
+// Return value of frame_bus_publish() when no detector is attached to the stream
+#define FRAME_BUS_NO_SUBSCRIBER 1
+
+/**
+ * Ring header at offset 0 of the memfd
+ */
+typedef struct {
+    uint32_t magic;             // FRAME_BUS_MAGIC
+    uint32_t version;           // FRAME_BUS_VERSION
+    uint32_t slot_count;        // Number of frame slots
+    uint32_t slot_stride;       // Bytes from one slot header to the next
+    uint32_t max_frame_bytes;   // Pixel capacity of one slot
+    uint32_t reserved;
+    uint64_t write_seq;         // Newest complete frame (0 = none yet); accessed atomically
+    char stream_name[64];       // Stream the ring belongs to
+} frame_bus_header_t;
+
+/**
+ * Slot header, followed by `size` bytes of pixel data
+ */
+typedef struct {
+    uint32_t gen;               // Seqlock generation, odd while being written; accessed atomically
+    uint32_t format;            // FRAME_BUS_FORMAT_RGB24
+    uint64_t seq;               // Frame sequence number (starts at 1)
+    uint64_t timestamp_us;      // Capture time, microseconds since the epoch
+    uint32_t width;
+    uint32_t height;
+    uint32_t stride;            // Bytes per pixel row
+    uint32_t size;              // Bytes of pixel data
+    uint8_t reserved[24];
+} frame_bus_slot_t;
+
+/**
+ * Result callback, invoked on the frame bus thread
+ *
+ * @param stream_name Stream the result belongs to
+ * @param seq Sequence number of the frame the detector analyzed
+ * @param json NUL-terminated detection JSON, valid only during the call
+ * @param json_len Length of json
+ * @param user_data Value passed to frame_bus_set_result_handler()
+ */
+typedef void (*frame_bus_result_cb)(const char *stream_name, uint64_t seq,
+                                    const char *json, size_t json_len, void *user_data);
+
+/**
+ * Create the control socket and start the frame bus thread
+ *
+ * @param socket_path Path of the Unix socket detectors connect to
+ * @param slot_count Frame slots per stream ring
+ * @param max_frame_bytes Pixel capacity of one slot
+ * @return 0 on success (or if already running), -1 on error
+ */
+int frame_bus_init(const char *socket_path, int slot_count, size_t max_frame_bytes);
+
+/**
+ * Stop the frame bus thread, disconnect all detectors and unmap all rings
+ */
+void frame_bus_shutdown(void);
+
+/**
+ * Check whether the frame bus is running
+ */
+bool frame_bus_is_running(void);
+
+/**
+ * Get the pixel capacity of one slot (0 if the bus is not running)
+ */
+size_t frame_bus_max_frame_bytes(void);
+
+/**
+ * Check whether at least one detector is attached to a stream
+ */
+bool frame_bus_has_subscriber(const char *stream_name);
+
+/**
+ * Publish an RGB24 frame to a stream's ring and wake its detectors
+ *
+ * @param stream_name Stream name
+ * @param rgb Packed RGB24 pixels (width * 3 bytes per row)
+ * @param width Frame width
+ * @param height Frame height
+ * @param seq_out Optional output: sequence number of the published frame
+ * @return 0 on success, FRAME_BUS_NO_SUBSCRIBER if nobody would read the
+ *         frame (nothing is copied), -1 on error or if the frame exceeds
+ *         the slot capacity
+ */
+int frame_bus_publish(const char *stream_name, const uint8_t *rgb, int width, int height,
+                      uint64_t *seq_out);
+
+/**
+ * Register the callback that receives a stream's detection results
+ *
+ * Creates the stream's ring if needed. Replaces any previous handler.
+ *
+ * @return 0 on success, -1 on error
+ */
+int frame_bus_set_result_handler(const char *stream_name, frame_bus_result_cb callback,
+                                 void *user_data);
+
+/**
+ * Remove a stream's result handler
+ *
+ * No callback for the stream runs after this returns, so the caller may
+ * free the handler's user_data.
+ */
+void frame_bus_clear_result_handler(const char *stream_name);
+
+#endif /* LIGHTNVR_FRAME_BUS_H */
@@ -0,0 +1,141 @@
+/**
+ * @file model_registry.h
+ * @brief Shared, reference-counted detection model versions
+ *
+ * Streams that run the same model file with the same threshold share one
+ * loaded copy of its weights. The registry keys models by path and
+ * threshold and hands out versions: the shared, read-only part of a model
+ * as it was loaded from one revision of its file. Each detection handle
+ * keeps its own mutable state (activations, scratch buffers) built on top
+ * of a version, so streams never serialize on a shared network.
+ *
+ * Models can be replaced while streams run. When the file on disk changes
+ * (different inode, size or mtime), the next check loads it as a new
+ * version; each handle moves to it on its own detection thread and the old
+ * version is freed once the last handle has left it. Files should be
+ * replaced by renaming a complete new file over the old one.
+ *
+ * The registry is backend agnostic: callers supply the functions that load
+ * and free the shared part.
+ */
+
+#ifndef LIGHTNVR_MODEL_REGISTRY_H
+#define LIGHTNVR_MODEL_REGISTRY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "core/config.h"
+
+// Distinct (path, threshold) models loaded at once
+#define MODEL_REGISTRY_MAX_ENTRIES 16
+
+/**
+ * Load the shared part of a model version
+ *
+ * @param path Model file path
+ * @param threshold Detection threshold the model is registered with
+ * @return Shared data, or NULL on failure
+ */
+typedef void *(*model_version_load_fn)(const char *path, float threshold);
+
+/**
+ * Free the shared part of a version once no handle uses it
+ */
+typedef void (*model_version_free_fn)(void *shared);
+
+typedef struct model_version model_version_t;
+
+/**
+ * Per-model registry statistics
+ */
+typedef struct {
+    char path[MAX_PATH_LENGTH];
+    float threshold;
+    int handles;                // Handles currently attached to any version
+    int versions;               // Versions alive (more than 1 while a reload drains)
+    unsigned int generation;    // Generation of the current version, 1 for the first load
+    uint64_t reloads;           // Successful hot reloads
+    uint64_t reload_failures;   // Changed files that failed to load
+} model_registry_stats_t;
+
+/**
+ * Attach a handle to the current version of a model, loading it if needed
+ *
+ * Concurrent first acquires of the same model wait for a single load.
+ *
+ * @param path Model file path
+ * @param threshold Detection threshold (part of the key)
+ * @param load Loader for the shared part
+ * @param free_fn Destructor for the shared part
+ * @return Version, or NULL if the model could not be loaded
+ */
+model_version_t *model_registry_acquire(const char *path, float threshold,
+                                        model_version_load_fn load, model_version_free_fn free_fn);
+
+/**
+ * Detach a handle from a version
+ *
+ * Frees the version when it is no longer current and this was its last
+ * handle, and forgets the model when no handle uses it any more.
+ */
+void model_registry_release(model_version_t *version);
+
+/**
+ * Check whether a handle's version has been superseded
+ *
+ * Stats the model file at most every [models] reload_interval seconds and
+ * loads it as a new version when it changed. Called from the handle's own
+ * detection thread before each detection.
+ *
+ * @param version Version the handle is attached to
+ * @return The newer version, already acquired for the caller, who must
+ *         rebuild its state on it and release the old one; NULL otherwise
+ */
+model_version_t *model_registry_check_update(model_version_t *version);
+
+/**
+ * Force the next check of a model to reload it, even if its file looks
+ * unchanged
+ *
+ * @param path Model file path
+ * @return Number of registered models (thresholds) for the path
+ */
+int model_registry_reload(const char *path);
+
+/**
+ * Get the shared part of a version
+ */
+void *model_version_shared(const model_version_t *version);
+
+/**
+ * Claim the version's shared instance for exclusive use by one handle
+ *
+ * Backends whose shared part is itself a usable instance (the SOD CNN the
+ * weights were loaded into) let the first handle run on it instead of
+ * building a private copy of the mutable state.
+ *
+ * @return true if the caller now owns the shared instance
+ */
+bool model_version_claim(model_version_t *version);
+
+/**
+ * Give back a claimed shared instance
+ */
+void model_version_unclaim(model_version_t *version);
+
+/**
+ * Get the generation of a version (1 for the first load of a model)
+ */
+unsigned int model_version_generation(const model_version_t *version);
+
+/**
+ * Get statistics for the registered models
+ *
+ * @param stats Output array
+ * @param max Capacity of stats
+ * @return Number of entries written
+ */
+int model_registry_get_stats(model_registry_stats_t *stats, int max);
+
+#endif /* LIGHTNVR_MODEL_REGISTRY_H */
@@ -60,6 +60,7 @@ typedef struct {
     time_t last_retry_time;   // Time of the last retry attempt
     bool auto_restart;        // Whether to automatically restart on failure
     atomic_int force_reconnect;  // Flag to signal forced reconnection (e.g., after go2rtc restart)
+    atomic_int config_changed;   // Set when the stream configuration changed; the thread reloads it
 
     // Per-stream FFmpeg context and segment info (BUGFIX: moved from global static variables)
     struct AVFormatContext *input_ctx;  // Input context for this stream (reused between segments)
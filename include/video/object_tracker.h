@@ -0,0 +1,60 @@
+#ifndef OBJECT_TRACKER_H
+#define OBJECT_TRACKER_H
+
+#include <stdbool.h>
+#include <time.h>
+#include "video/detection_result.h"
+
+/**
+ * Per-stream multi-object tracker
+ *
+ * A SORT-style tracker: every track carries a constant-velocity Kalman filter
+ * over its box center and size, and each analyzed frame is associated to the
+ * predicted boxes by IoU (same label only). Tracks get a stable track_id, and
+ * instead of storing every box of every frame the pipeline only persists and
+ * publishes track lifecycle events:
+ *
+ *   TRACK_EVENT_START   first frame of a new track
+ *   TRACK_EVENT_UPDATE  the box moved away from the last stored one, or
+ *                       `track_update_interval` seconds passed since then
+ *   TRACK_EVENT_END     the track went unmatched for more than
+ *                       `track_max_misses` analyzed frames (last known box)
+ *
+ * Detections that already carry a track_id (e.g. from an external detection
+ * API with its own tracker) keep it; only the event logic is applied to them.
+ */
+
+/**
+ * Run one analyzed frame of a stream through its tracker
+ *
+ * Call this for every analyzed frame, including frames without detections,
+ * so lost tracks can be ended. Detections in `result` get their track_id
+ * filled in. `events` receives the detections that should be stored and
+ * published, each with its track_event set. When tracking is disabled in
+ * the configuration, `events` is a plain copy of `result`.
+ *
+ * @param stream_name Stream the frame belongs to
+ * @param result Detections of the frame (track_id updated in place)
+ * @param now Frame timestamp
+ * @param events Output: track events to store/publish
+ * @return 0 on success, -1 on error (events is then a copy of result)
+ */
+int object_tracker_process(const char *stream_name, detection_result_t *result,
+                           time_t now, detection_result_t *events);
+
+/**
+ * Drop all tracks of a stream without emitting end events
+ *
+ * @param stream_name Stream name, or NULL for all streams
+ */
+void object_tracker_reset(const char *stream_name);
+
+/**
+ * Get a printable name for a track event ("start", "update", "end")
+ *
+ * @param event Track event
+ * @return Static string, or NULL for TRACK_EVENT_NONE
+ */
+const char *track_event_name(track_event_t event);
+
+#endif /* OBJECT_TRACKER_H */
@@ -0,0 +1,87 @@
+/**
+ * @file snapshot_cache.h
+ * @brief Per-stream cache of the latest JPEG snapshot
+ *
+ * API detection, the MQTT Home Assistant snapshots and the web UI all want
+ * "the current picture" of a camera. Each used to fetch its own JPEG from
+ * go2rtc, which decodes the stream for every request. The cache keeps the
+ * newest JPEG of every stream in memory and serves it to all of them while
+ * it is younger than [go2rtc] snapshot_max_age_ms.
+ *
+ * When the cached JPEG is too old, one caller fetches a new one from go2rtc
+ * and concurrent callers for the same stream wait for that fetch instead of
+ * starting their own. Frames that lightNVR already decoded and encoded
+ * itself (the API detection fallback) are stored as well.
+ *
+ * Snapshots are reference counted and immutable, so callers read them
+ * without copying.
+ */
+
+#ifndef LIGHTNVR_SNAPSHOT_CACHE_H
+#define LIGHTNVR_SNAPSHOT_CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * A cached JPEG
+ */
+typedef struct {
+    unsigned char *data;
+    size_t size;
+    int64_t captured_ms;        // Monotonic time the JPEG was produced
+    int refs;                   // Owned by the cache; do not touch
+} snapshot_t;
+
+/**
+ * Snapshot cache counters
+ */
+typedef struct {
+    uint64_t hits;              // Requests served from memory
+    uint64_t coalesced;         // Requests that waited for another caller's fetch
+    uint64_t fetches;           // JPEGs fetched from go2rtc
+    uint64_t fetch_failures;
+    uint64_t stored;            // JPEGs stored from locally decoded frames
+} snapshot_cache_stats_t;
+
+/**
+ * Get a recent snapshot of a stream
+ *
+ * @param stream_name Stream name
+ * @param max_age_ms Oldest acceptable snapshot in milliseconds, or -1 for
+ *                   [go2rtc] snapshot_max_age_ms
+ * @return Snapshot to be released with snapshot_release(), or NULL if none
+ *         could be fetched
+ */
+snapshot_t *snapshot_cache_get(const char *stream_name, int max_age_ms);
+
+/**
+ * Release a snapshot returned by snapshot_cache_get()
+ */
+void snapshot_release(snapshot_t *snapshot);
+
+/**
+ * Store a JPEG produced from a decoded frame as the stream's newest snapshot
+ *
+ * @param stream_name Stream name
+ * @param jpeg JPEG data (copied)
+ * @param size Size of the JPEG data
+ */
+void snapshot_cache_put(const char *stream_name, const unsigned char *jpeg, size_t size);
+
+/**
+ * Forget the cached snapshot of a stream
+ */
+void snapshot_cache_remove(const char *stream_name);
+
+/**
+ * Get the cache counters
+ */
+void snapshot_cache_get_stats(snapshot_cache_stats_t *stats);
+
+/**
+ * Free all cached snapshots
+ */
+void snapshot_cache_cleanup(void);
+
+#endif /* LIGHTNVR_SNAPSHOT_CACHE_H */
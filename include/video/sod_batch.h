@@ -0,0 +1,74 @@
+#ifndef SOD_BATCH_H
+#define SOD_BATCH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "video/detection_result.h"
+
+/**
+ * Cross-stream batched SOD CNN inference
+ *
+ * When several streams run the same .sod model, each detection thread would
+ * normally load its own copy of the network and run a forward pass per frame.
+ * With batching enabled, all streams sharing a model path submit frames to a
+ * single network owned by a batch worker. The worker waits until either
+ * `batch_size` frames are queued or the oldest frame has waited
+ * `batch_latency_ms`, then runs them through one sod_cnn_predict_batch() pass
+ * and hands each caller its own detections.
+ */
+
+/**
+ * Initialize the batching system
+ *
+ * @param max_batch Maximum frames per forward pass (<= 1 disables batching)
+ * @param max_latency_ms Maximum time a frame waits for the batch to fill
+ * @return 0 on success, non-zero on failure
+ */
+int init_sod_batch_system(int max_batch, int max_latency_ms);
+
+/**
+ * Stop all batch workers and free their networks
+ * Callers still waiting on a result are released with an error.
+ */
+void shutdown_sod_batch_system(void);
+
+/**
+ * Check whether cross-stream batching is active
+ *
+ * @return true if SOD models should be routed through the batcher
+ */
+bool sod_batch_enabled(void);
+
+/**
+ * Load the shared network for a model path if it is not loaded yet
+ *
+ * @param model_path Path to the .sod model file
+ * @return 0 on success, non-zero on failure
+ */
+int sod_batch_acquire(const char *model_path);
+
+/**
+ * Run detection on a frame through the shared batch worker for a model
+ * Blocks until the batch containing this frame has been processed.
+ *
+ * @param model_path Path to the .sod model file
+ * @param threshold Detection confidence threshold for this caller
+ * @param frame_data Packed HWC frame data
+ * @param width Frame width
+ * @param height Frame height
+ * @param channels Number of color channels
+ * @param result Pointer to detection result structure to fill
+ * @return 0 on success, non-zero on failure
+ */
+int sod_batch_detect(const char *model_path, float threshold, const unsigned char *frame_data,
+                     int width, int height, int channels, detection_result_t *result);
+
+/**
+ * Get cumulative batching statistics
+ *
+ * @param frames Output: frames processed through the batcher (may be NULL)
+ * @param passes Output: forward passes run (may be NULL)
+ */
+void sod_batch_get_stats(uint64_t *frames, uint64_t *passes);
+
+#endif /* SOD_BATCH_H */
@@ -5,6 +5,8 @@
 #include "video/detection_result.h"
 #include "video/detection_model.h"
 
+struct sod_box;
+
 /**
  * Initialize the SOD detection system
  *
@@ -40,6 +42,47 @@ detection_model_t load_sod_model(const char *model_path, float threshold);
 int detect_with_sod_model(detection_model_t model, const unsigned char *frame_data,
                          int width, int height, int channels, detection_result_t *result);
 
+/**
+ * Pick the built-in SOD CNN architecture (":face" or ":voc") for a model file
+ *
+ * @param model_path Path to the model file
+ * @return Architecture string to pass to sod_cnn_create()
+ */
+const char *get_sod_model_arch(const char *model_path);
+
+/**
+ * Check whether a model path names an INT8 quantized SOD model
+ * INT8 files are produced by sod_quantize and use the ".int8.sod" suffix.
+ *
+ * @param model_path Path to the model file
+ * @return true if the path has the ".int8.sod" suffix
+ */
+bool is_sod_int8_model(const char *model_path);
+
+/**
+ * Convert packed HWC 0-255 frame data into a CHW 0-1 float buffer
+ *
+ * @param frame_data Frame data
+ * @param width Frame width
+ * @param height Frame height
+ * @param channels Number of color channels
+ * @param out Output buffer of width * height * channels floats
+ */
+void sod_frame_to_chw(const unsigned char *frame_data, int width, int height, int channels, float *out);
+
+/**
+ * Convert SOD CNN boxes into normalized detections
+ *
+ * @param boxes Boxes returned by the network, in frame pixel coordinates
+ * @param count Number of boxes
+ * @param width Frame width
+ * @param height Frame height
+ * @param threshold Minimum confidence to keep a box
+ * @param result Pointer to detection result structure to fill
+ */
+void sod_boxes_to_detection_result(const struct sod_box *boxes, int count, int width, int height,
+                                   float threshold, detection_result_t *result);
+
 /**
  * Check if SOD is available
  *
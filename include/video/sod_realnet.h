@@ -23,7 +23,7 @@ void free_sod_realnet_model(void *model);
  * Run detection on a frame using SOD RealNet
  * 
  * @param model SOD RealNet model handle
- * @param frame_data Frame data (grayscale for RealNet)
+ * @param frame_data Packed frame data (grayscale, or RGB which is converted to grayscale)
  * @param width Frame width
  * @param height Frame height
  * @param channels Number of color channels (1 for grayscale)
@@ -33,4 +33,21 @@ void free_sod_realnet_model(void *model);
 int detect_with_sod_realnet(void *model, const unsigned char *frame_data, 
                            int width, int height, int channels, detection_result_t *result);
 
+/**
+ * Run detection on a strided 8-bit luma plane without copying it
+ *
+ * Suitable for the Y plane of a decoded AVFrame (frame->data[0] with
+ * frame->linesize[0] as the stride). The plane is only read.
+ *
+ * @param model SOD RealNet model handle
+ * @param luma First row of the luma plane
+ * @param width Frame width
+ * @param height Frame height
+ * @param stride Bytes between the starts of consecutive rows (>= width)
+ * @param result Pointer to detection result structure to fill
+ * @return 0 on success, non-zero on failure
+ */
+int detect_with_sod_realnet_luma(void *model, const unsigned char *luma,
+                                 int width, int height, int stride, detection_result_t *result);
+
 #endif /* SOD_REALNET_H */
@@ -24,12 +24,20 @@
 #include "core/config.h"
 #include "video/packet_buffer.h"
 #include "video/detection_model.h"
+#include "video/detection_cascade.h"
 #include "video/mp4_writer.h"
+#include "video/detection_result.h"
 #include "video/stream_manager.h"
 
 // Maximum number of unified detection threads
 #define MAX_UNIFIED_DETECTION_THREADS MAX_STREAMS
 
+// Completed asynchronous API detections buffered between two packets
+#define UDT_API_RESULT_SLOTS 4
+
+// Peak motion scores remembered by the adaptive detection rate
+#define UDT_MOTION_SCORE_HISTORY 8
+
 /**
  * Thread state machine states
  */
@@ -65,8 +73,12 @@ typedef struct {
     // Detection configuration
     char model_path[MAX_PATH_LENGTH];
     detection_model_t model;
+    bool is_cascade;                   // model_path is a "cascade:..." string
+    detection_cascade_t cascade;       // Parsed cascade stages
+    detection_model_t cascade_models[DETECTION_CASCADE_MAX_STAGES];  // Loaded on first use
     float detection_threshold;
     int detection_interval;  // Seconds between detection checks
+    atomic_int config_changed;  // Set by the stream configuration listener, applied by the UDT thread
     
     // Buffer configuration
     int pre_buffer_seconds;   // Seconds to keep before detection
@@ -85,6 +97,10 @@ typedef struct {
     atomic_llong last_detection_time;      // When last detection occurred (stored as atomic epoch seconds)
     atomic_llong last_detection_check_time; // When last detection check was attempted (for time-based interval)
     atomic_llong post_buffer_end_time;     // When post-buffer recording should end
+    atomic_llong last_activity_time;       // Last detection, motion near miss or external trigger
+    atomic_int effective_interval;         // Detection interval currently applied (seconds)
+    float motion_scores[UDT_MOTION_SCORE_HISTORY]; // Peak motion score of recent checks (UDT thread only)
+    int motion_score_next;
     atomic_int log_counter;          // Counter for periodic logging; intentionally accessed without ctx->mutex,
                                      // but all accesses must use atomic operations, and exact accuracy is not critical.
     
@@ -138,6 +154,21 @@ typedef struct {
     char onvif_username_cached[64];
     char onvif_password_cached[64];
 
+    // -------------------------------------------------------------------------
+    // Asynchronous API detection
+    // -------------------------------------------------------------------------
+    // With [api_detection] async enabled the UDT only queues the snapshot on
+    // the shared API detection client and keeps reading packets. The client
+    // worker parses each completed response into api_results (under ctx->mutex)
+    // and raises api_results_ready; the UDT main loop drains the mailbox and
+    // runs the results through the same pipeline as synchronous detections.
+    // Results of local detectors on the frame bus ("frame-bus" model) use the
+    // same mailbox. api_detection_client_cancel() and
+    // frame_bus_clear_result_handler() are called before ctx is freed.
+    detection_result_t api_results[UDT_API_RESULT_SLOTS];
+    int api_result_count;
+    atomic_int api_results_ready;
+
     // FFmpeg contexts (managed exclusively by the unified detection thread).
     // Concurrency / lifetime:
     // - These pointers and stream indices are created, updated, and freed only
@@ -280,12 +311,18 @@ int get_unified_detection_reconnect_attempts(const char *stream_name);
  * @param packets_processed Output: total packets processed
  * @param detections Output: total detections
  * @param recordings Output: total recordings created
+ * @param detection_interval Output: configured seconds between detection checks
+ * @param effective_interval Output: seconds between checks currently applied,
+ *                           larger than detection_interval while the adaptive
+ *                           rate has slowed a quiet stream down
  * @return 0 on success, -1 if not found
  */
 int get_unified_detection_stats(const char *stream_name,
                                 uint64_t *packets_processed,
                                 uint64_t *detections,
-                                uint64_t *recordings);
+                                uint64_t *recordings,
+                                int *detection_interval,
+                                int *effective_interval);
 
 /**
  * Notify a UDT-managed stream of an externally-detected motion event.
@@ -294,6 +331,8 @@ int get_unified_detection_stats(const char *stream_name,
  * event must be propagated to a slave stream that is managed by a UDT
  * (e.g. the PTZ lens on a dual-lens camera).  The UDT thread polls
  * ctx->external_motion_trigger and reacts on the next packet boundary.
+ * Motion also returns a stream slowed down by the adaptive detection rate
+ * to its configured interval.
  *
  * @param stream_name   Name of the slave stream (must be running as a UDT)
  * @param motion_active true  = motion started / ongoing
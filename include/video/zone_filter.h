@@ -7,7 +7,8 @@
  * Filter detections based on configured zones for a stream
  *
  * This function:
- * 1. Loads zones for the stream from the database
+ * 1. Looks up the stream's compiled zones, loading them from the database
+ *    only when the zone table has changed since they were compiled
  * 2. Filters detections to only include those within enabled zones
  * 3. Applies per-zone class filters and confidence thresholds
  * 4. Sets the zone_id field for each accepted detection
@@ -52,5 +53,27 @@ int filter_detections_by_stream_objects(const char *stream_name, detection_resul
  */
 int build_motion_zone_mask(const char *stream_name, int grid_size, bool *zone_mask);
 
+/**
+ * Get the bounding boxes of a stream's enabled zones.
+ *
+ * Boxes are in normalized 0-1 coordinates, labelled "zone" and carry the
+ * zone id.
+ *
+ * @param stream_name Stream name to load zones for
+ * @param boxes       Output, one detection per enabled zone
+ * @return Number of boxes (0 means no enabled zones), -1 on error
+ */
+int get_zone_bounding_boxes(const char *stream_name, detection_result_t *boxes);
+
+/**
+ * Drop compiled zones held by the zone filter.
+ *
+ * Zone writes through db_zones.c are picked up automatically; this is only
+ * needed when the detection_zones table is modified by other means.
+ *
+ * @param stream_name Stream to drop, or NULL for all streams
+ */
+void invalidate_zone_filter_cache(const char *stream_name);
+
 #endif /* LIGHTNVR_ZONE_FILTER_H */
 
@@ -52,6 +52,13 @@ void handle_delete_stream(const http_request_t *req, http_response_t *res);
  */
 void handle_post_stream_refresh(const http_request_t *req, http_response_t *res);
 
+/**
+ * @brief Handler for GET /api/streams/:id/snapshot
+ *
+ * Serves the stream's current picture as a JPEG from the snapshot cache.
+ */
+void handle_get_stream_snapshot(const http_request_t *req, http_response_t *res);
+
 /**
  * @brief Handler for GET /api/settings
  */
@@ -97,6 +104,11 @@ void handle_get_detection_results(const http_request_t *req, http_response_t *re
  */
 void handle_get_detection_models(const http_request_t *req, http_response_t *res);
 
+/**
+ * @brief Handler for GET /api/detection/rollups/:stream
+ */
+void handle_get_detection_rollups(const http_request_t *req, http_response_t *res);
+
 /**
  * @brief Handler for direct HLS requests
  * Endpoint: /hls/{stream_name}/{file}
@@ -18,6 +18,7 @@
 #include "core/logger.h"
 #include "core/path_utils.h"
 #include "database/database_manager.h"
+#include "storage/storage_cleanup_pool.h"
 #include "utils/strings.h"
 
 // Global configuration variable
@@ -323,6 +324,8 @@ void load_default_config(config_t *config) {
     config->max_storage_size = 0; // 0 means unlimited
     config->retention_days = 30;
     config->auto_delete_oldest = true;
+    config->cleanup_workers = 4;
+    config->cleanup_io_priority = CLEANUP_IO_PRIORITY_LOW;
 
     // Thumbnail/grid view settings
     config->generate_thumbnails = true;
@@ -336,22 +339,61 @@ void load_default_config(config_t *config) {
 
     // Models settings
     safe_strcpy(config->models_path, "/var/lib/lightnvr/models", MAX_PATH_LENGTH, 0);
+    config->sod_batch_max_size = 1;        // Cross-stream batching disabled by default
+    config->sod_batch_max_latency_ms = 50;
+    config->sod_threads = 0;               // Use all online CPUs
+    config->roi_cropping = true;
+    config->roi_max_regions = 4;
+    config->roi_padding = 20;
+    config->roi_max_coverage = 60;
+    config->mmap_model_weights = false;
+    config->model_reload_interval = 10;
     
     // API detection settings
     safe_strcpy(config->api_detection_url, "http://localhost:8000/detect", MAX_URL_LENGTH, 0);
     safe_strcpy(config->api_detection_backend, "onnx", 32, 0); // Default to ONNX backend
+    config->api_detection_async = true;
+    config->api_detection_max_inflight = 2;
+
+    // Frame bus settings
+    config->frame_bus_enabled = false;
+    safe_strcpy(config->frame_bus_socket_path, "/var/run/lightnvr/frame_bus.sock", MAX_PATH_LENGTH, 0);
+    config->frame_bus_slots = 4;
+    config->frame_bus_max_width = 1280;
+    config->frame_bus_max_height = 720;
 
     // Global detection defaults
     config->default_detection_threshold = 50;  // 50% confidence threshold
     config->default_pre_detection_buffer = 5;   // 5 seconds before detection
     config->default_post_detection_buffer = 10; // 10 seconds after detection
     safe_strcpy(config->default_buffer_strategy, "auto", 32, 0); // Auto-select buffer strategy
+    config->tracking_enabled = true;
+    config->track_update_interval = 10;         // Below the 30 s live overlay window
+    config->track_max_misses = 3;
+    config->adaptive_detection_interval = false;
+    config->adaptive_quiet_period = 120;
+    config->adaptive_max_factor = 4;
 
     // Database settings
     safe_strcpy(config->db_path, "/var/lib/lightnvr/lightnvr.db", MAX_PATH_LENGTH, 0);
     config->db_backup_interval_minutes = 60;
     config->db_backup_retention_count = 24;
     config->db_post_backup_script[0] = '\0';
+    config->db_backup_step_pages = 256;
+    config->db_backup_step_sleep_ms = 20;
+    config->db_backup_max_mb_per_sec = 0;
+    config->db_backup_compress = false;
+    config->db_checkpoint_interval_seconds = 30;
+    config->db_checkpoint_idle_writes = 50;
+    config->db_checkpoint_max_deferrals = 10;
+    config->db_wal_truncate_mb = 16;
+    config->db_wal_autocheckpoint_pages = 10000;
+    config->db_incremental_vacuum_pages = 256;
+    config->db_read_connections = 4;
+    config->db_write_queue = true;
+    config->db_write_batch_interval_ms = 250;
+    config->db_write_batch_max_rows = 200;
+    config->db_write_queue_capacity = 4096;
     
     // Web server settings
     config->web_port = 8080;
@@ -367,6 +409,7 @@ void load_default_config(config_t *config) {
     config->auth_timeout_hours = 24; // Default session idle timeout: 24 hours
     config->auth_absolute_timeout_hours = 168; // Default absolute session lifetime: 7 days
     config->trusted_device_days = 30; // Default trusted-device lifetime: 30 days
+    config->auth_cache_ttl_seconds = 30; // Reuse verified credentials for 30 seconds
     config->trusted_proxy_cidrs[0] = '\0';
     config->demo_mode = false; // Demo mode disabled by default
 
@@ -416,6 +459,7 @@ void load_default_config(config_t *config) {
     config->go2rtc_rtsp_port = 8554;  // Default RTSP listen port
     config->go2rtc_force_native_hls = false;  // Use go2rtc HLS by default
     config->go2rtc_proxy_max_inflight = 16;  // Default: 16 concurrent proxy requests
+    config->go2rtc_snapshot_max_age_ms = 1000;
 
     // go2rtc WebRTC settings for NAT traversal
     config->go2rtc_webrtc_enabled = true;  // Enable WebRTC by default
@@ -559,6 +603,100 @@ int validate_config(config_t *config) {
         return -1;
     }
 
+    if (config->sod_batch_max_size < 1 || config->sod_batch_max_size > 16) {
+        log_warn("models batch_size (%d) out of range [1, 16]; clamping",
+                 config->sod_batch_max_size);
+        config->sod_batch_max_size = config->sod_batch_max_size < 1 ? 1 : 16;
+    }
+
+    if (config->sod_batch_max_latency_ms < 1 || config->sod_batch_max_latency_ms > 1000) {
+        log_warn("models batch_latency_ms (%d) out of range [1, 1000]; clamping",
+                 config->sod_batch_max_latency_ms);
+        config->sod_batch_max_latency_ms = config->sod_batch_max_latency_ms < 1 ? 1 : 1000;
+    }
+
+    if (config->sod_threads < 0 || config->sod_threads > 16) {
+        log_warn("models threads (%d) out of range [0, 16]; clamping", config->sod_threads);
+        config->sod_threads = config->sod_threads < 0 ? 0 : 16;
+    }
+
+    if (config->roi_max_regions < 1 || config->roi_max_regions > 8) {
+        log_warn("models roi_max_regions (%d) out of range [1, 8]; clamping", config->roi_max_regions);
+        config->roi_max_regions = config->roi_max_regions < 1 ? 1 : 8;
+    }
+
+    if (config->roi_padding < 0 || config->roi_padding > 100) {
+        log_warn("models roi_padding (%d) out of range [0, 100]; clamping", config->roi_padding);
+        config->roi_padding = config->roi_padding < 0 ? 0 : 100;
+    }
+
+    if (config->roi_max_coverage < 10 || config->roi_max_coverage > 100) {
+        log_warn("models roi_max_coverage (%d) out of range [10, 100]; clamping", config->roi_max_coverage);
+        config->roi_max_coverage = config->roi_max_coverage < 10 ? 10 : 100;
+    }
+
+    if (config->model_reload_interval < 0 || config->model_reload_interval > 3600) {
+        log_warn("models reload_interval (%d) out of range [0, 3600]; clamping", config->model_reload_interval);
+        config->model_reload_interval = config->model_reload_interval < 0 ? 0 : 3600;
+    }
+
+    if (config->api_detection_max_inflight < 1 || config->api_detection_max_inflight > 16) {
+        log_warn("api_detection max_inflight (%d) out of range [1, 16]; clamping",
+                 config->api_detection_max_inflight);
+        config->api_detection_max_inflight = config->api_detection_max_inflight < 1 ? 1 : 16;
+    }
+
+    if (config->frame_bus_slots < 2 || config->frame_bus_slots > 16) {
+        log_warn("frame_bus slots (%d) out of range [2, 16]; clamping", config->frame_bus_slots);
+        config->frame_bus_slots = config->frame_bus_slots < 2 ? 2 : 16;
+    }
+
+    if (config->frame_bus_max_width < 64 || config->frame_bus_max_width > 3840) {
+        log_warn("frame_bus max_width (%d) out of range [64, 3840]; clamping", config->frame_bus_max_width);
+        config->frame_bus_max_width = config->frame_bus_max_width < 64 ? 64 : 3840;
+    }
+
+    if (config->frame_bus_max_height < 64 || config->frame_bus_max_height > 2160) {
+        log_warn("frame_bus max_height (%d) out of range [64, 2160]; clamping", config->frame_bus_max_height);
+        config->frame_bus_max_height = config->frame_bus_max_height < 64 ? 64 : 2160;
+    }
+
+    if (config->track_update_interval < 1 || config->track_update_interval > 3600) {
+        log_warn("api_detection track_update_interval (%d) out of range [1, 3600]; clamping",
+                 config->track_update_interval);
+        config->track_update_interval = config->track_update_interval < 1 ? 1 : 3600;
+    }
+
+    if (config->track_max_misses < 0 || config->track_max_misses > 100) {
+        log_warn("api_detection track_max_misses (%d) out of range [0, 100]; clamping",
+                 config->track_max_misses);
+        config->track_max_misses = config->track_max_misses < 0 ? 0 : 100;
+    }
+
+    if (config->go2rtc_snapshot_max_age_ms < 0 || config->go2rtc_snapshot_max_age_ms > 60000) {
+        log_warn("go2rtc snapshot_max_age_ms (%d) out of range [0, 60000]; clamping",
+                 config->go2rtc_snapshot_max_age_ms);
+        config->go2rtc_snapshot_max_age_ms = config->go2rtc_snapshot_max_age_ms < 0 ? 0 : 60000;
+    }
+
+    if (config->adaptive_quiet_period < 10 || config->adaptive_quiet_period > 86400) {
+        log_warn("api_detection adaptive_quiet_period (%d) out of range [10, 86400]; clamping",
+                 config->adaptive_quiet_period);
+        config->adaptive_quiet_period = config->adaptive_quiet_period < 10 ? 10 : 86400;
+    }
+
+    if (config->adaptive_max_factor < 1 || config->adaptive_max_factor > 32) {
+        log_warn("api_detection adaptive_max_factor (%d) out of range [1, 32]; clamping",
+                 config->adaptive_max_factor);
+        config->adaptive_max_factor = config->adaptive_max_factor < 1 ? 1 : 32;
+    }
+
+    if (config->cleanup_workers < 1 || config->cleanup_workers > CLEANUP_POOL_MAX_WORKERS) {
+        log_warn("storage cleanup_workers (%d) out of range [1, %d]; clamping",
+                 config->cleanup_workers, CLEANUP_POOL_MAX_WORKERS);
+        config->cleanup_workers = config->cleanup_workers < 1 ? 1 : CLEANUP_POOL_MAX_WORKERS;
+    }
+
     if (config->db_backup_interval_minutes < 0) {
         log_warn("db_backup_interval_minutes (%d) is negative; clamping to 0",
                  config->db_backup_interval_minutes);
@@ -570,6 +708,93 @@ int validate_config(config_t *config) {
                  config->db_backup_retention_count);
         config->db_backup_retention_count = 0;
     }
+
+    if (config->db_backup_step_pages < 1 || config->db_backup_step_pages > 65536) {
+        log_warn("database backup_step_pages (%d) out of range [1, 65536]; clamping",
+                 config->db_backup_step_pages);
+        config->db_backup_step_pages = config->db_backup_step_pages < 1 ? 1 : 65536;
+    }
+
+    if (config->db_backup_step_sleep_ms < 0 || config->db_backup_step_sleep_ms > 10000) {
+        log_warn("database backup_step_sleep_ms (%d) out of range [0, 10000]; clamping",
+                 config->db_backup_step_sleep_ms);
+        config->db_backup_step_sleep_ms = config->db_backup_step_sleep_ms < 0 ? 0 : 10000;
+    }
+
+    if (config->db_backup_max_mb_per_sec < 0) {
+        log_warn("database backup_max_mb_per_sec (%d) is negative; clamping to 0",
+                 config->db_backup_max_mb_per_sec);
+        config->db_backup_max_mb_per_sec = 0;
+    }
+
+    if (config->db_checkpoint_interval_seconds < 0 || config->db_checkpoint_interval_seconds > 3600) {
+        log_warn("database checkpoint_interval_seconds (%d) out of range [0, 3600]; clamping",
+                 config->db_checkpoint_interval_seconds);
+        config->db_checkpoint_interval_seconds = config->db_checkpoint_interval_seconds < 0 ? 0 : 3600;
+    }
+
+    if (config->db_checkpoint_idle_writes < 0) {
+        log_warn("database checkpoint_idle_writes (%d) is negative; clamping to 0",
+                 config->db_checkpoint_idle_writes);
+        config->db_checkpoint_idle_writes = 0;
+    }
+
+    if (config->db_checkpoint_max_deferrals < 0 || config->db_checkpoint_max_deferrals > 1000) {
+        log_warn("database checkpoint_max_deferrals (%d) out of range [0, 1000]; clamping",
+                 config->db_checkpoint_max_deferrals);
+        config->db_checkpoint_max_deferrals = config->db_checkpoint_max_deferrals < 0 ? 0 : 1000;
+    }
+
+    if (config->db_wal_truncate_mb < 0 || config->db_wal_truncate_mb > 4096) {
+        log_warn("database wal_truncate_mb (%d) out of range [0, 4096]; clamping",
+                 config->db_wal_truncate_mb);
+        config->db_wal_truncate_mb = config->db_wal_truncate_mb < 0 ? 0 : 4096;
+    }
+
+    if (config->db_wal_autocheckpoint_pages < 0 || config->db_wal_autocheckpoint_pages > 1000000) {
+        log_warn("database wal_autocheckpoint_pages (%d) out of range [0, 1000000]; clamping",
+                 config->db_wal_autocheckpoint_pages);
+        config->db_wal_autocheckpoint_pages = config->db_wal_autocheckpoint_pages < 0 ? 0 : 1000000;
+    }
+
+    // SQLite's own checkpoint keeps the WAL near wal_autocheckpoint_pages
+    // (4 KB pages), so a truncate threshold at or above that is never reached
+    int autocheckpoint_mb = (int)((int64_t)config->db_wal_autocheckpoint_pages * 4096 / (1024 * 1024));
+    if (config->db_wal_autocheckpoint_pages > 0 && config->db_wal_truncate_mb >= autocheckpoint_mb) {
+        int truncate_mb = autocheckpoint_mb / 2;
+        log_warn("database wal_truncate_mb (%d) is not below the %d MB WAL autocheckpoint size; using %d",
+                 config->db_wal_truncate_mb, autocheckpoint_mb, truncate_mb);
+        config->db_wal_truncate_mb = truncate_mb;
+    }
+
+    if (config->db_incremental_vacuum_pages < 0 || config->db_incremental_vacuum_pages > 65536) {
+        log_warn("database incremental_vacuum_pages (%d) out of range [0, 65536]; clamping",
+                 config->db_incremental_vacuum_pages);
+        config->db_incremental_vacuum_pages = config->db_incremental_vacuum_pages < 0 ? 0 : 65536;
+    }
+
+    if (config->db_read_connections < 0 || config->db_read_connections > 16) {
+        log_warn("database read_connections (%d) out of range [0, 16]; clamping", config->db_read_connections);
+        config->db_read_connections = config->db_read_connections < 0 ? 0 : 16;
+    }
+
+    if (config->db_write_batch_interval_ms < 10 || config->db_write_batch_interval_ms > 10000) {
+        log_warn("database write_batch_interval_ms (%d) out of range [10, 10000]; clamping",
+                 config->db_write_batch_interval_ms);
+        config->db_write_batch_interval_ms = config->db_write_batch_interval_ms < 10 ? 10 : 10000;
+    }
+
+    if (config->db_write_batch_max_rows < 1 || config->db_write_batch_max_rows > 10000) {
+        log_warn("database write_batch_max_rows (%d) out of range [1, 10000]; clamping",
+                 config->db_write_batch_max_rows);
+        config->db_write_batch_max_rows = config->db_write_batch_max_rows < 1 ? 1 : 10000;
+    }
+
+    if (config->db_write_queue_capacity < 16 || config->db_write_queue_capacity > 1000000) {
+        log_warn("database write_queue_capacity (%d) out of range [16, 1000000]; clamping",
+                 config->db_write_queue_capacity);
+        config->db_write_queue_capacity = config->db_write_queue_capacity < 16 ? 16 : 1000000;
+    }
     
     if (strlen(config->web_root) == 0) {
         log_error("Web root path is required");
@@ -644,6 +869,12 @@ static int config_ini_handler(void* user, const char* section, const char* name,
             config->retention_days = safe_atoi(value, 0);
         } else if (strcmp(name, "auto_delete_oldest") == 0) {
             config->auto_delete_oldest = (strcmp(value, "true") == 0 || strcmp(value, "1") == 0);
+        } else if (strcmp(name, "cleanup_workers") == 0) {
+            config->cleanup_workers = safe_atoi(value, 4);
+        } else if (strcmp(name, "cleanup_io_priority") == 0) {
+            if (strcmp(value, "normal") == 0) config->cleanup_io_priority = CLEANUP_IO_PRIORITY_NORMAL;
+            else if (strcmp(value, "idle") == 0) config->cleanup_io_priority = CLEANUP_IO_PRIORITY_IDLE;
+            else config->cleanup_io_priority = CLEANUP_IO_PRIORITY_LOW; // Default
         } else if (strcmp(name, "record_mp4_directly") == 0) {
             config->record_mp4_directly = (strcmp(value, "true") == 0 || strcmp(value, "1") == 0);
         } else if (strcmp(name, "mp4_path") == 0) {
@@ -663,6 +894,24 @@ static int config_ini_handler(void* user, const char* section, const char* name,
     else if (strcmp(section, "models") == 0) {
         if (strcmp(name, "path") == 0) {
             safe_strcpy(config->models_path, value, MAX_PATH_LENGTH, 0);
+        } else if (strcmp(name, "batch_size") == 0) {
+            config->sod_batch_max_size = safe_atoi(value, 1);
+        } else if (strcmp(name, "batch_latency_ms") == 0) {
+            config->sod_batch_max_latency_ms = safe_atoi(value, 50);
+        } else if (strcmp(name, "threads") == 0) {
+            config->sod_threads = safe_atoi(value, 0);
+        } else if (strcmp(name, "roi_cropping") == 0) {
+            config->roi_cropping = (strcmp(value, "true") == 0 || strcmp(value, "1") == 0);
+        } else if (strcmp(name, "roi_max_regions") == 0) {
+            config->roi_max_regions = safe_atoi(value, 4);
+        } else if (strcmp(name, "roi_padding") == 0) {
+            config->roi_padding = safe_atoi(value, 20);
+        } else if (strcmp(name, "roi_max_coverage") == 0) {
+            config->roi_max_coverage = safe_atoi(value, 60);
+        } else if (strcmp(name, "mmap_weights") == 0) {
+            config->mmap_model_weights = (strcmp(value, "true") == 0 || strcmp(value, "1") == 0);
+        } else if (strcmp(name, "reload_interval") == 0) {
+            config->model_reload_interval = safe_atoi(value, 10);
         }
     }
     // API detection settings
@@ -688,6 +937,36 @@ static int config_ini_handler(void* user, const char* section, const char* name,
             if (config->default_post_detection_buffer > 300) config->default_post_detection_buffer = 300;
         } else if (strcmp(name, "buffer_strategy") == 0) {
             safe_strcpy(config->default_buffer_strategy, value, sizeof(config->default_buffer_strategy), 0);
+        } else if (strcmp(name, "async") == 0) {
+            config->api_detection_async = (strcmp(value, "true") == 0 || strcmp(value, "1") == 0);
+        } else if (strcmp(name, "max_inflight") == 0) {
+            config->api_detection_max_inflight = safe_atoi(value, 2);
+        } else if (strcmp(name, "tracking") == 0) {
+            config->tracking_enabled = (strcmp(value, "true") == 0 || strcmp(value, "1") == 0);
+        } else if (strcmp(name, "track_update_interval") == 0) {
+            config->track_update_interval = safe_atoi(value, 10);
+        } else if (strcmp(name, "track_max_misses") == 0) {
+            config->track_max_misses = safe_atoi(value, 3);
+        } else if (strcmp(name, "adaptive_interval") == 0) {
+            config->adaptive_detection_interval = (strcmp(value, "true") == 0 || strcmp(value, "1") == 0);
+        } else if (strcmp(name, "adaptive_quiet_period") == 0) {
+            config->adaptive_quiet_period = safe_atoi(value, 120);
+        } else if (strcmp(name, "adaptive_max_factor") == 0) {
+            config->adaptive_max_factor = safe_atoi(value, 4);
+        }
+    }
+    // Frame bus settings
+    else if (strcmp(section, "frame_bus") == 0) {
+        if (strcmp(name, "enabled") == 0) {
+            config->frame_bus_enabled = (strcmp(value, "true") == 0 || strcmp(value, "1") == 0);
+        } else if (strcmp(name, "socket_path") == 0) {
+            safe_strcpy(config->frame_bus_socket_path, value, MAX_PATH_LENGTH, 0);
+        } else if (strcmp(name, "slots") == 0) {
+            config->frame_bus_slots = safe_atoi(value, 4);
+        } else if (strcmp(name, "max_width") == 0) {
+            config->frame_bus_max_width = safe_atoi(value, 1280);
+        } else if (strcmp(name, "max_height") == 0) {
+            config->frame_bus_max_height = safe_atoi(value, 720);
         }
     }
     // Database settings
@@ -700,6 +979,36 @@ static int config_ini_handler(void* user, const char* section, const char* name,
             config->db_backup_retention_count = safe_atoi(value, 0);
         } else if (strcmp(name, "post_backup_script") == 0) {
             safe_strcpy(config->db_post_backup_script, value, MAX_PATH_LENGTH, 0);
+        } else if (strcmp(name, "backup_step_pages") == 0) {
+            config->db_backup_step_pages = safe_atoi(value, 256);
+        } else if (strcmp(name, "backup_step_sleep_ms") == 0) {
+            config->db_backup_step_sleep_ms = safe_atoi(value, 20);
+        } else if (strcmp(name, "backup_max_mb_per_sec") == 0) {
+            config->db_backup_max_mb_per_sec = safe_atoi(value, 0);
+        } else if (strcmp(name, "backup_compress") == 0) {
+            config->db_backup_compress = (strcmp(value, "true") == 0 || strcmp(value, "1") == 0);
+        } else if (strcmp(name, "checkpoint_interval_seconds") == 0) {
+            config->db_checkpoint_interval_seconds = safe_atoi(value, 30);
+        } else if (strcmp(name, "checkpoint_idle_writes") == 0) {
+            config->db_checkpoint_idle_writes = safe_atoi(value, 50);
+        } else if (strcmp(name, "checkpoint_max_deferrals") == 0) {
+            config->db_checkpoint_max_deferrals = safe_atoi(value, 10);
+        } else if (strcmp(name, "wal_truncate_mb") == 0) {
+            config->db_wal_truncate_mb = safe_atoi(value, 16);
+        } else if (strcmp(name, "wal_autocheckpoint_pages") == 0) {
+            config->db_wal_autocheckpoint_pages = safe_atoi(value, 10000);
+        } else if (strcmp(name, "incremental_vacuum_pages") == 0) {
+            config->db_incremental_vacuum_pages = safe_atoi(value, 256);
+        } else if (strcmp(name, "read_connections") == 0) {
+            config->db_read_connections = safe_atoi(value, 4);
+        } else if (strcmp(name, "write_queue") == 0) {
+            config->db_write_queue = (strcmp(value, "true") == 0 || strcmp(value, "1") == 0);
+        } else if (strcmp(name, "write_batch_interval_ms") == 0) {
+            config->db_write_batch_interval_ms = safe_atoi(value, 250);
+        } else if (strcmp(name, "write_batch_max_rows") == 0) {
+            config->db_write_batch_max_rows = safe_atoi(value, 200);
+        } else if (strcmp(name, "write_queue_capacity") == 0) {
+            config->db_write_queue_capacity = safe_atoi(value, 4096);
         }
     }
     // Web server settings
@@ -743,6 +1052,13 @@ static int config_ini_handler(void* user, const char* section, const char* name,
             } else if (config->trusted_device_days > (INT_MAX / 86400)) {
                 config->trusted_device_days = (INT_MAX / 86400);
             }
+        } else if (strcmp(name, "auth_cache_ttl_seconds") == 0) {
+            config->auth_cache_ttl_seconds = safe_atoi(value, 30);
+            if (config->auth_cache_ttl_seconds < 0) {
+                config->auth_cache_ttl_seconds = 0;
+            } else if (config->auth_cache_ttl_seconds > 300) {
+                config->auth_cache_ttl_seconds = 300;
+            }
         } else if (strcmp(name, "trusted_proxy_cidrs") == 0) {
             safe_strcpy(config->trusted_proxy_cidrs, value, sizeof(config->trusted_proxy_cidrs), 0);
         } else if (strcmp(name, "demo_mode") == 0) {
@@ -857,6 +1173,8 @@ static int config_ini_handler(void* user, const char* section, const char* name,
             if (config->go2rtc_proxy_max_inflight > 128) {
                 config->go2rtc_proxy_max_inflight = 128;  // Maximum 128
             }
+        } else if (strcmp(name, "snapshot_max_age_ms") == 0) {
+            config->go2rtc_snapshot_max_age_ms = safe_atoi(value, 1000);
         } else if (strcmp(name, "turn_enabled") == 0) {
             config->turn_enabled = (strcmp(value, "true") == 0 || strcmp(value, "1") == 0);
         } else if (strcmp(name, "turn_server_url") == 0) {
@@ -1575,7 +1893,11 @@ int save_config(const config_t *config, const char *path) {
     
     fprintf(file, "max_size = %llu  ; 0 means unlimited, otherwise bytes\n", (unsigned long long)config->max_storage_size);
     fprintf(file, "retention_days = %d\n", config->retention_days);
-    fprintf(file, "auto_delete_oldest = %s\n\n", config->auto_delete_oldest ? "true" : "false");
+    fprintf(file, "auto_delete_oldest = %s\n", config->auto_delete_oldest ? "true" : "false");
+    fprintf(file, "cleanup_workers = %d  ; Threads that delete recording files\n", config->cleanup_workers);
+    fprintf(file, "cleanup_io_priority = %s  ; normal, low or idle\n\n",
+            config->cleanup_io_priority == CLEANUP_IO_PRIORITY_NORMAL ? "normal" :
+            config->cleanup_io_priority == CLEANUP_IO_PRIORITY_IDLE ? "idle" : "low");
 
     // Write MP4 recording settings
     fprintf(file, "; New recording format options\n");
@@ -1594,7 +1916,21 @@ int save_config(const config_t *config, const char *path) {
 
     // Write models settings
     fprintf(file, "[models]\n");
-    fprintf(file, "path = %s\n\n", config->models_path);
+    fprintf(file, "path = %s\n", config->models_path);
+    fprintf(file, "; Frames from different streams batched into one SOD CNN pass (1 = disabled)\n");
+    fprintf(file, "batch_size = %d\n", config->sod_batch_max_size);
+    fprintf(file, "batch_latency_ms = %d\n", config->sod_batch_max_latency_ms);
+    fprintf(file, "; Threads per SOD CNN convolution (0 = all CPUs)\n");
+    fprintf(file, "threads = %d\n", config->sod_threads);
+    fprintf(file, "; Run models on crops around zones and motion instead of the whole frame\n");
+    fprintf(file, "roi_cropping = %s\n", config->roi_cropping ? "true" : "false");
+    fprintf(file, "roi_max_regions = %d\n", config->roi_max_regions);
+    fprintf(file, "roi_padding = %d\n", config->roi_padding);
+    fprintf(file, "roi_max_coverage = %d\n", config->roi_max_coverage);
+    fprintf(file, "; Map weights from model files instead of copying them (replace files with mv, not cp)\n");
+    fprintf(file, "mmap_weights = %s\n", config->mmap_model_weights ? "true" : "false");
+    fprintf(file, "; Seconds between checks for updated model files (0 = never reload)\n");
+    fprintf(file, "reload_interval = %d\n\n", config->model_reload_interval);
     
     // Write API detection settings
     fprintf(file, "[api_detection]\n");
@@ -1603,7 +1939,27 @@ int save_config(const config_t *config, const char *path) {
     fprintf(file, "detection_threshold = %d  ; Default confidence threshold (0-100%%)\n", config->default_detection_threshold);
     fprintf(file, "pre_detection_buffer = %d\n", config->default_pre_detection_buffer);
     fprintf(file, "post_detection_buffer = %d\n", config->default_post_detection_buffer);
-    fprintf(file, "buffer_strategy = %s\n\n", config->default_buffer_strategy);
+    fprintf(file, "buffer_strategy = %s\n", config->default_buffer_strategy);
+    fprintf(file, "; Send requests without blocking detection threads, at most max_inflight per stream\n");
+    fprintf(file, "async = %s\n", config->api_detection_async ? "true" : "false");
+    fprintf(file, "max_inflight = %d\n", config->api_detection_max_inflight);
+    fprintf(file, "; Store track start/update/end events instead of every detected box\n");
+    fprintf(file, "tracking = %s\n", config->tracking_enabled ? "true" : "false");
+    fprintf(file, "track_update_interval = %d\n", config->track_update_interval);
+    fprintf(file, "track_max_misses = %d\n", config->track_max_misses);
+    fprintf(file, "; Analyze streams less often after adaptive_quiet_period seconds without activity\n");
+    fprintf(file, "adaptive_interval = %s\n", config->adaptive_detection_interval ? "true" : "false");
+    fprintf(file, "adaptive_quiet_period = %d\n", config->adaptive_quiet_period);
+    fprintf(file, "adaptive_max_factor = %d\n\n", config->adaptive_max_factor);
+
+    // Write frame bus settings
+    fprintf(file, "[frame_bus]\n");
+    fprintf(file, "; Shared-memory frame transport for detectors on this host (model \"frame-bus\")\n");
+    fprintf(file, "enabled = %s\n", config->frame_bus_enabled ? "true" : "false");
+    fprintf(file, "socket_path = %s\n", config->frame_bus_socket_path);
+    fprintf(file, "slots = %d\n", config->frame_bus_slots);
+    fprintf(file, "max_width = %d\n", config->frame_bus_max_width);
+    fprintf(file, "max_height = %d\n\n", config->frame_bus_max_height);
 
     // Write database settings
     fprintf(file, "[database]\n");
@@ -1612,8 +1968,29 @@ int save_config(const config_t *config, const char *path) {
             config->db_backup_interval_minutes);
     fprintf(file, "backup_retention_count = %d  ; Number of timestamped backups to keep\n",
             config->db_backup_retention_count);
-    fprintf(file, "post_backup_script = %s  ; Optional absolute path to executable hook\n\n",
+    fprintf(file, "post_backup_script = %s  ; Optional absolute path to executable hook\n",
             config->db_post_backup_script);
+    fprintf(file, "backup_step_pages = %d  ; Pages copied per step before writers get the database back\n",
+            config->db_backup_step_pages);
+    fprintf(file, "backup_step_sleep_ms = %d\n", config->db_backup_step_sleep_ms);
+    fprintf(file, "backup_max_mb_per_sec = %d  ; 0 = no rate cap\n", config->db_backup_max_mb_per_sec);
+    fprintf(file, "backup_compress = %s\n", config->db_backup_compress ? "true" : "false");
+    fprintf(file, "checkpoint_interval_seconds = %d  ; 0 leaves checkpoints to SQLite\n",
+            config->db_checkpoint_interval_seconds);
+    fprintf(file, "checkpoint_idle_writes = %d\n", config->db_checkpoint_idle_writes);
+    fprintf(file, "checkpoint_max_deferrals = %d  ; 0 skips busy periods indefinitely\n",
+            config->db_checkpoint_max_deferrals);
+    fprintf(file, "wal_truncate_mb = %d\n", config->db_wal_truncate_mb);
+    fprintf(file, "wal_autocheckpoint_pages = %d\n", config->db_wal_autocheckpoint_pages);
+    fprintf(file, "incremental_vacuum_pages = %d  ; Free pages released per run, 0 = never\n",
+            config->db_incremental_vacuum_pages);
+    fprintf(file, "read_connections = %d  ; Read-only connections for queries, 0 = share the writer\n",
+            config->db_read_connections);
+    fprintf(file, "write_queue = %s  ; false commits every write on the caller's thread\n",
+            config->db_write_queue ? "true" : "false");
+    fprintf(file, "write_batch_interval_ms = %d\n", config->db_write_batch_interval_ms);
+    fprintf(file, "write_batch_max_rows = %d\n", config->db_write_batch_max_rows);
+    fprintf(file, "write_queue_capacity = %d\n\n", config->db_write_queue_capacity);
     
     // Write web server settings
     fprintf(file, "[web]\n");
@@ -1630,6 +2007,7 @@ int save_config(const config_t *config, const char *path) {
     fprintf(file, "auth_timeout_hours = %d  ; Session idle timeout in hours (default: 24)\n", config->auth_timeout_hours);
     fprintf(file, "auth_absolute_timeout_hours = %d  ; Absolute session lifetime in hours (default: 168)\n", config->auth_absolute_timeout_hours);
     fprintf(file, "trusted_device_days = %d  ; Remember trusted device for N days (0 disables, default: 30)\n", config->trusted_device_days);
+    fprintf(file, "auth_cache_ttl_seconds = %d  ; Reuse verified credentials, sessions and API keys for N seconds (0 disables, default: 30)\n", config->auth_cache_ttl_seconds);
     fprintf(file, "trusted_proxy_cidrs = %s  ; Trusted reverse-proxy CIDRs for X-Forwarded-For (blank disables trust)\n", config->trusted_proxy_cidrs);
     fprintf(file, "demo_mode = %s  ; Demo mode: allows unauthenticated viewer access\n", config->demo_mode ? "true" : "false");
     fprintf(file, "force_mfa_on_login = %s  ; Require TOTP code with password at login (prevents password-only brute force)\n", config->force_mfa_on_login ? "true" : "false");
@@ -1674,6 +2052,7 @@ int save_config(const config_t *config, const char *path) {
     }
     fprintf(file, "force_native_hls = %s\n", config->go2rtc_force_native_hls ? "true" : "false");
     fprintf(file, "proxy_max_inflight = %d\n", config->go2rtc_proxy_max_inflight);
+    fprintf(file, "snapshot_max_age_ms = %d\n", config->go2rtc_snapshot_max_age_ms);
     // TURN server settings
     fprintf(file, "turn_enabled = %s\n", config->turn_enabled ? "true" : "false");
     if (config->turn_server_url[0] != '\0') {
@@ -1746,6 +2125,9 @@ void print_config(const config_t *config) {
     printf("    Max Storage Size: %llu bytes\n", (unsigned long long)config->max_storage_size);
     printf("    Retention Days: %d\n", config->retention_days);
     printf("    Auto Delete Oldest: %s\n", config->auto_delete_oldest ? "true" : "false");
+    printf("    Cleanup Workers: %d (I/O priority %s)\n", config->cleanup_workers,
+           config->cleanup_io_priority == CLEANUP_IO_PRIORITY_NORMAL ? "normal" :
+           config->cleanup_io_priority == CLEANUP_IO_PRIORITY_IDLE ? "idle" : "low");
     
     printf("  Models Settings:\n");
     printf("    Models Path: %s\n", config->models_path);
@@ -1759,6 +2141,13 @@ void print_config(const config_t *config) {
     printf("    Backup Retention Count: %d\n", config->db_backup_retention_count);
     printf("    Post-backup Script: %s\n",
            config->db_post_backup_script[0] ? config->db_post_backup_script : "(disabled)");
+    printf("    Backup Step: %d pages every %d ms (cap: %d MB/s)\n",
+           config->db_backup_step_pages, config->db_backup_step_sleep_ms, config->db_backup_max_mb_per_sec);
+    printf("    Backup Compression: %s\n", config->db_backup_compress ? "enabled" : "disabled");
+    printf("    Checkpoint Interval: %d seconds (idle at <= %d writes, forced after %d busy runs, truncate above %d MB)\n",
+           config->db_checkpoint_interval_seconds, config->db_checkpoint_idle_writes,
+           config->db_checkpoint_max_deferrals, config->db_wal_truncate_mb);
+    printf("    Incremental Vacuum: %d pages per run\n", config->db_incremental_vacuum_pages);
     
     printf("  Web Server Settings:\n");
     printf("    Web Port: %d\n", config->web_port);
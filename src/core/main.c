@@ -39,12 +39,14 @@
 #include "video/hls_writer.h"
 #include "video/detection_stream.h"
 #include "video/detection.h"
+#include "video/detection_cascade.h"
 #include "video/detection_integration.h"
 #include "video/unified_detection_thread.h"
 #include "video/timestamp_manager.h"
 #include "video/onvif_discovery.h"
 #include "video/ffmpeg_leak_detector.h"
 #include "video/cross_stream_motion_trigger.h"
+#include "video/snapshot_cache.h"
 #include "telemetry/stream_metrics.h"
 #include "telemetry/player_telemetry.h"
 
@@ -926,6 +928,8 @@ int main(int argc, char *argv[]) {
             bool is_api_based = (strcmp(config.streams[i].detection_model, "api-detection") == 0) ||
                                (strcmp(config.streams[i].detection_model, "motion") == 0) ||
                                (strcmp(config.streams[i].detection_model, "onvif") == 0) ||
+                               (strcmp(config.streams[i].detection_model, "frame-bus") == 0) ||
+                               is_detection_cascade(config.streams[i].detection_model) ||
                                (strncmp(config.streams[i].detection_model, "http://", 7) == 0) ||
                                (strncmp(config.streams[i].detection_model, "https://", 8) == 0);
 
@@ -1096,6 +1100,12 @@ int main(int argc, char *argv[]) {
             last_db_backup_check_time = now;
         }
 
+        // Checkpoint the WAL and release free pages while writes are quiet;
+        // rate-limited by [database] checkpoint_interval_seconds
+        if (maybe_run_database_maintenance() != 0) {
+            log_warn("Scheduled database maintenance failed");
+        }
+
         // Check if restart was requested and log it
         if (restart_requested) {
             log_info("Main loop detected restart_requested=true, running=%d - exiting loop immediately", running);
@@ -1458,6 +1468,8 @@ cleanup:
         go2rtc_stream_cleanup();
         #endif
 
+        snapshot_cache_cleanup();
+
         // Clean up libcurl globally (after all curl-using services are shut down)
         log_info("Cleaning up libcurl globally...");
         curl_cleanup_global();
@@ -18,6 +18,8 @@
 #include "database/db_streams.h"
 #include "utils/strings.h"
 #include "video/go2rtc/go2rtc_snapshot.h"
+#include "video/object_tracker.h"
+#include "video/snapshot_cache.h"
 
 #define MAX_TOPIC_LENGTH 512
 
@@ -392,6 +394,10 @@ int mqtt_publish_detection(const char *stream_name, const detection_result_t *re
             if (result->detections[i].zone_id[0] != '\0') {
                 cJSON_AddStringToObject(det, "zone_id", result->detections[i].zone_id);
             }
+            const char *track_event = track_event_name(result->detections[i].track_event);
+            if (track_event) {
+                cJSON_AddStringToObject(det, "event", track_event);
+            }
             cJSON_AddItemToArray(detections, det);
         }
     }
@@ -886,19 +892,17 @@ static void *ha_snapshot_thread_func(void *arg) {
                 continue;
             }
 
-            unsigned char *jpeg_data = NULL;
-            size_t jpeg_size = 0;
-
-            if (go2rtc_get_snapshot(streams[i].name, &jpeg_data, &jpeg_size)) {
+            snapshot_t *snapshot = snapshot_cache_get(streams[i].name, -1);
+            if (snapshot) {
                 char safe_name[256];
                 sanitize_stream_name(streams[i].name, safe_name, sizeof(safe_name));
                 char topic[MAX_TOPIC_LENGTH];
                 snprintf(topic, sizeof(topic), "%s/cameras/%s/snapshot",
                          mqtt_config->mqtt_topic_prefix, safe_name);
-                mqtt_publish_binary(topic, jpeg_data, jpeg_size, false);
+                mqtt_publish_binary(topic, snapshot->data, snapshot->size, false);
                 log_debug("MQTT HA: Published snapshot for %s (%zu bytes)",
-                          streams[i].name, jpeg_size);
-                free(jpeg_data);
+                          streams[i].name, snapshot->size);
+                snapshot_release(snapshot);
             } else {
                 log_debug("MQTT HA: Failed to get snapshot for %s", streams[i].name);
             }
@@ -17,6 +17,7 @@
 
 #include "database/db_auth.h"
 #include "database/db_core.h"
+#include "database/db_auth_cache.h"
 #include "database/db_schema_cache.h"  // For cached_column_exists
 #include "core/logger.h"
 #include "core/config.h"
@@ -779,6 +780,7 @@ int db_auth_update_user(int64_t user_id, const char *username, const char *email
 
     sqlite3_finalize(stmt);
 
+    db_auth_cache_invalidate_user(user_id);
     log_info("User updated successfully: %lld", (long long)user_id);
     return 0;
 }
@@ -901,6 +903,7 @@ int db_auth_change_password(int64_t user_id, const char *new_password) {
 
     sqlite3_finalize(stmt);
 
+    db_auth_cache_invalidate_user(user_id);
     log_info("Password changed successfully for user: %lld", (long long)user_id);
     return 0;
 }
@@ -951,6 +954,7 @@ int db_auth_delete_user(int64_t user_id) {
 
     sqlite3_finalize(stmt);
 
+    db_auth_cache_invalidate_user(user_id);
     log_info("User deleted successfully: %lld", (long long)user_id);
     return 0;
 }
@@ -1128,6 +1132,7 @@ int db_auth_generate_api_key(int64_t user_id, char *api_key, size_t api_key_size
 
     sqlite3_finalize(stmt);
 
+    db_auth_cache_invalidate_user(user_id);
     log_info("API key generated successfully for user: %lld", (long long)user_id);
     return 0;
 }
@@ -1370,6 +1375,7 @@ int db_auth_set_password_lock(int64_t user_id, bool locked) {
 
     sqlite3_finalize(stmt);
 
+    db_auth_cache_invalidate_user(user_id);
     log_info("Password lock status updated for user: %lld (locked: %d)", (long long)user_id, locked);
     return 0;
 }
@@ -1525,9 +1531,16 @@ int db_auth_validate_session_with_context(const char *token, int64_t *user_id,
           "FROM sessions s "
           "JOIN users u ON s.user_id = u.id "
           "WHERE s.token = ?;";
-    int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
-    if (rc != SQLITE_OK) {
-        log_error("Failed to prepare statement: %s", sqlite3_errmsg(db));
+
+    // Lookups run on a read connection so logins and page loads do not queue
+    // behind writers; only the tracking UPDATE below needs the writer
+    sqlite3 *reader = db_reader_acquire();
+    if (!reader) {
+        return -1;
+    }
+    stmt = db_prepare_cached_on(reader, sql);
+    if (!stmt) {
+        db_reader_release(reader);
         return -1;
     }
 
@@ -1535,7 +1548,8 @@ int db_auth_validate_session_with_context(const char *token, int64_t *user_id,
 
     if (sqlite3_step(stmt) != SQLITE_ROW) {
         log_debug("Session not found for token");
-        sqlite3_finalize(stmt);
+        db_release_cached(stmt);
+        db_reader_release(reader);
         return -1;
     }
 
@@ -1549,7 +1563,8 @@ int db_auth_validate_session_with_context(const char *token, int64_t *user_id,
 
     if (now > expires_at || now > idle_expires_at) {
         log_debug("Session has expired");
-        sqlite3_finalize(stmt);
+        db_release_cached(stmt);
+        db_reader_release(reader);
         return -1;
     }
 
@@ -1557,7 +1572,8 @@ int db_auth_validate_session_with_context(const char *token, int64_t *user_id,
     int is_active = sqlite3_column_int(stmt, has_tracking_columns ? 5 : (has_idle_expires_column ? 4 : 3));
     if (!is_active) {
         log_debug("User is inactive");
-        sqlite3_finalize(stmt);
+        db_release_cached(stmt);
+        db_reader_release(reader);
         return -1;
     }
 
@@ -1567,7 +1583,7 @@ int db_auth_validate_session_with_context(const char *token, int64_t *user_id,
         *user_id = id;
     }
 
-    sqlite3_finalize(stmt);
+    db_release_cached(stmt);
 
     bool update_ip = false;
     bool update_ua = false;
@@ -1580,8 +1596,8 @@ int db_auth_validate_session_with_context(const char *token, int64_t *user_id,
             ? "SELECT COALESCE(user_agent, '') FROM sessions WHERE id = ?;"
             : NULL;
         if (tracking_sql) {
-            rc = sqlite3_prepare_v2(db, tracking_sql, -1, &stmt, NULL);
-            if (rc == SQLITE_OK) {
+            stmt = db_prepare_cached_on(reader, tracking_sql);
+            if (stmt) {
                 sqlite3_bind_int64(stmt, 1, session_id);
                 if (sqlite3_step(stmt) == SQLITE_ROW) {
                     int column_index = 0;
@@ -1594,13 +1610,14 @@ int db_auth_validate_session_with_context(const char *token, int64_t *user_id,
                     update_ip = has_ip_column && tracking_value_differs(stored_ip, ip_address);
                     update_ua = has_ua_column && tracking_value_differs(stored_ua, user_agent);
                 }
-                sqlite3_finalize(stmt);
+                db_release_cached(stmt);
             } else {
-                log_warn("Failed to prepare session client-context lookup for session %lld: %s",
-                         (long long)session_id, sqlite3_errmsg(db));
+                log_warn("Failed to prepare session client-context lookup for session %lld",
+                         (long long)session_id);
             }
         }
     }
+    db_reader_release(reader);
 
     bool refresh_tracking = has_tracking_columns && should_refresh_session_tracking(now, last_activity_at, idle_expires_at);
     if (refresh_tracking || update_ip || update_ua) {
@@ -1648,8 +1665,9 @@ int db_auth_validate_session_with_context(const char *token, int64_t *user_id,
             return 0;
         }
 
-        rc = sqlite3_prepare_v2(db, update_sql, -1, &stmt, NULL);
-        if (rc == SQLITE_OK) {
+        // Only a handful of distinct texts can be built, so cache them too
+        stmt = db_prepare_cached(update_sql);
+        if (stmt) {
             int param = 1;
             if (refresh_tracking) {
                 sqlite3_bind_int64(stmt, param++, now);
@@ -1666,10 +1684,9 @@ int db_auth_validate_session_with_context(const char *token, int64_t *user_id,
                 log_warn("Failed to refresh tracking for session %lld: %s",
                          (long long)session_id, sqlite3_errmsg(db));
             }
-            sqlite3_finalize(stmt);
+            db_release_cached(stmt);
         } else {
-            log_warn("Failed to prepare tracking refresh for session %lld: %s",
-                     (long long)session_id, sqlite3_errmsg(db));
+            log_warn("Failed to prepare tracking refresh for session %lld", (long long)session_id);
         }
     }
 
@@ -1713,6 +1730,7 @@ int db_auth_delete_session(const char *token) {
     }
 
     sqlite3_finalize(stmt);
+    db_auth_cache_invalidate_secret(AUTH_CACHE_SESSION, token);
 
     log_info("Session deleted successfully");
     return 0;
@@ -1747,6 +1765,7 @@ int db_auth_delete_user_sessions(int64_t user_id) {
 
     sqlite3_finalize(stmt);
 
+    db_auth_cache_invalidate_user(user_id);
     log_info("Sessions deleted successfully for user: %lld", (long long)user_id);
     return 0;
 }
@@ -1898,6 +1917,10 @@ int db_auth_delete_session_by_id(int64_t user_id, int64_t session_id) {
     rc = sqlite3_step(stmt);
     int changes = (rc == SQLITE_DONE) ? sqlite3_changes(db) : 0;
     sqlite3_finalize(stmt);
+    if (changes > 0) {
+        // The token is not known here, so drop every cached entry of the user
+        db_auth_cache_invalidate_user(user_id);
+    }
     return (rc == SQLITE_DONE && changes > 0) ? 0 : -1;
 }
 
@@ -2278,6 +2301,7 @@ int db_auth_enable_totp(int64_t user_id, bool enabled) {
         return -1;
     }
 
+    db_auth_cache_invalidate_user(user_id);
     log_info("TOTP %s for user %lld", enabled ? "enabled" : "disabled", (long long)user_id);
     return 0;
 }
@@ -2324,6 +2348,7 @@ int db_auth_set_allowed_tags(int64_t user_id, const char *allowed_tags) {
         return -1;
     }
 
+    db_auth_cache_invalidate_user(user_id);
     log_info("allowed_tags updated for user %lld: %s", (long long)user_id,
              allowed_tags ? allowed_tags : "(unrestricted)");
     return 0;
@@ -2379,6 +2404,7 @@ int db_auth_set_allowed_login_cidrs(int64_t user_id, const char *allowed_login_c
         return -1;
     }
 
+    db_auth_cache_invalidate_user(user_id);
     log_info("allowed_login_cidrs updated for user %lld: %s", (long long)user_id,
              has_entries ? normalized : "(unrestricted)");
     return 0;
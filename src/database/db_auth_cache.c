@@ -0,0 +1,275 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <mbedtls/md.h>
+#include <mbedtls/entropy.h>
+#include <mbedtls/ctr_drbg.h>
+
+#include "database/db_auth_cache.h"
+#include "core/config.h"
+#include "core/logger.h"
+
+#define AUTH_CACHE_DIGEST_LENGTH 32
+
+typedef struct {
+    bool used;
+    auth_cache_kind_t kind;
+    unsigned char secret_digest[AUTH_CACHE_DIGEST_LENGTH];
+    unsigned char context_digest[AUTH_CACHE_DIGEST_LENGTH];
+    time_t expires_at;
+    user_t user;
+} auth_cache_entry_t;
+
+static pthread_mutex_t cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+static auth_cache_entry_t *entries = NULL;
+static auth_cache_stats_t stats;
+
+// Bumped under cache_mutex by every invalidation; a store whose caller read an
+// older value verified its credential before the invalidation and is dropped
+static uint64_t generation_counter = 0;
+
+// Digests are keyed with a per-process secret so a memory dump does not
+// hand out unsalted password hashes
+static unsigned char digest_key[32];
+static bool digest_key_ready = false;
+
+// Called with cache_mutex held
+static int ensure_cache_ready(void) {
+    if (!entries) {
+        entries = calloc(AUTH_CACHE_MAX_ENTRIES, sizeof(auth_cache_entry_t));
+        if (!entries) {
+            log_error("Failed to allocate authentication cache");
+            return -1;
+        }
+    }
+
+    if (!digest_key_ready) {
+        mbedtls_entropy_context entropy;
+        mbedtls_ctr_drbg_context ctr_drbg;
+        mbedtls_entropy_init(&entropy);
+        mbedtls_ctr_drbg_init(&ctr_drbg);
+
+        int rc = mbedtls_ctr_drbg_seed(&ctr_drbg, mbedtls_entropy_func, &entropy,
+                                       (const unsigned char *)"lightnvr-auth-cache", 19);
+        if (rc == 0) {
+            rc = mbedtls_ctr_drbg_random(&ctr_drbg, digest_key, sizeof(digest_key));
+        }
+
+        mbedtls_ctr_drbg_free(&ctr_drbg);
+        mbedtls_entropy_free(&entropy);
+
+        if (rc != 0) {
+            log_error("Failed to generate authentication cache key");
+            return -1;
+        }
+        digest_key_ready = true;
+    }
+
+    return 0;
+}
+
+static int compute_digest(auth_cache_kind_t kind, const char *value, unsigned char *digest) {
+    if (!value) {
+        memset(digest, 0, AUTH_CACHE_DIGEST_LENGTH);
+        return 0;
+    }
+
+    const mbedtls_md_info_t *md_info = mbedtls_md_info_from_type(MBEDTLS_MD_SHA256);
+    if (!md_info) {
+        return -1;
+    }
+
+    // Prefix the kind so a session token never matches an API key entry
+    size_t len = strlen(value);
+    unsigned char *input = malloc(len + 1);
+    if (!input) {
+        return -1;
+    }
+    input[0] = (unsigned char)kind;
+    memcpy(input + 1, value, len);
+
+    int rc = mbedtls_md_hmac(md_info, digest_key, sizeof(digest_key), input, len + 1, digest);
+
+    memset(input, 0, len + 1);
+    free(input);
+    return rc == 0 ? 0 : -1;
+}
+
+bool db_auth_cache_lookup(auth_cache_kind_t kind, const char *secret, const char *context, user_t *user) {
+    if (!secret || !user || g_config.auth_cache_ttl_seconds <= 0) {
+        return false;
+    }
+
+    unsigned char secret_digest[AUTH_CACHE_DIGEST_LENGTH];
+    unsigned char context_digest[AUTH_CACHE_DIGEST_LENGTH];
+    bool hit = false;
+    time_t now = time(NULL);
+
+    pthread_mutex_lock(&cache_mutex);
+
+    if (ensure_cache_ready() == 0 &&
+        compute_digest(kind, secret, secret_digest) == 0 &&
+        compute_digest(kind, context, context_digest) == 0) {
+        for (int i = 0; i < AUTH_CACHE_MAX_ENTRIES; i++) {
+            auth_cache_entry_t *e = &entries[i];
+            if (!e->used || e->kind != kind ||
+                memcmp(e->secret_digest, secret_digest, AUTH_CACHE_DIGEST_LENGTH) != 0 ||
+                memcmp(e->context_digest, context_digest, AUTH_CACHE_DIGEST_LENGTH) != 0) {
+                continue;
+            }
+            if (now >= e->expires_at) {
+                e->used = false;
+                stats.entries--;
+                break;
+            }
+            memcpy(user, &e->user, sizeof(user_t));
+            hit = true;
+            break;
+        }
+    }
+
+    if (hit) {
+        stats.hits++;
+    } else {
+        stats.misses++;
+    }
+
+    pthread_mutex_unlock(&cache_mutex);
+    return hit;
+}
+
+uint64_t db_auth_cache_generation(void) {
+    pthread_mutex_lock(&cache_mutex);
+    uint64_t generation = generation_counter;
+    pthread_mutex_unlock(&cache_mutex);
+    return generation;
+}
+
+void db_auth_cache_store(auth_cache_kind_t kind, const char *secret, const char *context, const user_t *user,
+                         uint64_t generation) {
+    int ttl = g_config.auth_cache_ttl_seconds;
+    if (!secret || !user || ttl <= 0) {
+        return;
+    }
+
+    time_t now = time(NULL);
+
+    pthread_mutex_lock(&cache_mutex);
+
+    if (generation != generation_counter) {
+        pthread_mutex_unlock(&cache_mutex);
+        return;
+    }
+
+    unsigned char secret_digest[AUTH_CACHE_DIGEST_LENGTH];
+    unsigned char context_digest[AUTH_CACHE_DIGEST_LENGTH];
+    if (ensure_cache_ready() != 0 ||
+        compute_digest(kind, secret, secret_digest) != 0 ||
+        compute_digest(kind, context, context_digest) != 0) {
+        pthread_mutex_unlock(&cache_mutex);
+        return;
+    }
+
+    // Reuse the entry for the same credential, else a free or expired slot,
+    // else the one closest to expiry
+    auth_cache_entry_t *slot = NULL;
+    auth_cache_entry_t *oldest = NULL;
+    for (int i = 0; i < AUTH_CACHE_MAX_ENTRIES; i++) {
+        auth_cache_entry_t *e = &entries[i];
+        if (e->used && e->kind == kind &&
+            memcmp(e->secret_digest, secret_digest, AUTH_CACHE_DIGEST_LENGTH) == 0 &&
+            memcmp(e->context_digest, context_digest, AUTH_CACHE_DIGEST_LENGTH) == 0) {
+            slot = e;
+            break;
+        }
+        if (!e->used || now >= e->expires_at) {
+            if (!slot) {
+                slot = e;
+            }
+        } else if (!oldest || e->expires_at < oldest->expires_at) {
+            oldest = e;
+        }
+    }
+    if (!slot) {
+        slot = oldest;
+    }
+
+    if (!slot->used) {
+        stats.entries++;
+    }
+    slot->used = true;
+    slot->kind = kind;
+    memcpy(slot->secret_digest, secret_digest, AUTH_CACHE_DIGEST_LENGTH);
+    memcpy(slot->context_digest, context_digest, AUTH_CACHE_DIGEST_LENGTH);
+    slot->expires_at = now + ttl;
+    memcpy(&slot->user, user, sizeof(user_t));
+
+    pthread_mutex_unlock(&cache_mutex);
+}
+
+void db_auth_cache_invalidate_user(int64_t user_id) {
+    pthread_mutex_lock(&cache_mutex);
+    generation_counter++;
+
+    if (entries) {
+        for (int i = 0; i < AUTH_CACHE_MAX_ENTRIES; i++) {
+            if (entries[i].used && entries[i].user.id == user_id) {
+                memset(&entries[i], 0, sizeof(auth_cache_entry_t));
+                stats.entries--;
+                stats.invalidations++;
+            }
+        }
+    }
+
+    pthread_mutex_unlock(&cache_mutex);
+}
+
+void db_auth_cache_invalidate_secret(auth_cache_kind_t kind, const char *secret) {
+    if (!secret) {
+        return;
+    }
+
+    pthread_mutex_lock(&cache_mutex);
+    generation_counter++;
+
+    unsigned char secret_digest[AUTH_CACHE_DIGEST_LENGTH];
+    if (entries && digest_key_ready && compute_digest(kind, secret, secret_digest) == 0) {
+        for (int i = 0; i < AUTH_CACHE_MAX_ENTRIES; i++) {
+            auth_cache_entry_t *e = &entries[i];
+            if (e->used && e->kind == kind &&
+                memcmp(e->secret_digest, secret_digest, AUTH_CACHE_DIGEST_LENGTH) == 0) {
+                memset(e, 0, sizeof(auth_cache_entry_t));
+                stats.entries--;
+                stats.invalidations++;
+            }
+        }
+    }
+
+    pthread_mutex_unlock(&cache_mutex);
+}
+
+void db_auth_cache_clear(void) {
+    pthread_mutex_lock(&cache_mutex);
+    generation_counter++;
+
+    if (entries) {
+        memset(entries, 0, AUTH_CACHE_MAX_ENTRIES * sizeof(auth_cache_entry_t));
+    }
+    stats.entries = 0;
+
+    pthread_mutex_unlock(&cache_mutex);
+}
+
+void db_auth_cache_get_stats(auth_cache_stats_t *out) {
+    if (!out) {
+        return;
+    }
+
+    pthread_mutex_lock(&cache_mutex);
+    memcpy(out, &stats, sizeof(auth_cache_stats_t));
+    pthread_mutex_unlock(&cache_mutex);
+}
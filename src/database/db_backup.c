@@ -16,10 +16,15 @@
 #include <fcntl.h>
 #include <limits.h>
 #include <libgen.h>
+#include <stdint.h>
+#ifdef LIGHTNVR_HAVE_ZLIB
+#include <zlib.h>
+#endif
 
 #include "database/db_core.h"
 #include "database/db_backup.h"
 #include "database/db_schema_utils.h"
+#include "core/config.h"
 #include "core/logger.h"
 
 // Flag to indicate if a backup is in progress
@@ -67,9 +72,10 @@ static int sync_parent_directory(const char *path) {
     return 0;
 }
 
-static int run_integrity_check(sqlite3 *db_handle, const char *path_label) {
+static int run_integrity_check(sqlite3 *db_handle, const char *path_label, bool quick) {
     sqlite3_stmt *stmt = NULL;
-    int rc = sqlite3_prepare_v2(db_handle, "PRAGMA integrity_check;", -1, &stmt, NULL);
+    const char *sql = quick ? "PRAGMA quick_check;" : "PRAGMA integrity_check;";
+    int rc = sqlite3_prepare_v2(db_handle, sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
         log_error("Failed to prepare integrity check for %s: %s",
                   path_label, sqlite3_errmsg(db_handle));
@@ -95,97 +101,215 @@ static int run_integrity_check(sqlite3 *db_handle, const char *path_label) {
     return 0;
 }
 
-// Backup the database to a specified path
-int backup_database(const char *source_path, const char *dest_path) {
-    int rc = -1;
-    sqlite3 *source_db = NULL;
-    sqlite3 *dest_db = NULL;
-    sqlite3_backup *backup = NULL;
-    char temp_path[PATH_MAX];
-    
+static bool begin_backup(void) {
     pthread_mutex_lock(&backup_mutex);
     if (backup_in_progress) {
         pthread_mutex_unlock(&backup_mutex);
         log_warn("Backup already in progress, skipping");
-        return -1;
+        return false;
     }
-
     backup_in_progress = true;
     pthread_mutex_unlock(&backup_mutex);
+    return true;
+}
+
+static void end_backup(void) {
+    pthread_mutex_lock(&backup_mutex);
+    backup_in_progress = false;
+    pthread_mutex_unlock(&backup_mutex);
+}
 
-    if (snprintf(temp_path, sizeof(temp_path), "%s.tmp", dest_path) >= (int)sizeof(temp_path)) {
-        log_error("Destination path is too long for temporary backup file: %s", dest_path);
-        goto cleanup;
+static uint64_t elapsed_ms_since(const struct timespec *start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    int64_t ms = (int64_t)(now.tv_sec - start->tv_sec) * 1000 + (now.tv_nsec - start->tv_nsec) / 1000000;
+    return ms > 0 ? (uint64_t)ms : 0;
+}
+
+static void sleep_ms(uint64_t ms) {
+    struct timespec ts = { .tv_sec = (time_t)(ms / 1000), .tv_nsec = (long)(ms % 1000) * 1000000L };
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {
     }
+}
 
-    unlink(temp_path);
+/**
+ * Pause between backup steps: at least db_backup_step_sleep_ms, and long
+ * enough to keep the average below db_backup_max_mb_per_sec
+ */
+static void pace_backup_io(const struct timespec *start, uint64_t bytes_done, bool step_pause) {
+    uint64_t pause_ms = step_pause && g_config.db_backup_step_sleep_ms > 0
+        ? (uint64_t)g_config.db_backup_step_sleep_ms : 0;
 
-    log_info("Starting database backup from %s to %s", source_path, dest_path);
-    
-    // Open the source database
-    rc = sqlite3_open_v2(source_path, &source_db, SQLITE_OPEN_READONLY, NULL);
-    if (rc != SQLITE_OK) {
-        log_error("Failed to open source database for backup: %s",
-                  source_db ? sqlite3_errmsg(source_db) : sqlite3_errstr(rc));
-        goto cleanup;
+    if (g_config.db_backup_max_mb_per_sec > 0) {
+        uint64_t budget_ms = bytes_done * 1000 / ((uint64_t)g_config.db_backup_max_mb_per_sec * 1024 * 1024);
+        uint64_t elapsed_ms = elapsed_ms_since(start);
+        if (budget_ms > elapsed_ms && budget_ms - elapsed_ms > pause_ms) {
+            pause_ms = budget_ms - elapsed_ms;
+        }
     }
-    
-    // Open the destination database
-    rc = sqlite3_open_v2(temp_path, &dest_db, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, NULL);
-    if (rc != SQLITE_OK) {
-        log_error("Failed to open destination database for backup: %s",
-                  dest_db ? sqlite3_errmsg(dest_db) : sqlite3_errstr(rc));
-        goto cleanup;
+
+    if (pause_ms > 0) {
+        sleep_ms(pause_ms);
     }
-    
-    // Initialize the backup
-    backup = sqlite3_backup_init(dest_db, "main", source_db, "main");
+}
+
+/**
+ * Copy source_db into dest_db a few pages at a time
+ *
+ * When live is set, source_db is the shared writer connection: each step
+ * runs under the writer lock and SQLite applies writes made on that
+ * connection between steps to the copy, so the backup never restarts.
+ */
+static int copy_database_in_steps(sqlite3 *source_db, sqlite3 *dest_db, bool live) {
+    int page_size = 4096;
+    sqlite3_stmt *stmt = NULL;
+
+    if (live) {
+        db_writer_lock();
+    }
+    if (sqlite3_prepare_v2(source_db, "PRAGMA page_size;", -1, &stmt, NULL) == SQLITE_OK) {
+        if (sqlite3_step(stmt) == SQLITE_ROW && sqlite3_column_int(stmt, 0) > 0) {
+            page_size = sqlite3_column_int(stmt, 0);
+        }
+        sqlite3_finalize(stmt);
+    }
+    sqlite3_backup *backup = sqlite3_backup_init(dest_db, "main", source_db, "main");
+    if (live) {
+        db_writer_unlock();
+    }
+
     if (!backup) {
         log_error("Failed to initialize backup: %s", sqlite3_errmsg(dest_db));
-        goto cleanup;
+        return -1;
     }
-    
-    // Perform the backup
-    rc = sqlite3_backup_step(backup, -1);
+
+    int step_pages = g_config.db_backup_step_pages > 0 ? g_config.db_backup_step_pages : 256;
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    uint64_t bytes_done = 0;
+    int busy_retries = 0;
+    int steps = 0;
+    int rc;
+
+    while (1) {
+        if (live) {
+            db_writer_lock();
+        }
+        int before = sqlite3_backup_remaining(backup);
+        rc = sqlite3_backup_step(backup, step_pages);
+        int after = sqlite3_backup_remaining(backup);
+        if (live) {
+            db_writer_unlock();
+        }
+
+        if (rc == SQLITE_DONE) {
+            break;
+        }
+
+        if (rc == SQLITE_BUSY || rc == SQLITE_LOCKED) {
+            if (++busy_retries > 100) {
+                log_error("Backup source stayed locked, giving up");
+                break;
+            }
+            sleep_ms(100);
+            continue;
+        }
+
+        if (rc != SQLITE_OK) {
+            break;
+        }
+
+        busy_retries = 0;
+        steps++;
+        // remaining is 0 before the first step; count a full step then
+        int copied = (before > after) ? before - after : step_pages;
+        bytes_done += (uint64_t)copied * (uint64_t)page_size;
+        pace_backup_io(&start, bytes_done, true);
+    }
+
     if (rc != SQLITE_DONE) {
         log_error("Failed to perform backup: %s", sqlite3_errmsg(dest_db));
-        goto cleanup;
+        sqlite3_backup_finish(backup);
+        return -1;
     }
-    
-    // Finish the backup
+
+    int total_pages = sqlite3_backup_pagecount(backup);
     rc = sqlite3_backup_finish(backup);
-    backup = NULL;
     if (rc != SQLITE_OK) {
         log_error("Failed to finish backup: %s", sqlite3_errmsg(dest_db));
+        return -1;
+    }
+
+    log_info("Copied %d pages (%d bytes each) in %d steps over %llu ms",
+             total_pages, page_size, steps + 1, (unsigned long long)elapsed_ms_since(&start));
+    return 0;
+}
+
+static int run_backup(sqlite3 *live_db, const char *source_path, const char *dest_path) {
+    int rc = -1;
+    sqlite3 *source_db = NULL;
+    sqlite3 *dest_db = NULL;
+    char temp_path[PATH_MAX];
+
+    if (snprintf(temp_path, sizeof(temp_path), "%s.tmp", dest_path) >= (int)sizeof(temp_path)) {
+        log_error("Destination path is too long for temporary backup file: %s", dest_path);
+        return -1;
+    }
+
+    unlink(temp_path);
+
+    if (!live_db) {
+        rc = sqlite3_open_v2(source_path, &source_db, SQLITE_OPEN_READONLY, NULL);
+        if (rc != SQLITE_OK) {
+            log_error("Failed to open source database for backup: %s",
+                      source_db ? sqlite3_errmsg(source_db) : sqlite3_errstr(rc));
+            rc = -1;
+            goto cleanup;
+        }
+    }
+
+    rc = sqlite3_open_v2(temp_path, &dest_db, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, NULL);
+    if (rc != SQLITE_OK) {
+        log_error("Failed to open destination database for backup: %s",
+                  dest_db ? sqlite3_errmsg(dest_db) : sqlite3_errstr(rc));
+        rc = -1;
         goto cleanup;
     }
 
-    if (run_integrity_check(dest_db, temp_path) != 0) {
+    rc = copy_database_in_steps(live_db ? live_db : source_db, dest_db, live_db != NULL);
+    if (rc != 0) {
         goto cleanup;
     }
-    
-    // Close the databases
-    sqlite3_close(source_db);
-    source_db = NULL;
+
+    // quick_check skips the index cross-checks that make integrity_check
+    // read every page several times; it still catches a torn copy
+    rc = run_integrity_check(dest_db, temp_path, true);
+    if (rc != 0) {
+        goto cleanup;
+    }
+
+    if (source_db) {
+        sqlite3_close(source_db);
+        source_db = NULL;
+    }
     sqlite3_close(dest_db);
     dest_db = NULL;
 
     if (rename(temp_path, dest_path) != 0) {
         log_error("Failed to publish backup %s -> %s: %s", temp_path, dest_path, strerror(errno));
+        rc = -1;
         goto cleanup;
     }
 
     if (sync_path_to_disk(dest_path) != 0 || sync_parent_directory(dest_path) != 0) {
+        rc = -1;
         goto cleanup;
     }
-    
+
     log_info("Database backup completed successfully");
     rc = 0;
 
 cleanup:
-    if (backup) {
-        sqlite3_backup_finish(backup);
-    }
     if (source_db) {
         sqlite3_close(source_db);
     }
@@ -195,14 +319,123 @@ cleanup:
     if (rc != 0) {
         unlink(temp_path);
     }
+    return rc;
+}
 
-    pthread_mutex_lock(&backup_mutex);
-    backup_in_progress = false;
-    pthread_mutex_unlock(&backup_mutex);
+// Backup the database to a specified path
+int backup_database(const char *source_path, const char *dest_path) {
+    if (!begin_backup()) {
+        return -1;
+    }
+
+    log_info("Starting database backup from %s to %s", source_path, dest_path);
+    int rc = run_backup(NULL, source_path, dest_path);
 
+    end_backup();
     return rc == 0 ? 0 : -1;
 }
 
+// Backup the open database without stopping writers
+int backup_live_database(const char *dest_path) {
+    sqlite3 *db = get_db_handle();
+    if (!db) {
+        log_error("Database not initialized, cannot back it up");
+        return -1;
+    }
+
+    if (!begin_backup()) {
+        return -1;
+    }
+
+    log_info("Starting online database backup to %s", dest_path);
+    int rc = run_backup(db, NULL, dest_path);
+
+    end_backup();
+    return rc == 0 ? 0 : -1;
+}
+
+// Gzip a finished backup file
+int compress_backup_file(const char *source_path, const char *dest_path) {
+#ifdef LIGHTNVR_HAVE_ZLIB
+    char temp_path[PATH_MAX];
+    if (snprintf(temp_path, sizeof(temp_path), "%s.tmp", dest_path) >= (int)sizeof(temp_path)) {
+        log_error("Destination path is too long for temporary backup file: %s", dest_path);
+        return -1;
+    }
+
+    int src_fd = open(source_path, O_RDONLY);
+    if (src_fd < 0) {
+        log_error("Failed to open backup for compression: %s (%s)", source_path, strerror(errno));
+        return -1;
+    }
+
+    int dst_fd = open(temp_path, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    gzFile gz = (dst_fd >= 0) ? gzdopen(dst_fd, "wb6") : NULL;
+    if (!gz) {
+        log_error("Failed to create compressed backup: %s", temp_path);
+        if (dst_fd >= 0) {
+            close(dst_fd);
+        }
+        close(src_fd);
+        unlink(temp_path);
+        return -1;
+    }
+
+    char buffer[65536];
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    uint64_t bytes_done = 0;
+    int rc = 0;
+
+    while (1) {
+        ssize_t bytes_read = read(src_fd, buffer, sizeof(buffer));
+        if (bytes_read == 0) {
+            break;
+        }
+        if (bytes_read < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            log_error("Failed to read backup during compression: %s (%s)", source_path, strerror(errno));
+            rc = -1;
+            break;
+        }
+        if (gzwrite(gz, buffer, (unsigned)bytes_read) != (int)bytes_read) {
+            log_error("Failed to write compressed backup: %s", temp_path);
+            rc = -1;
+            break;
+        }
+        bytes_done += (uint64_t)bytes_read;
+        pace_backup_io(&start, bytes_done, false);
+    }
+
+    close(src_fd);
+    if (gzclose(gz) != Z_OK && rc == 0) {
+        log_error("Failed to finish compressed backup: %s", temp_path);
+        rc = -1;
+    }
+
+    if (rc == 0 && sync_path_to_disk(temp_path) != 0) {
+        rc = -1;
+    }
+    if (rc == 0 && rename(temp_path, dest_path) != 0) {
+        log_error("Failed to publish compressed backup %s -> %s: %s", temp_path, dest_path, strerror(errno));
+        rc = -1;
+    }
+    if (rc != 0) {
+        unlink(temp_path);
+        return -1;
+    }
+
+    return sync_parent_directory(dest_path);
+#else
+    (void)source_path;
+    (void)dest_path;
+    log_warn("Backup compression requested but lightNVR was built without zlib");
+    return -1;
+#endif
+}
+
 // Restore database from backup
 int restore_database_from_backup(const char *backup_path, const char *db_path) {
     int rc;
@@ -213,6 +446,7 @@ int restore_database_from_backup(const char *backup_path, const char *db_path) {
     // Close the current database if it's open
     if (db) {
         log_info("Closing current database before restore");
+        db_stmt_cache_invalidate();
         sqlite3_close_v2(db);
         // Note: We don't set the global db to NULL here, as that's handled by the core module
     }
@@ -274,7 +508,7 @@ int restore_database_from_backup(const char *backup_path, const char *db_path) {
     if (rc == SQLITE_OK) {
         sqlite3_finalize(stmt);
         stmt = NULL;
-        if (run_integrity_check(test_db, db_path) != 0) {
+        if (run_integrity_check(test_db, db_path, false) != 0) {
             sqlite3_close(test_db);
             return -1;
         }
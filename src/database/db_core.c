@@ -24,6 +24,10 @@
 #include "database/db_schema.h"
 #include "database/db_migrations.h"
 #include "database/db_backup.h"
+#include "database/db_write_queue.h"
+#include "database/db_streams.h"
+#include "database/db_stream_cache.h"
+#include "database/db_auth_cache.h"
 #include "core/config.h"
 #include "core/logger.h"
 #include "core/path_utils.h"
@@ -47,7 +51,52 @@ static time_t last_backup_time = 0;
 // Flag to indicate if WAL mode is enabled
 static bool wal_mode_enabled = false;
 
-// No longer tracking prepared statements - each function is responsible for finalizing its own statements
+// Prepared statement cache. Hot queries borrow a compiled statement by SQL
+// text instead of preparing and finalizing it on every call.
+#define DB_STMT_CACHE_SIZE 128
+
+typedef struct {
+    sqlite3_stmt *stmt;         // NULL = free slot
+    uint32_t hash;              // Hash of the SQL text
+    bool in_use;                // Handed out by db_prepare_cached()
+    bool stale;                 // Invalidated while in use; finalized on release
+    uint64_t last_used;
+} db_stmt_cache_entry_t;
+
+static db_stmt_cache_entry_t stmt_cache[DB_STMT_CACHE_SIZE];
+static db_stmt_cache_stats_t stmt_cache_stats;
+static uint64_t stmt_cache_clock = 0;
+static pthread_mutex_t stmt_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+// Read-only connections for queries. Writes stay on db under db_mutex.
+#define DB_MAX_READ_CONNECTIONS 16
+
+static sqlite3 *read_conns[DB_MAX_READ_CONNECTIONS];
+static bool read_conn_busy[DB_MAX_READ_CONNECTIONS];
+static int read_conn_count = 0;
+static bool read_pool_closing = false;
+static pthread_mutex_t read_pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t read_pool_cond = PTHREAD_COND_INITIALIZER;
+
+// Longest a reader waits for a free read connection before it shares the
+// writer connection instead
+#define DB_READ_WAIT_SECONDS 2
+
+static db_lock_stats_t writer_lock_stats;
+static db_lock_stats_t reader_lock_stats;
+static pthread_mutex_t lock_stats_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+#define DB_WRITER_BUSY_TIMEOUT_MS 10000
+#define DB_CHECKPOINT_BUSY_TIMEOUT_MS 2000
+
+// Separate read-write connection for checkpoints. A PASSIVE checkpoint on it
+// copies WAL frames into the database while the writer keeps appending.
+static sqlite3 *checkpoint_conn = NULL;
+static pthread_mutex_t checkpoint_mutex = PTHREAD_MUTEX_INITIALIZER;
+static db_maintenance_stats_t maintenance_stats;
+static time_t last_maintenance_time = 0;
+static int last_total_changes = 0;
+static int deferred_runs = 0;
 
 static int sync_path_if_exists(const char *path) {
     int fd = open(path, O_RDONLY);
@@ -93,51 +142,6 @@ static int sync_parent_directory(const char *path) {
     return 0;
 }
 
-static int flush_database_to_disk(void) {
-    int sync_failed = 0;
-
-    if (!db || db_file_path[0] == '\0') {
-        log_error("Database not initialized, cannot flush to disk");
-        return -1;
-    }
-
-    pthread_mutex_lock(&db_mutex);
-
-#if SQLITE_VERSION_NUMBER >= 3007017
-    int cacheflush_rc = sqlite3_db_cacheflush(db);
-    if (cacheflush_rc != SQLITE_OK) {
-        log_warn("sqlite3_db_cacheflush failed: %s", sqlite3_errmsg(db));
-    }
-#endif
-
-    if (wal_mode_enabled) {
-        int checkpoint_rc = sqlite3_exec(db, "PRAGMA wal_checkpoint(FULL);", NULL, NULL, NULL);
-        if (checkpoint_rc != SQLITE_OK) {
-            log_error("Failed to checkpoint WAL before backup: %s", sqlite3_errmsg(db));
-            pthread_mutex_unlock(&db_mutex);
-            return -1;
-        }
-    }
-
-    pthread_mutex_unlock(&db_mutex);
-
-    sync_failed |= sync_path_if_exists(db_file_path);
-
-    char wal_path[PATH_MAX];
-    if (snprintf(wal_path, sizeof(wal_path), "%s-wal", db_file_path) < (int)sizeof(wal_path)) {
-        sync_failed |= sync_path_if_exists(wal_path);
-    }
-
-    char shm_path[PATH_MAX];
-    if (snprintf(shm_path, sizeof(shm_path), "%s-shm", db_file_path) < (int)sizeof(shm_path)) {
-        sync_failed |= sync_path_if_exists(shm_path);
-    }
-
-    sync_failed |= sync_parent_directory(db_file_path);
-
-    return sync_failed ? -1 : 0;
-}
-
 static int get_backup_directory(char *backup_dir, size_t backup_dir_size) {
     if (snprintf(backup_dir, backup_dir_size, "%s.backups", db_file_path) >= (int)backup_dir_size) {
         log_error("Backup directory path is too long for database %s", db_file_path);
@@ -175,7 +179,9 @@ static int build_timestamped_backup_path(const char *backup_dir, char *backup_pa
             log_error("Backup file path is too long for directory %s", backup_dir);
             return -1;
         }
-        if (access(backup_path, F_OK) != 0) {
+        char compressed_path[PATH_MAX + 3];
+        snprintf(compressed_path, sizeof(compressed_path), "%s.gz", backup_path);
+        if (access(backup_path, F_OK) != 0 && access(compressed_path, F_OK) != 0) {
             return 0;
         }
     }
@@ -405,11 +411,6 @@ static int perform_database_backup_cycle(const char *reason, bool run_post_backu
 
     log_info("Starting %s database backup cycle", reason);
 
-    if (flush_database_to_disk() != 0) {
-        log_error("Failed to flush database to disk before %s backup", reason);
-        return -1;
-    }
-
     if (get_backup_directory(backup_dir, sizeof(backup_dir)) != 0) {
         return -1;
     }
@@ -418,7 +419,9 @@ static int perform_database_backup_cycle(const char *reason, bool run_post_backu
         return -1;
     }
 
-    if (backup_database(db_file_path, timestamped_backup_path) != 0) {
+    // The backup API reads committed pages through the WAL, so there is no
+    // need to checkpoint first
+    if (backup_live_database(timestamped_backup_path) != 0) {
         log_error("Failed to create %s database backup", reason);
         return -1;
     }
@@ -428,8 +431,22 @@ static int perform_database_backup_cycle(const char *reason, bool run_post_backu
         return -1;
     }
 
+    // The latest .bak keeps the uncompressed copy so a restore can use it
+    // directly; only the timestamped history is compressed
+    const char *published_path = timestamped_backup_path;
+    char compressed_path[PATH_MAX];
+    if (g_config.db_backup_compress &&
+        snprintf(compressed_path, sizeof(compressed_path), "%s.gz", timestamped_backup_path) < (int)sizeof(compressed_path)) {
+        if (compress_backup_file(timestamped_backup_path, compressed_path) == 0) {
+            unlink(timestamped_backup_path);
+            published_path = compressed_path;
+        } else {
+            log_warn("Keeping uncompressed %s backup: %s", reason, timestamped_backup_path);
+        }
+    }
+
     if (run_post_backup_hook && g_config.db_post_backup_script[0] != '\0' &&
-        run_post_backup_script(timestamped_backup_path, backup_dir) != 0) {
+        run_post_backup_script(published_path, backup_dir) != 0) {
         log_warn("Post-backup script failed after %s backup", reason);
     }
 
@@ -437,14 +454,487 @@ static int perform_database_backup_cycle(const char *reason, bool run_post_backu
         log_warn("Failed to fully enforce backup retention after %s backup", reason);
     }
 
-    log_info("Completed %s database backup cycle: %s", reason, timestamped_backup_path);
+    log_info("Completed %s database backup cycle: %s", reason, published_path);
+    return 0;
+}
+
+static uint32_t sql_hash(const char *sql) {
+    // FNV-1a
+    uint32_t h = 2166136261u;
+    for (const unsigned char *p = (const unsigned char *)sql; *p; p++) {
+        h = (h ^ *p) * 16777619u;
+    }
+    return h;
+}
+
+sqlite3_stmt *db_prepare_cached(const char *sql) {
+    return db_prepare_cached_on(db, sql);
+}
+
+sqlite3_stmt *db_prepare_cached_on(sqlite3 *conn, const char *sql) {
+    if (!db || !conn || !sql) {
+        log_error("Database not initialized");
+        return NULL;
+    }
+
+    uint32_t hash = sql_hash(sql);
+
+    pthread_mutex_lock(&stmt_cache_mutex);
+    for (int i = 0; i < DB_STMT_CACHE_SIZE; i++) {
+        db_stmt_cache_entry_t *e = &stmt_cache[i];
+        if (e->stmt && !e->in_use && !e->stale && e->hash == hash &&
+            sqlite3_db_handle(e->stmt) == conn && strcmp(sqlite3_sql(e->stmt), sql) == 0) {
+            e->in_use = true;
+            e->last_used = ++stmt_cache_clock;
+            stmt_cache_stats.reuses++;
+            sqlite3_stmt *stmt = e->stmt;
+            pthread_mutex_unlock(&stmt_cache_mutex);
+            return stmt;
+        }
+    }
+    pthread_mutex_unlock(&stmt_cache_mutex);
+
+    sqlite3_stmt *stmt = NULL;
+#if SQLITE_VERSION_NUMBER >= 3020000
+    int rc = sqlite3_prepare_v3(conn, sql, -1, SQLITE_PREPARE_PERSISTENT, &stmt, NULL);
+#else
+    int rc = sqlite3_prepare_v2(conn, sql, -1, &stmt, NULL);
+#endif
+    if (rc != SQLITE_OK) {
+        log_error("Failed to prepare statement: %s", sqlite3_errmsg(conn));
+        return NULL;
+    }
+
+    // Keep it in a free slot, or in place of the least recently used idle statement
+    sqlite3_stmt *evicted = NULL;
+    pthread_mutex_lock(&stmt_cache_mutex);
+    stmt_cache_stats.prepares++;
+    db_stmt_cache_entry_t *slot = NULL;
+    for (int i = 0; i < DB_STMT_CACHE_SIZE; i++) {
+        db_stmt_cache_entry_t *e = &stmt_cache[i];
+        if (!e->stmt) {
+            slot = e;
+            break;
+        }
+        if (!e->in_use && (!slot || e->last_used < slot->last_used)) {
+            slot = e;
+        }
+    }
+    if (slot) {
+        if (slot->stmt) {
+            evicted = slot->stmt;
+        } else {
+            stmt_cache_stats.cached++;
+        }
+        slot->stmt = stmt;
+        slot->hash = hash;
+        slot->in_use = true;
+        slot->stale = false;
+        slot->last_used = ++stmt_cache_clock;
+    }
+    pthread_mutex_unlock(&stmt_cache_mutex);
+
+    if (evicted) {
+        sqlite3_finalize(evicted);
+    }
+    // With every slot in use the statement stays uncached and is finalized on release
+    return stmt;
+}
+
+void db_release_cached(sqlite3_stmt *stmt) {
+    if (!stmt) {
+        return;
+    }
+    // After shutdown the close sweep already finalized everything
+    if (!db) {
+        return;
+    }
+
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+
+    bool keep = false;
+    pthread_mutex_lock(&stmt_cache_mutex);
+    for (int i = 0; i < DB_STMT_CACHE_SIZE; i++) {
+        db_stmt_cache_entry_t *e = &stmt_cache[i];
+        if (e->stmt == stmt) {
+            if (e->stale) {
+                memset(e, 0, sizeof(*e));
+                stmt_cache_stats.cached--;
+            } else {
+                e->in_use = false;
+                keep = true;
+            }
+            break;
+        }
+    }
+    pthread_mutex_unlock(&stmt_cache_mutex);
+
+    if (!keep) {
+        sqlite3_finalize(stmt);
+    }
+}
+
+void db_stmt_cache_invalidate(void) {
+    sqlite3_stmt *idle[DB_STMT_CACHE_SIZE];
+    int n_idle = 0;
+
+    pthread_mutex_lock(&stmt_cache_mutex);
+    for (int i = 0; i < DB_STMT_CACHE_SIZE; i++) {
+        db_stmt_cache_entry_t *e = &stmt_cache[i];
+        if (!e->stmt) {
+            continue;
+        }
+        if (e->in_use) {
+            e->stale = true;
+        } else {
+            idle[n_idle++] = e->stmt;
+            memset(e, 0, sizeof(*e));
+            stmt_cache_stats.cached--;
+        }
+    }
+    stmt_cache_stats.invalidations++;
+    pthread_mutex_unlock(&stmt_cache_mutex);
+
+    for (int i = 0; i < n_idle; i++) {
+        sqlite3_finalize(idle[i]);
+    }
+    if (n_idle > 0) {
+        log_debug("Statement cache invalidated, finalized %d statements", n_idle);
+    }
+}
+
+// Forget statements the database close finalized
+static void stmt_cache_forget_all(void) {
+    pthread_mutex_lock(&stmt_cache_mutex);
+    memset(stmt_cache, 0, sizeof(stmt_cache));
+    stmt_cache_stats.cached = 0;
+    pthread_mutex_unlock(&stmt_cache_mutex);
+}
+
+void db_stmt_cache_get_stats(db_stmt_cache_stats_t *stats) {
+    if (!stats) {
+        return;
+    }
+
+    pthread_mutex_lock(&stmt_cache_mutex);
+    *stats = stmt_cache_stats;
+    pthread_mutex_unlock(&stmt_cache_mutex);
+}
+
+static uint64_t monotonic_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000;
+}
+
+static void count_lock(db_lock_stats_t *stats, bool waited, uint64_t wait_us) {
+    pthread_mutex_lock(&lock_stats_mutex);
+    stats->acquires++;
+    if (waited) {
+        stats->waits++;
+        stats->wait_us += wait_us;
+    }
+    pthread_mutex_unlock(&lock_stats_mutex);
+}
+
+void db_writer_lock(void) {
+    if (pthread_mutex_trylock(&db_mutex) == 0) {
+        count_lock(&writer_lock_stats, false, 0);
+        return;
+    }
+    uint64_t start = monotonic_us();
+    pthread_mutex_lock(&db_mutex);
+    count_lock(&writer_lock_stats, true, monotonic_us() - start);
+}
+
+void db_writer_unlock(void) {
+    pthread_mutex_unlock(&db_mutex);
+}
+
+// Open the read-only connections. Only useful in WAL mode, where readers
+// do not block the writer.
+static void read_pool_open(const char *db_path) {
+    int wanted = g_config.db_read_connections;
+    if (wanted <= 0 || !wal_mode_enabled) {
+        log_info("Database read pool disabled, queries share the writer connection");
+        return;
+    }
+    if (wanted > DB_MAX_READ_CONNECTIONS) {
+        wanted = DB_MAX_READ_CONNECTIONS;
+    }
+
+    pthread_mutex_lock(&read_pool_mutex);
+    read_pool_closing = false;
+    for (int i = 0; i < wanted; i++) {
+        sqlite3 *conn = NULL;
+        // Each connection is used by one thread at a time, so SQLite's own
+        // mutexes are not needed; a private cache keeps WAL concurrency
+        int rc = sqlite3_open_v2(db_path, &conn,
+                                 SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX | SQLITE_OPEN_PRIVATECACHE,
+                                 NULL);
+        if (rc != SQLITE_OK) {
+            log_warn("Failed to open read connection %d: %s", i, conn ? sqlite3_errmsg(conn) : "unknown error");
+            if (conn) {
+                sqlite3_close_v2(conn);
+            }
+            break;
+        }
+        sqlite3_busy_timeout(conn, 10000);
+        read_conns[read_conn_count] = conn;
+        read_conn_busy[read_conn_count] = false;
+        read_conn_count++;
+    }
+    int opened = read_conn_count;
+    pthread_mutex_unlock(&read_pool_mutex);
+
+    log_info("Opened %d read-only database connections", opened);
+}
+
+// Close the read-only connections once the queries running on them finish.
+// New readers fall back to the writer connection. The connections are
+// opened NOMUTEX, so one still in use is never closed under its reader;
+// a reader that never returns is left to the shutdown timeout.
+static void read_pool_close(void) {
+    pthread_mutex_lock(&read_pool_mutex);
+    if (read_conn_count == 0) {
+        pthread_mutex_unlock(&read_pool_mutex);
+        return;
+    }
+
+    read_pool_closing = true;
+    pthread_cond_broadcast(&read_pool_cond);
+
+    for (;;) {
+        int busy = 0;
+        for (int i = 0; i < read_conn_count; i++) {
+            busy += read_conn_busy[i] ? 1 : 0;
+        }
+        if (busy == 0) {
+            break;
+        }
+
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += 10;
+        if (pthread_cond_timedwait(&read_pool_cond, &read_pool_mutex, &deadline) == ETIMEDOUT) {
+            log_warn("%d read connections still busy after 10 seconds, waiting for them to close", busy);
+        }
+    }
+
+    sqlite3 *conns[DB_MAX_READ_CONNECTIONS];
+    int count = read_conn_count;
+    memcpy(conns, read_conns, sizeof(conns));
+    memset(read_conns, 0, sizeof(read_conns));
+    memset(read_conn_busy, 0, sizeof(read_conn_busy));
+    read_conn_count = 0;
+    pthread_cond_broadcast(&read_pool_cond);
+    pthread_mutex_unlock(&read_pool_mutex);
+
+    // Cached statements of the read connections must go first
+    db_stmt_cache_invalidate();
+    for (int i = 0; i < count; i++) {
+        sqlite3_close_v2(conns[i]);
+    }
+    log_info("Closed %d read-only database connections", count);
+}
+
+sqlite3 *db_reader_acquire(void) {
+    if (!db) {
+        log_error("Database not initialized");
+        return NULL;
+    }
+
+    bool waited = false;
+    uint64_t start = 0;
+    struct timespec deadline;
+
+    pthread_mutex_lock(&read_pool_mutex);
+    while (read_conn_count > 0 && !read_pool_closing) {
+        for (int i = 0; i < read_conn_count; i++) {
+            if (!read_conn_busy[i]) {
+                read_conn_busy[i] = true;
+                sqlite3 *conn = read_conns[i];
+                pthread_mutex_unlock(&read_pool_mutex);
+                count_lock(&reader_lock_stats, waited, waited ? monotonic_us() - start : 0);
+                return conn;
+            }
+        }
+        if (!waited) {
+            waited = true;
+            start = monotonic_us();
+            clock_gettime(CLOCK_REALTIME, &deadline);
+            deadline.tv_sec += DB_READ_WAIT_SECONDS;
+        }
+        if (pthread_cond_timedwait(&read_pool_cond, &read_pool_mutex, &deadline) == ETIMEDOUT) {
+            log_warn("All %d read connections busy for %d seconds, reading on the writer connection",
+                     read_conn_count, DB_READ_WAIT_SECONDS);
+            break;
+        }
+    }
+    pthread_mutex_unlock(&read_pool_mutex);
+
+    // No pool, pool closing or exhausted: share the writer connection
+    db_writer_lock();
+    if (!db) {
+        db_writer_unlock();
+        log_error("Database closed while waiting for a read connection");
+        return NULL;
+    }
+    return db;
+}
+
+void db_reader_release(sqlite3 *conn) {
+    if (!conn) {
+        return;
+    }
+    if (conn == db) {
+        db_writer_unlock();
+        return;
+    }
+
+    pthread_mutex_lock(&read_pool_mutex);
+    for (int i = 0; i < read_conn_count; i++) {
+        if (read_conns[i] == conn) {
+            read_conn_busy[i] = false;
+            break;
+        }
+    }
+    pthread_cond_broadcast(&read_pool_cond);
+    pthread_mutex_unlock(&read_pool_mutex);
+}
+
+void db_pool_get_stats(db_pool_stats_t *stats) {
+    if (!stats) {
+        return;
+    }
+
+    pthread_mutex_lock(&lock_stats_mutex);
+    stats->writer = writer_lock_stats;
+    stats->reader = reader_lock_stats;
+    pthread_mutex_unlock(&lock_stats_mutex);
+
+    pthread_mutex_lock(&read_pool_mutex);
+    stats->read_connections = read_conn_count;
+    stats->read_connections_busy = 0;
+    for (int i = 0; i < read_conn_count; i++) {
+        stats->read_connections_busy += read_conn_busy[i] ? 1 : 0;
+    }
+    pthread_mutex_unlock(&read_pool_mutex);
+}
+
+static void checkpoint_conn_open(const char *db_path) {
+    if (!wal_mode_enabled) {
+        return;
+    }
+
+    sqlite3 *conn = NULL;
+    int rc = sqlite3_open_v2(db_path, &conn,
+                             SQLITE_OPEN_READWRITE | SQLITE_OPEN_NOMUTEX | SQLITE_OPEN_PRIVATECACHE,
+                             NULL);
+    if (rc != SQLITE_OK) {
+        log_warn("Failed to open checkpoint connection, checkpointing on the writer: %s",
+                 conn ? sqlite3_errmsg(conn) : "unknown error");
+        if (conn) {
+            sqlite3_close_v2(conn);
+        }
+        return;
+    }
+    // Never writes, so never checkpoints on its own
+    sqlite3_wal_autocheckpoint(conn, 0);
+    sqlite3_busy_timeout(conn, DB_CHECKPOINT_BUSY_TIMEOUT_MS);
+    // Checkpoints are no-ops until the connection has read the database and
+    // found it in WAL mode
+    sqlite3_exec(conn, "PRAGMA schema_version;", NULL, NULL, NULL);
+
+    pthread_mutex_lock(&checkpoint_mutex);
+    checkpoint_conn = conn;
+    pthread_mutex_unlock(&checkpoint_mutex);
+
+    // With the scheduler running, SQLite's own checkpoint is only a ceiling
+    // on WAL growth during long busy periods
+    if (g_config.db_checkpoint_interval_seconds > 0) {
+        sqlite3_wal_autocheckpoint(db, g_config.db_wal_autocheckpoint_pages);
+    }
+}
+
+static void checkpoint_conn_close(void) {
+    pthread_mutex_lock(&checkpoint_mutex);
+    if (checkpoint_conn) {
+        sqlite3_close_v2(checkpoint_conn);
+        checkpoint_conn = NULL;
+    }
+    last_maintenance_time = 0;
+    last_total_changes = 0;
+    deferred_runs = 0;
+    pthread_mutex_unlock(&checkpoint_mutex);
+}
+
+static int64_t wal_file_size(void) {
+    char wal_path[PATH_MAX];
+    struct stat st;
+    if (snprintf(wal_path, sizeof(wal_path), "%s-wal", db_file_path) >= (int)sizeof(wal_path) ||
+        stat(wal_path, &st) != 0) {
+        return 0;
+    }
+    return (int64_t)st.st_size;
+}
+
+// Called with checkpoint_mutex held. PASSIVE runs beside the writer. FULL
+// waits for writers, so it holds the writer lock instead of letting SQLite's
+// busy handler spin against it. TRUNCATE runs without the writer lock and
+// gives up at once when the WAL is in use, so it never stalls recording
+// writes for the busy timeout; the caller copies the frames with a PASSIVE
+// checkpoint first, leaving TRUNCATE little to do but reset the file.
+static int run_checkpoint(int mode) {
+    sqlite3 *conn = checkpoint_conn ? checkpoint_conn : db;
+    bool hold_writer = (mode == SQLITE_CHECKPOINT_FULL) || conn == db;
+    int log_frames = 0;
+    int checkpointed_frames = 0;
+
+    if (hold_writer) {
+        db_writer_lock();
+    }
+    if (mode == SQLITE_CHECKPOINT_TRUNCATE) {
+        sqlite3_busy_timeout(conn, 0);
+    }
+    uint64_t start = monotonic_us();
+    int rc = sqlite3_wal_checkpoint_v2(conn, NULL, mode, &log_frames, &checkpointed_frames);
+    uint64_t elapsed = monotonic_us() - start;
+    if (mode == SQLITE_CHECKPOINT_TRUNCATE) {
+        sqlite3_busy_timeout(conn, conn == db ? DB_WRITER_BUSY_TIMEOUT_MS : DB_CHECKPOINT_BUSY_TIMEOUT_MS);
+    }
+    if (hold_writer) {
+        db_writer_unlock();
+    }
+
+    maintenance_stats.duration_us += elapsed;
+    maintenance_stats.last_duration_us = elapsed;
+    maintenance_stats.wal_bytes = wal_file_size();
+    if (mode == SQLITE_CHECKPOINT_PASSIVE) {
+        maintenance_stats.passive++;
+    } else if (mode == SQLITE_CHECKPOINT_TRUNCATE) {
+        maintenance_stats.truncate++;
+    } else {
+        maintenance_stats.full++;
+    }
+
+    if (rc == SQLITE_BUSY || (rc == SQLITE_OK && checkpointed_frames < log_frames)) {
+        // Readers still need older frames; the next run picks up the rest
+        maintenance_stats.busy++;
+        return 0;
+    }
+    if (rc != SQLITE_OK) {
+        log_error("Failed to checkpoint WAL: %s", sqlite3_errmsg(conn));
+        return -1;
+    }
+
+    log_debug("WAL checkpoint copied %d frames in %llu us", checkpointed_frames, (unsigned long long)elapsed);
     return 0;
 }
 
 // Function to checkpoint the database WAL file
 int checkpoint_database(void) {
-    int rc = SQLITE_OK;
-
     if (!db) {
         log_error("Database not initialized");
         return -1;
@@ -455,21 +945,92 @@ int checkpoint_database(void) {
         return 0;
     }
 
-    pthread_mutex_lock(&db_mutex);
-
     log_info("Checkpointing WAL file");
-    rc = sqlite3_exec(db, "PRAGMA wal_checkpoint(FULL);", NULL, NULL, NULL);
-    if (rc != SQLITE_OK) {
-        log_error("Failed to checkpoint WAL: %s", sqlite3_errmsg(db));
-        pthread_mutex_unlock(&db_mutex);
+    pthread_mutex_lock(&checkpoint_mutex);
+    int rc = run_checkpoint(SQLITE_CHECKPOINT_FULL);
+    pthread_mutex_unlock(&checkpoint_mutex);
+
+    if (rc != 0) {
         return -1;
     }
 
     log_info("WAL checkpoint successful");
-    pthread_mutex_unlock(&db_mutex);
     return 0;
 }
 
+int maybe_run_database_maintenance(void) {
+    if (!db || g_config.db_checkpoint_interval_seconds <= 0) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&checkpoint_mutex);
+
+    time_t now = time(NULL);
+    if (last_maintenance_time != 0 &&
+        now - last_maintenance_time < (time_t)g_config.db_checkpoint_interval_seconds) {
+        pthread_mutex_unlock(&checkpoint_mutex);
+        return 0;
+    }
+
+    // Rows written on the writer connection since the previous run
+    int total_changes = sqlite3_total_changes(db);
+    int written = total_changes - last_total_changes;
+    bool first_run = (last_maintenance_time == 0);
+    last_total_changes = total_changes;
+    last_maintenance_time = now;
+
+    // A database that is never quiet still gets a run every
+    // checkpoint_max_deferrals windows
+    if (!first_run && written > g_config.db_checkpoint_idle_writes) {
+        if (g_config.db_checkpoint_max_deferrals <= 0 ||
+            deferred_runs < g_config.db_checkpoint_max_deferrals) {
+            deferred_runs++;
+            maintenance_stats.skipped++;
+            if (wal_mode_enabled) {
+                maintenance_stats.wal_bytes = wal_file_size();
+            }
+            pthread_mutex_unlock(&checkpoint_mutex);
+            return 0;
+        }
+        log_debug("Running database maintenance after %d busy intervals", deferred_runs);
+    }
+    deferred_runs = 0;
+
+    int result = 0;
+    if (wal_mode_enabled) {
+        int64_t truncate_bytes = (int64_t)g_config.db_wal_truncate_mb * 1024 * 1024;
+        bool truncate = wal_file_size() > truncate_bytes;
+        result = run_checkpoint(SQLITE_CHECKPOINT_PASSIVE);
+        if (result == 0 && truncate) {
+            result = run_checkpoint(SQLITE_CHECKPOINT_TRUNCATE);
+        }
+    }
+    pthread_mutex_unlock(&checkpoint_mutex);
+
+    if (g_config.db_incremental_vacuum_pages > 0) {
+        int released = incremental_vacuum_database(g_config.db_incremental_vacuum_pages);
+        if (released < 0) {
+            result = -1;
+        } else {
+            pthread_mutex_lock(&checkpoint_mutex);
+            maintenance_stats.vacuum_pages += (uint64_t)released;
+            pthread_mutex_unlock(&checkpoint_mutex);
+        }
+    }
+
+    return result;
+}
+
+void db_maintenance_get_stats(db_maintenance_stats_t *stats) {
+    if (!stats) {
+        return;
+    }
+
+    pthread_mutex_lock(&checkpoint_mutex);
+    memcpy(stats, &maintenance_stats, sizeof(db_maintenance_stats_t));
+    pthread_mutex_unlock(&checkpoint_mutex);
+}
+
 int maybe_run_scheduled_database_backup(void) {
     if (!db || db_file_path[0] == '\0') {
         return 0;
@@ -681,12 +1242,26 @@ int init_database(const char *db_path) {
     }
 
     // Set busy timeout to avoid "database is locked" errors
-    rc = sqlite3_busy_timeout(db, 10000);  // 10 seconds
+    rc = sqlite3_busy_timeout(db, DB_WRITER_BUSY_TIMEOUT_MS);
     if (rc != SQLITE_OK) {
         log_warn("Failed to set busy timeout: %s", sqlite3_errmsg(db));
         // Continue anyway
     }
 
+    // Enable auto_vacuum to keep the database file size manageable. This has
+    // to happen before journal_mode=WAL writes the header of a new database;
+    // an existing database keeps its mode until the next full VACUUM.
+    log_info("Enabling auto_vacuum");
+    rc = sqlite3_exec(db, "PRAGMA auto_vacuum=INCREMENTAL;", NULL, NULL, &err_msg);
+    if (rc != SQLITE_OK) {
+        log_warn("Failed to enable auto_vacuum: %s", err_msg);
+        if (err_msg) {
+            sqlite3_free(err_msg);
+            err_msg = NULL;
+        }
+        // Continue anyway
+    }
+
     // Enable WAL mode for better performance and crash resistance
     log_info("Enabling WAL mode for better crash resistance");
     rc = sqlite3_exec(db, "PRAGMA journal_mode=WAL;", NULL, NULL, &err_msg);
@@ -727,18 +1302,6 @@ int init_database(const char *db_path) {
         // Continue anyway
     }
 
-    // Enable auto_vacuum to keep the database file size manageable
-    log_info("Enabling auto_vacuum");
-    rc = sqlite3_exec(db, "PRAGMA auto_vacuum=INCREMENTAL;", NULL, NULL, &err_msg);
-    if (rc != SQLITE_OK) {
-        log_warn("Failed to enable auto_vacuum: %s", err_msg);
-        if (err_msg) {
-            sqlite3_free(err_msg);
-            err_msg = NULL;
-        }
-        // Continue anyway
-    }
-
     // Check if we can write to the database
     log_info("Testing database write capability");
     rc = sqlite3_exec(db, "CREATE TABLE IF NOT EXISTS test_table (id INTEGER);", NULL, NULL, &err_msg);
@@ -799,6 +1362,15 @@ int init_database(const char *db_path) {
         return -1;
     }
 
+    read_pool_open(db_path);
+    checkpoint_conn_open(db_path);
+    db_write_queue_init();
+
+    // Stream configurations are read far more often than written; serve them from memory
+    if (load_stream_config_cache() != 0) {
+        log_warn("Failed to load stream configuration cache, reading stream configurations from the database");
+    }
+
     log_info("Database initialized successfully");
 
     // Create an initial backup if this is a new database
@@ -836,6 +1408,11 @@ static void reset_sqlite_internal_state(void) {
 void shutdown_database(void) {
     log_info("Starting database shutdown process");
 
+    // Commit queued writes while the database is fully available
+    db_write_queue_shutdown();
+    stream_config_cache_clear();
+    db_auth_cache_clear();
+
     // Create a final backup before shutting down
     if (db != NULL && db_file_path[0] != '\0') {
         log_info("Creating final backup before shutdown");
@@ -894,7 +1471,11 @@ void shutdown_database(void) {
             }
         }
 
-        // No longer using tracked statements - we now rely on sqlite3_next_stmt to find all statements
+        // Close the read connections, then drop the statement cache; the
+        // sweep below finalizes anything still handed out
+        checkpoint_conn_close();
+        read_pool_close();
+        db_stmt_cache_invalidate();
 
         // Finalize all prepared statements before closing the database
         // This helps prevent "corrupted size vs. prev_size in fastbins" errors
@@ -964,6 +1545,7 @@ void shutdown_database(void) {
         // Only set the global handle to NULL after the database is successfully closed
         // or after all attempts to close it have been made
         db = NULL;
+        stmt_cache_forget_all();
 
         // Reset SQLite internal state to prevent memory leaks
         reset_sqlite_internal_state();
@@ -9,156 +9,334 @@
 #include <sqlite3.h>
 #include <stdbool.h>
 #include <math.h>
+#include <stddef.h>
 
 #include "database/db_detections.h"
 #include "database/db_core.h"
+#include "database/db_recordings.h"
+#include "database/db_write_queue.h"
+#include "core/config.h"
 #include "core/logger.h"
 #include "utils/strings.h"
 #include "video/detection_result.h"
+#include "video/object_tracker.h"
+
+// Detections copied for the write queue; only the first count entries of
+// detections[] are part of the payload
+typedef struct {
+    char stream_name[MAX_STREAM_NAME];
+    time_t timestamp;
+    uint64_t recording_id;
+    int count;
+    detection_t detections[MAX_DETECTIONS];
+} detection_write_t;
+
+// Count the detections of the write sharing the label of detections[i].
+// Returns false if an earlier detection has the same label, so each label
+// is handled once.
+static bool label_totals(const detection_write_t *w, int i, int *count, float *max_confidence) {
+    const char *label = w->detections[i].label;
+    for (int j = 0; j < i; j++) {
+        if (strcmp(w->detections[j].label, label) == 0) {
+            return false;
+        }
+    }
 
-/**
- * Store detection results in the database
- *
- * @param stream_name Stream name
- * @param result Detection results
- * @param timestamp Timestamp of the detection (0 for current time)
- * @param recording_id Recording ID to link detections to (0 for no link)
- * @return 0 on success, non-zero on failure
- */
-int store_detections_in_db(const char *stream_name, const detection_result_t *result,
-                           time_t timestamp, uint64_t recording_id) {
-    int rc;
-    sqlite3_stmt *stmt;
-    
-    sqlite3 *db = get_db_handle();
-    pthread_mutex_t *db_mutex = get_db_mutex();
-    
-    if (!db) {
-        log_error("Database not initialized when trying to store detections");
+    *count = 0;
+    *max_confidence = 0.0f;
+    for (int j = i; j < w->count; j++) {
+        if (strcmp(w->detections[j].label, label) == 0) {
+            (*count)++;
+            if (w->detections[j].confidence > *max_confidence) {
+                *max_confidence = w->detections[j].confidence;
+            }
+        }
+    }
+    return true;
+}
+
+// Add stored detections to the summary of every recording they belong to:
+// the linked recording and completed recordings of the stream covering the
+// timestamp. Recordings still in progress are recounted when they complete.
+static int update_detection_summaries(sqlite3 *db, const detection_write_t *w) {
+    static const char *recording_sql =
+        "UPDATE recordings SET detection_count = detection_count + ?1, "
+        "max_confidence = MAX(max_confidence, ?2) "
+        "WHERE id = ?3 OR (stream_name = ?4 AND start_time <= ?5 AND end_time >= ?5);";
+    static const char *label_sql =
+        "INSERT INTO recording_detection_labels (recording_id, label, count, max_confidence) "
+        "SELECT id, ?1, ?2, ?3 FROM recordings "
+        "WHERE id = ?4 OR (stream_name = ?5 AND start_time <= ?6 AND end_time >= ?6) "
+        "ON CONFLICT(recording_id, label) DO UPDATE SET count = count + excluded.count, "
+        "max_confidence = MAX(max_confidence, excluded.max_confidence);";
+
+    if (w->count <= 0) {
+        return 0;
+    }
+
+    sqlite3_stmt *stmt = db_prepare_cached(label_sql);
+    if (!stmt) {
         return -1;
     }
-    
-    if (!stream_name || !result) {
-        log_error("Invalid parameters for store_detections_in_db: stream_name=%p, result=%p", 
-                 stream_name, result);
+
+    // One upsert per distinct label in this write
+    float max_confidence = 0.0f;
+    for (int i = 0; i < w->count; i++) {
+        const detection_t *d = &w->detections[i];
+        if (d->confidence > max_confidence) {
+            max_confidence = d->confidence;
+        }
+
+        int label_count;
+        float label_confidence;
+        if (!label_totals(w, i, &label_count, &label_confidence)) {
+            continue;
+        }
+
+        sqlite3_bind_text(stmt, 1, d->label, -1, SQLITE_STATIC);
+        sqlite3_bind_int(stmt, 2, label_count);
+        sqlite3_bind_double(stmt, 3, label_confidence);
+        if (w->recording_id > 0) {
+            sqlite3_bind_int64(stmt, 4, (sqlite3_int64)w->recording_id);
+        } else {
+            sqlite3_bind_null(stmt, 4);
+        }
+        sqlite3_bind_text(stmt, 5, w->stream_name, -1, SQLITE_STATIC);
+        sqlite3_bind_int64(stmt, 6, (sqlite3_int64)w->timestamp);
+
+        if (sqlite3_step(stmt) != SQLITE_DONE) {
+            log_error("Failed to update recording detection labels: %s", sqlite3_errmsg(db));
+            db_release_cached(stmt);
+            return -1;
+        }
+        sqlite3_reset(stmt);
+        sqlite3_clear_bindings(stmt);
+    }
+    db_release_cached(stmt);
+
+    stmt = db_prepare_cached(recording_sql);
+    if (!stmt) {
         return -1;
     }
-    
-    // Use current time if timestamp is 0
-    if (timestamp == 0) {
-        timestamp = time(NULL);
+    sqlite3_bind_int(stmt, 1, w->count);
+    sqlite3_bind_double(stmt, 2, max_confidence);
+    if (w->recording_id > 0) {
+        sqlite3_bind_int64(stmt, 3, (sqlite3_int64)w->recording_id);
+    } else {
+        sqlite3_bind_null(stmt, 3);
     }
-    
-    log_debug("Storing %d detections in database for stream %s", result->count, stream_name);
+    sqlite3_bind_text(stmt, 4, w->stream_name, -1, SQLITE_STATIC);
+    sqlite3_bind_int64(stmt, 5, (sqlite3_int64)w->timestamp);
 
-    // Log the first detection for debugging
-    if (result->count > 0) {
-        log_debug("First detection: %s (%.2f%%) at [%.2f, %.2f, %.2f, %.2f]",
-                result->detections[0].label,
-                result->detections[0].confidence * 100.0f,
-                result->detections[0].x,
-                result->detections[0].y,
-                result->detections[0].width,
-                result->detections[0].height);
+    int rc = sqlite3_step(stmt);
+    if (rc != SQLITE_DONE) {
+        log_error("Failed to update recording detection count: %s", sqlite3_errmsg(db));
     }
-    
-    pthread_mutex_lock(db_mutex);
-    
-    // Note: detections table is created by SQL migrations (see db/migrations/)
-    // No need for runtime table existence checks or fallback creation.
-    char *err_msg = NULL;
-    char **query_result;
-    int rows, cols;
+    db_release_cached(stmt);
+    return rc == SQLITE_DONE ? 0 : -1;
+}
 
-    // Begin transaction for better performance when inserting multiple detections
-    rc = sqlite3_exec(db, "BEGIN TRANSACTION;", NULL, NULL, &err_msg);
-    if (rc != SQLITE_OK) {
-        log_error("Failed to begin transaction: %s", err_msg);
-        sqlite3_free(err_msg);
-        pthread_mutex_unlock(db_mutex);
+// Add stored detections to the minute and hour rollups of their stream
+static int update_detection_rollups(sqlite3 *db, const detection_write_t *w) {
+    static const char *sql =
+        "INSERT INTO detection_rollups (stream_name, bucket_seconds, bucket_start, label, count, max_confidence) "
+        "VALUES (?1, ?2, ?3, ?4, ?5, ?6) "
+        "ON CONFLICT(stream_name, bucket_seconds, bucket_start, label) DO UPDATE SET "
+        "count = count + excluded.count, "
+        "max_confidence = MAX(max_confidence, excluded.max_confidence);";
+    static const int bucket_sizes[] = { DETECTION_ROLLUP_MINUTE, DETECTION_ROLLUP_HOUR };
+
+    if (w->count <= 0) {
+        return 0;
+    }
+
+    sqlite3_stmt *stmt = db_prepare_cached(sql);
+    if (!stmt) {
         return -1;
     }
-    
-    const char *sql = "INSERT INTO detections (stream_name, timestamp, label, confidence, x, y, width, height, track_id, zone_id, recording_id) "
-                      "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?);";
 
-    rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
-    if (rc != SQLITE_OK) {
-        log_error("Failed to prepare statement: %s", sqlite3_errmsg(db));
-        sqlite3_exec(db, "ROLLBACK;", NULL, NULL, NULL);
-        pthread_mutex_unlock(db_mutex);
+    for (int i = 0; i < w->count; i++) {
+        int label_count;
+        float label_confidence;
+        if (!label_totals(w, i, &label_count, &label_confidence)) {
+            continue;
+        }
+
+        for (size_t b = 0; b < sizeof(bucket_sizes) / sizeof(bucket_sizes[0]); b++) {
+            sqlite3_bind_text(stmt, 1, w->stream_name, -1, SQLITE_STATIC);
+            sqlite3_bind_int(stmt, 2, bucket_sizes[b]);
+            sqlite3_bind_int64(stmt, 3, (sqlite3_int64)(w->timestamp - w->timestamp % bucket_sizes[b]));
+            sqlite3_bind_text(stmt, 4, w->detections[i].label, -1, SQLITE_STATIC);
+            sqlite3_bind_int(stmt, 5, label_count);
+            sqlite3_bind_double(stmt, 6, label_confidence);
+
+            if (sqlite3_step(stmt) != SQLITE_DONE) {
+                log_error("Failed to update detection rollups: %s", sqlite3_errmsg(db));
+                db_release_cached(stmt);
+                return -1;
+            }
+            sqlite3_reset(stmt);
+        }
+    }
+
+    db_release_cached(stmt);
+    return 0;
+}
+
+// Insert detections; the caller holds the writer lock and an open transaction
+static int insert_detections(sqlite3 *db, const void *payload) {
+    const detection_write_t *w = payload;
+
+    const char *sql = "INSERT INTO detections (stream_name, timestamp, label, confidence, x, y, width, height, track_id, zone_id, recording_id, track_event) "
+                      "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?);";
+
+    sqlite3_stmt *stmt = db_prepare_cached(sql);
+    if (!stmt) {
         return -1;
     }
 
     // Insert each detection
-    for (int i = 0; i < result->count; i++) {
+    for (int i = 0; i < w->count; i++) {
+        const detection_t *d = &w->detections[i];
+
         // Bind parameters
-        sqlite3_bind_text(stmt, 1, stream_name, -1, SQLITE_STATIC);
-        sqlite3_bind_int64(stmt, 2, (sqlite3_int64)timestamp);
-        sqlite3_bind_text(stmt, 3, result->detections[i].label, -1, SQLITE_STATIC);
-        sqlite3_bind_double(stmt, 4, result->detections[i].confidence);
-        sqlite3_bind_double(stmt, 5, result->detections[i].x);
-        sqlite3_bind_double(stmt, 6, result->detections[i].y);
-        sqlite3_bind_double(stmt, 7, result->detections[i].width);
-        sqlite3_bind_double(stmt, 8, result->detections[i].height);
-        sqlite3_bind_int(stmt, 9, result->detections[i].track_id);
-        sqlite3_bind_text(stmt, 10, result->detections[i].zone_id, -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 1, w->stream_name, -1, SQLITE_STATIC);
+        sqlite3_bind_int64(stmt, 2, (sqlite3_int64)w->timestamp);
+        sqlite3_bind_text(stmt, 3, d->label, -1, SQLITE_STATIC);
+        sqlite3_bind_double(stmt, 4, d->confidence);
+        sqlite3_bind_double(stmt, 5, d->x);
+        sqlite3_bind_double(stmt, 6, d->y);
+        sqlite3_bind_double(stmt, 7, d->width);
+        sqlite3_bind_double(stmt, 8, d->height);
+        sqlite3_bind_int(stmt, 9, d->track_id);
+        sqlite3_bind_text(stmt, 10, d->zone_id, -1, SQLITE_STATIC);
 
         // Bind recording_id - NULL if 0, otherwise the actual ID
-        if (recording_id > 0) {
-            sqlite3_bind_int64(stmt, 11, (sqlite3_int64)recording_id);
+        if (w->recording_id > 0) {
+            sqlite3_bind_int64(stmt, 11, (sqlite3_int64)w->recording_id);
         } else {
             sqlite3_bind_null(stmt, 11);
         }
-        
+
+        // Track lifecycle event - NULL for untracked detections
+        const char *track_event = track_event_name(d->track_event);
+        if (track_event) {
+            sqlite3_bind_text(stmt, 12, track_event, -1, SQLITE_STATIC);
+        } else {
+            sqlite3_bind_null(stmt, 12);
+        }
+
         // Execute statement
-        rc = sqlite3_step(stmt);
-        if (rc != SQLITE_DONE) {
+        if (sqlite3_step(stmt) != SQLITE_DONE) {
             log_error("Failed to insert detection %d: %s", i, sqlite3_errmsg(db));
-            sqlite3_finalize(stmt);
-            sqlite3_exec(db, "ROLLBACK;", NULL, NULL, NULL);
-            pthread_mutex_unlock(db_mutex);
+            db_release_cached(stmt);
             return -1;
         }
-        
+
         // Reset statement and clear bindings for next detection
         sqlite3_reset(stmt);
         sqlite3_clear_bindings(stmt);
     }
-    
-    // Untrack and finalize the prepared statement
-    sqlite3_finalize(stmt);
-    
-    // Commit transaction
-    rc = sqlite3_exec(db, "COMMIT;", NULL, NULL, &err_msg);
-    if (rc != SQLITE_OK) {
-        log_error("Failed to commit transaction: %s", err_msg);
-        sqlite3_free(err_msg);
-        sqlite3_exec(db, "ROLLBACK;", NULL, NULL, NULL);
-        pthread_mutex_unlock(db_mutex);
+
+    db_release_cached(stmt);
+    if (update_detection_summaries(db, w) != 0) {
         return -1;
     }
-    
-    // Verify the detections were stored
-    char verify_sql[256];
-    snprintf(verify_sql, sizeof(verify_sql), 
-            "SELECT COUNT(*) FROM detections WHERE stream_name = '%s' AND timestamp = %lld;",
-            stream_name, (long long)timestamp);
-    
-    rc = sqlite3_get_table(db, verify_sql, &query_result, &rows, &cols, &err_msg);
-    if (rc != SQLITE_OK) {
-        log_error("Failed to verify detections were stored: %s", err_msg);
-        sqlite3_free(err_msg);
-    } else if (rows > 0 && cols > 0) {
-        int count = (int)strtol(query_result[1], NULL, 10); // First row, first column
-        log_debug("Verified %d detections were stored in database for stream %s", count, stream_name);
-        sqlite3_free_table(query_result);
+    return update_detection_rollups(db, w);
+}
+
+// Copy detections into a write payload; returns the payload size or 0
+static size_t prepare_detection_write(detection_write_t *w, const char *stream_name,
+                                      const detection_result_t *result, time_t timestamp,
+                                      uint64_t recording_id) {
+    if (!stream_name || !result) {
+        log_error("Invalid parameters for store_detections_in_db: stream_name=%p, result=%p",
+                 stream_name, result);
+        return 0;
     }
 
-    pthread_mutex_unlock(db_mutex);
+    int count = result->count;
+    if (count < 0) {
+        count = 0;
+    } else if (count > MAX_DETECTIONS) {
+        count = MAX_DETECTIONS;
+    }
 
-    log_debug("Successfully stored %d detections in database for stream %s", result->count, stream_name);
-    return 0;
+    safe_strcpy(w->stream_name, stream_name, sizeof(w->stream_name), 0);
+    // Use current time if timestamp is 0
+    w->timestamp = timestamp != 0 ? timestamp : time(NULL);
+    w->recording_id = recording_id;
+    w->count = count;
+    memcpy(w->detections, result->detections, (size_t)count * sizeof(detection_t));
+
+    log_debug("Storing %d detections in database for stream %s", count, stream_name);
+
+    // Log the first detection for debugging
+    if (count > 0) {
+        log_debug("First detection: %s (%.2f%%) at [%.2f, %.2f, %.2f, %.2f]",
+                result->detections[0].label,
+                result->detections[0].confidence * 100.0f,
+                result->detections[0].x,
+                result->detections[0].y,
+                result->detections[0].width,
+                result->detections[0].height);
+    }
+
+    return offsetof(detection_write_t, detections) + (size_t)count * sizeof(detection_t);
+}
+
+/**
+ * Store detection results in the database
+ *
+ * @param stream_name Stream name
+ * @param result Detection results
+ * @param timestamp Timestamp of the detection (0 for current time)
+ * @param recording_id Recording ID to link detections to (0 for no link)
+ * @return 0 on success, non-zero on failure
+ */
+int store_detections_in_db(const char *stream_name, const detection_result_t *result,
+                           time_t timestamp, uint64_t recording_id) {
+    if (!get_db_handle()) {
+        log_error("Database not initialized when trying to store detections");
+        return -1;
+    }
+
+    detection_write_t *w = malloc(sizeof(detection_write_t));
+    if (!w) {
+        log_error("Failed to allocate memory for detections");
+        return -1;
+    }
+    int rc = -1;
+    if (prepare_detection_write(w, stream_name, result, timestamp, recording_id) > 0) {
+        rc = db_write_now(insert_detections, w);
+    }
+    free(w);
+
+    if (rc == 0) {
+        log_debug("Successfully stored %d detections in database for stream %s", result->count, stream_name);
+    }
+    return rc;
+}
+
+int queue_detections_for_db(const char *stream_name, const detection_result_t *result,
+                            time_t timestamp, uint64_t recording_id) {
+    if (!get_db_handle()) {
+        log_error("Database not initialized when trying to store detections");
+        return -1;
+    }
+
+    detection_write_t *w = malloc(sizeof(detection_write_t));
+    if (!w) {
+        log_error("Failed to allocate memory for detections");
+        return -1;
+    }
+    int rc = -1;
+    size_t size = prepare_detection_write(w, stream_name, result, timestamp, recording_id);
+    if (size > 0) {
+        rc = db_write_queue_submit(insert_detections, w, size);
+    }
+    free(w);
+    return rc;
 }
 
 /**
@@ -177,7 +355,6 @@ int get_detections_from_db_time_range(const char *stream_name, detection_result_
     sqlite3_stmt *stmt;
     
     sqlite3 *db = get_db_handle();
-    pthread_mutex_t *db_mutex = get_db_mutex();
     
     if (!db) {
         log_error("Database not initialized");
@@ -192,7 +369,7 @@ int get_detections_from_db_time_range(const char *stream_name, detection_result_
     // Initialize result
     memset(result, 0, sizeof(detection_result_t));
     
-    pthread_mutex_lock(db_mutex);
+    db_writer_lock();
     
     // Build query based on filters
     char sql[512];
@@ -212,7 +389,7 @@ int get_detections_from_db_time_range(const char *stream_name, detection_result_
         rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
         if (rc != SQLITE_OK) {
             log_error("Failed to prepare statement: %s", sqlite3_errmsg(db));
-            pthread_mutex_unlock(db_mutex);
+            db_writer_unlock();
             return -1;
         }
         
@@ -236,7 +413,7 @@ int get_detections_from_db_time_range(const char *stream_name, detection_result_
         rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
         if (rc != SQLITE_OK) {
             log_error("Failed to prepare statement: %s", sqlite3_errmsg(db));
-            pthread_mutex_unlock(db_mutex);
+            db_writer_unlock();
             return -1;
         }
         
@@ -259,7 +436,7 @@ int get_detections_from_db_time_range(const char *stream_name, detection_result_
         rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
         if (rc != SQLITE_OK) {
             log_error("Failed to prepare statement: %s", sqlite3_errmsg(db));
-            pthread_mutex_unlock(db_mutex);
+            db_writer_unlock();
             return -1;
         }
         
@@ -286,7 +463,7 @@ int get_detections_from_db_time_range(const char *stream_name, detection_result_
         rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
         if (rc != SQLITE_OK) {
             log_error("Failed to prepare statement: %s", sqlite3_errmsg(db));
-            pthread_mutex_unlock(db_mutex);
+            db_writer_unlock();
             return -1;
         }
 
@@ -308,7 +485,7 @@ int get_detections_from_db_time_range(const char *stream_name, detection_result_
         rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
         if (rc != SQLITE_OK) {
             log_error("Failed to prepare statement: %s", sqlite3_errmsg(db));
-            pthread_mutex_unlock(db_mutex);
+            db_writer_unlock();
             return -1;
         }
         
@@ -347,7 +524,7 @@ int get_detections_from_db_time_range(const char *stream_name, detection_result_
     result->count = count;
 
     sqlite3_finalize(stmt);
-    pthread_mutex_unlock(db_mutex);
+    db_writer_unlock();
 
     log_info("Found %d detections in database for stream %s (start=%lld, end=%lld)",
              count, stream_name, (long long)start_time, (long long)end_time);
@@ -371,7 +548,6 @@ int get_detection_timestamps(const char *stream_name, const detection_result_t *
     sqlite3_stmt *stmt;
     
     sqlite3 *db = get_db_handle();
-    pthread_mutex_t *db_mutex = get_db_mutex();
     
     if (!db) {
         log_error("Database not initialized");
@@ -383,7 +559,7 @@ int get_detection_timestamps(const char *stream_name, const detection_result_t *
         return -1;
     }
     
-    pthread_mutex_lock(db_mutex);
+    db_writer_lock();
     
     // Build query based on filters
     char sql[512];
@@ -400,7 +576,7 @@ int get_detection_timestamps(const char *stream_name, const detection_result_t *
         rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
         if (rc != SQLITE_OK) {
             log_error("Failed to prepare statement: %s", sqlite3_errmsg(db));
-            pthread_mutex_unlock(db_mutex);
+            db_writer_unlock();
             return -1;
         }
 
@@ -421,7 +597,7 @@ int get_detection_timestamps(const char *stream_name, const detection_result_t *
         rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
         if (rc != SQLITE_OK) {
             log_error("Failed to prepare statement: %s", sqlite3_errmsg(db));
-            pthread_mutex_unlock(db_mutex);
+            db_writer_unlock();
             return -1;
         }
         
@@ -441,7 +617,7 @@ int get_detection_timestamps(const char *stream_name, const detection_result_t *
         rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
         if (rc != SQLITE_OK) {
             log_error("Failed to prepare statement: %s", sqlite3_errmsg(db));
-            pthread_mutex_unlock(db_mutex);
+            db_writer_unlock();
             return -1;
         }
         
@@ -465,7 +641,7 @@ int get_detection_timestamps(const char *stream_name, const detection_result_t *
         rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
         if (rc != SQLITE_OK) {
             log_error("Failed to prepare statement: %s", sqlite3_errmsg(db));
-            pthread_mutex_unlock(db_mutex);
+            db_writer_unlock();
             return -1;
         }
         
@@ -485,7 +661,7 @@ int get_detection_timestamps(const char *stream_name, const detection_result_t *
         rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
         if (rc != SQLITE_OK) {
             log_error("Failed to prepare statement: %s", sqlite3_errmsg(db));
-            pthread_mutex_unlock(db_mutex);
+            db_writer_unlock();
             return -1;
         }
         
@@ -506,7 +682,7 @@ int get_detection_timestamps(const char *stream_name, const detection_result_t *
     }
 
     sqlite3_finalize(stmt);
-    pthread_mutex_unlock(db_mutex);
+    db_writer_unlock();
 
     return 0;
 }
@@ -524,23 +700,75 @@ int get_detections_from_db(const char *stream_name, detection_result_t *result,
     return get_detections_from_db_time_range(stream_name, result, max_age, 0, 0);
 }
 
+// Parts of [start, end] answered from each source: hour rollups cover the
+// whole hours inside the range, minute rollups the whole minutes around
+// them, and the detections table the seconds at either edge.
+typedef struct {
+    time_t start;           // Detections from start up to minute_start
+    time_t minute_start;    // Minute rollups from minute_start up to hour_start
+    time_t hour_start;      // Hour rollups from hour_start up to hour_end
+    time_t hour_end;        // Minute rollups from hour_end up to minute_end
+    time_t minute_end;      // Detections from minute_end through end
+    time_t end;
+} rollup_span_t;
+
+static time_t align_up(time_t t, time_t size) {
+    return t % size == 0 ? t : t - t % size + size;
+}
+
+static rollup_span_t rollup_span(time_t start, time_t end) {
+    rollup_span_t span = { .start = start, .end = end };
+    span.minute_start = align_up(start, DETECTION_ROLLUP_MINUTE);
+    span.minute_end = (end + 1) - (end + 1) % DETECTION_ROLLUP_MINUTE;
+    if (span.minute_end <= span.minute_start) {
+        span.minute_start = span.minute_end = end + 1;
+    }
+    span.hour_start = align_up(span.minute_start, DETECTION_ROLLUP_HOUR);
+    span.hour_end = span.minute_end - span.minute_end % DETECTION_ROLLUP_HOUR;
+    if (span.hour_end <= span.hour_start) {
+        span.hour_start = span.hour_end = span.minute_end;
+    }
+    return span;
+}
+
+// Label, count and confidence rows covering a rollup_span_t bound to ?1-?7
+#define ROLLUP_SPAN_ROWS \
+    "SELECT label, count AS cnt, max_confidence AS conf FROM detection_rollups " \
+    "WHERE stream_name = ?1 AND bucket_seconds = 3600 AND bucket_start >= ?4 AND bucket_start < ?5 " \
+    "UNION ALL SELECT label, count, max_confidence FROM detection_rollups " \
+    "WHERE stream_name = ?1 AND bucket_seconds = 60 AND bucket_start >= ?3 AND bucket_start < ?4 " \
+    "UNION ALL SELECT label, count, max_confidence FROM detection_rollups " \
+    "WHERE stream_name = ?1 AND bucket_seconds = 60 AND bucket_start >= ?5 AND bucket_start < ?6 " \
+    "UNION ALL SELECT label, 1, confidence FROM detections " \
+    "WHERE stream_name = ?1 AND timestamp >= ?2 AND timestamp < ?3 " \
+    "UNION ALL SELECT label, 1, confidence FROM detections " \
+    "WHERE stream_name = ?1 AND timestamp >= ?6 AND timestamp <= ?7"
+
+static void bind_rollup_span(sqlite3_stmt *stmt, const char *stream_name, const rollup_span_t *span) {
+    sqlite3_bind_text(stmt, 1, stream_name, -1, SQLITE_STATIC);
+    sqlite3_bind_int64(stmt, 2, (sqlite3_int64)span->start);
+    sqlite3_bind_int64(stmt, 3, (sqlite3_int64)span->minute_start);
+    sqlite3_bind_int64(stmt, 4, (sqlite3_int64)span->hour_start);
+    sqlite3_bind_int64(stmt, 5, (sqlite3_int64)span->hour_end);
+    sqlite3_bind_int64(stmt, 6, (sqlite3_int64)span->minute_end);
+    sqlite3_bind_int64(stmt, 7, (sqlite3_int64)span->end);
+}
+
 /**
  * Check if there are any detections for a stream within a time range
  *
+ * Whole minutes and hours of the range are answered from the rollups, the
+ * seconds at either edge from the detections table.
+ *
  * @param stream_name Stream name
  * @param start_time Start time (inclusive)
  * @param end_time End time (inclusive)
  * @return 1 if detections exist, 0 if none, -1 on error
  */
 int has_detections_in_time_range(const char *stream_name, time_t start_time, time_t end_time) {
-    int rc;
-    sqlite3_stmt *stmt;
     int has_detections = 0;
 
-    sqlite3 *db = get_db_handle();
-    pthread_mutex_t *db_mutex = get_db_mutex();
-
-    if (!db) {
+    if (!get_db_handle()) {
         log_error("Database not initialized");
         return -1;
     }
@@ -553,35 +781,33 @@ int has_detections_in_time_range(const char *stream_name, time_t start_time, tim
     log_debug("Checking for detections: stream=%s, start=%lld, end=%lld",
              stream_name, (long long)start_time, (long long)end_time);
 
-    pthread_mutex_lock(db_mutex);
-
-    // Use EXISTS for efficiency - stops at first match
-    const char *sql = "SELECT EXISTS(SELECT 1 FROM detections WHERE stream_name = ? AND timestamp >= ? AND timestamp <= ? LIMIT 1);";
+    sqlite3 *db = db_reader_acquire();
+    if (!db) {
+        log_error("No database connection available");
+        return -1;
+    }
 
-    rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
-    if (rc != SQLITE_OK) {
+    sqlite3_stmt *stmt = db_prepare_cached_on(db, "SELECT EXISTS(" ROLLUP_SPAN_ROWS ");");
+    if (!stmt) {
         log_error("Failed to prepare statement: %s", sqlite3_errmsg(db));
-        pthread_mutex_unlock(db_mutex);
+        db_reader_release(db);
         return -1;
     }
 
-    sqlite3_bind_text(stmt, 1, stream_name, -1, SQLITE_STATIC);
-    sqlite3_bind_int64(stmt, 2, (sqlite3_int64)start_time);
-    sqlite3_bind_int64(stmt, 3, (sqlite3_int64)end_time);
+    rollup_span_t span = rollup_span(start_time, end_time);
+    bind_rollup_span(stmt, stream_name, &span);
 
-    rc = sqlite3_step(stmt);
+    int rc = sqlite3_step(stmt);
     if (rc == SQLITE_ROW) {
         has_detections = sqlite3_column_int(stmt, 0);
         log_debug("Detection check result for stream %s: %d", stream_name, has_detections);
     } else {
         log_error("Failed to check for detections: %s", sqlite3_errmsg(db));
-        sqlite3_finalize(stmt);
-        pthread_mutex_unlock(db_mutex);
-        return -1;
+        has_detections = -1;
     }
 
-    sqlite3_finalize(stmt);
-    pthread_mutex_unlock(db_mutex);
+    db_release_cached(stmt);
+    db_reader_release(db);
 
     return has_detections;
 }
@@ -589,53 +815,84 @@ int has_detections_in_time_range(const char *stream_name, time_t start_time, tim
 /**
  * Delete old detections from the database
  *
+ * The cutoff is rounded down to a whole minute so the minute rollups stay
+ * exact; the hour containing the cutoff is rebuilt from its minutes.
+ *
  * @param max_age Maximum age in seconds
  * @return Number of detections deleted, or -1 on error
  */
 int delete_old_detections(uint64_t max_age) {
-    int rc;
     sqlite3_stmt *stmt;
     int deleted_count = 0;
-    
+    char *err_msg = NULL;
+
     sqlite3 *db = get_db_handle();
-    pthread_mutex_t *db_mutex = get_db_mutex();
-    
+
     if (!db) {
         log_error("Database not initialized");
         return -1;
     }
-    
-    pthread_mutex_lock(db_mutex);
-    
-    const char *sql = "DELETE FROM detections WHERE timestamp < ?;";
-    
-    rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
-    if (rc != SQLITE_OK) {
-        log_error("Failed to prepare statement: %s", sqlite3_errmsg(db));
-        pthread_mutex_unlock(db_mutex);
-        return -1;
-    }
-    
+
     // Calculate cutoff time
     time_t cutoff_time = time(NULL) - (time_t)max_age;
-    
-    // Bind parameters
-    sqlite3_bind_int64(stmt, 1, (sqlite3_int64)cutoff_time);
-    
-    // Execute statement
-    rc = sqlite3_step(stmt);
-    if (rc != SQLITE_DONE) {
-        log_error("Failed to delete old detections: %s", sqlite3_errmsg(db));
+    cutoff_time -= cutoff_time % DETECTION_ROLLUP_MINUTE;
+    time_t cutoff_hour = cutoff_time - cutoff_time % DETECTION_ROLLUP_HOUR;
+
+    db_writer_lock();
+
+    if (sqlite3_exec(db, "BEGIN TRANSACTION;", NULL, NULL, &err_msg) != SQLITE_OK) {
+        log_error("Failed to begin transaction: %s", err_msg);
+        sqlite3_free(err_msg);
+        db_writer_unlock();
+        return -1;
+    }
+
+    static const char *sql[] = {
+        "DELETE FROM detections WHERE timestamp < ?1;",
+        "DELETE FROM detection_rollups WHERE bucket_start + bucket_seconds <= ?1 "
+        "OR (bucket_seconds = 3600 AND bucket_start = ?2);",
+        "INSERT INTO detection_rollups (stream_name, bucket_seconds, bucket_start, label, count, max_confidence) "
+        "SELECT stream_name, 3600, ?2, label, SUM(count), MAX(max_confidence) FROM detection_rollups "
+        "WHERE bucket_seconds = 60 AND bucket_start >= ?2 AND bucket_start < ?2 + 3600 "
+        "GROUP BY stream_name, label;",
+    };
+
+    for (size_t i = 0; i < sizeof(sql) / sizeof(sql[0]); i++) {
+        if (sqlite3_prepare_v2(db, sql[i], -1, &stmt, NULL) != SQLITE_OK) {
+            log_error("Failed to prepare statement: %s", sqlite3_errmsg(db));
+            sqlite3_exec(db, "ROLLBACK;", NULL, NULL, NULL);
+            db_writer_unlock();
+            return -1;
+        }
+
+        sqlite3_bind_int64(stmt, 1, (sqlite3_int64)cutoff_time);
+        if (sqlite3_bind_parameter_count(stmt) >= 2) {
+            sqlite3_bind_int64(stmt, 2, (sqlite3_int64)cutoff_hour);
+        }
+
+        if (sqlite3_step(stmt) != SQLITE_DONE) {
+            log_error("Failed to delete old detections: %s", sqlite3_errmsg(db));
+            sqlite3_finalize(stmt);
+            sqlite3_exec(db, "ROLLBACK;", NULL, NULL, NULL);
+            db_writer_unlock();
+            return -1;
+        }
+
+        if (i == 0) {
+            deleted_count = sqlite3_changes(db);
+        }
         sqlite3_finalize(stmt);
-        pthread_mutex_unlock(db_mutex);
+    }
+
+    if (sqlite3_exec(db, "COMMIT;", NULL, NULL, &err_msg) != SQLITE_OK) {
+        log_error("Failed to commit transaction: %s", err_msg);
+        sqlite3_free(err_msg);
+        sqlite3_exec(db, "ROLLBACK;", NULL, NULL, NULL);
+        db_writer_unlock();
         return -1;
     }
-    
-    deleted_count = sqlite3_changes(db);
 
-    // finalize the prepared statement
-    sqlite3_finalize(stmt);
-    pthread_mutex_unlock(db_mutex);
+    db_writer_unlock();
 
     log_info("Deleted %d old detections from database", deleted_count);
     return deleted_count;
@@ -645,6 +902,9 @@ int delete_old_detections(uint64_t max_age) {
  * Get a summary of detection labels for a stream within a time range
  * Returns unique labels with their counts, sorted by count descending
  *
+ * Whole minutes and hours of the range are read from the rollups, the
+ * seconds at either edge from the detections table.
+ *
  * @param stream_name Stream name
  * @param start_time Start time (inclusive)
  * @param end_time End time (inclusive)
@@ -655,13 +915,9 @@ int delete_old_detections(uint64_t max_age) {
 int get_detection_labels_summary(const char *stream_name, time_t start_time, time_t end_time,
                                  detection_label_summary_t *labels, int max_labels) {
     int rc;
-    sqlite3_stmt *stmt;
     int count = 0;
 
-    sqlite3 *db = get_db_handle();
-    pthread_mutex_t *db_mutex = get_db_mutex();
-
-    if (!db) {
+    if (!get_db_handle()) {
         log_error("Database not initialized");
         return -1;
     }
@@ -674,52 +930,161 @@ int get_detection_labels_summary(const char *stream_name, time_t start_time, tim
     // Initialize labels array
     memset(labels, 0, max_labels * sizeof(detection_label_summary_t));
 
-    pthread_mutex_lock(db_mutex);
+    sqlite3 *db = db_reader_acquire();
+    if (!db) {
+        log_error("No database connection available");
+        return -1;
+    }
 
-    // Query to get unique labels with counts, sorted by count descending
-    const char *sql =
-        "SELECT label, COUNT(*) as cnt "
-        "FROM detections "
-        "WHERE stream_name = ? AND timestamp >= ? AND timestamp <= ? "
+    // Unique labels with counts, sorted by count descending
+    sqlite3_stmt *stmt = db_prepare_cached_on(db,
+        "SELECT label, SUM(cnt) AS total, MAX(conf) "
+        "FROM (" ROLLUP_SPAN_ROWS ") "
         "GROUP BY label "
-        "ORDER BY cnt DESC "
-        "LIMIT ?;";
-
-    rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
-    if (rc != SQLITE_OK) {
+        "ORDER BY total DESC, label "
+        "LIMIT ?8;");
+    if (!stmt) {
         log_error("Failed to prepare statement for get_detection_labels_summary: %s", sqlite3_errmsg(db));
-        pthread_mutex_unlock(db_mutex);
+        db_reader_release(db);
         return -1;
     }
 
-    // Bind parameters
-    sqlite3_bind_text(stmt, 1, stream_name, -1, SQLITE_STATIC);
-    sqlite3_bind_int64(stmt, 2, (sqlite3_int64)start_time);
-    sqlite3_bind_int64(stmt, 3, (sqlite3_int64)end_time);
-    sqlite3_bind_int(stmt, 4, max_labels);
+    rollup_span_t span = rollup_span(start_time, end_time);
+    bind_rollup_span(stmt, stream_name, &span);
+    sqlite3_bind_int(stmt, 8, max_labels);
 
     // Execute query and fetch results
     while ((rc = sqlite3_step(stmt)) == SQLITE_ROW && count < max_labels) {
         const char *label = (const char *)sqlite3_column_text(stmt, 0);
-        int label_count = sqlite3_column_int(stmt, 1);
 
         if (label) {
             safe_strcpy(labels[count].label, label, MAX_LABEL_LENGTH, 0);
-            labels[count].count = label_count;
+            labels[count].count = sqlite3_column_int(stmt, 1);
+            labels[count].max_confidence = (float)sqlite3_column_double(stmt, 2);
             count++;
         }
     }
 
     if (rc != SQLITE_DONE && rc != SQLITE_ROW) {
         log_error("Failed to fetch detection labels: %s", sqlite3_errmsg(db));
-        sqlite3_finalize(stmt);
-        pthread_mutex_unlock(db_mutex);
+        count = -1;
+    }
+
+    db_release_cached(stmt);
+    db_reader_release(db);
+
+    return count;
+}
+
+int get_detection_density(const char *stream_name, time_t start_time, time_t end_time,
+                          int bucket_seconds, const char *label,
+                          detection_bucket_t *buckets, int max_buckets) {
+    if (!stream_name || !buckets || max_buckets <= 0 ||
+        (bucket_seconds != DETECTION_ROLLUP_MINUTE && bucket_seconds != DETECTION_ROLLUP_HOUR)) {
+        log_error("Invalid parameters for get_detection_density");
         return -1;
     }
 
-    sqlite3_finalize(stmt);
-    pthread_mutex_unlock(db_mutex);
+    if (!get_db_handle()) {
+        log_error("Database not initialized");
+        return -1;
+    }
+
+    memset(buckets, 0, max_buckets * sizeof(detection_bucket_t));
+
+    sqlite3 *db = db_reader_acquire();
+    if (!db) {
+        log_error("No database connection available");
+        return -1;
+    }
+
+    sqlite3_stmt *stmt = db_prepare_cached_on(db,
+        "SELECT bucket_start, SUM(count), MAX(max_confidence) FROM detection_rollups "
+        "WHERE stream_name = ?1 AND bucket_seconds = ?2 "
+        "AND bucket_start > ?3 - ?2 AND bucket_start <= ?4 "
+        "AND (?5 IS NULL OR label = ?5) "
+        "GROUP BY bucket_start ORDER BY bucket_start LIMIT ?6;");
+    if (!stmt) {
+        log_error("Failed to prepare detection density query: %s", sqlite3_errmsg(db));
+        db_reader_release(db);
+        return -1;
+    }
+
+    sqlite3_bind_text(stmt, 1, stream_name, -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 2, bucket_seconds);
+    sqlite3_bind_int64(stmt, 3, (sqlite3_int64)start_time);
+    sqlite3_bind_int64(stmt, 4, (sqlite3_int64)end_time);
+    if (label && label[0]) {
+        sqlite3_bind_text(stmt, 5, label, -1, SQLITE_STATIC);
+    } else {
+        sqlite3_bind_null(stmt, 5);
+    }
+    sqlite3_bind_int(stmt, 6, max_buckets);
+
+    int count = 0;
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW && count < max_buckets) {
+        buckets[count].bucket_start = (time_t)sqlite3_column_int64(stmt, 0);
+        buckets[count].count = sqlite3_column_int(stmt, 1);
+        buckets[count].max_confidence = (float)sqlite3_column_double(stmt, 2);
+        count++;
+    }
+
+    if (rc != SQLITE_DONE && rc != SQLITE_ROW) {
+        log_error("Failed to fetch detection density: %s", sqlite3_errmsg(db));
+        count = -1;
+    }
+
+    db_release_cached(stmt);
+    db_reader_release(db);
+    return count;
+}
+
+int get_recording_detection_labels(uint64_t recording_id,
+                                   detection_label_summary_t *labels, int max_labels) {
+    if (!labels || max_labels <= 0) {
+        log_error("Invalid parameters for get_recording_detection_labels");
+        return -1;
+    }
+
+    memset(labels, 0, max_labels * sizeof(detection_label_summary_t));
+
+    sqlite3 *db = db_reader_acquire();
+    if (!db) {
+        log_error("Database not initialized");
+        return -1;
+    }
+
+    sqlite3_stmt *stmt = db_prepare_cached_on(db,
+        "SELECT label, count, max_confidence FROM recording_detection_labels "
+        "WHERE recording_id = ? ORDER BY count DESC, label LIMIT ?;");
+    if (!stmt) {
+        db_reader_release(db);
+        return -1;
+    }
+
+    sqlite3_bind_int64(stmt, 1, (sqlite3_int64)recording_id);
+    sqlite3_bind_int(stmt, 2, max_labels);
+
+    int count = 0;
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW && count < max_labels) {
+        const char *label = (const char *)sqlite3_column_text(stmt, 0);
+        if (label) {
+            safe_strcpy(labels[count].label, label, MAX_LABEL_LENGTH, 0);
+            labels[count].count = sqlite3_column_int(stmt, 1);
+            labels[count].max_confidence = (float)sqlite3_column_double(stmt, 2);
+            count++;
+        }
+    }
+
+    if (rc != SQLITE_DONE && rc != SQLITE_ROW) {
+        log_error("Failed to fetch recording detection labels: %s", sqlite3_errmsg(db));
+        count = -1;
+    }
 
+    db_release_cached(stmt);
+    db_reader_release(db);
     return count;
 }
 
@@ -729,7 +1094,6 @@ int get_all_unique_detection_labels(char labels[][MAX_LABEL_LENGTH], int max_lab
     int count = 0;
 
     sqlite3 *db = get_db_handle();
-    pthread_mutex_t *db_mutex = get_db_mutex();
 
     if (!db) {
         log_error("Database not initialized");
@@ -743,7 +1107,7 @@ int get_all_unique_detection_labels(char labels[][MAX_LABEL_LENGTH], int max_lab
 
     memset(labels, 0, (size_t)max_labels * MAX_LABEL_LENGTH);
 
-    pthread_mutex_lock(db_mutex);
+    db_writer_lock();
 
     const char *sql =
         "SELECT DISTINCT label "
@@ -755,7 +1119,7 @@ int get_all_unique_detection_labels(char labels[][MAX_LABEL_LENGTH], int max_lab
     rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
         log_error("Failed to prepare statement for get_all_unique_detection_labels: %s", sqlite3_errmsg(db));
-        pthread_mutex_unlock(db_mutex);
+        db_writer_unlock();
         return -1;
     }
 
@@ -773,12 +1137,12 @@ int get_all_unique_detection_labels(char labels[][MAX_LABEL_LENGTH], int max_lab
     if (rc != SQLITE_DONE && rc != SQLITE_ROW) {
         log_error("Failed to fetch unique detection labels: %s", sqlite3_errmsg(db));
         sqlite3_finalize(stmt);
-        pthread_mutex_unlock(db_mutex);
+        db_writer_unlock();
         return -1;
     }
 
     sqlite3_finalize(stmt);
-    pthread_mutex_unlock(db_mutex);
+    db_writer_unlock();
 
     return count;
 }
@@ -793,7 +1157,6 @@ int update_detections_recording_id(const char *stream_name, uint64_t recording_i
     sqlite3_stmt *stmt;
 
     sqlite3 *db = get_db_handle();
-    pthread_mutex_t *db_mutex = get_db_mutex();
 
     if (!db) {
         log_error("Database not initialized");
@@ -805,7 +1168,7 @@ int update_detections_recording_id(const char *stream_name, uint64_t recording_i
         return -1;
     }
 
-    pthread_mutex_lock(db_mutex);
+    db_writer_lock();
 
     // Update detections where recording_id is NULL or 0 for the given stream and time range
     const char *sql =
@@ -816,7 +1179,7 @@ int update_detections_recording_id(const char *stream_name, uint64_t recording_i
     rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
         log_error("Failed to prepare statement for update_detections_recording_id: %s", sqlite3_errmsg(db));
-        pthread_mutex_unlock(db_mutex);
+        db_writer_unlock();
         return -1;
     }
 
@@ -829,18 +1192,19 @@ int update_detections_recording_id(const char *stream_name, uint64_t recording_i
     if (rc != SQLITE_DONE) {
         log_error("Failed to update detections with recording_id: %s", sqlite3_errmsg(db));
         sqlite3_finalize(stmt);
-        pthread_mutex_unlock(db_mutex);
+        db_writer_unlock();
         return -1;
     }
 
     int updated = sqlite3_changes(db);
 
     sqlite3_finalize(stmt);
-    pthread_mutex_unlock(db_mutex);
+    db_writer_unlock();
 
     if (updated > 0) {
         log_debug("Updated %d detections with recording_id %lu for stream %s",
                   updated, (unsigned long)recording_id, stream_name);
+        refresh_recording_detection_summary(recording_id);
     }
 
     return updated;
@@ -11,6 +11,7 @@
 
 #include "database/db_events.h"
 #include "database/db_core.h"
+#include "database/db_write_queue.h"
 #include "core/logger.h"
 #include "utils/strings.h"
 
@@ -22,7 +23,6 @@ uint64_t add_event(event_type_t type, const char *stream_name,
     uint64_t event_id = 0;
     
     sqlite3 *db = get_db_handle();
-    pthread_mutex_t *db_mutex = get_db_mutex();
     
     if (!db) {
         log_error("Database not initialized");
@@ -34,7 +34,7 @@ uint64_t add_event(event_type_t type, const char *stream_name,
         return 0;
     }
     
-    pthread_mutex_lock(db_mutex);
+    db_writer_lock();
     
     const char *sql = "INSERT INTO events (type, timestamp, stream_name, description, details) "
                       "VALUES (?, ?, ?, ?, ?);";
@@ -42,7 +42,7 @@ uint64_t add_event(event_type_t type, const char *stream_name,
     rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
         log_error("Failed to prepare statement: %s", sqlite3_errmsg(db));
-        pthread_mutex_unlock(db_mutex);
+        db_writer_unlock();
         return 0;
     }
     
@@ -75,11 +75,79 @@ uint64_t add_event(event_type_t type, const char *stream_name,
     
     // finalize the prepared statement
     sqlite3_finalize(stmt);
-    pthread_mutex_unlock(db_mutex);
+    db_writer_unlock();
     
     return event_id;
 }
 
+// Event copied for the write queue
+typedef struct {
+    event_type_t type;
+    time_t timestamp;
+    bool has_stream_name;
+    bool has_details;
+    char stream_name[64];
+    char description[256];
+    char details[1024];
+} event_write_t;
+
+// Insert a queued event; the caller holds the writer lock and an open transaction
+static int insert_event(sqlite3 *db, const void *payload) {
+    const event_write_t *w = payload;
+
+    sqlite3_stmt *stmt = db_prepare_cached("INSERT INTO events (type, timestamp, stream_name, description, details) "
+                                           "VALUES (?, ?, ?, ?, ?);");
+    if (!stmt) {
+        return -1;
+    }
+
+    sqlite3_bind_int(stmt, 1, (int)w->type);
+    sqlite3_bind_int64(stmt, 2, (sqlite3_int64)w->timestamp);
+    if (w->has_stream_name) {
+        sqlite3_bind_text(stmt, 3, w->stream_name, -1, SQLITE_STATIC);
+    } else {
+        sqlite3_bind_null(stmt, 3);
+    }
+    sqlite3_bind_text(stmt, 4, w->description, -1, SQLITE_STATIC);
+    if (w->has_details) {
+        sqlite3_bind_text(stmt, 5, w->details, -1, SQLITE_STATIC);
+    } else {
+        sqlite3_bind_null(stmt, 5);
+    }
+
+    int rc = sqlite3_step(stmt);
+    if (rc != SQLITE_DONE) {
+        log_error("Failed to add event: %s", sqlite3_errmsg(db));
+    }
+    db_release_cached(stmt);
+    return rc == SQLITE_DONE ? 0 : -1;
+}
+
+// Queue an event for the next group commit
+int queue_event(event_type_t type, const char *stream_name,
+                const char *description, const char *details) {
+    if (!description) {
+        log_error("Event description is required");
+        return -1;
+    }
+
+    event_write_t w;
+    memset(&w, 0, sizeof(w));
+    w.type = type;
+    w.timestamp = time(NULL);   // When it happened, not when it is committed
+    w.has_stream_name = stream_name != NULL;
+    w.has_details = details != NULL;
+    if (stream_name) {
+        safe_strcpy(w.stream_name, stream_name, sizeof(w.stream_name), 0);
+    }
+    safe_strcpy(w.description, description, sizeof(w.description), 0);
+    if (details) {
+        safe_strcpy(w.details, details, sizeof(w.details), 0);
+    }
+
+    return db_write_queue_submit(insert_event, &w, sizeof(w));
+}
+
 // Get events from the database
 int get_events(time_t start_time, time_t end_time, int type, 
               const char *stream_name, event_info_t *events, int max_count) {
@@ -88,7 +156,6 @@ int get_events(time_t start_time, time_t end_time, int type,
     int count = 0;
     
     sqlite3 *db = get_db_handle();
-    pthread_mutex_t *db_mutex = get_db_mutex();
     
     if (!db) {
         log_error("Database not initialized");
@@ -100,7 +167,7 @@ int get_events(time_t start_time, time_t end_time, int type,
         return -1;
     }
     
-    pthread_mutex_lock(db_mutex);
+    db_writer_lock();
     
     // Build query based on filters
     char sql[1024];
@@ -127,7 +194,7 @@ int get_events(time_t start_time, time_t end_time, int type,
     rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
         log_error("Failed to prepare statement: %s", sqlite3_errmsg(db));
-        pthread_mutex_unlock(db_mutex);
+        db_writer_unlock();
         return -1;
     }
     
@@ -184,7 +251,7 @@ int get_events(time_t start_time, time_t end_time, int type,
     
     // finalize the prepared statement
     sqlite3_finalize(stmt);
-    pthread_mutex_unlock(db_mutex);
+    db_writer_unlock();
     
     log_info("Found %d events in database matching criteria", count);
     return count;
@@ -197,21 +264,20 @@ int delete_old_events(uint64_t max_age) {
     int deleted_count = 0;
     
     sqlite3 *db = get_db_handle();
-    pthread_mutex_t *db_mutex = get_db_mutex();
     
     if (!db) {
         log_error("Database not initialized");
         return -1;
     }
     
-    pthread_mutex_lock(db_mutex);
+    db_writer_lock();
     
     const char *sql = "DELETE FROM events WHERE timestamp < ?;";
     
     rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
         log_error("Failed to prepare statement: %s", sqlite3_errmsg(db));
-        pthread_mutex_unlock(db_mutex);
+        db_writer_unlock();
         return -1;
     }
     
@@ -226,7 +292,7 @@ int delete_old_events(uint64_t max_age) {
     if (rc != SQLITE_DONE) {
         log_error("Failed to delete old events: %s", sqlite3_errmsg(db));
         sqlite3_finalize(stmt);
-        pthread_mutex_unlock(db_mutex);
+        db_writer_unlock();
         return -1;
     }
     
@@ -234,7 +300,7 @@ int delete_old_events(uint64_t max_age) {
     
     // finalize the prepared statement
     sqlite3_finalize(stmt);
-    pthread_mutex_unlock(db_mutex);
+    db_writer_unlock();
     
     return deleted_count;
 }
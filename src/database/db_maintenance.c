@@ -23,21 +23,20 @@ int64_t get_database_size(void) {
     sqlite3_stmt *stmt;
     int64_t size = -1;
     sqlite3 *db = get_db_handle();
-    pthread_mutex_t *db_mutex = get_db_mutex();
     
     if (!db) {
         log_error("Database not initialized");
         return -1;
     }
     
-    pthread_mutex_lock(db_mutex);
+    db_writer_lock();
     
     const char *sql = "PRAGMA page_count;";
     
     rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
         log_error("Failed to prepare statement: %s", sqlite3_errmsg(db));
-        pthread_mutex_unlock(db_mutex);
+        db_writer_unlock();
         return -1;
     }
     
@@ -49,7 +48,7 @@ int64_t get_database_size(void) {
         rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
         if (rc != SQLITE_OK) {
             log_error("Failed to prepare statement: %s", sqlite3_errmsg(db));
-            pthread_mutex_unlock(db_mutex);
+            db_writer_unlock();
             return -1;
         }
         
@@ -60,7 +59,7 @@ int64_t get_database_size(void) {
     }
     
     sqlite3_finalize(stmt);
-    pthread_mutex_unlock(db_mutex);
+    db_writer_unlock();
     
     return size;
 }
@@ -70,41 +69,99 @@ int vacuum_database(void) {
     int rc;
     char *err_msg = NULL;
     sqlite3 *db = get_db_handle();
-    pthread_mutex_t *db_mutex = get_db_mutex();
     
     if (!db) {
         log_error("Database not initialized");
         return -1;
     }
     
-    pthread_mutex_lock(db_mutex);
+    db_writer_lock();
     
-    rc = sqlite3_exec(db, "VACUUM;", NULL, NULL, &err_msg);
+    // auto_vacuum only changes on an existing database through a VACUUM
+    rc = sqlite3_exec(db, "PRAGMA auto_vacuum=INCREMENTAL; VACUUM;", NULL, NULL, &err_msg);
     if (rc != SQLITE_OK) {
         log_error("Failed to vacuum database: %s", err_msg);
         sqlite3_free(err_msg);
-        pthread_mutex_unlock(db_mutex);
+        db_writer_unlock();
         return -1;
     }
     
-    pthread_mutex_unlock(db_mutex);
+    db_writer_unlock();
     return 0;
 }
 
+static int64_t query_pragma_int(sqlite3 *db, const char *sql) {
+    sqlite3_stmt *stmt = NULL;
+    int64_t value = -1;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) == SQLITE_OK) {
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            value = sqlite3_column_int64(stmt, 0);
+        }
+        sqlite3_finalize(stmt);
+    }
+    return value;
+}
+
+// Release a bounded number of free pages
+int incremental_vacuum_database(int max_pages) {
+    sqlite3 *db = get_db_handle();
+    
+    if (!db) {
+        log_error("Database not initialized");
+        return -1;
+    }
+    if (max_pages <= 0) {
+        return 0;
+    }
+    
+    db_writer_lock();
+    
+    // 2 = INCREMENTAL; other modes ignore incremental_vacuum
+    if (query_pragma_int(db, "PRAGMA auto_vacuum;") != 2) {
+        db_writer_unlock();
+        return 0;
+    }
+    
+    int64_t before = query_pragma_int(db, "PRAGMA freelist_count;");
+    if (before <= 0) {
+        db_writer_unlock();
+        return before < 0 ? -1 : 0;
+    }
+    
+    char sql[64];
+    snprintf(sql, sizeof(sql), "PRAGMA incremental_vacuum(%d);", max_pages);
+    char *err_msg = NULL;
+    int rc = sqlite3_exec(db, sql, NULL, NULL, &err_msg);
+    if (rc != SQLITE_OK) {
+        log_error("Failed to run incremental vacuum: %s", err_msg ? err_msg : sqlite3_errmsg(db));
+        sqlite3_free(err_msg);
+        db_writer_unlock();
+        return -1;
+    }
+    
+    int64_t after = query_pragma_int(db, "PRAGMA freelist_count;");
+    db_writer_unlock();
+    
+    int released = (after >= 0 && after < before) ? (int)(before - after) : 0;
+    if (released > 0) {
+        log_debug("Incremental vacuum released %d pages (%lld still free)", released, (long long)after);
+    }
+    return released;
+}
+
 // Check database integrity with more detailed diagnostics
 int check_database_integrity(void) {
     int rc;
     sqlite3_stmt *stmt;
     int result = -1;
     sqlite3 *db = get_db_handle();
-    pthread_mutex_t *db_mutex = get_db_mutex();
     
     if (!db) {
         log_error("Database not initialized");
         return -1;
     }
     
-    pthread_mutex_lock(db_mutex);
+    db_writer_lock();
     
     // First run a quick check
     const char *sql = "PRAGMA quick_check;";
@@ -112,7 +169,7 @@ int check_database_integrity(void) {
     rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
         log_error("Failed to prepare quick_check statement: %s", sqlite3_errmsg(db));
-        pthread_mutex_unlock(db_mutex);
+        db_writer_unlock();
         return -1;
     }
     
@@ -137,7 +194,7 @@ int check_database_integrity(void) {
         rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
         if (rc != SQLITE_OK) {
             log_error("Failed to prepare integrity_check statement: %s", sqlite3_errmsg(db));
-            pthread_mutex_unlock(db_mutex);
+            db_writer_unlock();
             return -1;
         }
         
@@ -163,7 +220,7 @@ int check_database_integrity(void) {
         sqlite3_finalize(stmt);
     }
     
-    pthread_mutex_unlock(db_mutex);
+    db_writer_unlock();
     
     return result;
 }
@@ -173,7 +230,6 @@ int database_execute_query(const char *sql, void **result, int *rows, int *cols)
     int rc;
     char *err_msg = NULL;
     sqlite3 *db = get_db_handle();
-    pthread_mutex_t *db_mutex = get_db_mutex();
     
     if (!db) {
         log_error("Database not initialized");
@@ -185,7 +241,7 @@ int database_execute_query(const char *sql, void **result, int *rows, int *cols)
         return -1;
     }
     
-    pthread_mutex_lock(db_mutex);
+    db_writer_lock();
     
     // Execute the query and get results as a table
     rc = sqlite3_get_table(db, sql, (char ***)result, rows, cols, &err_msg);
@@ -193,10 +249,10 @@ int database_execute_query(const char *sql, void **result, int *rows, int *cols)
     if (rc != SQLITE_OK) {
         log_error("SQL error: %s", err_msg);
         sqlite3_free(err_msg);
-        pthread_mutex_unlock(db_mutex);
+        db_writer_unlock();
         return -1;
     }
     
-    pthread_mutex_unlock(db_mutex);
+    db_writer_unlock();
     return 0;
 }
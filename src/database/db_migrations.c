@@ -277,6 +277,9 @@ int run_database_migrations(void) {
 
     migrate_free(ctx);
 
+    // Cached statements were compiled against the old schema
+    db_stmt_cache_invalidate();
+
     return result;
 }
 
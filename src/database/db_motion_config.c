@@ -11,7 +11,6 @@
 // Delete motion recording configuration for a stream
 int delete_motion_config(const char *stream_name) {
     sqlite3 *db = get_db_handle();
-    pthread_mutex_t *db_mutex = get_db_mutex();
     sqlite3_stmt *stmt = NULL;
     int rc;
 
@@ -20,14 +19,14 @@ int delete_motion_config(const char *stream_name) {
         return -1;
     }
 
-    pthread_mutex_lock(db_mutex);
+    db_writer_lock();
 
     const char *sql = "DELETE FROM motion_recording_config WHERE stream_name = ?;";
 
     rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
         log_error("Failed to prepare delete_motion_config statement: %s", sqlite3_errmsg(db));
-        pthread_mutex_unlock(db_mutex);
+        db_writer_unlock();
         return -1;
     }
 
@@ -38,11 +37,11 @@ int delete_motion_config(const char *stream_name) {
 
     if (rc != SQLITE_DONE) {
         log_error("Failed to delete motion config for %s: %s", stream_name, sqlite3_errmsg(db));
-        pthread_mutex_unlock(db_mutex);
+        db_writer_unlock();
         return -1;
     }
 
-    pthread_mutex_unlock(db_mutex);
+    db_writer_unlock();
     log_info("Deleted motion recording config for stream: %s", stream_name);
     return 0;
 }
@@ -50,7 +49,6 @@ int delete_motion_config(const char *stream_name) {
 // Delete old motion recordings based on retention policy
 int cleanup_old_motion_recordings(const char *stream_name, int retention_days) {
     sqlite3 *db = get_db_handle();
-    pthread_mutex_t *db_mutex = get_db_mutex();
     sqlite3_stmt *stmt = NULL;
     int rc;
     int deleted_count = 0;
@@ -62,7 +60,7 @@ int cleanup_old_motion_recordings(const char *stream_name, int retention_days) {
 
     time_t cutoff_time = time(NULL) - ((time_t)retention_days * 24 * 60 * 60);
 
-    pthread_mutex_lock(db_mutex);
+    db_writer_lock();
 
     const char *sql;
     if (stream_name) {
@@ -74,7 +72,7 @@ int cleanup_old_motion_recordings(const char *stream_name, int retention_days) {
     rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
         log_error("Failed to prepare cleanup_old_motion_recordings statement: %s", sqlite3_errmsg(db));
-        pthread_mutex_unlock(db_mutex);
+        db_writer_unlock();
         return -1;
     }
 
@@ -94,7 +92,7 @@ int cleanup_old_motion_recordings(const char *stream_name, int retention_days) {
     }
 
     sqlite3_finalize(stmt);
-    pthread_mutex_unlock(db_mutex);
+    db_writer_unlock();
 
     if (deleted_count > 0) {
         log_info("Cleaned up %d old motion recordings (retention: %d days)", deleted_count, retention_days);
@@ -106,7 +104,6 @@ int cleanup_old_motion_recordings(const char *stream_name, int retention_days) {
 // Get total disk space used by motion recordings
 int64_t get_motion_recordings_disk_usage(const char *stream_name) {
     sqlite3 *db = get_db_handle();
-    pthread_mutex_t *db_mutex = get_db_mutex();
     sqlite3_stmt *stmt = NULL;
     int rc;
     int64_t total_size = 0;
@@ -116,7 +113,7 @@ int64_t get_motion_recordings_disk_usage(const char *stream_name) {
         return -1;
     }
 
-    pthread_mutex_lock(db_mutex);
+    db_writer_lock();
 
     const char *sql;
     if (stream_name) {
@@ -128,7 +125,7 @@ int64_t get_motion_recordings_disk_usage(const char *stream_name) {
     rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
         log_error("Failed to prepare get_motion_recordings_disk_usage statement: %s", sqlite3_errmsg(db));
-        pthread_mutex_unlock(db_mutex);
+        db_writer_unlock();
         return -1;
     }
 
@@ -142,7 +139,7 @@ int64_t get_motion_recordings_disk_usage(const char *stream_name) {
     }
 
     sqlite3_finalize(stmt);
-    pthread_mutex_unlock(db_mutex);
+    db_writer_unlock();
 
     return total_size;
 }
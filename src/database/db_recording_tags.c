@@ -23,24 +23,23 @@ int db_recording_tag_add(uint64_t recording_id, const char *tag) {
     }
 
     sqlite3 *db = get_db_handle();
-    pthread_mutex_t *mtx = get_db_mutex();
     if (!db) { log_error("Database not initialized"); return -1; }
 
-    pthread_mutex_lock(mtx);
+    db_writer_lock();
 
     sqlite3_stmt *stmt = NULL;
     const char *sql = "INSERT OR IGNORE INTO recording_tags (recording_id, tag) VALUES (?, ?);";
     int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
         log_error("Failed to prepare tag insert: %s", sqlite3_errmsg(db));
-        pthread_mutex_unlock(mtx);
+        db_writer_unlock();
         return -1;
     }
     sqlite3_bind_int64(stmt, 1, (sqlite3_int64)recording_id);
     sqlite3_bind_text(stmt, 2, trimmed, -1, SQLITE_STATIC);
     rc = sqlite3_step(stmt);
     sqlite3_finalize(stmt);
-    pthread_mutex_unlock(mtx);
+    db_writer_unlock();
 
     return (rc == SQLITE_DONE) ? 0 : -1;
 }
@@ -53,41 +52,39 @@ int db_recording_tag_remove(uint64_t recording_id, const char *tag) {
     }
 
     sqlite3 *db = get_db_handle();
-    pthread_mutex_t *mtx = get_db_mutex();
     if (!db) { log_error("Database not initialized"); return -1; }
 
-    pthread_mutex_lock(mtx);
+    db_writer_lock();
 
     sqlite3_stmt *stmt = NULL;
     const char *sql = "DELETE FROM recording_tags WHERE recording_id = ? AND tag = ?;";
     int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
         log_error("Failed to prepare tag delete: %s", sqlite3_errmsg(db));
-        pthread_mutex_unlock(mtx);
+        db_writer_unlock();
         return -1;
     }
     sqlite3_bind_int64(stmt, 1, (sqlite3_int64)recording_id);
     sqlite3_bind_text(stmt, 2, trimmed, -1, SQLITE_STATIC);
     rc = sqlite3_step(stmt);
     sqlite3_finalize(stmt);
-    pthread_mutex_unlock(mtx);
+    db_writer_unlock();
 
     return (rc == SQLITE_DONE) ? 0 : -1;
 }
 
 int db_recording_tag_get(uint64_t recording_id, char tags[][MAX_TAG_LENGTH], int max_tags) {
     sqlite3 *db = get_db_handle();
-    pthread_mutex_t *mtx = get_db_mutex();
     if (!db || !tags) return -1;
 
-    pthread_mutex_lock(mtx);
+    db_writer_lock();
 
     sqlite3_stmt *stmt = NULL;
     const char *sql = "SELECT tag FROM recording_tags WHERE recording_id = ? ORDER BY tag;";
     int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
         log_error("Failed to prepare tag select: %s", sqlite3_errmsg(db));
-        pthread_mutex_unlock(mtx);
+        db_writer_unlock();
         return -1;
     }
     sqlite3_bind_int64(stmt, 1, (sqlite3_int64)recording_id);
@@ -101,16 +98,15 @@ int db_recording_tag_get(uint64_t recording_id, char tags[][MAX_TAG_LENGTH], int
         }
     }
     sqlite3_finalize(stmt);
-    pthread_mutex_unlock(mtx);
+    db_writer_unlock();
     return count;
 }
 
 int db_recording_tag_set(uint64_t recording_id, const char **tags, int tag_count) {
     sqlite3 *db = get_db_handle();
-    pthread_mutex_t *mtx = get_db_mutex();
     if (!db) { log_error("Database not initialized"); return -1; }
 
-    pthread_mutex_lock(mtx);
+    db_writer_lock();
 
     /* Delete existing tags */
     sqlite3_stmt *del_stmt = NULL;
@@ -118,7 +114,7 @@ int db_recording_tag_set(uint64_t recording_id, const char **tags, int tag_count
         "DELETE FROM recording_tags WHERE recording_id = ?;", -1, &del_stmt, NULL);
     if (rc != SQLITE_OK) {
         log_error("Failed to prepare tag delete-all: %s", sqlite3_errmsg(db));
-        pthread_mutex_unlock(mtx);
+        db_writer_unlock();
         return -1;
     }
     sqlite3_bind_int64(del_stmt, 1, (sqlite3_int64)recording_id);
@@ -133,7 +129,7 @@ int db_recording_tag_set(uint64_t recording_id, const char **tags, int tag_count
             -1, &ins_stmt, NULL);
         if (rc != SQLITE_OK) {
             log_error("Failed to prepare tag insert: %s", sqlite3_errmsg(db));
-            pthread_mutex_unlock(mtx);
+            db_writer_unlock();
             return -1;
         }
         for (int i = 0; i < tag_count; i++) {
@@ -150,23 +146,22 @@ int db_recording_tag_set(uint64_t recording_id, const char **tags, int tag_count
         sqlite3_finalize(ins_stmt);
     }
 
-    pthread_mutex_unlock(mtx);
+    db_writer_unlock();
     return 0;
 }
 
 int db_recording_tag_get_all_unique(char tags[][MAX_TAG_LENGTH], int max_tags) {
     sqlite3 *db = get_db_handle();
-    pthread_mutex_t *mtx = get_db_mutex();
     if (!db || !tags) return -1;
 
-    pthread_mutex_lock(mtx);
+    db_writer_lock();
 
     sqlite3_stmt *stmt = NULL;
     const char *sql = "SELECT DISTINCT tag FROM recording_tags ORDER BY tag;";
     int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
         log_error("Failed to prepare unique tags select: %s", sqlite3_errmsg(db));
-        pthread_mutex_unlock(mtx);
+        db_writer_unlock();
         return -1;
     }
 
@@ -179,7 +174,7 @@ int db_recording_tag_get_all_unique(char tags[][MAX_TAG_LENGTH], int max_tags) {
         }
     }
     sqlite3_finalize(stmt);
-    pthread_mutex_unlock(mtx);
+    db_writer_unlock();
     return count;
 }
 
@@ -191,17 +186,16 @@ int db_recording_tag_batch_add(const uint64_t *recording_ids, int count, const c
     }
 
     sqlite3 *db = get_db_handle();
-    pthread_mutex_t *mtx = get_db_mutex();
     if (!db) { log_error("Database not initialized"); return -1; }
 
-    pthread_mutex_lock(mtx);
+    db_writer_lock();
 
     sqlite3_stmt *stmt = NULL;
     const char *sql = "INSERT OR IGNORE INTO recording_tags (recording_id, tag) VALUES (?, ?);";
     int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
         log_error("Failed to prepare batch tag insert: %s", sqlite3_errmsg(db));
-        pthread_mutex_unlock(mtx);
+        db_writer_unlock();
         return -1;
     }
 
@@ -213,7 +207,7 @@ int db_recording_tag_batch_add(const uint64_t *recording_ids, int count, const c
         if (sqlite3_step(stmt) == SQLITE_DONE) success++;
     }
     sqlite3_finalize(stmt);
-    pthread_mutex_unlock(mtx);
+    db_writer_unlock();
     return success;
 }
 
@@ -225,17 +219,16 @@ int db_recording_tag_batch_remove(const uint64_t *recording_ids, int count, cons
     }
 
     sqlite3 *db = get_db_handle();
-    pthread_mutex_t *mtx = get_db_mutex();
     if (!db) { log_error("Database not initialized"); return -1; }
 
-    pthread_mutex_lock(mtx);
+    db_writer_lock();
 
     sqlite3_stmt *stmt = NULL;
     const char *sql = "DELETE FROM recording_tags WHERE recording_id = ? AND tag = ?;";
     int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
         log_error("Failed to prepare batch tag delete: %s", sqlite3_errmsg(db));
-        pthread_mutex_unlock(mtx);
+        db_writer_unlock();
         return -1;
     }
 
@@ -247,7 +240,7 @@ int db_recording_tag_batch_remove(const uint64_t *recording_ids, int count, cons
         if (sqlite3_step(stmt) == SQLITE_DONE) success++;
     }
     sqlite3_finalize(stmt);
-    pthread_mutex_unlock(mtx);
+    db_writer_unlock();
     return success;
 }
 
@@ -259,17 +252,16 @@ int db_recording_tag_get_recordings_by_tag(const char *tag, uint64_t *recording_
     }
 
     sqlite3 *db = get_db_handle();
-    pthread_mutex_t *mtx = get_db_mutex();
     if (!db) return -1;
 
-    pthread_mutex_lock(mtx);
+    db_writer_lock();
 
     sqlite3_stmt *stmt = NULL;
     const char *sql = "SELECT recording_id FROM recording_tags WHERE tag = ? ORDER BY recording_id DESC;";
     int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
         log_error("Failed to prepare recordings-by-tag select: %s", sqlite3_errmsg(db));
-        pthread_mutex_unlock(mtx);
+        db_writer_unlock();
         return -1;
     }
     sqlite3_bind_text(stmt, 1, trimmed, -1, SQLITE_STATIC);
@@ -279,7 +271,7 @@ int db_recording_tag_get_recordings_by_tag(const char *tag, uint64_t *recording_
         recording_ids[count++] = (uint64_t)sqlite3_column_int64(stmt, 0);
     }
     sqlite3_finalize(stmt);
-    pthread_mutex_unlock(mtx);
+    db_writer_unlock();
     return count;
 }
 
@@ -13,12 +13,15 @@
 
 #include "database/db_recordings.h"
 #include "database/db_core.h"
+#include "database/db_write_queue.h"
 #include "core/logger.h"
 #include "utils/strings.h"
 
 #define MAX_MULTI_FILTER_VALUES 32
 #define MAX_MULTI_FILTER_VALUE_LEN 128
 
+static int refresh_detection_summary(sqlite3 *db, uint64_t id);
+
 static int parse_csv_filter_values(const char *csv,
                                    char values[][MAX_MULTI_FILTER_VALUE_LEN],
                                    int max_values) {
@@ -63,7 +66,6 @@ uint64_t add_recording_metadata(const recording_metadata_t *metadata) {
     uint64_t recording_id = 0;
 
     sqlite3 *db = get_db_handle();
-    pthread_mutex_t *db_mutex = get_db_mutex();
 
     if (!db) {
         log_error("Database not initialized");
@@ -75,7 +77,7 @@ uint64_t add_recording_metadata(const recording_metadata_t *metadata) {
         return 0;
     }
 
-    pthread_mutex_lock(db_mutex);
+    db_writer_lock();
 
     const char *sql = "INSERT INTO recordings (stream_name, file_path, start_time, end_time, "
                       "size_bytes, width, height, fps, codec, is_complete, trigger_type, "
@@ -85,7 +87,7 @@ uint64_t add_recording_metadata(const recording_metadata_t *metadata) {
     rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
         log_error("Failed to prepare statement: %s", sqlite3_errmsg(db));
-        pthread_mutex_unlock(db_mutex);
+        db_writer_unlock();
         return 0;
     }
 
@@ -128,61 +130,157 @@ uint64_t add_recording_metadata(const recording_metadata_t *metadata) {
 
     // Finalize the prepared statement
     sqlite3_finalize(stmt);
-    pthread_mutex_unlock(db_mutex);
+
+    // Recordings imported as complete already cover detections
+    if (recording_id > 0 && metadata->is_complete && metadata->end_time > 0) {
+        refresh_detection_summary(db, recording_id);
+    }
+    db_writer_unlock();
 
     return recording_id;
 }
 
-// Update recording metadata in the database
-int update_recording_metadata(uint64_t id, time_t end_time,
-                             uint64_t size_bytes, bool is_complete) {
-    int rc;
-    sqlite3_stmt *stmt;
+// Recording update copied for the write queue
+typedef struct {
+    uint64_t id;
+    time_t end_time;
+    uint64_t size_bytes;
+    bool is_complete;
+} recording_update_t;
+
+// Recount the detection summary of one recording from the detections
+// table: detections linked to it plus those of its stream inside its time
+// range. The caller holds the writer lock.
+static int refresh_detection_summary(sqlite3 *db, uint64_t id) {
+    static const char *sql[] = {
+        "DELETE FROM recording_detection_labels WHERE recording_id = ?1;",
+        "INSERT INTO recording_detection_labels (recording_id, label, count, max_confidence) "
+        "SELECT r.id, d.label, COUNT(*), MAX(d.confidence) "
+        "FROM recordings r CROSS JOIN detections d "
+        "ON d.recording_id = r.id "
+        "OR (d.stream_name = r.stream_name AND d.timestamp >= r.start_time AND d.timestamp <= r.end_time) "
+        "WHERE r.id = ?1 GROUP BY d.label;",
+        "UPDATE recordings SET "
+        "detection_count = COALESCE((SELECT SUM(count) FROM recording_detection_labels WHERE recording_id = ?1), 0), "
+        "max_confidence = COALESCE((SELECT MAX(max_confidence) FROM recording_detection_labels WHERE recording_id = ?1), 0) "
+        "WHERE id = ?1;",
+    };
+
+    for (size_t i = 0; i < sizeof(sql) / sizeof(sql[0]); i++) {
+        sqlite3_stmt *stmt = db_prepare_cached(sql[i]);
+        if (!stmt) {
+            return -1;
+        }
+        sqlite3_bind_int64(stmt, 1, (sqlite3_int64)id);
+        int rc = sqlite3_step(stmt);
+        db_release_cached(stmt);
+        if (rc != SQLITE_DONE) {
+            log_error("Failed to refresh detection summary of recording %llu: %s",
+                      (unsigned long long)id, sqlite3_errmsg(db));
+            return -1;
+        }
+    }
+    return 0;
+}
 
+int refresh_recording_detection_summary(uint64_t id) {
     sqlite3 *db = get_db_handle();
-    pthread_mutex_t *db_mutex = get_db_mutex();
-
     if (!db) {
         log_error("Database not initialized");
         return -1;
     }
 
-    pthread_mutex_lock(db_mutex);
-
-    const char *sql = "UPDATE recordings SET end_time = ?, size_bytes = ?, is_complete = ? "
-                      "WHERE id = ?;";
+    db_writer_lock();
+    int rc = refresh_detection_summary(db, id);
+    db_writer_unlock();
+    return rc;
+}
 
-    rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
-    if (rc != SQLITE_OK) {
-        log_error("Failed to prepare statement: %s", sqlite3_errmsg(db));
-        pthread_mutex_unlock(db_mutex);
+// Apply a recording update; the caller holds the writer lock and an open transaction
+static int apply_recording_update(sqlite3 *db, const void *payload) {
+    const recording_update_t *u = payload;
+
+    // A progress update that lands after the completion (a stale size sync)
+    // only changes the size; it never reopens the recording
+    sqlite3_stmt *stmt = db_prepare_cached("UPDATE recordings SET "
+                                           "end_time = CASE WHEN is_complete = 1 AND ?3 = 0 THEN end_time ELSE ?1 END, "
+                                           "size_bytes = ?2, is_complete = MAX(is_complete, ?3) "
+                                           "WHERE id = ?4;");
+    if (!stmt) {
         return -1;
     }
 
-    // No longer tracking statements - each function is responsible for finalizing its own statements
-
     // Bind parameters
-    sqlite3_bind_int64(stmt, 1, (sqlite3_int64)end_time);
-    sqlite3_bind_int64(stmt, 2, (sqlite3_int64)size_bytes);
-    sqlite3_bind_int(stmt, 3, is_complete ? 1 : 0);
-    sqlite3_bind_int64(stmt, 4, (sqlite3_int64)id);
+    sqlite3_bind_int64(stmt, 1, (sqlite3_int64)u->end_time);
+    sqlite3_bind_int64(stmt, 2, (sqlite3_int64)u->size_bytes);
+    sqlite3_bind_int(stmt, 3, u->is_complete ? 1 : 0);
+    sqlite3_bind_int64(stmt, 4, (sqlite3_int64)u->id);
 
     // Execute statement
-    rc = sqlite3_step(stmt);
+    int rc = sqlite3_step(stmt);
     if (rc != SQLITE_DONE) {
         log_error("Failed to update recording metadata: %s", sqlite3_errmsg(db));
-        sqlite3_finalize(stmt);
-        pthread_mutex_unlock(db_mutex);
+    }
+    db_release_cached(stmt);
+    if (rc != SQLITE_DONE) {
         return -1;
     }
 
-    // Finalize the prepared statement
-    sqlite3_finalize(stmt);
-    pthread_mutex_unlock(db_mutex);
-
+    // The final time range is known now; count the detections inside it
+    if (u->is_complete) {
+        return refresh_detection_summary(db, u->id);
+    }
     return 0;
 }
 
+// Fold a newer progress update into the one still queued for the recording.
+// Fields the caller left at 0 (unknown) keep the queued value, and a queued
+// completion is never turned back into progress.
+static void merge_recording_update(void *queued, const void *incoming) {
+    recording_update_t *q = queued;
+    const recording_update_t *in = incoming;
+
+    if (q->is_complete && !in->is_complete) {
+        if (in->size_bytes > 0) {
+            q->size_bytes = in->size_bytes;
+        }
+        return;
+    }
+
+    if (in->end_time != 0) {
+        q->end_time = in->end_time;
+    }
+    if (in->size_bytes > 0) {
+        q->size_bytes = in->size_bytes;
+    }
+    q->is_complete = in->is_complete;
+}
+
+// Update recording metadata in the database. Progress updates go through the
+// write queue, keyed by recording, so only the newest values are written.
+// Completions are committed before returning, after everything queued
+// earlier, so readers see the finished recording right away.
+int update_recording_metadata(uint64_t id, time_t end_time,
+                             uint64_t size_bytes, bool is_complete) {
+    if (!get_db_handle()) {
+        log_error("Database not initialized");
+        return -1;
+    }
+
+    recording_update_t u = {
+        .id = id,
+        .end_time = end_time,
+        .size_bytes = size_bytes,
+        .is_complete = is_complete,
+    };
+
+    if (is_complete) {
+        db_write_queue_flush();
+        return db_write_now(apply_recording_update, &u);
+    }
+    return db_write_queue_submit_keyed(apply_recording_update, merge_recording_update, id, &u, sizeof(u));
+}
+
 /**
  * Correct the start_time of an existing recording in the database.
  *
@@ -195,14 +293,13 @@ int update_recording_start_time(uint64_t id, time_t start_time) {
     sqlite3_stmt *stmt;
 
     sqlite3 *db = get_db_handle();
-    pthread_mutex_t *db_mutex = get_db_mutex();
 
     if (!db) {
         log_error("Database not initialized");
         return -1;
     }
 
-    pthread_mutex_lock(db_mutex);
+    db_writer_lock();
 
     const char *sql = "UPDATE recordings SET start_time = ? WHERE id = ?;";
 
@@ -210,7 +307,7 @@ int update_recording_start_time(uint64_t id, time_t start_time) {
     if (rc != SQLITE_OK) {
         log_error("Failed to prepare update_recording_start_time statement: %s",
                   sqlite3_errmsg(db));
-        pthread_mutex_unlock(db_mutex);
+        db_writer_unlock();
         return -1;
     }
 
@@ -222,12 +319,12 @@ int update_recording_start_time(uint64_t id, time_t start_time) {
         log_error("Failed to update recording start_time (id=%llu): %s",
                   (unsigned long long)id, sqlite3_errmsg(db));
         sqlite3_finalize(stmt);
-        pthread_mutex_unlock(db_mutex);
+        db_writer_unlock();
         return -1;
     }
 
     sqlite3_finalize(stmt);
-    pthread_mutex_unlock(db_mutex);
+    db_writer_unlock();
 
     log_debug("Corrected start_time for recording ID %llu to %ld",
               (unsigned long long)id, (long)start_time);
@@ -236,12 +333,10 @@ int update_recording_start_time(uint64_t id, time_t start_time) {
 
 // Get recording metadata by ID
 int get_recording_metadata_by_id(uint64_t id, recording_metadata_t *metadata) {
-    int rc;
     sqlite3_stmt *stmt;
     int result = -1;
 
     sqlite3 *db = get_db_handle();
-    pthread_mutex_t *db_mutex = get_db_mutex();
 
     if (!db) {
         log_error("Database not initialized");
@@ -253,22 +348,23 @@ int get_recording_metadata_by_id(uint64_t id, recording_metadata_t *metadata) {
         return -1;
     }
 
-    pthread_mutex_lock(db_mutex);
+    db = db_reader_acquire();
+    if (!db) {
+        log_error("No database connection available");
+        return -1;
+    }
 
     const char *sql = "SELECT id, stream_name, file_path, start_time, end_time, "
                       "size_bytes, width, height, fps, codec, is_complete, trigger_type, "
                       "protected, retention_override_days, retention_tier, disk_pressure_eligible "
                       "FROM recordings WHERE id = ?;";
 
-    rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
-    if (rc != SQLITE_OK) {
-        log_error("Failed to prepare statement: %s", sqlite3_errmsg(db));
-        pthread_mutex_unlock(db_mutex);
+    stmt = db_prepare_cached_on(db, sql);
+    if (!stmt) {
+        db_reader_release(db);
         return -1;
     }
 
-    // No longer tracking statements - each function is responsible for finalizing its own statements
-
     // Bind parameters
     sqlite3_bind_int64(stmt, 1, (sqlite3_int64)id);
 
@@ -335,9 +431,8 @@ int get_recording_metadata_by_id(uint64_t id, recording_metadata_t *metadata) {
         result = 0; // Success
     }
 
-    // Finalize the prepared statement
-    sqlite3_finalize(stmt);
-    pthread_mutex_unlock(db_mutex);
+    db_release_cached(stmt);
+    db_reader_release(db);
 
     return result;
 }
@@ -349,7 +444,6 @@ int get_recording_metadata_by_path(const char *file_path, recording_metadata_t *
     int result = -1;
 
     sqlite3 *db = get_db_handle();
-    pthread_mutex_t *db_mutex = get_db_mutex();
 
     if (!db) {
         log_error("Database not initialized");
@@ -361,7 +455,11 @@ int get_recording_metadata_by_path(const char *file_path, recording_metadata_t *
         return -1;
     }
 
-    pthread_mutex_lock(db_mutex);
+    db = db_reader_acquire();
+    if (!db) {
+        log_error("No database connection available");
+        return -1;
+    }
 
     const char *sql = "SELECT id, stream_name, file_path, start_time, end_time, "
                       "size_bytes, width, height, fps, codec, is_complete, trigger_type, "
@@ -371,7 +469,7 @@ int get_recording_metadata_by_path(const char *file_path, recording_metadata_t *
     rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
         log_error("Failed to prepare statement: %s", sqlite3_errmsg(db));
-        pthread_mutex_unlock(db_mutex);
+        db_reader_release(db);
         return -1;
     }
 
@@ -440,7 +538,7 @@ int get_recording_metadata_by_path(const char *file_path, recording_metadata_t *
     }
 
     sqlite3_finalize(stmt);
-    pthread_mutex_unlock(db_mutex);
+    db_reader_release(db);
 
     return result;
 }
@@ -454,7 +552,6 @@ int get_recording_metadata(time_t start_time, time_t end_time,
     int count = 0;
 
     sqlite3 *db = get_db_handle();
-    pthread_mutex_t *db_mutex = get_db_mutex();
 
     if (!db) {
         log_error("Database not initialized");
@@ -466,7 +563,11 @@ int get_recording_metadata(time_t start_time, time_t end_time,
         return -1;
     }
 
-    pthread_mutex_lock(db_mutex);
+    db = db_reader_acquire();
+    if (!db) {
+        log_error("No database connection available");
+        return -1;
+    }
 
     // Build query based on filters
     char sql[1024];
@@ -492,7 +593,7 @@ int get_recording_metadata(time_t start_time, time_t end_time,
     rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
         log_error("Failed to prepare statement: %s", sqlite3_errmsg(db));
-        pthread_mutex_unlock(db_mutex);
+        db_reader_release(db);
         return -1;
     }
 
@@ -588,7 +689,7 @@ int get_recording_metadata(time_t start_time, time_t end_time,
 
     // Finalize the prepared statement
     sqlite3_finalize(stmt);
-    pthread_mutex_unlock(db_mutex);
+    db_reader_release(db);
 
     log_info("Found %d recordings in database matching criteria", count);
     return count;
@@ -613,14 +714,17 @@ int get_recording_count(time_t start_time, time_t end_time,
     int capture_method_count = parse_csv_filter_values(capture_method_filter, capture_method_filters, MAX_MULTI_FILTER_VALUES);
 
     sqlite3 *db = get_db_handle();
-    pthread_mutex_t *db_mutex = get_db_mutex();
 
     if (!db) {
         log_error("Database not initialized");
         return -1;
     }
 
-    pthread_mutex_lock(db_mutex);
+    db = db_reader_acquire();
+    if (!db) {
+        log_error("No database connection available");
+        return -1;
+    }
 
     // Build query based on filters
     char sql[8192];
@@ -629,41 +733,26 @@ int get_recording_count(time_t start_time, time_t end_time,
     safe_strcpy(sql, "SELECT COUNT(*) FROM recordings r WHERE r.is_complete = 1 AND r.end_time IS NOT NULL", sizeof(sql), 0);
 
     if (has_detection == 1) {
-        // Filter by trigger_type = 'detection' OR existence of linked detections via recording_id (fast index lookup)
-        // Falls back to timestamp range scan for legacy detections without recording_id
-        safe_strcat(sql, " AND (r.trigger_type = 'detection'"
-                    " OR EXISTS (SELECT 1 FROM detections d WHERE d.recording_id = r.id)"
-                    " OR EXISTS (SELECT 1 FROM detections d WHERE d.stream_name = r.stream_name"
-                    " AND d.timestamp >= r.start_time AND d.timestamp <= r.end_time))",
-                    sizeof(sql));
-        log_debug("Adding detection filter (trigger_type OR recording_id OR timestamp range)");
+        // Filter by trigger_type = 'detection' OR the maintained detection summary
+        safe_strcat(sql, " AND (r.trigger_type = 'detection' OR r.detection_count > 0)", sizeof(sql));
+        log_debug("Adding detection filter (trigger_type OR detection_count)");
     } else if (has_detection == -1) {
         // Filter to recordings with NO detections
         safe_strcat(sql, " AND (r.trigger_type != 'detection' OR r.trigger_type IS NULL)"
-                    " AND NOT EXISTS (SELECT 1 FROM detections d WHERE d.recording_id = r.id)"
-                    " AND NOT EXISTS (SELECT 1 FROM detections d WHERE d.stream_name = r.stream_name"
-                    " AND d.timestamp >= r.start_time AND d.timestamp <= r.end_time)",
+                    " AND r.detection_count = 0",
                     sizeof(sql));
-        log_debug("Adding no-detection filter (no trigger_type AND no linked detections)");
+        log_debug("Adding no-detection filter (no trigger_type AND no detections)");
     }
 
     if (detection_label_count > 0) {
-        // Filter by specific detection label - prefer recording_id FK lookup, fall back to timestamp range
-        safe_strcat(sql, " AND (EXISTS (SELECT 1 FROM detections d WHERE d.recording_id = r.id AND (",
+        // Filter by specific detection label - one primary key lookup per recording
+        safe_strcat(sql, " AND EXISTS (SELECT 1 FROM recording_detection_labels rl WHERE rl.recording_id = r.id AND (",
                 sizeof(sql));
         for (int i = 0; i < detection_label_count; i++) {
             if (i > 0) safe_strcat(sql, " OR ", sizeof(sql));
-            safe_strcat(sql, "d.label LIKE ?", sizeof(sql));
-        }
-        safe_strcat(sql, ")) OR EXISTS (SELECT 1 FROM detections d WHERE d.recording_id IS NULL"
-                    " AND d.stream_name = r.stream_name AND d.timestamp >= r.start_time"
-                    " AND d.timestamp <= r.end_time AND (",
-                    sizeof(sql));
-        for (int i = 0; i < detection_label_count; i++) {
-            if (i > 0) safe_strcat(sql, " OR ", sizeof(sql));
-            safe_strcat(sql, "d.label LIKE ?", sizeof(sql));
+            safe_strcat(sql, "rl.label LIKE ?", sizeof(sql));
         }
-        safe_strcat(sql, ")))", sizeof(sql));
+        safe_strcat(sql, "))", sizeof(sql));
         log_debug("Adding %d detection_label filters", detection_label_count);
     }
 
@@ -729,7 +818,7 @@ int get_recording_count(time_t start_time, time_t end_time,
     rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
         log_error("Failed to prepare statement: %s", sqlite3_errmsg(db));
-        pthread_mutex_unlock(db_mutex);
+        db_reader_release(db);
         return -1;
     }
 
@@ -738,17 +827,10 @@ int get_recording_count(time_t start_time, time_t end_time,
     // Bind parameters
     int param_index = 1;
 
-    if (detection_label_count > 0) {
-        for (int i = 0; i < detection_label_count; i++) {
-            char label_pattern[MAX_MULTI_FILTER_VALUE_LEN + 2];
-            snprintf(label_pattern, sizeof(label_pattern), "%%%s%%", detection_label_filters[i]);
-            sqlite3_bind_text(stmt, param_index++, label_pattern, -1, SQLITE_TRANSIENT);
-        }
-        for (int i = 0; i < detection_label_count; i++) {
-            char label_pattern[MAX_MULTI_FILTER_VALUE_LEN + 2];
-            snprintf(label_pattern, sizeof(label_pattern), "%%%s%%", detection_label_filters[i]);
-            sqlite3_bind_text(stmt, param_index++, label_pattern, -1, SQLITE_TRANSIENT);
-        }
+    for (int i = 0; i < detection_label_count; i++) {
+        char label_pattern[MAX_MULTI_FILTER_VALUE_LEN + 2];
+        snprintf(label_pattern, sizeof(label_pattern), "%%%s%%", detection_label_filters[i]);
+        sqlite3_bind_text(stmt, param_index++, label_pattern, -1, SQLITE_TRANSIENT);
     }
 
     if (start_time > 0) {
@@ -787,22 +869,53 @@ int get_recording_count(time_t start_time, time_t end_time,
 
     // Finalize the prepared statement
     sqlite3_finalize(stmt);
-    pthread_mutex_unlock(db_mutex);
+    db_reader_release(db);
 
     log_debug("Total count of recordings matching criteria: %d", count);
     return count;
 }
 
-// Get paginated recording metadata from the database with sorting
-int get_recording_metadata_paginated(time_t start_time, time_t end_time,
-                                   const char *stream_name, int has_detection,
-                                   const char *detection_label,
-                                   int protected_filter,
-                                   const char *sort_field, const char *sort_order,
-                                   recording_metadata_t *metadata,
-                                   int limit, int offset,
-                                   const char * const *allowed_streams, int allowed_streams_count,
-                                   const char *tag_filter, const char *capture_method_filter) {
+// Validate and sanitize sort field to prevent SQL injection
+static void sanitize_sort_field(const char *sort_field, char *out, size_t out_size) {
+    safe_strcpy(out, "start_time", out_size, 0); // Default sort field
+    if (sort_field) {
+        if (strcmp(sort_field, "id") == 0 ||
+            strcmp(sort_field, "stream_name") == 0 ||
+            strcmp(sort_field, "start_time") == 0 ||
+            strcmp(sort_field, "end_time") == 0 ||
+            strcmp(sort_field, "size_bytes") == 0) {
+            safe_strcpy(out, sort_field, out_size, 0);
+        } else {
+            log_warn("Invalid sort field: %s, using default", sort_field);
+        }
+    }
+}
+
+// Validate sort order
+static void sanitize_sort_order(const char *sort_order, char *out, size_t out_size) {
+    safe_strcpy(out, "DESC", out_size, 0); // Default sort order
+    if (sort_order) {
+        if (strcasecmp(sort_order, "asc") == 0) {
+            safe_strcpy(out, "ASC", out_size, 0);
+        } else if (strcasecmp(sort_order, "desc") == 0) {
+            safe_strcpy(out, "DESC", out_size, 0);
+        } else {
+            log_warn("Invalid sort order: %s, using default", sort_order);
+        }
+    }
+}
+
+// Shared by offset and keyset pagination. With a cursor the page starts
+// after the cursor row and offset is ignored.
+static int query_recordings_page(time_t start_time, time_t end_time,
+                                 const char *stream_name, int has_detection,
+                                 const char *detection_label,
+                                 int protected_filter,
+                                 const char *sort_field, const char *sort_order,
+                                 recording_metadata_t *metadata,
+                                 int limit, int offset, const recording_cursor_t *after,
+                                 const char * const *allowed_streams, int allowed_streams_count,
+                                 const char *tag_filter, const char *capture_method_filter) {
     int rc;
     sqlite3_stmt *stmt;
     int count = 0;
@@ -816,7 +929,6 @@ int get_recording_metadata_paginated(time_t start_time, time_t end_time,
     int capture_method_count = parse_csv_filter_values(capture_method_filter, capture_method_filters, MAX_MULTI_FILTER_VALUES);
 
     sqlite3 *db = get_db_handle();
-    pthread_mutex_t *db_mutex = get_db_mutex();
 
     if (!db) {
         log_error("Database not initialized");
@@ -828,33 +940,17 @@ int get_recording_metadata_paginated(time_t start_time, time_t end_time,
         return -1;
     }
 
-    pthread_mutex_lock(db_mutex);
-
-    // Validate and sanitize sort field to prevent SQL injection
-    char safe_sort_field[32] = "start_time"; // Default sort field
-    if (sort_field) {
-        if (strcmp(sort_field, "id") == 0 ||
-            strcmp(sort_field, "stream_name") == 0 ||
-            strcmp(sort_field, "start_time") == 0 ||
-            strcmp(sort_field, "end_time") == 0 ||
-            strcmp(sort_field, "size_bytes") == 0) {
-            safe_strcpy(safe_sort_field, sort_field, sizeof(safe_sort_field), 0);
-        } else {
-            log_warn("Invalid sort field: %s, using default", sort_field);
-        }
+    db = db_reader_acquire();
+    if (!db) {
+        log_error("No database connection available");
+        return -1;
     }
 
-    // Validate sort order
-    char safe_sort_order[8] = "DESC"; // Default sort order
-    if (sort_order) {
-        if (strcasecmp(sort_order, "asc") == 0) {
-            strcpy(safe_sort_order, "ASC");
-        } else if (strcasecmp(sort_order, "desc") == 0) {
-            strcpy(safe_sort_order, "DESC");
-        } else {
-            log_warn("Invalid sort order: %s, using default", sort_order);
-        }
-    }
+    char safe_sort_field[32];
+    char safe_sort_order[8];
+    sanitize_sort_field(sort_field, safe_sort_field, sizeof(safe_sort_field));
+    sanitize_sort_order(sort_order, safe_sort_order, sizeof(safe_sort_order));
+    bool sort_by_id = strcmp(safe_sort_field, "id") == 0;
 
     // Build query based on filters
     char sql[8192];
@@ -867,41 +963,26 @@ int get_recording_metadata_paginated(time_t start_time, time_t end_time,
             "FROM recordings r WHERE r.is_complete = 1 AND r.end_time IS NOT NULL");
 
     if (has_detection == 1) {
-        // Filter by trigger_type = 'detection' OR existence of linked detections via recording_id (fast index lookup)
-        // Falls back to timestamp range scan for legacy detections without recording_id
-        safe_strcat(sql, " AND (r.trigger_type = 'detection'"
-                    " OR EXISTS (SELECT 1 FROM detections d WHERE d.recording_id = r.id)"
-                    " OR EXISTS (SELECT 1 FROM detections d WHERE d.stream_name = r.stream_name"
-                    " AND d.timestamp >= r.start_time AND d.timestamp <= r.end_time))",
-                    sizeof(sql));
-        log_info("Adding detection filter (trigger_type OR recording_id OR timestamp range)");
+        // Filter by trigger_type = 'detection' OR the maintained detection summary
+        safe_strcat(sql, " AND (r.trigger_type = 'detection' OR r.detection_count > 0)", sizeof(sql));
+        log_info("Adding detection filter (trigger_type OR detection_count)");
     } else if (has_detection == -1) {
         // Filter to recordings with NO detections
         safe_strcat(sql, " AND (r.trigger_type != 'detection' OR r.trigger_type IS NULL)"
-                    " AND NOT EXISTS (SELECT 1 FROM detections d WHERE d.recording_id = r.id)"
-                    " AND NOT EXISTS (SELECT 1 FROM detections d WHERE d.stream_name = r.stream_name"
-                    " AND d.timestamp >= r.start_time AND d.timestamp <= r.end_time)",
+                    " AND r.detection_count = 0",
                     sizeof(sql));
-        log_info("Adding no-detection filter (no trigger_type AND no linked detections)");
+        log_info("Adding no-detection filter (no trigger_type AND no detections)");
     }
 
     if (detection_label_count > 0) {
-        // Filter by specific detection label - prefer recording_id FK lookup, fall back to timestamp range
-        safe_strcat(sql, " AND (EXISTS (SELECT 1 FROM detections d WHERE d.recording_id = r.id AND (",
+        // Filter by specific detection label - one primary key lookup per recording
+        safe_strcat(sql, " AND EXISTS (SELECT 1 FROM recording_detection_labels rl WHERE rl.recording_id = r.id AND (",
                 sizeof(sql));
         for (int i = 0; i < detection_label_count; i++) {
             if (i > 0) safe_strcat(sql, " OR ", sizeof(sql));
-            safe_strcat(sql, "d.label LIKE ?", sizeof(sql));
-        }
-        safe_strcat(sql, ")) OR EXISTS (SELECT 1 FROM detections d WHERE d.recording_id IS NULL"
-                    " AND d.stream_name = r.stream_name AND d.timestamp >= r.start_time"
-                    " AND d.timestamp <= r.end_time AND (",
-                    sizeof(sql));
-        for (int i = 0; i < detection_label_count; i++) {
-            if (i > 0) safe_strcat(sql, " OR ", sizeof(sql));
-            safe_strcat(sql, "d.label LIKE ?", sizeof(sql));
+            safe_strcat(sql, "rl.label LIKE ?", sizeof(sql));
         }
-        safe_strcat(sql, ")))", sizeof(sql));
+        safe_strcat(sql, "))", sizeof(sql));
         log_info("Adding %d detection_label filters", detection_label_count);
     }
 
@@ -962,14 +1043,35 @@ int get_recording_metadata_paginated(time_t start_time, time_t end_time,
         log_debug("Adding %d capture_method filters to paginated query", capture_method_count);
     }
 
-    // Add ORDER BY clause with sanitized field and order
-    char order_clause[64];
-    snprintf(order_clause, sizeof(order_clause), " ORDER BY r.%s %s", safe_sort_field, safe_sort_order);
+    // Keyset condition: rows strictly after the cursor row in sort order.
+    // Comparing (sort column, id) as a row value keeps rows that share a
+    // sort value with the cursor row and can be answered from the index.
+    if (after) {
+        char keyset_clause[96];
+        const char *cmp = strcmp(safe_sort_order, "ASC") == 0 ? ">" : "<";
+        if (sort_by_id) {
+            snprintf(keyset_clause, sizeof(keyset_clause), " AND r.id %s ?", cmp);
+        } else {
+            snprintf(keyset_clause, sizeof(keyset_clause), " AND (r.%s, r.id) %s (?, ?)",
+                     safe_sort_field, cmp);
+        }
+        safe_strcat(sql, keyset_clause, sizeof(sql));
+    }
+
+    // Add ORDER BY clause with sanitized field and order; id breaks ties so
+    // pages are stable
+    char order_clause[96];
+    if (sort_by_id) {
+        snprintf(order_clause, sizeof(order_clause), " ORDER BY r.id %s", safe_sort_order);
+    } else {
+        snprintf(order_clause, sizeof(order_clause), " ORDER BY r.%s %s, r.id %s",
+                 safe_sort_field, safe_sort_order, safe_sort_order);
+    }
     safe_strcat(sql, order_clause, sizeof(sql));
 
     // Add LIMIT and OFFSET for pagination
     char limit_clause[64];
-    safe_strcpy(limit_clause, " LIMIT ? OFFSET ?", sizeof(limit_clause), 0);
+    safe_strcpy(limit_clause, after ? " LIMIT ?" : " LIMIT ? OFFSET ?", sizeof(limit_clause), 0);
     safe_strcat(sql, limit_clause, sizeof(sql));
 
     log_debug("SQL query for get_recording_metadata_paginated: %s", sql);
@@ -977,7 +1079,7 @@ int get_recording_metadata_paginated(time_t start_time, time_t end_time,
     rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
         log_error("Failed to prepare statement: %s", sqlite3_errmsg(db));
-        pthread_mutex_unlock(db_mutex);
+        db_reader_release(db);
         return -1;
     }
 
@@ -986,17 +1088,10 @@ int get_recording_metadata_paginated(time_t start_time, time_t end_time,
     // Bind parameters
     int param_index = 1;
 
-    if (detection_label_count > 0) {
-        for (int i = 0; i < detection_label_count; i++) {
-            char label_pattern[MAX_MULTI_FILTER_VALUE_LEN + 2];
-            snprintf(label_pattern, sizeof(label_pattern), "%%%s%%", detection_label_filters[i]);
-            sqlite3_bind_text(stmt, param_index++, label_pattern, -1, SQLITE_TRANSIENT);
-        }
-        for (int i = 0; i < detection_label_count; i++) {
-            char label_pattern[MAX_MULTI_FILTER_VALUE_LEN + 2];
-            snprintf(label_pattern, sizeof(label_pattern), "%%%s%%", detection_label_filters[i]);
-            sqlite3_bind_text(stmt, param_index++, label_pattern, -1, SQLITE_TRANSIENT);
-        }
+    for (int i = 0; i < detection_label_count; i++) {
+        char label_pattern[MAX_MULTI_FILTER_VALUE_LEN + 2];
+        snprintf(label_pattern, sizeof(label_pattern), "%%%s%%", detection_label_filters[i]);
+        sqlite3_bind_text(stmt, param_index++, label_pattern, -1, SQLITE_TRANSIENT);
     }
 
     if (start_time > 0) {
@@ -1025,9 +1120,22 @@ int get_recording_metadata_paginated(time_t start_time, time_t end_time,
         sqlite3_bind_text(stmt, param_index++, capture_method_filters[i], -1, SQLITE_TRANSIENT);
     }
 
+    if (after) {
+        if (!sort_by_id) {
+            if (strcmp(safe_sort_field, "stream_name") == 0) {
+                sqlite3_bind_text(stmt, param_index++, after->sort_text, -1, SQLITE_TRANSIENT);
+            } else {
+                sqlite3_bind_int64(stmt, param_index++, (sqlite3_int64)after->sort_int);
+            }
+        }
+        sqlite3_bind_int64(stmt, param_index++, (sqlite3_int64)after->id);
+    }
+
     // Bind LIMIT and OFFSET parameters
     sqlite3_bind_int(stmt, param_index++, limit);
-    sqlite3_bind_int(stmt, param_index, offset);
+    if (!after) {
+        sqlite3_bind_int(stmt, param_index, offset);
+    }
 
     // Execute query and fetch results
     int rc_step;
@@ -1102,27 +1210,179 @@ int get_recording_metadata_paginated(time_t start_time, time_t end_time,
 
     // Finalize the prepared statement
     sqlite3_finalize(stmt);
-    pthread_mutex_unlock(db_mutex);
+    db_reader_release(db);
 
-    log_debug("Found %d recordings in database matching criteria (page %d, limit %d)",
-             count, (offset / limit) + 1, limit);
+    if (after) {
+        log_debug("Found %d recordings in database matching criteria (after id %llu, limit %d)",
+                  count, (unsigned long long)after->id, limit);
+    } else {
+        log_debug("Found %d recordings in database matching criteria (page %d, limit %d)",
+                 count, (offset / limit) + 1, limit);
+    }
     return count;
 }
 
+// Get paginated recording metadata from the database with sorting
+int get_recording_metadata_paginated(time_t start_time, time_t end_time,
+                                   const char *stream_name, int has_detection,
+                                   const char *detection_label,
+                                   int protected_filter,
+                                   const char *sort_field, const char *sort_order,
+                                   recording_metadata_t *metadata,
+                                   int limit, int offset,
+                                   const char * const *allowed_streams, int allowed_streams_count,
+                                   const char *tag_filter, const char *capture_method_filter) {
+    return query_recordings_page(start_time, end_time, stream_name, has_detection,
+                                 detection_label, protected_filter, sort_field, sort_order,
+                                 metadata, limit, offset, NULL,
+                                 allowed_streams, allowed_streams_count,
+                                 tag_filter, capture_method_filter);
+}
+
+// Get the page of recordings after a cursor
+int get_recording_metadata_after(time_t start_time, time_t end_time,
+                                 const char *stream_name, int has_detection,
+                                 const char *detection_label,
+                                 int protected_filter,
+                                 const char *sort_field, const char *sort_order,
+                                 const recording_cursor_t *after,
+                                 recording_metadata_t *metadata, int limit,
+                                 const char * const *allowed_streams, int allowed_streams_count,
+                                 const char *tag_filter, const char *capture_method_filter) {
+    return query_recordings_page(start_time, end_time, stream_name, has_detection,
+                                 detection_label, protected_filter, sort_field, sort_order,
+                                 metadata, limit, 0, after,
+                                 allowed_streams, allowed_streams_count,
+                                 tag_filter, capture_method_filter);
+}
+
+// Cursor tokens are the hex encoding of "v1:<field>:<order>:<id>:<value>".
+// The value comes last because a stream name may contain ':'.
+int recording_cursor_encode(const recording_metadata_t *last,
+                            const char *sort_field, const char *sort_order,
+                            char *token, size_t token_size) {
+    if (!last || !token || token_size == 0) {
+        return -1;
+    }
+
+    char field[32];
+    char order[8];
+    sanitize_sort_field(sort_field, field, sizeof(field));
+    sanitize_sort_order(sort_order, order, sizeof(order));
+
+    char value[64];
+    if (strcmp(field, "stream_name") == 0) {
+        safe_strcpy(value, last->stream_name, sizeof(value), 0);
+    } else if (strcmp(field, "end_time") == 0) {
+        snprintf(value, sizeof(value), "%lld", (long long)last->end_time);
+    } else if (strcmp(field, "size_bytes") == 0) {
+        snprintf(value, sizeof(value), "%llu", (unsigned long long)last->size_bytes);
+    } else if (strcmp(field, "id") == 0) {
+        snprintf(value, sizeof(value), "%llu", (unsigned long long)last->id);
+    } else {
+        snprintf(value, sizeof(value), "%lld", (long long)last->start_time);
+    }
+
+    char plain[RECORDING_CURSOR_TOKEN_SIZE / 2];
+    int len = snprintf(plain, sizeof(plain), "v1:%s:%s:%llu:%s",
+                       field, order, (unsigned long long)last->id, value);
+    if (len < 0 || (size_t)len >= sizeof(plain) || (size_t)len * 2 + 1 > token_size) {
+        return -1;
+    }
+
+    static const char hex[] = "0123456789abcdef";
+    for (int i = 0; i < len; i++) {
+        token[i * 2] = hex[(unsigned char)plain[i] >> 4];
+        token[i * 2 + 1] = hex[(unsigned char)plain[i] & 0x0f];
+    }
+    token[len * 2] = '\0';
+    return 0;
+}
+
+static int hex_digit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+int recording_cursor_decode(const char *token,
+                            const char *sort_field, const char *sort_order,
+                            recording_cursor_t *cursor) {
+    if (!token || !cursor) {
+        return -1;
+    }
+
+    size_t token_len = strlen(token);
+    char plain[RECORDING_CURSOR_TOKEN_SIZE / 2];
+    if (token_len == 0 || token_len % 2 != 0 || token_len / 2 >= sizeof(plain)) {
+        return -1;
+    }
+    for (size_t i = 0; i < token_len / 2; i++) {
+        int hi = hex_digit(token[i * 2]);
+        int lo = hex_digit(token[i * 2 + 1]);
+        if (hi < 0 || lo < 0) {
+            return -1;
+        }
+        plain[i] = (char)((hi << 4) | lo);
+        if (plain[i] == '\0') {
+            return -1;
+        }
+    }
+    plain[token_len / 2] = '\0';
+
+    char field[32];
+    char order[8];
+    sanitize_sort_field(sort_field, field, sizeof(field));
+    sanitize_sort_order(sort_order, order, sizeof(order));
+
+    // The prefix must match the sort of this request
+    char prefix[48];
+    snprintf(prefix, sizeof(prefix), "v1:%s:%s:", field, order);
+    size_t prefix_len = strlen(prefix);
+    if (strncmp(plain, prefix, prefix_len) != 0) {
+        log_debug("Recording cursor does not match sort %s %s", field, order);
+        return -1;
+    }
+
+    char *p = plain + prefix_len;
+    char *end = NULL;
+    unsigned long long id = strtoull(p, &end, 10);
+    if (end == p || *end != ':') {
+        return -1;
+    }
+    const char *value = end + 1;
+
+    memset(cursor, 0, sizeof(*cursor));
+    cursor->id = (uint64_t)id;
+    if (strcmp(field, "stream_name") == 0) {
+        if (strlen(value) >= sizeof(cursor->sort_text)) {
+            return -1;
+        }
+        safe_strcpy(cursor->sort_text, value, sizeof(cursor->sort_text), 0);
+    } else {
+        long long v = strtoll(value, &end, 10);
+        if (end == value || *end != '\0') {
+            return -1;
+        }
+        cursor->sort_int = (int64_t)v;
+    }
+    return 0;
+}
+
 // Delete recording metadata from the database
 int delete_recording_metadata(uint64_t id) {
     int rc;
     sqlite3_stmt *stmt;
 
     sqlite3 *db = get_db_handle();
-    pthread_mutex_t *db_mutex = get_db_mutex();
 
     if (!db) {
         log_error("Database not initialized");
         return -1;
     }
 
-    pthread_mutex_lock(db_mutex);
+    db_writer_lock();
 
     // First, clear any foreign key references in the detections table
     // The detections table has FOREIGN KEY (recording_id) REFERENCES recordings(id)
@@ -1131,7 +1391,7 @@ int delete_recording_metadata(uint64_t id) {
     rc = sqlite3_prepare_v2(db, clear_fk_sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
         log_error("Failed to prepare detections FK cleanup: %s", sqlite3_errmsg(db));
-        pthread_mutex_unlock(db_mutex);
+        db_writer_unlock();
         return -1;
     }
     sqlite3_bind_int64(stmt, 1, (sqlite3_int64)id);
@@ -1140,7 +1400,7 @@ int delete_recording_metadata(uint64_t id) {
         log_error("Failed to clear detections FK for recording %llu: %s",
                   (unsigned long long)id, sqlite3_errmsg(db));
         sqlite3_finalize(stmt);
-        pthread_mutex_unlock(db_mutex);
+        db_writer_unlock();
         return -1;
     }
     sqlite3_finalize(stmt);
@@ -1151,7 +1411,7 @@ int delete_recording_metadata(uint64_t id) {
     rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
         log_error("Failed to prepare statement: %s", sqlite3_errmsg(db));
-        pthread_mutex_unlock(db_mutex);
+        db_writer_unlock();
         return -1;
     }
 
@@ -1163,17 +1423,89 @@ int delete_recording_metadata(uint64_t id) {
     if (rc != SQLITE_DONE) {
         log_error("Failed to delete recording metadata: %s", sqlite3_errmsg(db));
         sqlite3_finalize(stmt);
-        pthread_mutex_unlock(db_mutex);
+        db_writer_unlock();
         return -1;
     }
 
     // Finalize the prepared statement
     sqlite3_finalize(stmt);
-    pthread_mutex_unlock(db_mutex);
+    db_writer_unlock();
 
     return 0;
 }
 
+// Delete the metadata of several recordings in one transaction
+int delete_recordings_metadata_batch(const uint64_t *ids, int count) {
+    sqlite3 *db = get_db_handle();
+    char *err_msg = NULL;
+
+    if (!db) {
+        log_error("Database not initialized");
+        return -1;
+    }
+    if (!ids || count <= 0) {
+        return 0;
+    }
+
+    db_writer_lock();
+
+    if (sqlite3_exec(db, "BEGIN IMMEDIATE;", NULL, NULL, &err_msg) != SQLITE_OK) {
+        log_error("Failed to begin recording batch delete: %s", err_msg);
+        sqlite3_free(err_msg);
+        db_writer_unlock();
+        return -1;
+    }
+
+    // detections.recording_id has no ON DELETE CASCADE, see delete_recording_metadata()
+    sqlite3_stmt *clear_stmt = NULL;
+    sqlite3_stmt *delete_stmt = NULL;
+    if (sqlite3_prepare_v2(db, "UPDATE detections SET recording_id = NULL WHERE recording_id = ?;",
+                           -1, &clear_stmt, NULL) != SQLITE_OK ||
+        sqlite3_prepare_v2(db, "DELETE FROM recordings WHERE id = ?;",
+                           -1, &delete_stmt, NULL) != SQLITE_OK) {
+        log_error("Failed to prepare recording batch delete: %s", sqlite3_errmsg(db));
+        sqlite3_finalize(clear_stmt);
+        sqlite3_finalize(delete_stmt);
+        sqlite3_exec(db, "ROLLBACK;", NULL, NULL, NULL);
+        db_writer_unlock();
+        return -1;
+    }
+
+    int deleted = 0;
+    for (int i = 0; i < count; i++) {
+        sqlite3_bind_int64(clear_stmt, 1, (sqlite3_int64)ids[i]);
+        sqlite3_bind_int64(delete_stmt, 1, (sqlite3_int64)ids[i]);
+
+        if (sqlite3_step(clear_stmt) != SQLITE_DONE || sqlite3_step(delete_stmt) != SQLITE_DONE) {
+            log_error("Failed to delete metadata of recording %llu: %s",
+                      (unsigned long long)ids[i], sqlite3_errmsg(db));
+            sqlite3_finalize(clear_stmt);
+            sqlite3_finalize(delete_stmt);
+            sqlite3_exec(db, "ROLLBACK;", NULL, NULL, NULL);
+            db_writer_unlock();
+            return -1;
+        }
+        deleted += sqlite3_changes(db);
+
+        sqlite3_reset(clear_stmt);
+        sqlite3_reset(delete_stmt);
+    }
+
+    sqlite3_finalize(clear_stmt);
+    sqlite3_finalize(delete_stmt);
+
+    if (sqlite3_exec(db, "COMMIT;", NULL, NULL, &err_msg) != SQLITE_OK) {
+        log_error("Failed to commit recording batch delete: %s", err_msg);
+        sqlite3_free(err_msg);
+        sqlite3_exec(db, "ROLLBACK;", NULL, NULL, NULL);
+        db_writer_unlock();
+        return -1;
+    }
+
+    db_writer_unlock();
+    return deleted;
+}
+
 // Delete old recording metadata from the database
 int delete_old_recording_metadata(uint64_t max_age) {
     int rc;
@@ -1181,7 +1513,6 @@ int delete_old_recording_metadata(uint64_t max_age) {
     int deleted_count = 0;
 
     sqlite3 *db = get_db_handle();
-    pthread_mutex_t *db_mutex = get_db_mutex();
 
     if (!db) {
         log_error("Database not initialized");
@@ -1191,7 +1522,7 @@ int delete_old_recording_metadata(uint64_t max_age) {
     // Calculate cutoff time
     time_t cutoff_time = time(NULL) - (time_t)max_age;
 
-    pthread_mutex_lock(db_mutex);
+    db_writer_lock();
 
     // First, clear foreign key references in detections for recordings about to be deleted
     const char *clear_fk_sql = "UPDATE detections SET recording_id = NULL "
@@ -1199,7 +1530,7 @@ int delete_old_recording_metadata(uint64_t max_age) {
     rc = sqlite3_prepare_v2(db, clear_fk_sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
         log_error("Failed to prepare detections FK cleanup for old recordings: %s", sqlite3_errmsg(db));
-        pthread_mutex_unlock(db_mutex);
+        db_writer_unlock();
         return -1;
     }
     sqlite3_bind_int64(stmt, 1, (sqlite3_int64)cutoff_time);
@@ -1207,7 +1538,7 @@ int delete_old_recording_metadata(uint64_t max_age) {
     if (rc != SQLITE_DONE) {
         log_error("Failed to clear detections FK for old recordings: %s", sqlite3_errmsg(db));
         sqlite3_finalize(stmt);
-        pthread_mutex_unlock(db_mutex);
+        db_writer_unlock();
         return -1;
     }
     sqlite3_finalize(stmt);
@@ -1218,7 +1549,7 @@ int delete_old_recording_metadata(uint64_t max_age) {
     rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
         log_error("Failed to prepare statement: %s", sqlite3_errmsg(db));
-        pthread_mutex_unlock(db_mutex);
+        db_writer_unlock();
         return -1;
     }
 
@@ -1230,14 +1561,14 @@ int delete_old_recording_metadata(uint64_t max_age) {
     if (rc != SQLITE_DONE) {
         log_error("Failed to delete old recording metadata: %s", sqlite3_errmsg(db));
         sqlite3_finalize(stmt);
-        pthread_mutex_unlock(db_mutex);
+        db_writer_unlock();
         return -1;
     }
 
     deleted_count = sqlite3_changes(db);
 
     sqlite3_finalize(stmt);
-    pthread_mutex_unlock(db_mutex);
+    db_writer_unlock();
 
     return deleted_count;
 }
@@ -1254,21 +1585,20 @@ int set_recording_protected(uint64_t id, bool protected) {
     sqlite3_stmt *stmt;
 
     sqlite3 *db = get_db_handle();
-    pthread_mutex_t *db_mutex = get_db_mutex();
 
     if (!db) {
         log_error("Database not initialized");
         return -1;
     }
 
-    pthread_mutex_lock(db_mutex);
+    db_writer_lock();
 
     const char *sql = "UPDATE recordings SET protected = ? WHERE id = ?;";
 
     rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
         log_error("Failed to prepare statement: %s", sqlite3_errmsg(db));
-        pthread_mutex_unlock(db_mutex);
+        db_writer_unlock();
         return -1;
     }
 
@@ -1277,7 +1607,7 @@ int set_recording_protected(uint64_t id, bool protected) {
 
     rc = sqlite3_step(stmt);
     sqlite3_finalize(stmt);
-    pthread_mutex_unlock(db_mutex);
+    db_writer_unlock();
 
     if (rc != SQLITE_DONE) {
         log_error("Failed to update recording protection: %s", sqlite3_errmsg(db));
@@ -1300,21 +1630,20 @@ int set_recording_retention_override(uint64_t id, int days) {
     sqlite3_stmt *stmt;
 
     sqlite3 *db = get_db_handle();
-    pthread_mutex_t *db_mutex = get_db_mutex();
 
     if (!db) {
         log_error("Database not initialized");
         return -1;
     }
 
-    pthread_mutex_lock(db_mutex);
+    db_writer_lock();
 
     const char *sql = "UPDATE recordings SET retention_override_days = ? WHERE id = ?;";
 
     rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
         log_error("Failed to prepare statement: %s", sqlite3_errmsg(db));
-        pthread_mutex_unlock(db_mutex);
+        db_writer_unlock();
         return -1;
     }
 
@@ -1327,7 +1656,7 @@ int set_recording_retention_override(uint64_t id, int days) {
 
     rc = sqlite3_step(stmt);
     sqlite3_finalize(stmt);
-    pthread_mutex_unlock(db_mutex);
+    db_writer_unlock();
 
     if (rc != SQLITE_DONE) {
         log_error("Failed to update recording retention override: %s", sqlite3_errmsg(db));
@@ -1350,14 +1679,13 @@ int get_protected_recordings_count(const char *stream_name) {
     int count = -1;
 
     sqlite3 *db = get_db_handle();
-    pthread_mutex_t *db_mutex = get_db_mutex();
 
     if (!db) {
         log_error("Database not initialized");
         return -1;
     }
 
-    pthread_mutex_lock(db_mutex);
+    db_writer_lock();
 
     const char *sql;
     if (stream_name) {
@@ -1369,7 +1697,7 @@ int get_protected_recordings_count(const char *stream_name) {
     rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
         log_error("Failed to prepare statement: %s", sqlite3_errmsg(db));
-        pthread_mutex_unlock(db_mutex);
+        db_writer_unlock();
         return -1;
     }
 
@@ -1382,7 +1710,7 @@ int get_protected_recordings_count(const char *stream_name) {
     }
 
     sqlite3_finalize(stmt);
-    pthread_mutex_unlock(db_mutex);
+    db_writer_unlock();
 
     return count;
 }
@@ -1411,7 +1739,6 @@ int get_recordings_for_retention(const char *stream_name,
     int count = 0;
 
     sqlite3 *db = get_db_handle();
-    pthread_mutex_t *db_mutex = get_db_mutex();
 
     if (!db) {
         log_error("Database not initialized");
@@ -1428,7 +1755,7 @@ int get_recordings_for_retention(const char *stream_name,
     time_t regular_cutoff = (retention_days > 0) ? now - ((time_t)retention_days * 86400) : 0;
     time_t detection_cutoff = (detection_retention_days > 0) ? now - ((time_t)detection_retention_days * 86400) : 0;
 
-    pthread_mutex_lock(db_mutex);
+    db_writer_lock();
 
     // Query for recordings past retention, ordered by priority (regular first, then detection)
     // and by start_time (oldest first)
@@ -1458,7 +1785,7 @@ int get_recordings_for_retention(const char *stream_name,
     rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
         log_error("Failed to prepare statement: %s", sqlite3_errmsg(db));
-        pthread_mutex_unlock(db_mutex);
+        db_writer_unlock();
         return -1;
     }
 
@@ -1527,7 +1854,7 @@ int get_recordings_for_retention(const char *stream_name,
     }
 
     sqlite3_finalize(stmt);
-    pthread_mutex_unlock(db_mutex);
+    db_writer_unlock();
 
     return count;
 }
@@ -1552,7 +1879,6 @@ int get_recordings_for_quota_enforcement(const char *stream_name,
     int count = 0;
 
     sqlite3 *db = get_db_handle();
-    pthread_mutex_t *db_mutex = get_db_mutex();
 
     if (!db) {
         log_error("Database not initialized");
@@ -1564,7 +1890,7 @@ int get_recordings_for_quota_enforcement(const char *stream_name,
         return -1;
     }
 
-    pthread_mutex_lock(db_mutex);
+    db_writer_lock();
 
     // Get lower-priority unprotected recordings first.
     const char *sql =
@@ -1583,7 +1909,7 @@ int get_recordings_for_quota_enforcement(const char *stream_name,
     rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
         log_error("Failed to prepare statement: %s", sqlite3_errmsg(db));
-        pthread_mutex_unlock(db_mutex);
+        db_writer_unlock();
         return -1;
     }
 
@@ -1648,7 +1974,7 @@ int get_recordings_for_quota_enforcement(const char *stream_name,
     }
 
     sqlite3_finalize(stmt);
-    pthread_mutex_unlock(db_mutex);
+    db_writer_unlock();
 
     return count;
 }
@@ -1676,7 +2002,6 @@ int get_orphaned_db_entries(recording_metadata_t *recordings, int max_count,
     int count = 0;
 
     sqlite3 *db = get_db_handle();
-    pthread_mutex_t *db_mutex = get_db_mutex();
 
     if (!db) {
         log_error("Database not initialized");
@@ -1690,7 +2015,7 @@ int get_orphaned_db_entries(recording_metadata_t *recordings, int max_count,
 
     // Phase 1a: Get total count of eligible recordings (fast, index-only)
     int total_count = 0;
-    pthread_mutex_lock(db_mutex);
+    db_writer_lock();
 
     const char *count_sql =
         "SELECT COUNT(*) FROM recordings "
@@ -1699,7 +2024,7 @@ int get_orphaned_db_entries(recording_metadata_t *recordings, int max_count,
     rc = sqlite3_prepare_v2(db, count_sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
         log_error("Failed to prepare orphan count query: %s", sqlite3_errmsg(db));
-        pthread_mutex_unlock(db_mutex);
+        db_writer_unlock();
         return -1;
     }
     if (sqlite3_step(stmt) == SQLITE_ROW) {
@@ -1712,7 +2037,7 @@ int get_orphaned_db_entries(recording_metadata_t *recordings, int max_count,
     }
 
     if (total_count == 0) {
-        pthread_mutex_unlock(db_mutex);
+        db_writer_unlock();
         return 0;
     }
 
@@ -1730,7 +2055,7 @@ int get_orphaned_db_entries(recording_metadata_t *recordings, int max_count,
     rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
         log_error("Failed to prepare orphan candidate query: %s", sqlite3_errmsg(db));
-        pthread_mutex_unlock(db_mutex);
+        db_writer_unlock();
         return -1;
     }
 
@@ -1788,7 +2113,7 @@ int get_orphaned_db_entries(recording_metadata_t *recordings, int max_count,
     }
 
     sqlite3_finalize(stmt);
-    pthread_mutex_unlock(db_mutex);
+    db_writer_unlock();
     // --- db_mutex released: filesystem I/O below does not block DB writers ---
 
     // Phase 2: Check which candidates are orphaned (file missing on disk)
@@ -1823,7 +2148,6 @@ int get_recordings_for_tiered_retention(const char *stream_name,
     int count = 0;
 
     sqlite3 *db = get_db_handle();
-    pthread_mutex_t *db_mutex = get_db_mutex();
 
     if (!db) {
         log_error("Database not initialized");
@@ -1843,7 +2167,7 @@ int get_recordings_for_tiered_retention(const char *stream_name,
     time_t cutoff_standard = now - (time_t)(base_retention_days * tier_multipliers[RETENTION_TIER_STANDARD] * 86400);
     time_t cutoff_ephemeral = now - (time_t)(base_retention_days * tier_multipliers[RETENTION_TIER_EPHEMERAL] * 86400);
 
-    pthread_mutex_lock(db_mutex);
+    db_writer_lock();
 
     // Select recordings past their tier-specific retention cutoff
     // Order by tier descending (ephemeral=3 first) then oldest first
@@ -1888,7 +2212,7 @@ int get_recordings_for_tiered_retention(const char *stream_name,
     rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
         log_error("Failed to prepare tiered retention query: %s", sqlite3_errmsg(db));
-        pthread_mutex_unlock(db_mutex);
+        db_writer_unlock();
         return -1;
     }
 
@@ -1949,7 +2273,7 @@ int get_recordings_for_tiered_retention(const char *stream_name,
     }
 
     sqlite3_finalize(stmt);
-    pthread_mutex_unlock(db_mutex);
+    db_writer_unlock();
 
     log_info("Found %d recordings eligible for tiered retention cleanup", count);
     return count;
@@ -1969,7 +2293,6 @@ int get_recordings_for_pressure_cleanup(recording_metadata_t *recordings,
     int count = 0;
 
     sqlite3 *db = get_db_handle();
-    pthread_mutex_t *db_mutex = get_db_mutex();
 
     if (!db) {
         log_error("Database not initialized");
@@ -1981,7 +2304,7 @@ int get_recordings_for_pressure_cleanup(recording_metadata_t *recordings,
         return -1;
     }
 
-    pthread_mutex_lock(db_mutex);
+    db_writer_lock();
 
     const char *sql =
         "SELECT id, stream_name, file_path, start_time, end_time, "
@@ -2000,7 +2323,7 @@ int get_recordings_for_pressure_cleanup(recording_metadata_t *recordings,
     rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
         log_error("Failed to prepare pressure cleanup query: %s", sqlite3_errmsg(db));
-        pthread_mutex_unlock(db_mutex);
+        db_writer_unlock();
         return -1;
     }
 
@@ -2053,7 +2376,7 @@ int get_recordings_for_pressure_cleanup(recording_metadata_t *recordings,
     }
 
     sqlite3_finalize(stmt);
-    pthread_mutex_unlock(db_mutex);
+    db_writer_unlock();
 
     log_info("Found %d recordings eligible for disk pressure cleanup", count);
     return count;
@@ -2061,33 +2384,54 @@ int get_recordings_for_pressure_cleanup(recording_metadata_t *recordings,
 
 /**
  * Get total storage bytes used by a stream from the database.
+ *
+ * Reads the per-stream counters kept by the recordings triggers instead of
+ * summing the recordings table.
  */
 int64_t get_stream_storage_bytes(const char *stream_name) {
-    int rc;
-    sqlite3_stmt *stmt;
-    int64_t total_bytes = -1;
+    stream_storage_stats_t stats;
 
-    sqlite3 *db = get_db_handle();
-    pthread_mutex_t *db_mutex = get_db_mutex();
+    if (get_stream_storage_stats(stream_name, &stats) != 0) {
+        return -1;
+    }
 
-    if (!db) {
+    return stats.total_bytes;
+}
+
+int get_stream_storage_stats(const char *stream_name, stream_storage_stats_t *stats) {
+    if (!stats) {
+        log_error("Invalid parameters for get_stream_storage_stats");
+        return -1;
+    }
+
+    memset(stats, 0, sizeof(*stats));
+    if (stream_name) {
+        safe_strcpy(stats->stream_name, stream_name, sizeof(stats->stream_name), 0);
+    }
+
+    if (!get_db_handle()) {
         log_error("Database not initialized");
         return -1;
     }
 
-    pthread_mutex_lock(db_mutex);
+    sqlite3 *db = db_reader_acquire();
+    if (!db) {
+        log_error("No database connection available");
+        return -1;
+    }
 
     const char *sql;
     if (stream_name) {
-        sql = "SELECT COALESCE(SUM(size_bytes), 0) FROM recordings WHERE stream_name = ? AND is_complete = 1;";
+        sql = "SELECT recording_count, total_bytes FROM stream_storage_stats WHERE stream_name = ?;";
     } else {
-        sql = "SELECT COALESCE(SUM(size_bytes), 0) FROM recordings WHERE is_complete = 1;";
+        sql = "SELECT COALESCE(SUM(recording_count), 0), COALESCE(SUM(total_bytes), 0) "
+              "FROM stream_storage_stats;";
     }
 
-    rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
-    if (rc != SQLITE_OK) {
-        log_error("Failed to prepare storage bytes query: %s", sqlite3_errmsg(db));
-        pthread_mutex_unlock(db_mutex);
+    sqlite3_stmt *stmt = db_prepare_cached_on(db, sql);
+    if (!stmt) {
+        log_error("Failed to prepare storage stats query: %s", sqlite3_errmsg(db));
+        db_reader_release(db);
         return -1;
     }
 
@@ -2095,14 +2439,101 @@ int64_t get_stream_storage_bytes(const char *stream_name) {
         sqlite3_bind_text(stmt, 1, stream_name, -1, SQLITE_STATIC);
     }
 
-    if (sqlite3_step(stmt) == SQLITE_ROW) {
-        total_bytes = sqlite3_column_int64(stmt, 0);
+    int rc = sqlite3_step(stmt);
+    if (rc == SQLITE_ROW) {
+        stats->recording_count = sqlite3_column_int64(stmt, 0);
+        stats->total_bytes = sqlite3_column_int64(stmt, 1);
+    }
+
+    db_release_cached(stmt);
+    db_reader_release(db);
+
+    if (rc != SQLITE_ROW && rc != SQLITE_DONE) {
+        log_error("Failed to read storage stats: %s", sqlite3_errstr(rc));
+        return -1;
+    }
+
+    return 0;
+}
+
+int reconcile_stream_storage_stats(void) {
+    sqlite3 *db = get_db_handle();
+
+    if (!db) {
+        log_error("Database not initialized");
+        return -1;
     }
 
+    // Streams whose counters differ from the recordings table, in either direction
+    const char *drift_sql =
+        "SELECT a.stream_name, COALESCE(s.recording_count, 0), COALESCE(s.total_bytes, 0), "
+        "       a.recording_count, a.total_bytes "
+        "FROM (SELECT stream_name, SUM(end_time IS NOT NULL) AS recording_count, "
+        "             COALESCE(SUM(size_bytes), 0) AS total_bytes "
+        "      FROM recordings WHERE is_complete = 1 GROUP BY stream_name) a "
+        "LEFT JOIN stream_storage_stats s ON s.stream_name = a.stream_name "
+        "WHERE s.stream_name IS NULL OR s.recording_count != a.recording_count "
+        "   OR s.total_bytes != a.total_bytes "
+        "UNION ALL "
+        "SELECT s.stream_name, s.recording_count, s.total_bytes, 0, 0 "
+        "FROM stream_storage_stats s "
+        "WHERE (s.recording_count != 0 OR s.total_bytes != 0) "
+        "  AND NOT EXISTS (SELECT 1 FROM recordings r "
+        "                  WHERE r.stream_name = s.stream_name AND r.is_complete = 1);";
+
+    const char *rebuild_sql =
+        "DELETE FROM stream_storage_stats;"
+        "INSERT INTO stream_storage_stats (stream_name, recording_count, total_bytes) "
+        "SELECT stream_name, SUM(end_time IS NOT NULL), COALESCE(SUM(size_bytes), 0) "
+        "FROM recordings WHERE is_complete = 1 GROUP BY stream_name;";
+
+    db_writer_lock();
+
+    char *err_msg = NULL;
+    if (sqlite3_exec(db, "BEGIN IMMEDIATE;", NULL, NULL, &err_msg) != SQLITE_OK) {
+        log_error("Failed to begin storage stats reconciliation: %s", err_msg);
+        sqlite3_free(err_msg);
+        db_writer_unlock();
+        return -1;
+    }
+
+    sqlite3_stmt *stmt = NULL;
+    if (sqlite3_prepare_v2(db, drift_sql, -1, &stmt, NULL) != SQLITE_OK) {
+        log_error("Failed to prepare storage stats drift query: %s", sqlite3_errmsg(db));
+        sqlite3_exec(db, "ROLLBACK;", NULL, NULL, NULL);
+        db_writer_unlock();
+        return -1;
+    }
+
+    int drifted = 0;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        log_warn("Storage stats for stream %s drifted: %lld recordings / %lld bytes recorded, "
+                 "%lld / %lld actual",
+                 (const char *)sqlite3_column_text(stmt, 0),
+                 (long long)sqlite3_column_int64(stmt, 1), (long long)sqlite3_column_int64(stmt, 2),
+                 (long long)sqlite3_column_int64(stmt, 3), (long long)sqlite3_column_int64(stmt, 4));
+        drifted++;
+    }
     sqlite3_finalize(stmt);
-    pthread_mutex_unlock(db_mutex);
 
-    return total_bytes;
+    if (drifted > 0 && sqlite3_exec(db, rebuild_sql, NULL, NULL, &err_msg) != SQLITE_OK) {
+        log_error("Failed to rebuild storage stats: %s", err_msg);
+        sqlite3_free(err_msg);
+        sqlite3_exec(db, "ROLLBACK;", NULL, NULL, NULL);
+        db_writer_unlock();
+        return -1;
+    }
+
+    if (sqlite3_exec(db, "COMMIT;", NULL, NULL, &err_msg) != SQLITE_OK) {
+        log_error("Failed to commit storage stats reconciliation: %s", err_msg);
+        sqlite3_free(err_msg);
+        sqlite3_exec(db, "ROLLBACK;", NULL, NULL, NULL);
+        db_writer_unlock();
+        return -1;
+    }
+
+    db_writer_unlock();
+    return drifted;
 }
 
 /**
@@ -2113,7 +2544,6 @@ int set_recording_retention_tier(uint64_t id, int tier) {
     sqlite3_stmt *stmt;
 
     sqlite3 *db = get_db_handle();
-    pthread_mutex_t *db_mutex = get_db_mutex();
 
     if (!db) {
         log_error("Database not initialized");
@@ -2125,14 +2555,14 @@ int set_recording_retention_tier(uint64_t id, int tier) {
         return -1;
     }
 
-    pthread_mutex_lock(db_mutex);
+    db_writer_lock();
 
     const char *sql = "UPDATE recordings SET retention_tier = ? WHERE id = ?;";
 
     rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
         log_error("Failed to prepare statement: %s", sqlite3_errmsg(db));
-        pthread_mutex_unlock(db_mutex);
+        db_writer_unlock();
         return -1;
     }
 
@@ -2141,7 +2571,7 @@ int set_recording_retention_tier(uint64_t id, int tier) {
 
     rc = sqlite3_step(stmt);
     sqlite3_finalize(stmt);
-    pthread_mutex_unlock(db_mutex);
+    db_writer_unlock();
 
     if (rc != SQLITE_DONE) {
         log_error("Failed to set retention tier for recording %llu: %s",
@@ -2161,21 +2591,20 @@ int set_recording_disk_pressure_eligible(uint64_t id, bool eligible) {
     sqlite3_stmt *stmt;
 
     sqlite3 *db = get_db_handle();
-    pthread_mutex_t *db_mutex = get_db_mutex();
 
     if (!db) {
         log_error("Database not initialized");
         return -1;
     }
 
-    pthread_mutex_lock(db_mutex);
+    db_writer_lock();
 
     const char *sql = "UPDATE recordings SET disk_pressure_eligible = ? WHERE id = ?;";
 
     rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
         log_error("Failed to prepare statement: %s", sqlite3_errmsg(db));
-        pthread_mutex_unlock(db_mutex);
+        db_writer_unlock();
         return -1;
     }
 
@@ -2184,7 +2613,7 @@ int set_recording_disk_pressure_eligible(uint64_t id, bool eligible) {
 
     rc = sqlite3_step(stmt);
     sqlite3_finalize(stmt);
-    pthread_mutex_unlock(db_mutex);
+    db_writer_unlock();
 
     if (rc != SQLITE_DONE) {
         log_error("Failed to set disk pressure eligibility for recording %llu: %s",
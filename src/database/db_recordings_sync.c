@@ -102,14 +102,13 @@ static int sync_recordings_needing_size_update(void) {
     sqlite3_stmt *stmt = NULL;
 
     sqlite3 *db = get_db_handle();
-    pthread_mutex_t *db_mutex = get_db_mutex();
 
     if (!db) {
         log_error("Database not initialized for recording sync");
         return -1;
     }
 
-    pthread_mutex_lock(db_mutex);
+    db_writer_lock();
 
     // Query only recordings with size_bytes = 0 that were created since startup
     // This is much more efficient than fetching all 100k+ recordings
@@ -120,7 +119,7 @@ static int sync_recordings_needing_size_update(void) {
     rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
         log_error("Failed to prepare sync query: %s", sqlite3_errmsg(db));
-        pthread_mutex_unlock(db_mutex);
+        db_writer_unlock();
         return -1;
     }
 
@@ -169,7 +168,7 @@ static int sync_recordings_needing_size_update(void) {
     }
 
     sqlite3_finalize(stmt);
-    pthread_mutex_unlock(db_mutex);
+    db_writer_unlock();
 
     if (item_count > 0) {
         log_debug("Found %d recordings needing size sync", item_count);
@@ -0,0 +1,457 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "database/db_stream_cache.h"
+#include "core/logger.h"
+
+#define MAX_STREAM_CONFIG_LISTENERS 32
+
+// Immutable once published. Entries are shared with later snapshots until
+// they are replaced; an entry is freed together with the last snapshot that
+// referenced it.
+typedef struct {
+    int count;
+    stream_config_t *streams[MAX_STREAMS];      // Sorted by name
+} stream_snapshot_t;
+
+typedef struct {
+    uint32_t mask;
+    stream_config_listener_fn fn;
+    void *user_data;
+} stream_config_listener_t;
+
+typedef struct {
+    char name[MAX_STREAM_NAME];
+    const stream_config_t *old_config;
+    const stream_config_t *new_config;
+    uint32_t changed;
+} stream_config_change_t;
+
+static _Atomic(stream_snapshot_t *) current_snapshot = NULL;
+static atomic_uint_fast64_t cache_version = 0;
+
+// Readers count themselves in the slot of the epoch they started in; a
+// writer advances the epoch and waits for the previous slot to drain
+static atomic_uint_fast64_t read_epoch = 0;
+static atomic_int epoch_readers[2];
+
+static pthread_mutex_t publish_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t notify_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t listeners_mutex = PTHREAD_MUTEX_INITIALIZER;
+static stream_config_listener_t listeners[MAX_STREAM_CONFIG_LISTENERS];
+
+static const stream_snapshot_t *read_begin(int *slot) {
+    for (;;) {
+        uint_fast64_t epoch = atomic_load(&read_epoch);
+        *slot = (int)(epoch & 1);
+        atomic_fetch_add(&epoch_readers[*slot], 1);
+        if (atomic_load(&read_epoch) == epoch) {
+            return atomic_load(&current_snapshot);
+        }
+        atomic_fetch_sub(&epoch_readers[*slot], 1);
+    }
+}
+
+static void read_end(int slot) {
+    atomic_fetch_sub(&epoch_readers[slot], 1);
+}
+
+// Wait until no reader can still see a snapshot replaced before the call
+static void wait_for_readers(void) {
+    uint_fast64_t epoch = atomic_fetch_add(&read_epoch, 1);
+    atomic_int *readers = &epoch_readers[epoch & 1];
+    while (atomic_load(readers) > 0) {
+        sched_yield();
+    }
+}
+
+// Binary search by name; returns the index, or -(insertion point) - 1
+static int find_stream(const stream_snapshot_t *snap, const char *name) {
+    int lo = 0;
+    int hi = snap->count - 1;
+    while (lo <= hi) {
+        int mid = lo + (hi - lo) / 2;
+        int cmp = strcmp(snap->streams[mid]->name, name);
+        if (cmp == 0) {
+            return mid;
+        }
+        if (cmp < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    return -lo - 1;
+}
+
+static int compare_stream_names(const void *a, const void *b) {
+    const stream_config_t *const *x = a;
+    const stream_config_t *const *y = b;
+    return strcmp((*x)->name, (*y)->name);
+}
+
+// Deliver changes to the listeners. Called with notify_mutex held so
+// notifications arrive in publish order and unsubscribe can wait for them.
+static void notify_listeners(const stream_config_change_t *changes, int count) {
+    stream_config_listener_t active[MAX_STREAM_CONFIG_LISTENERS];
+
+    pthread_mutex_lock(&listeners_mutex);
+    memcpy(active, listeners, sizeof(active));
+    pthread_mutex_unlock(&listeners_mutex);
+
+    for (int i = 0; i < count; i++) {
+        for (int j = 0; j < MAX_STREAM_CONFIG_LISTENERS; j++) {
+            if (active[j].fn && (active[j].mask & changes[i].changed)) {
+                active[j].fn(changes[i].name, changes[i].old_config, changes[i].new_config,
+                             changes[i].changed, active[j].user_data);
+            }
+        }
+    }
+}
+
+#define STR_CHANGED(f) (strcmp(a->f, b->f) != 0)
+#define VAL_CHANGED(f) (a->f != b->f)
+
+uint32_t stream_config_diff(const stream_config_t *a, const stream_config_t *b) {
+    if (!a && !b) {
+        return 0;
+    }
+    if (!a) {
+        return STREAM_CONFIG_CHANGED_ADDED;
+    }
+    if (!b) {
+        return STREAM_CONFIG_CHANGED_REMOVED;
+    }
+
+    uint32_t changed = 0;
+
+    if (VAL_CHANGED(enabled) || VAL_CHANGED(streaming_enabled) || VAL_CHANGED(privacy_mode)) {
+        changed |= STREAM_CONFIG_CHANGED_STATE;
+    }
+    if (STR_CHANGED(url) || STR_CHANGED(sub_stream_url) || STR_CHANGED(go2rtc_source_override) ||
+        VAL_CHANGED(protocol) || VAL_CHANGED(is_onvif) || VAL_CHANGED(onvif_port) ||
+        STR_CHANGED(onvif_username) || STR_CHANGED(onvif_password) || STR_CHANGED(onvif_profile) ||
+        VAL_CHANGED(onvif_discovery_enabled) || VAL_CHANGED(backchannel_enabled)) {
+        changed |= STREAM_CONFIG_CHANGED_SOURCE;
+    }
+    if (VAL_CHANGED(width) || VAL_CHANGED(height) || VAL_CHANGED(fps) || STR_CHANGED(codec)) {
+        changed |= STREAM_CONFIG_CHANGED_VIDEO;
+    }
+    if (VAL_CHANGED(record) || VAL_CHANGED(segment_duration) || VAL_CHANGED(record_audio) ||
+        VAL_CHANGED(record_on_schedule) ||
+        memcmp(a->recording_schedule, b->recording_schedule, sizeof(a->recording_schedule)) != 0 ||
+        STR_CHANGED(motion_trigger_source)) {
+        changed |= STREAM_CONFIG_CHANGED_RECORDING;
+    }
+    if (VAL_CHANGED(detection_based_recording) || STR_CHANGED(detection_model) ||
+        VAL_CHANGED(detection_interval) || VAL_CHANGED(detection_threshold) ||
+        VAL_CHANGED(pre_detection_buffer) || VAL_CHANGED(post_detection_buffer) ||
+        STR_CHANGED(detection_api_url) || STR_CHANGED(detection_object_filter) ||
+        STR_CHANGED(detection_object_filter_list) || STR_CHANGED(buffer_strategy)) {
+        changed |= STREAM_CONFIG_CHANGED_DETECTION;
+    }
+    if (VAL_CHANGED(retention_days) || VAL_CHANGED(detection_retention_days) ||
+        VAL_CHANGED(max_storage_mb) || VAL_CHANGED(tier_critical_multiplier) ||
+        VAL_CHANGED(tier_important_multiplier) || VAL_CHANGED(tier_ephemeral_multiplier) ||
+        VAL_CHANGED(storage_priority)) {
+        changed |= STREAM_CONFIG_CHANGED_RETENTION;
+    }
+    if (VAL_CHANGED(ptz_enabled) || VAL_CHANGED(ptz_max_x) || VAL_CHANGED(ptz_max_y) ||
+        VAL_CHANGED(ptz_max_z) || VAL_CHANGED(ptz_has_home)) {
+        changed |= STREAM_CONFIG_CHANGED_PTZ;
+    }
+    if (STR_CHANGED(tags) || STR_CHANGED(admin_url) || VAL_CHANGED(priority)) {
+        changed |= STREAM_CONFIG_CHANGED_OTHER;
+    }
+
+    return changed;
+}
+
+#undef STR_CHANGED
+#undef VAL_CHANGED
+
+int stream_config_cache_load(const stream_config_t *streams, int count) {
+    if ((!streams && count > 0) || count < 0 || count > MAX_STREAMS) {
+        log_error("Invalid parameters for stream_config_cache_load");
+        return -1;
+    }
+
+    stream_snapshot_t *snap = calloc(1, sizeof(stream_snapshot_t));
+    stream_config_change_t *changes = calloc(MAX_STREAMS * 2, sizeof(stream_config_change_t));
+    if (!snap || !changes) {
+        log_error("Out of memory loading stream configuration cache");
+        free(snap);
+        free(changes);
+        return -1;
+    }
+
+    for (int i = 0; i < count; i++) {
+        snap->streams[i] = malloc(sizeof(stream_config_t));
+        if (!snap->streams[i]) {
+            log_error("Out of memory loading stream configuration cache");
+            for (int j = 0; j < i; j++) {
+                free(snap->streams[j]);
+            }
+            free(snap);
+            free(changes);
+            return -1;
+        }
+        memcpy(snap->streams[i], &streams[i], sizeof(stream_config_t));
+    }
+    snap->count = count;
+    qsort(snap->streams, (size_t)count, sizeof(snap->streams[0]), compare_stream_names);
+
+    pthread_mutex_lock(&publish_mutex);
+    stream_snapshot_t *old = atomic_exchange(&current_snapshot, snap);
+    atomic_fetch_add(&cache_version, 1);
+    wait_for_readers();
+
+    // Work out what changed against the previous contents
+    int change_count = 0;
+    for (int i = 0; i < snap->count; i++) {
+        const stream_config_t *before = NULL;
+        if (old) {
+            int idx = find_stream(old, snap->streams[i]->name);
+            before = idx >= 0 ? old->streams[idx] : NULL;
+        }
+        uint32_t changed = stream_config_diff(before, snap->streams[i]);
+        if (changed) {
+            stream_config_change_t *c = &changes[change_count++];
+            memcpy(c->name, snap->streams[i]->name, sizeof(c->name));
+            c->old_config = before;
+            c->new_config = snap->streams[i];
+            c->changed = changed;
+        }
+    }
+    for (int i = 0; old && i < old->count; i++) {
+        if (find_stream(snap, old->streams[i]->name) < 0) {
+            stream_config_change_t *c = &changes[change_count++];
+            memcpy(c->name, old->streams[i]->name, sizeof(c->name));
+            c->old_config = old->streams[i];
+            c->changed = STREAM_CONFIG_CHANGED_REMOVED;
+        }
+    }
+
+    pthread_mutex_lock(&notify_mutex);
+    pthread_mutex_unlock(&publish_mutex);
+    notify_listeners(changes, change_count);
+    pthread_mutex_unlock(&notify_mutex);
+
+    if (old) {
+        for (int i = 0; i < old->count; i++) {
+            free(old->streams[i]);
+        }
+        free(old);
+    }
+    free(changes);
+
+    log_info("Loaded %d stream configurations into the configuration cache", count);
+    return 0;
+}
+
+void stream_config_cache_clear(void) {
+    pthread_mutex_lock(&publish_mutex);
+    stream_snapshot_t *old = atomic_exchange(&current_snapshot, NULL);
+    atomic_store(&cache_version, 0);
+    wait_for_readers();
+    pthread_mutex_unlock(&publish_mutex);
+
+    if (old) {
+        for (int i = 0; i < old->count; i++) {
+            free(old->streams[i]);
+        }
+        free(old);
+    }
+}
+
+bool stream_config_cache_loaded(void) {
+    return atomic_load(&current_snapshot) != NULL;
+}
+
+int stream_config_cache_publish(const char *name, const stream_config_t *config) {
+    if (!name || !name[0]) {
+        return -1;
+    }
+
+    stream_config_t *entry = NULL;
+    if (config) {
+        entry = malloc(sizeof(stream_config_t));
+        if (!entry) {
+            log_error("Out of memory publishing configuration of stream %s", name);
+            return -1;
+        }
+        memcpy(entry, config, sizeof(stream_config_t));
+    }
+
+    pthread_mutex_lock(&publish_mutex);
+
+    stream_snapshot_t *old = atomic_load(&current_snapshot);
+    if (!old) {
+        pthread_mutex_unlock(&publish_mutex);
+        free(entry);
+        return -1;
+    }
+
+    int idx = find_stream(old, name);
+    const stream_config_t *before = idx >= 0 ? old->streams[idx] : NULL;
+    uint32_t changed = stream_config_diff(before, entry);
+    if (changed == 0) {
+        pthread_mutex_unlock(&publish_mutex);
+        free(entry);
+        return 0;
+    }
+
+    if (!before && old->count >= MAX_STREAMS) {
+        log_error("Stream configuration cache is full, cannot add stream %s", name);
+        pthread_mutex_unlock(&publish_mutex);
+        free(entry);
+        return -1;
+    }
+
+    stream_snapshot_t *snap = malloc(sizeof(stream_snapshot_t));
+    if (!snap) {
+        log_error("Out of memory publishing configuration of stream %s", name);
+        pthread_mutex_unlock(&publish_mutex);
+        free(entry);
+        return -1;
+    }
+
+    // Copy the entry pointers, replacing, inserting or dropping one
+    if (before && entry) {
+        memcpy(snap->streams, old->streams, (size_t)old->count * sizeof(old->streams[0]));
+        snap->streams[idx] = entry;
+        snap->count = old->count;
+    } else if (entry) {
+        int at = -idx - 1;
+        memcpy(snap->streams, old->streams, (size_t)at * sizeof(old->streams[0]));
+        snap->streams[at] = entry;
+        memcpy(&snap->streams[at + 1], &old->streams[at], (size_t)(old->count - at) * sizeof(old->streams[0]));
+        snap->count = old->count + 1;
+    } else {
+        memcpy(snap->streams, old->streams, (size_t)idx * sizeof(old->streams[0]));
+        memcpy(&snap->streams[idx], &old->streams[idx + 1], (size_t)(old->count - idx - 1) * sizeof(old->streams[0]));
+        snap->count = old->count - 1;
+    }
+
+    atomic_store(&current_snapshot, snap);
+    atomic_fetch_add(&cache_version, 1);
+    wait_for_readers();
+    free(old);
+
+    stream_config_change_t change;
+    memset(&change, 0, sizeof(change));
+    strncpy(change.name, name, sizeof(change.name) - 1);
+    change.old_config = before;
+    change.new_config = entry;
+    change.changed = changed;
+
+    pthread_mutex_lock(&notify_mutex);
+    pthread_mutex_unlock(&publish_mutex);
+    notify_listeners(&change, 1);
+    pthread_mutex_unlock(&notify_mutex);
+
+    // No snapshot references the replaced entry any more
+    free((void *)before);
+    return 0;
+}
+
+int stream_config_cache_get(const char *name, stream_config_t *config) {
+    if (!name || !config) {
+        return -1;
+    }
+
+    int slot;
+    const stream_snapshot_t *snap = read_begin(&slot);
+    int idx = snap ? find_stream(snap, name) : -1;
+    if (idx >= 0) {
+        memcpy(config, snap->streams[idx], sizeof(stream_config_t));
+    }
+    read_end(slot);
+
+    return idx >= 0 ? 0 : -1;
+}
+
+int stream_config_cache_read(const char *name, stream_config_reader_fn fn, void *user_data) {
+    if (!name || !fn) {
+        return -1;
+    }
+
+    int slot;
+    const stream_snapshot_t *snap = read_begin(&slot);
+    int idx = snap ? find_stream(snap, name) : -1;
+    if (idx >= 0) {
+        fn(snap->streams[idx], user_data);
+    }
+    read_end(slot);
+
+    return idx >= 0 ? 0 : -1;
+}
+
+int stream_config_cache_get_all(stream_config_t *streams, int max_count) {
+    if (!streams || max_count <= 0) {
+        return 0;
+    }
+
+    int slot;
+    const stream_snapshot_t *snap = read_begin(&slot);
+    int count = 0;
+    if (snap) {
+        count = snap->count < max_count ? snap->count : max_count;
+        for (int i = 0; i < count; i++) {
+            memcpy(&streams[i], snap->streams[i], sizeof(stream_config_t));
+        }
+    }
+    read_end(slot);
+
+    return count;
+}
+
+int stream_config_cache_count(void) {
+    int slot;
+    const stream_snapshot_t *snap = read_begin(&slot);
+    int count = snap ? snap->count : 0;
+    read_end(slot);
+    return count;
+}
+
+uint64_t stream_config_cache_version(void) {
+    return (uint64_t)atomic_load(&cache_version);
+}
+
+int stream_config_subscribe(uint32_t mask, stream_config_listener_fn fn, void *user_data) {
+    if (!fn) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&listeners_mutex);
+    for (int i = 0; i < MAX_STREAM_CONFIG_LISTENERS; i++) {
+        if (!listeners[i].fn) {
+            listeners[i].mask = mask;
+            listeners[i].fn = fn;
+            listeners[i].user_data = user_data;
+            pthread_mutex_unlock(&listeners_mutex);
+            return i + 1;
+        }
+    }
+    pthread_mutex_unlock(&listeners_mutex);
+
+    log_error("No free stream configuration listener slot");
+    return -1;
+}
+
+void stream_config_unsubscribe(int id) {
+    if (id <= 0 || id > MAX_STREAM_CONFIG_LISTENERS) {
+        return;
+    }
+
+    pthread_mutex_lock(&notify_mutex);
+    pthread_mutex_lock(&listeners_mutex);
+    memset(&listeners[id - 1], 0, sizeof(listeners[0]));
+    pthread_mutex_unlock(&listeners_mutex);
+    pthread_mutex_unlock(&notify_mutex);
+}
@@ -8,15 +8,22 @@
 #include <time.h>
 #include <sqlite3.h>
 #include <stdbool.h>
+#include <pthread.h>
 
 #include "database/db_streams.h"
 #include "database/db_core.h"
+#include "database/db_recordings.h"
 #include "database/db_schema.h"
 #include "database/db_schema_cache.h"
+#include "database/db_stream_cache.h"
 #include "core/logger.h"
 #include "core/config.h"
 #include "utils/strings.h"
 
+// Writers republish after releasing the writer lock; holding this across the
+// re-read and the publish keeps the last publish in step with the last commit
+static pthread_mutex_t reload_mutex = PTHREAD_MUTEX_INITIALIZER;
+
 /**
  * Serialize recording_schedule uint8_t[168] to comma-separated text string.
  * Output: "1,0,1,1,..." (168 values)
@@ -75,7 +82,6 @@ uint64_t add_stream_config(const stream_config_t *stream) {
     uint64_t stream_id = 0;
 
     sqlite3 *db = get_db_handle();
-    pthread_mutex_t *db_mutex = get_db_mutex();
 
     if (!db) {
         log_error("Database not initialized");
@@ -95,7 +101,7 @@ uint64_t add_stream_config(const stream_config_t *stream) {
         return 0;
     }
 
-    pthread_mutex_lock(db_mutex);
+    db_writer_lock();
 
     // Check if a stream with this name already exists but is disabled
     const char *check_sql = "SELECT id FROM streams WHERE name = ? AND enabled = 0;";
@@ -104,7 +110,7 @@ uint64_t add_stream_config(const stream_config_t *stream) {
     rc = sqlite3_prepare_v2(db, check_sql, -1, &check_stmt, NULL);
     if (rc != SQLITE_OK) {
         log_error("Failed to prepare statement to check for disabled stream: %s", sqlite3_errmsg(db));
-        pthread_mutex_unlock(db_mutex);
+        db_writer_unlock();
         return 0;
     }
 
@@ -139,7 +145,7 @@ uint64_t add_stream_config(const stream_config_t *stream) {
         rc = sqlite3_prepare_v2(db, update_sql, -1, &stmt, NULL);
         if (rc != SQLITE_OK) {
             log_error("Failed to prepare statement to update disabled stream: %s", sqlite3_errmsg(db));
-            pthread_mutex_unlock(db_mutex);
+            db_writer_unlock();
             return 0;
         }
 
@@ -231,7 +237,7 @@ uint64_t add_stream_config(const stream_config_t *stream) {
                 sqlite3_finalize(stmt);
                 stmt = NULL;
             }
-            pthread_mutex_unlock(db_mutex);
+            db_writer_unlock();
             return 0;
         }
 
@@ -247,7 +253,8 @@ uint64_t add_stream_config(const stream_config_t *stream) {
                 stream->detection_based_recording ? "true" : "false",
                 stream->detection_model);
 
-        pthread_mutex_unlock(db_mutex);
+        db_writer_unlock();
+        reload_stream_config(stream->name);
         return existing_id;
     }
 
@@ -274,7 +281,7 @@ uint64_t add_stream_config(const stream_config_t *stream) {
     rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
         log_error("Failed to prepare statement: %s", sqlite3_errmsg(db));
-        pthread_mutex_unlock(db_mutex);
+        db_writer_unlock();
         return 0;
     }
 
@@ -376,7 +383,11 @@ uint64_t add_stream_config(const stream_config_t *stream) {
         sqlite3_finalize(stmt);
         stmt = NULL;
     }
-    pthread_mutex_unlock(db_mutex);
+    db_writer_unlock();
+
+    if (stream_id != 0) {
+        reload_stream_config(stream->name);
+    }
 
     return stream_id;
 }
@@ -393,7 +404,6 @@ int update_stream_config(const char *name, const stream_config_t *stream) {
     sqlite3_stmt *stmt;
 
     sqlite3 *db = get_db_handle();
-    pthread_mutex_t *db_mutex = get_db_mutex();
 
     if (!db) {
         log_error("Database not initialized");
@@ -405,7 +415,7 @@ int update_stream_config(const char *name, const stream_config_t *stream) {
         return -1;
     }
 
-    pthread_mutex_lock(db_mutex);
+    db_writer_lock();
 
     // Schema migrations should have already been run during database initialization
     // No need to check for columns here anymore
@@ -430,7 +440,7 @@ int update_stream_config(const char *name, const stream_config_t *stream) {
     rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
         log_error("Failed to prepare statement: %s", sqlite3_errmsg(db));
-        pthread_mutex_unlock(db_mutex);
+        db_writer_unlock();
         return -1;
     }
 
@@ -523,7 +533,7 @@ int update_stream_config(const char *name, const stream_config_t *stream) {
             sqlite3_finalize(stmt);
             stmt = NULL;
         }
-        pthread_mutex_unlock(db_mutex);
+        db_writer_unlock();
         return -1;
     }
 
@@ -540,7 +550,13 @@ int update_stream_config(const char *name, const stream_config_t *stream) {
              stream->detection_based_recording ? "true" : "false",
              stream->detection_model);
 
-    pthread_mutex_unlock(db_mutex);
+    db_writer_unlock();
+
+    // A rename moves the configuration to a new key
+    if (strcmp(name, stream->name) != 0) {
+        reload_stream_config(name);
+    }
+    reload_stream_config(stream->name);
 
     return 0;
 }
@@ -558,7 +574,6 @@ int update_stream_video_params(const char *stream_name, int width, int height, i
     sqlite3_stmt *stmt;
 
     sqlite3 *db = get_db_handle();
-    pthread_mutex_t *db_mutex = get_db_mutex();
 
     if (!db) {
         log_error("Database not initialized");
@@ -570,7 +585,7 @@ int update_stream_video_params(const char *stream_name, int width, int height, i
         return -1;
     }
 
-    pthread_mutex_lock(db_mutex);
+    db_writer_lock();
 
     // First, read the current values so we can log meaningful changes
     int old_width = 0, old_height = 0, old_fps = 0;
@@ -600,7 +615,7 @@ int update_stream_video_params(const char *stream_name, int width, int height, i
         same = (strcmp(old_codec, codec) == 0);
     }
     if (same) {
-        pthread_mutex_unlock(db_mutex);
+        db_writer_unlock();
         return 0;   // nothing to do
     }
 
@@ -616,7 +631,7 @@ int update_stream_video_params(const char *stream_name, int width, int height, i
     rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
         log_error("Failed to prepare video params update: %s", sqlite3_errmsg(db));
-        pthread_mutex_unlock(db_mutex);
+        db_writer_unlock();
         return -1;
     }
 
@@ -630,13 +645,13 @@ int update_stream_video_params(const char *stream_name, int width, int height, i
     if (rc != SQLITE_DONE) {
         log_error("Failed to update video params for stream %s: %s", stream_name, sqlite3_errmsg(db));
         sqlite3_finalize(stmt);
-        pthread_mutex_unlock(db_mutex);
+        db_writer_unlock();
         return -1;
     }
 
     int changes = sqlite3_changes(db);
     sqlite3_finalize(stmt);
-    pthread_mutex_unlock(db_mutex);
+    db_writer_unlock();
 
     if (changes > 0) {
         if (old_width != width || old_height != height) {
@@ -649,6 +664,7 @@ int update_stream_video_params(const char *stream_name, int width, int height, i
             log_info("Auto-detected video params for stream %s: %dx%d @ %d fps, codec=%s",
                      stream_name, width, height, fps, codec ? codec : "unknown");
         }
+        reload_stream_config(stream_name);
     }
 
     return 0;
@@ -676,7 +692,6 @@ int delete_stream_config_internal(const char *name, bool permanent) {
     sqlite3_stmt *stmt;
 
     sqlite3 *db = get_db_handle();
-    pthread_mutex_t *db_mutex = get_db_mutex();
 
     if (!db) {
         log_error("Database not initialized");
@@ -688,7 +703,7 @@ int delete_stream_config_internal(const char *name, bool permanent) {
         return -1;
     }
 
-    pthread_mutex_lock(db_mutex);
+    db_writer_lock();
 
     const char *sql;
     if (permanent) {
@@ -704,7 +719,7 @@ int delete_stream_config_internal(const char *name, bool permanent) {
     rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
         log_error("Failed to prepare statement: %s", sqlite3_errmsg(db));
-        pthread_mutex_unlock(db_mutex);
+        db_writer_unlock();
         return -1;
     }
 
@@ -723,7 +738,7 @@ int delete_stream_config_internal(const char *name, bool permanent) {
             sqlite3_finalize(stmt);
             stmt = NULL;
         }
-        pthread_mutex_unlock(db_mutex);
+        db_writer_unlock();
         return -1;
     }
 
@@ -739,25 +754,26 @@ int delete_stream_config_internal(const char *name, bool permanent) {
         log_info("Disabled stream configuration: %s", name);
     }
 
-    pthread_mutex_unlock(db_mutex);
+    db_writer_unlock();
+
+    reload_stream_config(name);
 
     return 0;
 }
 
 /**
- * Get a stream configuration from the database
+ * Read a stream configuration from the database, bypassing the cache
  *
  * @param name Stream name to get
  * @param stream Stream configuration to fill
  * @return 0 on success, non-zero on failure
  */
-int get_stream_config_by_name(const char *name, stream_config_t *stream) {
+static int read_stream_config(const char *name, stream_config_t *stream) {
     int rc;
     sqlite3_stmt *stmt;
     int result = -1;
 
     sqlite3 *db = get_db_handle();
-    pthread_mutex_t *db_mutex = get_db_mutex();
 
     if (!db) {
         log_error("Database not initialized");
@@ -769,7 +785,7 @@ int get_stream_config_by_name(const char *name, stream_config_t *stream) {
         return -1;
     }
 
-    pthread_mutex_lock(db_mutex);
+    db_writer_lock();
 
     // After migrations, all columns are guaranteed to exist
     // Use a single query with all columns - column indices are fixed
@@ -806,7 +822,7 @@ int get_stream_config_by_name(const char *name, stream_config_t *stream) {
     rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
         log_error("Failed to prepare statement: %s", sqlite3_errmsg(db));
-        pthread_mutex_unlock(db_mutex);
+        db_writer_unlock();
         return -1;
     }
 
@@ -985,25 +1001,44 @@ int get_stream_config_by_name(const char *name, stream_config_t *stream) {
         sqlite3_finalize(stmt);
         stmt = NULL;
     }
-    pthread_mutex_unlock(db_mutex);
+    db_writer_unlock();
 
     return result;
 }
 
 /**
- * Get all stream configurations from the database
+ * Get a stream configuration, from the cache once it is loaded
+ *
+ * @param name Stream name to get
+ * @param stream Stream configuration to fill
+ * @return 0 on success, non-zero on failure
+ */
+int get_stream_config_by_name(const char *name, stream_config_t *stream) {
+    if (!name || !stream) {
+        log_error("Stream name and configuration pointer are required");
+        return -1;
+    }
+
+    if (stream_config_cache_loaded()) {
+        return stream_config_cache_get(name, stream);
+    }
+
+    return read_stream_config(name, stream);
+}
+
+/**
+ * Read all stream configurations from the database, bypassing the cache
  *
  * @param streams Array to fill with stream configurations
  * @param max_count Maximum number of streams to return
  * @return Number of streams found, or -1 on error
  */
-int get_all_stream_configs(stream_config_t *streams, int max_count) {
+static int read_all_stream_configs(stream_config_t *streams, int max_count) {
     int rc;
     sqlite3_stmt *stmt;
     int count = 0;
 
     sqlite3 *db = get_db_handle();
-    pthread_mutex_t *db_mutex = get_db_mutex();
 
     if (!db) {
         log_error("Database not initialized");
@@ -1015,7 +1050,7 @@ int get_all_stream_configs(stream_config_t *streams, int max_count) {
         return -1;
     }
 
-    pthread_mutex_lock(db_mutex);
+    db_writer_lock();
 
     // After migrations, all columns are guaranteed to exist
     const char *sql =
@@ -1051,7 +1086,7 @@ int get_all_stream_configs(stream_config_t *streams, int max_count) {
     rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
         log_error("Failed to prepare statement: %s", sqlite3_errmsg(db));
-        pthread_mutex_unlock(db_mutex);
+        db_writer_unlock();
         return -1;
     }
 
@@ -1229,7 +1264,7 @@ int get_all_stream_configs(stream_config_t *streams, int max_count) {
         sqlite3_finalize(stmt);
         stmt = NULL;
     }
-    pthread_mutex_unlock(db_mutex);
+    db_writer_unlock();
 
     return count;
 }
@@ -1246,7 +1281,6 @@ int is_stream_eligible_for_live_streaming(const char *stream_name) {
     int result = -1;
 
     sqlite3 *db = get_db_handle();
-    pthread_mutex_t *db_mutex = get_db_mutex();
 
     if (!db) {
         log_error("Database not initialized");
@@ -1258,14 +1292,14 @@ int is_stream_eligible_for_live_streaming(const char *stream_name) {
         return -1;
     }
 
-    pthread_mutex_lock(db_mutex);
+    db_writer_lock();
 
     const char *sql = "SELECT enabled, streaming_enabled, privacy_mode FROM streams WHERE name = ?;";
 
     rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
         log_error("Failed to prepare statement: %s", sqlite3_errmsg(db));
-        pthread_mutex_unlock(db_mutex);
+        db_writer_unlock();
         return -1;
     }
 
@@ -1297,7 +1331,7 @@ int is_stream_eligible_for_live_streaming(const char *stream_name) {
         sqlite3_finalize(stmt);
         stmt = NULL;
     }
-    pthread_mutex_unlock(db_mutex);
+    db_writer_unlock();
 
     return result;
 }
@@ -1313,21 +1347,20 @@ int get_enabled_stream_count(void) {
     int count = -1;
 
     sqlite3 *db = get_db_handle();
-    pthread_mutex_t *db_mutex = get_db_mutex();
 
     if (!db) {
         log_error("Database not initialized");
         return -1;
     }
 
-    pthread_mutex_lock(db_mutex);
+    db_writer_lock();
 
     const char *sql = "SELECT COUNT(*) FROM streams WHERE enabled = 1;";
 
     rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
         log_error("Failed to prepare statement: %s", sqlite3_errmsg(db));
-        pthread_mutex_unlock(db_mutex);
+        db_writer_unlock();
         return -1;
     }
 
@@ -1337,13 +1370,87 @@ int get_enabled_stream_count(void) {
 
     // finalize the prepared statement
     sqlite3_finalize(stmt);
-    pthread_mutex_unlock(db_mutex);
+    db_writer_unlock();
 
     return count;
 }
 
 /**
- * Count the number of stream configurations in the database
+ * Get all stream configurations, from the cache once it is loaded
+ *
+ * @param streams Array to fill with stream configurations
+ * @param max_count Maximum number of streams to return
+ * @return Number of streams found, or -1 on error
+ */
+int get_all_stream_configs(stream_config_t *streams, int max_count) {
+    if (!streams || max_count <= 0) {
+        log_error("Invalid parameters for get_all_stream_configs");
+        return -1;
+    }
+
+    if (stream_config_cache_loaded()) {
+        return stream_config_cache_get_all(streams, max_count);
+    }
+
+    return read_all_stream_configs(streams, max_count);
+}
+
+/**
+ * Load every stream configuration into the configuration cache
+ *
+ * @return 0 on success, -1 on error
+ */
+int load_stream_config_cache(void) {
+    stream_config_t *streams = calloc(MAX_STREAMS, sizeof(stream_config_t));
+    if (!streams) {
+        log_error("Failed to allocate memory for the stream configuration cache");
+        return -1;
+    }
+
+    pthread_mutex_lock(&reload_mutex);
+    int count = read_all_stream_configs(streams, MAX_STREAMS);
+    int result = -1;
+    if (count >= 0) {
+        result = stream_config_cache_load(streams, count);
+    }
+    pthread_mutex_unlock(&reload_mutex);
+
+    free(streams);
+    return result;
+}
+
+/**
+ * Re-read one stream configuration into the configuration cache
+ *
+ * @param name Stream name
+ * @return 0 on success, -1 on error
+ */
+int reload_stream_config(const char *name) {
+    if (!name || !stream_config_cache_loaded()) {
+        return 0;
+    }
+
+    stream_config_t *stream = malloc(sizeof(stream_config_t));
+    if (!stream) {
+        log_error("Failed to allocate memory to reload stream %s", name);
+        return -1;
+    }
+
+    pthread_mutex_lock(&reload_mutex);
+    int result;
+    if (read_stream_config(name, stream) == 0) {
+        result = stream_config_cache_publish(name, stream);
+    } else {
+        result = stream_config_cache_publish(name, NULL);
+    }
+    pthread_mutex_unlock(&reload_mutex);
+
+    free(stream);
+    return result;
+}
+
+/**
+ * Count the number of stream configurations
  *
  * @return Number of streams, or -1 on error
  */
@@ -1353,21 +1460,24 @@ int count_stream_configs(void) {
     int count = -1;
 
     sqlite3 *db = get_db_handle();
-    pthread_mutex_t *db_mutex = get_db_mutex();
 
     if (!db) {
         log_error("Database not initialized");
         return -1;
     }
 
-    pthread_mutex_lock(db_mutex);
+    if (stream_config_cache_loaded()) {
+        return stream_config_cache_count();
+    }
+
+    db_writer_lock();
 
     const char *sql = "SELECT COUNT(*) FROM streams;";
 
     rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
         log_error("Failed to prepare statement: %s", sqlite3_errmsg(db));
-        pthread_mutex_unlock(db_mutex);
+        db_writer_unlock();
         return -1;
     }
 
@@ -1377,7 +1487,7 @@ int count_stream_configs(void) {
 
     // finalize the prepared statement
     sqlite3_finalize(stmt);
-    pthread_mutex_unlock(db_mutex);
+    db_writer_unlock();
 
     return count;
 }
@@ -1395,7 +1505,6 @@ int get_stream_retention_config(const char *stream_name, stream_retention_config
     int result = -1;
 
     sqlite3 *db = get_db_handle();
-    pthread_mutex_t *db_mutex = get_db_mutex();
 
     if (!db) {
         log_error("Database not initialized");
@@ -1412,7 +1521,7 @@ int get_stream_retention_config(const char *stream_name, stream_retention_config
     config->detection_retention_days = 90;
     config->max_storage_mb = 0;
 
-    pthread_mutex_lock(db_mutex);
+    db_writer_lock();
 
     const char *sql = "SELECT retention_days, detection_retention_days, max_storage_mb "
                       "FROM streams WHERE name = ?;";
@@ -1420,7 +1529,7 @@ int get_stream_retention_config(const char *stream_name, stream_retention_config
     rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
         log_error("Failed to prepare statement: %s", sqlite3_errmsg(db));
-        pthread_mutex_unlock(db_mutex);
+        db_writer_unlock();
         return -1;
     }
 
@@ -1440,7 +1549,7 @@ int get_stream_retention_config(const char *stream_name, stream_retention_config
     }
 
     sqlite3_finalize(stmt);
-    pthread_mutex_unlock(db_mutex);
+    db_writer_unlock();
 
     return result;
 }
@@ -1457,7 +1566,6 @@ int set_stream_retention_config(const char *stream_name, const stream_retention_
     sqlite3_stmt *stmt;
 
     sqlite3 *db = get_db_handle();
-    pthread_mutex_t *db_mutex = get_db_mutex();
 
     if (!db) {
         log_error("Database not initialized");
@@ -1469,7 +1577,7 @@ int set_stream_retention_config(const char *stream_name, const stream_retention_
         return -1;
     }
 
-    pthread_mutex_lock(db_mutex);
+    db_writer_lock();
 
     const char *sql = "UPDATE streams SET retention_days = ?, detection_retention_days = ?, "
                       "max_storage_mb = ? WHERE name = ?;";
@@ -1477,7 +1585,7 @@ int set_stream_retention_config(const char *stream_name, const stream_retention_
     rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
         log_error("Failed to prepare statement: %s", sqlite3_errmsg(db));
-        pthread_mutex_unlock(db_mutex);
+        db_writer_unlock();
         return -1;
     }
 
@@ -1488,7 +1596,7 @@ int set_stream_retention_config(const char *stream_name, const stream_retention_
 
     rc = sqlite3_step(stmt);
     sqlite3_finalize(stmt);
-    pthread_mutex_unlock(db_mutex);
+    db_writer_unlock();
 
     if (rc != SQLITE_DONE) {
         log_error("Failed to update stream retention config: %s", sqlite3_errmsg(db));
@@ -1499,6 +1607,8 @@ int set_stream_retention_config(const char *stream_name, const stream_retention_
              stream_name, config->retention_days, config->detection_retention_days,
              (unsigned long)config->max_storage_mb);
 
+    reload_stream_config(stream_name);
+
     return 0;
 }
 
@@ -1515,7 +1625,6 @@ int get_all_stream_names(char names[][MAX_STREAM_NAME], int max_count) {
     int count = 0;
 
     sqlite3 *db = get_db_handle();
-    pthread_mutex_t *db_mutex = get_db_mutex();
 
     if (!db) {
         log_error("Database not initialized");
@@ -1527,14 +1636,14 @@ int get_all_stream_names(char names[][MAX_STREAM_NAME], int max_count) {
         return -1;
     }
 
-    pthread_mutex_lock(db_mutex);
+    db_writer_lock();
 
     const char *sql = "SELECT name FROM streams WHERE enabled = 1 ORDER BY name;";
 
     rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
         log_error("Failed to prepare statement: %s", sqlite3_errmsg(db));
-        pthread_mutex_unlock(db_mutex);
+        db_writer_unlock();
         return -1;
     }
 
@@ -1547,7 +1656,7 @@ int get_all_stream_names(char names[][MAX_STREAM_NAME], int max_count) {
     }
 
     sqlite3_finalize(stmt);
-    pthread_mutex_unlock(db_mutex);
+    db_writer_unlock();
 
     return count;
 }
@@ -1559,43 +1668,11 @@ int get_all_stream_names(char names[][MAX_STREAM_NAME], int max_count) {
  * @return Total size in bytes, or 0 on error
  */
 uint64_t get_stream_storage_usage_db(const char *stream_name) {
-    int rc;
-    sqlite3_stmt *stmt;
-    uint64_t size_bytes = 0;
-
-    sqlite3 *db = get_db_handle();
-    pthread_mutex_t *db_mutex = get_db_mutex();
-
-    if (!db) {
-        log_error("Database not initialized");
-        return 0;
-    }
-
     if (!stream_name) {
         log_error("Stream name is required");
         return 0;
     }
 
-    pthread_mutex_lock(db_mutex);
-
-    const char *sql = "SELECT COALESCE(SUM(size_bytes), 0) FROM recordings "
-                      "WHERE stream_name = ? AND is_complete = 1;";
-
-    rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
-    if (rc != SQLITE_OK) {
-        log_error("Failed to prepare statement: %s", sqlite3_errmsg(db));
-        pthread_mutex_unlock(db_mutex);
-        return 0;
-    }
-
-    sqlite3_bind_text(stmt, 1, stream_name, -1, SQLITE_STATIC);
-
-    if (sqlite3_step(stmt) == SQLITE_ROW) {
-        size_bytes = (uint64_t)sqlite3_column_int64(stmt, 0);
-    }
-
-    sqlite3_finalize(stmt);
-    pthread_mutex_unlock(db_mutex);
-
-    return size_bytes;
+    int64_t size_bytes = get_stream_storage_bytes(stream_name);
+    return size_bytes > 0 ? (uint64_t)size_bytes : 0;
 }
@@ -0,0 +1,358 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "database/db_write_queue.h"
+#include "database/db_core.h"
+#include "core/config.h"
+#include "core/logger.h"
+
+typedef struct db_write_item {
+    struct db_write_item *next;
+    db_write_fn apply;
+    bool keyed;
+    uint64_t key;
+    int64_t queued_ms;
+    size_t size;
+    unsigned char payload[];
+} db_write_item_t;
+
+static db_write_item_t *queue_head = NULL;
+static db_write_item_t *queue_tail = NULL;
+static int queue_depth = 0;
+static uint64_t writes_enqueued = 0;        // Sequence numbers for db_write_queue_flush()
+static uint64_t writes_done = 0;
+static int flush_requests = 0;
+static bool running = false;
+static bool stopping = false;
+static pthread_t queue_thread;
+static db_write_queue_stats_t stats;
+static pthread_mutex_t queue_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t work_cond = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t done_cond = PTHREAD_COND_INITIALIZER;
+
+static int64_t monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static int queue_capacity(void) {
+    return g_config.db_write_queue_capacity > 0 ? g_config.db_write_queue_capacity : 4096;
+}
+
+static int batch_max_rows(void) {
+    return g_config.db_write_batch_max_rows > 0 ? g_config.db_write_batch_max_rows : 200;
+}
+
+static int batch_interval_ms(void) {
+    return g_config.db_write_batch_interval_ms > 0 ? g_config.db_write_batch_interval_ms : 250;
+}
+
+int db_write_now(db_write_fn apply, const void *payload) {
+    sqlite3 *db = get_db_handle();
+    if (!db || !apply) {
+        log_error("Database not initialized");
+        return -1;
+    }
+
+    db_writer_lock();
+
+    char *err_msg = NULL;
+    if (sqlite3_exec(db, "BEGIN TRANSACTION;", NULL, NULL, &err_msg) != SQLITE_OK) {
+        log_error("Failed to begin transaction: %s", err_msg);
+        sqlite3_free(err_msg);
+        db_writer_unlock();
+        return -1;
+    }
+
+    int rc = apply(db, payload);
+    if (rc != 0) {
+        sqlite3_exec(db, "ROLLBACK;", NULL, NULL, NULL);
+        db_writer_unlock();
+        return -1;
+    }
+
+    if (sqlite3_exec(db, "COMMIT;", NULL, NULL, &err_msg) != SQLITE_OK) {
+        log_error("Failed to commit transaction: %s", err_msg);
+        sqlite3_free(err_msg);
+        sqlite3_exec(db, "ROLLBACK;", NULL, NULL, NULL);
+        db_writer_unlock();
+        return -1;
+    }
+
+    db_writer_unlock();
+    return 0;
+}
+
+// Commit a detached list of writes in one transaction. Each write runs in
+// a savepoint so one failing row does not discard the rest of the batch.
+static void commit_batch(db_write_item_t *items, int count) {
+    int64_t start = monotonic_ms();
+    uint64_t committed = 0;
+    uint64_t failed = 0;
+
+    sqlite3 *db = get_db_handle();
+    if (!db) {
+        log_error("Database not initialized, dropping %d queued writes", count);
+        failed = (uint64_t)count;
+    } else {
+        db_writer_lock();
+
+        char *err_msg = NULL;
+        if (sqlite3_exec(db, "BEGIN TRANSACTION;", NULL, NULL, &err_msg) != SQLITE_OK) {
+            log_error("Failed to begin write batch: %s", err_msg);
+            sqlite3_free(err_msg);
+            failed = (uint64_t)count;
+        } else {
+            for (db_write_item_t *item = items; item; item = item->next) {
+                sqlite3_exec(db, "SAVEPOINT queued_write;", NULL, NULL, NULL);
+                if (item->apply(db, item->payload) == 0) {
+                    committed++;
+                } else {
+                    sqlite3_exec(db, "ROLLBACK TO queued_write;", NULL, NULL, NULL);
+                    failed++;
+                }
+                sqlite3_exec(db, "RELEASE queued_write;", NULL, NULL, NULL);
+            }
+
+            if (sqlite3_exec(db, "COMMIT;", NULL, NULL, &err_msg) != SQLITE_OK) {
+                log_error("Failed to commit write batch of %d: %s", count, err_msg);
+                sqlite3_free(err_msg);
+                sqlite3_exec(db, "ROLLBACK;", NULL, NULL, NULL);
+                failed = (uint64_t)count;
+                committed = 0;
+            }
+        }
+
+        db_writer_unlock();
+    }
+
+    while (items) {
+        db_write_item_t *next = items->next;
+        free(items);
+        items = next;
+    }
+
+    pthread_mutex_lock(&queue_mutex);
+    stats.committed += committed;
+    stats.failed += failed;
+    stats.batches++;
+    stats.commit_us += (uint64_t)(monotonic_ms() - start) * 1000;
+    writes_done += (uint64_t)count;
+    pthread_cond_broadcast(&done_cond);
+    pthread_mutex_unlock(&queue_mutex);
+}
+
+static void *write_queue_thread(void *arg) {
+    (void)arg;
+
+    pthread_mutex_lock(&queue_mutex);
+    for (;;) {
+        // Wait for a full batch, the batch interval of the oldest write, a
+        // flush or shutdown
+        while (!stopping &&
+               (queue_depth == 0 ||
+                (flush_requests == 0 && queue_depth < batch_max_rows() &&
+                 monotonic_ms() - queue_head->queued_ms < batch_interval_ms()))) {
+            if (queue_depth == 0) {
+                pthread_cond_wait(&work_cond, &queue_mutex);
+            } else {
+                int64_t due_ms = queue_head->queued_ms + batch_interval_ms() - monotonic_ms();
+                struct timespec deadline;
+                clock_gettime(CLOCK_REALTIME, &deadline);
+                deadline.tv_sec += due_ms / 1000;
+                deadline.tv_nsec += (due_ms % 1000) * 1000000L;
+                if (deadline.tv_nsec >= 1000000000L) {
+                    deadline.tv_sec++;
+                    deadline.tv_nsec -= 1000000000L;
+                }
+                pthread_cond_timedwait(&work_cond, &queue_mutex, &deadline);
+            }
+        }
+
+        if (queue_depth == 0) {
+            break;      // Stopping and drained
+        }
+
+        // Detach up to one batch
+        int max_rows = batch_max_rows();
+        db_write_item_t *batch = queue_head;
+        db_write_item_t *last = queue_head;
+        int count = 1;
+        while (count < max_rows && last->next) {
+            last = last->next;
+            count++;
+        }
+        queue_head = last->next;
+        last->next = NULL;
+        if (!queue_head) {
+            queue_tail = NULL;
+        }
+        queue_depth -= count;
+        pthread_cond_broadcast(&done_cond);     // Producers waiting for room
+        pthread_mutex_unlock(&queue_mutex);
+
+        commit_batch(batch, count);
+
+        pthread_mutex_lock(&queue_mutex);
+    }
+
+    // Later writes are done synchronously
+    running = false;
+    pthread_cond_broadcast(&done_cond);
+    pthread_mutex_unlock(&queue_mutex);
+    return NULL;
+}
+
+int db_write_queue_init(void) {
+    if (!g_config.db_write_queue) {
+        log_info("Database write queue disabled, writes commit synchronously");
+        return 0;
+    }
+
+    pthread_mutex_lock(&queue_mutex);
+    if (running) {
+        pthread_mutex_unlock(&queue_mutex);
+        return 0;
+    }
+    stopping = false;
+    running = true;
+    if (pthread_create(&queue_thread, NULL, write_queue_thread, NULL) != 0) {
+        running = false;
+        pthread_mutex_unlock(&queue_mutex);
+        log_error("Failed to start database write queue thread");
+        return -1;
+    }
+    pthread_mutex_unlock(&queue_mutex);
+
+    log_info("Database write queue started (batch every %d ms or %d rows, capacity %d)",
+             batch_interval_ms(), batch_max_rows(), queue_capacity());
+    return 0;
+}
+
+void db_write_queue_shutdown(void) {
+    pthread_mutex_lock(&queue_mutex);
+    if (!running || stopping) {
+        pthread_mutex_unlock(&queue_mutex);
+        return;
+    }
+    int pending = queue_depth;
+    stopping = true;
+    pthread_cond_signal(&work_cond);
+    pthread_mutex_unlock(&queue_mutex);
+
+    log_info("Stopping database write queue, committing %d queued writes", pending);
+    pthread_join(queue_thread, NULL);
+
+    pthread_mutex_lock(&queue_mutex);
+    stopping = false;
+    pthread_mutex_unlock(&queue_mutex);
+}
+
+static int submit(db_write_fn apply, db_write_merge_fn merge, bool keyed, uint64_t key,
+                  const void *payload, size_t size) {
+    if (!apply) {
+        return -1;
+    }
+
+    db_write_item_t *item = malloc(sizeof(db_write_item_t) + size);
+    if (!item) {
+        log_error("Out of memory queueing database write");
+        return db_write_now(apply, payload);
+    }
+    item->next = NULL;
+    item->apply = apply;
+    item->keyed = keyed;
+    item->key = key;
+    item->size = size;
+    memcpy(item->payload, payload, size);
+
+    pthread_mutex_lock(&queue_mutex);
+    if (keyed && running) {
+        for (db_write_item_t *queued = queue_head; queued; queued = queued->next) {
+            if (queued->keyed && queued->apply == apply && queued->key == key && queued->size == size) {
+                if (merge) {
+                    merge(queued->payload, payload);
+                } else {
+                    memcpy(queued->payload, payload, size);
+                }
+                stats.submitted++;
+                stats.coalesced++;
+                pthread_mutex_unlock(&queue_mutex);
+                free(item);
+                return 0;
+            }
+        }
+    }
+
+    // A full queue makes the producer wait for room; writes keep their order
+    if (running && queue_depth >= queue_capacity()) {
+        stats.overflows++;
+        while (running && queue_depth >= queue_capacity()) {
+            pthread_cond_wait(&done_cond, &queue_mutex);
+        }
+    }
+
+    if (!running) {
+        pthread_mutex_unlock(&queue_mutex);
+        int rc = db_write_now(apply, item->payload);
+        free(item);
+        return rc;
+    }
+
+    item->queued_ms = monotonic_ms();
+    if (queue_tail) {
+        queue_tail->next = item;
+    } else {
+        queue_head = item;
+    }
+    queue_tail = item;
+    queue_depth++;
+    writes_enqueued++;
+    stats.submitted++;
+    if (queue_depth > stats.max_depth) {
+        stats.max_depth = queue_depth;
+    }
+    if (queue_depth == 1 || queue_depth >= batch_max_rows()) {
+        pthread_cond_signal(&work_cond);
+    }
+    pthread_mutex_unlock(&queue_mutex);
+    return 0;
+}
+
+int db_write_queue_submit(db_write_fn apply, const void *payload, size_t size) {
+    return submit(apply, NULL, false, 0, payload, size);
+}
+
+int db_write_queue_submit_keyed(db_write_fn apply, db_write_merge_fn merge, uint64_t key,
+                                const void *payload, size_t size) {
+    return submit(apply, merge, true, key, payload, size);
+}
+
+void db_write_queue_flush(void) {
+    pthread_mutex_lock(&queue_mutex);
+    uint64_t target = writes_enqueued;
+    flush_requests++;
+    pthread_cond_signal(&work_cond);
+    while (running && writes_done < target) {
+        pthread_cond_wait(&done_cond, &queue_mutex);
+    }
+    flush_requests--;
+    pthread_mutex_unlock(&queue_mutex);
+}
+
+void db_write_queue_get_stats(db_write_queue_stats_t *out) {
+    if (!out) {
+        return;
+    }
+
+    pthread_mutex_lock(&queue_mutex);
+    *out = stats;
+    out->depth = queue_depth;
+    pthread_mutex_unlock(&queue_mutex);
+}
@@ -8,12 +8,21 @@
 #include <time.h>
 #include <sqlite3.h>
 #include <stdbool.h>
+#include <stdatomic.h>
 
 #include "database/db_zones.h"
 #include "database/db_core.h"
 #include "core/logger.h"
 #include "utils/strings.h"
 
+// Bumped after every successful zone write so compiled zone caches
+// (see video/zone_filter.c) know to rebuild.
+static atomic_uint_fast64_t zones_generation = 1;
+
+uint64_t get_detection_zones_generation(void) {
+    return (uint64_t)atomic_load(&zones_generation);
+}
+
 /**
  * Convert polygon points to JSON string
  */
@@ -187,6 +196,7 @@ int save_detection_zones(const char *stream_name, const detection_zone_t *zones,
         return -1;
     }
 
+    atomic_fetch_add(&zones_generation, 1);
     log_info("Saved %d detection zones for stream %s", count, stream_name);
     return 0;
 }
@@ -276,7 +286,11 @@ int delete_detection_zones(const char *stream_name) {
     rc = sqlite3_step(stmt);
     sqlite3_finalize(stmt);
 
-    return (rc == SQLITE_DONE) ? 0 : -1;
+    if (rc != SQLITE_DONE) {
+        return -1;
+    }
+    atomic_fetch_add(&zones_generation, 1);
+    return 0;
 }
 
 /**
@@ -304,7 +318,11 @@ int delete_detection_zone(const char *zone_id) {
     rc = sqlite3_step(stmt);
     sqlite3_finalize(stmt);
 
-    return (rc == SQLITE_DONE) ? 0 : -1;
+    if (rc != SQLITE_DONE) {
+        return -1;
+    }
+    atomic_fetch_add(&zones_generation, 1);
+    return 0;
 }
 
 /**
@@ -335,6 +353,10 @@ int update_zone_enabled(const char *zone_id, bool enabled) {
     rc = sqlite3_step(stmt);
     sqlite3_finalize(stmt);
 
-    return (rc == SQLITE_DONE) ? 0 : -1;
+    if (rc != SQLITE_DONE) {
+        return -1;
+    }
+    atomic_fetch_add(&zones_generation, 1);
+    return 0;
 }
 
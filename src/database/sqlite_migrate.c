@@ -220,6 +220,54 @@ static int validate_migration_file_security(const char *filepath) {
     return 0;
 }
 
+/**
+ * Find the semicolon that ends the statement starting at sql
+ *
+ * Semicolons inside single-quoted literals do not end a statement. A
+ * CREATE TRIGGER statement also spans the semicolons of its body and ends
+ * at the first semicolon after the END that closes its BEGIN; CASE ... END
+ * expressions inside the body are tracked so their END is not taken for it.
+ *
+ * Returns a pointer to the terminating semicolon, or to the end of the string.
+ */
+static const char *find_statement_end(const char *sql) {
+    const bool is_trigger = strncasecmp(sql, "CREATE TRIGGER", 14) == 0;
+    int depth = 0;
+    int in_str = 0;
+    const char *p = sql;
+
+    while (*p) {
+        if (*p == '\'') {
+            in_str = !in_str;
+            p++;
+            continue;
+        }
+        if (in_str) {
+            p++;
+            continue;
+        }
+        if (*p == ';' && depth == 0) {
+            break;
+        }
+        if (is_trigger && (isalpha((unsigned char)*p) || *p == '_') &&
+            (p == sql || !(isalnum((unsigned char)p[-1]) || p[-1] == '_' || p[-1] == '.'))) {
+            const char *word = p;
+            while (isalnum((unsigned char)*p) || *p == '_') p++;
+            size_t len = (size_t)(p - word);
+            if ((len == 5 && strncasecmp(word, "BEGIN", 5) == 0) ||
+                (len == 4 && strncasecmp(word, "CASE", 4) == 0)) {
+                depth++;
+            } else if (len == 3 && strncasecmp(word, "END", 3) == 0 && depth > 0) {
+                depth--;
+            }
+            continue;
+        }
+        p++;
+    }
+
+    return p;
+}
+
 /**
  * Validate that SQL from a migration file only contains allowlisted statement
  * types (DDL + safe DML).  This acts as a sanitization boundary between the
@@ -295,15 +343,10 @@ static int validate_migration_sql(const char *sql) {
             return -1;
         }
 
-        /* Advance past this statement (to the next semicolon),
-         * respecting single-quoted string literals.              */
-        int in_str = 0;
-        while (*p) {
-            if (*p == '\'' && !in_str) { in_str = 1; p++; continue; }
-            if (*p == '\'' &&  in_str) { in_str = 0; p++; continue; }
-            if (*p == ';'  && !in_str) { p++; break; }
-            p++;
-        }
+        /* Advance past this statement (to its terminating semicolon),
+         * respecting string literals and trigger bodies.               */
+        p = find_statement_end(p);
+        if (*p == ';') p++;
     }
 
     return 0;
@@ -717,19 +760,8 @@ static int execute_sql(sqlite3 *db, const char *sql) {
             continue;
         }
 
-        // Find end of statement (semicolon)
-        end = start;
-        int in_string = 0;
-        while (*end) {
-            if (*end == '\'' && !in_string) {
-                in_string = 1;
-            } else if (*end == '\'' && in_string) {
-                in_string = 0;
-            } else if (*end == ';' && !in_string) {
-                break;
-            }
-            end++;
-        }
+        // Find end of statement (semicolon), keeping trigger bodies whole
+        end = find_statement_end(start);
 
         if (end == start) {
             start = end + 1;
@@ -0,0 +1,72 @@
+/*
+ * SOD CNN INT8 quantization tool.
+ *
+ * Loads a float weights file, runs the given calibration images through it to
+ * measure activation ranges, and writes an INT8 weights file for the same
+ * architecture. The output is a drop-in replacement for the float file:
+ * sod_cnn_create() recognizes it by its header and runs the quantized kernels.
+ *
+ * Usage: sod_quantize <arch> <weights> <out.int8.sod> <calib images...>
+ *
+ *   arch      :face, :voc or a path to a darknet .cfg file
+ *   weights   Float weights file for the architecture
+ *   out       Path of the INT8 weights file to write
+ *   images    Calibration frames (PNG/JPEG/BMP...), ideally stills from the
+ *             cameras the model will run on. A few dozen is usually enough.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include "sod/sod.h"
+
+int main(int argc, char *argv[])
+{
+	const char *zErr = NULL;
+	sod_cnn *pNet;
+	sod_img *aCalib;
+	int nCalib = 0, i, rc;
+
+	if (argc < 5) {
+		fprintf(stderr, "Usage: %s <arch> <weights> <out.int8.sod> <calib images...>\n", argv[0]);
+		return 1;
+	}
+
+	if (sod_cnn_create(&pNet, argv[1], argv[2], &zErr) != SOD_OK) {
+		fprintf(stderr, "sod_cnn_create(%s, %s) failed: %s\n", argv[1], argv[2], zErr ? zErr : "unknown error");
+		return 1;
+	}
+
+	aCalib = calloc((size_t)(argc - 4), sizeof(sod_img));
+	if (aCalib == 0) {
+		fprintf(stderr, "Out of memory\n");
+		sod_cnn_destroy(pNet);
+		return 1;
+	}
+	for (i = 4; i < argc; i++) {
+		sod_img img = sod_img_load_from_file(argv[i], SOD_IMG_COLOR);
+		if (img.data == 0) {
+			fprintf(stderr, "Skipping unreadable calibration image %s\n", argv[i]);
+			continue;
+		}
+		aCalib[nCalib++] = img;
+	}
+	if (nCalib < 1) {
+		fprintf(stderr, "No usable calibration images\n");
+		free(aCalib);
+		sod_cnn_destroy(pNet);
+		return 1;
+	}
+
+	rc = sod_cnn_quantize(pNet, aCalib, nCalib, argv[3]);
+	if (rc != SOD_OK) {
+		fprintf(stderr, "Quantization failed (rc=%d)\n", rc);
+	} else {
+		printf("Wrote %s (calibrated on %d images)\n", argv[3], nCalib);
+	}
+
+	for (i = 0; i < nCalib; i++) {
+		sod_free_image(aCalib[i]);
+	}
+	free(aCalib);
+	sod_cnn_destroy(pNet);
+	return rc == SOD_OK ? 0 : 1;
+}
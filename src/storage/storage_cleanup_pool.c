@@ -0,0 +1,220 @@
+/**
+ * @file storage_cleanup_pool.c
+ * @brief Worker threads that remove recording files for retention cleanup
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#include "storage/storage_cleanup_pool.h"
+#include "core/logger.h"
+
+// Linux ioprio_set(2) encoding; glibc has no wrapper
+#define CLEANUP_IOPRIO_CLASS_SHIFT 13
+#define CLEANUP_IOPRIO_CLASS_BE    2
+#define CLEANUP_IOPRIO_CLASS_IDLE  3
+#define CLEANUP_IOPRIO_WHO_PROCESS 1
+
+static struct {
+    pthread_t threads[CLEANUP_POOL_MAX_WORKERS];
+    int worker_count;
+    bool stopping;
+    cleanup_io_priority_t io_priority;
+
+    // Batch in progress (protected by mutex)
+    cleanup_job_t *jobs;
+    int job_count;
+    int next_job;
+    int jobs_done;
+
+    pthread_mutex_t mutex;
+    pthread_cond_t work_cond;   // Workers wait here for a batch
+    pthread_cond_t done_cond;   // The submitter waits here for the batch to finish
+    pthread_mutex_t run_mutex;  // One batch at a time
+
+    cleanup_pool_stats_t stats;
+} pool = {
+    .worker_count = 0,
+    .stopping = false,
+    .jobs = NULL,
+    .mutex = PTHREAD_MUTEX_INITIALIZER,
+    .work_cond = PTHREAD_COND_INITIALIZER,
+    .done_cond = PTHREAD_COND_INITIALIZER,
+    .run_mutex = PTHREAD_MUTEX_INITIALIZER,
+};
+
+static void apply_io_priority(cleanup_io_priority_t io_priority) {
+#ifdef SYS_ioprio_set
+    int value;
+    if (io_priority == CLEANUP_IO_PRIORITY_IDLE) {
+        value = CLEANUP_IOPRIO_CLASS_IDLE << CLEANUP_IOPRIO_CLASS_SHIFT;
+    } else if (io_priority == CLEANUP_IO_PRIORITY_LOW) {
+        value = (CLEANUP_IOPRIO_CLASS_BE << CLEANUP_IOPRIO_CLASS_SHIFT) | 7;
+    } else {
+        return;
+    }
+
+    // who = 0 is the calling thread
+    if (syscall(SYS_ioprio_set, CLEANUP_IOPRIO_WHO_PROCESS, 0, value) != 0) {
+        log_warn("Failed to lower I/O priority of cleanup worker: %s", strerror(errno));
+    }
+#else
+    (void)io_priority;
+#endif
+}
+
+static void run_job(cleanup_job_t *job) {
+    job->result = 0;
+
+    if (job->path && job->path[0] != '\0' && unlink(job->path) != 0) {
+        job->result = errno;
+    }
+
+    pthread_mutex_lock(&pool.mutex);
+    if (job->result == 0 && job->path && job->path[0] != '\0') {
+        pool.stats.files_removed++;
+        pool.stats.bytes_freed += job->size_bytes;
+    } else if (job->result != 0 && job->result != ENOENT) {
+        pool.stats.failures++;
+    }
+    pthread_mutex_unlock(&pool.mutex);
+}
+
+static void *cleanup_worker_func(void *arg) {
+    (void)arg;
+    log_set_thread_context("StorageCleanup", NULL);
+    apply_io_priority(pool.io_priority);
+
+    pthread_mutex_lock(&pool.mutex);
+    for (;;) {
+        while (!pool.stopping && (!pool.jobs || pool.next_job >= pool.job_count)) {
+            pthread_cond_wait(&pool.work_cond, &pool.mutex);
+        }
+        if (!pool.jobs || pool.next_job >= pool.job_count) {
+            break;  // Stopping and nothing left to claim
+        }
+
+        cleanup_job_t *job = &pool.jobs[pool.next_job++];
+        pthread_mutex_unlock(&pool.mutex);
+
+        run_job(job);
+
+        pthread_mutex_lock(&pool.mutex);
+        if (++pool.jobs_done == pool.job_count) {
+            pthread_cond_signal(&pool.done_cond);
+        }
+    }
+    pthread_mutex_unlock(&pool.mutex);
+    return NULL;
+}
+
+int cleanup_pool_start(int workers, cleanup_io_priority_t io_priority) {
+    if (workers < 1) {
+        workers = 1;
+    }
+    if (workers > CLEANUP_POOL_MAX_WORKERS) {
+        workers = CLEANUP_POOL_MAX_WORKERS;
+    }
+
+    pthread_mutex_lock(&pool.mutex);
+    if (pool.worker_count > 0) {
+        pthread_mutex_unlock(&pool.mutex);
+        return 0;
+    }
+    pool.stopping = false;
+    pool.io_priority = io_priority;
+
+    int started = 0;
+    for (int i = 0; i < workers; i++) {
+        if (pthread_create(&pool.threads[started], NULL, cleanup_worker_func, NULL) != 0) {
+            log_warn("Failed to start cleanup worker %d: %s", i, strerror(errno));
+            break;
+        }
+        started++;
+    }
+    pool.worker_count = started;
+    pool.stats.workers = started;
+    pthread_mutex_unlock(&pool.mutex);
+
+    if (started == 0) {
+        log_error("No cleanup workers started, recordings will be removed on the storage thread");
+        return -1;
+    }
+
+    log_info("Started %d storage cleanup workers", started);
+    return 0;
+}
+
+void cleanup_pool_stop(void) {
+    pthread_mutex_lock(&pool.mutex);
+    int count = pool.worker_count;
+    pool.stopping = true;
+    pthread_cond_broadcast(&pool.work_cond);
+    pthread_mutex_unlock(&pool.mutex);
+
+    for (int i = 0; i < count; i++) {
+        pthread_join(pool.threads[i], NULL);
+    }
+
+    pthread_mutex_lock(&pool.mutex);
+    pool.worker_count = 0;
+    pool.stats.workers = 0;
+    pthread_mutex_unlock(&pool.mutex);
+
+    if (count > 0) {
+        log_info("Stopped %d storage cleanup workers", count);
+    }
+}
+
+void cleanup_pool_run(cleanup_job_t *jobs, int count) {
+    if (!jobs || count <= 0) {
+        return;
+    }
+
+    pthread_mutex_lock(&pool.run_mutex);
+    pthread_mutex_lock(&pool.mutex);
+
+    if (pool.worker_count == 0 || pool.stopping) {
+        pthread_mutex_unlock(&pool.mutex);
+        for (int i = 0; i < count; i++) {
+            run_job(&jobs[i]);
+        }
+        pthread_mutex_unlock(&pool.run_mutex);
+        return;
+    }
+
+    pool.jobs = jobs;
+    pool.job_count = count;
+    pool.next_job = 0;
+    pool.jobs_done = 0;
+    pthread_cond_broadcast(&pool.work_cond);
+
+    while (pool.jobs_done < pool.job_count) {
+        pthread_cond_wait(&pool.done_cond, &pool.mutex);
+    }
+
+    pool.jobs = NULL;
+    pool.job_count = 0;
+    pool.next_job = 0;
+    pool.jobs_done = 0;
+    pthread_mutex_unlock(&pool.mutex);
+    pthread_mutex_unlock(&pool.run_mutex);
+}
+
+void cleanup_pool_get_stats(cleanup_pool_stats_t *stats) {
+    if (!stats) {
+        return;
+    }
+
+    pthread_mutex_lock(&pool.mutex);
+    memcpy(stats, &pool.stats, sizeof(cleanup_pool_stats_t));
+    pthread_mutex_unlock(&pool.mutex);
+}
@@ -13,6 +13,7 @@
 
 #include "storage/storage_manager.h"
 #include "storage/storage_manager_streams_cache.h"
+#include "storage/storage_cleanup_pool.h"
 #include "database/db_auth.h"
 #include "database/db_streams.h"
 #include "database/db_recordings.h"
@@ -67,51 +68,105 @@ static struct {
     .reserved_space = 0
 };
 
-static bool delete_recording_file_and_metadata(const recording_metadata_t *recording,
-                                               const char *context,
-                                               uint64_t *freed_bytes) {
-    bool file_deleted = false;
-
+/**
+ * Delete a batch of recordings
+ *
+ * The files are removed by the cleanup pool first; only recordings whose
+ * file is gone (or was already missing) lose their metadata, in a single
+ * transaction, so a failed unlink never orphans a file on disk. Thumbnails
+ * go once that transaction has committed.
+ *
+ * @param freed_bytes Set to the size of the files unlinked, even if their
+ *                    metadata could not be deleted
+ * @param pruned_bytes Set to the size of the recordings whose file was
+ *                     already missing and whose metadata was deleted (may be NULL)
+ * @return Number of recordings deleted
+ */
+static int delete_recordings_batch(const recording_metadata_t *recordings, int count,
+                                   const char *context, uint64_t *freed_bytes,
+                                   uint64_t *pruned_bytes) {
     if (freed_bytes) {
         *freed_bytes = 0;
     }
+    if (pruned_bytes) {
+        *pruned_bytes = 0;
+    }
 
-    if (!recording) {
-        return false;
+    if (!recordings || count <= 0) {
+        return 0;
+    }
+
+    cleanup_job_t *jobs = calloc(count, sizeof(cleanup_job_t));
+    uint64_t *ids = calloc(count, sizeof(uint64_t));
+    if (!jobs || !ids) {
+        log_error("%s: failed to allocate batch of %d recordings", context, count);
+        free(jobs);
+        free(ids);
+        return 0;
     }
 
-    if (recording->file_path[0] != '\0') {
-        if (unlink(recording->file_path) == 0) {
-            file_deleted = true;
-        } else if (errno == ENOENT) {
+    for (int i = 0; i < count; i++) {
+        jobs[i].path = recordings[i].file_path;
+        jobs[i].size_bytes = recordings[i].size_bytes;
+    }
+
+    cleanup_pool_run(jobs, count);
+
+    // The disk space is gone once the unlink succeeds, whatever happens to
+    // the metadata; the callers stop deleting when enough is freed
+    uint64_t freed = 0;
+    int id_count = 0;
+    for (int i = 0; i < count; i++) {
+        if (jobs[i].result == ENOENT) {
             log_warn("%s: file already missing, pruning stale metadata for %s",
-                     context, recording->file_path);
-        } else {
+                     context, recordings[i].file_path);
+        } else if (jobs[i].result != 0) {
             log_error("%s: failed to delete recording file: %s (error: %s)",
-                      context, recording->file_path, strerror(errno));
-            return false;
+                      context, recordings[i].file_path, strerror(jobs[i].result));
+            continue;
+        } else if (recordings[i].file_path[0] != '\0') {
+            freed += recordings[i].size_bytes;
         }
+        ids[id_count++] = recordings[i].id;
     }
 
-    delete_recording_thumbnails(recording->id);
-
-    if (delete_recording_metadata(recording->id) != 0) {
-        log_warn("%s: failed to delete recording metadata for ID %llu",
-                 context, (unsigned long long)recording->id);
-        return false;
+    // Rows whose metadata could not be deleted keep their thumbnails; the
+    // next pass finds the file missing and retries the metadata
+    int deleted = 0;
+    if (id_count > 0 && delete_recordings_metadata_batch(ids, id_count) < 0) {
+        log_warn("%s: failed to delete metadata for %d recordings", context, id_count);
+        id_count = 0;
     }
 
-    /* Keep the stream storage cache consistent so the System page stats
-     * reflect the deletion immediately without waiting for the next full
-     * cache refresh. */
-    update_stream_storage_cache_remove_recording(recording->stream_name,
-                                                 recording->size_bytes);
+    uint64_t pruned = 0;
+    for (int i = 0; i < count && id_count > 0; i++) {
+        if (jobs[i].result != 0 && jobs[i].result != ENOENT) {
+            continue;
+        }
+        if (jobs[i].result == ENOENT) {
+            pruned += recordings[i].size_bytes;
+        }
+
+        delete_recording_thumbnails(recordings[i].id);
 
-    if (file_deleted && freed_bytes) {
-        *freed_bytes = recording->size_bytes;
+        /* Keep the stream storage cache consistent so the System page stats
+         * reflect the deletion immediately without waiting for the next full
+         * cache refresh. */
+        update_stream_storage_cache_remove_recording(recordings[i].stream_name,
+                                                     recordings[i].size_bytes);
+        deleted++;
     }
 
-    return true;
+    free(jobs);
+    free(ids);
+
+    if (freed_bytes) {
+        *freed_bytes = freed;
+    }
+    if (pruned_bytes) {
+        *pruned_bytes = pruned;
+    }
+    return deleted;
 }
 
 // Initialize the storage manager
@@ -384,16 +439,13 @@ int apply_retention_policy(void) {
                                                      MAX_RECORDINGS_PER_STREAM);
 
                 if (count > 0) {
-                    for (int i = 0; i < count; i++) {
-                        uint64_t freed_bytes = 0;
-                        if (delete_recording_file_and_metadata(&batch[i],
-                                                              "Retention cleanup",
-                                                              &freed_bytes)) {
-                            total_freed += freed_bytes;
-                            total_deleted++;
-                            stream_deleted++;
-                        }
-                    }
+                    uint64_t freed_bytes = 0;
+                    int batch_deleted = delete_recordings_batch(batch, count,
+                                                                "Retention cleanup",
+                                                                &freed_bytes, NULL);
+                    total_freed += freed_bytes;
+                    total_deleted += batch_deleted;
+                    stream_deleted += batch_deleted;
                 }
             } while (count == MAX_RECORDINGS_PER_STREAM);
 
@@ -422,15 +474,27 @@ int apply_retention_policy(void) {
                                                                   batch,
                                                                   MAX_RECORDINGS_PER_STREAM);
 
-                    for (int i = 0; i < count && freed < to_free; i++) {
-                        uint64_t freed_bytes = 0;
-                        if (delete_recording_file_and_metadata(&batch[i],
-                                                              "Quota cleanup",
-                                                              &freed_bytes)) {
-                            freed += freed_bytes;
-                            total_freed += freed_bytes;
-                            total_deleted++;
+                    // Take the oldest recordings that cover what is still over quota,
+                    // moving on to the next ones if some files could not be removed
+                    int next = 0;
+                    while (next < count && freed < to_free) {
+                        int victims = 0;
+                        uint64_t planned = freed;
+                        while (next + victims < count && planned < to_free) {
+                            planned += batch[next + victims].size_bytes;
+                            victims++;
                         }
+
+                        // Stale rows count toward the quota, which is measured
+                        // from the metadata, but free nothing on disk
+                        uint64_t freed_bytes = 0;
+                        uint64_t pruned_bytes = 0;
+                        total_deleted += delete_recordings_batch(&batch[next], victims,
+                                                                 "Quota cleanup",
+                                                                 &freed_bytes, &pruned_bytes);
+                        freed += freed_bytes + pruned_bytes;
+                        total_freed += freed_bytes;
+                        next += victims;
                     }
                 } while (count == MAX_RECORDINGS_PER_STREAM && freed < to_free);
 
@@ -482,11 +546,16 @@ int apply_retention_policy(void) {
                         log_info("Found %d orphaned database entries (checked %d, ratio %.0f%%), cleaning up",
                                  orphan_count, total_checked, orphan_ratio * 100.0);
 
-                        for (int i = 0; i < orphan_count; i++) {
-                            if (delete_recording_metadata(orphaned[i].id) == 0) {
-                                log_debug("Deleted orphaned DB entry: ID %llu, path %s",
-                                         (unsigned long long)orphaned[i].id, orphaned[i].file_path);
+                        uint64_t *orphan_ids = calloc(orphan_count, sizeof(uint64_t));
+                        if (orphan_ids) {
+                            for (int i = 0; i < orphan_count; i++) {
+                                orphan_ids[i] = orphaned[i].id;
                             }
+                            int removed = delete_recordings_metadata_batch(orphan_ids, orphan_count);
+                            if (removed >= 0) {
+                                log_debug("Deleted %d orphaned DB entries", removed);
+                            }
+                            free(orphan_ids);
                         }
                     }
                 }
@@ -660,6 +729,8 @@ int create_stream_directory(const char *stream_name) {
 
 // Maximum recordings to process per emergency cleanup
 #define MAX_EMERGENCY_RECORDINGS 200
+// Recordings deleted between disk pressure re-checks during emergency cleanup
+#define EMERGENCY_CLEANUP_CHUNK 32
 
 // Unified storage controller thread state
 static struct {
@@ -801,25 +872,23 @@ static void emergency_cleanup(bool aggressive) {
     int deleted = 0;
     uint64_t freed = 0;
 
-    for (int i = 0; i < count; i++) {
+    for (int i = 0; i < count; i += EMERGENCY_CLEANUP_CHUNK) {
         if (!unified_ctrl.running) break;  // Respect shutdown
 
+        int chunk = count - i < EMERGENCY_CLEANUP_CHUNK ? count - i : EMERGENCY_CLEANUP_CHUNK;
         uint64_t freed_bytes = 0;
-        if (delete_recording_file_and_metadata(&recordings[i],
-                                              "Emergency cleanup",
-                                              &freed_bytes)) {
-            freed += freed_bytes;
-            deleted++;
-
-            if (freed_bytes > 0) {
-                heartbeat_check_disk_pressure();
-
-                disk_pressure_level_t current_pressure = get_disk_pressure_level();
-                if (!should_continue_emergency_cleanup(initial_pressure, current_pressure, aggressive)) {
-                    log_info("Emergency cleanup stopping after pressure recovered to %s",
-                             disk_pressure_level_str(current_pressure));
-                    break;
-                }
+        deleted += delete_recordings_batch(&recordings[i], chunk,
+                                           "Emergency cleanup", &freed_bytes, NULL);
+        freed += freed_bytes;
+
+        if (freed_bytes > 0) {
+            heartbeat_check_disk_pressure();
+
+            disk_pressure_level_t current_pressure = get_disk_pressure_level();
+            if (!should_continue_emergency_cleanup(initial_pressure, current_pressure, aggressive)) {
+                log_info("Emergency cleanup stopping after pressure recovered to %s",
+                         disk_pressure_level_str(current_pressure));
+                break;
             }
         }
     }
@@ -909,14 +978,11 @@ static void standard_cleanup_cycle(void) {
                     tier_mults,
                     tier_recs, MAX_RECORDINGS_PER_STREAM);
 
-                for (int i = 0; i < count && unified_ctrl.running; i++) {
+                if (count > 0 && unified_ctrl.running) {
                     uint64_t freed_bytes = 0;
-                    if (delete_recording_file_and_metadata(&tier_recs[i],
-                                                          "Tiered cleanup",
-                                                          &freed_bytes)) {
-                        tier_freed += freed_bytes;
-                        tier_deleted++;
-                    }
+                    tier_deleted += delete_recordings_batch(tier_recs, count,
+                                                            "Tiered cleanup", &freed_bytes, NULL);
+                    tier_freed += freed_bytes;
                 }
             } while (count == MAX_RECORDINGS_PER_STREAM);
         }
@@ -973,7 +1039,7 @@ static void standard_cleanup_cycle(void) {
 // ---- Deep Maintenance Cycle (6h) ----
 
 /**
- * Deep maintenance: session cleanup, full analytics
+ * Deep maintenance: session cleanup, storage counter reconciliation, full analytics
  * Memory budget: <1MB
  */
 static void deep_maintenance_cycle(void) {
@@ -990,7 +1056,15 @@ static void deep_maintenance_cycle(void) {
     // 2. Run a standard cleanup as part of deep maintenance
     standard_cleanup_cycle();
 
-    // 3. Update deep maintenance timestamp
+    // 3. Check the per-stream storage counters against the recordings table
+    int drifted_streams = reconcile_stream_storage_stats();
+    if (drifted_streams > 0) {
+        log_warn("Deep maintenance: rebuilt storage counters, %d streams had drifted", drifted_streams);
+    } else if (drifted_streams < 0) {
+        log_warn("Deep maintenance: storage counter reconciliation error");
+    }
+
+    // 4. Update deep maintenance timestamp
     pthread_mutex_lock(&unified_ctrl.mutex);
     unified_ctrl.health.last_deep_time = time(NULL);
     pthread_mutex_unlock(&unified_ctrl.mutex);
@@ -1128,10 +1202,14 @@ int start_storage_manager_thread(int interval_seconds) {
     unified_ctrl.running = true;
     unified_ctrl.exited = false;
 
+    // Without workers, recordings are simply removed on the controller thread
+    cleanup_pool_start(g_config.cleanup_workers, (cleanup_io_priority_t)g_config.cleanup_io_priority);
+
     if (pthread_create(&unified_ctrl.thread, NULL, unified_storage_controller_func, NULL) != 0) {
         log_error("Failed to create storage controller thread: %s", strerror(errno));
         unified_ctrl.running = false;
         pthread_mutex_unlock(&unified_ctrl.mutex);
+        cleanup_pool_stop();
         return -1;
     }
 
@@ -1166,6 +1244,7 @@ int stop_storage_manager_thread(void) {
     while (elapsed_ms < timeout_ms) {
         if (unified_ctrl.exited) {
             pthread_join(unified_ctrl.thread, NULL);
+            cleanup_pool_stop();
             log_info("Storage controller thread stopped successfully");
             return 0;
         }
@@ -1175,6 +1254,9 @@ int stop_storage_manager_thread(void) {
 
     log_warn("Storage controller thread did not exit in time (%d ms), detaching", timeout_ms);
     pthread_detach(unified_ctrl.thread);
+
+    // Workers finish the batch in progress, later batches run on the detached thread
+    cleanup_pool_stop();
     return 0;
 }
 
@@ -20,9 +20,10 @@
 /**
  * Get storage usage per stream (DB-driven, no subprocess calls)
  *
- * Uses database aggregation queries instead of blocking popen("du -sb")
- * subprocess calls. This is O(1) per stream vs O(n) filesystem walk,
- * and does not block HTTP handler threads.
+ * Reads the per-stream storage counters from the database instead of
+ * blocking popen("du -sb") subprocess calls or SUM/COUNT scans of the
+ * recordings table. This is one row lookup per stream and does not block
+ * HTTP handler threads.
  *
  * @param storage_path Base storage path (kept for API compatibility, unused)
  * @param stream_info Array to fill with stream storage information
@@ -48,24 +49,19 @@ int get_stream_storage_usage(const char *storage_path, stream_storage_info_t *st
 
     int stream_count = 0;
     for (int i = 0; i < name_count && stream_count < max_streams; i++) {
-        // Get total bytes from DB (SUM of size_bytes for completed recordings)
-        int64_t total_bytes = get_stream_storage_bytes(stream_names[i]);
-        if (total_bytes < 0) {
-            total_bytes = 0; // Treat errors as zero
-        }
-
-        // Get recording count from DB
-        int rec_count = get_recording_count(0, 0, stream_names[i], 0, NULL, -1, NULL, 0, NULL, NULL);
-        if (rec_count < 0) {
-            rec_count = 0; // Treat errors as zero
+        // Counters are maintained per stream in the DB, one row lookup each
+        stream_storage_stats_t stats;
+        if (get_stream_storage_stats(stream_names[i], &stats) != 0) {
+            stats.total_bytes = 0; // Treat errors as zero
+            stats.recording_count = 0;
         }
 
         // Only include streams that have recordings or storage
         // (include all to match previous behavior of including dirs with HLS segments)
         safe_strcpy(stream_info[stream_count].name, stream_names[i],
                 sizeof(stream_info[stream_count].name), 0);
-        stream_info[stream_count].size_bytes = (unsigned long)total_bytes;
-        stream_info[stream_count].recording_count = rec_count;
+        stream_info[stream_count].size_bytes = (unsigned long)stats.total_bytes;
+        stream_info[stream_count].recording_count = (int)stats.recording_count;
         stream_count++;
     }
 
@@ -6,7 +6,6 @@
 #include <stdint.h>
 #include <unistd.h>
 #include <sys/stat.h>
-#include <curl/curl.h>
 #include <cjson/cJSON.h>
 #include <pthread.h>
 
@@ -17,13 +16,15 @@
 #include "core/mqtt_client.h"
 #include "utils/strings.h"
 #include "video/api_detection.h"
+#include "video/api_detection_client.h"
 #include "video/detection_result.h"
 #include "video/stream_manager.h"
 #include "video/stream_state.h"
 #include "video/zone_filter.h"
+#include "video/object_tracker.h"
 #include "video/ffmpeg_utils.h"
 #include "database/db_detections.h"
-#include "video/go2rtc/go2rtc_snapshot.h"
+#include "video/snapshot_cache.h"
 #include "video/go2rtc/go2rtc_integration.h"
 
 // Global variables
@@ -33,26 +34,13 @@ static pthread_mutex_t curl_mutex = PTHREAD_MUTEX_INITIALIZER;
 // Default JPEG quality used for API detection snapshots (range typically 0–100).
 #define API_DETECTION_JPEG_QUALITY_DEFAULT 85
 
-// Timeout (in seconds) for API detection HTTP requests.
-#define API_DETECTION_TIMEOUT_SECONDS 10L
-
 // Maximum number of bytes to log from the API response, including the null terminator.
 #define API_DETECTION_RESPONSE_PREVIEW_LEN 64
 
-// Initial buffer size (in bytes) for CURL responses to reduce realloc churn.
-#define API_DETECTION_INITIAL_RESPONSE_BUFFER_SIZE 1024
-
 // ASCII printable character range used when sanitizing response previews.
 #define ASCII_PRINTABLE_MIN 32
 #define ASCII_PRINTABLE_MAX 126
 
-// Structure to hold memory for curl response
-typedef struct {
-    char *memory;
-    size_t size;
-    size_t capacity;
-} memory_struct_t;
-
 // Basic validation to ensure the base URL does not contain control characters or spaces.
 static bool is_safe_base_url(const char *url) {
     if (url == NULL) {
@@ -68,26 +56,6 @@ static bool is_safe_base_url(const char *url) {
     return true;
 }
 
-// Set common curl options used across API detection requests.
-static void setup_common_curl_options(CURL *handle) {
-    if (handle == NULL) {
-        return;
-    }
-
-    // Prevent curl from using signals (required for multi-threaded apps)
-    curl_easy_setopt(handle, CURLOPT_NOSIGNAL, 1L);
-    // API detection URLs are admin-configured and commonly point to localhost/private services,
-    // so we explicitly disable redirects instead of blocking private address ranges.
-    curl_easy_setopt(handle, CURLOPT_FOLLOWLOCATION, 0L);
-#if defined(CURLOPT_PROTOCOLS_STR) && defined(CURLOPT_REDIR_PROTOCOLS_STR)
-    curl_easy_setopt(handle, CURLOPT_PROTOCOLS_STR, "http,https");
-    curl_easy_setopt(handle, CURLOPT_REDIR_PROTOCOLS_STR, "http,https");
-#elif defined(CURLOPT_PROTOCOLS) && defined(CURLOPT_REDIR_PROTOCOLS)
-    curl_easy_setopt(handle, CURLOPT_PROTOCOLS, CURLPROTO_HTTP | CURLPROTO_HTTPS);
-    curl_easy_setopt(handle, CURLOPT_REDIR_PROTOCOLS, CURLPROTO_HTTP | CURLPROTO_HTTPS);
-#endif
-}
-
 static bool is_api_detection_system_initialized(void) {
     bool is_ready = false;
 
@@ -217,91 +185,6 @@ static int build_api_detection_url(char *buffer,
     return 0;
 }
 
-// Callback function for curl to write data
-static size_t write_memory_callback(void *contents, size_t size, size_t nmemb, void *userp) {
-    if (nmemb != 0 && size > (SIZE_MAX / nmemb)) {
-        log_error("Not enough memory for curl response (size overflow)");
-        return 0;
-    }
-
-    size_t realsize = size * nmemb;
-    memory_struct_t *mem = (memory_struct_t *)userp;
-
-    if (realsize > SIZE_MAX - mem->size - 1) {
-        log_error("Not enough memory for curl response (size overflow)");
-        return 0;
-    }
-
-    size_t required_size = mem->size + realsize + 1;
-    if (required_size > mem->capacity) {
-        size_t new_capacity = mem->capacity > 0 ? mem->capacity : API_DETECTION_INITIAL_RESPONSE_BUFFER_SIZE;
-        while (new_capacity < required_size) {
-            if (new_capacity > (SIZE_MAX / 2)) {
-                new_capacity = required_size;
-                break;
-            }
-            new_capacity *= 2;
-        }
-
-        char *new_memory = realloc(mem->memory, new_capacity);
-        if (new_memory == NULL) {
-            log_error("Not enough memory for curl response");
-            return 0;
-        }
-
-        mem->memory = new_memory;
-        mem->capacity = new_capacity;
-    }
-
-    memcpy(&(mem->memory[mem->size]), contents, realsize);
-    mem->size += realsize;
-    mem->memory[mem->size] = 0;
-
-    return realsize;
-}
-
-static bool is_tls_ca_error(CURLcode res) {
-#ifdef CURLE_SSL_CACERT_BADFILE
-    if (res == CURLE_SSL_CACERT_BADFILE) {
-        return true;
-    }
-#endif
-#ifdef CURLE_SSL_CACERT
-    if (res == CURLE_SSL_CACERT) {
-        return true;
-    }
-#endif
-#ifdef CURLE_PEER_FAILED_VERIFICATION
-    if (res == CURLE_PEER_FAILED_VERIFICATION) {
-        return true;
-    }
-#endif
-    return false;
-}
-
-static void log_tls_error_details(const char *context, CURL *curl, CURLcode res, const char *url) {
-    if (!is_tls_ca_error(res)) {
-        return;
-    }
-
-    long ssl_verify_result = 0;
-    if (curl) {
-        curl_easy_getinfo(curl, CURLINFO_SSL_VERIFYRESULT, &ssl_verify_result);
-    }
-
-    const char *ssl_cert_file = getenv("SSL_CERT_FILE");
-    const char *ssl_cert_dir = getenv("SSL_CERT_DIR");
-
-    log_error("%s: TLS certificate verification failed for %s", context, url ? url : "(unknown URL)");
-    log_error("%s: libcurl SSL verify result=%ld, SSL_CERT_FILE=%s, SSL_CERT_DIR=%s",
-              context,
-              ssl_verify_result,
-              (ssl_cert_file && ssl_cert_file[0] != '\0') ? ssl_cert_file : "(unset)",
-              (ssl_cert_dir && ssl_cert_dir[0] != '\0') ? ssl_cert_dir : "(unset)");
-    log_error("%s: Ensure a readable CA bundle is installed (for containers, install ca-certificates) or configure SSL_CERT_FILE/SSL_CERT_DIR to valid paths.",
-              context);
-}
-
 /**
  * Initialize the API detection system
  */
@@ -321,6 +204,13 @@ int init_api_detection_system(void) {
         return -1;
     }
 
+    // Start the shared request worker (keep-alive connections, async requests)
+    if (api_detection_client_init() != 0) {
+        pthread_mutex_unlock(&curl_mutex);
+        log_error("Failed to start API detection client");
+        return -1;
+    }
+
     initialized = true;
     pthread_mutex_unlock(&curl_mutex);
 
@@ -343,6 +233,9 @@ void shutdown_api_detection_system(void) {
     log_info("Shutting down API detection system (initialized: %s)",
              was_initialized ? "yes" : "no");
 
+    // Abort outstanding requests and close the kept-alive connections
+    api_detection_client_shutdown();
+
     /*
      * Cleanup cached JPEG encoders used for API detection snapshots.
      *
@@ -364,239 +257,24 @@ void shutdown_api_detection_system(void) {
 }
 
 /**
- * Detect objects using the API with go2rtc snapshot
+ * Parse the JSON body of a detection API response
  */
-int detect_objects_api(const char *api_url, const unsigned char *frame_data,
-                      int width, int height, int channels, detection_result_t *result,
-                      const char *stream_name, float threshold, uint64_t recording_id) {
-    // Check if we're in shutdown mode or if the stream has been stopped.
-    if (is_shutdown_initiated()) {
-        log_info("API Detection: System shutdown in progress, skipping detection");
-        return -1;
-    }
-
-    // Initialize result to empty at the beginning to prevent segmentation faults.
-    if (result) {
-        memset(result, 0, sizeof(detection_result_t));
-    } else {
-        log_error("API Detection: NULL result pointer provided");
-        return -1;
-    }
-
-    // Check if api_url is the special "api-detection" string.
-    // If so, get the actual URL from the global config.
-    const char *actual_api_url = api_url;
-    if (api_url && strcmp(api_url, "api-detection") == 0) {
-        actual_api_url = g_config.api_detection_url;
-        log_info("API Detection: Using API URL from config: %s", actual_api_url ? actual_api_url : "NULL");
-    }
-
-    log_info("API Detection: Starting detection with API URL: %s", actual_api_url);
-    log_info("API Detection: Stream name: %s", stream_name ? stream_name : "NULL");
-
-    if (!is_api_detection_system_initialized()) {
-        log_error("API detection system not initialized");
+int api_detection_parse_response(const char *body, size_t body_len, detection_result_t *result) {
+    if (!result) {
         return -1;
     }
+    memset(result, 0, sizeof(detection_result_t));
 
-    if (!validate_api_detection_base_url(actual_api_url, "API Detection")) {
-        return -1;
-    }
-
-    // Use go2rtc to get a JPEG snapshot directly only when we do not already
-    // have a decoded frame. This avoids re-entering the go2rtc snapshot path
-    // during fallback flows that already decoded a local frame.
-    unsigned char *jpeg_data = NULL;
-    size_t jpeg_size = 0;
-    CURL *local_curl = NULL;
-    curl_mime *mime = NULL;
-    curl_mimepart *part = NULL;
-    memory_struct_t chunk = {0};
-    struct curl_slist *headers = NULL;
-    cJSON *root = NULL;
-    int ret = -1;
-    bool go2rtc_initialized = false;
-    bool snapshot_ok = false;
-
-    if (api_detection_should_use_go2rtc_snapshot(frame_data, width, height, channels, stream_name)) {
-        go2rtc_initialized = go2rtc_integration_is_initialized();
-        if (go2rtc_initialized) {
-            snapshot_ok = go2rtc_get_snapshot(stream_name, &jpeg_data, &jpeg_size);
-        }
-    }
-
-    if (snapshot_ok) {
-        log_info("API Detection: Successfully fetched snapshot from go2rtc: %zu bytes", jpeg_size);
-    } else {
-        if (!stream_name || stream_name[0] == '\0') {
-            log_debug("API Detection: No stream name provided for go2rtc snapshot, using cached JPEG encoding");
-        } else if (!go2rtc_initialized) {
-            log_debug("API Detection: go2rtc not initialized, using cached JPEG encoding");
-        } else {
-            log_warn("API Detection: Failed to get snapshot from go2rtc, falling back to cached JPEG encoding");
-        }
-
-        // FALLBACK: Use cached JPEG encoder to encode raw frame to JPEG in memory.
-        // The cache is keyed by (width, height, channels, quality) so encoders are only
-        // reused when the frame characteristics and JPEG quality match. The underlying
-        // AVCodecContext is kept alive and reused to avoid recreating it on every call.
-        //
-        // Thread-safety / lifetime notes:
-        // - jpeg_encoder_get_cached() and jpeg_encoder_cache_encode_to_memory() are
-        //   synchronized internally by the encoder cache implementation.
-        // - Encoders remain cached for the lifetime of the process (or until an explicit
-        //   cache-clear in the encoder module); there is no per-call teardown here.
-        jpeg_encoder_cache_t *encoder = jpeg_encoder_get_cached(width, height, channels, API_DETECTION_JPEG_QUALITY_DEFAULT);
-        if (!encoder) {
-            log_error("API Detection: Failed to get cached JPEG encoder");
-            goto cleanup;
-        }
-
-        // Encode directly to memory - no temp file needed
-        int encode_result = jpeg_encoder_cache_encode_to_memory(encoder, frame_data, &jpeg_data, &jpeg_size);
-        if (encode_result != 0) {
-            log_error("API Detection: Failed to encode frame to JPEG using cached encoder");
-            goto cleanup;
-        }
-
-        log_info("API Detection: Encoded frame to JPEG using cached encoder: %zu bytes", jpeg_size);
-    }
-
-    // Validate JPEG data.
-    if (!jpeg_data || jpeg_size == 0) {
-        log_error("API Detection: No JPEG data available");
-        goto cleanup;
-    }
-
-    // Use a per-call curl handle so detection requests can run concurrently.
-    local_curl = curl_easy_init();
-    if (local_curl == NULL) {
-        log_error("API Detection: Failed to initialize CURL handle");
-        goto cleanup;
-    }
-
-    // Set up curl for multipart/form-data using the modern mime API.
-    // Note: curl_mime_* replaced deprecated curl_formadd in libcurl 7.56.0.
-    mime = curl_mime_init(local_curl);
-    if (!mime) {
-        log_error("API Detection: Failed to create mime structure");
-        goto cleanup;
-    }
-
-    part = curl_mime_addpart(mime);
-    if (!part) {
-        log_error("API Detection: Failed to add mime part");
-        goto cleanup;
-    }
-
-    CURLcode mime_result;
-    mime_result = curl_mime_name(part, "file");
-    if (mime_result != CURLE_OK) {
-        log_error("API Detection: Failed to set mime name: %s", curl_easy_strerror(mime_result));
-        goto cleanup;
-    }
-
-    // Use curl_mime_data to pass data directly from memory (CURL_ZERO_TERMINATED not used; we pass size).
-    // curl_mime_data copies the data, so jpeg_data can be freed after this call.
-    mime_result = curl_mime_data(part, (const char *)jpeg_data, jpeg_size);
-    if (mime_result != CURLE_OK) {
-        log_error("API Detection: Failed to set mime data: %s", curl_easy_strerror(mime_result));
-        goto cleanup;
-    }
-
-    mime_result = curl_mime_filename(part, "snapshot.jpg");
-    if (mime_result != CURLE_OK) {
-        log_error("API Detection: Failed to set mime filename: %s", curl_easy_strerror(mime_result));
-        goto cleanup;
-    }
-
-    mime_result = curl_mime_type(part, "image/jpeg");
-    if (mime_result != CURLE_OK) {
-        log_error("API Detection: Failed to set mime type: %s", curl_easy_strerror(mime_result));
-        goto cleanup;
-    }
-
-    // Free the JPEG data now that curl has copied it.
-    free(jpeg_data);
-    jpeg_data = NULL;
-
-    log_info("API Detection: Successfully added JPEG data to form (%zu bytes)", jpeg_size);
-
-    const char *backend = g_config.api_detection_backend;
-    const char *safe_backend = sanitize_backend(backend);
-    float actual_threshold = normalize_api_detection_threshold(threshold);
-
-    char url_with_params[1024];
-    if (build_api_detection_url(url_with_params,
-                                sizeof(url_with_params),
-                                actual_api_url,
-                                backend,
-                                threshold,
-                                false) != 0) {
-        log_error("API Detection: Failed to construct URL with parameters.");
-        goto cleanup;
-    }
-    log_info("API Detection: Using URL with parameters: %s (backend: %s, threshold: %.2f)",
-             url_with_params, safe_backend, actual_threshold);
-
-    curl_easy_setopt(local_curl, CURLOPT_URL, url_with_params);
-    curl_easy_setopt(local_curl, CURLOPT_MIMEPOST, mime);
-
-    headers = curl_slist_append(headers, "accept: application/json");
-    curl_easy_setopt(local_curl, CURLOPT_HTTPHEADER, headers);
-
-    chunk.memory = malloc(API_DETECTION_INITIAL_RESPONSE_BUFFER_SIZE);
-    if (chunk.memory == NULL) {
-        log_error("API Detection: Failed to allocate memory for curl response buffer");
-        goto cleanup;
-    }
-    chunk.size = 0;
-    chunk.capacity = API_DETECTION_INITIAL_RESPONSE_BUFFER_SIZE;
-    chunk.memory[0] = '\0';
-
-    curl_easy_setopt(local_curl, CURLOPT_WRITEFUNCTION, write_memory_callback);
-    curl_easy_setopt(local_curl, CURLOPT_WRITEDATA, (void *)&chunk);
-
-    curl_easy_setopt(local_curl, CURLOPT_TIMEOUT, API_DETECTION_TIMEOUT_SECONDS);
-    setup_common_curl_options(local_curl);
-
-    log_info("API Detection: Sending request to %s", url_with_params);
-
-    CURLcode res = curl_easy_perform(local_curl);
-
-    if (res != CURLE_OK) {
-        log_error("API Detection: curl_easy_perform() failed: %s", curl_easy_strerror(res));
-        log_tls_error_details("API Detection", local_curl, res, url_with_params);
-
-        if (res == CURLE_COULDNT_CONNECT) {
-            log_error("API Detection: Could not connect to server at %s. Is the API server running?", url_with_params);
-        } else if (res == CURLE_OPERATION_TIMEDOUT) {
-            log_error("API Detection: Connection to %s timed out. Server might be slow or unreachable.", url_with_params);
-        } else if (res == CURLE_COULDNT_RESOLVE_HOST) {
-            log_error("API Detection: Could not resolve host %s. Check your network connection and DNS settings.", url_with_params);
-        }
-
-        goto cleanup;
-    }
-
-    long http_code = 0;
-    curl_easy_getinfo(local_curl, CURLINFO_RESPONSE_CODE, &http_code);
-
-    if (http_code != 200) {
-        log_error("API request failed with HTTP code %ld", http_code);
-        goto cleanup;
-    }
-
-    if (!chunk.memory || chunk.size == 0) {
+    if (!body || body_len == 0) {
         log_error("API Detection: Empty response from server");
-        goto cleanup;
+        return -1;
     }
 
     char preview[API_DETECTION_RESPONSE_PREVIEW_LEN];
-    int preview_len = (int)(chunk.size < (API_DETECTION_RESPONSE_PREVIEW_LEN - 1)
-                                ? chunk.size
+    int preview_len = (int)(body_len < (API_DETECTION_RESPONSE_PREVIEW_LEN - 1)
+                                ? body_len
                                 : (API_DETECTION_RESPONSE_PREVIEW_LEN - 1));
-    memcpy(preview, chunk.memory, preview_len);
+    memcpy(preview, body, preview_len);
     preview[preview_len] = '\0';
     // Replace non-printable characters with dots
     for (int i = 0; i < preview_len; i++) {
@@ -604,16 +282,15 @@ int detect_objects_api(const char *api_url, const unsigned char *frame_data,
             preview[i] = '.';
         }
     }
-    log_info("API Detection: Response preview: %s", preview);
-
-    root = cJSON_Parse(chunk.memory);
+    log_debug("API Detection: Response preview: %s", preview);
 
+    cJSON *root = cJSON_ParseWithLength(body, body_len);
     if (!root) {
         const char *error_ptr = cJSON_GetErrorPtr();
         log_error("Failed to parse JSON response: %s", error_ptr ? error_ptr : "Unknown error");
-        log_error("API Detection: Response size: %zu bytes", chunk.size);
+        log_error("API Detection: Response size: %zu bytes", body_len);
         log_error("API Detection: Response preview: %s", preview);
-        goto cleanup;
+        return -1;
     }
 
     cJSON *detections = cJSON_GetObjectItem(root, "detections");
@@ -624,7 +301,8 @@ int detect_objects_api(const char *api_url, const unsigned char *frame_data,
             log_error("API Detection: Full JSON response: %s", json_str);
             free(json_str);
         }
-        goto cleanup;
+        cJSON_Delete(root);
+        return -1;
     }
 
     int array_size = cJSON_GetArraySize(detections);
@@ -653,13 +331,11 @@ int detect_objects_api(const char *api_url, const unsigned char *frame_data,
             y_min = cJSON_GetObjectItem(bounding_box, "y_min");
             x_max = cJSON_GetObjectItem(bounding_box, "x_max");
             y_max = cJSON_GetObjectItem(bounding_box, "y_max");
-            log_info("API Detection: Found bounding_box object in JSON response");
         } else {
             x_min = cJSON_GetObjectItem(detection, "x_min");
             y_min = cJSON_GetObjectItem(detection, "y_min");
             x_max = cJSON_GetObjectItem(detection, "x_max");
             y_max = cJSON_GetObjectItem(detection, "y_max");
-            log_info("API Detection: Using direct coordinates from JSON response");
         }
 
         if (!label || !cJSON_IsString(label) ||
@@ -678,64 +354,230 @@ int detect_objects_api(const char *api_url, const unsigned char *frame_data,
         }
 
         // Add the detection to the result
-        safe_strcpy(result->detections[result->count].label, label->valuestring, MAX_LABEL_LENGTH, 0);
-        result->detections[result->count].confidence = (float)confidence->valuedouble;
-        result->detections[result->count].x = (float)x_min->valuedouble;
-        result->detections[result->count].y = (float)y_min->valuedouble;
-        result->detections[result->count].width = (float)(x_max->valuedouble - x_min->valuedouble);
-        result->detections[result->count].height = (float)(y_max->valuedouble - y_min->valuedouble);
+        detection_t *det = &result->detections[result->count];
+        safe_strcpy(det->label, label->valuestring, MAX_LABEL_LENGTH, 0);
+        det->confidence = (float)confidence->valuedouble;
+        det->x = (float)x_min->valuedouble;
+        det->y = (float)y_min->valuedouble;
+        det->width = (float)(x_max->valuedouble - x_min->valuedouble);
+        det->height = (float)(y_max->valuedouble - y_min->valuedouble);
 
         // Parse optional track_id field
         cJSON *track_id = cJSON_GetObjectItem(detection, "track_id");
-        if (track_id && cJSON_IsNumber(track_id)) {
-            result->detections[result->count].track_id = (int)track_id->valuedouble;
-        } else {
-            result->detections[result->count].track_id = -1; // No tracking
-        }
+        det->track_id = (track_id && cJSON_IsNumber(track_id)) ? (int)track_id->valuedouble : -1;
 
         // Parse optional zone_id field
         cJSON *zone_id = cJSON_GetObjectItem(detection, "zone_id");
         if (zone_id && cJSON_IsString(zone_id)) {
-            safe_strcpy(result->detections[result->count].zone_id, zone_id->valuestring, MAX_ZONE_ID_LENGTH, 0);
+            safe_strcpy(det->zone_id, zone_id->valuestring, MAX_ZONE_ID_LENGTH, 0);
         } else {
-            result->detections[result->count].zone_id[0] = '\0'; // Empty zone
+            det->zone_id[0] = '\0'; // Empty zone
         }
 
         result->count++;
     }
 
+    cJSON_Delete(root);
+    return 0;
+}
+
+/**
+ * Run parsed API detections through the per-stream pipeline
+ */
+int api_detection_process_result(const char *stream_name, detection_result_t *result,
+                                 uint64_t recording_id) {
+    if (!result) {
+        return -1;
+    }
+
+    if (!stream_name || stream_name[0] == '\0') {
+        log_warn("No stream name provided, skipping database storage");
+        return 0;
+    }
+
     // Filter detections by zones before storing
-    if (stream_name && stream_name[0] != '\0') {
-        log_info("API Detection: Filtering %d detections by zones for stream %s", result->count, stream_name);
-        int filter_ret = filter_detections_by_zones(stream_name, result);
-        if (filter_ret != 0) {
-            log_error("Failed to filter detections by zones, aborting detection pipeline for this frame");
-            goto cleanup;
-        }
+    log_info("API Detection: Filtering %d detections by zones for stream %s", result->count, stream_name);
+    if (filter_detections_by_zones(stream_name, result) != 0) {
+        log_error("Failed to filter detections by zones, aborting detection pipeline for this frame");
+        result->count = 0;
+        return -1;
+    }
 
-        filter_detections_by_stream_objects(stream_name, result);
+    // Filter detections by per-stream object include/exclude lists
+    filter_detections_by_stream_objects(stream_name, result);
 
-        time_t timestamp = time(NULL);
-        store_detections_in_db(stream_name, result, timestamp, recording_id);
+    // Only track start/update/end events are stored and published
+    time_t timestamp = time(NULL);
+    detection_result_t events;
+    object_tracker_process(stream_name, result, timestamp, &events);
+    if (events.count > 0) {
+        queue_detections_for_db(stream_name, &events, timestamp, recording_id);
+        mqtt_publish_detection(stream_name, &events, timestamp);
+    }
 
-        if (result->count > 0) {
-            mqtt_publish_detection(stream_name, result, timestamp);
-            mqtt_set_motion_state(stream_name, result);
-        }
+    // Update MQTT motion state if enabled
+    if (result->count > 0) {
+        mqtt_set_motion_state(stream_name, result);
+    }
+
+    return 0;
+}
+
+// Resolve the "api-detection" placeholder and validate the resulting base URL.
+static const char *resolve_api_detection_url(const char *api_url, const char *context) {
+    const char *actual_api_url = api_url;
+    if (api_url && strcmp(api_url, "api-detection") == 0) {
+        actual_api_url = g_config.api_detection_url;
+        log_debug("%s: Using API URL from config: %s", context, actual_api_url);
+    }
+
+    if (!is_api_detection_system_initialized()) {
+        log_error("API detection system not initialized");
+        return NULL;
+    }
+
+    if (!validate_api_detection_base_url(actual_api_url, context)) {
+        return NULL;
+    }
+
+    return actual_api_url;
+}
+
+// Send a JPEG through the shared client, wait for the answer and parse it.
+static int request_detections(const char *context, const char *stream_name, const char *base_url,
+                              float threshold, const unsigned char *jpeg_data, size_t jpeg_size,
+                              detection_result_t *result) {
+    const char *backend = sanitize_backend(g_config.api_detection_backend);
+
+    char url_with_params[1024];
+    if (build_api_detection_url(url_with_params, sizeof(url_with_params), base_url,
+                                backend, threshold, false) != 0) {
+        log_error("%s: Failed to construct URL with parameters.", context);
+        return -1;
+    }
+
+    log_info("%s: Sending request to %s (backend: %s, threshold: %.2f)",
+             context, url_with_params, backend, normalize_api_detection_threshold(threshold));
+
+    long http_code = 0;
+    char *body = NULL;
+    size_t body_len = 0;
+    if (api_detection_client_perform(stream_name, url_with_params, backend, jpeg_data, jpeg_size,
+                                     &http_code, &body, &body_len) != 0) {
+        free(body);
+        return -1;
+    }
+
+    int ret = -1;
+    if (http_code != 200) {
+        log_error("%s: API request failed with HTTP code %ld", context, http_code);
     } else {
-        log_warn("No stream name provided, skipping database storage");
+        ret = api_detection_parse_response(body, body_len, result);
     }
 
-    ret = 0;
+    free(body);
+    return ret;
+}
 
-cleanup:
-    cJSON_Delete(root);
-    free(chunk.memory);
-    curl_mime_free(mime);
-    curl_slist_free_all(headers);
-    curl_easy_cleanup(local_curl);
+/**
+ * Detect objects using the API with go2rtc snapshot
+ */
+int detect_objects_api(const char *api_url, const unsigned char *frame_data,
+                      int width, int height, int channels, detection_result_t *result,
+                      const char *stream_name, float threshold, uint64_t recording_id) {
+    // Check if we're in shutdown mode or if the stream has been stopped.
+    if (is_shutdown_initiated()) {
+        log_info("API Detection: System shutdown in progress, skipping detection");
+        return -1;
+    }
+
+    // Initialize result to empty at the beginning to prevent segmentation faults.
+    if (result) {
+        memset(result, 0, sizeof(detection_result_t));
+    } else {
+        log_error("API Detection: NULL result pointer provided");
+        return -1;
+    }
+
+    log_info("API Detection: Stream name: %s", stream_name ? stream_name : "NULL");
+
+    const char *actual_api_url = resolve_api_detection_url(api_url, "API Detection");
+    if (!actual_api_url) {
+        return -1;
+    }
+
+    // Use a go2rtc snapshot only when we do not already have a decoded
+    // frame. This avoids re-entering the go2rtc snapshot path during fallback
+    // flows that already decoded a local frame.
+    unsigned char *jpeg_data = NULL;
+    size_t jpeg_size = 0;
+    bool go2rtc_initialized = false;
+    snapshot_t *snapshot = NULL;
+
+    if (api_detection_should_use_go2rtc_snapshot(frame_data, width, height, channels, stream_name)) {
+        go2rtc_initialized = go2rtc_integration_is_initialized();
+        if (go2rtc_initialized) {
+            snapshot = snapshot_cache_get(stream_name, -1);
+        }
+    }
+
+    if (snapshot) {
+        log_info("API Detection: Using snapshot of stream %s: %zu bytes", stream_name, snapshot->size);
+    } else {
+        if (!stream_name || stream_name[0] == '\0') {
+            log_debug("API Detection: No stream name provided for go2rtc snapshot, using cached JPEG encoding");
+        } else if (!go2rtc_initialized) {
+            log_debug("API Detection: go2rtc not initialized, using cached JPEG encoding");
+        } else {
+            log_warn("API Detection: Failed to get snapshot from go2rtc, falling back to cached JPEG encoding");
+        }
+
+        // FALLBACK: Use cached JPEG encoder to encode raw frame to JPEG in memory.
+        // The cache is keyed by (width, height, channels, quality) so encoders are only
+        // reused when the frame characteristics and JPEG quality match. The underlying
+        // AVCodecContext is kept alive and reused to avoid recreating it on every call.
+        //
+        // Thread-safety / lifetime notes:
+        // - jpeg_encoder_get_cached() and jpeg_encoder_cache_encode_to_memory() are
+        //   synchronized internally by the encoder cache implementation.
+        // - Encoders remain cached for the lifetime of the process (or until an explicit
+        //   cache-clear in the encoder module); there is no per-call teardown here.
+        jpeg_encoder_cache_t *encoder = jpeg_encoder_get_cached(width, height, channels, API_DETECTION_JPEG_QUALITY_DEFAULT);
+        if (!encoder) {
+            log_error("API Detection: Failed to get cached JPEG encoder");
+            return -1;
+        }
+
+        // Encode directly to memory - no temp file needed
+        if (jpeg_encoder_cache_encode_to_memory(encoder, frame_data, &jpeg_data, &jpeg_size) != 0) {
+            log_error("API Detection: Failed to encode frame to JPEG using cached encoder");
+            free(jpeg_data);
+            return -1;
+        }
+
+        log_info("API Detection: Encoded frame to JPEG using cached encoder: %zu bytes", jpeg_size);
+
+        // Validate JPEG data.
+        if (!jpeg_data || jpeg_size == 0) {
+            log_error("API Detection: No JPEG data available");
+            free(jpeg_data);
+            return -1;
+        }
+
+        // Other snapshot users can reuse the frame we just encoded
+        snapshot_cache_put(stream_name, jpeg_data, jpeg_size);
+    }
+
+    int ret = request_detections("API Detection", stream_name, actual_api_url, threshold,
+                                 snapshot ? snapshot->data : jpeg_data,
+                                 snapshot ? snapshot->size : jpeg_size, result);
+    snapshot_release(snapshot);
     free(jpeg_data);
 
+    if (ret == 0) {
+        ret = api_detection_process_result(stream_name, result, recording_id);
+    }
+
     if (ret != 0) {
         result->count = 0;
     }
@@ -774,329 +616,94 @@ int detect_objects_api_snapshot(const char *api_url, const char *stream_name,
         return -1;
     }
 
-    // Handle "api-detection" special string
-    const char *actual_api_url = api_url;
-    if (api_url && strcmp(api_url, "api-detection") == 0) {
-        actual_api_url = g_config.api_detection_url;
-        log_info("API Detection (snapshot): Using API URL from config: %s", actual_api_url ? actual_api_url : "NULL");
-    }
-
-    if (!is_api_detection_system_initialized()) {
-        log_error("API detection system not initialized");
-        return -1;
-    }
-
-    if (!validate_api_detection_base_url(actual_api_url, "API Detection (snapshot)")) {
+    const char *actual_api_url = resolve_api_detection_url(api_url, "API Detection (snapshot)");
+    if (!actual_api_url) {
         return -1;
     }
 
     // Try to get snapshot from go2rtc (only if go2rtc is initialized)
-    unsigned char *jpeg_data = NULL;
-    size_t jpeg_size = 0;
-
     if (!go2rtc_integration_is_initialized()) {
         log_debug("API Detection (snapshot): go2rtc not initialized, skipping snapshot for stream %s", stream_name);
         return -2;  // Special return code: go2rtc not available, caller should fall back
     }
 
-    if (!go2rtc_get_snapshot(stream_name, &jpeg_data, &jpeg_size)) {
+    snapshot_t *snapshot = snapshot_cache_get(stream_name, -1);
+    if (!snapshot) {
         log_warn("API Detection (snapshot): Failed to get snapshot from go2rtc for stream %s", stream_name);
         return -2;  // Special return code: go2rtc failed, caller should fall back
     }
 
-    log_info("API Detection (snapshot): Successfully fetched snapshot from go2rtc: %zu bytes", jpeg_size);
-
-    // Validate JPEG data
-    if (!jpeg_data || jpeg_size == 0) {
-        log_error("API Detection (snapshot): No JPEG data available");
-        if (jpeg_data) free(jpeg_data);
-        return -2;
-    }
-
-    // Create a per-call curl handle to allow parallel requests from multiple threads
-    // This avoids the global mutex bottleneck that was serializing all detection calls
-    CURL *local_curl = curl_easy_init();
-    if (!local_curl) {
-        log_error("API Detection (snapshot): Failed to create curl handle");
-        free(jpeg_data);
-        return -1;
-    }
+    log_info("API Detection (snapshot): Using snapshot of stream %s: %zu bytes", stream_name, snapshot->size);
 
-    // Set up curl for multipart/form-data
-    curl_mime *mime = NULL;
-    curl_mimepart *part = NULL;
-    memory_struct_t chunk = {0};
-    chunk.memory = NULL;
-    struct curl_slist *headers = NULL;
-
-    // Create the mime structure
-    mime = curl_mime_init(local_curl);
-    if (!mime) {
-        log_error("API Detection (snapshot): Failed to create mime structure");
-        free(jpeg_data);
-        curl_easy_cleanup(local_curl);
-        return -1;
-    }
+    int ret = request_detections("API Detection (snapshot)", stream_name, actual_api_url, threshold,
+                                 snapshot->data, snapshot->size, result);
+    snapshot_release(snapshot);
 
-    // Add the file part
-    part = curl_mime_addpart(mime);
-    if (!part) {
-        log_error("API Detection (snapshot): Failed to add mime part");
-        curl_mime_free(mime);
-        free(jpeg_data);
-        curl_easy_cleanup(local_curl);
-        return -1;
+    if (ret == 0) {
+        ret = api_detection_process_result(stream_name, result, recording_id);
     }
 
-    // Set up the mime part
-    CURLcode mime_result;
-    mime_result = curl_mime_name(part, "file");
-    if (mime_result != CURLE_OK) {
-        log_error("API Detection (snapshot): curl_mime_name failed: %s",
-                  curl_easy_strerror(mime_result));
-        curl_mime_free(mime);
-        free(jpeg_data);
-        curl_easy_cleanup(local_curl);
+    if (ret != 0) {
+        result->count = 0;
         return -1;
     }
 
-    mime_result = curl_mime_data(part, (const char *)jpeg_data, jpeg_size);
-    if (mime_result != CURLE_OK) {
-        log_error("API Detection (snapshot): curl_mime_data failed: %s",
-                  curl_easy_strerror(mime_result));
-        curl_mime_free(mime);
-        free(jpeg_data);
-        curl_easy_cleanup(local_curl);
-        return -1;
-    }
+    log_info("API Detection (snapshot): Successfully detected %d objects", result->count);
+    return 0;
+}
 
-    mime_result = curl_mime_filename(part, "snapshot.jpg");
-    if (mime_result != CURLE_OK) {
-        log_error("API Detection (snapshot): curl_mime_filename failed: %s",
-                  curl_easy_strerror(mime_result));
-        curl_mime_free(mime);
-        free(jpeg_data);
-        curl_easy_cleanup(local_curl);
+/**
+ * Queue an API detection for a go2rtc snapshot without waiting for the answer
+ */
+int detect_objects_api_snapshot_async(const char *api_url, const char *stream_name, float threshold,
+                                      api_detection_complete_cb callback, void *user_data) {
+    if (is_shutdown_initiated()) {
         return -1;
     }
 
-    mime_result = curl_mime_type(part, "image/jpeg");
-    if (mime_result != CURLE_OK) {
-        log_error("API Detection (snapshot): curl_mime_type failed: %s",
-                  curl_easy_strerror(mime_result));
-        curl_mime_free(mime);
-        free(jpeg_data);
-        curl_easy_cleanup(local_curl);
+    if (!stream_name || stream_name[0] == '\0' || !callback) {
+        log_error("API Detection (async): Stream name and callback are required");
         return -1;
     }
 
-    // Free JPEG data now that curl has copied it
-    free(jpeg_data);
-    jpeg_data = NULL;
-
-    const char *backend = g_config.api_detection_backend;
-    const char *sanitized_backend = sanitize_backend(backend);
-    float actual_threshold = normalize_api_detection_threshold(threshold);
-
-    char url_with_params[1024];
-    if (build_api_detection_url(url_with_params,
-                                sizeof(url_with_params),
-                                actual_api_url,
-                                backend,
-                                threshold,
-                                false) != 0) {
-        log_error("API Detection (snapshot): URL too long when constructing request");
-        curl_mime_free(mime);
-        curl_slist_free_all(headers);
-        curl_easy_cleanup(local_curl);
-        return -1;
+    // Don't fetch a snapshot the client would refuse anyway
+    if (api_detection_client_inflight(stream_name) >= g_config.api_detection_max_inflight) {
+        log_debug("API Detection (async): %d requests already in flight for stream %s, skipping",
+                  api_detection_client_inflight(stream_name), stream_name);
+        return API_DETECTION_CLIENT_BUSY;
     }
 
-    log_info("API Detection (snapshot): Sending request to %s (backend: %s, threshold: %.2f)",
-             url_with_params,
-             sanitized_backend,
-             actual_threshold);
-
-    // Set up the request
-    curl_easy_setopt(local_curl, CURLOPT_URL, url_with_params);
-    curl_easy_setopt(local_curl, CURLOPT_MIMEPOST, mime);
-
-    headers = curl_slist_append(headers, "accept: application/json");
-    curl_easy_setopt(local_curl, CURLOPT_HTTPHEADER, headers);
-
-    chunk.memory = malloc(API_DETECTION_INITIAL_RESPONSE_BUFFER_SIZE);
-    if (chunk.memory == NULL) {
-        log_error("API Detection (snapshot): Failed to allocate memory for curl response buffer");
-        curl_mime_free(mime);
-        curl_slist_free_all(headers);
-        curl_easy_cleanup(local_curl);
+    const char *actual_api_url = resolve_api_detection_url(api_url, "API Detection (async)");
+    if (!actual_api_url) {
         return -1;
     }
-    chunk.size = 0;
-    chunk.capacity = API_DETECTION_INITIAL_RESPONSE_BUFFER_SIZE;
-    chunk.memory[0] = '\0';
-
-    curl_easy_setopt(local_curl, CURLOPT_WRITEFUNCTION, write_memory_callback);
-    curl_easy_setopt(local_curl, CURLOPT_WRITEDATA, (void *)&chunk);
-    curl_easy_setopt(local_curl, CURLOPT_TIMEOUT, API_DETECTION_TIMEOUT_SECONDS);
-    setup_common_curl_options(local_curl);
-
-    // Perform the request
-    CURLcode res = curl_easy_perform(local_curl);
-
-    if (res != CURLE_OK) {
-        log_error("API Detection (snapshot): curl_easy_perform() failed: %s", curl_easy_strerror(res));
-        log_tls_error_details("API Detection (snapshot)", local_curl, res, url_with_params);
-        free(chunk.memory);
-        curl_mime_free(mime);
-        curl_slist_free_all(headers);
-        curl_easy_cleanup(local_curl);
-        return -1;
-    }
-
-    // Check HTTP response code
-    long http_code = 0;
-    curl_easy_getinfo(local_curl, CURLINFO_RESPONSE_CODE, &http_code);
 
-    if (http_code != 200) {
-        log_error("API Detection (snapshot): HTTP error %ld", http_code);
-        free(chunk.memory);
-        curl_mime_free(mime);
-        curl_slist_free_all(headers);
-        curl_easy_cleanup(local_curl);
-        return -1;
-    }
-
-    // Parse JSON response
-    if (!chunk.memory || chunk.size == 0) {
-        log_error("API Detection (snapshot): Empty response");
-        free(chunk.memory);
-        curl_mime_free(mime);
-        curl_slist_free_all(headers);
-        curl_easy_cleanup(local_curl);
-        return -1;
+    if (!go2rtc_integration_is_initialized()) {
+        return -2;  // go2rtc not available, caller should fall back
     }
 
-    cJSON *root = cJSON_Parse(chunk.memory);
-    if (!root) {
-        log_error("API Detection (snapshot): Failed to parse JSON response");
-        free(chunk.memory);
-        curl_mime_free(mime);
-        curl_slist_free_all(headers);
-        curl_easy_cleanup(local_curl);
-        return -1;
+    snapshot_t *snapshot = snapshot_cache_get(stream_name, -1);
+    if (!snapshot) {
+        log_warn("API Detection (async): Failed to get snapshot from go2rtc for stream %s", stream_name);
+        return -2;
     }
 
-    // Extract detections
-    cJSON *detections = cJSON_GetObjectItem(root, "detections");
-    if (!detections || !cJSON_IsArray(detections)) {
-        log_error("API Detection (snapshot): Invalid JSON response");
-        cJSON_Delete(root);
-        free(chunk.memory);
-        curl_mime_free(mime);
-        curl_slist_free_all(headers);
-        curl_easy_cleanup(local_curl);
+    const char *backend = sanitize_backend(g_config.api_detection_backend);
+    char url_with_params[1024];
+    if (build_api_detection_url(url_with_params, sizeof(url_with_params), actual_api_url,
+                                backend, threshold, false) != 0) {
+        log_error("API Detection (async): Failed to construct URL with parameters.");
+        snapshot_release(snapshot);
         return -1;
     }
 
-    // Process each detection
-    int array_size = cJSON_GetArraySize(detections);
-    for (int i = 0; i < array_size; i++) {
-        if (result->count >= MAX_DETECTIONS) {
-            log_warn("API Detection (snapshot): Maximum detections reached");
-            break;
-        }
-
-        cJSON *detection = cJSON_GetArrayItem(detections, i);
-        if (!detection) continue;
+    size_t jpeg_size = snapshot->size;
+    int ret = api_detection_client_submit(stream_name, url_with_params, backend,
+                                          snapshot->data, jpeg_size, callback, user_data);
+    snapshot_release(snapshot);
 
-        cJSON *label = cJSON_GetObjectItem(detection, "label");
-        cJSON *confidence = cJSON_GetObjectItem(detection, "confidence");
-
-        cJSON *bounding_box = cJSON_GetObjectItem(detection, "bounding_box");
-        cJSON *x_min = NULL, *y_min = NULL, *x_max = NULL, *y_max = NULL;
-
-        if (bounding_box) {
-            x_min = cJSON_GetObjectItem(bounding_box, "x_min");
-            y_min = cJSON_GetObjectItem(bounding_box, "y_min");
-            x_max = cJSON_GetObjectItem(bounding_box, "x_max");
-            y_max = cJSON_GetObjectItem(bounding_box, "y_max");
-        } else {
-            x_min = cJSON_GetObjectItem(detection, "x_min");
-            y_min = cJSON_GetObjectItem(detection, "y_min");
-            x_max = cJSON_GetObjectItem(detection, "x_max");
-            y_max = cJSON_GetObjectItem(detection, "y_max");
-        }
-
-        if (!label || !cJSON_IsString(label) ||
-            !confidence || !cJSON_IsNumber(confidence) ||
-            !x_min || !cJSON_IsNumber(x_min) ||
-            !y_min || !cJSON_IsNumber(y_min) ||
-            !x_max || !cJSON_IsNumber(x_max) ||
-            !y_max || !cJSON_IsNumber(y_max)) {
-            continue;
-        }
-
-        // Add detection to result
-        safe_strcpy(result->detections[result->count].label, label->valuestring, MAX_LABEL_LENGTH, 0);
-        result->detections[result->count].confidence = (float)confidence->valuedouble;
-        result->detections[result->count].x = (float)x_min->valuedouble;
-        result->detections[result->count].y = (float)y_min->valuedouble;
-        result->detections[result->count].width = (float)(x_max->valuedouble - x_min->valuedouble);
-        result->detections[result->count].height = (float)(y_max->valuedouble - y_min->valuedouble);
-
-        cJSON *track_id = cJSON_GetObjectItem(detection, "track_id");
-        result->detections[result->count].track_id = (track_id && cJSON_IsNumber(track_id))
-            ? (int)track_id->valuedouble : -1;
-
-        cJSON *zone_id = cJSON_GetObjectItem(detection, "zone_id");
-        if (zone_id && cJSON_IsString(zone_id)) {
-            safe_strcpy(result->detections[result->count].zone_id, zone_id->valuestring, MAX_ZONE_ID_LENGTH, 0);
-        } else {
-            result->detections[result->count].zone_id[0] = '\0';
-        }
-
-        result->count++;
+    if (ret == 0) {
+        log_debug("API Detection (async): Queued %zu byte snapshot of stream %s", jpeg_size, stream_name);
     }
-
-    // Filter by zones and store in database
-    if (stream_name && stream_name[0] != '\0') {
-        log_info("API Detection (snapshot): Filtering %d detections by zones for stream %s",
-                 result->count, stream_name);
-        if (filter_detections_by_zones(stream_name, result) != 0) {
-            log_error("API Detection (snapshot): Failed to filter detections by zones for stream %s",
-                      stream_name);
-
-            // Clean up on error to avoid leaking resources
-            cJSON_Delete(root);
-            free(chunk.memory);
-            curl_mime_free(mime);
-            curl_slist_free_all(headers);
-            curl_easy_cleanup(local_curl);
-
-            return -1;
-        }
-
-        // Filter detections by per-stream object include/exclude lists
-        filter_detections_by_stream_objects(stream_name, result);
-
-        time_t timestamp = time(NULL);
-        store_detections_in_db(stream_name, result, timestamp, recording_id);
-
-        // Publish to MQTT if enabled
-        if (result->count > 0) {
-            mqtt_publish_detection(stream_name, result, timestamp);
-            mqtt_set_motion_state(stream_name, result);
-        }
-    }
-
-    // Clean up
-    cJSON_Delete(root);
-    free(chunk.memory);
-    curl_mime_free(mime);
-    curl_slist_free_all(headers);
-    curl_easy_cleanup(local_curl);
-
-    log_info("API Detection (snapshot): Successfully detected %d objects", result->count);
-    return 0;
+    return ret;
 }
@@ -0,0 +1,901 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <time.h>
+#include <curl/curl.h>
+
+#include "core/logger.h"
+#include "core/config.h"
+#include "core/curl_init.h"
+#include "utils/strings.h"
+#include "video/api_detection_client.h"
+
+// Timeout (in seconds) for API detection HTTP requests.
+#define API_DETECTION_TIMEOUT_SECONDS 10L
+
+// Initial buffer size (in bytes) for CURL responses to reduce realloc churn.
+#define API_DETECTION_INITIAL_RESPONSE_BUFFER_SIZE 1024
+
+// Idle easy handles kept for reuse
+#define API_DETECTION_HANDLE_POOL_SIZE 32
+
+// Connections the multi handle keeps open per detection server
+#define API_DETECTION_MAX_HOST_CONNECTIONS 8
+
+// Poll timeout of the worker when nothing wakes it up (ms)
+#define API_DETECTION_POLL_TIMEOUT_MS 1000
+
+// curl_multi_poll()/curl_multi_wakeup() appeared in libcurl 7.68.0
+#if LIBCURL_VERSION_NUM >= 0x074400
+#define API_DETECTION_HAVE_MULTI_WAKEUP 1
+#else
+#define API_DETECTION_HAVE_MULTI_WAKEUP 0
+#define API_DETECTION_FALLBACK_WAIT_MS 50
+#endif
+
+// One queued or in-flight request
+typedef struct api_request {
+    struct api_request *next;
+    CURL *easy;
+    curl_mime *mime;
+    char stream_name[MAX_STREAM_NAME];
+    char backend[32];
+    char url[1024];
+    char *response;
+    size_t response_size;
+    size_t response_capacity;
+    api_detection_complete_cb callback;
+    void *user_data;
+    struct timespec submitted;
+    bool counted;           // Counts toward the stream's in-flight limit
+    bool cancelled;         // Dropped by api_detection_client_cancel()
+    CURLcode result;        // Transfer result once the request is on completed_head
+} api_request_t;
+
+// Per-stream in-flight counter
+typedef struct {
+    char stream_name[MAX_STREAM_NAME];
+    int inflight;
+} stream_inflight_t;
+
+// Per-backend latency histogram
+typedef struct {
+    char backend[32];
+    atomic_uint_fast64_t buckets[API_DETECTION_LATENCY_BUCKETS];
+    atomic_uint_fast64_t count;
+    atomic_uint_fast64_t errors;
+    atomic_uint_fast64_t sum_us;
+} latency_slot_t;
+
+static const double latency_bounds_ms[API_DETECTION_LATENCY_BUCKETS - 1] = {
+    10.0, 25.0, 50.0, 100.0, 250.0, 500.0, 1000.0, 2500.0, 5000.0, 10000.0
+};
+
+// Client state: everything below is guarded by client_mutex, except the
+// multi handle, which only the worker thread touches.
+static pthread_mutex_t client_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t client_cond = PTHREAD_COND_INITIALIZER;
+static pthread_t worker_thread;
+static bool worker_running = false;
+static bool stop_requested = false;
+static CURLM *multi = NULL;
+static struct curl_slist *accept_headers = NULL;
+static api_request_t *pending_head = NULL;    // Submitted, not yet added to the multi handle
+static api_request_t *pending_tail = NULL;
+static api_request_t *active_head = NULL;     // Added to the multi handle
+static api_request_t *completed_head = NULL;  // Finished, callback not yet started
+static CURL *handle_pool[API_DETECTION_HANDLE_POOL_SIZE];
+static int handle_pool_count = 0;
+static stream_inflight_t stream_inflight[MAX_STREAMS];
+static const char *callback_stream = NULL;    // Stream whose callback is running, if any
+
+static latency_slot_t latency_slots[API_DETECTION_LATENCY_MAX_BACKENDS];
+static atomic_int latency_slot_count = 0;
+static pthread_mutex_t latency_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static double elapsed_ms(const struct timespec *since) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)(now.tv_sec - since->tv_sec) * 1000.0 +
+           (double)(now.tv_nsec - since->tv_nsec) / 1000000.0;
+}
+
+// Wake the worker out of curl_multi_poll(). Callable from any thread.
+static void wake_worker(void) {
+#if API_DETECTION_HAVE_MULTI_WAKEUP
+    pthread_mutex_lock(&client_mutex);
+    if (multi) {
+        curl_multi_wakeup(multi);
+    }
+    pthread_mutex_unlock(&client_mutex);
+#endif
+}
+
+// Callback function for curl to write data
+static size_t write_response_callback(void *contents, size_t size, size_t nmemb, void *userp) {
+    if (nmemb != 0 && size > (SIZE_MAX / nmemb)) {
+        log_error("Not enough memory for curl response (size overflow)");
+        return 0;
+    }
+
+    size_t realsize = size * nmemb;
+    api_request_t *req = (api_request_t *)userp;
+
+    if (realsize > SIZE_MAX - req->response_size - 1) {
+        log_error("Not enough memory for curl response (size overflow)");
+        return 0;
+    }
+
+    size_t required_size = req->response_size + realsize + 1;
+    if (required_size > req->response_capacity) {
+        size_t new_capacity = req->response_capacity > 0
+            ? req->response_capacity : API_DETECTION_INITIAL_RESPONSE_BUFFER_SIZE;
+        while (new_capacity < required_size) {
+            if (new_capacity > (SIZE_MAX / 2)) {
+                new_capacity = required_size;
+                break;
+            }
+            new_capacity *= 2;
+        }
+
+        char *new_memory = realloc(req->response, new_capacity);
+        if (new_memory == NULL) {
+            log_error("Not enough memory for curl response");
+            return 0;
+        }
+
+        req->response = new_memory;
+        req->response_capacity = new_capacity;
+    }
+
+    memcpy(&(req->response[req->response_size]), contents, realsize);
+    req->response_size += realsize;
+    req->response[req->response_size] = 0;
+
+    return realsize;
+}
+
+static bool is_tls_ca_error(CURLcode res) {
+#ifdef CURLE_SSL_CACERT_BADFILE
+    if (res == CURLE_SSL_CACERT_BADFILE) {
+        return true;
+    }
+#endif
+#ifdef CURLE_SSL_CACERT
+    if (res == CURLE_SSL_CACERT) {
+        return true;
+    }
+#endif
+#ifdef CURLE_PEER_FAILED_VERIFICATION
+    if (res == CURLE_PEER_FAILED_VERIFICATION) {
+        return true;
+    }
+#endif
+    return false;
+}
+
+static void log_transfer_error(const api_request_t *req, CURLcode res) {
+    log_error("API Detection: request for stream %s failed: %s",
+              req->stream_name[0] ? req->stream_name : "(none)", curl_easy_strerror(res));
+
+    if (res == CURLE_COULDNT_CONNECT) {
+        log_error("API Detection: Could not connect to server at %s. Is the API server running?", req->url);
+    } else if (res == CURLE_OPERATION_TIMEDOUT) {
+        log_error("API Detection: Connection to %s timed out. Server might be slow or unreachable.", req->url);
+    } else if (res == CURLE_COULDNT_RESOLVE_HOST) {
+        log_error("API Detection: Could not resolve host %s. Check your network connection and DNS settings.", req->url);
+    }
+
+    if (!is_tls_ca_error(res)) {
+        return;
+    }
+
+    long ssl_verify_result = 0;
+    curl_easy_getinfo(req->easy, CURLINFO_SSL_VERIFYRESULT, &ssl_verify_result);
+
+    const char *ssl_cert_file = getenv("SSL_CERT_FILE");
+    const char *ssl_cert_dir = getenv("SSL_CERT_DIR");
+
+    log_error("API Detection: TLS certificate verification failed for %s", req->url);
+    log_error("API Detection: libcurl SSL verify result=%ld, SSL_CERT_FILE=%s, SSL_CERT_DIR=%s",
+              ssl_verify_result,
+              (ssl_cert_file && ssl_cert_file[0] != '\0') ? ssl_cert_file : "(unset)",
+              (ssl_cert_dir && ssl_cert_dir[0] != '\0') ? ssl_cert_dir : "(unset)");
+    log_error("API Detection: Ensure a readable CA bundle is installed (for containers, install ca-certificates) or configure SSL_CERT_FILE/SSL_CERT_DIR to valid paths.");
+}
+
+/* ------------------------------------------------------------------ */
+/*  Latency histograms                                                  */
+/* ------------------------------------------------------------------ */
+
+static latency_slot_t *find_latency_slot(const char *backend) {
+    int count = atomic_load(&latency_slot_count);
+    for (int i = 0; i < count; i++) {
+        if (strcmp(latency_slots[i].backend, backend) == 0) {
+            return &latency_slots[i];
+        }
+    }
+
+    pthread_mutex_lock(&latency_mutex);
+    count = atomic_load(&latency_slot_count);
+    for (int i = 0; i < count; i++) {
+        if (strcmp(latency_slots[i].backend, backend) == 0) {
+            pthread_mutex_unlock(&latency_mutex);
+            return &latency_slots[i];
+        }
+    }
+
+    latency_slot_t *slot = NULL;
+    if (count < API_DETECTION_LATENCY_MAX_BACKENDS) {
+        slot = &latency_slots[count];
+        safe_strcpy(slot->backend, backend, sizeof(slot->backend), 0);
+        // Publish the slot only after its name is written
+        atomic_store(&latency_slot_count, count + 1);
+    }
+    pthread_mutex_unlock(&latency_mutex);
+
+    return slot;
+}
+
+double api_detection_latency_bucket_bound_ms(int bucket) {
+    if (bucket < 0 || bucket >= API_DETECTION_LATENCY_BUCKETS - 1) {
+        return -1.0;
+    }
+    return latency_bounds_ms[bucket];
+}
+
+void api_detection_client_record_latency(const char *backend, double latency_ms, bool failed) {
+    if (!backend || backend[0] == '\0') {
+        backend = "unknown";
+    }
+
+    latency_slot_t *slot = find_latency_slot(backend);
+    if (!slot) {
+        return;
+    }
+
+    if (latency_ms < 0.0) {
+        latency_ms = 0.0;
+    }
+
+    int bucket = API_DETECTION_LATENCY_BUCKETS - 1;
+    for (int i = 0; i < API_DETECTION_LATENCY_BUCKETS - 1; i++) {
+        if (latency_ms <= latency_bounds_ms[i]) {
+            bucket = i;
+            break;
+        }
+    }
+
+    atomic_fetch_add(&slot->buckets[bucket], 1);
+    atomic_fetch_add(&slot->count, 1);
+    atomic_fetch_add(&slot->sum_us, (uint_fast64_t)(latency_ms * 1000.0));
+    if (failed) {
+        atomic_fetch_add(&slot->errors, 1);
+    }
+}
+
+int api_detection_client_get_latency_stats(api_detection_latency_t *out, int max_entries) {
+    if (!out || max_entries <= 0) {
+        return 0;
+    }
+
+    int count = atomic_load(&latency_slot_count);
+    if (count > max_entries) {
+        count = max_entries;
+    }
+
+    for (int i = 0; i < count; i++) {
+        latency_slot_t *slot = &latency_slots[i];
+        safe_strcpy(out[i].backend, slot->backend, sizeof(out[i].backend), 0);
+        for (int b = 0; b < API_DETECTION_LATENCY_BUCKETS; b++) {
+            out[i].buckets[b] = atomic_load(&slot->buckets[b]);
+        }
+        out[i].count = atomic_load(&slot->count);
+        out[i].errors = atomic_load(&slot->errors);
+        out[i].sum_ms = (double)atomic_load(&slot->sum_us) / 1000.0;
+    }
+
+    return count;
+}
+
+/* ------------------------------------------------------------------ */
+/*  Request bookkeeping (client_mutex held)                             */
+/* ------------------------------------------------------------------ */
+
+static stream_inflight_t *find_stream_inflight(const char *stream_name, bool create) {
+    stream_inflight_t *free_slot = NULL;
+
+    for (int i = 0; i < MAX_STREAMS; i++) {
+        if (stream_inflight[i].stream_name[0] == '\0') {
+            if (!free_slot) free_slot = &stream_inflight[i];
+            continue;
+        }
+        if (strcmp(stream_inflight[i].stream_name, stream_name) == 0) {
+            return &stream_inflight[i];
+        }
+    }
+
+    if (create && free_slot) {
+        safe_strcpy(free_slot->stream_name, stream_name, sizeof(free_slot->stream_name), 0);
+        free_slot->inflight = 0;
+        return free_slot;
+    }
+    return NULL;
+}
+
+static void release_stream_inflight(const api_request_t *req) {
+    if (!req->counted) {
+        return;
+    }
+
+    stream_inflight_t *entry = find_stream_inflight(req->stream_name, false);
+    if (entry && --entry->inflight <= 0) {
+        entry->stream_name[0] = '\0';
+        entry->inflight = 0;
+    }
+}
+
+static CURL *take_pooled_handle(void) {
+    if (handle_pool_count > 0) {
+        return handle_pool[--handle_pool_count];
+    }
+    return NULL;
+}
+
+static void return_pooled_handle(CURL *easy) {
+    if (!easy) {
+        return;
+    }
+    if (handle_pool_count < API_DETECTION_HANDLE_POOL_SIZE) {
+        curl_easy_reset(easy);
+        handle_pool[handle_pool_count++] = easy;
+    } else {
+        curl_easy_cleanup(easy);
+    }
+}
+
+static void unlink_request(api_request_t **head, api_request_t *req) {
+    for (api_request_t **p = head; *p; p = &(*p)->next) {
+        if (*p == req) {
+            *p = req->next;
+            req->next = NULL;
+            return;
+        }
+    }
+}
+
+// Queue a finished request for delivery, keeping completion order; client_mutex must be held
+static void push_completed_locked(api_request_t *req, CURLcode res) {
+    api_request_t **p = &completed_head;
+    while (*p) {
+        p = &(*p)->next;
+    }
+    req->result = res;
+    req->next = NULL;
+    *p = req;
+}
+
+// Free a finished request; client_mutex must be held
+static void free_request_locked(api_request_t *req) {
+    release_stream_inflight(req);
+    curl_mime_free(req->mime);
+    return_pooled_handle(req->easy);
+    free(req->response);
+    free(req);
+}
+
+/* ------------------------------------------------------------------ */
+/*  Worker thread                                                       */
+/* ------------------------------------------------------------------ */
+
+// Report a finished request to its owner and recycle it (worker thread only)
+//
+// The request stays on completed_head until this takes client_mutex, so a
+// concurrent api_detection_client_cancel() either marks it cancelled or
+// finds callback_stream set and waits for the callback to return.
+static void complete_request(api_request_t *req) {
+    CURLcode res = req->result;
+    api_detection_response_t response = {0};
+    response.latency_ms = elapsed_ms(&req->submitted);
+
+    if (res == CURLE_OK) {
+        curl_easy_getinfo(req->easy, CURLINFO_RESPONSE_CODE, &response.http_code);
+        response.status = 0;
+        response.body = req->response;
+        response.body_len = req->response_size;
+    } else {
+        response.status = -1;
+        if (res != CURLE_ABORTED_BY_CALLBACK) {
+            log_transfer_error(req, res);
+        }
+    }
+
+    pthread_mutex_lock(&client_mutex);
+    unlink_request(&completed_head, req);
+    bool cancelled = req->cancelled;
+    if (!cancelled) {
+        callback_stream = req->stream_name;
+    }
+    // Free the in-flight slot first so the callback may submit the next request
+    release_stream_inflight(req);
+    req->counted = false;
+    pthread_mutex_unlock(&client_mutex);
+
+    // Cancelled requests say nothing about the backend
+    if (!cancelled) {
+        api_detection_client_record_latency(req->backend, response.latency_ms,
+                                            response.status != 0 || response.http_code != 200);
+    }
+
+    bool deliver = !cancelled && req->callback;
+
+    if (deliver) {
+        req->callback(req->stream_name, &response, req->user_data);
+    }
+
+    pthread_mutex_lock(&client_mutex);
+    callback_stream = NULL;
+    pthread_cond_broadcast(&client_cond);
+    free_request_locked(req);
+    pthread_mutex_unlock(&client_mutex);
+}
+
+// Deliver every request on completed_head (worker thread only)
+static void deliver_completed(void) {
+    for (;;) {
+        pthread_mutex_lock(&client_mutex);
+        api_request_t *req = completed_head;
+        pthread_mutex_unlock(&client_mutex);
+        if (!req) {
+            break;
+        }
+        complete_request(req);
+    }
+}
+
+// Move submitted requests into the multi handle and drop cancelled ones
+static void sync_requests(void) {
+    pthread_mutex_lock(&client_mutex);
+
+    while (pending_head) {
+        api_request_t *req = pending_head;
+        pending_head = req->next;
+        req->next = NULL;
+
+        if (req->cancelled) {
+            push_completed_locked(req, CURLE_ABORTED_BY_CALLBACK);
+            continue;
+        }
+
+        CURLMcode mres = curl_multi_add_handle(multi, req->easy);
+        if (mres != CURLM_OK) {
+            log_error("API Detection: curl_multi_add_handle failed: %s", curl_multi_strerror(mres));
+            push_completed_locked(req, CURLE_ABORTED_BY_CALLBACK);
+            continue;
+        }
+        req->next = active_head;
+        active_head = req;
+    }
+    pending_tail = NULL;
+
+    for (api_request_t **p = &active_head; *p;) {
+        api_request_t *req = *p;
+        if (req->cancelled) {
+            *p = req->next;
+            curl_multi_remove_handle(multi, req->easy);
+            push_completed_locked(req, CURLE_ABORTED_BY_CALLBACK);
+        } else {
+            p = &req->next;
+        }
+    }
+
+    pthread_mutex_unlock(&client_mutex);
+
+    // Cancelled requests are dropped silently; failed adds get an error callback
+    deliver_completed();
+}
+
+static void *api_detection_worker(void *arg) {
+    (void)arg;
+    log_set_thread_context("APIDetection", NULL);
+    log_info("API Detection: client worker started");
+
+    for (;;) {
+        pthread_mutex_lock(&client_mutex);
+        bool stop = stop_requested;
+        pthread_mutex_unlock(&client_mutex);
+        if (stop) {
+            break;
+        }
+
+        sync_requests();
+
+        int still_running = 0;
+        curl_multi_perform(multi, &still_running);
+
+        CURLMsg *msg;
+        int msgs_left = 0;
+        while ((msg = curl_multi_info_read(multi, &msgs_left)) != NULL) {
+            if (msg->msg != CURLMSG_DONE) {
+                continue;
+            }
+
+            CURL *easy = msg->easy_handle;
+            CURLcode res = msg->data.result;
+            api_request_t *req = NULL;
+            curl_easy_getinfo(easy, CURLINFO_PRIVATE, (char **)&req);
+            curl_multi_remove_handle(multi, easy);
+
+            if (req) {
+                pthread_mutex_lock(&client_mutex);
+                unlink_request(&active_head, req);
+                push_completed_locked(req, res);
+                pthread_mutex_unlock(&client_mutex);
+            }
+        }
+        deliver_completed();
+
+#if API_DETECTION_HAVE_MULTI_WAKEUP
+        curl_multi_poll(multi, NULL, 0, API_DETECTION_POLL_TIMEOUT_MS, NULL);
+#else
+        curl_multi_wait(multi, NULL, 0, API_DETECTION_FALLBACK_WAIT_MS, NULL);
+#endif
+    }
+
+    // Abort everything still outstanding; owners get status -1
+    pthread_mutex_lock(&client_mutex);
+    while (active_head) {
+        api_request_t *req = active_head;
+        active_head = req->next;
+        curl_multi_remove_handle(multi, req->easy);
+        push_completed_locked(req, CURLE_ABORTED_BY_CALLBACK);
+    }
+    while (pending_head) {
+        api_request_t *req = pending_head;
+        pending_head = req->next;
+        push_completed_locked(req, CURLE_ABORTED_BY_CALLBACK);
+    }
+    pending_tail = NULL;
+    pthread_mutex_unlock(&client_mutex);
+
+    deliver_completed();
+
+    log_info("API Detection: client worker stopped");
+    return NULL;
+}
+
+/* ------------------------------------------------------------------ */
+/*  Public API                                                          */
+/* ------------------------------------------------------------------ */
+
+int api_detection_client_init(void) {
+    if (curl_init_global() != 0) {
+        log_error("API Detection: Failed to initialize curl global");
+        return -1;
+    }
+
+    pthread_mutex_lock(&client_mutex);
+    if (worker_running) {
+        pthread_mutex_unlock(&client_mutex);
+        return 0;
+    }
+
+    multi = curl_multi_init();
+    if (!multi) {
+        pthread_mutex_unlock(&client_mutex);
+        log_error("API Detection: Failed to create curl multi handle");
+        return -1;
+    }
+    curl_multi_setopt(multi, CURLMOPT_MAX_HOST_CONNECTIONS, (long)API_DETECTION_MAX_HOST_CONNECTIONS);
+    curl_multi_setopt(multi, CURLMOPT_MAXCONNECTS, (long)API_DETECTION_MAX_HOST_CONNECTIONS * 2);
+
+    accept_headers = curl_slist_append(NULL, "accept: application/json");
+    stop_requested = false;
+
+    if (pthread_create(&worker_thread, NULL, api_detection_worker, NULL) != 0) {
+        curl_slist_free_all(accept_headers);
+        accept_headers = NULL;
+        curl_multi_cleanup(multi);
+        multi = NULL;
+        pthread_mutex_unlock(&client_mutex);
+        log_error("API Detection: Failed to start client worker thread");
+        return -1;
+    }
+
+    worker_running = true;
+    pthread_mutex_unlock(&client_mutex);
+
+    log_info("API Detection: client started (max %d in-flight requests per stream)",
+             g_config.api_detection_max_inflight);
+    return 0;
+}
+
+void api_detection_client_shutdown(void) {
+    pthread_mutex_lock(&client_mutex);
+    if (!worker_running) {
+        pthread_mutex_unlock(&client_mutex);
+        return;
+    }
+    stop_requested = true;
+    pthread_mutex_unlock(&client_mutex);
+
+    wake_worker();
+    pthread_join(worker_thread, NULL);
+
+    pthread_mutex_lock(&client_mutex);
+    while (handle_pool_count > 0) {
+        curl_easy_cleanup(handle_pool[--handle_pool_count]);
+    }
+    curl_multi_cleanup(multi);
+    multi = NULL;
+    curl_slist_free_all(accept_headers);
+    accept_headers = NULL;
+    memset(stream_inflight, 0, sizeof(stream_inflight));
+    worker_running = false;
+    pthread_mutex_unlock(&client_mutex);
+}
+
+bool api_detection_client_is_running(void) {
+    pthread_mutex_lock(&client_mutex);
+    bool running = worker_running && !stop_requested;
+    pthread_mutex_unlock(&client_mutex);
+    return running;
+}
+
+// Build a request on a pooled easy handle; client_mutex must NOT be held
+static api_request_t *create_request(const char *stream_name, const char *url, const char *backend,
+                                     const unsigned char *jpeg_data, size_t jpeg_size,
+                                     api_detection_complete_cb callback, void *user_data) {
+    api_request_t *req = calloc(1, sizeof(api_request_t));
+    if (!req) {
+        log_error("API Detection: Failed to allocate request");
+        return NULL;
+    }
+
+    safe_strcpy(req->stream_name, stream_name ? stream_name : "", sizeof(req->stream_name), 0);
+    safe_strcpy(req->backend, backend ? backend : "unknown", sizeof(req->backend), 0);
+    if (strlen(url) >= sizeof(req->url)) {
+        log_error("API Detection: Request URL too long");
+        free(req);
+        return NULL;
+    }
+    safe_strcpy(req->url, url, sizeof(req->url), 0);
+    req->callback = callback;
+    req->user_data = user_data;
+
+    pthread_mutex_lock(&client_mutex);
+    req->easy = take_pooled_handle();
+    pthread_mutex_unlock(&client_mutex);
+    if (!req->easy) {
+        req->easy = curl_easy_init();
+    }
+    if (!req->easy) {
+        log_error("API Detection: Failed to initialize CURL handle");
+        free(req);
+        return NULL;
+    }
+
+    // Multipart body: one "file" part; curl_mime_data copies the JPEG
+    req->mime = curl_mime_init(req->easy);
+    curl_mimepart *part = req->mime ? curl_mime_addpart(req->mime) : NULL;
+    if (!part ||
+        curl_mime_name(part, "file") != CURLE_OK ||
+        curl_mime_data(part, (const char *)jpeg_data, jpeg_size) != CURLE_OK ||
+        curl_mime_filename(part, "snapshot.jpg") != CURLE_OK ||
+        curl_mime_type(part, "image/jpeg") != CURLE_OK) {
+        log_error("API Detection: Failed to build multipart request");
+        pthread_mutex_lock(&client_mutex);
+        free_request_locked(req);
+        pthread_mutex_unlock(&client_mutex);
+        return NULL;
+    }
+
+    CURL *easy = req->easy;
+    curl_easy_setopt(easy, CURLOPT_URL, req->url);
+    curl_easy_setopt(easy, CURLOPT_MIMEPOST, req->mime);
+    curl_easy_setopt(easy, CURLOPT_HTTPHEADER, accept_headers);
+    curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, write_response_callback);
+    curl_easy_setopt(easy, CURLOPT_WRITEDATA, (void *)req);
+    curl_easy_setopt(easy, CURLOPT_PRIVATE, (void *)req);
+    curl_easy_setopt(easy, CURLOPT_TIMEOUT, API_DETECTION_TIMEOUT_SECONDS);
+    curl_easy_setopt(easy, CURLOPT_TCP_KEEPALIVE, 1L);
+    // Prevent curl from using signals (required for multi-threaded apps)
+    curl_easy_setopt(easy, CURLOPT_NOSIGNAL, 1L);
+    // API detection URLs are admin-configured and commonly point to localhost/private services,
+    // so we explicitly disable redirects instead of blocking private address ranges.
+    curl_easy_setopt(easy, CURLOPT_FOLLOWLOCATION, 0L);
+#if defined(CURLOPT_PROTOCOLS_STR) && defined(CURLOPT_REDIR_PROTOCOLS_STR)
+    curl_easy_setopt(easy, CURLOPT_PROTOCOLS_STR, "http,https");
+    curl_easy_setopt(easy, CURLOPT_REDIR_PROTOCOLS_STR, "http,https");
+#elif defined(CURLOPT_PROTOCOLS) && defined(CURLOPT_REDIR_PROTOCOLS)
+    curl_easy_setopt(easy, CURLOPT_PROTOCOLS, CURLPROTO_HTTP | CURLPROTO_HTTPS);
+    curl_easy_setopt(easy, CURLOPT_REDIR_PROTOCOLS, CURLPROTO_HTTP | CURLPROTO_HTTPS);
+#endif
+
+    return req;
+}
+
+// Queue a request; counted requests are checked against the stream's in-flight limit
+static int enqueue_request(api_request_t *req, bool counted) {
+    pthread_mutex_lock(&client_mutex);
+
+    if (!worker_running || stop_requested) {
+        free_request_locked(req);
+        pthread_mutex_unlock(&client_mutex);
+        log_error("API Detection: client is not running");
+        return -1;
+    }
+
+    if (counted && req->stream_name[0] != '\0') {
+        stream_inflight_t *entry = find_stream_inflight(req->stream_name, true);
+        if (!entry) {
+            free_request_locked(req);
+            pthread_mutex_unlock(&client_mutex);
+            log_error("API Detection: Too many streams with requests in flight");
+            return -1;
+        }
+
+        int limit = g_config.api_detection_max_inflight;
+        if (limit < 1) limit = 1;
+        if (entry->inflight >= limit) {
+            free_request_locked(req);
+            pthread_mutex_unlock(&client_mutex);
+            return API_DETECTION_CLIENT_BUSY;
+        }
+        entry->inflight++;
+        req->counted = true;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &req->submitted);
+    if (pending_tail) {
+        pending_tail->next = req;
+    } else {
+        pending_head = req;
+    }
+    pending_tail = req;
+
+    pthread_mutex_unlock(&client_mutex);
+
+    wake_worker();
+    return 0;
+}
+
+int api_detection_client_submit(const char *stream_name, const char *url, const char *backend,
+                                const unsigned char *jpeg_data, size_t jpeg_size,
+                                api_detection_complete_cb callback, void *user_data) {
+    if (!stream_name || stream_name[0] == '\0' || !url || !jpeg_data || jpeg_size == 0 || !callback) {
+        log_error("API Detection: Invalid parameters for asynchronous request");
+        return -1;
+    }
+
+    // Check the limit before paying for the multipart copy
+    if (api_detection_client_inflight(stream_name) >= g_config.api_detection_max_inflight) {
+        return API_DETECTION_CLIENT_BUSY;
+    }
+
+    api_request_t *req = create_request(stream_name, url, backend, jpeg_data, jpeg_size,
+                                        callback, user_data);
+    if (!req) {
+        return -1;
+    }
+
+    return enqueue_request(req, true);
+}
+
+// Rendezvous between api_detection_client_perform() and the worker
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    bool done;
+    int status;
+    long http_code;
+    char *body;
+    size_t body_len;
+} sync_waiter_t;
+
+static void sync_request_complete(const char *stream_name, const api_detection_response_t *response,
+                                  void *user_data) {
+    (void)stream_name;
+    sync_waiter_t *waiter = (sync_waiter_t *)user_data;
+
+    pthread_mutex_lock(&waiter->mutex);
+    waiter->status = response->status;
+    waiter->http_code = response->http_code;
+    if (response->body && response->body_len > 0) {
+        waiter->body = malloc(response->body_len + 1);
+        if (waiter->body) {
+            memcpy(waiter->body, response->body, response->body_len);
+            waiter->body[response->body_len] = '\0';
+            waiter->body_len = response->body_len;
+        }
+    }
+    waiter->done = true;
+    pthread_cond_signal(&waiter->cond);
+    pthread_mutex_unlock(&waiter->mutex);
+}
+
+int api_detection_client_perform(const char *stream_name, const char *url, const char *backend,
+                                 const unsigned char *jpeg_data, size_t jpeg_size,
+                                 long *http_code, char **body, size_t *body_len) {
+    if (!url || !jpeg_data || jpeg_size == 0 || !http_code || !body || !body_len) {
+        return -1;
+    }
+    *http_code = 0;
+    *body = NULL;
+    *body_len = 0;
+
+    sync_waiter_t waiter = {0};
+    pthread_mutex_init(&waiter.mutex, NULL);
+    pthread_cond_init(&waiter.cond, NULL);
+    waiter.status = -1;
+
+    int ret = -1;
+    api_request_t *req = create_request(stream_name, url, backend, jpeg_data, jpeg_size,
+                                        sync_request_complete, &waiter);
+    if (req && enqueue_request(req, false) == 0) {
+        // The worker always completes queued requests, also on shutdown
+        pthread_mutex_lock(&waiter.mutex);
+        while (!waiter.done) {
+            pthread_cond_wait(&waiter.cond, &waiter.mutex);
+        }
+        pthread_mutex_unlock(&waiter.mutex);
+
+        *http_code = waiter.http_code;
+        *body = waiter.body;
+        *body_len = waiter.body_len;
+        ret = waiter.status;
+    }
+
+    pthread_cond_destroy(&waiter.cond);
+    pthread_mutex_destroy(&waiter.mutex);
+    return ret;
+}
+
+void api_detection_client_cancel(const char *stream_name) {
+    if (!stream_name || stream_name[0] == '\0') {
+        return;
+    }
+
+    bool found = false;
+    pthread_mutex_lock(&client_mutex);
+
+    api_request_t *lists[3] = {pending_head, active_head, completed_head};
+    for (int l = 0; l < 3; l++) {
+        for (api_request_t *req = lists[l]; req; req = req->next) {
+            // Only counted (asynchronous) requests; synchronous callers are waiting on theirs
+            if (req->counted && strcmp(req->stream_name, stream_name) == 0) {
+                req->cancelled = true;
+                found = true;
+            }
+        }
+    }
+
+    // A callback for this stream may already be running on the worker
+    while (callback_stream && strcmp(callback_stream, stream_name) == 0) {
+        pthread_cond_wait(&client_cond, &client_mutex);
+    }
+
+    pthread_mutex_unlock(&client_mutex);
+
+    if (found) {
+        log_debug("API Detection: cancelled outstanding requests for stream %s", stream_name);
+        wake_worker();
+    }
+}
+
+int api_detection_client_inflight(const char *stream_name) {
+    if (!stream_name || stream_name[0] == '\0') {
+        return 0;
+    }
+
+    pthread_mutex_lock(&client_mutex);
+    stream_inflight_t *entry = find_stream_inflight(stream_name, false);
+    int inflight = entry ? entry->inflight : 0;
+    pthread_mutex_unlock(&client_mutex);
+
+    return inflight;
+}
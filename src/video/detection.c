@@ -25,6 +25,7 @@
 #include "../../include/video/motion_detection.h"
 #include "../../include/video/api_detection.h"
 #include "../../include/video/onvif_detection.h"
+#include "../../include/video/frame_bus.h"
 #include "../../include/video/unified_detection_thread.h"
 #include "../../include/video/ffmpeg_utils.h"  // For comprehensive_ffmpeg_cleanup
 #include "../../include/core/logger.h"
@@ -76,6 +77,15 @@ int init_detection_system(void) {
         log_warn("ONVIF detection will not be available");
     }
 
+    // Initialize the shared-memory frame bus for local detectors
+    if (g_config.frame_bus_enabled) {
+        size_t max_frame_bytes = (size_t)g_config.frame_bus_max_width * g_config.frame_bus_max_height * 3;
+        if (frame_bus_init(g_config.frame_bus_socket_path, g_config.frame_bus_slots, max_frame_bytes) != 0) {
+            log_error("Failed to initialize frame bus");
+            log_warn("Frame bus detection will not be available");
+        }
+    }
+
     // Initialize unified detection thread system
     int unified_ret = init_unified_detection_system();
     if (unified_ret != 0) {
@@ -103,6 +113,9 @@ void shutdown_detection_system(void) {
     // Shutdown API detection system
     shutdown_api_detection_system();
 
+    // Disconnect local detectors from the frame bus
+    frame_bus_shutdown();
+
     // Shutdown ONVIF detection system
     shutdown_onvif_detection_system();
 
@@ -0,0 +1,262 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "core/logger.h"
+#include "core/config.h"
+#include "utils/strings.h"
+#include "video/detection_cascade.h"
+
+// Fraction of a detection's area that must lie inside the previous stage's
+// regions for it to be kept. Motion regions are coarse grid cells, so any
+// real overlap counts.
+#define CASCADE_MIN_REGION_OVERLAP 0.1f
+
+// Per-stream stage counters
+typedef struct {
+    char stream_name[MAX_STREAM_NAME];
+    int stage_count;
+    cascade_stage_stats_t stages[DETECTION_CASCADE_MAX_STAGES];
+} cascade_stream_stats_t;
+
+static cascade_stream_stats_t stream_stats[MAX_STREAMS];
+static pthread_mutex_t stats_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+bool is_detection_cascade(const char *model_path) {
+    return model_path &&
+           strncmp(model_path, DETECTION_CASCADE_PREFIX, strlen(DETECTION_CASCADE_PREFIX)) == 0;
+}
+
+static int parse_stage(const char *token, const char *models_dir, cascade_stage_t *stage) {
+    if (strcmp(token, "motion") == 0) {
+        stage->kind = CASCADE_STAGE_MOTION;
+        safe_strcpy(stage->model_path, token, sizeof(stage->model_path), 0);
+        safe_strcpy(stage->name, "motion", sizeof(stage->name), 0);
+    } else if (strcmp(token, "api-detection") == 0 ||
+               strncmp(token, "http://", 7) == 0 || strncmp(token, "https://", 8) == 0) {
+        stage->kind = CASCADE_STAGE_API;
+        safe_strcpy(stage->model_path, token, sizeof(stage->model_path), 0);
+        safe_strcpy(stage->name, "api", sizeof(stage->name), 0);
+    } else if (strcmp(token, "frame-bus") == 0) {
+        stage->kind = CASCADE_STAGE_FRAME_BUS;
+        safe_strcpy(stage->model_path, token, sizeof(stage->model_path), 0);
+        safe_strcpy(stage->name, "frame-bus", sizeof(stage->name), 0);
+    } else if (strcmp(token, "onvif") == 0 || is_detection_cascade(token)) {
+        log_error("Detection cascade: '%s' cannot be a cascade stage", token);
+        return -1;
+    } else {
+        stage->kind = CASCADE_STAGE_MODEL;
+        int len;
+        if (token[0] == '/' || !models_dir || models_dir[0] == '\0') {
+            len = snprintf(stage->model_path, sizeof(stage->model_path), "%s", token);
+        } else {
+            len = snprintf(stage->model_path, sizeof(stage->model_path), "%s/%s", models_dir, token);
+        }
+        if (len < 0 || (size_t)len >= sizeof(stage->model_path)) {
+            log_error("Detection cascade: model path too long: %s", token);
+            return -1;
+        }
+        const char *base = strrchr(token, '/');
+        safe_strcpy(stage->name, base ? base + 1 : token, sizeof(stage->name), 0);
+    }
+    return 0;
+}
+
+int detection_cascade_parse(const char *model_path, const char *models_dir,
+                            detection_cascade_t *cascade) {
+    if (!is_detection_cascade(model_path) || !cascade) {
+        return -1;
+    }
+    memset(cascade, 0, sizeof(*cascade));
+
+    char spec[MAX_PATH_LENGTH];
+    safe_strcpy(spec, model_path + strlen(DETECTION_CASCADE_PREFIX), sizeof(spec), 0);
+
+    char *saveptr = NULL;
+    for (char *token = strtok_r(spec, ",", &saveptr); token; token = strtok_r(NULL, ",", &saveptr)) {
+        token = trim_ascii_whitespace(token);
+        if (token[0] == '\0') {
+            continue;
+        }
+        if (cascade->stage_count == DETECTION_CASCADE_MAX_STAGES) {
+            log_error("Detection cascade: more than %d stages in '%s'",
+                      DETECTION_CASCADE_MAX_STAGES, model_path);
+            return -1;
+        }
+        if (parse_stage(token, models_dir, &cascade->stages[cascade->stage_count]) != 0) {
+            return -1;
+        }
+        cascade->stage_count++;
+    }
+
+    if (cascade->stage_count < 2) {
+        log_error("Detection cascade: '%s' needs at least two stages", model_path);
+        return -1;
+    }
+
+    for (int i = 0; i < cascade->stage_count; i++) {
+        cascade_stage_kind_t kind = cascade->stages[i].kind;
+        if (kind == CASCADE_STAGE_MOTION && i != 0) {
+            log_error("Detection cascade: motion can only be the first stage of '%s'", model_path);
+            return -1;
+        }
+        if ((kind == CASCADE_STAGE_API || kind == CASCADE_STAGE_FRAME_BUS) &&
+            i != cascade->stage_count - 1) {
+            log_error("Detection cascade: %s can only be the last stage of '%s'",
+                      cascade->stages[i].name, model_path);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+bool detection_cascade_has_stage(const detection_cascade_t *cascade, cascade_stage_kind_t kind) {
+    if (!cascade) {
+        return false;
+    }
+    for (int i = 0; i < cascade->stage_count; i++) {
+        if (cascade->stages[i].kind == kind) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static float overlap_area(const detection_t *a, const detection_t *b) {
+    float x1 = a->x > b->x ? a->x : b->x;
+    float y1 = a->y > b->y ? a->y : b->y;
+    float x2 = (a->x + a->width) < (b->x + b->width) ? (a->x + a->width) : (b->x + b->width);
+    float y2 = (a->y + a->height) < (b->y + b->height) ? (a->y + a->height) : (b->y + b->height);
+    if (x2 <= x1 || y2 <= y1) {
+        return 0.0f;
+    }
+    return (x2 - x1) * (y2 - y1);
+}
+
+int detection_cascade_filter_by_regions(detection_result_t *result, const detection_result_t *regions) {
+    if (!result || !regions) {
+        return result ? result->count : 0;
+    }
+
+    int kept = 0;
+    for (int i = 0; i < result->count; i++) {
+        const detection_t *det = &result->detections[i];
+        float area = det->width * det->height;
+        bool inside = false;
+        if (area > 0.0f) {
+            float covered = 0.0f;
+            for (int r = 0; r < regions->count; r++) {
+                covered += overlap_area(det, &regions->detections[r]);
+            }
+            inside = covered >= CASCADE_MIN_REGION_OVERLAP * area;
+        } else {
+            // Degenerate box: keep it if its corner lies inside a region
+            for (int r = 0; r < regions->count && !inside; r++) {
+                const detection_t *reg = &regions->detections[r];
+                inside = det->x >= reg->x && det->x <= reg->x + reg->width &&
+                         det->y >= reg->y && det->y <= reg->y + reg->height;
+            }
+        }
+        if (inside) {
+            if (kept != i) {
+                result->detections[kept] = result->detections[i];
+            }
+            kept++;
+        }
+    }
+    result->count = kept;
+    return kept;
+}
+
+// Find (or claim) a stream's counters; stats_mutex must be held
+static cascade_stream_stats_t *find_stream_stats_locked(const char *stream_name, bool create) {
+    cascade_stream_stats_t *free_slot = NULL;
+    for (int i = 0; i < MAX_STREAMS; i++) {
+        if (stream_stats[i].stream_name[0] == '\0') {
+            if (!free_slot) free_slot = &stream_stats[i];
+        } else if (strcmp(stream_stats[i].stream_name, stream_name) == 0) {
+            return &stream_stats[i];
+        }
+    }
+    if (!create || !free_slot) {
+        return NULL;
+    }
+    memset(free_slot, 0, sizeof(*free_slot));
+    safe_strcpy(free_slot->stream_name, stream_name, sizeof(free_slot->stream_name), 0);
+    return free_slot;
+}
+
+void detection_cascade_record_run(const char *stream_name, const detection_cascade_t *cascade,
+                                  int stage, bool fired, uint64_t elapsed_us) {
+    if (!stream_name || !cascade || stage < 0 || stage >= cascade->stage_count) {
+        return;
+    }
+
+    pthread_mutex_lock(&stats_mutex);
+    cascade_stream_stats_t *s = find_stream_stats_locked(stream_name, true);
+    if (s) {
+        // A changed cascade starts its counters from scratch
+        bool same = s->stage_count == cascade->stage_count;
+        for (int i = 0; same && i < cascade->stage_count; i++) {
+            same = strcmp(s->stages[i].name, cascade->stages[i].name) == 0;
+        }
+        if (!same) {
+            memset(s->stages, 0, sizeof(s->stages));
+            s->stage_count = cascade->stage_count;
+            for (int i = 0; i < cascade->stage_count; i++) {
+                safe_strcpy(s->stages[i].name, cascade->stages[i].name, sizeof(s->stages[i].name), 0);
+            }
+        }
+
+        s->stages[stage].runs++;
+        if (fired) {
+            s->stages[stage].hits++;
+        }
+        s->stages[stage].total_us += elapsed_us;
+    }
+    pthread_mutex_unlock(&stats_mutex);
+}
+
+void detection_cascade_record_hit(const char *stream_name, int stage) {
+    if (!stream_name) {
+        return;
+    }
+
+    pthread_mutex_lock(&stats_mutex);
+    cascade_stream_stats_t *s = find_stream_stats_locked(stream_name, false);
+    if (s && stage >= 0 && stage < s->stage_count) {
+        s->stages[stage].hits++;
+    }
+    pthread_mutex_unlock(&stats_mutex);
+}
+
+int detection_cascade_get_stats(const char *stream_name, cascade_stage_stats_t *out, int max_stages) {
+    if (!stream_name || !out || max_stages <= 0) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&stats_mutex);
+    int n = 0;
+    cascade_stream_stats_t *s = find_stream_stats_locked(stream_name, false);
+    if (s) {
+        n = s->stage_count < max_stages ? s->stage_count : max_stages;
+        memcpy(out, s->stages, sizeof(cascade_stage_stats_t) * (size_t)n);
+    }
+    pthread_mutex_unlock(&stats_mutex);
+    return n;
+}
+
+void detection_cascade_reset_stats(const char *stream_name) {
+    pthread_mutex_lock(&stats_mutex);
+    if (!stream_name) {
+        memset(stream_stats, 0, sizeof(stream_stats));
+    } else {
+        cascade_stream_stats_t *s = find_stream_stats_locked(stream_name, false);
+        if (s) {
+            memset(s, 0, sizeof(*s));
+        }
+    }
+    pthread_mutex_unlock(&stats_mutex);
+}
@@ -217,7 +217,7 @@ static detection_model_t load_tflite_model(const char *model_path, float thresho
     }
 
     // Create model structure
-    model_t *model = (model_t *)malloc(sizeof(model_t));
+    model_t *model = (model_t *)calloc(1, sizeof(model_t));
     if (!model) {
         log_error("Failed to allocate memory for model structure");
         tflite_free_model(tflite_model);
@@ -284,21 +284,22 @@ const char* get_model_type_from_handle(detection_model_t model) {
 /**
  * Clean up old models in the global cache
  *
- * This function is kept for API compatibility but does nothing in the thread-local model approach
+ * This function is kept for API compatibility but does nothing: shared
+ * model weights are freed by the model registry when their last handle is
+ * unloaded
  */
 void cleanup_old_detection_models(time_t max_age) {
-    // This function is now a no-op since we're using thread-local models
-    // Each thread is responsible for managing its own model
-
     // Log memory usage for monitoring
-    log_info("Thread-local model approach: No global cache to clean. Current memory usage: %zu bytes", get_total_memory_allocated());
+    log_info("Model weights are freed with their last handle. Current memory usage: %zu bytes", get_total_memory_allocated());
 }
 
 /**
  * Load a detection model
  *
- * Simplified implementation that directly loads the model without caching
- * Each thread will manage its own model instance
+ * Each call returns a separate handle for the calling thread. Local model
+ * files are loaded once through the model registry (model_registry.h):
+ * handles for the same file share its weights and are moved to a new
+ * version when the file changes on disk.
  */
 detection_model_t load_detection_model(const char *model_path, float threshold) {
     if (!model_path) {
@@ -347,7 +348,7 @@ detection_model_t load_detection_model(const char *model_path, float threshold)
 
     if (strcmp(model_type, MODEL_TYPE_API) == 0) {
         // For API models, we just need to store the URL
-        model_t *m = (model_t *)malloc(sizeof(model_t));
+        model_t *m = (model_t *)calloc(1, sizeof(model_t));
         if (m) {
             safe_strcpy(m->type, MODEL_TYPE_API, sizeof(m->type), 0);
             m->sod = NULL; // We don't need a model handle for API
@@ -358,7 +359,7 @@ detection_model_t load_detection_model(const char *model_path, float threshold)
     }
     else if (strcmp(model_type, MODEL_TYPE_ONVIF) == 0) {
         // For ONVIF models, we just need to store the URL
-        model_t *m = (model_t *)malloc(sizeof(model_t));
+        model_t *m = (model_t *)calloc(1, sizeof(model_t));
         if (m) {
             safe_strcpy(m->type, MODEL_TYPE_ONVIF, sizeof(m->type), 0);
             m->sod = NULL; // We don't need a model handle for ONVIF
@@ -372,7 +373,7 @@ detection_model_t load_detection_model(const char *model_path, float threshold)
     else if (strcmp(model_type, MODEL_TYPE_MOTION) == 0) {
         // For built-in motion detection, we just need a lightweight handle
         // The actual detection is done by detect_motion() in motion_detection.c
-        model_t *m = (model_t *)malloc(sizeof(model_t));
+        model_t *m = (model_t *)calloc(1, sizeof(model_t));
         if (m) {
             safe_strcpy(m->type, MODEL_TYPE_MOTION, sizeof(m->type), 0);
             m->sod = NULL; // No external model handle needed
@@ -386,7 +387,7 @@ detection_model_t load_detection_model(const char *model_path, float threshold)
         void *realnet_model = load_sod_realnet_model(model_path, threshold);
         if (realnet_model) {
             // Create model structure
-            model_t *m = (model_t *)malloc(sizeof(model_t));
+            model_t *m = (model_t *)calloc(1, sizeof(model_t));
             if (m) {
                 safe_strcpy(m->type, MODEL_TYPE_SOD_REALNET, sizeof(m->type), 0);
                 m->sod_realnet = realnet_model;
@@ -398,6 +399,8 @@ detection_model_t load_detection_model(const char *model_path, float threshold)
             }
         }
     } else if (strcmp(model_type, MODEL_TYPE_SOD) == 0) {
+        // Float and INT8 (.int8.sod) CNN models share this loader; the
+        // quantized kernels are selected per model from the weights file
         model = load_sod_model(model_path, threshold);
     } else if (strcmp(model_type, MODEL_TYPE_TFLITE) == 0) {
         model = load_tflite_model(model_path, threshold);
@@ -540,14 +543,12 @@ void unload_detection_model(detection_model_t model) {
 /**
  * Force cleanup of all models in the global cache
  *
- * This function is kept for API compatibility but does nothing in the thread-local model approach
+ * This function is kept for API compatibility; shared model weights are
+ * freed by the model registry when their last handle is unloaded
  */
 void force_cleanup_model_cache(void) {
-    // This function is now a no-op since we're using thread-local models
-    // Each thread is responsible for managing its own model
-
     // Set the shutdown mode flag to true for any remaining cleanup operations
     in_shutdown_mode = true;
 
-    log_info("Thread-local model approach: No global cache to clean up");
+    log_info("Model weights are freed with their last handle; no cache to clean up");
 }
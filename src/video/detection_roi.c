@@ -0,0 +1,208 @@
+#include <string.h>
+
+#include "core/config.h"
+#include "video/detection_roi.h"
+
+// Smallest crop side: a model gains nothing from a crop much smaller than
+// its input, and motion cells can be tiny
+#define ROI_MIN_SIZE 96
+
+// Detections of the same label from two crops that overlap this much are
+// the same object
+#define ROI_DUPLICATE_IOU 0.5f
+
+typedef struct {
+    int x0, y0, x1, y1;     // Half-open pixel rectangle
+} roi_rect_t;
+
+static long long rect_area(const roi_rect_t *r) {
+    return (long long)(r->x1 - r->x0) * (r->y1 - r->y0);
+}
+
+static roi_rect_t rect_union(const roi_rect_t *a, const roi_rect_t *b) {
+    roi_rect_t u = {
+        a->x0 < b->x0 ? a->x0 : b->x0,
+        a->y0 < b->y0 ? a->y0 : b->y0,
+        a->x1 > b->x1 ? a->x1 : b->x1,
+        a->y1 > b->y1 ? a->y1 : b->y1,
+    };
+    return u;
+}
+
+static bool rects_overlap(const roi_rect_t *a, const roi_rect_t *b) {
+    return a->x0 < b->x1 && b->x0 < a->x1 && a->y0 < b->y1 && b->y0 < a->y1;
+}
+
+// Grow a span to at least min_len, shifting it back inside [0, limit)
+static void grow_span(int *lo, int *hi, int min_len, int limit) {
+    if (min_len > limit) {
+        min_len = limit;
+    }
+    int len = *hi - *lo;
+    if (len < min_len) {
+        *lo -= (min_len - len) / 2;
+        *hi = *lo + min_len;
+    }
+    if (*lo < 0) {
+        *hi -= *lo;
+        *lo = 0;
+    }
+    if (*hi > limit) {
+        *lo -= *hi - limit;
+        *hi = limit;
+    }
+    if (*lo < 0) {
+        *lo = 0;
+    }
+}
+
+int detection_roi_plan(const detection_result_t *regions, int frame_width, int frame_height,
+                       detection_roi_t *rois) {
+    if (!g_config.roi_cropping || !regions || regions->count <= 0 || !rois ||
+        frame_width <= 0 || frame_height <= 0) {
+        return 0;
+    }
+
+    int max_rois = g_config.roi_max_regions;
+    if (max_rois > DETECTION_ROI_MAX_REGIONS) max_rois = DETECTION_ROI_MAX_REGIONS;
+    if (max_rois < 1) max_rois = 1;
+
+    int short_side = frame_width < frame_height ? frame_width : frame_height;
+    int min_size = short_side / 8 > ROI_MIN_SIZE ? short_side / 8 : ROI_MIN_SIZE;
+
+    roi_rect_t rects[MAX_DETECTIONS];
+    int n = 0;
+    for (int i = 0; i < regions->count && i < MAX_DETECTIONS; i++) {
+        const detection_t *r = &regions->detections[i];
+        if (r->width <= 0.0f || r->height <= 0.0f) {
+            continue;
+        }
+        float pad_x = r->width * (float)g_config.roi_padding / 100.0f;
+        float pad_y = r->height * (float)g_config.roi_padding / 100.0f;
+        roi_rect_t rect = {
+            (int)((r->x - pad_x) * (float)frame_width),
+            (int)((r->y - pad_y) * (float)frame_height),
+            (int)((r->x + r->width + pad_x) * (float)frame_width + 0.999f),
+            (int)((r->y + r->height + pad_y) * (float)frame_height + 0.999f),
+        };
+        if (rect.x0 < 0) rect.x0 = 0;
+        if (rect.y0 < 0) rect.y0 = 0;
+        if (rect.x1 > frame_width) rect.x1 = frame_width;
+        if (rect.y1 > frame_height) rect.y1 = frame_height;
+        if (rect.x1 <= rect.x0 || rect.y1 <= rect.y0) {
+            continue;
+        }
+        grow_span(&rect.x0, &rect.x1, min_size, frame_width);
+        grow_span(&rect.y0, &rect.y1, min_size, frame_height);
+        rects[n++] = rect;
+    }
+    if (n == 0) {
+        return 0;
+    }
+
+    // Merge overlapping crops so no pixel is scanned twice
+    bool merged = true;
+    while (merged) {
+        merged = false;
+        for (int i = 0; i < n && !merged; i++) {
+            for (int j = i + 1; j < n && !merged; j++) {
+                if (rects_overlap(&rects[i], &rects[j])) {
+                    rects[i] = rect_union(&rects[i], &rects[j]);
+                    rects[j] = rects[--n];
+                    merged = true;
+                }
+            }
+        }
+    }
+
+    // Too many crops: merge the pair whose union adds the least extra area
+    while (n > max_rois) {
+        int best_i = 0;
+        int best_j = 1;
+        long long best_cost = -1;
+        for (int i = 0; i < n; i++) {
+            for (int j = i + 1; j < n; j++) {
+                roi_rect_t u = rect_union(&rects[i], &rects[j]);
+                long long cost = rect_area(&u) - rect_area(&rects[i]) - rect_area(&rects[j]);
+                if (best_cost < 0 || cost < best_cost) {
+                    best_cost = cost;
+                    best_i = i;
+                    best_j = j;
+                }
+            }
+        }
+        rects[best_i] = rect_union(&rects[best_i], &rects[best_j]);
+        rects[best_j] = rects[--n];
+    }
+
+    // Unions may overlap again; an overestimate here only errs towards the full frame
+    long long covered = 0;
+    for (int i = 0; i < n; i++) {
+        covered += rect_area(&rects[i]);
+    }
+    if (covered * 100 > (long long)g_config.roi_max_coverage * frame_width * frame_height) {
+        return 0;
+    }
+
+    for (int i = 0; i < n; i++) {
+        rois[i].x = rects[i].x0;
+        rois[i].y = rects[i].y0;
+        rois[i].width = rects[i].x1 - rects[i].x0;
+        rois[i].height = rects[i].y1 - rects[i].y0;
+    }
+    return n;
+}
+
+void detection_roi_crop(const uint8_t *frame, int frame_width, int channels,
+                        const detection_roi_t *roi, uint8_t *dst) {
+    size_t src_stride = (size_t)frame_width * channels;
+    size_t row_bytes = (size_t)roi->width * channels;
+    const uint8_t *src = frame + (size_t)roi->y * src_stride + (size_t)roi->x * channels;
+    for (int row = 0; row < roi->height; row++) {
+        memcpy(dst + (size_t)row * row_bytes, src + (size_t)row * src_stride, row_bytes);
+    }
+}
+
+void detection_roi_map_to_frame(detection_result_t *result, const detection_roi_t *roi,
+                                int frame_width, int frame_height) {
+    for (int i = 0; i < result->count; i++) {
+        detection_t *d = &result->detections[i];
+        d->x = ((float)roi->x + d->x * (float)roi->width) / (float)frame_width;
+        d->y = ((float)roi->y + d->y * (float)roi->height) / (float)frame_height;
+        d->width = d->width * (float)roi->width / (float)frame_width;
+        d->height = d->height * (float)roi->height / (float)frame_height;
+    }
+}
+
+static float box_iou(const detection_t *a, const detection_t *b) {
+    float x1 = a->x > b->x ? a->x : b->x;
+    float y1 = a->y > b->y ? a->y : b->y;
+    float x2 = (a->x + a->width) < (b->x + b->width) ? (a->x + a->width) : (b->x + b->width);
+    float y2 = (a->y + a->height) < (b->y + b->height) ? (a->y + a->height) : (b->y + b->height);
+    if (x2 <= x1 || y2 <= y1) {
+        return 0.0f;
+    }
+    float inter = (x2 - x1) * (y2 - y1);
+    float uni = a->width * a->height + b->width * b->height - inter;
+    return uni > 0.0f ? inter / uni : 0.0f;
+}
+
+void detection_roi_merge(detection_result_t *dst, const detection_result_t *src) {
+    for (int i = 0; i < src->count; i++) {
+        const detection_t *det = &src->detections[i];
+        int dup = -1;
+        for (int j = 0; j < dst->count && dup < 0; j++) {
+            if (strcmp(dst->detections[j].label, det->label) == 0 &&
+                box_iou(&dst->detections[j], det) >= ROI_DUPLICATE_IOU) {
+                dup = j;
+            }
+        }
+        if (dup >= 0) {
+            if (det->confidence > dst->detections[dup].confidence) {
+                dst->detections[dup] = *det;
+            }
+        } else if (dst->count < MAX_DETECTIONS) {
+            dst->detections[dst->count++] = *det;
+        }
+    }
+}
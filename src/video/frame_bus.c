@@ -0,0 +1,677 @@
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "core/logger.h"
+#include "core/config.h"
+#include "core/path_utils.h"
+#include "utils/strings.h"
+#include "video/frame_bus.h"
+
+// Detector connections served at once
+#define FRAME_BUS_MAX_CLIENTS 64
+
+// Streams that can have a ring
+#define FRAME_BUS_MAX_RINGS MAX_STREAMS
+
+// Poll timeout of the bus thread when nothing happens (ms)
+#define FRAME_BUS_POLL_TIMEOUT_MS 1000
+
+// Slots are page aligned so detectors can map or madvise them individually
+#define FRAME_BUS_PAGE_SIZE 4096
+
+// One stream's ring. Rings live until frame_bus_shutdown().
+typedef struct {
+    char stream_name[MAX_STREAM_NAME];
+    int memfd;
+    uint8_t *map;
+    size_t map_size;
+    uint64_t next_seq;          // Only the stream's publishing thread touches this
+    int subscribers;            // Attached connections
+    int publishers;             // Publishes copying into the ring right now
+    frame_bus_result_cb callback;
+    void *user_data;
+} frame_ring_t;
+
+// One detector connection
+typedef struct {
+    int fd;                     // Connection socket (-1 = free)
+    int event_fd;               // Signalled after every frame published to the ring
+    int ring;                   // Index into rings, -1 until ATTACH
+} frame_client_t;
+
+// Bus state: everything below is guarded by bus_mutex. The clients table is
+// only modified by the bus thread (and by shutdown after joining it).
+static pthread_mutex_t bus_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t bus_cond = PTHREAD_COND_INITIALIZER;
+static pthread_t bus_thread;
+static bool bus_running = false;
+static bool stop_requested = false;
+static int listen_fd = -1;
+static int wake_fd = -1;                 // eventfd that interrupts poll() on shutdown
+static char bus_socket_path[MAX_PATH_LENGTH];
+static int bus_slot_count = 0;
+static size_t bus_max_frame_bytes = 0;
+static size_t bus_slot_stride = 0;
+static frame_ring_t *rings[FRAME_BUS_MAX_RINGS];
+static frame_client_t clients[FRAME_BUS_MAX_CLIENTS];
+static int callback_ring = -1;           // Ring whose result callback is running, if any
+
+static uint64_t now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL;
+}
+
+static frame_bus_slot_t *ring_slot(const frame_ring_t *ring, uint64_t seq) {
+    size_t index = (size_t)(seq % (uint64_t)bus_slot_count);
+    return (frame_bus_slot_t *)(ring->map + FRAME_BUS_HEADER_SIZE + index * bus_slot_stride);
+}
+
+static int find_ring_locked(const char *stream_name) {
+    for (int i = 0; i < FRAME_BUS_MAX_RINGS; i++) {
+        if (rings[i] && strcmp(rings[i]->stream_name, stream_name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static void destroy_ring(frame_ring_t *ring) {
+    if (ring->map) {
+        munmap(ring->map, ring->map_size);
+    }
+    if (ring->memfd >= 0) {
+        close(ring->memfd);
+    }
+    free(ring);
+}
+
+// Create the memfd-backed ring of a stream
+static int create_ring_locked(const char *stream_name) {
+    int index = -1;
+    for (int i = 0; i < FRAME_BUS_MAX_RINGS; i++) {
+        if (!rings[i]) {
+            index = i;
+            break;
+        }
+    }
+    if (index < 0) {
+        log_error("Frame bus: no free ring for stream %s", stream_name);
+        return -1;
+    }
+
+    frame_ring_t *ring = calloc(1, sizeof(frame_ring_t));
+    if (!ring) {
+        log_error("Frame bus: failed to allocate ring for stream %s", stream_name);
+        return -1;
+    }
+    safe_strcpy(ring->stream_name, stream_name, sizeof(ring->stream_name), 0);
+    ring->map_size = FRAME_BUS_HEADER_SIZE + (size_t)bus_slot_count * bus_slot_stride;
+
+    ring->memfd = memfd_create("lightnvr-frame-bus", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (ring->memfd < 0) {
+        log_error("Frame bus: memfd_create failed for stream %s: %s", stream_name, strerror(errno));
+        free(ring);
+        return -1;
+    }
+
+    // The file stays sparse: slot pages are only backed once frames are written
+    if (ftruncate(ring->memfd, (off_t)ring->map_size) != 0) {
+        log_error("Frame bus: failed to size ring for stream %s: %s", stream_name, strerror(errno));
+        close(ring->memfd);
+        free(ring);
+        return -1;
+    }
+
+#ifdef F_ADD_SEALS
+    // Detectors must not be able to shrink the file under our mapping
+    if (fcntl(ring->memfd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) != 0) {
+        log_warn("Frame bus: failed to seal ring for stream %s: %s", stream_name, strerror(errno));
+    }
+#endif
+
+    ring->map = mmap(NULL, ring->map_size, PROT_READ | PROT_WRITE, MAP_SHARED, ring->memfd, 0);
+    if (ring->map == MAP_FAILED) {
+        log_error("Frame bus: failed to map ring for stream %s: %s", stream_name, strerror(errno));
+        ring->map = NULL;
+        destroy_ring(ring);
+        return -1;
+    }
+
+    frame_bus_header_t *hdr = (frame_bus_header_t *)ring->map;
+    hdr->magic = FRAME_BUS_MAGIC;
+    hdr->version = FRAME_BUS_VERSION;
+    hdr->slot_count = (uint32_t)bus_slot_count;
+    hdr->slot_stride = (uint32_t)bus_slot_stride;
+    hdr->max_frame_bytes = (uint32_t)bus_max_frame_bytes;
+    safe_strcpy(hdr->stream_name, stream_name, sizeof(hdr->stream_name), 0);
+
+    rings[index] = ring;
+    log_info("Frame bus: created %d x %zu byte ring for stream %s",
+             bus_slot_count, bus_max_frame_bytes, stream_name);
+    return index;
+}
+
+static int find_or_create_ring_locked(const char *stream_name) {
+    int index = find_ring_locked(stream_name);
+    if (index < 0) {
+        index = create_ring_locked(stream_name);
+    }
+    return index;
+}
+
+// Send a control message, optionally passing file descriptors
+static int send_message(int fd, const char *msg, const int *fds, int nfds) {
+    struct iovec iov = { .iov_base = (void *)msg, .iov_len = strlen(msg) };
+    struct msghdr mh;
+    union {
+        struct cmsghdr align;
+        char buf[CMSG_SPACE(sizeof(int) * 2)];
+    } control;
+
+    memset(&mh, 0, sizeof(mh));
+    mh.msg_iov = &iov;
+    mh.msg_iovlen = 1;
+
+    if (nfds > 0) {
+        memset(&control, 0, sizeof(control));
+        mh.msg_control = control.buf;
+        mh.msg_controllen = CMSG_SPACE(sizeof(int) * (size_t)nfds);
+        struct cmsghdr *cmsg = CMSG_FIRSTHDR(&mh);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int) * (size_t)nfds);
+        memcpy(CMSG_DATA(cmsg), fds, sizeof(int) * (size_t)nfds);
+    }
+
+    return sendmsg(fd, &mh, MSG_NOSIGNAL) < 0 ? -1 : 0;
+}
+
+static void close_client_locked(frame_client_t *client) {
+    if (client->ring >= 0 && rings[client->ring]) {
+        rings[client->ring]->subscribers--;
+        log_info("Frame bus: detector detached from stream %s", rings[client->ring]->stream_name);
+    }
+    if (client->event_fd >= 0) {
+        close(client->event_fd);
+    }
+    if (client->fd >= 0) {
+        close(client->fd);
+    }
+    client->fd = -1;
+    client->event_fd = -1;
+    client->ring = -1;
+}
+
+static void handle_attach(frame_client_t *client, const char *stream_name) {
+    char reply[128];
+
+    pthread_mutex_lock(&bus_mutex);
+
+    if (client->ring >= 0) {
+        pthread_mutex_unlock(&bus_mutex);
+        send_message(client->fd, "ERR already attached", NULL, 0);
+        return;
+    }
+    if (stream_name[0] == '\0' || strlen(stream_name) >= MAX_STREAM_NAME) {
+        pthread_mutex_unlock(&bus_mutex);
+        send_message(client->fd, "ERR invalid stream name", NULL, 0);
+        return;
+    }
+
+    int index = find_or_create_ring_locked(stream_name);
+    if (index < 0) {
+        pthread_mutex_unlock(&bus_mutex);
+        send_message(client->fd, "ERR no ring available", NULL, 0);
+        return;
+    }
+
+    int event_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (event_fd < 0) {
+        pthread_mutex_unlock(&bus_mutex);
+        log_error("Frame bus: eventfd failed: %s", strerror(errno));
+        send_message(client->fd, "ERR eventfd failed", NULL, 0);
+        return;
+    }
+
+    snprintf(reply, sizeof(reply), "OK %d %zu %zu", bus_slot_count, bus_slot_stride, bus_max_frame_bytes);
+    int fds[2] = { rings[index]->memfd, event_fd };
+    if (send_message(client->fd, reply, fds, 2) != 0) {
+        pthread_mutex_unlock(&bus_mutex);
+        log_warn("Frame bus: failed to answer ATTACH for stream %s: %s", stream_name, strerror(errno));
+        close(event_fd);
+        return;
+    }
+
+    client->event_fd = event_fd;
+    client->ring = index;
+    rings[index]->subscribers++;
+    pthread_mutex_unlock(&bus_mutex);
+
+    log_info("Frame bus: detector attached to stream %s", stream_name);
+}
+
+static void handle_result(frame_client_t *client, const char *args, size_t args_len) {
+    char *end = NULL;
+    uint64_t seq = strtoull(args, &end, 10);
+    if (end == args || *end != ' ') {
+        log_warn("Frame bus: malformed RESULT message");
+        return;
+    }
+    const char *json = end + 1;
+    size_t json_len = args_len - (size_t)(json - args);
+
+    pthread_mutex_lock(&bus_mutex);
+    int index = client->ring;
+    if (index < 0) {
+        pthread_mutex_unlock(&bus_mutex);
+        send_message(client->fd, "ERR not attached", NULL, 0);
+        return;
+    }
+    frame_ring_t *ring = rings[index];
+    frame_bus_result_cb callback = ring->callback;
+    void *user_data = ring->user_data;
+    if (!callback) {
+        pthread_mutex_unlock(&bus_mutex);
+        log_debug("Frame bus: no result handler for stream %s, dropping result", ring->stream_name);
+        return;
+    }
+    callback_ring = index;
+    pthread_mutex_unlock(&bus_mutex);
+
+    callback(ring->stream_name, seq, json, json_len, user_data);
+
+    pthread_mutex_lock(&bus_mutex);
+    callback_ring = -1;
+    pthread_cond_broadcast(&bus_cond);
+    pthread_mutex_unlock(&bus_mutex);
+}
+
+// Read and dispatch one control message; returns -1 when the connection should be closed
+static int handle_client_message(frame_client_t *client, char *buf) {
+    ssize_t n = recv(client->fd, buf, FRAME_BUS_MAX_MESSAGE, MSG_TRUNC);
+    if (n <= 0) {
+        return -1;
+    }
+    if (n >= FRAME_BUS_MAX_MESSAGE) {
+        log_warn("Frame bus: dropping oversized control message (%zd bytes)", n);
+        return 0;
+    }
+    buf[n] = '\0';
+
+    if (strncmp(buf, "ATTACH ", 7) == 0) {
+        handle_attach(client, buf + 7);
+    } else if (strncmp(buf, "RESULT ", 7) == 0) {
+        handle_result(client, buf + 7, (size_t)n - 7);
+    } else {
+        log_warn("Frame bus: unknown control message");
+        send_message(client->fd, "ERR unknown command", NULL, 0);
+    }
+    return 0;
+}
+
+static void accept_client(void) {
+    int fd = accept4(listen_fd, NULL, NULL, SOCK_CLOEXEC);
+    if (fd < 0) {
+        if (errno != EAGAIN && errno != EINTR) {
+            log_warn("Frame bus: accept failed: %s", strerror(errno));
+        }
+        return;
+    }
+
+    pthread_mutex_lock(&bus_mutex);
+    for (int i = 0; i < FRAME_BUS_MAX_CLIENTS; i++) {
+        if (clients[i].fd < 0) {
+            clients[i].fd = fd;
+            clients[i].event_fd = -1;
+            clients[i].ring = -1;
+            pthread_mutex_unlock(&bus_mutex);
+            return;
+        }
+    }
+    pthread_mutex_unlock(&bus_mutex);
+
+    log_warn("Frame bus: too many detector connections, rejecting");
+    send_message(fd, "ERR too many connections", NULL, 0);
+    close(fd);
+}
+
+static void *frame_bus_thread(void *arg) {
+    (void)arg;
+    struct pollfd pfds[FRAME_BUS_MAX_CLIENTS + 2];
+    int pfd_client[FRAME_BUS_MAX_CLIENTS + 2];
+
+    log_set_thread_context("FrameBus", NULL);
+
+    char *buf = malloc(FRAME_BUS_MAX_MESSAGE + 1);
+    if (!buf) {
+        log_error("Frame bus: failed to allocate message buffer");
+        return NULL;
+    }
+
+    while (true) {
+        int nfds = 0;
+
+        pthread_mutex_lock(&bus_mutex);
+        bool stop = stop_requested;
+        pthread_mutex_unlock(&bus_mutex);
+        if (stop) {
+            break;
+        }
+
+        pfds[nfds].fd = wake_fd;
+        pfds[nfds].events = POLLIN;
+        pfd_client[nfds++] = -1;
+        pfds[nfds].fd = listen_fd;
+        pfds[nfds].events = POLLIN;
+        pfd_client[nfds++] = -1;
+        // Only this thread modifies the clients table, so no lock is needed to read it
+        for (int i = 0; i < FRAME_BUS_MAX_CLIENTS; i++) {
+            if (clients[i].fd >= 0) {
+                pfds[nfds].fd = clients[i].fd;
+                pfds[nfds].events = POLLIN;
+                pfd_client[nfds++] = i;
+            }
+        }
+
+        int ready = poll(pfds, (nfds_t)nfds, FRAME_BUS_POLL_TIMEOUT_MS);
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            log_error("Frame bus: poll failed: %s", strerror(errno));
+            break;
+        }
+        if (ready == 0 || (pfds[0].revents & POLLIN)) {
+            continue;
+        }
+
+        if (pfds[1].revents & POLLIN) {
+            accept_client();
+        }
+
+        for (int p = 2; p < nfds; p++) {
+            if (!pfds[p].revents) {
+                continue;
+            }
+            frame_client_t *client = &clients[pfd_client[p]];
+            if ((pfds[p].revents & POLLIN) && handle_client_message(client, buf) == 0) {
+                continue;
+            }
+            pthread_mutex_lock(&bus_mutex);
+            close_client_locked(client);
+            pthread_mutex_unlock(&bus_mutex);
+        }
+    }
+
+    free(buf);
+    return NULL;
+}
+
+int frame_bus_init(const char *socket_path, int slot_count, size_t max_frame_bytes) {
+    if (!socket_path || socket_path[0] == '\0' || slot_count < 2 || max_frame_bytes == 0) {
+        log_error("Frame bus: invalid parameters");
+        return -1;
+    }
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(socket_path) >= sizeof(addr.sun_path)) {
+        log_error("Frame bus: socket path too long: %s", socket_path);
+        return -1;
+    }
+    safe_strcpy(addr.sun_path, socket_path, sizeof(addr.sun_path), 0);
+
+    pthread_mutex_lock(&bus_mutex);
+    if (bus_running) {
+        pthread_mutex_unlock(&bus_mutex);
+        return 0;
+    }
+
+    if (ensure_path(socket_path) != 0) {
+        log_warn("Frame bus: failed to create directory for %s", socket_path);
+    }
+    unlink(socket_path);  // Stale socket from a previous run
+
+    listen_fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (listen_fd < 0) {
+        log_error("Frame bus: socket failed: %s", strerror(errno));
+        pthread_mutex_unlock(&bus_mutex);
+        return -1;
+    }
+    if (bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+        listen(listen_fd, 16) != 0) {
+        log_error("Frame bus: failed to listen on %s: %s", socket_path, strerror(errno));
+        close(listen_fd);
+        listen_fd = -1;
+        pthread_mutex_unlock(&bus_mutex);
+        return -1;
+    }
+    // Frames are readable by anyone who can connect: keep the socket private
+    chmod(socket_path, 0660);
+
+    wake_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (wake_fd < 0) {
+        log_error("Frame bus: eventfd failed: %s", strerror(errno));
+        close(listen_fd);
+        listen_fd = -1;
+        unlink(socket_path);
+        pthread_mutex_unlock(&bus_mutex);
+        return -1;
+    }
+
+    safe_strcpy(bus_socket_path, socket_path, sizeof(bus_socket_path), 0);
+    bus_slot_count = slot_count;
+    bus_max_frame_bytes = max_frame_bytes;
+    bus_slot_stride = (sizeof(frame_bus_slot_t) + max_frame_bytes + FRAME_BUS_PAGE_SIZE - 1) &
+                      ~(size_t)(FRAME_BUS_PAGE_SIZE - 1);
+    memset(rings, 0, sizeof(rings));
+    for (int i = 0; i < FRAME_BUS_MAX_CLIENTS; i++) {
+        clients[i].fd = -1;
+        clients[i].event_fd = -1;
+        clients[i].ring = -1;
+    }
+    stop_requested = false;
+
+    if (pthread_create(&bus_thread, NULL, frame_bus_thread, NULL) != 0) {
+        log_error("Frame bus: failed to start thread");
+        close(wake_fd);
+        wake_fd = -1;
+        close(listen_fd);
+        listen_fd = -1;
+        unlink(socket_path);
+        pthread_mutex_unlock(&bus_mutex);
+        return -1;
+    }
+
+    bus_running = true;
+    pthread_mutex_unlock(&bus_mutex);
+
+    log_info("Frame bus listening on %s (%d slots of %zu bytes per stream)",
+             socket_path, slot_count, max_frame_bytes);
+    return 0;
+}
+
+void frame_bus_shutdown(void) {
+    pthread_mutex_lock(&bus_mutex);
+    if (!bus_running) {
+        pthread_mutex_unlock(&bus_mutex);
+        return;
+    }
+    stop_requested = true;
+    pthread_mutex_unlock(&bus_mutex);
+
+    uint64_t one = 1;
+    if (write(wake_fd, &one, sizeof(one)) != sizeof(one)) {
+        log_warn("Frame bus: failed to wake thread: %s", strerror(errno));
+    }
+    pthread_join(bus_thread, NULL);
+
+    pthread_mutex_lock(&bus_mutex);
+    bus_running = false;
+    for (int i = 0; i < FRAME_BUS_MAX_CLIENTS; i++) {
+        if (clients[i].fd >= 0) {
+            close_client_locked(&clients[i]);
+        }
+    }
+    for (int i = 0; i < FRAME_BUS_MAX_RINGS; i++) {
+        if (!rings[i]) {
+            continue;
+        }
+        // A publisher may still be copying a frame into the ring
+        while (rings[i]->publishers > 0) {
+            pthread_cond_wait(&bus_cond, &bus_mutex);
+        }
+        destroy_ring(rings[i]);
+        rings[i] = NULL;
+    }
+    close(listen_fd);
+    listen_fd = -1;
+    close(wake_fd);
+    wake_fd = -1;
+    unlink(bus_socket_path);
+    pthread_mutex_unlock(&bus_mutex);
+
+    log_info("Frame bus stopped");
+}
+
+bool frame_bus_is_running(void) {
+    pthread_mutex_lock(&bus_mutex);
+    bool running = bus_running;
+    pthread_mutex_unlock(&bus_mutex);
+    return running;
+}
+
+size_t frame_bus_max_frame_bytes(void) {
+    pthread_mutex_lock(&bus_mutex);
+    size_t max_bytes = bus_running ? bus_max_frame_bytes : 0;
+    pthread_mutex_unlock(&bus_mutex);
+    return max_bytes;
+}
+
+bool frame_bus_has_subscriber(const char *stream_name) {
+    if (!stream_name) {
+        return false;
+    }
+
+    pthread_mutex_lock(&bus_mutex);
+    int index = bus_running ? find_ring_locked(stream_name) : -1;
+    bool attached = index >= 0 && rings[index]->subscribers > 0;
+    pthread_mutex_unlock(&bus_mutex);
+    return attached;
+}
+
+int frame_bus_publish(const char *stream_name, const uint8_t *rgb, int width, int height,
+                      uint64_t *seq_out) {
+    if (!stream_name || !rgb || width <= 0 || height <= 0) {
+        return -1;
+    }
+    size_t size = (size_t)width * (size_t)height * 3;
+
+    pthread_mutex_lock(&bus_mutex);
+    if (!bus_running) {
+        pthread_mutex_unlock(&bus_mutex);
+        return -1;
+    }
+    int index = find_ring_locked(stream_name);
+    if (index < 0 || rings[index]->subscribers == 0) {
+        pthread_mutex_unlock(&bus_mutex);
+        return FRAME_BUS_NO_SUBSCRIBER;
+    }
+    if (size > bus_max_frame_bytes) {
+        pthread_mutex_unlock(&bus_mutex);
+        log_warn("[%s] Frame bus: %dx%d frame exceeds the slot size of %zu bytes",
+                 stream_name, width, height, bus_max_frame_bytes);
+        return -1;
+    }
+    frame_ring_t *ring = rings[index];
+    ring->publishers++;
+    pthread_mutex_unlock(&bus_mutex);
+
+    // Seqlock write: readers that see an odd or changed gen discard their copy
+    uint64_t seq = ++ring->next_seq;
+    frame_bus_slot_t *slot = ring_slot(ring, seq);
+    uint32_t gen = __atomic_load_n(&slot->gen, __ATOMIC_RELAXED);
+    __atomic_store_n(&slot->gen, gen + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    slot->format = FRAME_BUS_FORMAT_RGB24;
+    slot->seq = seq;
+    slot->timestamp_us = now_us();
+    slot->width = (uint32_t)width;
+    slot->height = (uint32_t)height;
+    slot->stride = (uint32_t)width * 3;
+    slot->size = (uint32_t)size;
+    memcpy((uint8_t *)slot + sizeof(frame_bus_slot_t), rgb, size);
+
+    __atomic_store_n(&slot->gen, gen + 2, __ATOMIC_RELEASE);
+    __atomic_store_n(&((frame_bus_header_t *)ring->map)->write_seq, seq, __ATOMIC_RELEASE);
+
+    pthread_mutex_lock(&bus_mutex);
+    ring->publishers--;
+    if (stop_requested) {
+        pthread_cond_broadcast(&bus_cond);
+    }
+    uint64_t one = 1;
+    for (int i = 0; i < FRAME_BUS_MAX_CLIENTS; i++) {
+        if (clients[i].fd >= 0 && clients[i].ring == index &&
+            write(clients[i].event_fd, &one, sizeof(one)) != sizeof(one) && errno != EAGAIN) {
+            log_debug("[%s] Frame bus: failed to signal detector: %s", stream_name, strerror(errno));
+        }
+    }
+    pthread_mutex_unlock(&bus_mutex);
+
+    if (seq_out) {
+        *seq_out = seq;
+    }
+    return 0;
+}
+
+int frame_bus_set_result_handler(const char *stream_name, frame_bus_result_cb callback,
+                                 void *user_data) {
+    if (!stream_name || !callback) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&bus_mutex);
+    int index = bus_running ? find_or_create_ring_locked(stream_name) : -1;
+    if (index >= 0) {
+        rings[index]->callback = callback;
+        rings[index]->user_data = user_data;
+    }
+    pthread_mutex_unlock(&bus_mutex);
+
+    return index >= 0 ? 0 : -1;
+}
+
+void frame_bus_clear_result_handler(const char *stream_name) {
+    if (!stream_name) {
+        return;
+    }
+
+    pthread_mutex_lock(&bus_mutex);
+    int index = bus_running ? find_ring_locked(stream_name) : -1;
+    if (index >= 0) {
+        rings[index]->callback = NULL;
+        rings[index]->user_data = NULL;
+        while (callback_ring == index) {
+            pthread_cond_wait(&bus_cond, &bus_mutex);
+        }
+    }
+    pthread_mutex_unlock(&bus_mutex);
+}
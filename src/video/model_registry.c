@@ -0,0 +1,374 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#include "core/logger.h"
+#include "core/config.h"
+#include "utils/strings.h"
+#include "video/model_registry.h"
+
+// Which revision of a model file a version was loaded from
+typedef struct {
+    bool valid;
+    dev_t dev;
+    ino_t ino;
+    off_t size;
+    time_t mtime_sec;
+    long mtime_nsec;
+} file_identity_t;
+
+typedef struct model_entry model_entry_t;
+
+struct model_version {
+    model_entry_t *entry;
+    void *shared;
+    model_version_free_fn free_fn;
+    int refs;                       // Attached handles, plus one while current
+    unsigned int generation;
+    bool claimed;                   // Shared instance in exclusive use by one handle
+    file_identity_t identity;
+};
+
+struct model_entry {
+    bool in_use;
+    char path[MAX_PATH_LENGTH];
+    float threshold;
+    model_version_load_fn load;
+    model_version_free_fn free_fn;
+    model_version_t *current;       // NULL until the first load completes
+    int handles;
+    int versions;
+    bool loading;                   // First load or a reload is running
+    bool force_reload;
+    time_t last_check;
+    file_identity_t failed;         // Revision that failed to load; not retried until it changes
+    uint64_t reloads;
+    uint64_t reload_failures;
+};
+
+static model_entry_t entries[MODEL_REGISTRY_MAX_ENTRIES];
+static pthread_mutex_t registry_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t registry_cond = PTHREAD_COND_INITIALIZER;
+
+static time_t monotonic_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec;
+}
+
+static file_identity_t stat_identity(const char *path) {
+    file_identity_t id;
+    struct stat st;
+    memset(&id, 0, sizeof(id));
+    if (stat(path, &st) == 0) {
+        id.valid = true;
+        id.dev = st.st_dev;
+        id.ino = st.st_ino;
+        id.size = st.st_size;
+        id.mtime_sec = st.st_mtim.tv_sec;
+        id.mtime_nsec = st.st_mtim.tv_nsec;
+    }
+    return id;
+}
+
+static bool same_identity(const file_identity_t *a, const file_identity_t *b) {
+    return a->valid && b->valid && a->dev == b->dev && a->ino == b->ino && a->size == b->size &&
+           a->mtime_sec == b->mtime_sec && a->mtime_nsec == b->mtime_nsec;
+}
+
+// Caller holds registry_mutex
+static model_entry_t *find_entry(const char *path, float threshold) {
+    for (int i = 0; i < MODEL_REGISTRY_MAX_ENTRIES; i++) {
+        if (entries[i].in_use && entries[i].threshold == threshold && strcmp(entries[i].path, path) == 0) {
+            return &entries[i];
+        }
+    }
+    return NULL;
+}
+
+static model_version_t *new_version(model_entry_t *e, void *shared, const file_identity_t *identity,
+                                    unsigned int generation) {
+    model_version_t *v = calloc(1, sizeof(model_version_t));
+    if (!v) {
+        return NULL;
+    }
+    v->entry = e;
+    v->shared = shared;
+    v->free_fn = e->free_fn;
+    v->generation = generation;
+    v->identity = *identity;
+    return v;
+}
+
+static void free_version(model_version_t *v) {
+    if (v->free_fn && v->shared) {
+        v->free_fn(v->shared);
+    }
+    free(v);
+}
+
+// Drop one reference. Caller holds registry_mutex; returns the version if
+// it must be freed once the lock is released.
+static model_version_t *unref_version(model_version_t *v) {
+    if (--v->refs > 0) {
+        return NULL;
+    }
+    v->entry->versions--;
+    return v;
+}
+
+model_version_t *model_registry_acquire(const char *path, float threshold,
+                                        model_version_load_fn load, model_version_free_fn free_fn) {
+    if (!path || !load) {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&registry_mutex);
+    model_entry_t *e;
+    while ((e = find_entry(path, threshold)) != NULL) {
+        if (!e->current) {
+            // Another stream is loading this model; wait for its result
+            pthread_cond_wait(&registry_cond, &registry_mutex);
+            continue;
+        }
+        model_version_t *v = e->current;
+        v->refs++;
+        int handles = ++e->handles;
+        pthread_mutex_unlock(&registry_mutex);
+        log_info("Sharing loaded model %s (generation %u, %d handles)", path, v->generation, handles);
+        return v;
+    }
+
+    for (int i = 0; i < MODEL_REGISTRY_MAX_ENTRIES && !e; i++) {
+        if (!entries[i].in_use) {
+            e = &entries[i];
+        }
+    }
+    if (!e) {
+        pthread_mutex_unlock(&registry_mutex);
+        log_error("Model registry full (%d models), cannot load %s", MODEL_REGISTRY_MAX_ENTRIES, path);
+        return NULL;
+    }
+    memset(e, 0, sizeof(*e));
+    e->in_use = true;
+    safe_strcpy(e->path, path, sizeof(e->path), 0);
+    e->threshold = threshold;
+    e->load = load;
+    e->free_fn = free_fn;
+    e->loading = true;
+    e->handles = 1;
+    pthread_mutex_unlock(&registry_mutex);
+
+    // Identify the file before loading it, so a change during the load is
+    // picked up by the next check
+    file_identity_t identity = stat_identity(path);
+    void *shared = load(path, threshold);
+
+    pthread_mutex_lock(&registry_mutex);
+    e->loading = false;
+    model_version_t *v = shared ? new_version(e, shared, &identity, 1) : NULL;
+    if (!v) {
+        memset(e, 0, sizeof(*e));
+        pthread_cond_broadcast(&registry_cond);
+        pthread_mutex_unlock(&registry_mutex);
+        if (shared && free_fn) {
+            free_fn(shared);
+        }
+        return NULL;
+    }
+    v->refs = 2;    // The entry's and the caller's
+    e->current = v;
+    e->versions = 1;
+    e->last_check = monotonic_seconds();
+    pthread_cond_broadcast(&registry_cond);
+    pthread_mutex_unlock(&registry_mutex);
+    return v;
+}
+
+void model_registry_release(model_version_t *version) {
+    if (!version) {
+        return;
+    }
+
+    model_version_t *to_free[2] = {NULL, NULL};
+
+    pthread_mutex_lock(&registry_mutex);
+    model_entry_t *e = version->entry;
+    e->handles--;
+    to_free[0] = unref_version(version);
+    if (e->handles == 0) {
+        // Last stream using the model: forget it
+        if (e->current) {
+            to_free[1] = unref_version(e->current);
+        }
+        log_info("Model %s no longer used, unloading", e->path);
+        memset(e, 0, sizeof(*e));
+    }
+    pthread_mutex_unlock(&registry_mutex);
+
+    for (int i = 0; i < 2; i++) {
+        if (to_free[i]) {
+            free_version(to_free[i]);
+        }
+    }
+}
+
+model_version_t *model_registry_check_update(model_version_t *version) {
+    if (!version) {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&registry_mutex);
+    model_entry_t *e = version->entry;
+
+    // Another handle already loaded a newer version
+    if (e->current != version) {
+        model_version_t *nv = e->current;
+        nv->refs++;
+        e->handles++;
+        pthread_mutex_unlock(&registry_mutex);
+        return nv;
+    }
+
+    time_t now = monotonic_seconds();
+    int interval = g_config.model_reload_interval;
+    if (e->loading || (!e->force_reload && (interval <= 0 || now - e->last_check < interval))) {
+        pthread_mutex_unlock(&registry_mutex);
+        return NULL;
+    }
+
+    bool forced = e->force_reload;
+    e->force_reload = false;
+    e->last_check = now;
+    e->loading = true;
+    file_identity_t current_id = version->identity;
+    file_identity_t failed_id = e->failed;
+    unsigned int generation = version->generation + 1;
+    pthread_mutex_unlock(&registry_mutex);
+
+    // The entry cannot go away meanwhile: the caller's handle keeps it alive
+    file_identity_t identity = stat_identity(e->path);
+    if (!forced && (!identity.valid || same_identity(&identity, &current_id) ||
+                    same_identity(&identity, &failed_id))) {
+        pthread_mutex_lock(&registry_mutex);
+        e->loading = false;
+        pthread_mutex_unlock(&registry_mutex);
+        return NULL;
+    }
+
+    log_info("Model %s changed, loading generation %u", e->path, generation);
+    void *shared = e->load(e->path, e->threshold);
+
+    pthread_mutex_lock(&registry_mutex);
+    e->loading = false;
+    model_version_t *nv = shared ? new_version(e, shared, &identity, generation) : NULL;
+    if (!nv) {
+        e->failed = identity;
+        e->reload_failures++;
+        pthread_mutex_unlock(&registry_mutex);
+        if (shared && e->free_fn) {
+            e->free_fn(shared);
+        }
+        log_error("Failed to reload model %s; streams keep generation %u", e->path, generation - 1);
+        return NULL;
+    }
+
+    // The old version stays alive until its last handle moves over;
+    // the caller holds one, so dropping the entry's reference cannot free it
+    nv->refs = 2;   // The entry's and the caller's
+    e->current = nv;
+    e->versions++;
+    e->handles++;
+    e->reloads++;
+    memset(&e->failed, 0, sizeof(e->failed));
+    unref_version(version);
+    pthread_mutex_unlock(&registry_mutex);
+
+    log_info("Model %s reloaded as generation %u", e->path, generation);
+    return nv;
+}
+
+int model_registry_reload(const char *path) {
+    int count = 0;
+
+    if (!path) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&registry_mutex);
+    for (int i = 0; i < MODEL_REGISTRY_MAX_ENTRIES; i++) {
+        if (entries[i].in_use && strcmp(entries[i].path, path) == 0) {
+            entries[i].force_reload = true;
+            count++;
+        }
+    }
+    pthread_mutex_unlock(&registry_mutex);
+
+    return count;
+}
+
+void *model_version_shared(const model_version_t *version) {
+    return version ? version->shared : NULL;
+}
+
+bool model_version_claim(model_version_t *version) {
+    bool claimed = false;
+
+    if (!version) {
+        return false;
+    }
+
+    pthread_mutex_lock(&registry_mutex);
+    if (!version->claimed) {
+        version->claimed = true;
+        claimed = true;
+    }
+    pthread_mutex_unlock(&registry_mutex);
+
+    return claimed;
+}
+
+void model_version_unclaim(model_version_t *version) {
+    if (!version) {
+        return;
+    }
+
+    pthread_mutex_lock(&registry_mutex);
+    version->claimed = false;
+    pthread_mutex_unlock(&registry_mutex);
+}
+
+unsigned int model_version_generation(const model_version_t *version) {
+    return version ? version->generation : 0;
+}
+
+int model_registry_get_stats(model_registry_stats_t *stats, int max) {
+    int n = 0;
+
+    if (!stats || max <= 0) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&registry_mutex);
+    for (int i = 0; i < MODEL_REGISTRY_MAX_ENTRIES && n < max; i++) {
+        const model_entry_t *e = &entries[i];
+        if (!e->in_use || !e->current) {
+            continue;
+        }
+        model_registry_stats_t *s = &stats[n++];
+        safe_strcpy(s->path, e->path, sizeof(s->path), 0);
+        s->threshold = e->threshold;
+        s->handles = e->handles;
+        s->versions = e->versions;
+        s->generation = e->current->generation;
+        s->reloads = e->reloads;
+        s->reload_failures = e->reload_failures;
+    }
+    pthread_mutex_unlock(&registry_mutex);
+
+    return n;
+}
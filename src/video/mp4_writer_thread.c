@@ -37,10 +37,71 @@
 #include "database/database_manager.h"
 #include "database/db_recordings.h"
 #include "database/db_streams.h"
+#include "database/db_stream_cache.h"
 #include "storage/storage_manager_streams_cache.h"
 #include "telemetry/stream_metrics.h"
 
 
+// Running recording threads, so configuration changes can be routed to the
+// thread of the stream that changed. The subscription lives as long as the
+// process; the listener runs on the thread that wrote the configuration.
+#define MAX_CONFIG_WATCHERS (MAX_STREAMS * 2)
+
+static struct {
+    mp4_writer_thread_t *ctx;
+    char stream_name[MAX_STREAM_NAME];
+} config_watchers[MAX_CONFIG_WATCHERS];
+static pthread_mutex_t config_watchers_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t config_subscribe_once = PTHREAD_ONCE_INIT;
+
+static void on_stream_config_changed(const char *name, const stream_config_t *old_config,
+                                     const stream_config_t *new_config, uint32_t changed,
+                                     void *user_data) {
+    (void)old_config;
+    (void)new_config;
+    (void)changed;
+    (void)user_data;
+
+    pthread_mutex_lock(&config_watchers_mutex);
+    for (int i = 0; i < MAX_CONFIG_WATCHERS; i++) {
+        if (config_watchers[i].ctx && strcmp(config_watchers[i].stream_name, name) == 0) {
+            atomic_store(&config_watchers[i].ctx->config_changed, 1);
+        }
+    }
+    pthread_mutex_unlock(&config_watchers_mutex);
+}
+
+static void subscribe_stream_config(void) {
+    if (stream_config_subscribe(STREAM_CONFIG_CHANGED_RECORDING, on_stream_config_changed, NULL) < 0) {
+        log_warn("Recording threads will not pick up segment and audio changes until restarted");
+    }
+}
+
+static void watch_stream_config(mp4_writer_thread_t *thread_ctx, const char *stream_name) {
+    pthread_once(&config_subscribe_once, subscribe_stream_config);
+
+    pthread_mutex_lock(&config_watchers_mutex);
+    for (int i = 0; i < MAX_CONFIG_WATCHERS; i++) {
+        if (!config_watchers[i].ctx) {
+            config_watchers[i].ctx = thread_ctx;
+            safe_strcpy(config_watchers[i].stream_name, stream_name, MAX_STREAM_NAME, 0);
+            break;
+        }
+    }
+    pthread_mutex_unlock(&config_watchers_mutex);
+}
+
+static void unwatch_stream_config(mp4_writer_thread_t *thread_ctx) {
+    pthread_mutex_lock(&config_watchers_mutex);
+    for (int i = 0; i < MAX_CONFIG_WATCHERS; i++) {
+        if (config_watchers[i].ctx == thread_ctx) {
+            config_watchers[i].ctx = NULL;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&config_watchers_mutex);
+}
+
 // Callback invoked by record_segment when the first keyframe is detected
 // and the segment officially begins. We create the DB metadata here so
 // start_time aligns with the actual playable start.
@@ -145,6 +206,10 @@ static void *mp4_writer_rtsp_thread(void *arg) {
     // Notify telemetry that recording is active for this stream
     metrics_set_recording_active(stream_name, true);
 
+    // Load the configuration on the first pass, then again whenever it changes
+    atomic_store(&thread_ctx->config_changed, 1);
+    watch_stream_config(thread_ctx, stream_name);
+
     // Main loop to record segments
     while (thread_ctx->running && !thread_ctx->shutdown_requested) {
         // Check if shutdown has been initiated
@@ -196,9 +261,15 @@ static void *mp4_writer_rtsp_thread(void *arg) {
         // Get current time
         time_t current_time = time(NULL);
 
-        // Fetch the latest stream configuration from the database
+        // Fetch the stream configuration if it changed since the last pass
         stream_config_t db_stream_config;
-        int db_config_result = get_stream_config_by_name(stream_name, &db_stream_config);
+        int db_config_result = -1;
+        if (atomic_exchange(&thread_ctx->config_changed, 0)) {
+            db_config_result = get_stream_config_by_name(stream_name, &db_stream_config);
+            if (db_config_result != 0) {
+                atomic_store(&thread_ctx->config_changed, 1);
+            }
+        }
 
         // Define segment_duration variable outside the if block
         segment_duration = thread_ctx->writer->segment_duration;
@@ -704,6 +775,8 @@ thread_cleanup:
     // Log that we've completed cleanup
     log_info("Completed cleanup of FFmpeg resources for stream %s", stream_name);
 
+    unwatch_stream_config(thread_ctx);
+
     // Notify telemetry that recording has stopped
     metrics_set_recording_active(stream_name, false);
 
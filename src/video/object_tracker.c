@@ -0,0 +1,379 @@
+/**
+ * Per-stream SORT-style object tracker
+ *
+ * Each track keeps four independent constant-velocity Kalman filters (box
+ * center x/y, width, height). With SORT's diagonal process and measurement
+ * noise the full filter decouples into exactly these 2-state filters, so
+ * nothing is lost by not carrying a 7x7 covariance. Association is greedy on
+ * IoU between predicted track boxes and detections of the same label, which
+ * for the handful of boxes per frame we see matches the Hungarian result in
+ * practice. See object_tracker.h for the events that come out of it.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "core/logger.h"
+#include "core/config.h"
+#include "utils/strings.h"
+#include "video/object_tracker.h"
+
+#define MAX_TRACKS_PER_STREAM 64
+
+// Minimum IoU between a predicted track box and a detection to associate them
+#define TRACK_MATCH_IOU 0.3f
+// A matched box whose IoU with the last stored box drops below this is stored again
+#define TRACK_MOVED_IOU 0.6f
+
+// Kalman noise in normalized frame units (1.0 = full frame)
+#define KF_MEASUREMENT_VAR 1e-4f
+#define KF_PROCESS_POS_VAR 1e-5f
+#define KF_PROCESS_VEL_VAR 1e-5f
+#define KF_INITIAL_POS_VAR 1e-3f
+#define KF_INITIAL_VEL_VAR 1e-1f
+
+typedef struct {
+    float x, v;             // state: value and per-frame velocity
+    float p00, p01, p11;    // covariance
+} kf1_t;
+
+typedef struct {
+    int id;
+    bool external;                  // track_id supplied by the detector
+    char label[MAX_LABEL_LENGTH];
+    kf1_t kf[4];                    // center x, center y, width, height
+    detection_t last;               // last matched detection
+    detection_t stored;             // detection of the last stored event
+    time_t stored_time;
+    int misses;                     // consecutive analyzed frames without a match
+    bool matched;
+} track_t;
+
+typedef struct {
+    char stream_name[MAX_STREAM_NAME];
+    pthread_mutex_t mutex;
+    track_t tracks[MAX_TRACKS_PER_STREAM];
+    int track_count;
+    uint64_t frames;
+    uint64_t detections;
+    uint64_t events;
+} stream_tracker_t;
+
+static stream_tracker_t *trackers[MAX_STREAMS];
+static pthread_mutex_t trackers_mutex = PTHREAD_MUTEX_INITIALIZER;
+static atomic_int next_track_id = 1;
+
+static void kf1_init(kf1_t *f, float z) {
+    f->x = z;
+    f->v = 0.0f;
+    f->p00 = KF_INITIAL_POS_VAR;
+    f->p01 = 0.0f;
+    f->p11 = KF_INITIAL_VEL_VAR;
+}
+
+static void kf1_predict(kf1_t *f) {
+    f->x += f->v;
+    f->p00 += 2.0f * f->p01 + f->p11 + KF_PROCESS_POS_VAR;
+    f->p01 += f->p11;
+    f->p11 += KF_PROCESS_VEL_VAR;
+}
+
+static void kf1_update(kf1_t *f, float z) {
+    float s = f->p00 + KF_MEASUREMENT_VAR;
+    float k0 = f->p00 / s;
+    float k1 = f->p01 / s;
+    float y = z - f->x;
+
+    f->x += k0 * y;
+    f->v += k1 * y;
+    f->p11 -= k1 * f->p01;
+    f->p01 -= k0 * f->p01;
+    f->p00 -= k0 * f->p00;
+}
+
+static void track_init_filters(track_t *t, const detection_t *det) {
+    kf1_init(&t->kf[0], det->x + det->width / 2.0f);
+    kf1_init(&t->kf[1], det->y + det->height / 2.0f);
+    kf1_init(&t->kf[2], det->width);
+    kf1_init(&t->kf[3], det->height);
+}
+
+static void track_update_filters(track_t *t, const detection_t *det) {
+    kf1_update(&t->kf[0], det->x + det->width / 2.0f);
+    kf1_update(&t->kf[1], det->y + det->height / 2.0f);
+    kf1_update(&t->kf[2], det->width);
+    kf1_update(&t->kf[3], det->height);
+}
+
+/**
+ * Intersection over union of two (x, y, w, h) boxes
+ */
+static float box_iou(float ax, float ay, float aw, float ah,
+                     float bx, float by, float bw, float bh) {
+    float ix0 = ax > bx ? ax : bx;
+    float iy0 = ay > by ? ay : by;
+    float ix1 = (ax + aw) < (bx + bw) ? (ax + aw) : (bx + bw);
+    float iy1 = (ay + ah) < (by + bh) ? (ay + ah) : (by + bh);
+    if (ix1 <= ix0 || iy1 <= iy0) {
+        return 0.0f;
+    }
+    float inter = (ix1 - ix0) * (iy1 - iy0);
+    float uni = aw * ah + bw * bh - inter;
+    return uni > 0.0f ? inter / uni : 0.0f;
+}
+
+static float track_predicted_iou(const track_t *t, const detection_t *det) {
+    float w = t->kf[2].x > 1e-3f ? t->kf[2].x : 1e-3f;
+    float h = t->kf[3].x > 1e-3f ? t->kf[3].x : 1e-3f;
+    return box_iou(t->kf[0].x - w / 2.0f, t->kf[1].x - h / 2.0f, w, h,
+                   det->x, det->y, det->width, det->height);
+}
+
+static float detection_iou(const detection_t *a, const detection_t *b) {
+    return box_iou(a->x, a->y, a->width, a->height, b->x, b->y, b->width, b->height);
+}
+
+/**
+ * Find or create the tracker for a stream (caller holds trackers_mutex)
+ */
+static stream_tracker_t *get_stream_tracker(const char *stream_name) {
+    int free_slot = -1;
+    for (int i = 0; i < MAX_STREAMS; i++) {
+        if (!trackers[i]) {
+            if (free_slot < 0) free_slot = i;
+            continue;
+        }
+        if (strcmp(trackers[i]->stream_name, stream_name) == 0) {
+            return trackers[i];
+        }
+    }
+
+    if (free_slot < 0) {
+        return NULL;
+    }
+
+    stream_tracker_t *tracker = calloc(1, sizeof(stream_tracker_t));
+    if (!tracker) {
+        return NULL;
+    }
+    safe_strcpy(tracker->stream_name, stream_name, sizeof(tracker->stream_name), 0);
+    pthread_mutex_init(&tracker->mutex, NULL);
+    trackers[free_slot] = tracker;
+    return tracker;
+}
+
+static void emit_event(detection_result_t *events, const detection_t *det, int track_id,
+                       track_event_t event) {
+    detection_t *out = &events->detections[events->count++];
+    memcpy(out, det, sizeof(detection_t));
+    out->track_id = track_id;
+    out->track_event = event;
+}
+
+static track_t *add_track(stream_tracker_t *tracker, const detection_t *det, int id, bool external) {
+    if (tracker->track_count >= MAX_TRACKS_PER_STREAM) {
+        return NULL;
+    }
+    track_t *t = &tracker->tracks[tracker->track_count++];
+    memset(t, 0, sizeof(*t));
+    t->id = id;
+    t->external = external;
+    safe_strcpy(t->label, det->label, sizeof(t->label), 0);
+    track_init_filters(t, det);
+    return t;
+}
+
+int object_tracker_process(const char *stream_name, detection_result_t *result,
+                           time_t now, detection_result_t *events) {
+    if (!events) {
+        return -1;
+    }
+    memset(events, 0, sizeof(detection_result_t));
+    if (!stream_name || !result) {
+        return -1;
+    }
+
+    if (!g_config.tracking_enabled) {
+        memcpy(events, result, sizeof(detection_result_t));
+        for (int i = 0; i < events->count && i < MAX_DETECTIONS; i++) {
+            events->detections[i].track_event = TRACK_EVENT_NONE;
+        }
+        return 0;
+    }
+
+    // Take the tracker lock before dropping the registry lock so that
+    // object_tracker_reset() cannot free it underneath us
+    pthread_mutex_lock(&trackers_mutex);
+    stream_tracker_t *tracker = get_stream_tracker(stream_name);
+    if (tracker) {
+        pthread_mutex_lock(&tracker->mutex);
+    }
+    pthread_mutex_unlock(&trackers_mutex);
+    if (!tracker) {
+        log_warn("No tracker available for stream %s, storing raw detections", stream_name);
+        memcpy(events, result, sizeof(detection_result_t));
+        return -1;
+    }
+
+    int update_interval = g_config.track_update_interval;
+    int max_misses = g_config.track_max_misses;
+
+    for (int t = 0; t < tracker->track_count; t++) {
+        for (int k = 0; k < 4; k++) {
+            kf1_predict(&tracker->tracks[t].kf[k]);
+        }
+        tracker->tracks[t].matched = false;
+    }
+
+    int det_track[MAX_DETECTIONS];      // index into tracks[], -1 if unmatched
+    bool det_new[MAX_DETECTIONS];
+    int count = result->count < MAX_DETECTIONS ? result->count : MAX_DETECTIONS;
+
+    // Detections with a track_id from the detector follow that id
+    for (int d = 0; d < count; d++) {
+        detection_t *det = &result->detections[d];
+        det_track[d] = -1;
+        det_new[d] = false;
+        if (det->track_id < 0) {
+            continue;
+        }
+        for (int t = 0; t < tracker->track_count; t++) {
+            track_t *tr = &tracker->tracks[t];
+            if (tr->external && tr->id == det->track_id && !tr->matched) {
+                det_track[d] = t;
+                tr->matched = true;
+                break;
+            }
+        }
+        if (det_track[d] < 0 && add_track(tracker, det, det->track_id, true)) {
+            det_track[d] = tracker->track_count - 1;
+            det_new[d] = true;
+            tracker->tracks[det_track[d]].matched = true;
+        }
+    }
+
+    // Greedy IoU association for everything else: repeatedly take the best
+    // remaining (track, detection) pair above the threshold
+    int existing = tracker->track_count;
+    for (;;) {
+        float best = TRACK_MATCH_IOU;
+        int best_d = -1, best_t = -1;
+        for (int d = 0; d < count; d++) {
+            const detection_t *det = &result->detections[d];
+            if (det->track_id >= 0 || det_track[d] >= 0) continue;
+            for (int t = 0; t < existing; t++) {
+                const track_t *tr = &tracker->tracks[t];
+                if (tr->external || tr->matched || strcmp(tr->label, det->label) != 0) continue;
+                float iou = track_predicted_iou(tr, det);
+                if (iou >= best) {
+                    best = iou;
+                    best_d = d;
+                    best_t = t;
+                }
+            }
+        }
+        if (best_d < 0) break;
+        det_track[best_d] = best_t;
+        tracker->tracks[best_t].matched = true;
+    }
+
+    // Unmatched detections start new tracks
+    for (int d = 0; d < count; d++) {
+        detection_t *det = &result->detections[d];
+        if (det_track[d] >= 0 || det->track_id >= 0) continue;
+        if (add_track(tracker, det, atomic_fetch_add(&next_track_id, 1), false)) {
+            det_track[d] = tracker->track_count - 1;
+            det_new[d] = true;
+            tracker->tracks[det_track[d]].matched = true;
+        }
+    }
+
+    // Matched tracks: correct the filter and decide whether to store
+    for (int d = 0; d < count; d++) {
+        detection_t *det = &result->detections[d];
+        if (det_track[d] < 0) {
+            // Track table full: pass the raw detection through untracked
+            emit_event(events, det, -1, TRACK_EVENT_NONE);
+            continue;
+        }
+
+        track_t *tr = &tracker->tracks[det_track[d]];
+        det->track_id = tr->id;
+        if (!det_new[d]) {
+            track_update_filters(tr, det);
+        }
+        tr->misses = 0;
+        memcpy(&tr->last, det, sizeof(detection_t));
+
+        track_event_t event = TRACK_EVENT_NONE;
+        if (det_new[d]) {
+            event = TRACK_EVENT_START;
+        } else if (now - tr->stored_time >= update_interval ||
+                   detection_iou(det, &tr->stored) < TRACK_MOVED_IOU) {
+            event = TRACK_EVENT_UPDATE;
+        }
+
+        if (event != TRACK_EVENT_NONE) {
+            emit_event(events, det, tr->id, event);
+            memcpy(&tr->stored, det, sizeof(detection_t));
+            tr->stored_time = now;
+        }
+    }
+
+    // Unmatched tracks age out; an end event carries the last known box
+    for (int t = 0; t < tracker->track_count; ) {
+        track_t *tr = &tracker->tracks[t];
+        if (tr->matched || ++tr->misses <= max_misses) {
+            t++;
+            continue;
+        }
+        if (events->count >= MAX_DETECTIONS) {
+            // No room this frame; the track ends on the next one
+            t++;
+            continue;
+        }
+        emit_event(events, &tr->last, tr->id, TRACK_EVENT_END);
+        log_debug("[%s] Track %d (%s) ended", stream_name, tr->id, tr->label);
+        tracker->tracks[t] = tracker->tracks[--tracker->track_count];
+    }
+
+    tracker->frames++;
+    tracker->detections += (uint64_t)count;
+    tracker->events += (uint64_t)events->count;
+    if (events->count > 0) {
+        log_debug("[%s] Tracker: %d detections -> %d events (%d active tracks, %llu/%llu stored overall)",
+                  stream_name, count, events->count, tracker->track_count,
+                  (unsigned long long)tracker->events, (unsigned long long)tracker->detections);
+    }
+
+    pthread_mutex_unlock(&tracker->mutex);
+    return 0;
+}
+
+void object_tracker_reset(const char *stream_name) {
+    pthread_mutex_lock(&trackers_mutex);
+    for (int i = 0; i < MAX_STREAMS; i++) {
+        if (trackers[i] &&
+            (!stream_name || strcmp(trackers[i]->stream_name, stream_name) == 0)) {
+            // Wait for an in-flight object_tracker_process() to finish
+            pthread_mutex_lock(&trackers[i]->mutex);
+            pthread_mutex_unlock(&trackers[i]->mutex);
+            pthread_mutex_destroy(&trackers[i]->mutex);
+            free(trackers[i]);
+            trackers[i] = NULL;
+        }
+    }
+    pthread_mutex_unlock(&trackers_mutex);
+}
+
+const char *track_event_name(track_event_t event) {
+    switch (event) {
+        case TRACK_EVENT_START:  return "start";
+        case TRACK_EVENT_UPDATE: return "update";
+        case TRACK_EVENT_END:    return "end";
+        default:                 return NULL;
+    }
+}
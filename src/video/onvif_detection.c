@@ -21,6 +21,7 @@
 #include "video/detection_result.h"
 #include "video/cross_stream_motion_trigger.h"
 #include "video/zone_filter.h"
+#include "video/object_tracker.h"
 #include "database/db_detections.h"
 #include "ezxml.h"
 
@@ -717,13 +718,17 @@ int detect_motion_onvif(const char *onvif_url, const char *username, const char
                 log_warn("Failed to filter detections by zones, storing all detections");
             }
 
-            // Store the detection in the database (no recording_id linkage for ONVIF)
+            // Store and publish track events (no recording_id linkage for ONVIF)
             time_t timestamp = time(NULL);
-            store_detections_in_db(stream_name, result, timestamp, 0);
+            detection_result_t events;
+            object_tracker_process(stream_name, result, timestamp, &events);
+            if (events.count > 0) {
+                queue_detections_for_db(stream_name, &events, timestamp, 0);
+                mqtt_publish_detection(stream_name, &events, timestamp);
+            }
 
-            // Publish to MQTT and trigger motion recording if detections remain after filtering
+            // Trigger motion recording if detections remain after filtering
             if (result->count > 0) {
-                mqtt_publish_detection(stream_name, result, timestamp);
                 process_motion_event(stream_name, true, timestamp, false);
             }
         } else {
@@ -735,7 +740,17 @@ int detect_motion_onvif(const char *onvif_url, const char *username, const char
 
         // Notify motion recording that motion has ended
         if (stream_name && stream_name[0] != '\0') {
-            process_motion_event(stream_name, false, time(NULL), false);
+            time_t timestamp = time(NULL);
+
+            // Let the tracker age out the motion track and store its end event
+            detection_result_t events;
+            object_tracker_process(stream_name, result, timestamp, &events);
+            if (events.count > 0) {
+                queue_detections_for_db(stream_name, &events, timestamp, 0);
+                mqtt_publish_detection(stream_name, &events, timestamp);
+            }
+
+            process_motion_event(stream_name, false, timestamp, false);
         }
     }
 
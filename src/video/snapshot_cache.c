@@ -0,0 +1,307 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "core/config.h"
+#include "core/logger.h"
+#include "utils/strings.h"
+#include "video/go2rtc/go2rtc_snapshot.h"
+#include "video/snapshot_cache.h"
+
+typedef struct {
+    bool in_use;
+    char name[MAX_STREAM_NAME];
+    snapshot_t *current;            // Newest JPEG, one reference held by the cache
+    bool fetching;                  // A caller is fetching from go2rtc
+    bool last_fetch_ok;
+    uint64_t fetch_gen;             // Completed fetches, wakes the waiters of one fetch
+    int waiters;
+    int64_t last_used_ms;
+} snapshot_entry_t;
+
+static snapshot_entry_t entries[MAX_STREAMS];
+static snapshot_cache_stats_t stats;
+static pthread_mutex_t cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cache_cond = PTHREAD_COND_INITIALIZER;
+
+static int64_t monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static snapshot_t *new_snapshot(unsigned char *data, size_t size) {
+    snapshot_t *s = calloc(1, sizeof(snapshot_t));
+    if (!s) {
+        return NULL;
+    }
+    s->data = data;
+    s->size = size;
+    s->captured_ms = monotonic_ms();
+    s->refs = 1;
+    return s;
+}
+
+static void free_snapshot(snapshot_t *s) {
+    free(s->data);
+    free(s);
+}
+
+// Drop one reference. Caller holds cache_mutex; returns the snapshot if it
+// must be freed once the lock is released.
+static snapshot_t *unref_snapshot(snapshot_t *s) {
+    if (s && --s->refs == 0) {
+        return s;
+    }
+    return NULL;
+}
+
+// Caller holds cache_mutex
+static snapshot_entry_t *find_entry(const char *name) {
+    for (int i = 0; i < MAX_STREAMS; i++) {
+        if (entries[i].in_use && strcmp(entries[i].name, name) == 0) {
+            return &entries[i];
+        }
+    }
+    return NULL;
+}
+
+// Caller holds cache_mutex. Reuses the least recently used idle entry when
+// the table is full; *evicted receives its snapshot to free after unlocking.
+static snapshot_entry_t *add_entry(const char *name, snapshot_t **evicted) {
+    snapshot_entry_t *e = NULL;
+    for (int i = 0; i < MAX_STREAMS; i++) {
+        snapshot_entry_t *c = &entries[i];
+        if (!c->in_use) {
+            e = c;
+            break;
+        }
+        if (!c->fetching && c->waiters == 0 && (!e || c->last_used_ms < e->last_used_ms)) {
+            e = c;
+        }
+    }
+    if (!e) {
+        return NULL;
+    }
+    if (e->in_use) {
+        *evicted = unref_snapshot(e->current);
+    }
+    memset(e, 0, sizeof(*e));
+    e->in_use = true;
+    safe_strcpy(e->name, name, sizeof(e->name), 0);
+    return e;
+}
+
+// Fetch a JPEG from go2rtc; the returned snapshot holds one reference
+static snapshot_t *fetch_snapshot(const char *stream_name) {
+    unsigned char *data = NULL;
+    size_t size = 0;
+
+    if (!go2rtc_get_snapshot(stream_name, &data, &size) || !data || size == 0) {
+        free(data);
+        return NULL;
+    }
+    snapshot_t *s = new_snapshot(data, size);
+    if (!s) {
+        free(data);
+    }
+    return s;
+}
+
+snapshot_t *snapshot_cache_get(const char *stream_name, int max_age_ms) {
+    if (!stream_name || stream_name[0] == '\0') {
+        return NULL;
+    }
+    if (max_age_ms < 0) {
+        max_age_ms = g_config.go2rtc_snapshot_max_age_ms;
+    }
+
+    snapshot_t *evicted = NULL;
+    snapshot_t *result = NULL;
+
+    pthread_mutex_lock(&cache_mutex);
+    snapshot_entry_t *e = find_entry(stream_name);
+    if (!e) {
+        e = add_entry(stream_name, &evicted);
+    }
+    if (!e) {
+        // Every entry is busy: fetch without caching
+        pthread_mutex_unlock(&cache_mutex);
+        return fetch_snapshot(stream_name);
+    }
+
+    int64_t now = monotonic_ms();
+    e->last_used_ms = now;
+
+    if (e->current && now - e->current->captured_ms <= max_age_ms) {
+        result = e->current;
+        result->refs++;
+        stats.hits++;
+        pthread_mutex_unlock(&cache_mutex);
+        goto done;
+    }
+
+    if (e->fetching) {
+        // Another caller is already fetching this stream; share its result
+        uint64_t gen = e->fetch_gen;
+        stats.coalesced++;
+        e->waiters++;
+        while (e->fetch_gen == gen) {
+            pthread_cond_wait(&cache_cond, &cache_mutex);
+        }
+        e->waiters--;
+        if (e->last_fetch_ok && e->current) {
+            result = e->current;
+            result->refs++;
+        }
+        pthread_mutex_unlock(&cache_mutex);
+        goto done;
+    }
+
+    e->fetching = true;
+    pthread_mutex_unlock(&cache_mutex);
+
+    // The entry cannot be evicted or reused while fetching is set
+    result = fetch_snapshot(stream_name);
+
+    pthread_mutex_lock(&cache_mutex);
+    e->fetching = false;
+    e->fetch_gen++;
+    e->last_fetch_ok = result != NULL;
+    if (result) {
+        stats.fetches++;
+        if (e->in_use) {
+            evicted = unref_snapshot(e->current);
+            result->refs++;     // The cache's reference
+            e->current = result;
+        }
+    } else {
+        stats.fetch_failures++;
+    }
+    pthread_cond_broadcast(&cache_cond);
+    pthread_mutex_unlock(&cache_mutex);
+
+done:
+    if (evicted) {
+        free_snapshot(evicted);
+    }
+    return result;
+}
+
+void snapshot_release(snapshot_t *snapshot) {
+    if (!snapshot) {
+        return;
+    }
+
+    pthread_mutex_lock(&cache_mutex);
+    snapshot_t *to_free = unref_snapshot(snapshot);
+    pthread_mutex_unlock(&cache_mutex);
+
+    if (to_free) {
+        free_snapshot(to_free);
+    }
+}
+
+void snapshot_cache_put(const char *stream_name, const unsigned char *jpeg, size_t size) {
+    if (!stream_name || stream_name[0] == '\0' || !jpeg || size == 0) {
+        return;
+    }
+
+    unsigned char *data = malloc(size);
+    if (!data) {
+        return;
+    }
+    memcpy(data, jpeg, size);
+    snapshot_t *s = new_snapshot(data, size);
+    if (!s) {
+        free(data);
+        return;
+    }
+
+    snapshot_t *old = NULL;
+    snapshot_t *evicted = NULL;
+
+    pthread_mutex_lock(&cache_mutex);
+    snapshot_entry_t *e = find_entry(stream_name);
+    if (!e) {
+        e = add_entry(stream_name, &evicted);
+    }
+    if (e) {
+        old = unref_snapshot(e->current);
+        e->current = s;
+        e->last_used_ms = s->captured_ms;
+        stats.stored++;
+        s = NULL;
+    }
+    pthread_mutex_unlock(&cache_mutex);
+
+    if (s) {
+        free_snapshot(s);
+    }
+    if (old) {
+        free_snapshot(old);
+    }
+    if (evicted) {
+        free_snapshot(evicted);
+    }
+}
+
+void snapshot_cache_remove(const char *stream_name) {
+    if (!stream_name) {
+        return;
+    }
+
+    snapshot_t *old = NULL;
+
+    pthread_mutex_lock(&cache_mutex);
+    snapshot_entry_t *e = find_entry(stream_name);
+    if (e) {
+        old = unref_snapshot(e->current);
+        e->current = NULL;
+        // A running fetch or its waiters still use the entry; it is
+        // reused once they are done
+        if (!e->fetching && e->waiters == 0) {
+            memset(e, 0, sizeof(*e));
+        }
+    }
+    pthread_mutex_unlock(&cache_mutex);
+
+    if (old) {
+        free_snapshot(old);
+    }
+}
+
+void snapshot_cache_get_stats(snapshot_cache_stats_t *out) {
+    if (!out) {
+        return;
+    }
+
+    pthread_mutex_lock(&cache_mutex);
+    *out = stats;
+    pthread_mutex_unlock(&cache_mutex);
+}
+
+void snapshot_cache_cleanup(void) {
+    int freed = 0;
+
+    pthread_mutex_lock(&cache_mutex);
+    for (int i = 0; i < MAX_STREAMS; i++) {
+        snapshot_entry_t *e = &entries[i];
+        if (!e->in_use || e->fetching || e->waiters > 0) {
+            continue;
+        }
+        snapshot_t *old = unref_snapshot(e->current);
+        if (old) {
+            free_snapshot(old);
+        }
+        memset(e, 0, sizeof(*e));
+        freed++;
+    }
+    pthread_mutex_unlock(&cache_mutex);
+
+    log_info("Snapshot cache cleaned up (%d streams)", freed);
+}
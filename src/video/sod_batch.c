@@ -0,0 +1,417 @@
+/**
+ * Cross-stream batched SOD CNN inference
+ *
+ * One batcher exists per model path. Each owns a single sod_cnn and a worker
+ * thread; detection threads enqueue a converted frame and sleep until the
+ * worker has run the batch that contains it. See sod_batch.h.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <time.h>
+#include <stdatomic.h>
+
+#include "core/logger.h"
+#include "core/config.h"  // For MAX_PATH_LENGTH
+#include "utils/strings.h"
+#include "video/detection_result.h"
+#include "video/sod_detection.h"
+#include "video/sod_batch.h"
+#ifdef SOD_ENABLED
+#include "sod/sod.h"
+#endif
+
+// Maximum number of distinct models that can be batched at once
+#define MAX_SOD_BATCHERS 8
+
+static int batch_max_size = 1;
+static int batch_max_latency_ms = 50;
+static atomic_bool batch_enabled = false;
+
+static atomic_uint_fast64_t batch_frames = 0;
+static atomic_uint_fast64_t batch_passes = 0;
+
+#ifdef SOD_ENABLED
+
+typedef struct batch_request {
+    sod_img img;                    // Frame converted to CHW float, owned by the submitter
+    float threshold;
+    detection_result_t *result;
+    int status;                     // 1 while pending, then 0 or -1 (guarded by the batcher mutex)
+    bool predicted;                 // Set by the worker outside the lock once boxes are converted
+    struct timespec deadline;       // When the worker must stop waiting for more frames
+    struct batch_request *next;
+} batch_request_t;
+
+typedef struct {
+    char path[MAX_PATH_LENGTH];
+    sod_cnn *net;
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t work_cond;       // Signalled when a request is queued or on shutdown
+    pthread_cond_t done_cond;       // Broadcast when a batch completes
+    batch_request_t *head;
+    batch_request_t *tail;
+    int queued;
+    bool running;
+    int users;                      // Callers holding this batcher (guarded by batchers_mutex)
+    bool detached;                  // Removed at shutdown; the last user frees it
+} sod_batcher_t;
+
+static sod_batcher_t *batchers[MAX_SOD_BATCHERS] = {NULL};
+static pthread_mutex_t batchers_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Per-image callback from sod_cnn_predict_batch()
+ * The box array is only valid for the duration of the call.
+ */
+static void batch_consume_boxes(int index, sod_box *boxes, int count, void *user_data) {
+    batch_request_t **batch = (batch_request_t **)user_data;
+    batch_request_t *req = batch[index];
+
+    sod_boxes_to_detection_result(boxes, count, req->img.w, req->img.h, req->threshold, req->result);
+    req->predicted = true;
+}
+
+/**
+ * Run one forward pass over the given requests
+ */
+static void batch_run(sod_batcher_t *b, batch_request_t **batch, int n) {
+    sod_img images[n];
+    float min_threshold = batch[0]->threshold;
+
+    for (int i = 0; i < n; i++) {
+        images[i] = batch[i]->img;
+        if (batch[i]->threshold < min_threshold) {
+            min_threshold = batch[i]->threshold;
+        }
+    }
+
+    // The network keeps boxes above its own threshold; each caller then
+    // filters with its own, so use the loosest one in this batch
+    sod_cnn_config(b->net, SOD_CNN_DETECTION_THRESHOLD, (double)min_threshold);
+
+    int rc = sod_cnn_predict_batch(b->net, images, n, batch_consume_boxes, batch);
+    if (rc != SOD_OK) {
+        log_error("Batched SOD prediction failed for %s (rc=%d, batch=%d)", b->path, rc, n);
+    }
+}
+
+/**
+ * Batch worker thread
+ */
+static void *batch_worker(void *arg) {
+    sod_batcher_t *b = (sod_batcher_t *)arg;
+    batch_request_t *batch[batch_max_size];
+
+    pthread_mutex_lock(&b->mutex);
+    while (b->running) {
+        if (!b->head) {
+            pthread_cond_wait(&b->work_cond, &b->mutex);
+            continue;
+        }
+
+        // Wait for the batch to fill, but never past the oldest frame's deadline
+        int rc = 0;
+        while (b->running && b->queued < batch_max_size && rc != ETIMEDOUT) {
+            rc = pthread_cond_timedwait(&b->work_cond, &b->mutex, &b->head->deadline);
+        }
+        if (!b->running) {
+            break;
+        }
+
+        int n = 0;
+        while (b->head && n < batch_max_size) {
+            batch[n++] = b->head;
+            b->head = b->head->next;
+            b->queued--;
+        }
+        if (!b->head) {
+            b->tail = NULL;
+        }
+        pthread_mutex_unlock(&b->mutex);
+
+        batch_run(b, batch, n);
+
+        pthread_mutex_lock(&b->mutex);
+        for (int i = 0; i < n; i++) {
+            batch[i]->status = batch[i]->predicted ? 0 : -1;
+        }
+        atomic_fetch_add(&batch_frames, n);
+        atomic_fetch_add(&batch_passes, 1);
+        pthread_cond_broadcast(&b->done_cond);
+    }
+
+    // Release anyone still queued
+    for (batch_request_t *r = b->head; r; r = r->next) {
+        r->status = -1;
+    }
+    b->head = b->tail = NULL;
+    b->queued = 0;
+    pthread_cond_broadcast(&b->done_cond);
+    pthread_mutex_unlock(&b->mutex);
+
+    return NULL;
+}
+
+/**
+ * Free a stopped batcher whose worker has been joined
+ * Must be called with batchers_mutex held and no users left.
+ */
+static void free_batcher(sod_batcher_t *b) {
+    sod_cnn_destroy(b->net);
+    pthread_mutex_destroy(&b->mutex);
+    pthread_cond_destroy(&b->work_cond);
+    pthread_cond_destroy(&b->done_cond);
+    log_info("Stopped SOD batch worker for %s", b->path);
+    free(b);
+}
+
+/**
+ * Find the batcher for a model path, creating it if needed
+ * The caller holds a reference until it calls put_batcher().
+ */
+static sod_batcher_t *get_batcher(const char *model_path) {
+    pthread_mutex_lock(&batchers_mutex);
+    if (!atomic_load(&batch_enabled)) {
+        pthread_mutex_unlock(&batchers_mutex);
+        return NULL;
+    }
+
+    int free_slot = -1;
+    for (int i = 0; i < MAX_SOD_BATCHERS; i++) {
+        if (batchers[i] && strcmp(batchers[i]->path, model_path) == 0) {
+            sod_batcher_t *b = batchers[i];
+            b->users++;
+            pthread_mutex_unlock(&batchers_mutex);
+            return b;
+        }
+        if (!batchers[i] && free_slot < 0) {
+            free_slot = i;
+        }
+    }
+
+    if (free_slot < 0) {
+        log_error("No free SOD batcher slot for model %s (max %d)", model_path, MAX_SOD_BATCHERS);
+        pthread_mutex_unlock(&batchers_mutex);
+        return NULL;
+    }
+
+    sod_batcher_t *b = calloc(1, sizeof(sod_batcher_t));
+    if (!b) {
+        log_error("Failed to allocate SOD batcher");
+        pthread_mutex_unlock(&batchers_mutex);
+        return NULL;
+    }
+
+    const char *err_msg = NULL;
+    int rc = sod_cnn_create(&b->net, get_sod_model_arch(model_path), model_path, &err_msg);
+    if (rc != SOD_OK || !b->net) {
+        log_error("Failed to load shared SOD model: %s - %s", model_path, err_msg ? err_msg : "Unknown error");
+        free(b);
+        pthread_mutex_unlock(&batchers_mutex);
+        return NULL;
+    }
+
+    safe_strcpy(b->path, model_path, sizeof(b->path), 0);
+    pthread_mutex_init(&b->mutex, NULL);
+    pthread_cond_init(&b->work_cond, NULL);
+    pthread_cond_init(&b->done_cond, NULL);
+    b->running = true;
+
+    if (pthread_create(&b->thread, NULL, batch_worker, b) != 0) {
+        log_error("Failed to start SOD batch worker for %s", model_path);
+        sod_cnn_destroy(b->net);
+        pthread_mutex_destroy(&b->mutex);
+        pthread_cond_destroy(&b->work_cond);
+        pthread_cond_destroy(&b->done_cond);
+        free(b);
+        pthread_mutex_unlock(&batchers_mutex);
+        return NULL;
+    }
+
+    b->users = 1;
+    batchers[free_slot] = b;
+    pthread_mutex_unlock(&batchers_mutex);
+
+    log_info("Started SOD batch worker for %s (batch_size=%d, latency=%dms)",
+             model_path, batch_max_size, batch_max_latency_ms);
+    return b;
+}
+
+/**
+ * Drop a reference taken by get_batcher()
+ * Frees the batcher if shutdown detached it while this caller was inside.
+ */
+static void put_batcher(sod_batcher_t *b) {
+    pthread_mutex_lock(&batchers_mutex);
+    if (--b->users == 0 && b->detached) {
+        free_batcher(b);
+    }
+    pthread_mutex_unlock(&batchers_mutex);
+}
+
+#endif /* SOD_ENABLED */
+
+/**
+ * Initialize the batching system
+ */
+int init_sod_batch_system(int max_batch, int max_latency_ms) {
+    batch_max_size = max_batch > 1 ? max_batch : 1;
+    batch_max_latency_ms = max_latency_ms > 0 ? max_latency_ms : 1;
+#ifdef SOD_ENABLED
+    batch_enabled = batch_max_size > 1;
+#else
+    batch_enabled = false;
+#endif
+
+    if (batch_enabled) {
+        log_info("Cross-stream SOD batching enabled (batch_size=%d, latency=%dms)",
+                 batch_max_size, batch_max_latency_ms);
+    }
+    return 0;
+}
+
+/**
+ * Stop all batch workers
+ */
+void shutdown_sod_batch_system(void) {
+    bool was_enabled = atomic_exchange(&batch_enabled, false);
+
+#ifdef SOD_ENABLED
+    // get_batcher() checks batch_enabled under batchers_mutex, so no new
+    // batcher can appear once this loop has emptied the table
+    pthread_mutex_lock(&batchers_mutex);
+    for (int i = 0; i < MAX_SOD_BATCHERS; i++) {
+        sod_batcher_t *b = batchers[i];
+        if (!b) {
+            continue;
+        }
+        batchers[i] = NULL;
+
+        pthread_mutex_lock(&b->mutex);
+        b->running = false;
+        pthread_cond_broadcast(&b->work_cond);
+        pthread_mutex_unlock(&b->mutex);
+        pthread_join(b->thread, NULL);
+
+        // The worker has failed every queued request, but their callers may
+        // not have woken yet; the last of them frees the batcher
+        if (b->users > 0) {
+            b->detached = true;
+        } else {
+            free_batcher(b);
+        }
+    }
+    pthread_mutex_unlock(&batchers_mutex);
+#endif
+
+    if (was_enabled) {
+        log_info("SOD batching processed %llu frames in %llu passes",
+                 (unsigned long long)atomic_load(&batch_frames),
+                 (unsigned long long)atomic_load(&batch_passes));
+    }
+}
+
+/**
+ * Check whether cross-stream batching is active
+ */
+bool sod_batch_enabled(void) {
+    return batch_enabled;
+}
+
+/**
+ * Load the shared network for a model path
+ */
+int sod_batch_acquire(const char *model_path) {
+#ifdef SOD_ENABLED
+    if (!batch_enabled || !model_path) {
+        return -1;
+    }
+    sod_batcher_t *b = get_batcher(model_path);
+    if (!b) {
+        return -1;
+    }
+    put_batcher(b);
+    return 0;
+#else
+    (void)model_path;
+    return -1;
+#endif
+}
+
+/**
+ * Run detection on a frame through the shared batch worker
+ */
+int sod_batch_detect(const char *model_path, float threshold, const unsigned char *frame_data,
+                     int width, int height, int channels, detection_result_t *result) {
+#ifdef SOD_ENABLED
+    if (!batch_enabled || !model_path || !frame_data || !result) {
+        return -1;
+    }
+
+    sod_batcher_t *b = get_batcher(model_path);
+    if (!b) {
+        return -1;
+    }
+
+    batch_request_t req;
+    memset(&req, 0, sizeof(req));
+    req.img = sod_make_image(width, height, channels);
+    if (!req.img.data) {
+        log_error("Failed to create SOD image for batched detection");
+        put_batcher(b);
+        return -1;
+    }
+    sod_frame_to_chw(frame_data, width, height, channels, req.img.data);
+    req.threshold = threshold;
+    req.result = result;
+    req.status = 1;
+    result->count = 0;
+
+    clock_gettime(CLOCK_REALTIME, &req.deadline);
+    req.deadline.tv_nsec += (long)batch_max_latency_ms * 1000000L;
+    req.deadline.tv_sec += req.deadline.tv_nsec / 1000000000L;
+    req.deadline.tv_nsec %= 1000000000L;
+
+    pthread_mutex_lock(&b->mutex);
+    if (!b->running) {
+        pthread_mutex_unlock(&b->mutex);
+        put_batcher(b);
+        sod_free_image(req.img);
+        return -1;
+    }
+    if (b->tail) {
+        b->tail->next = &req;
+    } else {
+        b->head = &req;
+    }
+    b->tail = &req;
+    b->queued++;
+    pthread_cond_signal(&b->work_cond);
+
+    while (req.status == 1) {
+        pthread_cond_wait(&b->done_cond, &b->mutex);
+    }
+    pthread_mutex_unlock(&b->mutex);
+    put_batcher(b);
+
+    sod_free_image(req.img);
+    return req.status == 0 ? 0 : -1;
+#else
+    (void)model_path; (void)threshold; (void)frame_data;
+    (void)width; (void)height; (void)channels; (void)result;
+    return -1;
+#endif
+}
+
+/**
+ * Get cumulative batching statistics
+ */
+void sod_batch_get_stats(uint64_t *frames, uint64_t *passes) {
+    if (frames) *frames = atomic_load(&batch_frames);
+    if (passes) *passes = atomic_load(&batch_passes);
+}
@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <stdbool.h>
 #include <dlfcn.h>
 #include <pthread.h>
@@ -21,6 +22,8 @@
 #include "video/detection_model.h"
 #include "video/detection_model_internal.h"
 #include "video/sod_detection.h"
+#include "video/sod_batch.h"
+#include "video/model_registry.h"
 #ifdef SOD_ENABLED
 #include "sod/sod.h"
 
@@ -66,6 +69,9 @@ int init_sod_detection_system(void) {
         // Static linking approach - SOD functions are directly available
         log_info("SOD detection initialized with static linking");
         sod_available = true;
+        sod_cnn_set_threads(g_config.sod_threads);
+        sod_cnn_set_weight_mapping(g_config.mmap_model_weights);
+        init_sod_batch_system(g_config.sod_batch_max_size, g_config.sod_batch_max_latency_ms);
     return 0;
 #else
     log_error("SOD support is not enabled at compile time");
@@ -84,6 +90,9 @@ void shutdown_sod_detection_system(void) {
     // Add a small delay to allow any in-progress operations to detect the flag change
     usleep(100000); // 100ms
 
+    // Stop the shared batch workers (releases any callers still waiting)
+    shutdown_sod_batch_system();
+
     log_info("SOD detection system shutdown");
 }
 
@@ -128,6 +137,84 @@ static void add_to_cleaned_models(void *model_ptr) {
     pthread_mutex_unlock(&cleaned_models_mutex);
 }
 
+#ifdef SOD_ENABLED
+/**
+ * Load the weights of a SOD CNN model version (model registry loader)
+ */
+static void *load_sod_version(const char *model_path, float threshold) {
+    sod_cnn *cnn = NULL;
+    const char *err_msg = NULL;
+
+    int rc = sod_cnn_create(&cnn, get_sod_model_arch(model_path), model_path, &err_msg);
+    if (rc != SOD_OK || !cnn) {
+        log_error("Failed to load SOD model: %s - %s", model_path, err_msg ? err_msg : "Unknown error");
+        return NULL;
+    }
+    sod_cnn_config(cnn, SOD_CNN_DETECTION_THRESHOLD, threshold);
+    return cnn;
+}
+
+static void free_sod_version(void *shared) {
+    sod_cnn_destroy((sod_cnn *)shared);
+}
+
+/**
+ * Get a network of a model version for one handle
+ *
+ * The first handle runs on the network the weights were loaded into; the
+ * others get their own activations on top of the same weights, so streams
+ * sharing a model still predict in parallel.
+ */
+static sod_cnn *attach_sod_instance(model_version_t *version, const char *model_path, float threshold) {
+    sod_cnn *base = (sod_cnn *)model_version_shared(version);
+    if (model_version_claim(version)) {
+        return base;
+    }
+
+    sod_cnn *cnn = NULL;
+    const char *err_msg = NULL;
+    int rc = sod_cnn_create_shared(&cnn, get_sod_model_arch(model_path), base, &err_msg);
+    if (rc != SOD_OK || !cnn) {
+        log_error("Failed to create SOD network on shared weights of %s - %s", model_path,
+                  err_msg ? err_msg : "Unknown error");
+        return NULL;
+    }
+    sod_cnn_config(cnn, SOD_CNN_DETECTION_THRESHOLD, threshold);
+    return cnn;
+}
+
+static void detach_sod_instance(model_version_t *version, void *cnn) {
+    if (cnn == model_version_shared(version)) {
+        model_version_unclaim(version);
+    } else if (cnn) {
+        sod_cnn_destroy((sod_cnn *)cnn);
+    }
+}
+
+/**
+ * Move a handle to the newest version of its model after the file changed
+ */
+static void refresh_sod_model(model_t *m) {
+    model_version_t *latest = model_registry_check_update(m->version);
+    if (!latest) {
+        return;
+    }
+
+    sod_cnn *cnn = attach_sod_instance(latest, m->path, m->threshold);
+    if (!cnn) {
+        // Keep detecting with the previous weights
+        model_registry_release(latest);
+        return;
+    }
+
+    detach_sod_instance(m->version, m->sod);
+    model_registry_release(m->version);
+    m->sod = cnn;
+    m->version = latest;
+    log_info("SOD model %s switched to generation %u", m->path, model_version_generation(latest));
+}
+#endif /* SOD_ENABLED */
+
 /**
  * Safely clean up a SOD model
  * This function ensures proper cleanup of SOD model resources
@@ -148,6 +235,21 @@ void cleanup_sod_model(detection_model_t model) {
 
     log_info("Cleaning up SOD model: %s", m->path);
 
+#ifdef SOD_ENABLED
+    // Networks built on registry weights are owned through the registry; the
+    // shared network may be handed to another stream later, so it must not
+    // go through the cleaned-models list below
+    if (m->version) {
+        detach_sod_instance(m->version, m->sod);
+        model_registry_release(m->version);
+        m->sod = NULL;
+        m->version = NULL;
+        free(m);
+        log_info("SOD model cleanup complete");
+        return;
+    }
+#endif
+
     // Clean up the SOD model - use a local variable to avoid double-free issues
     void *sod_model_ptr = m->sod;
 
@@ -191,14 +293,9 @@ bool is_sod_available(void) {
 }
 
 /**
- * Load a SOD model
+ * Pick the built-in SOD CNN architecture for a model file
  */
-detection_model_t load_sod_model(const char *model_path, float threshold) {
-    if (!sod_available) {
-        log_error("SOD library not available");
-        return NULL;
-    }
-
+const char *get_sod_model_arch(const char *model_path) {
     // Check if this is a face detection model based on filename or path
     // Default to ":face" for unknown models
     const char *arch = ":face";
@@ -211,6 +308,19 @@ detection_model_t load_sod_model(const char *model_path, float threshold) {
         filename = model_path; // No '/' in the path
     }
 
+    // An INT8 file quantized from a known model keeps that model's
+    // architecture: "tiny20.int8.sod" is matched as "tiny20.sod"
+    char base[256];
+    if (is_sod_int8_model(filename)) {
+        size_t len = strlen(filename) - strlen(".int8.sod");
+        if (len >= sizeof(base) - strlen(".sod")) {
+            len = sizeof(base) - strlen(".sod") - 1;
+        }
+        memcpy(base, filename, len);
+        memcpy(base + len, ".sod", strlen(".sod") + 1);
+        filename = base;
+    }
+
     // First check for exact filename matches
     if (strcmp(filename, "face_cnn.sod") == 0 ||
         strcmp(filename, "face.sod") == 0 ||
@@ -229,23 +339,162 @@ detection_model_t load_sod_model(const char *model_path, float threshold) {
         log_info("Could not determine model architecture from name, defaulting to :face for: %s", model_path);
     }
 
+    return arch;
+}
+
+/**
+ * Check whether a model path names an INT8 quantized SOD model
+ */
+bool is_sod_int8_model(const char *model_path) {
+    const char *suffix = ".int8.sod";
+    size_t len = model_path ? strlen(model_path) : 0;
+    size_t suffix_len = strlen(suffix);
+
+    return len > suffix_len && strcasecmp(model_path + len - suffix_len, suffix) == 0;
+}
+
+/**
+ * Convert packed HWC 0-255 frame data into a CHW 0-1 float buffer
+ */
+void sod_frame_to_chw(const unsigned char *frame_data, int width, int height, int channels, float *out) {
+    size_t plane = (size_t)width * (size_t)height;
+
+    for (int c = 0; c < channels; c++) {
+        float *dst = out + (size_t)c * plane;
+        const unsigned char *src = frame_data + c;
+        for (size_t i = 0; i < plane; i++) {
+            dst[i] = src[i * channels] / 255.0f;
+        }
+    }
+}
+
 #ifdef SOD_ENABLED
-    // Load the model using SOD API
-    void *sod_model = NULL;
-    const char *err_msg = NULL;
-    int rc;
+/**
+ * Convert SOD CNN boxes for a width x height frame into normalized detections
+ */
+void sod_boxes_to_detection_result(const struct sod_box *boxes, int count, int width, int height,
+                                   float threshold, detection_result_t *result) {
+    int valid_count = 0;
+
+    result->count = 0;
+    if (count <= 0 || !boxes) {
+        return;
+    }
 
-    // Use static linking
-    sod_cnn *cnn_model = NULL;
-    rc = sod_cnn_create(&cnn_model, arch, model_path, &err_msg);
+    for (int i = 0; i < count && valid_count < MAX_DETECTIONS; i++) {
+        const sod_box *box = &boxes[i];
 
-    if (rc != 0 || !cnn_model) {  // SOD_OK is 0
-        log_error("Failed to load SOD model: %s - %s", model_path, err_msg ? err_msg : "Unknown error");
+        // Log box values for debugging
+        log_debug("Box %d: x=%d, y=%d, w=%d, h=%d, score=%.2f, name=%s",
+                i, box->x, box->y, box->w, box->h, box->score,
+                box->zName ? box->zName : "unknown");
+
+        // CRITICAL FIX: Add extra validation for box values
+        if (box->x < 0 || box->y < 0 || box->w <= 0 || box->h <= 0 ||
+            box->x + box->w > width || box->y + box->h > height) {
+            log_warn("Box %d has invalid coordinates (x=%d, y=%d, w=%d, h=%d, img_w=%d, img_h=%d), skipping",
+                    i, box->x, box->y, box->w, box->h, width, height);
+            continue;
+        }
+
+        char label[MAX_LABEL_LENGTH];
+        const char *name = box->zName ? box->zName : "object";
+
+        // Extra safety check for name string
+        if (strlen(name) > 0) {
+            safe_strcpy(label, name, MAX_LABEL_LENGTH, 0);
+        } else {
+            safe_strcpy(label, "object", MAX_LABEL_LENGTH, 0);
+        }
+
+        // Clamp confidence to valid range [0.0, 1.0]
+        float confidence = box->score;
+        if (confidence > 1.0f) confidence = 1.0f;
+        if (confidence < 0.0f) confidence = 0.0f;
+
+        // Convert pixel coordinates to normalized 0-1 range with safety checks
+        float x = (width > 0) ? ((float)box->x / width) : 0.0f;
+        float y = (height > 0) ? ((float)box->y / height) : 0.0f;
+        float w = (width > 0) ? ((float)box->w / width) : 0.0f;
+        float h = (height > 0) ? ((float)box->h / height) : 0.0f;
+
+        // Clamp values to [0.0, 1.0] range
+        x = (x < 0.0f) ? 0.0f : (x > 1.0f ? 1.0f : x);
+        y = (y < 0.0f) ? 0.0f : (y > 1.0f ? 1.0f : y);
+        w = (w < 0.0f) ? 0.0f : (w > 1.0f ? 1.0f : w);
+        h = (h < 0.0f) ? 0.0f : (h > 1.0f ? 1.0f : h);
+
+        // Apply threshold
+        if (confidence < threshold) {
+            log_debug("Detection %d below threshold: %s (%.2f%%) at [%.2f, %.2f, %.2f, %.2f]",
+                    i, label, confidence * 100.0f, x, y, w, h);
+            continue;
+        }
+
+        // Add valid detection to result
+        memset(&result->detections[valid_count], 0, sizeof(result->detections[valid_count]));
+        safe_strcpy(result->detections[valid_count].label, label, MAX_LABEL_LENGTH, 0);
+        result->detections[valid_count].confidence = confidence;
+        result->detections[valid_count].x = x;
+        result->detections[valid_count].y = y;
+        result->detections[valid_count].width = w;
+        result->detections[valid_count].height = h;
+
+        log_info("Valid detection %d: %s (%.2f%%) at [%.2f, %.2f, %.2f, %.2f]",
+                valid_count, label, confidence * 100.0f, x, y, w, h);
+
+        valid_count++;
+    }
+
+    result->count = valid_count;
+    log_info("Detection found %d valid objects out of %d total", valid_count, count);
+}
+#endif /* SOD_ENABLED */
+
+/**
+ * Load a SOD model
+ */
+detection_model_t load_sod_model(const char *model_path, float threshold) {
+    if (!sod_available) {
+        log_error("SOD library not available");
         return NULL;
     }
 
-    // Store the model pointer
-    sod_model = cnn_model;
+    const char *arch = get_sod_model_arch(model_path);
+
+    // The INT8 kernels are picked by libsod from the file header; the suffix
+    // only tells us which architecture the weights were quantized from
+    if (is_sod_int8_model(model_path)) {
+        log_info("Using INT8 quantized weights for %s (%s architecture)", model_path, arch);
+    }
+
+#ifdef SOD_ENABLED
+    if (sod_batch_enabled()) {
+        // All streams share the batch worker's network; this handle only
+        // carries the path and threshold used to route frames to it
+        if (sod_batch_acquire(model_path) != 0) {
+            log_error("Failed to load shared SOD model for batching: %s", model_path);
+            return NULL;
+        }
+
+        if (threshold <= 0.0f) {
+            threshold = 0.3f;
+        }
+
+        model_t *model = (model_t *)calloc(1, sizeof(model_t));
+        if (!model) {
+            log_error("Failed to allocate memory for model structure");
+            return NULL;
+        }
+
+        safe_strcpy(model->type, MODEL_TYPE_SOD, sizeof(model->type), 0);
+        model->sod = NULL;
+        model->threshold = threshold;
+        safe_strcpy(model->path, model_path, MAX_PATH_LENGTH, 0);
+
+        log_info("SOD model %s attached to shared batch worker with threshold %.2f", model_path, threshold);
+        return model;
+    }
 
     // Set detection threshold - use same threshold as spec if not specified
     if (threshold <= 0.0f) {
@@ -253,20 +502,31 @@ detection_model_t load_sod_model(const char *model_path, float threshold) {
         log_info("Using default threshold of 0.3 for model %s", model_path);
     }
 
-    // Use static linking
-    sod_cnn_config(cnn_model, SOD_CNN_DETECTION_THRESHOLD, threshold);
+    // Streams running the same file with the same threshold share its weights
+    model_version_t *version = model_registry_acquire(model_path, threshold, load_sod_version, free_sod_version);
+    if (!version) {
+        return NULL;
+    }
+
+    sod_cnn *cnn_model = attach_sod_instance(version, model_path, threshold);
+    if (!cnn_model) {
+        model_registry_release(version);
+        return NULL;
+    }
 
     // Create model structure
-    model_t *model = (model_t *)malloc(sizeof(model_t));
+    model_t *model = (model_t *)calloc(1, sizeof(model_t));
     if (!model) {
         log_error("Failed to allocate memory for model structure");
-        sod_cnn_destroy(sod_model);
+        detach_sod_instance(version, cnn_model);
+        model_registry_release(version);
         return NULL;
     }
 
     // Initialize model structure
     safe_strcpy(model->type, MODEL_TYPE_SOD, sizeof(model->type), 0);
-    model->sod = sod_model;
+    model->sod = cnn_model;
+    model->version = version;
     model->threshold = threshold;
 
     // Store the model path in the model structure
@@ -311,239 +571,58 @@ int detect_with_sod_model(detection_model_t model, const unsigned char *frame_da
     }
 
 #ifdef SOD_ENABLED
-    // Step 1: Create a SOD image
-    log_info("Step 1: Creating SOD image from frame data (dimensions: %dx%d, channels: %d)",
-            width, height, channels);
-
-    sod_img img = sod_make_image(width, height, channels);
-    if (!img.data) {
-        log_error("Failed to create SOD image");
-        return -1;
+    // Frames for shared models go through the cross-stream batch worker
+    if (!m->sod && sod_batch_enabled()) {
+        return sod_batch_detect(m->path, m->threshold, frame_data, width, height, channels, result);
     }
 
-    // Step 2: Copy the frame data to the SOD image
-    log_info("Step 2: Copying frame data to SOD image");
-
-    // Calculate the total size of the image data with overflow check
-    size_t pixel_count = (size_t)width * (size_t)height;
-    if (pixel_count / width != height) { // Check for overflow
-        log_error("Integer overflow in image dimensions: width=%d, height=%d", width, height);
-        sod_free_image(img);
-        return -1;
+    if (m->version) {
+        refresh_sod_model(m);
     }
 
-    size_t total_size = pixel_count * channels;
-    if (total_size / pixel_count != channels) { // Check for overflow
-        log_error("Integer overflow in total size calculation: width=%d, height=%d, channels=%d",
-                 width, height, channels);
-        sod_free_image(img);
+    if (!m->sod) {
+        log_error("Model pointer is NULL before preparing image");
         return -1;
     }
 
-    // Allocate a temporary buffer to store the converted data
-    float *temp_buffer = (float *)malloc(total_size * sizeof(float));
-    if (!temp_buffer) {
-        log_error("Failed to allocate temporary buffer for image data conversion (size=%zu bytes)",
-                 total_size * sizeof(float));
-        sod_free_image(img);
+    // Check the image dimensions for overflow
+    size_t pixel_count = (size_t)width * (size_t)height;
+    if (pixel_count / width != (size_t)height) {
+        log_error("Integer overflow in image dimensions: width=%d, height=%d", width, height);
         return -1;
     }
 
-    // Initialize the temp buffer to zeros for safety
-    memset(temp_buffer, 0, total_size * sizeof(float));
-
-    // Convert the frame data from HWC to CHW format and from 0-255 to 0-1 range
-    for (int c = 0; c < channels; c++) {
-        for (int h = 0; h < height; h++) {
-            for (int w = 0; w < width; w++) {
-                // Calculate the index in the SOD image (CHW format) with overflow checks
-                size_t c_offset = (size_t)c * (size_t)height * (size_t)width;
-                size_t h_offset = (size_t)h * (size_t)width;
-                size_t sod_idx = c_offset + h_offset + w;
-
-                // Calculate the index in the frame data (HWC format) with overflow checks
-                size_t row_offset = (size_t)h * (size_t)width * (size_t)channels;
-                size_t pixel_offset = (size_t)w * (size_t)channels;
-                size_t frame_idx = row_offset + pixel_offset + c;
-
-                // Make sure the indices are within bounds
-                if (sod_idx < total_size && frame_idx < total_size) {
-                    // Convert from 0-255 to 0-1 range
-                    temp_buffer[sod_idx] = frame_data[frame_idx] / 255.0f;
-                } else {
-                    log_warn("Index out of bounds: sod_idx=%zu, frame_idx=%zu, total_size=%zu",
-                             sod_idx, frame_idx, total_size);
-                }
-            }
-        }
-    }
-
-    // Copy the converted data to the SOD image with NULL check
-    if (img.data != NULL) {
-        memcpy(img.data, temp_buffer, total_size * sizeof(float));
-    } else {
-        log_error("SOD image data pointer is NULL");
-        free(temp_buffer);
-        sod_free_image(img);
+    sod_img img = sod_make_image(width, height, channels);
+    if (!img.data) {
+        log_error("Failed to create SOD image");
         return -1;
     }
 
-    // Free the temporary buffer
-    free(temp_buffer);
-
-    log_info("Step 3: Successfully copied frame data to SOD image");
-
-    // Step 3: Prepare the image for CNN detection
-    log_info("Step 4: Preparing image for CNN detection with model=%p", (void*)m->sod);
-    float *prepared_data = NULL;
-
-    // Extra safety check for model pointer
-    if (!m->sod) {
-        log_error("Model pointer is NULL before preparing image");
-        sod_free_image(img);
-        return -1;
-    }
+    // Convert the frame data from HWC to CHW format and from 0-255 to 0-1 range
+    sod_frame_to_chw(frame_data, width, height, channels, img.data);
 
-    prepared_data = sod_cnn_prepare_image(m->sod, img);
+    float *prepared_data = sod_cnn_prepare_image(m->sod, img);
     if (!prepared_data) {
         log_error("Failed to prepare image for CNN detection");
         sod_free_image(img);
         return -1;
     }
 
-    log_info("Step 5: Successfully prepared image for CNN detection");
-
-    // Step 4: Run detection
-    log_info("Step 6: Running CNN detection");
-    int count = 0;
-    void **boxes_ptr = NULL;
-
-    // Add extra safety check
-    if (!m->sod) {
-        log_error("Model pointer is NULL before prediction");
-        // prepared_data is freed when we free the image
-        sod_free_image(img);
-        return -1;
-    }
-
-    // Step 5: Call predict
     sod_box *boxes = NULL;
-    int rc;
-
-    rc = sod_cnn_predict((sod_cnn*)m->sod, prepared_data, &boxes, &count);
-    log_info("Step 7: sod_cnn_predict returned with rc=%d, count=%d", rc, count);
+    int count = 0;
+    int rc = sod_cnn_predict((sod_cnn*)m->sod, prepared_data, &boxes, &count);
+    log_debug("sod_cnn_predict returned with rc=%d, count=%d", rc, count);
 
     if (rc != 0) { // SOD_OK is 0
         log_error("CNN detection failed with error code: %d", rc);
-        sod_free_image(img); // This also frees prepared_data
+        sod_free_image(img);
         return -1;
     }
 
-    // Extra safety check for boxes pointer
-    if (!boxes && count > 0) {
-        log_error("Boxes pointer is NULL but count is %d", count);
-        count = 0; // Reset count to avoid accessing NULL pointer
-    }
+    sod_boxes_to_detection_result(boxes, count, width, height, m->threshold, result);
 
-    // Step 6: Process detection results
-    log_info("Step 8: Processing detection results");
-
-    // Initialize result
-    result->count = 0;
-
-    // Process detection results
-    int valid_count = 0;
-
-    // Skip processing boxes if count is 0 or boxes is NULL
-    if (count <= 0 || !boxes) {
-        log_warn("No detection boxes returned (count=%d, boxes=%p)", count, (void*)boxes);
-        sod_free_image(img); // This also frees prepared_data
-        result->count = 0; // Ensure result is properly initialized
-        return 0;
-    }
-
-    log_info("Processing %d detection boxes", count);
-
-    // For static linking, boxes is already an array of sod_box structures
-
-    for (int i = 0; i < count && valid_count < MAX_DETECTIONS; i++) {
-        sod_box *box = &boxes[i];
-
-        // Log box values for debugging
-        log_info("Box %d: x=%d, y=%d, w=%d, h=%d, score=%.2f, name=%s",
-                i, box->x, box->y, box->w, box->h, box->score,
-                box->zName ? box->zName : "unknown");
-
-        // CRITICAL FIX: Add extra validation for box values
-        if (box->x < 0 || box->y < 0 || box->w <= 0 || box->h <= 0 ||
-            box->x + box->w > width || box->y + box->h > height) {
-            log_warn("Box %d has invalid coordinates (x=%d, y=%d, w=%d, h=%d, img_w=%d, img_h=%d), skipping",
-                    i, box->x, box->y, box->w, box->h, width, height);
-            continue;
-        }
-
-        // Validate zName pointer
-        if (box->zName == NULL) {
-            log_warn("Box %d has NULL name, using 'unknown'", i);
-        }
-
-        char label[MAX_LABEL_LENGTH];
-        const char *name = box->zName ? box->zName : "object";
-
-        // Extra safety check for name string
-        if (name && strlen(name) > 0) {
-            safe_strcpy(label, name, MAX_LABEL_LENGTH, 0);
-        } else {
-            safe_strcpy(label, "object", MAX_LABEL_LENGTH, 0);
-        }
-
-        // Clamp confidence to valid range [0.0, 1.0]
-        float confidence = box->score;
-        if (confidence > 1.0f) confidence = 1.0f;
-        if (confidence < 0.0f) confidence = 0.0f;
-
-        // Convert pixel coordinates to normalized 0-1 range with safety checks
-        float x = (width > 0) ? ((float)box->x / width) : 0.0f;
-        float y = (height > 0) ? ((float)box->y / height) : 0.0f;
-        float w = (width > 0) ? ((float)box->w / width) : 0.0f;
-        float h = (height > 0) ? ((float)box->h / height) : 0.0f;
-
-        // Clamp values to [0.0, 1.0] range
-        x = (x < 0.0f) ? 0.0f : (x > 1.0f ? 1.0f : x);
-        y = (y < 0.0f) ? 0.0f : (y > 1.0f ? 1.0f : y);
-        w = (w < 0.0f) ? 0.0f : (w > 1.0f ? 1.0f : w);
-        h = (h < 0.0f) ? 0.0f : (h > 1.0f ? 1.0f : h);
-
-        // Apply threshold
-        if (confidence < m->threshold) {
-            log_info("Detection %d below threshold: %s (%.2f%%) at [%.2f, %.2f, %.2f, %.2f]",
-                    i, label, confidence * 100.0f, x, y, w, h);
-            continue;
-        }
-
-        // Add valid detection to result
-        safe_strcpy(result->detections[valid_count].label, label, MAX_LABEL_LENGTH, 0);
-        result->detections[valid_count].confidence = confidence;
-        result->detections[valid_count].x = x;
-        result->detections[valid_count].y = y;
-        result->detections[valid_count].width = w;
-        result->detections[valid_count].height = h;
-
-        log_info("Valid detection %d: %s (%.2f%%) at [%.2f, %.2f, %.2f, %.2f]",
-                valid_count, label, confidence * 100.0f, x, y, w, h);
-
-        valid_count++;
-    }
-
-    result->count = valid_count;
-    log_info("Detection found %d valid objects out of %d total", valid_count, count);
-
-    // Step 7: Free the image data and prepared data
-    log_info("Step 9: Freeing SOD image and prepared data");
+    // The prepared data belongs to the network (or to img), so only the image is freed here
     sod_free_image(img);
-    // Note: The prepared_data is actually part of the SOD image structure, so we don't need to free it separately
-    // It's automatically freed when we call sod_free_image(img)
-
     return 0;
 #else
     log_error("SOD support not enabled");
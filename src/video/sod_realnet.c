@@ -3,8 +3,12 @@
 #include <string.h>
 #include <stdbool.h>
 #include <dlfcn.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include "video/detection.h"
+#include "video/model_registry.h"
+#include "core/config.h"
 #include "core/logger.h"
 #include "utils/strings.h"
 
@@ -15,6 +19,8 @@ typedef struct {
     int (*sod_realnet_load_model_from_mem)(void *pNet, const void *pModel, unsigned int nBytes, unsigned int *pOutHandle);
     int (*sod_realnet_model_config)(void *pNet, unsigned int handle, int conf, ...);
     int (*sod_realnet_detect)(void *pNet, const unsigned char *zGrayImg, int width, int height, void ***apBox, int *pnBox);
+    // Optional: older libsod builds only scan tightly packed images
+    int (*sod_realnet_detect_strided)(void *pNet, const unsigned char *zGrayImg, int width, int height, int stride, void ***apBox, int *pnBox);
     void (*sod_realnet_destroy)(void *pNet);
 } sod_realnet_functions_t;
 
@@ -40,8 +46,18 @@ typedef struct sod_realnet_struct sod_realnet;
 typedef struct {
     void *net;                   // SOD RealNet handle (void* for dynamic loading)
     float threshold;             // Detection threshold
+    model_version_t *version;    // Registry version holding the cascade the net runs on
+    char path[MAX_PATH_LENGTH];
 } sod_realnet_model_t;
 
+// Contents of a RealNet model file. A net parsed from memory keeps pointing
+// into it, so it is shared by every net running the model and outlives them.
+typedef struct {
+    void *data;
+    size_t size;
+    bool mapped;                 // data is a read-only mapping of the file
+} realnet_blob_t;
+
 /**
  * Initialize SOD RealNet functions
  */
@@ -64,6 +80,7 @@ static bool init_sod_realnet_functions(void) {
     sod_realnet_funcs.sod_realnet_model_config = dlsym(sod_realnet_funcs.handle, "sod_realnet_model_config");
     sod_realnet_funcs.sod_realnet_detect = dlsym(sod_realnet_funcs.handle, "sod_realnet_detect");
     sod_realnet_funcs.sod_realnet_destroy = dlsym(sod_realnet_funcs.handle, "sod_realnet_destroy");
+    sod_realnet_funcs.sod_realnet_detect_strided = dlsym(sod_realnet_funcs.handle, "sod_realnet_detect_strided");
     
     // Check if all required functions were loaded
     if (sod_realnet_funcs.sod_realnet_create && sod_realnet_funcs.sod_realnet_load_model_from_mem && 
@@ -81,86 +98,153 @@ static bool init_sod_realnet_functions(void) {
 }
 
 /**
- * Load a SOD RealNet model
+ * Read a RealNet model file (model registry loader)
  */
-void* load_sod_realnet_model(const char *model_path, float threshold) {
-    // Initialize SOD RealNet functions
-    if (!init_sod_realnet_functions()) {
-        log_error("SOD RealNet functions not available");
-        return NULL;
-    }
-    
-    // Create RealNet handle
-    void *net = NULL;
-    int rc;
-    
-    rc = sod_realnet_funcs.sod_realnet_create(&net);
-    
-    if (rc != 0) { // SOD_OK is 0
-        log_error("Failed to create SOD RealNet handle: %d", rc);
-        return NULL;
-    }
-    
-    // Load the model
-    unsigned int handle;
-    
-    // Use sod_realnet_load_model_from_mem since sod_realnet_load_model_from_disk requires SOD_NO_MMAP
-    // First, read the model file into memory
+static void *load_realnet_blob(const char *model_path, float threshold) {
+    (void)threshold;
+
     FILE *fp = fopen(model_path, "rb");
     if (!fp) {
         log_error("Failed to open SOD RealNet model file: %s", model_path);
-    sod_realnet_funcs.sod_realnet_destroy(net);
         return NULL;
     }
-    
-    // Get file size
-    fseek(fp, 0, SEEK_END);
-    long file_size = ftell(fp);
-    fseek(fp, 0, SEEK_SET);
-    
-    // Allocate memory for model data
-    void *model_data = malloc(file_size);
-    if (!model_data) {
-        log_error("Failed to allocate memory for SOD RealNet model data");
+
+    struct stat st;
+    if (fstat(fileno(fp), &st) != 0 || st.st_size <= 0) {
+        log_error("Failed to get size of SOD RealNet model file: %s", model_path);
         fclose(fp);
-        sod_realnet_funcs.sod_realnet_destroy(net);
         return NULL;
     }
-    
-    // Read model data
-    if (fread(model_data, 1, file_size, fp) != file_size) {
-        log_error("Failed to read SOD RealNet model data");
-        free(model_data);
+
+    realnet_blob_t *blob = calloc(1, sizeof(realnet_blob_t));
+    if (!blob) {
+        log_error("Failed to allocate memory for SOD RealNet model data");
         fclose(fp);
-        sod_realnet_funcs.sod_realnet_destroy(net);
         return NULL;
     }
-    
+    blob->size = (size_t)st.st_size;
+
+    if (g_config.mmap_model_weights) {
+        void *map = mmap(NULL, blob->size, PROT_READ, MAP_PRIVATE, fileno(fp), 0);
+        if (map != MAP_FAILED) {
+            blob->data = map;
+            blob->mapped = true;
+        } else {
+            log_warn("Failed to map SOD RealNet model %s, reading it instead", model_path);
+        }
+    }
+
+    if (!blob->data) {
+        blob->data = malloc(blob->size);
+        if (!blob->data || fread(blob->data, 1, blob->size, fp) != blob->size) {
+            log_error("Failed to read SOD RealNet model data: %s", model_path);
+            free(blob->data);
+            free(blob);
+            fclose(fp);
+            return NULL;
+        }
+    }
+
     fclose(fp);
-    
-    // Load model from memory
-    rc = sod_realnet_funcs.sod_realnet_load_model_from_mem(net, model_data, file_size, &handle);
-    
-    // Free model data
-    free(model_data);
+    return blob;
+}
+
+static void free_realnet_blob(void *shared) {
+    realnet_blob_t *blob = (realnet_blob_t *)shared;
+    if (blob->mapped) {
+        munmap(blob->data, blob->size);
+    } else {
+        free(blob->data);
+    }
+    free(blob);
+}
+
+/**
+ * Create a RealNet handle running the cascade of a model version
+ */
+static void *create_realnet_net(model_version_t *version, const char *model_path) {
+    const realnet_blob_t *blob = (const realnet_blob_t *)model_version_shared(version);
+    void *net = NULL;
+    unsigned int handle;
+
+    int rc = sod_realnet_funcs.sod_realnet_create(&net);
     if (rc != 0) { // SOD_OK is 0
+        log_error("Failed to create SOD RealNet handle: %d", rc);
+        return NULL;
+    }
+
+    // The cascade is used in place, not copied
+    rc = sod_realnet_funcs.sod_realnet_load_model_from_mem(net, blob->data, (unsigned int)blob->size, &handle);
+    if (rc != 0) {
         log_error("Failed to load SOD RealNet model: %s (error: %d)", model_path, rc);
         sod_realnet_funcs.sod_realnet_destroy(net);
         return NULL;
     }
-    
+
+    return net;
+}
+
+/**
+ * Move a handle to the newest version of its model after the file changed
+ */
+static void refresh_realnet_model(sod_realnet_model_t *m) {
+    model_version_t *latest = model_registry_check_update(m->version);
+    if (!latest) {
+        return;
+    }
+
+    void *net = create_realnet_net(latest, m->path);
+    if (!net) {
+        // Keep detecting with the previous cascade
+        model_registry_release(latest);
+        return;
+    }
+
+    sod_realnet_funcs.sod_realnet_destroy(m->net);
+    model_registry_release(m->version);
+    m->net = net;
+    m->version = latest;
+    log_info("SOD RealNet model %s switched to generation %u", m->path, model_version_generation(latest));
+}
+
+/**
+ * Load a SOD RealNet model
+ */
+void* load_sod_realnet_model(const char *model_path, float threshold) {
+    // Initialize SOD RealNet functions
+    if (!init_sod_realnet_functions()) {
+        log_error("SOD RealNet functions not available");
+        return NULL;
+    }
+
+    // The threshold only filters boxes, so streams with different
+    // thresholds share a single copy of the cascade
+    model_version_t *version = model_registry_acquire(model_path, 0.0f, load_realnet_blob, free_realnet_blob);
+    if (!version) {
+        return NULL;
+    }
+
+    void *net = create_realnet_net(version, model_path);
+    if (!net) {
+        model_registry_release(version);
+        return NULL;
+    }
+
     // Create model structure
-    sod_realnet_model_t *model = (sod_realnet_model_t *)malloc(sizeof(sod_realnet_model_t));
+    sod_realnet_model_t *model = (sod_realnet_model_t *)calloc(1, sizeof(sod_realnet_model_t));
     if (!model) {
         log_error("Failed to allocate memory for SOD RealNet model structure");
         sod_realnet_funcs.sod_realnet_destroy(net);
+        model_registry_release(version);
         return NULL;
     }
-    
+
     // Initialize model structure
     model->net = net;
     model->threshold = threshold;
-    
+    model->version = version;
+    safe_strcpy(model->path, model_path, sizeof(model->path), 0);
+
     log_info("SOD RealNet model loaded: %s", model_path);
     return model;
 }
@@ -172,104 +256,154 @@ void free_sod_realnet_model(void *model) {
     if (!model) {
         return;
     }
-    
+
     sod_realnet_model_t *m = (sod_realnet_model_t *)model;
-    
-    // Destroy RealNet handle
+
+    // Destroy RealNet handle before the cascade it points into
     if (sod_realnet_funcs.sod_realnet_destroy) {
         sod_realnet_funcs.sod_realnet_destroy(m->net);
     }
-    
+    model_registry_release(m->version);
+
     // Free model structure
     free(m);
 }
 
 /**
- * Run detection on a frame using SOD RealNet
+ * Convert RealNet boxes to a detection result
  */
-int detect_with_sod_realnet(void *model, const unsigned char *frame_data, 
-                           int width, int height, int channels, detection_result_t *result) {
-    if (!model || !frame_data || !result) {
-        return -1;
-    }
-    
-    // Check if SOD RealNet is available
-    if (!init_sod_realnet_functions()) {
-        log_error("SOD RealNet functions not available");
-        return -1;
-    }
-    
-    sod_realnet_model_t *m = (sod_realnet_model_t *)model;
-    
-    // Initialize result
-    result->count = 0;
-    
-    // Create a copy of the frame data for processing
-    unsigned char *blob = malloc((size_t)width * height * channels);
-    if (!blob) {
-        log_error("Failed to allocate memory for frame blob");
-        return -1;
-    }
-    memcpy(blob, frame_data, (size_t)width * height * channels);
-    
-    // Run detection
-    void *boxes = NULL;
-    int box_count = 0;
-    int rc;
-    
-    rc = sod_realnet_funcs.sod_realnet_detect(m->net, blob, width, height, (void***)&boxes, &box_count);
-    
-    if (rc != 0) { // SOD_OK is 0
-        log_error("SOD RealNet detection failed: %d", rc);
-        free(blob);
-        blob = NULL;  // Set to NULL after freeing to prevent use-after-free
-        return -1;
-    }
-    
-    // Process detections
+static void realnet_boxes_to_result(const sod_realnet_model_t *m, const sod_box_dynamic *box_array, int box_count,
+                                    int width, int height, detection_result_t *result) {
     int valid_count = 0;
     for (int i = 0; i < box_count && valid_count < MAX_DETECTIONS; i++) {
-        // Get box data
-        // For dynamic loading, we need to access the box array differently
-        // boxes is an array of sod_box_dynamic structures, not pointers to structures
-        sod_box_dynamic *box_array = (sod_box_dynamic*)boxes;
         float score = box_array[i].score;
         const char *name = box_array[i].zName;
         int x = box_array[i].x;
         int y = box_array[i].y;
         int w = box_array[i].w;
         int h = box_array[i].h;
-        
+
         // Apply threshold
         if (score < m->threshold) {
             continue;
         }
-        
+
         // Copy detection data
-        safe_strcpy(result->detections[valid_count].label, 
+        safe_strcpy(result->detections[valid_count].label,
                 name ? name : "face", MAX_LABEL_LENGTH, 0);
-        
+
         // Convert confidence from SOD score to 0.0-1.0 range
         // SOD RealNet typically uses a score > 5.0 for good detections
         result->detections[valid_count].confidence = (float)(score / 10.0);
         if (result->detections[valid_count].confidence > 1.0f) {
             result->detections[valid_count].confidence = 1.0f;
         }
-        
+
         // Normalize coordinates to 0.0-1.0 range
         result->detections[valid_count].x = (float)x / (float)width;
         result->detections[valid_count].y = (float)y / (float)height;
         result->detections[valid_count].width = (float)w / (float)width;
         result->detections[valid_count].height = (float)h / (float)height;
-        
+
         valid_count++;
     }
-    
+
     result->count = valid_count;
-    
-    // Free the blob
-    free(blob);
-    blob = NULL;  // Set to NULL after freeing to prevent use-after-free
-    
+}
+
+/**
+ * Run detection directly on a strided 8-bit luma plane
+ */
+int detect_with_sod_realnet_luma(void *model, const unsigned char *luma,
+                                 int width, int height, int stride, detection_result_t *result) {
+    if (!model || !luma || !result || width <= 0 || height <= 0 || stride < width) {
+        return -1;
+    }
+
+    // Check if SOD RealNet is available
+    if (!init_sod_realnet_functions()) {
+        log_error("SOD RealNet functions not available");
+        return -1;
+    }
+
+    sod_realnet_model_t *m = (sod_realnet_model_t *)model;
+    refresh_realnet_model(m);
+
+    // Initialize result
+    result->count = 0;
+
+    void *boxes = NULL;
+    int box_count = 0;
+    int rc;
+    unsigned char *packed = NULL;
+
+    if (sod_realnet_funcs.sod_realnet_detect_strided) {
+        // The plane is only read, so it is scanned in place
+        rc = sod_realnet_funcs.sod_realnet_detect_strided(m->net, luma, width, height, stride,
+                                                          (void***)&boxes, &box_count);
+    } else if (stride == width) {
+        rc = sod_realnet_funcs.sod_realnet_detect(m->net, luma, width, height, (void***)&boxes, &box_count);
+    } else {
+        // Older libsod without stride support: pack the rows first
+        packed = malloc((size_t)width * height);
+        if (!packed) {
+            log_error("Failed to allocate memory for packed luma plane");
+            return -1;
+        }
+        for (int y = 0; y < height; y++) {
+            memcpy(packed + (size_t)y * width, luma + (size_t)y * stride, width);
+        }
+        rc = sod_realnet_funcs.sod_realnet_detect(m->net, packed, width, height, (void***)&boxes, &box_count);
+    }
+
+    if (rc != 0) { // SOD_OK is 0
+        log_error("SOD RealNet detection failed: %d", rc);
+        free(packed);
+        return -1;
+    }
+
+    // boxes is an array of sod_box_dynamic structures, not pointers to structures
+    realnet_boxes_to_result(m, (const sod_box_dynamic *)boxes, box_count, width, height, result);
+
+    free(packed);
     return 0;
 }
+
+/**
+ * Run detection on a frame using SOD RealNet
+ */
+int detect_with_sod_realnet(void *model, const unsigned char *frame_data, 
+                           int width, int height, int channels, detection_result_t *result) {
+    if (!model || !frame_data || !result) {
+        return -1;
+    }
+
+    // Grayscale frames are scanned in place
+    if (channels == 1) {
+        return detect_with_sod_realnet_luma(model, frame_data, width, height, width, result);
+    }
+
+    if (channels < 3) {
+        log_error("Unsupported channel count for SOD RealNet: %d", channels);
+        return -1;
+    }
+
+    // RealNet cascades compare luma samples: reduce packed RGB(A) to gray
+    unsigned char *gray = malloc((size_t)width * height);
+    if (!gray) {
+        log_error("Failed to allocate memory for grayscale frame");
+        return -1;
+    }
+
+    size_t pixels = (size_t)width * height;
+    for (size_t i = 0; i < pixels; i++) {
+        const unsigned char *px = frame_data + i * channels;
+        // BT.601 integer weights, as used by sod_img_load_grayscale()
+        gray[i] = (unsigned char)((px[0] * 77 + px[1] * 150 + px[2] * 29) >> 8);
+    }
+
+    int ret = detect_with_sod_realnet_luma(model, gray, width, height, width, result);
+
+    free(gray);
+    return ret;
+}
@@ -43,11 +43,16 @@
 #include "video/packet_buffer.h"
 #include "video/detection.h"
 #include "video/detection_model.h"
+#include "video/detection_cascade.h"
+#include "video/detection_roi.h"
 #include "video/detection_result.h"
+#include "video/sod_realnet.h"
 #include "video/api_detection.h"
+#include "video/frame_bus.h"
 #include "video/motion_detection.h"
 #include "video/onvif_detection.h"
 #include "video/zone_filter.h"
+#include "video/object_tracker.h"
 #include "video/mp4_writer.h"
 #include "video/mp4_writer_internal.h"
 #include "video/mp4_recording.h"
@@ -58,6 +63,7 @@
 #include "database/db_recordings.h"
 #include "database/db_detections.h"
 #include "database/db_streams.h"
+#include "database/db_stream_cache.h"
 #include "core/url_utils.h"
 #include "storage/storage_manager_streams_cache.h"
 #include "telemetry/stream_metrics.h"
@@ -76,6 +82,11 @@
 // is configured via the application's stream/detection settings (i.e. when
 // the configured detection interval is missing or <= 0).
 #define DEFAULT_DETECTION_INTERVAL 5
+
+// Motion scores above this fraction of the threshold keep the adaptive
+// detection rate at the configured interval
+#define ADAPTIVE_NEAR_MISS_RATIO 0.5f
+
 #define DETECTION_GRACE_PERIOD_SEC 2  // Seconds to wait after last detection before entering post-buffer
 
 // Video/default FPS settings
@@ -100,13 +111,25 @@ static const int   DEFAULT_MOTION_MIN_CONSECUTIVE_FRAMES = 3;  // Minimum consec
 static unified_detection_ctx_t *detection_contexts[MAX_UNIFIED_DETECTION_THREADS] = {0};
 static pthread_mutex_t contexts_mutex = PTHREAD_MUTEX_INITIALIZER;
 static bool system_initialized = false;
+static int config_subscription = 0;
 
 // Forward declarations
 static void *unified_detection_thread_func(void *arg);
 static int connect_to_stream(unified_detection_ctx_t *ctx);
 static void disconnect_from_stream(unified_detection_ctx_t *ctx);
 static int process_packet(unified_detection_ctx_t *ctx, AVPacket *pkt);
-static bool run_detection_on_frame(unified_detection_ctx_t *ctx, AVPacket *pkt);
+static bool run_detection_on_frame(unified_detection_ctx_t *ctx, AVPacket *pkt, bool *pending);
+static bool run_detection_cascade(unified_detection_ctx_t *ctx, AVPacket *pkt, bool *pending);
+static void handle_detection_outcome(unified_detection_ctx_t *ctx, bool detection_triggered,
+                                     time_t now, unified_detection_state_t current_state);
+static void drain_api_detection_results(unified_detection_ctx_t *ctx, time_t now);
+static int effective_detection_interval(unified_detection_ctx_t *ctx, time_t now,
+                                        unified_detection_state_t state);
+static void apply_stream_config_change(unified_detection_ctx_t *ctx);
+static void record_motion_score(unified_detection_ctx_t *ctx, const detection_result_t *result,
+                                time_t now);
+static void frame_bus_result_ready(const char *stream_name, uint64_t seq, const char *json,
+                                   size_t json_len, void *user_data);
 static int udt_start_recording(unified_detection_ctx_t *ctx);
 static int udt_stop_recording(unified_detection_ctx_t *ctx);
 static int flush_prebuffer_to_recording(unified_detection_ctx_t *ctx);
@@ -205,6 +228,37 @@ static bool is_onvif_detection_model(const char *model_path) {
     return strcmp(model_path, "onvif") == 0;
 }
 
+/**
+ * Check if a model path indicates a local detector attached via the frame bus
+ * Returns true if the path is exactly "frame-bus"
+ */
+static bool is_frame_bus_model(const char *model_path) {
+    if (!model_path || model_path[0] == '\0') {
+        return false;
+    }
+    return strcmp(model_path, "frame-bus") == 0;
+}
+
+/**
+ * Check if a decoded pixel format stores 8-bit luma as its first plane
+ */
+static bool frame_has_luma_plane(int format) {
+    switch (format) {
+        case AV_PIX_FMT_YUV420P:
+        case AV_PIX_FMT_YUVJ420P:
+        case AV_PIX_FMT_YUV422P:
+        case AV_PIX_FMT_YUVJ422P:
+        case AV_PIX_FMT_YUV444P:
+        case AV_PIX_FMT_YUVJ444P:
+        case AV_PIX_FMT_NV12:
+        case AV_PIX_FMT_NV21:
+        case AV_PIX_FMT_GRAY8:
+            return true;
+        default:
+            return false;
+    }
+}
+
 /**
  * Derive an ONVIF base URL (http[s]://host[:port]) from a stream URL.
  *
@@ -227,6 +281,33 @@ static void extract_onvif_base_url(const char *stream_url, int onvif_port, char
     url_build_onvif_service_url(stream_url, onvif_port, NULL, onvif_url, onvif_url_size);
 }
 
+/**
+ * Stream configuration listener
+ *
+ * Runs on the thread that wrote the configuration, so it only flags the
+ * detection thread of the stream; that thread applies the change itself.
+ */
+static void on_stream_config_changed(const char *name, const stream_config_t *old_config,
+                                     const stream_config_t *new_config, uint32_t changed,
+                                     void *user_data) {
+    (void)old_config;
+    (void)changed;
+    (void)user_data;
+
+    if (!new_config) {
+        return;
+    }
+
+    pthread_mutex_lock(&contexts_mutex);
+    for (int i = 0; i < MAX_UNIFIED_DETECTION_THREADS; i++) {
+        if (detection_contexts[i] && strcmp(detection_contexts[i]->stream_name, name) == 0) {
+            atomic_store(&detection_contexts[i]->config_changed, 1);
+            break;
+        }
+    }
+    pthread_mutex_unlock(&contexts_mutex);
+}
+
 /**
  * Initialize the unified detection thread system
  */
@@ -252,6 +333,13 @@ int init_unified_detection_system(void) {
     system_initialized = true;
     pthread_mutex_unlock(&contexts_mutex);
 
+    config_subscription = stream_config_subscribe(STREAM_CONFIG_CHANGED_DETECTION | STREAM_CONFIG_CHANGED_RECORDING,
+                                                  on_stream_config_changed, NULL);
+    if (config_subscription < 0) {
+        log_warn("Detection threads will not pick up stream configuration changes until restarted");
+        config_subscription = 0;
+    }
+
     log_info("Unified detection system initialized");
     return 0;
 }
@@ -266,6 +354,11 @@ void shutdown_unified_detection_system(void) {
 
     log_info("Shutting down unified detection system");
 
+    if (config_subscription > 0) {
+        stream_config_unsubscribe(config_subscription);
+        config_subscription = 0;
+    }
+
     // First pass: Signal all threads to stop (without holding the lock for long)
     int already_stopped_count = 0;
     int threads_to_stop = 0;
@@ -346,6 +439,10 @@ void shutdown_unified_detection_system(void) {
                 stop_onvif_detection_thread(ctx);
             }
 
+            // No asynchronous API or frame bus detection may complete into ctx after free()
+            api_detection_client_cancel(ctx->stream_name);
+            frame_bus_clear_result_handler(ctx->stream_name);
+
             // Clean up resources
             if (ctx->packet_buffer) {
                 destroy_packet_buffer(ctx->packet_buffer);
@@ -375,6 +472,9 @@ void shutdown_unified_detection_system(void) {
     // Cleanup packet buffer pool
     cleanup_packet_buffer_pool();
 
+    // Drop per-stream object tracks
+    object_tracker_reset(NULL);
+
     system_initialized = false;
     pthread_mutex_unlock(&contexts_mutex);
 
@@ -657,6 +757,16 @@ int start_unified_detection_thread(const char *stream_name, const char *model_pa
     // Initialize context
     safe_strcpy(ctx->stream_name, stream_name, sizeof(ctx->stream_name), 0);
     safe_strcpy(ctx->model_path, model_path, sizeof(ctx->model_path), 0);
+    if (is_detection_cascade(model_path)) {
+        if (detection_cascade_parse(model_path, g_config.models_path, &ctx->cascade) != 0) {
+            log_error("[%s] Invalid detection cascade: %s", stream_name, model_path);
+            free(ctx);
+            pthread_mutex_unlock(&contexts_mutex);
+            return -1;
+        }
+        ctx->is_cascade = true;
+        detection_cascade_reset_stats(stream_name);
+    }
     ctx->detection_threshold = threshold;
     ctx->pre_buffer_seconds = pre_buffer_seconds > 0 ? pre_buffer_seconds : 10;
     ctx->post_buffer_seconds = post_buffer_seconds > 0 ? post_buffer_seconds : 5;
@@ -666,6 +776,7 @@ int start_unified_detection_thread(const char *stream_name, const char *model_pa
     ctx->record_audio = config.record_audio;
     ctx->annotation_only = annotation_only;
     atomic_store(&ctx->external_motion_trigger, 0);  // no pending external trigger
+    atomic_store(&ctx->config_changed, 0);
 
     // Replay-detection: will be set properly on first successful connect
     ctx->stream_connect_time = time(NULL);
@@ -675,6 +786,8 @@ int start_unified_detection_thread(const char *stream_name, const char *model_pa
 
     // Initialize to current time to avoid large elapsed time on first detection check
     atomic_store(&ctx->last_detection_check_time, (long long)time(NULL));
+    atomic_store(&ctx->last_activity_time, (long long)time(NULL));
+    atomic_store(&ctx->effective_interval, ctx->detection_interval);
 
     if (annotation_only) {
         log_info("[%s] Detection running in annotation-only mode (no separate MP4 files)", stream_name);
@@ -712,7 +825,8 @@ int start_unified_detection_thread(const char *stream_name, const char *model_pa
     // streams are created with enabled=false, so we must flip the flag here.
     // configure_motion_detection() uses threshold as sensitivity and clamps it
     // to a valid range internally.
-    if (is_motion_detection_model(model_path)) {
+    if (is_motion_detection_model(model_path) ||
+        (ctx->is_cascade && detection_cascade_has_stage(&ctx->cascade, CASCADE_STAGE_MOTION))) {
         float sens = (threshold > 0.0f && threshold <= 1.0f) ? threshold : DEFAULT_MOTION_SENSITIVITY;
         configure_motion_detection(stream_name,
                                    sens,
@@ -947,7 +1061,9 @@ int get_unified_detection_reconnect_attempts(const char *stream_name) {
 int get_unified_detection_stats(const char *stream_name,
                                 uint64_t *packets_processed,
                                 uint64_t *detections,
-                                uint64_t *recordings) {
+                                uint64_t *recordings,
+                                int *detection_interval,
+                                int *effective_interval) {
     if (!stream_name) {
         return -1;
     }
@@ -965,6 +1081,8 @@ int get_unified_detection_stats(const char *stream_name,
     if (detections) *detections = ctx->total_detections;
     if (recordings) *recordings = ctx->total_recordings;
     pthread_mutex_unlock(&ctx->mutex);
+    if (detection_interval) *detection_interval = ctx->detection_interval;
+    if (effective_interval) *effective_interval = atomic_load(&ctx->effective_interval);
 
     pthread_mutex_unlock(&contexts_mutex);
 
@@ -991,6 +1109,9 @@ int get_unified_detection_stats(const char *stream_name,
  *   1 = motion active (start / keep-alive)
  *   2 = motion ended
  *   0 = idle (initial / reset by UDT thread after processing)
+ *
+ * Motion also counts as scene activity, so a stream slowed down by the
+ * adaptive detection rate returns to its configured interval right away.
  */
 void unified_detection_notify_motion(const char *stream_name, bool motion_active) {
     if (!stream_name) return;
@@ -1000,6 +1121,10 @@ void unified_detection_notify_motion(const char *stream_name, bool motion_active
     if (ctx) {
         // 1 = motion active, 2 = motion ended
         atomic_store(&ctx->external_motion_trigger, motion_active ? 1 : 2);
+        if (motion_active) {
+            // Back to the configured rate from the next keyframe on
+            atomic_store(&ctx->last_activity_time, (long long)time(NULL));
+        }
         log_debug("[%s] external_motion_trigger set to %d via unified_detection_notify_motion",
                   stream_name, motion_active ? 1 : 2);
     }
@@ -1157,6 +1282,42 @@ static int connect_to_stream(unified_detection_ctx_t *ctx) {
     return 0;
 }
 
+/**
+ * Apply a changed stream configuration to a running detection thread
+ *
+ * The threshold, interval, post-buffer and audio setting take effect at the
+ * next detection check or recording. The pre-buffer is sized when the thread
+ * starts, so a new pre-buffer length still needs a restart.
+ */
+static void apply_stream_config_change(unified_detection_ctx_t *ctx) {
+    stream_config_t config;
+    if (get_stream_config_by_name(ctx->stream_name, &config) != 0) {
+        return;
+    }
+
+    if (config.detection_threshold > 0.0f && config.detection_threshold != ctx->detection_threshold) {
+        log_info("[%s] Detection threshold changed from %.2f to %.2f",
+                 ctx->stream_name, ctx->detection_threshold, config.detection_threshold);
+        ctx->detection_threshold = config.detection_threshold;
+    }
+
+    int interval = config.detection_interval > 0 ? config.detection_interval : DEFAULT_DETECTION_INTERVAL;
+    if (interval != ctx->detection_interval) {
+        log_info("[%s] Detection interval changed from %d to %d seconds",
+                 ctx->stream_name, ctx->detection_interval, interval);
+        ctx->detection_interval = interval;
+        atomic_store(&ctx->effective_interval, interval);
+    }
+
+    if (config.post_detection_buffer > 0 && config.post_detection_buffer != ctx->post_buffer_seconds) {
+        log_info("[%s] Post-detection buffer changed from %d to %d seconds",
+                 ctx->stream_name, ctx->post_buffer_seconds, config.post_detection_buffer);
+        ctx->post_buffer_seconds = config.post_detection_buffer;
+    }
+
+    ctx->record_audio = config.record_audio;
+}
+
 /**
  * Update stored video parameters, tracking whether the FPS value is provisional.
  * When fps_is_provisional is true, the runtime frame-arrival measurement in
@@ -1260,6 +1421,14 @@ static void *unified_detection_thread_func(void *arg) {
     // callback. We surface errors through log_error() ourselves.
     av_log_set_level(AV_LOG_QUIET);
 
+    // Local detectors post their results back through the frame bus thread
+    if ((is_frame_bus_model(ctx->model_path) ||
+         (ctx->is_cascade && detection_cascade_has_stage(&ctx->cascade, CASCADE_STAGE_FRAME_BUS))) &&
+        frame_bus_set_result_handler(stream_name, frame_bus_result_ready, ctx) != 0) {
+        log_warn("[%s] Frame bus is not running; enable [frame_bus] to use the frame-bus model",
+                 stream_name);
+    }
+
     unified_detection_state_t state;
     int reconnect_delay_ms = BASE_RECONNECT_DELAY_MS;
     // Track whether this particular connection produced any real media
@@ -1280,6 +1449,10 @@ static void *unified_detection_thread_func(void *arg) {
 
     // Main loop
     while (atomic_load(&ctx->running) && !is_shutdown_initiated()) {
+        if (atomic_exchange(&ctx->config_changed, 0)) {
+            apply_stream_config_change(ctx);
+        }
+
         // Read current state from context (may have been changed by process_packet)
         state = atomic_load(&ctx->state);
 
@@ -1486,6 +1659,19 @@ static void *unified_detection_thread_func(void *arg) {
     // (e.g., during shutdown while in BUFFERING/RECORDING state)
     disconnect_from_stream(ctx);
 
+    // Drop outstanding asynchronous API detections and frame bus results;
+    // once these return no completion callback touches ctx anymore
+    api_detection_client_cancel(stream_name);
+    frame_bus_clear_result_handler(stream_name);
+
+    // Cascade stage models are loaded and used only by this thread
+    for (int i = 0; i < DETECTION_CASCADE_MAX_STAGES; i++) {
+        if (ctx->cascade_models[i]) {
+            unload_detection_model(ctx->cascade_models[i]);
+            ctx->cascade_models[i] = NULL;
+        }
+    }
+
     // Clean up thread-local CURL handle used by go2rtc_get_snapshot()
     // This must be called from the same thread that created the handle
     go2rtc_snapshot_cleanup_thread();
@@ -1789,6 +1975,7 @@ stats_done:
             // Motion active: treat as a detection event
             log_info("[%s] External motion trigger (active) received", ctx->stream_name);
             atomic_store(&ctx->last_detection_time, (long long)now);
+            atomic_store(&ctx->last_activity_time, (long long)now);
 
             if (!ctx->annotation_only) {
                 if (current_state == UDT_STATE_BUFFERING) {
@@ -1843,6 +2030,12 @@ stats_done:
         current_state = (unified_detection_state_t)atomic_load(&ctx->state);
     }
 
+    // Act on asynchronous API detections that completed since the last packet
+    if (is_video && atomic_load(&ctx->api_results_ready)) {
+        drain_api_detection_results(ctx, now);
+        current_state = (unified_detection_state_t)atomic_load(&ctx->state);
+    }
+
     // Run detection based on time interval (in seconds)
     // We check on keyframes as a convenient trigger point, but the decision is time-based
     // This ensures detection_interval is interpreted as seconds, not keyframe count
@@ -1853,96 +2046,183 @@ stats_done:
         // Log periodically to show detection is running
         if (time_since_last_check > 0 && (atomic_fetch_add(&ctx->log_counter, 1) % 10) == 0) {
             log_debug("[%s] Time since last detection check: %ld/%d seconds, model=%s, state=%d",
-                     ctx->stream_name, (long)time_since_last_check, ctx->detection_interval,
+                     ctx->stream_name, (long)time_since_last_check,
+                     atomic_load(&ctx->effective_interval),
                      ctx->model_path, current_state);
         }
 
-        // Run detection if enough time has passed (detection_interval is in seconds)
-        if (time_since_last_check >= ctx->detection_interval) {
+        // Run detection if enough time has passed (detection_interval is in seconds,
+        // stretched by the adaptive rate while the stream is quiet)
+        int interval = effective_detection_interval(ctx, now, current_state);
+        if (time_since_last_check >= interval) {
             atomic_store(&ctx->last_detection_check_time, (long long)now);
 
             log_info("[%s] Running detection (interval=%ds, elapsed=%lds, model=%s)",
-                    ctx->stream_name, ctx->detection_interval, (long)time_since_last_check, ctx->model_path);
+                    ctx->stream_name, interval, (long)time_since_last_check, ctx->model_path);
+
+            // Decode frame and run detection. Asynchronous API detections
+            // report back through the mailbox drained above.
+            bool detection_pending = false;
+            bool detection_triggered = run_detection_on_frame(ctx, pkt, &detection_pending);
+            if (!detection_pending) {
+                handle_detection_outcome(ctx, detection_triggered, now, current_state);
+            }
+        }
+    }
 
-            // Decode frame and run detection
-            bool detection_triggered = run_detection_on_frame(ctx, pkt);
+    return 0;
+}
 
-            // If detection triggered
-            if (detection_triggered) {
-                atomic_store(&ctx->last_detection_time, (long long)now);
+/**
+ * Remember the peak motion score of one check
+ *
+ * A score close to the threshold, or recent scores that stay close to it
+ * on average, count as scene activity for the adaptive detection rate even
+ * when nothing triggered.
+ */
+static void record_motion_score(unified_detection_ctx_t *ctx, const detection_result_t *result,
+                                time_t now) {
+    float peak = 0.0f;
+    for (int i = 0; i < result->count; i++) {
+        if (result->detections[i].confidence > peak) {
+            peak = result->detections[i].confidence;
+        }
+    }
 
-                pthread_mutex_lock(&ctx->mutex);
-                ctx->total_detections++;
-                pthread_mutex_unlock(&ctx->mutex);
+    ctx->motion_scores[ctx->motion_score_next] = peak;
+    ctx->motion_score_next = (ctx->motion_score_next + 1) % UDT_MOTION_SCORE_HISTORY;
 
-                // In annotation_only mode, we don't manage recording state - just store detections
-                // The continuous recording system handles the actual MP4 files
-                if (!ctx->annotation_only) {
-                    // If not already recording, start recording
-                    if (current_state == UDT_STATE_BUFFERING) {
-                        log_info("[%s] Detection triggered, starting recording", ctx->stream_name);
-
-                        // Start recording first, then flush pre-buffer
-                        if (udt_start_recording(ctx) == 0) {
-                            // Flush pre-buffer and correct DB start_time
-                            int pre_dur = 0;
-                            int pre_cnt = 0; size_t pre_mem = 0;
-                            if (ctx->packet_buffer)
-                                packet_buffer_get_stats(ctx->packet_buffer, &pre_cnt, &pre_mem, &pre_dur);
-
-                            flush_prebuffer_to_recording(ctx);
-                            atomic_store(&ctx->state, UDT_STATE_RECORDING);
-
-                            // Correct start_time in DB and writer to the actual first-packet time
-                            if (!ctx->mp4_writer->start_time_corrected && pre_dur > 0 &&
-                                ctx->current_recording_id > 0) {
-                                // Clamp pre_dur to the configured pre_buffer window.
-                                // go2rtc may deliver a ring-buffer of 200+ seconds; using
-                                // the raw value would push start_time so far back that
-                                // elapsed > max_duration immediately, stopping the recording.
-                                int clamped_pre = pre_dur > ctx->pre_buffer_seconds
-                                                  ? ctx->pre_buffer_seconds : pre_dur;
-                                time_t corrected = now - (time_t)clamped_pre;
-                                ctx->mp4_writer->creation_time = corrected;
-                                ctx->mp4_writer->start_time_corrected = true;
-                                update_recording_start_time(ctx->current_recording_id, corrected);
-                                log_info("[%s] Corrected recording start_time by -%ds (pre-buffer, clamped from %ds)",
-                                         ctx->stream_name, clamped_pre, pre_dur);
-                            }
+    float sum = 0.0f;
+    for (int i = 0; i < UDT_MOTION_SCORE_HISTORY; i++) {
+        sum += ctx->motion_scores[i];
+    }
 
-                            // Link any recent detections (that triggered this recording) to the new recording_id
-                            // Look back up to detection_interval + 2 seconds to catch the triggering detection
-                            time_t lookback = now - (ctx->detection_interval > 0 ? ctx->detection_interval + 2 : 7);
-                            int updated = update_detections_recording_id(ctx->stream_name,
-                                                                          ctx->current_recording_id,
-                                                                          lookback);
-                            if (updated > 0) {
-                                log_debug("[%s] Linked %d recent detections to recording ID %lu",
-                                         ctx->stream_name, updated, (unsigned long)ctx->current_recording_id);
-                            }
-                        }
+    float near_miss = ctx->detection_threshold * ADAPTIVE_NEAR_MISS_RATIO;
+    if (peak >= near_miss || sum / UDT_MOTION_SCORE_HISTORY >= near_miss / 2.0f) {
+        atomic_store(&ctx->last_activity_time, (long long)now);
+    }
+}
+
+/**
+ * Detection interval to apply right now
+ *
+ * With [api_detection] adaptive_interval, a stream without activity for
+ * adaptive_quiet_period seconds is checked at twice its configured interval,
+ * and the interval doubles again after every further quiet period, up to
+ * adaptive_max_factor times. Detections, motion near misses and external
+ * motion triggers return it to the configured interval. A recording in
+ * progress always uses the configured interval.
+ */
+static int effective_detection_interval(unified_detection_ctx_t *ctx, time_t now,
+                                        unified_detection_state_t state) {
+    int interval = ctx->detection_interval;
+
+    if (g_config.adaptive_detection_interval && state == UDT_STATE_BUFFERING) {
+        long quiet = (long)(now - (time_t)atomic_load(&ctx->last_activity_time));
+        long period = g_config.adaptive_quiet_period;
+        int factor = 1;
+        for (long q = quiet; q >= period && factor < g_config.adaptive_max_factor; q -= period) {
+            factor *= 2;
+        }
+        if (factor > g_config.adaptive_max_factor) {
+            factor = g_config.adaptive_max_factor;
+        }
+        interval *= factor;
+    }
+
+    int previous = atomic_exchange(&ctx->effective_interval, interval);
+    if (previous != interval) {
+        if (interval > ctx->detection_interval) {
+            log_info("[%s] Stream quiet, detection interval now %ds (configured %ds)",
+                     ctx->stream_name, interval, ctx->detection_interval);
+        } else {
+            log_info("[%s] Activity, detection interval back to %ds", ctx->stream_name, interval);
+        }
+    }
+    return interval;
+}
+
+/**
+ * Act on the outcome of one detection run
+ *
+ * Starts or extends the detection recording when something was detected,
+ * and moves into the post-buffer once nothing has been detected for the
+ * grace period.
+ */
+static void handle_detection_outcome(unified_detection_ctx_t *ctx, bool detection_triggered,
+                                     time_t now, unified_detection_state_t current_state) {
+    if (detection_triggered) {
+        atomic_store(&ctx->last_detection_time, (long long)now);
+        atomic_store(&ctx->last_activity_time, (long long)now);
+
+        pthread_mutex_lock(&ctx->mutex);
+        ctx->total_detections++;
+        pthread_mutex_unlock(&ctx->mutex);
+
+        // In annotation_only mode, we don't manage recording state - just store detections
+        // The continuous recording system handles the actual MP4 files
+        if (!ctx->annotation_only) {
+            // If not already recording, start recording
+            if (current_state == UDT_STATE_BUFFERING) {
+                log_info("[%s] Detection triggered, starting recording", ctx->stream_name);
+
+                // Start recording first, then flush pre-buffer
+                if (udt_start_recording(ctx) == 0) {
+                    // Flush pre-buffer and correct DB start_time
+                    int pre_dur = 0;
+                    int pre_cnt = 0; size_t pre_mem = 0;
+                    if (ctx->packet_buffer)
+                        packet_buffer_get_stats(ctx->packet_buffer, &pre_cnt, &pre_mem, &pre_dur);
+
+                    flush_prebuffer_to_recording(ctx);
+                    atomic_store(&ctx->state, UDT_STATE_RECORDING);
+
+                    // Correct start_time in DB and writer to the actual first-packet time
+                    if (!ctx->mp4_writer->start_time_corrected && pre_dur > 0 &&
+                        ctx->current_recording_id > 0) {
+                        // Clamp pre_dur to the configured pre_buffer window.
+                        // go2rtc may deliver a ring-buffer of 200+ seconds; using
+                        // the raw value would push start_time so far back that
+                        // elapsed > max_duration immediately, stopping the recording.
+                        int clamped_pre = pre_dur > ctx->pre_buffer_seconds
+                                          ? ctx->pre_buffer_seconds : pre_dur;
+                        time_t corrected = now - (time_t)clamped_pre;
+                        ctx->mp4_writer->creation_time = corrected;
+                        ctx->mp4_writer->start_time_corrected = true;
+                        update_recording_start_time(ctx->current_recording_id, corrected);
+                        log_info("[%s] Corrected recording start_time by -%ds (pre-buffer, clamped from %ds)",
+                                 ctx->stream_name, clamped_pre, pre_dur);
                     }
-                    // If in post-buffer, go back to recording
-                    else if (current_state == UDT_STATE_POST_BUFFER) {
-                        log_info("[%s] Detection during post-buffer, continuing recording", ctx->stream_name);
-                        atomic_store(&ctx->state, UDT_STATE_RECORDING);
+
+                    // Link any recent detections (that triggered this recording) to the new recording_id
+                    // Look back up to detection_interval + 2 seconds to catch the triggering detection
+                    time_t lookback = now - (ctx->detection_interval > 0 ? ctx->detection_interval + 2 : 7);
+                    int updated = update_detections_recording_id(ctx->stream_name,
+                                                                  ctx->current_recording_id,
+                                                                  lookback);
+                    if (updated > 0) {
+                        log_debug("[%s] Linked %d recent detections to recording ID %lu",
+                                 ctx->stream_name, updated, (unsigned long)ctx->current_recording_id);
                     }
                 }
             }
-            // No detection - check if we should enter post-buffer (only in detection-recording mode)
-            else if (!ctx->annotation_only && current_state == UDT_STATE_RECORDING) {
-                // Check if enough time has passed since last detection
-                if (now - (time_t)atomic_load(&ctx->last_detection_time) > DETECTION_GRACE_PERIOD_SEC) {  // grace period before post-buffer
-                    log_info("[%s] No detection, entering post-buffer (%d seconds)",
-                             ctx->stream_name, ctx->post_buffer_seconds);
-                    atomic_store(&ctx->post_buffer_end_time, (long long)(now + ctx->post_buffer_seconds));
-                    atomic_store(&ctx->state, UDT_STATE_POST_BUFFER);
-                }
+            // If in post-buffer, go back to recording
+            else if (current_state == UDT_STATE_POST_BUFFER) {
+                log_info("[%s] Detection during post-buffer, continuing recording", ctx->stream_name);
+                atomic_store(&ctx->state, UDT_STATE_RECORDING);
             }
         }
     }
-
-    return 0;
+    // No detection - check if we should enter post-buffer (only in detection-recording mode)
+    else if (!ctx->annotation_only && current_state == UDT_STATE_RECORDING) {
+        // Check if enough time has passed since last detection
+        if (now - (time_t)atomic_load(&ctx->last_detection_time) > DETECTION_GRACE_PERIOD_SEC) {  // grace period before post-buffer
+            log_info("[%s] No detection, entering post-buffer (%d seconds)",
+                     ctx->stream_name, ctx->post_buffer_seconds);
+            atomic_store(&ctx->post_buffer_end_time, (long long)(now + ctx->post_buffer_seconds));
+            atomic_store(&ctx->state, UDT_STATE_POST_BUFFER);
+        }
+    }
 }
 
 /**
@@ -2201,6 +2481,619 @@ static int flush_prebuffer_to_recording(unified_detection_ctx_t *ctx) {
     return 0;
 }
 
+/**
+ * Recording ID new detections of this stream should be linked to
+ */
+static uint64_t detection_recording_id(const unified_detection_ctx_t *ctx) {
+    if (ctx->annotation_only) {
+        // In annotation_only mode, link detections to the continuous recording
+        return get_current_recording_id_for_stream(ctx->stream_name);
+    }
+    // For detection recordings, link to the current detection recording
+    return ctx->current_recording_id;
+}
+
+/**
+ * Post an asynchronously completed detection to the context's mailbox
+ */
+static void post_detection_result(unified_detection_ctx_t *ctx, const detection_result_t *parsed) {
+    pthread_mutex_lock(&ctx->mutex);
+    if (ctx->api_result_count == UDT_API_RESULT_SLOTS) {
+        // The UDT has not read packets for a while; keep the newest results
+        memmove(&ctx->api_results[0], &ctx->api_results[1],
+                sizeof(detection_result_t) * (UDT_API_RESULT_SLOTS - 1));
+        ctx->api_result_count--;
+        log_warn("[%s] Dropping oldest unprocessed API detection result", ctx->stream_name);
+    }
+    ctx->api_results[ctx->api_result_count++] = *parsed;
+    pthread_mutex_unlock(&ctx->mutex);
+
+    atomic_store(&ctx->api_results_ready, 1);
+}
+
+/**
+ * Completion callback for asynchronous API detections
+ *
+ * Runs on the API detection client worker: only parses the response and
+ * posts it to the context's mailbox.
+ */
+static void api_detection_complete(const char *stream_name, const api_detection_response_t *response,
+                                   void *user_data) {
+    unified_detection_ctx_t *ctx = (unified_detection_ctx_t *)user_data;
+
+    if (response->status != 0) {
+        return;  // Transport error, already logged by the client
+    }
+    if (response->http_code != 200) {
+        log_error("[%s] API detection request failed with HTTP code %ld", stream_name, response->http_code);
+        return;
+    }
+
+    detection_result_t parsed;
+    if (api_detection_parse_response(response->body, response->body_len, &parsed) != 0) {
+        return;
+    }
+
+    log_debug("[%s] API detection completed in %.0f ms: %d objects",
+              stream_name, response->latency_ms, parsed.count);
+
+    post_detection_result(ctx, &parsed);
+}
+
+/**
+ * Result callback of the frame bus
+ *
+ * Runs on the frame bus thread. Local detectors answer in the JSON format
+ * of the HTTP detection API, so the result takes the same path as an
+ * asynchronous API detection.
+ */
+static void frame_bus_result_ready(const char *stream_name, uint64_t seq, const char *json,
+                                   size_t json_len, void *user_data) {
+    unified_detection_ctx_t *ctx = (unified_detection_ctx_t *)user_data;
+
+    detection_result_t parsed;
+    if (api_detection_parse_response(json, json_len, &parsed) != 0) {
+        return;
+    }
+
+    log_debug("[%s] Frame bus detector answered frame %llu: %d objects",
+              stream_name, (unsigned long long)seq, parsed.count);
+
+    post_detection_result(ctx, &parsed);
+}
+
+/**
+ * Decode a keyframe into a packed RGB24 buffer
+ *
+ * When max_width/max_height are set, larger frames are downscaled to fit,
+ * keeping the aspect ratio.
+ *
+ * @param ctx The unified detection context
+ * @param pkt The video packet containing a keyframe
+ * @param max_width Largest output width (0 = native size)
+ * @param max_height Largest output height (0 = native size)
+ * @param width Output: width of the returned image
+ * @param height Output: height of the returned image
+ * @return malloc'd RGB24 buffer the caller frees, or NULL on failure
+ */
+static uint8_t *decode_packet_to_rgb(unified_detection_ctx_t *ctx, AVPacket *pkt,
+                                     int max_width, int max_height, int *width, int *height) {
+    if (!pkt || !ctx->decoder_ctx) {
+        return NULL;
+    }
+
+    int ret = avcodec_send_packet(ctx->decoder_ctx, pkt);
+    if (ret < 0) {
+        log_debug("[%s] Decode failed: avcodec_send_packet error %d", ctx->stream_name, ret);
+        return NULL;
+    }
+
+    AVFrame *frame = av_frame_alloc();
+    if (!frame) {
+        return NULL;
+    }
+
+    ret = avcodec_receive_frame(ctx->decoder_ctx, frame);
+    if (ret < 0) {
+        av_frame_free(&frame);
+        log_debug("[%s] Decode failed: avcodec_receive_frame error %d", ctx->stream_name, ret);
+        return NULL;
+    }
+
+    int out_width = frame->width;
+    int out_height = frame->height;
+    if (max_width > 0 && max_height > 0 && (out_width > max_width || out_height > max_height)) {
+        if ((long long)out_width * max_height > (long long)out_height * max_width) {
+            out_height = (int)((long long)out_height * max_width / out_width);
+            out_width = max_width;
+        } else {
+            out_width = (int)((long long)out_width * max_height / out_height);
+            out_height = max_height;
+        }
+        out_width &= ~1;
+        out_height &= ~1;
+    }
+
+    struct SwsContext *sws_ctx = sws_getContext(
+        frame->width, frame->height, frame->format,
+        out_width, out_height, AV_PIX_FMT_RGB24,
+        SWS_BILINEAR, NULL, NULL, NULL);
+    if (!sws_ctx) {
+        log_error("[%s] Failed to create sws context", ctx->stream_name);
+        av_frame_free(&frame);
+        return NULL;
+    }
+
+    uint8_t *rgb_buffer = malloc((size_t)out_width * out_height * 3);
+    if (!rgb_buffer) {
+        log_error("[%s] Failed to allocate RGB buffer", ctx->stream_name);
+        sws_freeContext(sws_ctx);
+        av_frame_free(&frame);
+        return NULL;
+    }
+
+    uint8_t *rgb_data[4] = {rgb_buffer, NULL, NULL, NULL};
+    int rgb_linesize[4] = {out_width * 3, 0, 0, 0};
+    sws_scale(sws_ctx, (const uint8_t * const *)frame->data, frame->linesize,
+              0, frame->height, rgb_data, rgb_linesize);
+
+    sws_freeContext(sws_ctx);
+    av_frame_free(&frame);
+
+    *width = out_width;
+    *height = out_height;
+    return rgb_buffer;
+}
+
+/**
+ * Publish a decoded frame to the frame bus
+ *
+ * @return true if a detector will answer through frame_bus_result_ready()
+ */
+static bool publish_rgb_to_bus(unified_detection_ctx_t *ctx, const uint8_t *rgb, int width, int height) {
+    uint64_t seq = 0;
+    if (frame_bus_publish(ctx->stream_name, rgb, width, height, &seq) != 0) {
+        return false;
+    }
+    log_debug("[%s] Published %dx%d frame %llu to the frame bus",
+              ctx->stream_name, width, height, (unsigned long long)seq);
+    return true;
+}
+
+/**
+ * Decode a keyframe and publish it to the frame bus
+ *
+ * The frame is converted to RGB24 and downscaled to fit
+ * [frame_bus] max_width x max_height. Detections arrive later through
+ * frame_bus_result_ready().
+ *
+ * @param ctx The unified detection context
+ * @param pkt The video packet containing a keyframe
+ * @param pending Output: set when a frame was handed to a detector
+ */
+static void publish_frame_to_bus(unified_detection_ctx_t *ctx, AVPacket *pkt, bool *pending) {
+    if (!frame_bus_has_subscriber(ctx->stream_name)) {
+        // Don't decode frames nobody will look at
+        log_debug("[%s] No detector attached to the frame bus, skipping", ctx->stream_name);
+        return;
+    }
+
+    int width = 0;
+    int height = 0;
+    uint8_t *rgb_buffer = decode_packet_to_rgb(ctx, pkt, g_config.frame_bus_max_width,
+                                               g_config.frame_bus_max_height, &width, &height);
+    if (!rgb_buffer) {
+        return;
+    }
+
+    if (publish_rgb_to_bus(ctx, rgb_buffer, width, height) && pending) {
+        *pending = true;
+    }
+    free(rgb_buffer);
+}
+
+/**
+ * Run completed asynchronous API and frame bus detections through the
+ * detection pipeline
+ */
+static void drain_api_detection_results(unified_detection_ctx_t *ctx, time_t now) {
+    detection_result_t results[UDT_API_RESULT_SLOTS];
+    int count;
+
+    atomic_store(&ctx->api_results_ready, 0);
+    pthread_mutex_lock(&ctx->mutex);
+    count = ctx->api_result_count;
+    memcpy(results, ctx->api_results, sizeof(detection_result_t) * (size_t)count);
+    ctx->api_result_count = 0;
+    pthread_mutex_unlock(&ctx->mutex);
+
+    for (int r = 0; r < count; r++) {
+        detection_result_t *result = &results[r];
+        if (api_detection_process_result(ctx->stream_name, result, detection_recording_id(ctx)) != 0) {
+            continue;
+        }
+
+        bool detection_triggered = false;
+        for (int i = 0; i < result->count; i++) {
+            if (result->detections[i].confidence >= ctx->detection_threshold) {
+                detection_triggered = true;
+                log_info("[%s] API Detection: %s (%.1f%%) at [%.2f, %.2f, %.2f, %.2f]",
+                         ctx->stream_name,
+                         result->detections[i].label,
+                         result->detections[i].confidence * 100.0f,
+                         result->detections[i].x,
+                         result->detections[i].y,
+                         result->detections[i].width,
+                         result->detections[i].height);
+            }
+        }
+
+        if (ctx->is_cascade && detection_triggered) {
+            // The last stage answered asynchronously; its run was counted on submit
+            detection_cascade_record_hit(ctx->stream_name, ctx->cascade.stage_count - 1);
+        }
+
+        unified_detection_state_t current_state = atomic_load(&ctx->state);
+        handle_detection_outcome(ctx, detection_triggered, now, current_state);
+    }
+}
+
+/**
+ * Act on the detections of a model that ran on this thread
+ *
+ * Logs the detections above the threshold and stores track events
+ * (start/update/end) rather than every box. Also call this with an empty
+ * result when the model did not run, so vanished tracks end.
+ *
+ * @return true if any detection met the threshold
+ */
+static bool finish_local_detection(unified_detection_ctx_t *ctx, detection_result_t *result) {
+    // Check if any detections meet the threshold
+    bool detection_triggered = false;
+    for (int i = 0; i < result->count; i++) {
+        if (result->detections[i].confidence >= ctx->detection_threshold) {
+            detection_triggered = true;
+            log_info("[%s] Detection: %s (%.1f%%) at [%.2f, %.2f, %.2f, %.2f]",
+                     ctx->stream_name,
+                     result->detections[i].label,
+                     result->detections[i].confidence * 100.0f,
+                     result->detections[i].x,
+                     result->detections[i].y,
+                     result->detections[i].width,
+                     result->detections[i].height);
+        }
+    }
+
+    // Store track events (start/update/end) rather than every box. The
+    // tracker also runs on empty frames so vanished tracks end.
+    time_t now = time(NULL);
+    detection_result_t events;
+    object_tracker_process(ctx->stream_name, result, now, &events);
+
+    if (events.count > 0) {
+        // Link detections to the current recording
+        uint64_t rec_id = 0;
+        if (ctx->annotation_only) {
+            // In annotation_only mode, link detections to the continuous recording
+            rec_id = get_current_recording_id_for_stream(ctx->stream_name);
+            if (rec_id > 0) {
+                log_debug("[%s] Annotation mode: linking detections to recording ID %lu",
+                         ctx->stream_name, (unsigned long)rec_id);
+            } else {
+                log_debug("[%s] Annotation mode: no active recording to link detections to",
+                         ctx->stream_name);
+            }
+        } else if (ctx->current_recording_id > 0) {
+            // For detection recordings, link to the current detection recording
+            rec_id = ctx->current_recording_id;
+            log_debug("[%s] Detection mode: linking detections to recording ID %lu",
+                     ctx->stream_name, (unsigned long)rec_id);
+        }
+
+        if (queue_detections_for_db(ctx->stream_name, &events, now, rec_id) != 0) {
+            log_warn("[%s] Failed to store detections in database", ctx->stream_name);
+        }
+    }
+
+    if (result->count > 0) {
+        pthread_mutex_lock(&ctx->mutex);
+        ctx->total_detections += result->count;
+        pthread_mutex_unlock(&ctx->mutex);
+    }
+
+    return detection_triggered;
+}
+
+/**
+ * Run a model on crops around the given regions
+ *
+ * Falls back to the whole frame when detection_roi_plan() finds nothing
+ * worth cropping. Boxes are returned in frame coordinates.
+ *
+ * @param regions Zone boxes or motion regions (NULL = whole frame)
+ * @return 0 on success, non-zero if the model failed
+ */
+static int detect_objects_in_regions(unified_detection_ctx_t *ctx, detection_model_t model,
+                                     const uint8_t *rgb, int width, int height,
+                                     const detection_result_t *regions, detection_result_t *result) {
+    detection_roi_t rois[DETECTION_ROI_MAX_REGIONS];
+    int roi_count = detection_roi_plan(regions, width, height, rois);
+    if (roi_count == 0) {
+        return detect_objects(model, rgb, width, height, 3, result);
+    }
+
+    size_t crop_size = 0;
+    for (int i = 0; i < roi_count; i++) {
+        size_t size = (size_t)rois[i].width * rois[i].height * 3;
+        if (size > crop_size) crop_size = size;
+    }
+    uint8_t *crop = malloc(crop_size);
+    if (!crop) {
+        return detect_objects(model, rgb, width, height, 3, result);
+    }
+
+    memset(result, 0, sizeof(*result));
+    int ret = 0;
+    for (int i = 0; i < roi_count; i++) {
+        detection_result_t part;
+        memset(&part, 0, sizeof(part));
+        detection_roi_crop(rgb, width, 3, &rois[i], crop);
+        ret = detect_objects(model, crop, rois[i].width, rois[i].height, 3, &part);
+        if (ret != 0) {
+            break;
+        }
+        detection_roi_map_to_frame(&part, &rois[i], width, height);
+        detection_roi_merge(result, &part);
+    }
+    free(crop);
+
+    log_debug("[%s] Ran model on %d crops: %d objects", ctx->stream_name, roi_count, result->count);
+    return ret;
+}
+
+/**
+ * Run a RealNet model on the luma plane, cropped around the given regions
+ *
+ * Crops are views into the plane, so nothing is copied.
+ */
+static int detect_realnet_luma_in_regions(unified_detection_ctx_t *ctx, void *realnet_model,
+                                          const uint8_t *luma, int width, int height, int stride,
+                                          const detection_result_t *regions, detection_result_t *result) {
+    detection_roi_t rois[DETECTION_ROI_MAX_REGIONS];
+    int roi_count = detection_roi_plan(regions, width, height, rois);
+    if (roi_count == 0) {
+        return detect_with_sod_realnet_luma(realnet_model, luma, width, height, stride, result);
+    }
+
+    memset(result, 0, sizeof(*result));
+    for (int i = 0; i < roi_count; i++) {
+        detection_result_t part;
+        memset(&part, 0, sizeof(part));
+        const uint8_t *view = luma + (size_t)rois[i].y * stride + rois[i].x;
+        int ret = detect_with_sod_realnet_luma(realnet_model, view, rois[i].width, rois[i].height,
+                                               stride, &part);
+        if (ret != 0) {
+            return ret;
+        }
+        detection_roi_map_to_frame(&part, &rois[i], width, height);
+        detection_roi_merge(result, &part);
+    }
+
+    log_debug("[%s] Ran RealNet on %d crops: %d objects", ctx->stream_name, roi_count, result->count);
+    return 0;
+}
+
+/**
+ * Regions a model should be cropped to when nothing narrower is known:
+ * the bounding boxes of the stream's enabled zones
+ *
+ * @return regions, or NULL to scan the whole frame
+ */
+static const detection_result_t *zone_regions(unified_detection_ctx_t *ctx, detection_result_t *regions) {
+    if (!g_config.roi_cropping || get_zone_bounding_boxes(ctx->stream_name, regions) <= 0) {
+        return NULL;
+    }
+    return regions;
+}
+
+static uint64_t monotonic_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL;
+}
+
+/**
+ * Hand the keyframe to an API or frame bus stage that ends a cascade
+ *
+ * @param pending Output: set when the outcome will be delivered asynchronously
+ * @return true if a synchronous API detection was triggered
+ */
+static bool run_cascade_remote_stage(unified_detection_ctx_t *ctx, const cascade_stage_t *stage,
+                                     const uint8_t *rgb, int width, int height, bool *pending) {
+    if (stage->kind == CASCADE_STAGE_FRAME_BUS) {
+        if (frame_bus_has_subscriber(ctx->stream_name) &&
+            publish_rgb_to_bus(ctx, rgb, width, height) && pending) {
+            *pending = true;
+        }
+        return false;
+    }
+
+    detection_result_t result;
+    memset(&result, 0, sizeof(result));
+    uint64_t rec_id = detection_recording_id(ctx);
+    int detect_ret;
+
+    if (g_config.api_detection_async) {
+        detect_ret = detect_objects_api_snapshot_async(stage->model_path, ctx->stream_name,
+                                                       ctx->detection_threshold,
+                                                       api_detection_complete, ctx);
+        if (detect_ret == 0 || detect_ret == API_DETECTION_CLIENT_BUSY) {
+            if (pending) *pending = true;
+            return false;
+        }
+    } else {
+        detect_ret = detect_objects_api_snapshot(stage->model_path, ctx->stream_name,
+                                                 &result, ctx->detection_threshold, rec_id);
+    }
+
+    if (detect_ret == DETECT_SNAPSHOT_UNAVAILABLE) {
+        // The keyframe is already decoded, send it instead
+        const char *actual_api_url = get_actual_api_url(ctx->stream_name, stage->model_path);
+        if (actual_api_url == NULL) {
+            return false;
+        }
+        detect_ret = detect_objects_api(actual_api_url, rgb, width, height, 3,
+                                        &result, ctx->stream_name, ctx->detection_threshold, rec_id);
+    }
+
+    if (detect_ret != 0) {
+        log_warn("[%s] Cascade API detection failed with error %d", ctx->stream_name, detect_ret);
+        return false;
+    }
+
+    bool triggered = false;
+    for (int i = 0; i < result.count; i++) {
+        if (result.detections[i].confidence >= ctx->detection_threshold) {
+            triggered = true;
+            log_info("[%s] API Detection: %s (%.1f%%) at [%.2f, %.2f, %.2f, %.2f]",
+                     ctx->stream_name,
+                     result.detections[i].label,
+                     result.detections[i].confidence * 100.0f,
+                     result.detections[i].x,
+                     result.detections[i].y,
+                     result.detections[i].width,
+                     result.detections[i].height);
+        }
+    }
+    return triggered;
+}
+
+/**
+ * Run a detection cascade on a keyframe
+ *
+ * The keyframe is decoded once and every stage runs on the same image,
+ * each only when the previous stage fired. Motion regions gate the
+ * detections of the model stage that follows. When the cascade stops
+ * before its last stage, that stage still sees an empty result so its
+ * tracks end.
+ *
+ * @param ctx The unified detection context
+ * @param pkt The video packet containing a keyframe
+ * @param pending Output: set when the last stage answers asynchronously
+ * @return true if the last stage fired
+ */
+static bool run_detection_cascade(unified_detection_ctx_t *ctx, AVPacket *pkt, bool *pending) {
+    const detection_cascade_t *cascade = &ctx->cascade;
+    const int last = cascade->stage_count - 1;
+    const cascade_stage_t *final_stage = &cascade->stages[last];
+
+    // Size the frame for the frame bus when that is where it ends up
+    int max_width = 0;
+    int max_height = 0;
+    if (final_stage->kind == CASCADE_STAGE_FRAME_BUS) {
+        max_width = g_config.frame_bus_max_width;
+        max_height = g_config.frame_bus_max_height;
+    }
+
+    int width = 0;
+    int height = 0;
+    uint8_t *rgb = decode_packet_to_rgb(ctx, pkt, max_width, max_height, &width, &height);
+    if (!rgb) {
+        return false;
+    }
+
+    detection_result_t regions;
+    detection_result_t zones;
+    bool have_regions = false;
+    bool triggered = false;
+    int stage_idx;
+    memset(&regions, 0, sizeof(regions));
+
+    for (stage_idx = 0; stage_idx <= last; stage_idx++) {
+        const cascade_stage_t *stage = &cascade->stages[stage_idx];
+        uint64_t start_us = monotonic_us();
+        detection_result_t result;
+        bool fired = false;
+        memset(&result, 0, sizeof(result));
+
+        if (stage->kind == CASCADE_STAGE_MOTION) {
+            if (detect_motion(ctx->stream_name, rgb, width, height, 3, time(NULL), &result) != 0) {
+                log_warn("[%s] Cascade motion stage failed", ctx->stream_name);
+            } else if (result.count > 0) {
+                if (filter_detections_by_zones(ctx->stream_name, &result) != 0) {
+                    log_warn("[%s] Zone filtering failed for motion detections, keeping all",
+                             ctx->stream_name);
+                }
+                for (int i = 0; i < result.count && !fired; i++) {
+                    fired = result.detections[i].confidence >= ctx->detection_threshold;
+                }
+            }
+            record_motion_score(ctx, &result, time(NULL));
+            if (fired) {
+                regions = result;
+                have_regions = true;
+            }
+        } else if (stage->kind == CASCADE_STAGE_MODEL) {
+            detection_model_t *model = &ctx->cascade_models[stage_idx];
+            if (!*model) {
+                *model = load_detection_model(stage->model_path, ctx->detection_threshold);
+                if (*model) {
+                    log_info("[%s] Loaded cascade model: %s", ctx->stream_name, stage->model_path);
+                }
+            }
+            if (!*model) {
+                log_warn("[%s] Failed to load cascade model: %s", ctx->stream_name, stage->model_path);
+            } else if (detect_objects_in_regions(ctx, *model, rgb, width, height,
+                                                 have_regions ? &regions : zone_regions(ctx, &zones),
+                                                 &result) != 0) {
+                log_warn("[%s] Cascade stage %s failed", ctx->stream_name, stage->name);
+                result.count = 0;
+            } else if (have_regions) {
+                detection_cascade_filter_by_regions(&result, &regions);
+            }
+
+            if (stage_idx == last) {
+                fired = finish_local_detection(ctx, &result);
+            } else {
+                for (int i = 0; i < result.count && !fired; i++) {
+                    fired = result.detections[i].confidence >= ctx->detection_threshold;
+                }
+                if (fired) {
+                    // Later stages look where this model found something
+                    regions = result;
+                    have_regions = true;
+                }
+            }
+        } else {
+            fired = run_cascade_remote_stage(ctx, stage, rgb, width, height, pending);
+        }
+
+        detection_cascade_record_run(ctx->stream_name, cascade, stage_idx, fired,
+                                     monotonic_us() - start_us);
+
+        if (stage_idx == last) {
+            triggered = fired;
+        } else if (!fired) {
+            break;
+        }
+    }
+
+    free(rgb);
+
+    if (stage_idx < last) {
+        // Stopped early: let the last stage's tracks end
+        detection_result_t empty;
+        memset(&empty, 0, sizeof(empty));
+        if (final_stage->kind == CASCADE_STAGE_MODEL) {
+            finish_local_detection(ctx, &empty);
+        } else {
+            api_detection_process_result(ctx->stream_name, &empty, detection_recording_id(ctx));
+        }
+    }
+
+    return triggered;
+}
+
 /**
  * Run detection on a keyframe
  *
@@ -2208,36 +3101,62 @@ static int flush_prebuffer_to_recording(unified_detection_ctx_t *ctx) {
  * and embedded model detection (SOD). For API detection, it uses go2rtc
  * snapshots which is more efficient than decoding frames.
  *
+ * With [api_detection] async enabled, API detection only queues the request
+ * and sets *pending; the outcome arrives via drain_api_detection_results().
+ * The "frame-bus" model works the same way with a local detector.
+ * Cascades are handed to run_detection_cascade().
+ *
  * @param ctx The unified detection context
  * @param pkt The video packet containing a keyframe (unused for API detection)
+ * @param pending Output: set when the outcome will be delivered asynchronously
  * @return true if detection was triggered, false otherwise
  */
-static bool run_detection_on_frame(unified_detection_ctx_t *ctx, AVPacket *pkt) {
+static bool run_detection_on_frame(unified_detection_ctx_t *ctx, AVPacket *pkt, bool *pending) {
     if (!ctx) return false;
 
     detection_result_t result;
     memset(&result, 0, sizeof(detection_result_t));
 
+    // Multi-stage cascade ("cascade:motion,model.sod,api-detection")
+    if (ctx->is_cascade) {
+        return run_detection_cascade(ctx, pkt, pending);
+    }
+
+    // Local detector attached to the shared-memory frame bus
+    if (is_frame_bus_model(ctx->model_path)) {
+        publish_frame_to_bus(ctx, pkt, pending);
+        return false;
+    }
+
     // Check if this is API-based detection
     if (is_api_detection(ctx->model_path)) {
         // API detection - try go2rtc snapshot first (more efficient, no frame decoding needed)
         log_debug("[%s] Running API detection via snapshot", ctx->stream_name);
 
-        // Determine recording_id to link detections to
-        uint64_t rec_id = 0;
-        if (ctx->annotation_only) {
-            // In annotation_only mode, link detections to the continuous recording
-            rec_id = get_current_recording_id_for_stream(ctx->stream_name);
-        } else if (ctx->current_recording_id > 0) {
-            // For detection recordings, link to the current detection recording
-            rec_id = ctx->current_recording_id;
-        }
-
         // The model_path contains either "api-detection" or an HTTP URL
         // detect_objects_api_snapshot handles the "api-detection" special case
         // by looking up g_config.api_detection_url
-        int detect_ret = detect_objects_api_snapshot(ctx->model_path, ctx->stream_name,
+        bool use_async = g_config.api_detection_async;
+        int detect_ret = -1;
+        if (use_async) {
+            detect_ret = detect_objects_api_snapshot_async(ctx->model_path, ctx->stream_name,
+                                                           ctx->detection_threshold,
+                                                           api_detection_complete, ctx);
+            if (detect_ret == 0 || detect_ret == API_DETECTION_CLIENT_BUSY) {
+                // Queued (or the previous requests are still outstanding):
+                // the outcome arrives through the api_results mailbox
+                if (pending) *pending = true;
+                return false;
+            }
+        }
+
+        // Determine recording_id to link detections to
+        uint64_t rec_id = detection_recording_id(ctx);
+
+        if (!use_async) {
+            detect_ret = detect_objects_api_snapshot(ctx->model_path, ctx->stream_name,
                                                      &result, ctx->detection_threshold, rec_id);
+        }
 
         if (detect_ret == DETECT_SNAPSHOT_UNAVAILABLE) {
             // go2rtc snapshot failed - fall back to local frame decoding
@@ -2428,6 +3347,7 @@ static bool run_detection_on_frame(unified_detection_ctx_t *ctx, AVPacket *pkt)
                          ctx->stream_name);
             }
         }
+        record_motion_score(ctx, &result, time(NULL));
 
         // Filter out detections below the threshold so they are not stored
         // or displayed on the overlay.  Keep only those that meet the
@@ -2457,18 +3377,23 @@ static bool run_detection_on_frame(unified_detection_ctx_t *ctx, AVPacket *pkt)
             result.count = kept;
         }
 
-        // Store detections in database if any passed the threshold
-        if (result.count > 0) {
-            time_t now = time(NULL);
+        // Store track events for the detections that passed the threshold.
+        // The tracker also runs on empty frames so vanished tracks end.
+        time_t mot_now = time(NULL);
+        detection_result_t mot_events;
+        object_tracker_process(ctx->stream_name, &result, mot_now, &mot_events);
+        if (mot_events.count > 0) {
             uint64_t rec_id = 0;
             if (ctx->annotation_only) {
                 rec_id = get_current_recording_id_for_stream(ctx->stream_name);
             } else if (ctx->current_recording_id > 0) {
                 rec_id = ctx->current_recording_id;
             }
-            if (store_detections_in_db(ctx->stream_name, &result, now, rec_id) != 0) {
+            if (queue_detections_for_db(ctx->stream_name, &mot_events, mot_now, rec_id) != 0) {
                 log_warn("[%s] Failed to store motion detections in database", ctx->stream_name);
             }
+        }
+        if (result.count > 0) {
             pthread_mutex_lock(&ctx->mutex);
             ctx->total_detections += result.count;
             pthread_mutex_unlock(&ctx->mutex);
@@ -2545,99 +3470,72 @@ static bool run_detection_on_frame(unified_detection_ctx_t *ctx, AVPacket *pkt)
         return false;
     }
 
-    // Convert frame to RGB for detection
     int width = frame->width;
     int height = frame->height;
-    int channels = 3;  // RGB
+    int detect_ret;
+    detection_result_t zones;
+    const detection_result_t *regions = zone_regions(ctx, &zones);
+
+    // RealNet cascades only compare luma samples, so scan the decoder's Y
+    // plane in place instead of converting the frame to RGB. Limited vs full
+    // range does not matter: the comparisons are order preserving.
+    void *realnet_model = NULL;
+    if (strcmp(get_model_type_from_handle(ctx->model), MODEL_TYPE_SOD_REALNET) == 0 &&
+        frame_has_luma_plane(frame->format) && frame->linesize[0] >= width) {
+        realnet_model = get_realnet_model_handle(ctx->model);
+    }
+
+    if (realnet_model) {
+        detect_ret = detect_realnet_luma_in_regions(ctx, realnet_model, frame->data[0], width, height,
+                                                    frame->linesize[0], regions, &result);
+        av_frame_free(&frame);
+    } else {
+        // Convert frame to RGB for detection
+        int channels = 3;  // RGB
 
-    // Create software scaler for conversion
-    struct SwsContext *sws_ctx = sws_getContext(
-        width, height, frame->format,
-        width, height, AV_PIX_FMT_RGB24,
-        SWS_BILINEAR, NULL, NULL, NULL);
+        // Create software scaler for conversion
+        struct SwsContext *sws_ctx = sws_getContext(
+            width, height, frame->format,
+            width, height, AV_PIX_FMT_RGB24,
+            SWS_BILINEAR, NULL, NULL, NULL);
 
-    if (!sws_ctx) {
-        log_error("[%s] Failed to create sws context", ctx->stream_name);
-        av_frame_free(&frame);
-        return false;
-    }
+        if (!sws_ctx) {
+            log_error("[%s] Failed to create sws context", ctx->stream_name);
+            av_frame_free(&frame);
+            return false;
+        }
 
-    // Allocate RGB buffer
-    size_t rgb_buffer_size = (size_t)width * height * channels;
-    uint8_t *rgb_buffer = malloc(rgb_buffer_size);
-    if (!rgb_buffer) {
-        log_error("[%s] Failed to allocate RGB buffer", ctx->stream_name);
-        sws_freeContext(sws_ctx);
-        av_frame_free(&frame);
-        return false;
-    }
+        // Allocate RGB buffer
+        size_t rgb_buffer_size = (size_t)width * height * channels;
+        uint8_t *rgb_buffer = malloc(rgb_buffer_size);
+        if (!rgb_buffer) {
+            log_error("[%s] Failed to allocate RGB buffer", ctx->stream_name);
+            sws_freeContext(sws_ctx);
+            av_frame_free(&frame);
+            return false;
+        }
 
-    // Convert frame to RGB
-    uint8_t *rgb_data[4] = {rgb_buffer, NULL, NULL, NULL};
-    int rgb_linesize[4] = {width * channels, 0, 0, 0};
+        // Convert frame to RGB
+        uint8_t *rgb_data[4] = {rgb_buffer, NULL, NULL, NULL};
+        int rgb_linesize[4] = {width * channels, 0, 0, 0};
 
-    sws_scale(sws_ctx, (const uint8_t * const *)frame->data, frame->linesize,
-              0, height, rgb_data, rgb_linesize);
+        sws_scale(sws_ctx, (const uint8_t * const *)frame->data, frame->linesize,
+                  0, height, rgb_data, rgb_linesize);
 
-    sws_freeContext(sws_ctx);
-    av_frame_free(&frame);
+        sws_freeContext(sws_ctx);
+        av_frame_free(&frame);
 
-    // Run detection
-    int detect_ret = detect_objects(ctx->model, rgb_buffer, width, height, channels, &result);
+        // Run detection, cropped to the zones when they cover part of the frame
+        detect_ret = detect_objects_in_regions(ctx, ctx->model, rgb_buffer, width, height,
+                                               regions, &result);
 
-    free(rgb_buffer);
+        free(rgb_buffer);
+    }
 
     if (detect_ret != 0) {
         log_warn("[%s] Detection failed with error %d", ctx->stream_name, detect_ret);
         return false;
     }
 
-    // Check if any detections meet the threshold
-    bool detection_triggered = false;
-    for (int i = 0; i < result.count; i++) {
-        if (result.detections[i].confidence >= ctx->detection_threshold) {
-            detection_triggered = true;
-            log_info("[%s] Detection: %s (%.1f%%) at [%.2f, %.2f, %.2f, %.2f]",
-                     ctx->stream_name,
-                     result.detections[i].label,
-                     result.detections[i].confidence * 100.0f,
-                     result.detections[i].x,
-                     result.detections[i].y,
-                     result.detections[i].width,
-                     result.detections[i].height);
-        }
-    }
-
-    // Store detections in database if any were found
-    if (result.count > 0) {
-        time_t now = time(NULL);
-
-        // Link detections to the current recording
-        uint64_t rec_id = 0;
-        if (ctx->annotation_only) {
-            // In annotation_only mode, link detections to the continuous recording
-            rec_id = get_current_recording_id_for_stream(ctx->stream_name);
-            if (rec_id > 0) {
-                log_debug("[%s] Annotation mode: linking detections to recording ID %lu",
-                         ctx->stream_name, (unsigned long)rec_id);
-            } else {
-                log_debug("[%s] Annotation mode: no active recording to link detections to",
-                         ctx->stream_name);
-            }
-        } else if (ctx->current_recording_id > 0) {
-            // For detection recordings, link to the current detection recording
-            rec_id = ctx->current_recording_id;
-            log_debug("[%s] Detection mode: linking detections to recording ID %lu",
-                     ctx->stream_name, (unsigned long)rec_id);
-        }
-
-        if (store_detections_in_db(ctx->stream_name, &result, now, rec_id) != 0) {
-            log_warn("[%s] Failed to store detections in database", ctx->stream_name);
-        }
-        pthread_mutex_lock(&ctx->mutex);
-        ctx->total_detections += result.count;
-        pthread_mutex_unlock(&ctx->mutex);
-    }
-
-    return detection_triggered;
+    return finish_local_detection(ctx, &result);
 }
@@ -1,5 +1,8 @@
+#include <stdlib.h>
+#include <stdint.h>
 #include <string.h>
 #include <math.h>
+#include <pthread.h>
 
 #include "video/zone_filter.h"
 #include "database/db_zones.h"
@@ -9,23 +12,79 @@
 #include "utils/strings.h"
 
 /**
- * Check if a point is inside a polygon using ray casting algorithm
+ * Check if a detection meets the zone's confidence threshold
+ */
+static bool detection_meets_confidence(const detection_t *detection, const detection_zone_t *zone) {
+    // If no minimum confidence is set (0.0), accept all
+    if (zone->min_confidence <= 0.0f) {
+        return true;
+    }
+
+    return detection->confidence >= zone->min_confidence;
+}
+
+/*
+ * Compiled zone cache
+ *
+ * Zones only change when someone edits them, but filtering runs on every
+ * detection result. Each stream's enabled zones are therefore compiled once
+ * into a bounding box, an edge table and pre-split class list, plus a
+ * ZONE_RASTER_SIZE x ZONE_RASTER_SIZE raster over the normalized frame. Per
+ * raster cell, inside_bits marks zones that contain the whole cell and
+ * edge_bits marks zones whose outline passes through it, so most boxes are
+ * resolved with a single lookup and only boundary cells fall back to the
+ * exact ray cast. Entries are rebuilt when get_detection_zones_generation()
+ * moves on, i.e. after any write through db_zones.c.
+ */
+#define ZONE_RASTER_SIZE 32
+#define ZONE_RASTER_MARGIN 1e-4f
+#define ZONE_MAX_CLASSES 64
+
+typedef struct {
+    float xi, yi, xj, yj;
+} zone_edge_t;
+
+typedef struct {
+    const detection_zone_t *src;        // points into zone_cache_entry_t.zones
+    float min_x, min_y, max_x, max_y;   // polygon bounding box
+    int edge_count;                     // 0 for degenerate polygons (never match)
+    zone_edge_t edges[MAX_ZONE_POINTS];
+    bool has_class_filter;
+    int class_count;
+    const char *classes[ZONE_MAX_CLASSES];
+    char class_buf[256];
+} compiled_zone_t;
+
+typedef struct {
+    char stream_name[MAX_STREAM_NAME];
+    uint64_t generation;
+    int zone_count;                          // all zones, enabled or not
+    int enabled_count;                       // entries in compiled[]
+    detection_zone_t zones[MAX_ZONES_PER_STREAM];
+    compiled_zone_t compiled[MAX_ZONES_PER_STREAM];
+    uint16_t inside_bits[ZONE_RASTER_SIZE * ZONE_RASTER_SIZE];
+    uint16_t edge_bits[ZONE_RASTER_SIZE * ZONE_RASTER_SIZE];
+} zone_cache_entry_t;
+
+static zone_cache_entry_t *zone_cache[MAX_STREAMS];
+static int zone_cache_next_evict = 0;
+static pthread_rwlock_t zone_cache_lock = PTHREAD_RWLOCK_INITIALIZER;
+
+/**
+ * Check if a point is inside a compiled zone using ray casting, with a
+ * bounding box reject in front of the edge loop
  */
-static bool point_in_polygon(float x, float y, const zone_point_t *polygon, int polygon_count) {
-    if (!polygon || polygon_count < 3) {
+static bool compiled_zone_contains(const compiled_zone_t *cz, float x, float y) {
+    if (cz->edge_count == 0 ||
+        x < cz->min_x || x > cz->max_x || y < cz->min_y || y > cz->max_y) {
         return false;
     }
 
     bool inside = false;
-    for (int i = 0, j = polygon_count - 1; i < polygon_count; j = i++) {
-        float xi = polygon[i].x;
-        float yi = polygon[i].y;
-        float xj = polygon[j].x;
-        float yj = polygon[j].y;
-
-        bool intersect = ((yi > y) != (yj > y)) &&
-                        (x < (xj - xi) * (y - yi) / (yj - yi) + xi);
-        if (intersect) {
+    for (int i = 0; i < cz->edge_count; i++) {
+        const zone_edge_t *e = &cz->edges[i];
+        if (((e->yi > y) != (e->yj > y)) &&
+            (x < (e->xj - e->xi) * (y - e->yi) / (e->yj - e->yi) + e->xi)) {
             inside = !inside;
         }
     }
@@ -33,65 +92,248 @@ static bool point_in_polygon(float x, float y, const zone_point_t *polygon, int
 }
 
 /**
- * Check if a detection's center point is within a zone
+ * Check whether a segment touches an axis-aligned rectangle
  */
-static bool detection_in_zone(const detection_t *detection, const detection_zone_t *zone) {
-    if (!detection || !zone || !zone->enabled) {
+static bool segment_touches_rect(const zone_edge_t *e, float x0, float y0, float x1, float y1) {
+    if (fmaxf(e->xi, e->xj) < x0 || fminf(e->xi, e->xj) > x1 ||
+        fmaxf(e->yi, e->yj) < y0 || fminf(e->yi, e->yj) > y1) {
         return false;
     }
 
-    // Calculate center point of detection bounding box
-    float center_x = detection->x + (detection->width / 2.0f);
-    float center_y = detection->y + (detection->height / 2.0f);
+    // Rectangle corners all strictly on one side of the line: no contact
+    float dx = e->xj - e->xi;
+    float dy = e->yj - e->yi;
+    float c[4] = {
+        dx * (y0 - e->yi) - dy * (x0 - e->xi),
+        dx * (y0 - e->yi) - dy * (x1 - e->xi),
+        dx * (y1 - e->yi) - dy * (x0 - e->xi),
+        dx * (y1 - e->yi) - dy * (x1 - e->xi),
+    };
+    bool all_pos = c[0] > 0.0f && c[1] > 0.0f && c[2] > 0.0f && c[3] > 0.0f;
+    bool all_neg = c[0] < 0.0f && c[1] < 0.0f && c[2] < 0.0f && c[3] < 0.0f;
+    return !all_pos && !all_neg;
+}
+
+static void compile_zone(compiled_zone_t *cz, const detection_zone_t *zone) {
+    memset(cz, 0, sizeof(*cz));
+    cz->src = zone;
+
+    if (zone->polygon_count >= 3) {
+        int n = zone->polygon_count;
+        cz->min_x = cz->max_x = zone->polygon[0].x;
+        cz->min_y = cz->max_y = zone->polygon[0].y;
+        for (int i = 0, j = n - 1; i < n; j = i++) {
+            cz->edges[i] = (zone_edge_t){zone->polygon[i].x, zone->polygon[i].y,
+                                         zone->polygon[j].x, zone->polygon[j].y};
+            cz->min_x = fminf(cz->min_x, zone->polygon[i].x);
+            cz->max_x = fmaxf(cz->max_x, zone->polygon[i].x);
+            cz->min_y = fminf(cz->min_y, zone->polygon[i].y);
+            cz->max_y = fmaxf(cz->max_y, zone->polygon[i].y);
+        }
+        cz->edge_count = n;
+    }
 
-    // Check if center is in polygon
-    return point_in_polygon(center_x, center_y, zone->polygon, zone->polygon_count);
+    // Split the comma-separated class filter once, trimming whitespace
+    cz->has_class_filter = zone->filter_classes[0] != '\0';
+    if (cz->has_class_filter) {
+        safe_strcpy(cz->class_buf, zone->filter_classes, sizeof(cz->class_buf), 0);
+        char *saveptr = NULL;
+        char *token = strtok_r(cz->class_buf, ",", &saveptr);
+        while (token && cz->class_count < ZONE_MAX_CLASSES) {
+            while (*token == ' ') token++;
+            char *end = token + strlen(token) - 1;
+            while (end > token && *end == ' ') {
+                *end = '\0';
+                end--;
+            }
+            cz->classes[cz->class_count++] = token;
+            token = strtok_r(NULL, ",", &saveptr);
+        }
+    }
+}
+
+static void compile_zone_raster(zone_cache_entry_t *entry) {
+    const float cell = 1.0f / (float)ZONE_RASTER_SIZE;
+
+    for (int k = 0; k < entry->enabled_count; k++) {
+        const compiled_zone_t *cz = &entry->compiled[k];
+        uint16_t bit = (uint16_t)(1u << k);
+        if (cz->edge_count == 0) {
+            continue;
+        }
+
+        for (int gy = 0; gy < ZONE_RASTER_SIZE; gy++) {
+            float y0 = (float)gy * cell - ZONE_RASTER_MARGIN;
+            float y1 = (float)(gy + 1) * cell + ZONE_RASTER_MARGIN;
+            for (int gx = 0; gx < ZONE_RASTER_SIZE; gx++) {
+                float x0 = (float)gx * cell - ZONE_RASTER_MARGIN;
+                float x1 = (float)(gx + 1) * cell + ZONE_RASTER_MARGIN;
+                int idx = gy * ZONE_RASTER_SIZE + gx;
+
+                if (x1 < cz->min_x || x0 > cz->max_x || y1 < cz->min_y || y0 > cz->max_y) {
+                    continue;
+                }
+
+                bool on_edge = false;
+                for (int e = 0; e < cz->edge_count && !on_edge; e++) {
+                    on_edge = segment_touches_rect(&cz->edges[e], x0, y0, x1, y1);
+                }
+
+                if (on_edge) {
+                    entry->edge_bits[idx] |= bit;
+                } else if (compiled_zone_contains(cz, ((float)gx + 0.5f) * cell,
+                                                  ((float)gy + 0.5f) * cell)) {
+                    entry->inside_bits[idx] |= bit;
+                }
+            }
+        }
+    }
 }
 
 /**
- * Check if a detection's class matches the zone's filter
+ * Load and compile the zones for a stream. Returns NULL on database error.
  */
-static bool detection_class_matches(const detection_t *detection, const detection_zone_t *zone) {
-    // If no filter is set, all classes match
-    if (!zone->filter_classes || zone->filter_classes[0] == '\0') {
-        return true;
+static zone_cache_entry_t *compile_zone_cache_entry(const char *stream_name, uint64_t generation) {
+    zone_cache_entry_t *entry = calloc(1, sizeof(zone_cache_entry_t));
+    if (!entry) {
+        log_error("Failed to allocate zone cache for stream %s", stream_name);
+        return NULL;
     }
 
-    // Check if detection label is in the comma-separated filter list
-    char filter_copy[256];
-    safe_strcpy(filter_copy, zone->filter_classes, sizeof(filter_copy), 0);
+    int zone_count = get_detection_zones(stream_name, entry->zones, MAX_ZONES_PER_STREAM);
+    if (zone_count < 0) {
+        free(entry);
+        return NULL;
+    }
 
-    char *token = strtok(filter_copy, ",");
-    while (token) {
-        // Trim whitespace
-        while (*token == ' ') token++;
-        char *end = token + strlen(token) - 1;
-        while (end > token && *end == ' ') {
-            *end = '\0';
-            end--;
+    safe_strcpy(entry->stream_name, stream_name, sizeof(entry->stream_name), 0);
+    entry->generation = generation;
+    entry->zone_count = zone_count;
+    for (int i = 0; i < zone_count; i++) {
+        if (entry->zones[i].enabled) {
+            compile_zone(&entry->compiled[entry->enabled_count++], &entry->zones[i]);
         }
+    }
+    compile_zone_raster(entry);
 
-        // Check if it matches
-        if (strcmp(token, detection->label) == 0) {
-            return true;
+    log_debug("Compiled %d enabled zones (of %d) for stream %s",
+              entry->enabled_count, zone_count, stream_name);
+    return entry;
+}
+
+static int find_zone_cache_slot(const char *stream_name) {
+    for (int i = 0; i < MAX_STREAMS; i++) {
+        if (zone_cache[i] && strcmp(zone_cache[i]->stream_name, stream_name) == 0) {
+            return i;
         }
+    }
+    return -1;
+}
 
-        token = strtok(NULL, ",");
+/**
+ * Get the compiled zones for a stream, rebuilding them if the zone table
+ * changed. On success the cache read lock is held and the caller must call
+ * release_zone_cache(); returns NULL (no lock held) on error.
+ */
+static const zone_cache_entry_t *acquire_zone_cache(const char *stream_name) {
+    uint64_t generation = get_detection_zones_generation();
+
+    pthread_rwlock_rdlock(&zone_cache_lock);
+    int slot = find_zone_cache_slot(stream_name);
+    if (slot >= 0 && zone_cache[slot]->generation == generation) {
+        return zone_cache[slot];
     }
+    pthread_rwlock_unlock(&zone_cache_lock);
 
-    return false;
+    // Compile outside the lock so other streams keep filtering meanwhile
+    zone_cache_entry_t *fresh = compile_zone_cache_entry(stream_name, generation);
+    if (!fresh) {
+        return NULL;
+    }
+
+    pthread_rwlock_wrlock(&zone_cache_lock);
+    slot = find_zone_cache_slot(stream_name);
+    if (slot < 0) {
+        for (int i = 0; i < MAX_STREAMS && slot < 0; i++) {
+            if (!zone_cache[i]) slot = i;
+        }
+    }
+    if (slot < 0) {
+        // Only reachable with stale entries for removed streams
+        slot = zone_cache_next_evict;
+        zone_cache_next_evict = (zone_cache_next_evict + 1) % MAX_STREAMS;
+    }
+    free(zone_cache[slot]);
+    zone_cache[slot] = fresh;
+    pthread_rwlock_unlock(&zone_cache_lock);
+
+    // Re-take as a reader; another thread may have installed an even newer copy
+    pthread_rwlock_rdlock(&zone_cache_lock);
+    slot = find_zone_cache_slot(stream_name);
+    if (slot < 0) {
+        pthread_rwlock_unlock(&zone_cache_lock);
+        return NULL;
+    }
+    return zone_cache[slot];
+}
+
+static void release_zone_cache(void) {
+    pthread_rwlock_unlock(&zone_cache_lock);
 }
 
 /**
- * Check if a detection meets the zone's confidence threshold
+ * Index of the first enabled zone (in zone order) that contains the point,
+ * restricted to zones in candidate_mask; -1 if none.
  */
-static bool detection_meets_confidence(const detection_t *detection, const detection_zone_t *zone) {
-    // If no minimum confidence is set (0.0), accept all
-    if (zone->min_confidence <= 0.0f) {
+static int compiled_zones_first_hit(const zone_cache_entry_t *entry, float x, float y,
+                                    uint16_t candidate_mask) {
+    uint16_t inside = 0;
+    uint16_t edge = (uint16_t)((1u << entry->enabled_count) - 1);
+
+    // Points outside the frame are not covered by the raster
+    if (x >= 0.0f && x < 1.0f && y >= 0.0f && y < 1.0f) {
+        int idx = (int)(y * ZONE_RASTER_SIZE) * ZONE_RASTER_SIZE + (int)(x * ZONE_RASTER_SIZE);
+        inside = entry->inside_bits[idx];
+        edge = entry->edge_bits[idx];
+    }
+
+    uint16_t candidates = (inside | edge) & candidate_mask;
+    while (candidates) {
+        int k = __builtin_ctz(candidates);
+        uint16_t bit = (uint16_t)(1u << k);
+        if ((inside & bit) || compiled_zone_contains(&entry->compiled[k], x, y)) {
+            return k;
+        }
+        candidates &= (uint16_t)~bit;
+    }
+    return -1;
+}
+
+static bool compiled_zone_class_matches(const compiled_zone_t *cz, const char *label) {
+    if (!cz->has_class_filter) {
         return true;
     }
+    for (int i = 0; i < cz->class_count; i++) {
+        if (strcmp(cz->classes[i], label) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
 
-    return detection->confidence >= zone->min_confidence;
+/**
+ * Drop compiled zones so the next filter call reloads them from the database
+ */
+void invalidate_zone_filter_cache(const char *stream_name) {
+    pthread_rwlock_wrlock(&zone_cache_lock);
+    for (int i = 0; i < MAX_STREAMS; i++) {
+        if (zone_cache[i] &&
+            (!stream_name || strcmp(zone_cache[i]->stream_name, stream_name) == 0)) {
+            free(zone_cache[i]);
+            zone_cache[i] = NULL;
+        }
+    }
+    pthread_rwlock_unlock(&zone_cache_lock);
 }
 
 /**
@@ -108,31 +350,24 @@ int filter_detections_by_zones(const char *stream_name, detection_result_t *resu
         return 0;
     }
 
-    // Get zones for this stream
-    detection_zone_t zones[MAX_ZONES_PER_STREAM];
-    int zone_count = get_detection_zones(stream_name, zones, MAX_ZONES_PER_STREAM);
-
-    if (zone_count < 0) {
+    // Get compiled zones for this stream (no database access unless zones changed)
+    const zone_cache_entry_t *entry = acquire_zone_cache(stream_name);
+    if (!entry) {
         log_error("Failed to get detection zones for stream %s", stream_name);
         return -1;
     }
 
     // If no zones are configured, don't filter (allow all detections)
-    if (zone_count == 0) {
+    if (entry->zone_count == 0) {
+        release_zone_cache();
         log_debug("No zones configured for stream %s, allowing all detections", stream_name);
         return 0;
     }
 
-    // Count enabled zones
-    int enabled_zone_count = 0;
-    for (int i = 0; i < zone_count; i++) {
-        if (zones[i].enabled) {
-            enabled_zone_count++;
-        }
-    }
-
     // If no enabled zones, don't filter (allow all detections)
+    int enabled_zone_count = entry->enabled_count;
     if (enabled_zone_count == 0) {
+        release_zone_cache();
         log_debug("No enabled zones for stream %s, allowing all detections", stream_name);
         return 0;
     }
@@ -150,21 +385,19 @@ int filter_detections_by_zones(const char *stream_name, detection_result_t *resu
         bool detection_accepted = false;
         const char *matched_zone_id = NULL;
 
-        // Check if detection is in any enabled zone
-        for (int j = 0; j < zone_count; j++) {
-            detection_zone_t *zone = &zones[j];
-
-            if (!zone->enabled) {
-                continue;
-            }
-
-            // Check if detection is in this zone
-            if (!detection_in_zone(det, zone)) {
-                continue;
-            }
+        // Zones are tried in order; a zone that contains the center but
+        // rejects the class or confidence passes the detection on to the next.
+        float center_x = det->x + (det->width / 2.0f);
+        float center_y = det->y + (det->height / 2.0f);
+        uint16_t remaining = (uint16_t)((1u << enabled_zone_count) - 1);
+        int k;
+        while ((k = compiled_zones_first_hit(entry, center_x, center_y, remaining)) >= 0) {
+            const compiled_zone_t *cz = &entry->compiled[k];
+            const detection_zone_t *zone = cz->src;
+            remaining &= (uint16_t)~(1u << k);
 
             // Check if detection class matches zone filter
-            if (!detection_class_matches(det, zone)) {
+            if (!compiled_zone_class_matches(cz, det->label)) {
                 log_debug("Detection %s rejected by zone %s (class filter)",
                          det->label, zone->name);
                 continue;
@@ -198,11 +431,12 @@ int filter_detections_by_zones(const char *stream_name, detection_result_t *resu
             filtered.count++;
         } else {
             log_debug("Detection %s (%.2f%%) at [%.2f, %.2f] rejected (not in any enabled zone)",
-                     det->label, det->confidence * 100.0f,
-                     det->x + det->width / 2.0f, det->y + det->height / 2.0f);
+                     det->label, det->confidence * 100.0f, center_x, center_y);
         }
     }
 
+    release_zone_cache();
+
     log_info("Zone filtering: %d detections -> %d detections (filtered out %d)",
              result->count, filtered.count, result->count - filtered.count);
 
@@ -333,11 +567,10 @@ int build_motion_zone_mask(const char *stream_name, int grid_size, bool *zone_ma
 
     int total_cells = grid_size * grid_size;
 
-    // Get zones for this stream
-    detection_zone_t zones[MAX_ZONES_PER_STREAM];
-    int zone_count = get_detection_zones(stream_name, zones, MAX_ZONES_PER_STREAM);
+    // Get compiled zones for this stream
+    const zone_cache_entry_t *entry = acquire_zone_cache(stream_name);
 
-    if (zone_count < 0) {
+    if (!entry) {
         log_error("Failed to get detection zones for stream %s", stream_name);
         // On error, allow all cells (don't block motion detection)
         for (int i = 0; i < total_cells; i++) {
@@ -346,16 +579,10 @@ int build_motion_zone_mask(const char *stream_name, int grid_size, bool *zone_ma
         return -1;
     }
 
-    // Count enabled zones
-    int enabled_zone_count = 0;
-    for (int i = 0; i < zone_count; i++) {
-        if (zones[i].enabled) {
-            enabled_zone_count++;
-        }
-    }
-
     // If no zones configured or none enabled, all cells are active
-    if (zone_count == 0 || enabled_zone_count == 0) {
+    int enabled_zone_count = entry->enabled_count;
+    if (enabled_zone_count == 0) {
+        release_zone_cache();
         for (int i = 0; i < total_cells; i++) {
             zone_mask[i] = true;
         }
@@ -363,28 +590,57 @@ int build_motion_zone_mask(const char *stream_name, int grid_size, bool *zone_ma
     }
 
     // For each grid cell, check if its center is inside any enabled zone
+    uint16_t all_zones = (uint16_t)((1u << enabled_zone_count) - 1);
+    int active_cells = 0;
     for (int gy = 0; gy < grid_size; gy++) {
         for (int gx = 0; gx < grid_size; gx++) {
             // Compute normalized center of this cell (0.0 - 1.0)
             float center_x = ((float)gx + 0.5f) / (float)grid_size;
             float center_y = ((float)gy + 0.5f) / (float)grid_size;
 
-            bool in_any_zone = false;
-            for (int z = 0; z < zone_count; z++) {
-                if (!zones[z].enabled) continue;
-                if (point_in_polygon(center_x, center_y,
-                                     zones[z].polygon, zones[z].polygon_count)) {
-                    in_any_zone = true;
-                    break;
-                }
-            }
-
+            bool in_any_zone = compiled_zones_first_hit(entry, center_x, center_y, all_zones) >= 0;
             zone_mask[gy * grid_size + gx] = in_any_zone;
+            if (in_any_zone) active_cells++;
         }
     }
+    release_zone_cache();
 
     log_debug("Built zone mask for stream %s: %d/%d cells active (%d enabled zones)",
-              stream_name, enabled_zone_count, total_cells, enabled_zone_count);
+              stream_name, active_cells, total_cells, enabled_zone_count);
 
     return enabled_zone_count;
-}
\ No newline at end of file
+}
+
+/**
+ * Get the bounding boxes of a stream's enabled zones
+ */
+int get_zone_bounding_boxes(const char *stream_name, detection_result_t *boxes) {
+    if (!stream_name || !boxes) {
+        return -1;
+    }
+    memset(boxes, 0, sizeof(*boxes));
+
+    const zone_cache_entry_t *entry = acquire_zone_cache(stream_name);
+    if (!entry) {
+        log_error("Failed to get detection zones for stream %s", stream_name);
+        return -1;
+    }
+
+    for (int k = 0; k < entry->enabled_count && boxes->count < MAX_DETECTIONS; k++) {
+        const compiled_zone_t *cz = &entry->compiled[k];
+        if (cz->edge_count == 0) {
+            continue;
+        }
+        detection_t *box = &boxes->detections[boxes->count++];
+        safe_strcpy(box->label, "zone", sizeof(box->label), 0);
+        safe_strcpy(box->zone_id, cz->src->id, sizeof(box->zone_id), 0);
+        box->confidence = 1.0f;
+        box->x = cz->min_x;
+        box->y = cz->min_y;
+        box->width = cz->max_x - cz->min_x;
+        box->height = cz->max_y - cz->min_y;
+    }
+    release_zone_cache();
+
+    return boxes->count;
+}
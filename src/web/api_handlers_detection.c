@@ -206,3 +206,144 @@ void handle_get_detection_results(const http_request_t *req, http_response_t *re
     log_info("Successfully handled GET /api/detection/results/%s request, returned %d detections",
              stream_name, result.count);
 }
+
+// Bucket limits for GET /api/detection/rollups. "auto" uses minute buckets
+// while the range fits in DENSITY_AUTO_MINUTE_BUCKETS of them, else hours.
+#define DENSITY_MAX_BUCKETS 10080
+#define DENSITY_AUTO_MINUTE_BUCKETS 1440
+
+/**
+ * @brief Handler for GET /api/detection/rollups/:stream
+ *
+ * Detection density per minute or hour and a label histogram for a time
+ * range, read from the detection rollups. Query parameters: start and end
+ * (Unix seconds, default the last 24 hours), bucket (minute, hour or auto)
+ * and label (count only this label).
+ */
+void handle_get_detection_rollups(const http_request_t *req, http_response_t *res) {
+    char stream_name[MAX_STREAM_NAME];
+    if (http_request_extract_path_param(req, "/api/detection/rollups/", stream_name, sizeof(stream_name)) != 0) {
+        log_error("Failed to extract stream name from URL");
+        http_response_set_json_error(res, 400, "Invalid request path");
+        return;
+    }
+
+    time_t end_time = time(NULL);
+    time_t start_time = 0;
+    char param[64] = {0};
+    if (http_request_get_query_param(req, "end", param, sizeof(param)) > 0 && param[0]) {
+        end_time = (time_t)strtoll(param, NULL, 10);
+    }
+    param[0] = '\0';
+    if (http_request_get_query_param(req, "start", param, sizeof(param)) > 0 && param[0]) {
+        start_time = (time_t)strtoll(param, NULL, 10);
+    } else {
+        start_time = end_time - (time_t)24 * 60 * 60;
+    }
+    if (start_time > end_time) {
+        http_response_set_json_error(res, 400, "start must not be after end");
+        return;
+    }
+
+    int bucket_seconds = 0;
+    char bucket[16] = {0};
+    http_request_get_query_param(req, "bucket", bucket, sizeof(bucket));
+    if (strcmp(bucket, "minute") == 0) {
+        bucket_seconds = DETECTION_ROLLUP_MINUTE;
+    } else if (strcmp(bucket, "hour") == 0) {
+        bucket_seconds = DETECTION_ROLLUP_HOUR;
+    } else if (bucket[0] == '\0' || strcmp(bucket, "auto") == 0) {
+        bucket_seconds = (end_time - start_time) / DETECTION_ROLLUP_MINUTE < DENSITY_AUTO_MINUTE_BUCKETS
+            ? DETECTION_ROLLUP_MINUTE : DETECTION_ROLLUP_HOUR;
+    } else {
+        http_response_set_json_error(res, 400, "bucket must be minute, hour or auto");
+        return;
+    }
+
+    if ((end_time - start_time) / bucket_seconds >= DENSITY_MAX_BUCKETS) {
+        http_response_set_json_error(res, 400, "Time range too long for the bucket size");
+        return;
+    }
+
+    char label[MAX_LABEL_LENGTH] = {0};
+    http_request_get_query_param(req, "label", label, sizeof(label));
+
+    detection_bucket_t *buckets = malloc(DENSITY_MAX_BUCKETS * sizeof(detection_bucket_t));
+    if (!buckets) {
+        log_error("Failed to allocate memory for detection buckets");
+        http_response_set_json_error(res, 500, "Failed to allocate memory");
+        return;
+    }
+
+    int bucket_count = get_detection_density(stream_name, start_time, end_time, bucket_seconds,
+                                             label[0] ? label : NULL, buckets, DENSITY_MAX_BUCKETS);
+    detection_label_summary_t labels[MAX_UNIQUE_DETECTION_LABELS];
+    int label_count = get_detection_labels_summary(stream_name, start_time, end_time,
+                                                   labels, MAX_UNIQUE_DETECTION_LABELS);
+    if (bucket_count < 0 || label_count < 0) {
+        log_error("Failed to get detection rollups for stream: %s", stream_name);
+        free(buckets);
+        http_response_set_json_error(res, 500, "Failed to get detection rollups");
+        return;
+    }
+
+    cJSON *response = cJSON_CreateObject();
+    cJSON *buckets_array = cJSON_CreateArray();
+    cJSON *labels_array = cJSON_CreateArray();
+    if (!response || !buckets_array || !labels_array) {
+        log_error("Failed to create response JSON");
+        cJSON_Delete(response);
+        cJSON_Delete(buckets_array);
+        cJSON_Delete(labels_array);
+        free(buckets);
+        http_response_set_json_error(res, 500, "Failed to create response JSON");
+        return;
+    }
+
+    cJSON_AddStringToObject(response, "stream", stream_name);
+    cJSON_AddNumberToObject(response, "start", (double)start_time);
+    cJSON_AddNumberToObject(response, "end", (double)end_time);
+    cJSON_AddNumberToObject(response, "bucket_seconds", bucket_seconds);
+    cJSON_AddItemToObject(response, "buckets", buckets_array);
+    cJSON_AddItemToObject(response, "labels", labels_array);
+
+    for (int i = 0; i < bucket_count; i++) {
+        cJSON *item = cJSON_CreateObject();
+        if (!item) {
+            continue;
+        }
+        cJSON_AddNumberToObject(item, "start", (double)buckets[i].bucket_start);
+        cJSON_AddNumberToObject(item, "count", buckets[i].count);
+        cJSON_AddNumberToObject(item, "max_confidence", buckets[i].max_confidence);
+        cJSON_AddItemToArray(buckets_array, item);
+    }
+    free(buckets);
+
+    for (int i = 0; i < label_count; i++) {
+        if (label[0] && strcmp(labels[i].label, label) != 0) {
+            continue;
+        }
+        cJSON *item = cJSON_CreateObject();
+        if (!item) {
+            continue;
+        }
+        cJSON_AddStringToObject(item, "label", labels[i].label);
+        cJSON_AddNumberToObject(item, "count", labels[i].count);
+        cJSON_AddNumberToObject(item, "max_confidence", labels[i].max_confidence);
+        cJSON_AddItemToArray(labels_array, item);
+    }
+
+    char *json_str = cJSON_PrintUnformatted(response);
+    cJSON_Delete(response);
+    if (!json_str) {
+        log_error("Failed to convert response JSON to string");
+        http_response_set_json_error(res, 500, "Failed to convert response JSON to string");
+        return;
+    }
+
+    http_response_set_json(res, 200, json_str);
+    free(json_str);
+
+    log_debug("Returned %d detection buckets and %d labels for stream %s",
+              bucket_count, label_count, stream_name);
+}
@@ -115,6 +115,25 @@ void handle_get_detection_models(const http_request_t *req, http_response_t *res
         log_error("Failed to create ONVIF model JSON object");
     }
 
+    // Add the local frame bus detector when the bus is enabled
+    if (config->frame_bus_enabled) {
+        cJSON *bus_model = cJSON_CreateObject();
+        if (bus_model) {
+            cJSON_AddStringToObject(bus_model, "id", "frame-bus");
+            cJSON_AddStringToObject(bus_model, "name", "Local Detector (frame bus)");
+            cJSON_AddStringToObject(bus_model, "path", "frame-bus");
+            cJSON_AddStringToObject(bus_model, "type", "builtin");
+            cJSON_AddBoolToObject(bus_model, "supported", true);
+            cJSON_AddStringToObject(bus_model, "description",
+                                    "Detector on this host reading frames from shared memory");
+
+            cJSON_AddItemToArray(models_array, bus_model);
+            model_count++;
+        } else {
+            log_error("Failed to create frame bus model JSON object");
+        }
+    }
+
     // Check if models directory exists
     DIR *dir = opendir(models_dir);
     if (!dir) {
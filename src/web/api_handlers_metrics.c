@@ -19,6 +19,16 @@
 #include "telemetry/player_telemetry.h"
 #include "video/stream_manager.h"
 #include "storage/storage_manager.h"
+#include "storage/storage_cleanup_pool.h"
+#include "video/api_detection_client.h"
+#include "video/detection_cascade.h"
+#include "video/model_registry.h"
+#include "video/sod_batch.h"
+#include "video/snapshot_cache.h"
+#include "video/unified_detection_thread.h"
+#include "database/db_core.h"
+#include "database/db_write_queue.h"
+#include "database/db_auth_cache.h"
 #define LOG_COMPONENT "MetricsAPI"
 #include "core/logger.h"
 #include "core/config.h"
@@ -248,6 +258,246 @@ void handle_get_metrics(const http_request_t *req, http_response_t *res) {
     prom_buf_append(&buf, "# TYPE lightnvr_storage_available_bytes gauge\n");
     prom_buf_append(&buf, "lightnvr_storage_available_bytes %.0f\n", (double)storage_health.free_space_bytes);
 
+    /* --- Detection API request latency (per backend) --- */
+    api_detection_latency_t latency[API_DETECTION_LATENCY_MAX_BACKENDS];
+    int backends = api_detection_client_get_latency_stats(latency, API_DETECTION_LATENCY_MAX_BACKENDS);
+    prom_buf_append(&buf, "# HELP lightnvr_api_detection_request_duration_seconds Detection API request latency\n");
+    prom_buf_append(&buf, "# TYPE lightnvr_api_detection_request_duration_seconds histogram\n");
+    for (int i = 0; i < backends; i++) {
+        uint64_t cumulative = 0;
+        for (int b = 0; b < API_DETECTION_LATENCY_BUCKETS; b++) {
+            cumulative += latency[i].buckets[b];
+            double bound_ms = api_detection_latency_bucket_bound_ms(b);
+            if (bound_ms < 0.0) {
+                prom_buf_append(&buf, "lightnvr_api_detection_request_duration_seconds_bucket{backend=\"%s\",le=\"+Inf\"} %llu\n",
+                                latency[i].backend, (unsigned long long)cumulative);
+            } else {
+                prom_buf_append(&buf, "lightnvr_api_detection_request_duration_seconds_bucket{backend=\"%s\",le=\"%g\"} %llu\n",
+                                latency[i].backend, bound_ms / 1000.0, (unsigned long long)cumulative);
+            }
+        }
+        prom_buf_append(&buf, "lightnvr_api_detection_request_duration_seconds_sum{backend=\"%s\"} %.3f\n",
+                        latency[i].backend, latency[i].sum_ms / 1000.0);
+        prom_buf_append(&buf, "lightnvr_api_detection_request_duration_seconds_count{backend=\"%s\"} %llu\n",
+                        latency[i].backend, (unsigned long long)latency[i].count);
+    }
+    prom_buf_append(&buf, "# HELP lightnvr_api_detection_request_errors_total Failed detection API requests\n");
+    prom_buf_append(&buf, "# TYPE lightnvr_api_detection_request_errors_total counter\n");
+    for (int i = 0; i < backends; i++) {
+        prom_buf_append(&buf, "lightnvr_api_detection_request_errors_total{backend=\"%s\"} %llu\n",
+                        latency[i].backend, (unsigned long long)latency[i].errors);
+    }
+
+    /* --- Detection interval (per stream, stretched by the adaptive rate) --- */
+    prom_buf_append(&buf, "# HELP lightnvr_detection_interval_seconds Seconds between detection checks\n");
+    prom_buf_append(&buf, "# TYPE lightnvr_detection_interval_seconds gauge\n");
+    for (int i = 0; i < count; i++) {
+        int configured = 0;
+        int effective = 0;
+        if (get_unified_detection_stats(snaps[i].stream_name, NULL, NULL, NULL, &configured, &effective) != 0)
+            continue;
+        prom_buf_append(&buf, "lightnvr_detection_interval_seconds{stream=\"%s\",kind=\"configured\"} %d\n",
+                        snaps[i].stream_name, configured);
+        prom_buf_append(&buf, "lightnvr_detection_interval_seconds{stream=\"%s\",kind=\"effective\"} %d\n",
+                        snaps[i].stream_name, effective);
+    }
+
+    /* --- Detection cascade stages (per stream) --- */
+    cascade_stage_stats_t (*stages)[DETECTION_CASCADE_MAX_STAGES] =
+        calloc((size_t)(count > 0 ? count : 1), sizeof(*stages));
+    int *stage_counts = calloc((size_t)(count > 0 ? count : 1), sizeof(int));
+    if (stages && stage_counts) {
+        for (int i = 0; i < count; i++)
+            stage_counts[i] = detection_cascade_get_stats(snaps[i].stream_name, stages[i], DETECTION_CASCADE_MAX_STAGES);
+
+        prom_buf_append(&buf, "# HELP lightnvr_detection_cascade_stage_runs_total Frames analyzed by a cascade stage\n");
+        prom_buf_append(&buf, "# TYPE lightnvr_detection_cascade_stage_runs_total counter\n");
+        for (int i = 0; i < count; i++)
+            for (int s = 0; s < stage_counts[i]; s++)
+                prom_buf_append(&buf, "lightnvr_detection_cascade_stage_runs_total{stream=\"%s\",stage=\"%s\"} %llu\n",
+                                snaps[i].stream_name, stages[i][s].name, (unsigned long long)stages[i][s].runs);
+
+        prom_buf_append(&buf, "# HELP lightnvr_detection_cascade_stage_hits_total Frames on which a cascade stage fired\n");
+        prom_buf_append(&buf, "# TYPE lightnvr_detection_cascade_stage_hits_total counter\n");
+        for (int i = 0; i < count; i++)
+            for (int s = 0; s < stage_counts[i]; s++)
+                prom_buf_append(&buf, "lightnvr_detection_cascade_stage_hits_total{stream=\"%s\",stage=\"%s\"} %llu\n",
+                                snaps[i].stream_name, stages[i][s].name, (unsigned long long)stages[i][s].hits);
+
+        prom_buf_append(&buf, "# HELP lightnvr_detection_cascade_stage_seconds_total Time spent in a cascade stage\n");
+        prom_buf_append(&buf, "# TYPE lightnvr_detection_cascade_stage_seconds_total counter\n");
+        for (int i = 0; i < count; i++)
+            for (int s = 0; s < stage_counts[i]; s++)
+                prom_buf_append(&buf, "lightnvr_detection_cascade_stage_seconds_total{stream=\"%s\",stage=\"%s\"} %.6f\n",
+                                snaps[i].stream_name, stages[i][s].name, (double)stages[i][s].total_us / 1e6);
+    }
+    free(stages);
+    free(stage_counts);
+
+    /* --- Shared detection models --- */
+    model_registry_stats_t models[MODEL_REGISTRY_MAX_ENTRIES];
+    int model_count = model_registry_get_stats(models, MODEL_REGISTRY_MAX_ENTRIES);
+    if (model_count > 0) {
+        prom_buf_append(&buf, "# HELP lightnvr_detection_model_handles Detection handles sharing a loaded model\n");
+        prom_buf_append(&buf, "# TYPE lightnvr_detection_model_handles gauge\n");
+        for (int i = 0; i < model_count; i++)
+            prom_buf_append(&buf, "lightnvr_detection_model_handles{model=\"%s\",threshold=\"%.2f\"} %d\n",
+                            models[i].path, models[i].threshold, models[i].handles);
+        prom_buf_append(&buf, "# HELP lightnvr_detection_model_versions Loaded versions of a model (more than 1 while streams switch)\n");
+        prom_buf_append(&buf, "# TYPE lightnvr_detection_model_versions gauge\n");
+        for (int i = 0; i < model_count; i++)
+            prom_buf_append(&buf, "lightnvr_detection_model_versions{model=\"%s\",threshold=\"%.2f\"} %d\n",
+                            models[i].path, models[i].threshold, models[i].versions);
+        prom_buf_append(&buf, "# HELP lightnvr_detection_model_reloads_total Hot reloads of a changed model file\n");
+        prom_buf_append(&buf, "# TYPE lightnvr_detection_model_reloads_total counter\n");
+        for (int i = 0; i < model_count; i++)
+            prom_buf_append(&buf, "lightnvr_detection_model_reloads_total{model=\"%s\",threshold=\"%.2f\"} %llu\n",
+                            models[i].path, models[i].threshold, (unsigned long long)models[i].reloads);
+        prom_buf_append(&buf, "# HELP lightnvr_detection_model_reload_failures_total Changed model files that failed to load\n");
+        prom_buf_append(&buf, "# TYPE lightnvr_detection_model_reload_failures_total counter\n");
+        for (int i = 0; i < model_count; i++)
+            prom_buf_append(&buf, "lightnvr_detection_model_reload_failures_total{model=\"%s\",threshold=\"%.2f\"} %llu\n",
+                            models[i].path, models[i].threshold, (unsigned long long)models[i].reload_failures);
+    }
+
+    /* --- Cross-stream SOD batching --- */
+    uint64_t batch_frames = 0, batch_passes = 0;
+    sod_batch_get_stats(&batch_frames, &batch_passes);
+    prom_buf_append(&buf, "# HELP lightnvr_sod_batch_frames_total Frames run through the shared SOD batch workers\n");
+    prom_buf_append(&buf, "# TYPE lightnvr_sod_batch_frames_total counter\n");
+    prom_buf_append(&buf, "lightnvr_sod_batch_frames_total %llu\n", (unsigned long long)batch_frames);
+    prom_buf_append(&buf, "# HELP lightnvr_sod_batch_passes_total Batched SOD forward passes (frames / passes is the mean batch size)\n");
+    prom_buf_append(&buf, "# TYPE lightnvr_sod_batch_passes_total counter\n");
+    prom_buf_append(&buf, "lightnvr_sod_batch_passes_total %llu\n", (unsigned long long)batch_passes);
+
+    /* --- Snapshot cache --- */
+    snapshot_cache_stats_t snap_stats;
+    snapshot_cache_get_stats(&snap_stats);
+    prom_buf_append(&buf, "# HELP lightnvr_snapshot_requests_total Snapshot requests by how they were served\n");
+    prom_buf_append(&buf, "# TYPE lightnvr_snapshot_requests_total counter\n");
+    prom_buf_append(&buf, "lightnvr_snapshot_requests_total{result=\"hit\"} %llu\n", (unsigned long long)snap_stats.hits);
+    prom_buf_append(&buf, "lightnvr_snapshot_requests_total{result=\"coalesced\"} %llu\n", (unsigned long long)snap_stats.coalesced);
+    prom_buf_append(&buf, "lightnvr_snapshot_requests_total{result=\"fetch\"} %llu\n", (unsigned long long)snap_stats.fetches);
+    prom_buf_append(&buf, "lightnvr_snapshot_requests_total{result=\"failure\"} %llu\n", (unsigned long long)snap_stats.fetch_failures);
+    prom_buf_append(&buf, "# HELP lightnvr_snapshot_stored_total Snapshots stored from locally encoded frames\n");
+    prom_buf_append(&buf, "# TYPE lightnvr_snapshot_stored_total counter\n");
+    prom_buf_append(&buf, "lightnvr_snapshot_stored_total %llu\n", (unsigned long long)snap_stats.stored);
+
+    /* ---- Prepared statement cache ---- */
+    db_stmt_cache_stats_t stmt_stats;
+    db_stmt_cache_get_stats(&stmt_stats);
+    prom_buf_append(&buf, "# HELP lightnvr_db_statements_prepared_total SQL statements compiled for the statement cache\n");
+    prom_buf_append(&buf, "# TYPE lightnvr_db_statements_prepared_total counter\n");
+    prom_buf_append(&buf, "lightnvr_db_statements_prepared_total %llu\n", (unsigned long long)stmt_stats.prepares);
+    prom_buf_append(&buf, "# HELP lightnvr_db_prepares_avoided_total Queries that reused a cached prepared statement\n");
+    prom_buf_append(&buf, "# TYPE lightnvr_db_prepares_avoided_total counter\n");
+    prom_buf_append(&buf, "lightnvr_db_prepares_avoided_total %llu\n", (unsigned long long)stmt_stats.reuses);
+    prom_buf_append(&buf, "# HELP lightnvr_db_statement_cache_invalidations_total Statement cache flushes after schema changes or restores\n");
+    prom_buf_append(&buf, "# TYPE lightnvr_db_statement_cache_invalidations_total counter\n");
+    prom_buf_append(&buf, "lightnvr_db_statement_cache_invalidations_total %llu\n", (unsigned long long)stmt_stats.invalidations);
+    prom_buf_append(&buf, "# HELP lightnvr_db_statements_cached Prepared statements held by the cache\n");
+    prom_buf_append(&buf, "# TYPE lightnvr_db_statements_cached gauge\n");
+    prom_buf_append(&buf, "lightnvr_db_statements_cached %d\n", stmt_stats.cached);
+
+    /* ---- Database connections ---- */
+    db_pool_stats_t pool_stats;
+    db_pool_get_stats(&pool_stats);
+    prom_buf_append(&buf, "# HELP lightnvr_db_lock_acquires_total Database connection acquisitions\n");
+    prom_buf_append(&buf, "# TYPE lightnvr_db_lock_acquires_total counter\n");
+    prom_buf_append(&buf, "lightnvr_db_lock_acquires_total{lock=\"writer\"} %llu\n", (unsigned long long)pool_stats.writer.acquires);
+    prom_buf_append(&buf, "lightnvr_db_lock_acquires_total{lock=\"reader\"} %llu\n", (unsigned long long)pool_stats.reader.acquires);
+    prom_buf_append(&buf, "# HELP lightnvr_db_lock_waits_total Acquisitions that had to wait for another thread\n");
+    prom_buf_append(&buf, "# TYPE lightnvr_db_lock_waits_total counter\n");
+    prom_buf_append(&buf, "lightnvr_db_lock_waits_total{lock=\"writer\"} %llu\n", (unsigned long long)pool_stats.writer.waits);
+    prom_buf_append(&buf, "lightnvr_db_lock_waits_total{lock=\"reader\"} %llu\n", (unsigned long long)pool_stats.reader.waits);
+    prom_buf_append(&buf, "# HELP lightnvr_db_lock_wait_seconds_total Time spent waiting for a database connection\n");
+    prom_buf_append(&buf, "# TYPE lightnvr_db_lock_wait_seconds_total counter\n");
+    prom_buf_append(&buf, "lightnvr_db_lock_wait_seconds_total{lock=\"writer\"} %.6f\n", pool_stats.writer.wait_us / 1e6);
+    prom_buf_append(&buf, "lightnvr_db_lock_wait_seconds_total{lock=\"reader\"} %.6f\n", pool_stats.reader.wait_us / 1e6);
+    prom_buf_append(&buf, "# HELP lightnvr_db_read_connections Read-only database connections\n");
+    prom_buf_append(&buf, "# TYPE lightnvr_db_read_connections gauge\n");
+    prom_buf_append(&buf, "lightnvr_db_read_connections{state=\"busy\"} %d\n", pool_stats.read_connections_busy);
+    prom_buf_append(&buf, "lightnvr_db_read_connections{state=\"idle\"} %d\n",
+                    pool_stats.read_connections - pool_stats.read_connections_busy);
+
+    /* ---- Database write queue ---- */
+    db_write_queue_stats_t wq_stats;
+    db_write_queue_get_stats(&wq_stats);
+    prom_buf_append(&buf, "# HELP lightnvr_db_write_queue_writes_total Queued database writes by outcome\n");
+    prom_buf_append(&buf, "# TYPE lightnvr_db_write_queue_writes_total counter\n");
+    prom_buf_append(&buf, "lightnvr_db_write_queue_writes_total{result=\"committed\"} %llu\n", (unsigned long long)wq_stats.committed);
+    prom_buf_append(&buf, "lightnvr_db_write_queue_writes_total{result=\"coalesced\"} %llu\n", (unsigned long long)wq_stats.coalesced);
+    prom_buf_append(&buf, "lightnvr_db_write_queue_writes_total{result=\"failed\"} %llu\n", (unsigned long long)wq_stats.failed);
+    prom_buf_append(&buf, "# HELP lightnvr_db_write_queue_batches_total Group commits of the write queue\n");
+    prom_buf_append(&buf, "# TYPE lightnvr_db_write_queue_batches_total counter\n");
+    prom_buf_append(&buf, "lightnvr_db_write_queue_batches_total %llu\n", (unsigned long long)wq_stats.batches);
+    prom_buf_append(&buf, "# HELP lightnvr_db_write_queue_commit_seconds_total Time spent in group commits\n");
+    prom_buf_append(&buf, "# TYPE lightnvr_db_write_queue_commit_seconds_total counter\n");
+    prom_buf_append(&buf, "lightnvr_db_write_queue_commit_seconds_total %.3f\n", wq_stats.commit_us / 1e6);
+    prom_buf_append(&buf, "# HELP lightnvr_db_write_queue_full_total Writes that waited for room in a full queue\n");
+    prom_buf_append(&buf, "# TYPE lightnvr_db_write_queue_full_total counter\n");
+    prom_buf_append(&buf, "lightnvr_db_write_queue_full_total %llu\n", (unsigned long long)wq_stats.overflows);
+    prom_buf_append(&buf, "# HELP lightnvr_db_write_queue_depth Writes waiting for a group commit\n");
+    prom_buf_append(&buf, "# TYPE lightnvr_db_write_queue_depth gauge\n");
+    prom_buf_append(&buf, "lightnvr_db_write_queue_depth %d\n", wq_stats.depth);
+
+    /* ---- WAL checkpoints and vacuum ---- */
+    db_maintenance_stats_t maint_stats;
+    db_maintenance_get_stats(&maint_stats);
+    prom_buf_append(&buf, "# HELP lightnvr_db_wal_bytes Size of the SQLite write-ahead log\n");
+    prom_buf_append(&buf, "# TYPE lightnvr_db_wal_bytes gauge\n");
+    prom_buf_append(&buf, "lightnvr_db_wal_bytes %lld\n", (long long)maint_stats.wal_bytes);
+    prom_buf_append(&buf, "# HELP lightnvr_db_checkpoints_total WAL checkpoints by mode\n");
+    prom_buf_append(&buf, "# TYPE lightnvr_db_checkpoints_total counter\n");
+    prom_buf_append(&buf, "lightnvr_db_checkpoints_total{mode=\"passive\"} %llu\n", (unsigned long long)maint_stats.passive);
+    prom_buf_append(&buf, "lightnvr_db_checkpoints_total{mode=\"truncate\"} %llu\n", (unsigned long long)maint_stats.truncate);
+    prom_buf_append(&buf, "lightnvr_db_checkpoints_total{mode=\"full\"} %llu\n", (unsigned long long)maint_stats.full);
+    prom_buf_append(&buf, "# HELP lightnvr_db_checkpoints_incomplete_total Checkpoints cut short by active readers or writers\n");
+    prom_buf_append(&buf, "# TYPE lightnvr_db_checkpoints_incomplete_total counter\n");
+    prom_buf_append(&buf, "lightnvr_db_checkpoints_incomplete_total %llu\n", (unsigned long long)maint_stats.busy);
+    prom_buf_append(&buf, "# HELP lightnvr_db_checkpoints_skipped_total Scheduled checkpoints skipped because of write load\n");
+    prom_buf_append(&buf, "# TYPE lightnvr_db_checkpoints_skipped_total counter\n");
+    prom_buf_append(&buf, "lightnvr_db_checkpoints_skipped_total %llu\n", (unsigned long long)maint_stats.skipped);
+    prom_buf_append(&buf, "# HELP lightnvr_db_checkpoint_seconds_total Time spent in WAL checkpoints\n");
+    prom_buf_append(&buf, "# TYPE lightnvr_db_checkpoint_seconds_total counter\n");
+    prom_buf_append(&buf, "lightnvr_db_checkpoint_seconds_total %.6f\n", maint_stats.duration_us / 1e6);
+    prom_buf_append(&buf, "# HELP lightnvr_db_checkpoint_last_seconds Duration of the most recent WAL checkpoint\n");
+    prom_buf_append(&buf, "# TYPE lightnvr_db_checkpoint_last_seconds gauge\n");
+    prom_buf_append(&buf, "lightnvr_db_checkpoint_last_seconds %.6f\n", maint_stats.last_duration_us / 1e6);
+    prom_buf_append(&buf, "# HELP lightnvr_db_vacuum_pages_total Free pages released by incremental vacuum\n");
+    prom_buf_append(&buf, "# TYPE lightnvr_db_vacuum_pages_total counter\n");
+    prom_buf_append(&buf, "lightnvr_db_vacuum_pages_total %llu\n", (unsigned long long)maint_stats.vacuum_pages);
+
+    /* ---- Retention cleanup ---- */
+    cleanup_pool_stats_t cp_stats;
+    cleanup_pool_get_stats(&cp_stats);
+    prom_buf_append(&buf, "# HELP lightnvr_storage_cleanup_files_total Recording files removed by retention cleanup\n");
+    prom_buf_append(&buf, "# TYPE lightnvr_storage_cleanup_files_total counter\n");
+    prom_buf_append(&buf, "lightnvr_storage_cleanup_files_total %llu\n", (unsigned long long)cp_stats.files_removed);
+    prom_buf_append(&buf, "# HELP lightnvr_storage_cleanup_freed_bytes_total Bytes freed by retention cleanup\n");
+    prom_buf_append(&buf, "# TYPE lightnvr_storage_cleanup_freed_bytes_total counter\n");
+    prom_buf_append(&buf, "lightnvr_storage_cleanup_freed_bytes_total %llu\n", (unsigned long long)cp_stats.bytes_freed);
+    prom_buf_append(&buf, "# HELP lightnvr_storage_cleanup_failures_total Recording files that could not be removed\n");
+    prom_buf_append(&buf, "# TYPE lightnvr_storage_cleanup_failures_total counter\n");
+    prom_buf_append(&buf, "lightnvr_storage_cleanup_failures_total %llu\n", (unsigned long long)cp_stats.failures);
+    prom_buf_append(&buf, "# HELP lightnvr_storage_cleanup_workers Running cleanup worker threads\n");
+    prom_buf_append(&buf, "# TYPE lightnvr_storage_cleanup_workers gauge\n");
+    prom_buf_append(&buf, "lightnvr_storage_cleanup_workers %d\n", cp_stats.workers);
+
+    /* ---- Authentication cache ---- */
+    auth_cache_stats_t ac_stats;
+    db_auth_cache_get_stats(&ac_stats);
+    prom_buf_append(&buf, "# HELP lightnvr_auth_cache_lookups_total Authentication cache lookups by result\n");
+    prom_buf_append(&buf, "# TYPE lightnvr_auth_cache_lookups_total counter\n");
+    prom_buf_append(&buf, "lightnvr_auth_cache_lookups_total{result=\"hit\"} %llu\n", (unsigned long long)ac_stats.hits);
+    prom_buf_append(&buf, "lightnvr_auth_cache_lookups_total{result=\"miss\"} %llu\n", (unsigned long long)ac_stats.misses);
+    prom_buf_append(&buf, "# HELP lightnvr_auth_cache_invalidations_total Cached credentials dropped after a user, password or session change\n");
+    prom_buf_append(&buf, "# TYPE lightnvr_auth_cache_invalidations_total counter\n");
+    prom_buf_append(&buf, "lightnvr_auth_cache_invalidations_total %llu\n", (unsigned long long)ac_stats.invalidations);
+    prom_buf_append(&buf, "# HELP lightnvr_auth_cache_entries Cached credentials, sessions and API keys\n");
+    prom_buf_append(&buf, "# TYPE lightnvr_auth_cache_entries gauge\n");
+    prom_buf_append(&buf, "lightnvr_auth_cache_entries %d\n", ac_stats.entries);
+
     /* --- Instance-level metrics --- */
     prom_buf_append(&buf, "# HELP lightnvr_instance_streams_configured Number of streams configured\n");
     prom_buf_append(&buf, "# TYPE lightnvr_instance_streams_configured gauge\n");
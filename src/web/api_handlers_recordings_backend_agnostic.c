@@ -126,23 +126,18 @@ void handle_get_recording(const http_request_t *req, http_response_t *res) {
     detection_label_summary_t labels[MAX_DETECTION_LABELS];
     int label_count = 0;
 
-    if (recording.start_time > 0 && recording.end_time > 0) {
-        // Get detection labels summary for this recording's time range
+    if (recording.is_complete) {
+        // Detection labels come from the summary maintained for each recording
+        label_count = get_recording_detection_labels(recording.id, labels, MAX_DETECTION_LABELS);
+    } else if (recording.start_time > 0 && recording.end_time > 0) {
+        // The summary of a recording in progress is finished when it completes
         label_count = get_detection_labels_summary(recording.stream_name,
                                                    recording.start_time,
                                                    recording.end_time,
                                                    labels, MAX_DETECTION_LABELS);
-        if (label_count > 0) {
-            has_detection_flag = true;
-        } else if (!has_detection_flag) {
-            // Fall back to simple check if get_detection_labels_summary returned 0
-            int det_result = has_detections_in_time_range(recording.stream_name,
-                                                          recording.start_time,
-                                                          recording.end_time);
-            if (det_result > 0) {
-                has_detection_flag = true;
-            }
-        }
+    }
+    if (label_count > 0) {
+        has_detection_flag = true;
     }
     cJSON_AddBoolToObject(recording_obj, "has_detection", has_detection_flag);
     cJSON_AddBoolToObject(recording_obj, "protected", recording.protected);
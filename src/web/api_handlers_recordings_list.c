@@ -63,6 +63,9 @@ static int parse_selected_streams(const char *csv,
  * - start: Start time (ISO 8601 format)
  * - end: End time (ISO 8601 format)
  * - page: Page number (default: 1)
+ * - cursor: Keyset pagination; empty for the first page, then the next_cursor
+ *   of the previous response. Replaces page and skips the total count.
+ * - include_total: With cursor, also return the total count (1)
  * - limit: Results per page (default: 20, max: 1000)
  * - sort: Sort field (default: "start_time")
  * - order: Sort order "asc" or "desc" (default: "desc")
@@ -117,6 +120,8 @@ void handle_get_recordings(const http_request_t *req, http_response_t *res) {
     char protected_str[8] = {0};
     char tag_filter_str[512] = {0};
     char capture_method_str[128] = {0};
+    char cursor_str[RECORDING_CURSOR_TOKEN_SIZE] = {0};
+    char include_total_str[8] = {0};
 
     http_request_get_query_param(req, "stream", stream_name, sizeof(stream_name));
     http_request_get_query_param(req, "start", start_time_str, sizeof(start_time_str));
@@ -130,6 +135,8 @@ void handle_get_recordings(const http_request_t *req, http_response_t *res) {
     http_request_get_query_param(req, "protected", protected_str, sizeof(protected_str));
     http_request_get_query_param(req, "tag", tag_filter_str, sizeof(tag_filter_str));
     http_request_get_query_param(req, "capture_method", capture_method_str, sizeof(capture_method_str));
+    bool keyset = http_request_get_query_param(req, "cursor", cursor_str, sizeof(cursor_str)) >= 0;
+    http_request_get_query_param(req, "include_total", include_total_str, sizeof(include_total_str));
 
     // Parse numeric parameters
     int page = page_str[0] ? (int)strtol(page_str, NULL, 10) : 1;
@@ -153,6 +160,25 @@ void handle_get_recordings(const http_request_t *req, http_response_t *res) {
     // Calculate offset from page and limit
     int offset = (page - 1) * limit;
 
+    // Keyset pagination: the page starts after the cursor row instead of
+    // skipping offset rows, and the total is only counted on request
+    recording_cursor_t cursor;
+    bool have_cursor = false;
+    bool want_total = true;
+    if (keyset) {
+        if (cursor_str[0] != '\0') {
+            if (recording_cursor_decode(cursor_str, sort_field, sort_order, &cursor) != 0) {
+                http_response_set_json_error(res, 400, "Invalid cursor");
+                return;
+            }
+            have_cursor = true;
+        }
+        want_total = include_total_str[0] == '1' || strcasecmp(include_total_str, "true") == 0;
+        all_limit_requested = 0;
+        page = 1;
+        offset = 0;
+    }
+
     // Parse time strings to time_t
     time_t start_time = 0;
     time_t end_time = 0;
@@ -300,12 +326,15 @@ void handle_get_recordings(const http_request_t *req, http_response_t *res) {
 
     const char *tag_filt = tag_filter_str[0] != '\0' ? tag_filter_str : NULL;
 
-    int total_count = get_recording_count(start_time, end_time,
+    int total_count = 0;
+    if (want_total) {
+        total_count = get_recording_count(start_time, end_time,
                                           stream_name[0] != '\0' ? stream_name : NULL,
                                           has_detection, label_filter, protected_filter,
                                           streams_filter, streams_filter_count,
                                           tag_filt,
                                           capture_method_str[0] != '\0' ? capture_method_str : NULL);
+    }
 
     if (total_count < 0) {
         log_error("Failed to get total recording count from database");
@@ -320,8 +349,10 @@ void handle_get_recordings(const http_request_t *req, http_response_t *res) {
         offset = 0;
     }
 
-    // Allocate memory for recordings
-    recordings = (recording_metadata_t *)malloc(limit * sizeof(recording_metadata_t));
+    // Allocate memory for recordings; keyset pages fetch one extra row to
+    // tell whether there is a next page
+    int fetch_limit = keyset ? limit + 1 : limit;
+    recordings = (recording_metadata_t *)malloc(fetch_limit * sizeof(recording_metadata_t));
     if (!recordings) {
         log_error("Failed to allocate memory for recordings");
         if (all_stream_cfgs) free(all_stream_cfgs);
@@ -330,7 +361,19 @@ void handle_get_recordings(const http_request_t *req, http_response_t *res) {
     }
 
     // Get recordings with pagination
-    int count = get_recording_metadata_paginated(start_time, end_time,
+    int count;
+    if (keyset) {
+        count = get_recording_metadata_after(start_time, end_time,
+                                             stream_name[0] != '\0' ? stream_name : NULL,
+                                             has_detection, label_filter, protected_filter,
+                                             sort_field, sort_order,
+                                             have_cursor ? &cursor : NULL,
+                                             recordings, fetch_limit,
+                                             streams_filter, streams_filter_count,
+                                             tag_filt,
+                                             capture_method_str[0] != '\0' ? capture_method_str : NULL);
+    } else {
+        count = get_recording_metadata_paginated(start_time, end_time,
                                                  stream_name[0] != '\0' ? stream_name : NULL,
                                                  has_detection, label_filter, protected_filter,
                                                  sort_field, sort_order,
@@ -338,6 +381,7 @@ void handle_get_recordings(const http_request_t *req, http_response_t *res) {
                                                  streams_filter, streams_filter_count,
                                                  tag_filt,
                                                  capture_method_str[0] != '\0' ? capture_method_str : NULL);
+    }
 
     if (count < 0) {
         log_error("Failed to get recordings from database");
@@ -380,11 +424,30 @@ void handle_get_recordings(const http_request_t *req, http_response_t *res) {
     }
 
     // Add pagination info
-    int total_pages = (total_count + limit - 1) / limit; // Ceiling division
-    cJSON_AddNumberToObject(pagination, "page", page);
-    cJSON_AddNumberToObject(pagination, "pages", total_pages);
-    cJSON_AddNumberToObject(pagination, "total", total_count);
-    cJSON_AddNumberToObject(pagination, "limit", limit);
+    if (keyset) {
+        bool has_more = count > limit;
+        if (has_more) {
+            count = limit;
+        }
+        char next_cursor[RECORDING_CURSOR_TOKEN_SIZE];
+        if (has_more && recording_cursor_encode(&recordings[count - 1], sort_field, sort_order,
+                                                next_cursor, sizeof(next_cursor)) == 0) {
+            cJSON_AddStringToObject(pagination, "next_cursor", next_cursor);
+        } else {
+            cJSON_AddNullToObject(pagination, "next_cursor");
+        }
+        cJSON_AddBoolToObject(pagination, "has_more", has_more);
+        if (want_total) {
+            cJSON_AddNumberToObject(pagination, "total", total_count);
+        }
+        cJSON_AddNumberToObject(pagination, "limit", limit);
+    } else {
+        int total_pages = (total_count + limit - 1) / limit; // Ceiling division
+        cJSON_AddNumberToObject(pagination, "page", page);
+        cJSON_AddNumberToObject(pagination, "pages", total_pages);
+        cJSON_AddNumberToObject(pagination, "total", total_count);
+        cJSON_AddNumberToObject(pagination, "limit", limit);
+    }
 
     // Add pagination object to response
     cJSON_AddItemToObject(response, "pagination", pagination);
@@ -445,23 +508,10 @@ void handle_get_recordings(const http_request_t *req, http_response_t *res) {
         detection_label_summary_t labels[MAX_DETECTION_LABELS];
         int label_count = 0;
 
-        if (recordings[i].start_time > 0 && recordings[i].end_time > 0) {
-            // Get detection labels summary for this recording's time range
-            label_count = get_detection_labels_summary(recordings[i].stream_name,
-                                                       recordings[i].start_time,
-                                                       recordings[i].end_time,
-                                                       labels, MAX_DETECTION_LABELS);
-            if (label_count > 0) {
-                has_detection_flag = true;
-            } else if (!has_detection_flag) {
-                // Fall back to simple check if get_detection_labels_summary returned 0
-                int det_result = has_detections_in_time_range(recordings[i].stream_name,
-                                                              recordings[i].start_time,
-                                                              recordings[i].end_time);
-                if (det_result > 0) {
-                    has_detection_flag = true;
-                }
-            }
+        // Detection labels come from the summary maintained for each recording
+        label_count = get_recording_detection_labels(recordings[i].id, labels, MAX_DETECTION_LABELS);
+        if (label_count > 0) {
+            has_detection_flag = true;
         }
         cJSON_AddBoolToObject(recording, "has_detection", has_detection_flag);
         cJSON_AddBoolToObject(recording, "protected", recordings[i].protected);
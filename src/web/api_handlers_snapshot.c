@@ -0,0 +1,91 @@
+/**
+ * @file api_handlers_snapshot.c
+ * @brief Handler for live stream snapshots served from the snapshot cache
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "web/api_handlers.h"
+#include "web/request_response.h"
+#include "web/httpd_utils.h"
+#define LOG_COMPONENT "StreamsAPI"
+#include "core/logger.h"
+#include "core/config.h"
+#include "utils/strings.h"
+#include "video/stream_manager.h"
+#include "video/snapshot_cache.h"
+
+/**
+ * @brief Handler for GET /api/streams/:name/snapshot
+ *
+ * Returns the stream's current picture as a JPEG. The optional max_age_ms
+ * query parameter overrides [go2rtc] snapshot_max_age_ms for this request.
+ */
+void handle_get_stream_snapshot(const http_request_t *req, http_response_t *res) {
+    // Check authentication if enabled
+    if (g_config.web_auth_enabled) {
+        user_t user;
+        if (g_config.demo_mode) {
+            if (!httpd_check_viewer_access(req, &user)) {
+                http_response_set_json_error(res, 401, "Unauthorized");
+                return;
+            }
+        } else {
+            if (!httpd_get_authenticated_user(req, &user)) {
+                http_response_set_json_error(res, 401, "Unauthorized");
+                return;
+            }
+        }
+    }
+
+    // Extract stream name from URL
+    char stream_name[MAX_STREAM_NAME] = {0};
+    if (http_request_extract_path_param(req, "/api/streams/", stream_name, sizeof(stream_name)) != 0) {
+        http_response_set_json_error(res, 400, "Invalid stream name in URL");
+        return;
+    }
+
+    // Remove /snapshot suffix if present
+    char *suffix = strstr(stream_name, "/snapshot");
+    if (suffix) {
+        *suffix = '\0';
+    }
+
+    if (!get_stream_by_name(stream_name)) {
+        http_response_set_json_error(res, 404, "Stream not found");
+        return;
+    }
+
+    int max_age_ms = -1;
+    char param[32];
+    if (http_request_get_query_param(req, "max_age_ms", param, sizeof(param)) > 0) {
+        max_age_ms = atoi(param);
+    }
+
+    snapshot_t *snapshot = snapshot_cache_get(stream_name, max_age_ms);
+    if (!snapshot) {
+        log_warn("No snapshot available for stream %s", stream_name);
+        http_response_set_json_error(res, 503, "Snapshot not available");
+        return;
+    }
+
+    // The response owns its body, so copy the shared JPEG
+    void *body = malloc(snapshot->size);
+    if (!body) {
+        snapshot_release(snapshot);
+        http_response_set_json_error(res, 500, "Out of memory");
+        return;
+    }
+    memcpy(body, snapshot->data, snapshot->size);
+
+    res->status_code = 200;
+    safe_strcpy(res->content_type, "image/jpeg", sizeof(res->content_type), 0);
+    http_response_add_header(res, "Cache-Control", "no-cache");
+    res->body = body;
+    res->body_length = snapshot->size;
+    res->body_allocated = true;
+
+    snapshot_release(snapshot);
+}
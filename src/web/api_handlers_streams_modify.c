@@ -1571,6 +1571,7 @@ void handle_put_stream(const http_request_t *req, http_response_t *res) {
                         log_error("Failed to enable stream %s: %s", stream_id, sqlite3_errmsg(db));
                     } else {
                         log_info("Successfully enabled stream %s", stream_id);
+                        reload_stream_config(stream_id);
 
                         // Get the stream configuration to register with go2rtc
                         stream_config_t stream_config;
@@ -1628,6 +1629,7 @@ void handle_put_stream(const http_request_t *req, http_response_t *res) {
                     log_error("Failed to set privacy mode for stream %s: %s", stream_id, sqlite3_errmsg(db));
                 } else {
                     log_info("Successfully set privacy_mode=%d for stream %s", enable_privacy ? 1 : 0, stream_id);
+                    reload_stream_config(stream_id);
                     // If enabling privacy, stop stream processing; if disabling, restart it
                     if (enable_privacy) {
                         // Unregister from go2rtc so clients cannot connect
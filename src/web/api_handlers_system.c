@@ -1176,24 +1176,19 @@ void handle_get_system_info(const http_request_t *req, http_response_t *res) {
     // Create recordings object
     cJSON *recordings = cJSON_CreateObject();
     if (recordings) {
-        // Get recordings count from database using the db_recordings function
+        // Recording count and size come from the per-stream storage counters
+        // maintained in the DB. Avoids a full filesystem walk that could take
+        // many minutes on HDD deployments with hundreds of thousands of
+        // segments (#368), and a scan of the recordings table.
         int recording_count = 0;
-
-        // Use the get_recording_count function from db_recordings.h
-        // Parameters: start_time, end_time, stream_name, has_detection
-        // Pass 0 for start_time and end_time to get all recordings
-        // Pass NULL for stream_name to get recordings from all streams
-        // Pass 0 for has_detection to get all recordings regardless of detection status
-        recording_count = get_recording_count(0, 0, NULL, 0, NULL, -1, NULL, 0, NULL, NULL);
-        if (recording_count < 0) {
-            recording_count = 0; // Reset if query fails
+        int64_t recording_size_db = 0;
+        stream_storage_stats_t storage_stats;
+        if (get_stream_storage_stats(NULL, &storage_stats) == 0) {
+            recording_count = (int)storage_stats.recording_count;
+            recording_size_db = storage_stats.total_bytes;
+        } else {
             log_error("Failed to get recording count from database");
         }
-
-        // Recordings size comes from the DB (SUM of completed recording sizes).
-        // Avoids a full filesystem walk that could take many minutes on HDD
-        // deployments with hundreds of thousands of segments (#368).
-        int64_t recording_size_db = get_stream_storage_bytes(NULL);
         unsigned long long recording_size =
             (recording_size_db > 0) ? (unsigned long long)recording_size_db : 0;
 
@@ -55,15 +55,11 @@ int get_timeline_segments(const char *stream_name, time_t start_time, time_t end
         return -1;
     }
 
-    sqlite3 *db = get_db_handle();
-    pthread_mutex_t *db_mutex = get_db_mutex();
+    sqlite3 *db = db_reader_acquire();
     if (!db) {
-        log_error("Database not initialized");
         return -1;
     }
 
-    pthread_mutex_lock(db_mutex);
-
     /*
      * Use an overlap query so that recordings which span the boundary of the
      * requested range are included.  A recording overlaps [start_time, end_time]
@@ -75,13 +71,13 @@ int get_timeline_segments(const char *stream_name, time_t start_time, time_t end
      * whose end_time falls inside it (e.g. a recording from the previous day
      * that extends past midnight).
      *
-     * Also populate has_detection by checking trigger_type or the detections table.
+     * Also populate has_detection from trigger_type or the recording's
+     * maintained detection count.
      */
     const char *sql =
         "SELECT r.id, r.stream_name, r.file_path, r.start_time, r.end_time, "
         "r.size_bytes, "
-        "CASE WHEN r.trigger_type = 'detection' THEN 1 "
-        "     WHEN EXISTS (SELECT 1 FROM detections d WHERE d.recording_id = r.id) THEN 1 "
+        "CASE WHEN r.trigger_type = 'detection' OR r.detection_count > 0 THEN 1 "
         "     ELSE 0 END AS has_detection "
         "FROM recordings r "
         "WHERE r.is_complete = 1 "
@@ -92,11 +88,10 @@ int get_timeline_segments(const char *stream_name, time_t start_time, time_t end
         "ORDER BY r.start_time ASC "
         "LIMIT ?;";
 
-    sqlite3_stmt *stmt = NULL;
-    int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
-    if (rc != SQLITE_OK) {
-        log_error("Failed to prepare timeline segments query: %s", sqlite3_errmsg(db));
-        pthread_mutex_unlock(db_mutex);
+    sqlite3_stmt *stmt = db_prepare_cached_on(db, sql);
+    if (!stmt) {
+        log_error("Failed to prepare timeline segments query");
+        db_reader_release(db);
         return -1;
     }
 
@@ -123,8 +118,8 @@ int get_timeline_segments(const char *stream_name, time_t start_time, time_t end
         count++;
     }
 
-    sqlite3_finalize(stmt);
-    pthread_mutex_unlock(db_mutex);
+    db_release_cached(stmt);
+    db_reader_release(db);
 
     log_info("get_timeline_segments: found %d segments for stream '%s' in range [%ld, %ld]",
              count, stream_name, (long)start_time, (long)end_time);
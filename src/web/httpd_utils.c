@@ -16,6 +16,7 @@
 #include "core/config.h"
 #include "utils/strings.h"
 #include "database/db_auth.h"
+#include "database/db_auth_cache.h"
 
 cJSON* httpd_parse_json_body(const http_request_t *req) {
     if (!req || !req->body || req->body_len == 0) {
@@ -359,9 +360,21 @@ int httpd_get_authenticated_user(const http_request_t *req, user_t *user) {
         return 1;
     }
 
+    // Verified credentials are reused for auth_cache_ttl_seconds. The client IP
+    // is part of every cache key so the allowed_login_cidrs check still holds
+    // on a hit; sessions also key on the user agent so tracking changes reach
+    // the database.
+    char cache_context[sizeof(effective_client_ip) + sizeof(req->user_agent) + 2];
+
     // First, check for session token in cookie
     char session_token[64] = {0};
     if (httpd_get_session_token(req, session_token, sizeof(session_token)) == 0) {
+        snprintf(cache_context, sizeof(cache_context), "%s\n%s", effective_client_ip, req->user_agent);
+        if (db_auth_cache_lookup(AUTH_CACHE_SESSION, session_token, cache_context, user)) {
+            return 1;
+        }
+        uint64_t cache_generation = db_auth_cache_generation();
+
         int64_t user_id;
         int rc = db_auth_validate_session(session_token, &user_id);
         if (rc == 0) {
@@ -370,6 +383,7 @@ int httpd_get_authenticated_user(const http_request_t *req, user_t *user) {
                 rc = db_auth_validate_session_with_context(session_token, &user_id,
                                                            effective_client_ip, req->user_agent);
                 if (rc == 0) {
+                    db_auth_cache_store(AUTH_CACHE_SESSION, session_token, cache_context, user, cache_generation);
                     return 1;
                 }
             } else if (rc == 0) {
@@ -385,11 +399,18 @@ int httpd_get_authenticated_user(const http_request_t *req, user_t *user) {
     if (httpd_get_basic_auth_credentials(req, username, sizeof(username),
                                           password, sizeof(password)) == 0) {
         if (username[0] != '\0' && password[0] != '\0') {
+            snprintf(cache_context, sizeof(cache_context), "%s\n%s", effective_client_ip, username);
+            if (db_auth_cache_lookup(AUTH_CACHE_BASIC, password, cache_context, user)) {
+                return 1;
+            }
+            uint64_t cache_generation = db_auth_cache_generation();
+
             int64_t user_id;
             int rc = db_auth_authenticate(username, password, &user_id);
             if (rc == 0) {
                 rc = db_auth_get_user_by_id(user_id, user);
                 if (rc == 0 && db_auth_ip_allowed_for_user(user, effective_client_ip)) {
+                    db_auth_cache_store(AUTH_CACHE_BASIC, password, cache_context, user, cache_generation);
                     return 1;
                 } else if (rc == 0) {
                     log_warn("Basic auth blocked by allowed_login_cidrs for user '%s' from IP %s",
@@ -403,8 +424,14 @@ int httpd_get_authenticated_user(const http_request_t *req, user_t *user) {
 
     char api_key[128] = {0};
     if (httpd_get_api_key(req, api_key, sizeof(api_key)) == 0) {
+        if (db_auth_cache_lookup(AUTH_CACHE_API_KEY, api_key, effective_client_ip, user)) {
+            return 1;
+        }
+        uint64_t cache_generation = db_auth_cache_generation();
+
         int rc = db_auth_get_user_by_api_key(api_key, user);
         if (rc == 0 && user->is_active && db_auth_ip_allowed_for_user(user, effective_client_ip)) {
+            db_auth_cache_store(AUTH_CACHE_API_KEY, api_key, effective_client_ip, user, cache_generation);
             return 1;
         }
         if (rc == 0 && user->is_active) {
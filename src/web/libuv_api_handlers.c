@@ -92,6 +92,9 @@ int register_all_libuv_handlers(http_server_handle_t server) {
     // Stream Refresh API
     http_server_register_handler(server, "/api/streams/#/refresh", "POST", handle_post_stream_refresh);
 
+    // Stream Snapshot API
+    http_server_register_handler(server, "/api/streams/#/snapshot", "GET", handle_get_stream_snapshot);
+
     // PTZ API
     http_server_register_handler(server, "/api/streams/#/ptz/capabilities", "GET", handle_ptz_capabilities);
     http_server_register_handler(server, "/api/streams/#/ptz/presets", "GET", handle_ptz_get_presets);
@@ -136,6 +139,7 @@ int register_all_libuv_handlers(http_server_handle_t server) {
     // Detection API
     http_server_register_handler(server, "/api/detection/results/#", "GET", handle_get_detection_results);
     http_server_register_handler(server, "/api/detection/models", "GET", handle_get_detection_models);
+    http_server_register_handler(server, "/api/detection/rollups/#", "GET", handle_get_detection_rollups);
 
     // Storage Management API
     http_server_register_handler(server, "/api/storage/health", "GET", handle_get_storage_health);
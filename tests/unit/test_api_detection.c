@@ -1,6 +1,6 @@
 /**
  * @file test_api_detection.c
- * @brief Layer 2 Unity tests for API detection URL validation.
+ * @brief Layer 2 Unity tests for API detection URL validation and response parsing.
  */
 
 #define _POSIX_C_SOURCE 200809L
@@ -57,6 +57,36 @@ void test_api_detection_skips_go2rtc_snapshot_without_stream_name(void) {
     TEST_ASSERT_FALSE(api_detection_should_use_go2rtc_snapshot(NULL, 0, 0, 0, ""));
 }
 
+void test_api_detection_parse_response_reads_both_box_formats(void) {
+    const char *body =
+        "{\"detections\":["
+        "{\"label\":\"person\",\"confidence\":0.9,"
+        "\"bounding_box\":{\"x_min\":0.1,\"y_min\":0.2,\"x_max\":0.3,\"y_max\":0.6},\"track_id\":7},"
+        "{\"label\":\"car\",\"confidence\":0.5,\"x_min\":0.5,\"y_min\":0.5,\"x_max\":0.9,\"y_max\":0.7},"
+        "{\"label\":\"broken\"}"
+        "]}";
+    detection_result_t result;
+
+    TEST_ASSERT_EQUAL_INT(0, api_detection_parse_response(body, strlen(body), &result));
+    TEST_ASSERT_EQUAL_INT(2, result.count);
+    TEST_ASSERT_EQUAL_STRING("person", result.detections[0].label);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.2f, result.detections[0].width);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.4f, result.detections[0].height);
+    TEST_ASSERT_EQUAL_INT(7, result.detections[0].track_id);
+    TEST_ASSERT_EQUAL_STRING("car", result.detections[1].label);
+    TEST_ASSERT_EQUAL_INT(-1, result.detections[1].track_id);
+}
+
+void test_api_detection_parse_response_rejects_invalid_body(void) {
+    detection_result_t result;
+    const char *no_array = "{\"objects\":[]}";
+
+    TEST_ASSERT_EQUAL_INT(-1, api_detection_parse_response(no_array, strlen(no_array), &result));
+    TEST_ASSERT_EQUAL_INT(-1, api_detection_parse_response("not json", 8, &result));
+    TEST_ASSERT_EQUAL_INT(-1, api_detection_parse_response(NULL, 0, &result));
+    TEST_ASSERT_EQUAL_INT(0, result.count);
+}
+
 int main(void) {
     init_logger();
     UNITY_BEGIN();
@@ -66,5 +96,7 @@ int main(void) {
     RUN_TEST(test_detect_objects_api_rejects_url_with_multiple_query_markers);
     RUN_TEST(test_api_detection_uses_go2rtc_snapshot_only_without_decoded_frame);
     RUN_TEST(test_api_detection_skips_go2rtc_snapshot_without_stream_name);
+    RUN_TEST(test_api_detection_parse_response_reads_both_box_formats);
+    RUN_TEST(test_api_detection_parse_response_rejects_invalid_body);
     return UNITY_END();
 }
\ No newline at end of file
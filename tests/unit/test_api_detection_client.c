@@ -0,0 +1,404 @@
+/**
+ * @file test_api_detection_client.c
+ * @brief Layer 2 unit tests — shared curl_multi API detection client
+ *
+ * Tests:
+ *   api_detection_client_submit / _perform — against an in-process HTTP server
+ *   keep-alive connection reuse, per-stream in-flight limit, cancellation
+ *   (including a request that has finished but is still waiting for delivery)
+ *   per-backend latency histograms
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+#include "unity.h"
+#include "core/config.h"
+#include "video/api_detection_client.h"
+
+/* ---- minimal keep-alive HTTP server ---- */
+
+static const char *RESPONSE_BODY = "{\"detections\":[]}";
+
+static int server_fd = -1;
+static int server_port = 0;
+static pthread_t server_thread;
+static atomic_int server_connections;
+static atomic_int server_requests;
+static atomic_int server_delay_ms;
+
+static void *connection_thread(void *arg) {
+    int fd = (int)(intptr_t)arg;
+    char buf[8192];
+    size_t len = 0;
+
+    for (;;) {
+        ssize_t n = recv(fd, buf + len, sizeof(buf) - 1 - len, 0);
+        if (n <= 0) break;
+        len += (size_t)n;
+        buf[len] = '\0';
+
+        char *hdr_end = strstr(buf, "\r\n\r\n");
+        if (!hdr_end) continue;
+
+        size_t content_length = 0;
+        const char *cl = strstr(buf, "Content-Length:");
+        if (cl && cl < hdr_end) content_length = (size_t)atol(cl + 15);
+
+        if (strstr(buf, "Expect: 100-continue") && len == (size_t)(hdr_end + 4 - buf)) {
+            const char *cont = "HTTP/1.1 100 Continue\r\n\r\n";
+            send(fd, cont, strlen(cont), 0);
+        }
+
+        size_t header_len = (size_t)(hdr_end + 4 - buf);
+        while (len < header_len + content_length) {
+            n = recv(fd, buf + len, sizeof(buf) - 1 - len, 0);
+            if (n <= 0) goto done;
+            len += (size_t)n;
+        }
+
+        int delay = atomic_load(&server_delay_ms);
+        if (delay > 0) {
+            struct timespec ts = {delay / 1000, (long)(delay % 1000) * 1000000L};
+            nanosleep(&ts, NULL);
+        }
+
+        char resp[256];
+        int rlen = snprintf(resp, sizeof(resp),
+                            "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n"
+                            "Content-Length: %zu\r\n\r\n%s",
+                            strlen(RESPONSE_BODY), RESPONSE_BODY);
+        send(fd, resp, (size_t)rlen, 0);
+        atomic_fetch_add(&server_requests, 1);
+
+        // Keep any pipelined bytes of the next request
+        size_t consumed = header_len + content_length;
+        memmove(buf, buf + consumed, len - consumed);
+        len -= consumed;
+    }
+done:
+    close(fd);
+    return NULL;
+}
+
+static void *server_main(void *arg) {
+    (void)arg;
+    for (;;) {
+        int fd = accept(server_fd, NULL, NULL);
+        if (fd < 0) break;
+        atomic_fetch_add(&server_connections, 1);
+        pthread_t t;
+        pthread_create(&t, NULL, connection_thread, (void *)(intptr_t)fd);
+        pthread_detach(t);
+    }
+    return NULL;
+}
+
+static void start_server(void) {
+    server_fd = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    setsockopt(server_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    bind(server_fd, (struct sockaddr *)&addr, sizeof(addr));
+    listen(server_fd, 16);
+
+    socklen_t alen = sizeof(addr);
+    getsockname(server_fd, (struct sockaddr *)&addr, &alen);
+    server_port = ntohs(addr.sin_port);
+
+    pthread_create(&server_thread, NULL, server_main, NULL);
+}
+
+static void stop_server(void) {
+    shutdown(server_fd, SHUT_RDWR);
+    close(server_fd);
+    pthread_join(server_thread, NULL);
+}
+
+/* ---- completion tracking ---- */
+
+static pthread_mutex_t done_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t done_cond = PTHREAD_COND_INITIALIZER;
+static int done_count;
+static int done_ok;
+
+static void on_complete(const char *stream_name, const api_detection_response_t *response,
+                        void *user_data) {
+    (void)stream_name;
+    (void)user_data;
+    pthread_mutex_lock(&done_mutex);
+    done_count++;
+    if (response->status == 0 && response->http_code == 200 &&
+        response->body && strstr(response->body, "detections")) {
+        done_ok++;
+    }
+    pthread_cond_broadcast(&done_cond);
+    pthread_mutex_unlock(&done_mutex);
+}
+
+static bool wait_for_completions(int expected, int timeout_ms) {
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    pthread_mutex_lock(&done_mutex);
+    while (done_count < expected) {
+        if (pthread_cond_timedwait(&done_cond, &done_mutex, &deadline) != 0) break;
+    }
+    bool ok = done_count >= expected;
+    pthread_mutex_unlock(&done_mutex);
+    return ok;
+}
+
+static void server_url(char *buf, size_t size) {
+    snprintf(buf, size, "http://127.0.0.1:%d/detect?backend=test", server_port);
+}
+
+static const unsigned char JPEG[] = {0xFF, 0xD8, 0xFF, 0xE0, 0x00, 0x10, 0xFF, 0xD9};
+
+/* ---- Unity boilerplate ---- */
+void setUp(void) {
+    g_config.api_detection_max_inflight = 2;
+    atomic_store(&server_delay_ms, 0);
+    atomic_store(&server_connections, 0);
+    atomic_store(&server_requests, 0);
+    done_count = 0;
+    done_ok = 0;
+    TEST_ASSERT_EQUAL_INT(0, api_detection_client_init());
+}
+
+void tearDown(void) {
+    api_detection_client_shutdown();
+}
+
+/* ================================================================
+ * Keep-alive: sequential requests share one connection
+ * ================================================================ */
+
+void test_sequential_requests_reuse_connection(void) {
+    char url[128];
+    server_url(url, sizeof(url));
+
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT_EQUAL_INT(0, api_detection_client_submit("cam_keepalive", url, "test",
+                                                             JPEG, sizeof(JPEG), on_complete, NULL));
+        TEST_ASSERT_TRUE(wait_for_completions(i + 1, 5000));
+    }
+
+    TEST_ASSERT_EQUAL_INT(3, done_ok);
+    TEST_ASSERT_EQUAL_INT(3, atomic_load(&server_requests));
+    TEST_ASSERT_EQUAL_INT(1, atomic_load(&server_connections));
+}
+
+/* ================================================================
+ * In-flight limit is per stream
+ * ================================================================ */
+
+void test_inflight_limit_per_stream(void) {
+    char url[128];
+    server_url(url, sizeof(url));
+    atomic_store(&server_delay_ms, 300);
+
+    TEST_ASSERT_EQUAL_INT(0, api_detection_client_submit("cam_a", url, "test", JPEG, sizeof(JPEG), on_complete, NULL));
+    TEST_ASSERT_EQUAL_INT(0, api_detection_client_submit("cam_a", url, "test", JPEG, sizeof(JPEG), on_complete, NULL));
+    TEST_ASSERT_EQUAL_INT(API_DETECTION_CLIENT_BUSY,
+                          api_detection_client_submit("cam_a", url, "test", JPEG, sizeof(JPEG), on_complete, NULL));
+    TEST_ASSERT_EQUAL_INT(2, api_detection_client_inflight("cam_a"));
+
+    /* Another stream is not affected */
+    TEST_ASSERT_EQUAL_INT(0, api_detection_client_submit("cam_b", url, "test", JPEG, sizeof(JPEG), on_complete, NULL));
+
+    TEST_ASSERT_TRUE(wait_for_completions(3, 5000));
+    TEST_ASSERT_EQUAL_INT(3, done_ok);
+    TEST_ASSERT_EQUAL_INT(0, api_detection_client_inflight("cam_a"));
+    TEST_ASSERT_EQUAL_INT(0, api_detection_client_inflight("cam_b"));
+}
+
+/* ================================================================
+ * Cancellation and synchronous requests
+ * ================================================================ */
+
+void test_cancel_suppresses_callback(void) {
+    char url[128];
+    server_url(url, sizeof(url));
+    atomic_store(&server_delay_ms, 200);
+
+    TEST_ASSERT_EQUAL_INT(0, api_detection_client_submit("cam_gone", url, "test", JPEG, sizeof(JPEG), on_complete, NULL));
+    api_detection_client_cancel("cam_gone");
+
+    TEST_ASSERT_FALSE(wait_for_completions(1, 500));
+    TEST_ASSERT_EQUAL_INT(0, done_count);
+    TEST_ASSERT_EQUAL_INT(0, api_detection_client_inflight("cam_gone"));
+}
+
+/* The first callback blocks while the other request waits for delivery */
+static pthread_mutex_t gate_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t gate_cond = PTHREAD_COND_INITIALIZER;
+static char gate_stream[32];
+static bool gate_entered;
+static bool gate_open;
+static int gate_calls;
+
+static void on_complete_gated(const char *stream_name, const api_detection_response_t *response,
+                              void *user_data) {
+    (void)response;
+    (void)user_data;
+    pthread_mutex_lock(&gate_mutex);
+    gate_calls++;
+    if (!gate_entered) {
+        snprintf(gate_stream, sizeof(gate_stream), "%s", stream_name);
+        gate_entered = true;
+        pthread_cond_broadcast(&gate_cond);
+        while (!gate_open) {
+            pthread_cond_wait(&gate_cond, &gate_mutex);
+        }
+    }
+    pthread_mutex_unlock(&gate_mutex);
+}
+
+static void *shutdown_thread(void *arg) {
+    (void)arg;
+    api_detection_client_shutdown();
+    return NULL;
+}
+
+void test_cancel_between_completion_and_delivery(void) {
+    char url[128];
+    server_url(url, sizeof(url));
+    atomic_store(&server_delay_ms, 2000);
+    gate_entered = false;
+    gate_open = false;
+    gate_calls = 0;
+
+    TEST_ASSERT_EQUAL_INT(0, api_detection_client_submit("cam_one", url, "test", JPEG, sizeof(JPEG),
+                                                         on_complete_gated, NULL));
+    TEST_ASSERT_EQUAL_INT(0, api_detection_client_submit("cam_two", url, "test", JPEG, sizeof(JPEG),
+                                                         on_complete_gated, NULL));
+
+    /* Shutdown aborts both at once; the second waits while the first is delivered */
+    pthread_t stopper;
+    TEST_ASSERT_EQUAL_INT(0, pthread_create(&stopper, NULL, shutdown_thread, NULL));
+
+    pthread_mutex_lock(&gate_mutex);
+    while (!gate_entered) {
+        pthread_cond_wait(&gate_cond, &gate_mutex);
+    }
+    const char *other = strcmp(gate_stream, "cam_one") == 0 ? "cam_two" : "cam_one";
+    pthread_mutex_unlock(&gate_mutex);
+
+    api_detection_client_cancel(other);
+
+    pthread_mutex_lock(&gate_mutex);
+    gate_open = true;
+    pthread_cond_broadcast(&gate_cond);
+    pthread_mutex_unlock(&gate_mutex);
+    pthread_join(stopper, NULL);
+
+    TEST_ASSERT_EQUAL_INT(1, gate_calls);
+}
+
+void test_perform_returns_body(void) {
+    char url[128];
+    server_url(url, sizeof(url));
+
+    long http_code = 0;
+    char *body = NULL;
+    size_t body_len = 0;
+    TEST_ASSERT_EQUAL_INT(0, api_detection_client_perform("cam_sync", url, "test", JPEG, sizeof(JPEG),
+                                                          &http_code, &body, &body_len));
+    TEST_ASSERT_EQUAL_INT(200, (int)http_code);
+    TEST_ASSERT_NOT_NULL(body);
+    TEST_ASSERT_EQUAL_STRING(RESPONSE_BODY, body);
+    TEST_ASSERT_EQUAL_size_t(strlen(RESPONSE_BODY), body_len);
+    free(body);
+}
+
+void test_connection_refused_reports_error(void) {
+    long http_code = 0;
+    char *body = NULL;
+    size_t body_len = 0;
+    /* Port 1 on loopback: nothing listens there */
+    TEST_ASSERT_EQUAL_INT(-1, api_detection_client_perform("cam_down", "http://127.0.0.1:1/detect", "test_down",
+                                                           JPEG, sizeof(JPEG), &http_code, &body, &body_len));
+    TEST_ASSERT_NULL(body);
+
+    api_detection_latency_t stats[API_DETECTION_LATENCY_MAX_BACKENDS];
+    int n = api_detection_client_get_latency_stats(stats, API_DETECTION_LATENCY_MAX_BACKENDS);
+    bool found = false;
+    for (int i = 0; i < n; i++) {
+        if (strcmp(stats[i].backend, "test_down") == 0) {
+            found = true;
+            TEST_ASSERT_EQUAL_UINT64(1, stats[i].count);
+            TEST_ASSERT_EQUAL_UINT64(1, stats[i].errors);
+        }
+    }
+    TEST_ASSERT_TRUE(found);
+}
+
+/* ================================================================
+ * Latency histograms
+ * ================================================================ */
+
+void test_latency_histogram_buckets(void) {
+    api_detection_client_record_latency("hist", 5.0, false);      /* <= 10 ms */
+    api_detection_client_record_latency("hist", 30.0, false);     /* <= 50 ms */
+    api_detection_client_record_latency("hist", 30.0, true);
+    api_detection_client_record_latency("hist", 20000.0, false);  /* +Inf */
+
+    api_detection_latency_t stats[API_DETECTION_LATENCY_MAX_BACKENDS];
+    int n = api_detection_client_get_latency_stats(stats, API_DETECTION_LATENCY_MAX_BACKENDS);
+
+    api_detection_latency_t *hist = NULL;
+    for (int i = 0; i < n; i++) {
+        if (strcmp(stats[i].backend, "hist") == 0) hist = &stats[i];
+    }
+    TEST_ASSERT_NOT_NULL(hist);
+    TEST_ASSERT_EQUAL_UINT64(4, hist->count);
+    TEST_ASSERT_EQUAL_UINT64(1, hist->errors);
+    TEST_ASSERT_EQUAL_UINT64(1, hist->buckets[0]);
+    TEST_ASSERT_EQUAL_UINT64(2, hist->buckets[2]);
+    TEST_ASSERT_EQUAL_UINT64(1, hist->buckets[API_DETECTION_LATENCY_BUCKETS - 1]);
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 20065.0, hist->sum_ms);
+
+    TEST_ASSERT_FLOAT_WITHIN(1e-9, 10.0, api_detection_latency_bucket_bound_ms(0));
+    TEST_ASSERT_TRUE(api_detection_latency_bucket_bound_ms(API_DETECTION_LATENCY_BUCKETS - 1) < 0.0);
+}
+
+/* ================================================================
+ * main
+ * ================================================================ */
+
+int main(void) {
+    start_server();
+    UNITY_BEGIN();
+    RUN_TEST(test_sequential_requests_reuse_connection);
+    RUN_TEST(test_inflight_limit_per_stream);
+    RUN_TEST(test_cancel_suppresses_callback);
+    RUN_TEST(test_cancel_between_completion_and_delivery);
+    RUN_TEST(test_perform_returns_body);
+    RUN_TEST(test_connection_refused_reports_error);
+    RUN_TEST(test_latency_histogram_buckets);
+    int ret = UNITY_END();
+    stop_server();
+    return ret;
+}
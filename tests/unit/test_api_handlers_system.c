@@ -27,6 +27,7 @@
 #include "web/request_response.h"
 #include "video/stream_manager.h"
 #include "video/stream_state.h"
+#include "test_stream_fixtures.h"
 
 extern config_t g_config;
 
@@ -54,11 +55,6 @@ static cJSON *find_version_item(cJSON *items, const char *name) {
 }
 
 /* ---- helpers ---- */
-static void clear_db_streams(void) {
-    sqlite3 *db = get_db_handle();
-    sqlite3_exec(db, "DELETE FROM streams;", NULL, NULL, NULL);
-}
-
 static stream_config_t make_test_stream(const char *name) {
     stream_config_t s;
     memset(&s, 0, sizeof(s));
@@ -141,7 +137,7 @@ void test_handle_get_system_info_includes_empty_stream_storage_array(void) {
  * ================================================================ */
 
 void test_handle_get_streams_includes_motion_trigger_source(void) {
-    clear_db_streams();
+    test_clear_streams();
 
     stream_config_t ptz = make_test_stream("ptz_cam");
     safe_strcpy(ptz.motion_trigger_source, "fixed_cam", sizeof(ptz.motion_trigger_source), 0);
@@ -170,7 +166,7 @@ void test_handle_get_streams_includes_motion_trigger_source(void) {
 
     cJSON_Delete(root);
     http_response_free(&res);
-    clear_db_streams();
+    test_clear_streams();
 }
 
 /* ================================================================
@@ -181,7 +177,7 @@ void test_handle_get_streams_includes_motion_trigger_source(void) {
  * ================================================================ */
 
 void test_handle_put_stream_parses_motion_trigger_source(void) {
-    clear_db_streams();
+    test_clear_streams();
 
     /* Register stream in both DB and in-memory stream manager */
     stream_config_t s = make_test_stream("cam_put_mts");
@@ -217,7 +213,7 @@ void test_handle_put_stream_parses_motion_trigger_source(void) {
     http_response_free(&res);
     shutdown_stream_manager();
     shutdown_stream_state_manager();
-    clear_db_streams();
+    test_clear_streams();
 }
 
 int main(void) {
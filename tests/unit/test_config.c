@@ -21,6 +21,7 @@
 #include "core/config.h"
 #include "core/logger.h"
 #include "core/path_utils.h"
+#include "storage/storage_cleanup_pool.h"
 
 /* File-scope config used by most tests — setUp zeros it, tearDown frees
    the dynamically allocated streams array to keep ASan leak-free. */
@@ -96,6 +97,10 @@ void test_default_config_db_backup_settings(void) {
     TEST_ASSERT_EQUAL_INT(60, cfg.db_backup_interval_minutes);
     TEST_ASSERT_EQUAL_INT(24, cfg.db_backup_retention_count);
     TEST_ASSERT_EQUAL_STRING("", cfg.db_post_backup_script);
+    TEST_ASSERT_EQUAL_INT(256, cfg.db_backup_step_pages);
+    TEST_ASSERT_EQUAL_INT(20, cfg.db_backup_step_sleep_ms);
+    TEST_ASSERT_EQUAL_INT(0, cfg.db_backup_max_mb_per_sec);
+    TEST_ASSERT_FALSE(cfg.db_backup_compress);
 }
 
 void test_default_config_models_path_nonempty(void) {
@@ -195,6 +200,59 @@ void test_validate_config_clamps_negative_db_backup_values(void) {
     TEST_ASSERT_EQUAL_INT(0, cfg.db_backup_retention_count);
 }
 
+void test_default_config_db_checkpoint_settings(void) {
+    load_default_config(&cfg);
+    TEST_ASSERT_EQUAL_INT(30, cfg.db_checkpoint_interval_seconds);
+    TEST_ASSERT_EQUAL_INT(50, cfg.db_checkpoint_idle_writes);
+    TEST_ASSERT_EQUAL_INT(10, cfg.db_checkpoint_max_deferrals);
+    TEST_ASSERT_EQUAL_INT(16, cfg.db_wal_truncate_mb);
+    TEST_ASSERT_EQUAL_INT(10000, cfg.db_wal_autocheckpoint_pages);
+    TEST_ASSERT_EQUAL_INT(256, cfg.db_incremental_vacuum_pages);
+}
+
+void test_validate_config_keeps_wal_truncate_below_autocheckpoint(void) {
+    load_default_config(&cfg);
+    TEST_ASSERT_EQUAL_INT(0, validate_config(&cfg));
+    TEST_ASSERT_EQUAL_INT(16, cfg.db_wal_truncate_mb);
+
+    /* 10000 pages of 4 KB is 39 MB, so 64 MB would never be reached */
+    cfg.db_wal_truncate_mb = 64;
+    TEST_ASSERT_EQUAL_INT(0, validate_config(&cfg));
+    TEST_ASSERT_EQUAL_INT(19, cfg.db_wal_truncate_mb);
+
+    /* Without SQLite's own checkpoint any threshold can be reached */
+    cfg.db_wal_autocheckpoint_pages = 0;
+    cfg.db_wal_truncate_mb = 64;
+    TEST_ASSERT_EQUAL_INT(0, validate_config(&cfg));
+    TEST_ASSERT_EQUAL_INT(64, cfg.db_wal_truncate_mb);
+}
+
+void test_validate_config_clamps_db_backup_pacing(void) {
+    load_default_config(&cfg);
+    cfg.db_backup_step_pages = 0;
+    cfg.db_backup_step_sleep_ms = -1;
+    cfg.db_backup_max_mb_per_sec = -10;
+
+    TEST_ASSERT_EQUAL_INT(0, validate_config(&cfg));
+    TEST_ASSERT_EQUAL_INT(1, cfg.db_backup_step_pages);
+    TEST_ASSERT_EQUAL_INT(0, cfg.db_backup_step_sleep_ms);
+    TEST_ASSERT_EQUAL_INT(0, cfg.db_backup_max_mb_per_sec);
+}
+
+void test_validate_config_clamps_cleanup_workers(void) {
+    load_default_config(&cfg);
+    TEST_ASSERT_EQUAL_INT(4, cfg.cleanup_workers);
+    TEST_ASSERT_EQUAL_INT(CLEANUP_IO_PRIORITY_LOW, cfg.cleanup_io_priority);
+
+    cfg.cleanup_workers = 0;
+    TEST_ASSERT_EQUAL_INT(0, validate_config(&cfg));
+    TEST_ASSERT_EQUAL_INT(1, cfg.cleanup_workers);
+
+    cfg.cleanup_workers = 100;
+    TEST_ASSERT_EQUAL_INT(0, validate_config(&cfg));
+    TEST_ASSERT_EQUAL_INT(CLEANUP_POOL_MAX_WORKERS, cfg.cleanup_workers);
+}
+
 /* ================================================================
  * additional default field checks
  * ================================================================ */
@@ -488,6 +546,10 @@ int main(void) {
     RUN_TEST(test_validate_config_buffer_size_zero);
     RUN_TEST(test_validate_config_clamps_absolute_timeout_to_idle_timeout);
     RUN_TEST(test_validate_config_clamps_negative_db_backup_values);
+    RUN_TEST(test_validate_config_clamps_db_backup_pacing);
+    RUN_TEST(test_validate_config_clamps_cleanup_workers);
+    RUN_TEST(test_default_config_db_checkpoint_settings);
+    RUN_TEST(test_validate_config_keeps_wal_truncate_below_autocheckpoint);
 
     RUN_TEST(test_default_config_web_auth_enabled);
     RUN_TEST(test_default_config_username);
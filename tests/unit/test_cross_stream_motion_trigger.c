@@ -28,6 +28,7 @@
 #include "core/config.h"
 #include "core/logger.h"
 #include "utils/strings.h"
+#include "test_stream_fixtures.h"
 
 #define TEST_DB_PATH "/tmp/lightnvr_unit_cross_stream_trigger_test.db"
 
@@ -60,13 +61,8 @@ static stream_config_t make_stream(const char *name, bool enabled) {
     return s;
 }
 
-static void clear_streams(void) {
-    sqlite3 *db = get_db_handle();
-    sqlite3_exec(db, "DELETE FROM streams;", NULL, NULL, NULL);
-}
-
 /* ---- Unity boilerplate ---- */
-void setUp(void)    { clear_streams(); }
+void setUp(void)    { test_clear_streams(); }
 void tearDown(void) {}
 
 /* ================================================================
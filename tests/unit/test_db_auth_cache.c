@@ -0,0 +1,194 @@
+/**
+ * @file test_db_auth_cache.c
+ * @brief Layer 2 — cache of verified credentials, sessions and API keys
+ *
+ * Tests:
+ *   - a stored credential is found only with the same secret and context
+ *   - entries expire after auth_cache_ttl_seconds, and 0 disables the cache
+ *   - password changes, user updates and user deletion drop the user's entries
+ *   - deleting a session drops only that session
+ *   - a credential verified before an invalidation is not stored after it
+ *   - the cache stays bounded
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sqlite3.h>
+
+#include "unity.h"
+#include "core/config.h"
+#include "utils/strings.h"
+#include "database/db_core.h"
+#include "database/db_auth.h"
+#include "database/db_auth_cache.h"
+
+#define TEST_DB_PATH "/tmp/lightnvr_unit_auth_cache_test.db"
+
+static int64_t create_user(const char *username) {
+    int64_t uid = 0;
+    TEST_ASSERT_EQUAL_INT(0, db_auth_create_user(username, "password123", NULL, USER_ROLE_USER, true, &uid));
+    return uid;
+}
+
+static user_t load_user(int64_t uid) {
+    user_t user;
+    TEST_ASSERT_EQUAL_INT(0, db_auth_get_user_by_id(uid, &user));
+    return user;
+}
+
+void setUp(void) {
+    g_config.auth_cache_ttl_seconds = 30;
+    db_auth_cache_clear();
+    sqlite3_exec(get_db_handle(), "DELETE FROM users WHERE username != 'admin';", NULL, NULL, NULL);
+    sqlite3_exec(get_db_handle(), "DELETE FROM sessions;", NULL, NULL, NULL);
+}
+void tearDown(void) {}
+
+/* Hits need the same kind, secret and context */
+void test_lookup_matches_secret_and_context(void) {
+    user_t alice = load_user(create_user("alice"));
+    db_auth_cache_store(AUTH_CACHE_BASIC, "password123", "10.0.0.1\nalice", &alice, db_auth_cache_generation());
+
+    user_t got;
+    memset(&got, 0, sizeof(got));
+    TEST_ASSERT_TRUE(db_auth_cache_lookup(AUTH_CACHE_BASIC, "password123", "10.0.0.1\nalice", &got));
+    TEST_ASSERT_EQUAL_STRING("alice", got.username);
+    TEST_ASSERT_EQUAL_INT64(alice.id, got.id);
+
+    TEST_ASSERT_FALSE(db_auth_cache_lookup(AUTH_CACHE_BASIC, "wrong", "10.0.0.1\nalice", &got));
+    TEST_ASSERT_FALSE(db_auth_cache_lookup(AUTH_CACHE_BASIC, "password123", "10.0.0.2\nalice", &got));
+    TEST_ASSERT_FALSE(db_auth_cache_lookup(AUTH_CACHE_API_KEY, "password123", "10.0.0.1\nalice", &got));
+}
+
+/* Entries expire and a TTL of 0 turns the cache off */
+void test_ttl_expiry_and_disable(void) {
+    user_t bob = load_user(create_user("bob"));
+    user_t got;
+
+    g_config.auth_cache_ttl_seconds = 1;
+    db_auth_cache_store(AUTH_CACHE_API_KEY, "key-bob", "10.0.0.1", &bob, db_auth_cache_generation());
+    TEST_ASSERT_TRUE(db_auth_cache_lookup(AUTH_CACHE_API_KEY, "key-bob", "10.0.0.1", &got));
+    sleep(2);
+    TEST_ASSERT_FALSE(db_auth_cache_lookup(AUTH_CACHE_API_KEY, "key-bob", "10.0.0.1", &got));
+
+    g_config.auth_cache_ttl_seconds = 0;
+    db_auth_cache_store(AUTH_CACHE_API_KEY, "key-bob", "10.0.0.1", &bob, db_auth_cache_generation());
+    TEST_ASSERT_FALSE(db_auth_cache_lookup(AUTH_CACHE_API_KEY, "key-bob", "10.0.0.1", &got));
+}
+
+/* Changing the password or the user drops everything cached for that user */
+void test_user_changes_invalidate(void) {
+    int64_t carol_id = create_user("carol");
+    int64_t dave_id = create_user("dave");
+    user_t carol = load_user(carol_id);
+    user_t dave = load_user(dave_id);
+    user_t got;
+
+    db_auth_cache_store(AUTH_CACHE_BASIC, "password123", "ip\ncarol", &carol, db_auth_cache_generation());
+    db_auth_cache_store(AUTH_CACHE_SESSION, "carol-token", "ip\nua", &carol, db_auth_cache_generation());
+    db_auth_cache_store(AUTH_CACHE_BASIC, "password123", "ip\ndave", &dave, db_auth_cache_generation());
+
+    TEST_ASSERT_EQUAL_INT(0, db_auth_change_password(carol_id, "new-password"));
+    TEST_ASSERT_FALSE(db_auth_cache_lookup(AUTH_CACHE_BASIC, "password123", "ip\ncarol", &got));
+    TEST_ASSERT_FALSE(db_auth_cache_lookup(AUTH_CACHE_SESSION, "carol-token", "ip\nua", &got));
+    TEST_ASSERT_TRUE(db_auth_cache_lookup(AUTH_CACHE_BASIC, "password123", "ip\ndave", &got));
+
+    TEST_ASSERT_EQUAL_INT(0, db_auth_update_user(dave_id, NULL, NULL, USER_ROLE_VIEWER, -1));
+    TEST_ASSERT_FALSE(db_auth_cache_lookup(AUTH_CACHE_BASIC, "password123", "ip\ndave", &got));
+
+    db_auth_cache_store(AUTH_CACHE_API_KEY, "dave-key", "ip", &dave, db_auth_cache_generation());
+    TEST_ASSERT_EQUAL_INT(0, db_auth_delete_user(dave_id));
+    TEST_ASSERT_FALSE(db_auth_cache_lookup(AUTH_CACHE_API_KEY, "dave-key", "ip", &got));
+}
+
+/* Logging out drops only the deleted session */
+void test_delete_session_invalidates_token(void) {
+    int64_t uid = create_user("erin");
+    user_t erin = load_user(uid);
+    user_t got;
+
+    char token_a[128];
+    char token_b[128];
+    TEST_ASSERT_EQUAL_INT(0, db_auth_create_session(uid, "10.0.0.1", "ua", 3600, token_a, sizeof(token_a)));
+    TEST_ASSERT_EQUAL_INT(0, db_auth_create_session(uid, "10.0.0.2", "ua", 3600, token_b, sizeof(token_b)));
+    db_auth_cache_store(AUTH_CACHE_SESSION, token_a, "10.0.0.1\nua", &erin, db_auth_cache_generation());
+    db_auth_cache_store(AUTH_CACHE_SESSION, token_b, "10.0.0.2\nua", &erin, db_auth_cache_generation());
+
+    TEST_ASSERT_EQUAL_INT(0, db_auth_delete_session(token_a));
+    TEST_ASSERT_FALSE(db_auth_cache_lookup(AUTH_CACHE_SESSION, token_a, "10.0.0.1\nua", &got));
+    TEST_ASSERT_TRUE(db_auth_cache_lookup(AUTH_CACHE_SESSION, token_b, "10.0.0.2\nua", &got));
+
+    TEST_ASSERT_EQUAL_INT(0, db_auth_delete_user_sessions(uid));
+    TEST_ASSERT_FALSE(db_auth_cache_lookup(AUTH_CACHE_SESSION, token_b, "10.0.0.2\nua", &got));
+}
+
+/* A store racing a password change must not bring back the old password */
+void test_store_after_invalidation_is_dropped(void) {
+    int64_t uid = create_user("grace");
+    user_t got;
+
+    // The request reads the generation and verifies the old password...
+    uint64_t generation = db_auth_cache_generation();
+    int64_t verified_id = 0;
+    TEST_ASSERT_EQUAL_INT(0, db_auth_authenticate("grace", "password123", &verified_id));
+    user_t grace = load_user(verified_id);
+
+    // ...the password changes before it gets to cache the result
+    TEST_ASSERT_EQUAL_INT(0, db_auth_change_password(uid, "new-password"));
+
+    db_auth_cache_store(AUTH_CACHE_BASIC, "password123", "ip\ngrace", &grace, generation);
+    TEST_ASSERT_FALSE(db_auth_cache_lookup(AUTH_CACHE_BASIC, "password123", "ip\ngrace", &got));
+
+    // Logging out another session also moves the generation
+    generation = db_auth_cache_generation();
+    db_auth_cache_invalidate_secret(AUTH_CACHE_SESSION, "other-token");
+    db_auth_cache_store(AUTH_CACHE_BASIC, "new-password", "ip\ngrace", &grace, generation);
+    TEST_ASSERT_FALSE(db_auth_cache_lookup(AUTH_CACHE_BASIC, "new-password", "ip\ngrace", &got));
+
+    db_auth_cache_store(AUTH_CACHE_BASIC, "new-password", "ip\ngrace", &grace, db_auth_cache_generation());
+    TEST_ASSERT_TRUE(db_auth_cache_lookup(AUTH_CACHE_BASIC, "new-password", "ip\ngrace", &got));
+}
+
+/* The oldest entry is replaced once the cache is full */
+void test_cache_is_bounded(void) {
+    user_t frank = load_user(create_user("frank"));
+    char key[32];
+
+    for (int i = 0; i < AUTH_CACHE_MAX_ENTRIES + 10; i++) {
+        snprintf(key, sizeof(key), "key-%d", i);
+        db_auth_cache_store(AUTH_CACHE_API_KEY, key, "ip", &frank, db_auth_cache_generation());
+    }
+
+    auth_cache_stats_t stats;
+    db_auth_cache_get_stats(&stats);
+    TEST_ASSERT_EQUAL_INT(AUTH_CACHE_MAX_ENTRIES, stats.entries);
+
+    user_t got;
+    snprintf(key, sizeof(key), "key-%d", AUTH_CACHE_MAX_ENTRIES + 9);
+    TEST_ASSERT_TRUE(db_auth_cache_lookup(AUTH_CACHE_API_KEY, key, "ip", &got));
+}
+
+int main(void) {
+    unlink(TEST_DB_PATH);
+    if (init_database(TEST_DB_PATH) != 0) {
+        fprintf(stderr, "FATAL: init_database failed\n");
+        return 1;
+    }
+    db_auth_init();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_lookup_matches_secret_and_context);
+    RUN_TEST(test_ttl_expiry_and_disable);
+    RUN_TEST(test_user_changes_invalidate);
+    RUN_TEST(test_delete_session_invalidates_token);
+    RUN_TEST(test_store_after_invalidation_is_dropped);
+    RUN_TEST(test_cache_is_bounded);
+    int result = UNITY_END();
+    shutdown_database();
+    unlink(TEST_DB_PATH);
+    return result;
+}
@@ -0,0 +1,202 @@
+/**
+ * @file test_db_backup.c
+ * @brief Layer 2 — stepped online backups of the open database
+ *
+ * Tests:
+ *   - a live backup copies every committed row and passes quick_check
+ *   - writers keep committing while a backup is being stepped
+ *   - a second backup is refused while one is running
+ *   - compressed backups decompress to the original file (zlib builds)
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sqlite3.h>
+#ifdef LIGHTNVR_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#include "unity.h"
+#include "core/config.h"
+#include "database/db_core.h"
+#include "database/db_backup.h"
+
+#define TEST_DB_PATH     "/tmp/lightnvr_unit_backup_test.db"
+#define TEST_BACKUP_PATH "/tmp/lightnvr_unit_backup_test.copy"
+#define TEST_GZ_PATH     "/tmp/lightnvr_unit_backup_test.copy.gz"
+#define TEST_ROWS        2000
+
+static volatile int writer_running = 0;
+static int rows_written_during_backup = 0;
+
+static void insert_probe_rows(int count) {
+    sqlite3 *db = get_db_handle();
+    db_writer_lock();
+    sqlite3_exec(db, "BEGIN;", NULL, NULL, NULL);
+    for (int i = 0; i < count; i++) {
+        sqlite3_exec(db, "INSERT INTO backup_probe (payload) VALUES (hex(randomblob(64)));",
+                     NULL, NULL, NULL);
+    }
+    sqlite3_exec(db, "COMMIT;", NULL, NULL, NULL);
+    db_writer_unlock();
+}
+
+static int count_rows(sqlite3 *conn) {
+    sqlite3_stmt *stmt = NULL;
+    int count = -1;
+    if (sqlite3_prepare_v2(conn, "SELECT COUNT(*) FROM backup_probe;", -1, &stmt, NULL) == SQLITE_OK) {
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            count = sqlite3_column_int(stmt, 0);
+        }
+        sqlite3_finalize(stmt);
+    }
+    return count;
+}
+
+static int count_backup_rows(const char *path) {
+    sqlite3 *copy = NULL;
+    TEST_ASSERT_EQUAL_INT(SQLITE_OK, sqlite3_open_v2(path, &copy, SQLITE_OPEN_READONLY, NULL));
+    int count = count_rows(copy);
+    sqlite3_close(copy);
+    return count;
+}
+
+static void *writer_thread(void *arg) {
+    (void)arg;
+    while (writer_running) {
+        insert_probe_rows(1);
+        rows_written_during_backup++;
+        struct timespec ts = {0, 1000000L};
+        nanosleep(&ts, NULL);
+    }
+    return NULL;
+}
+
+static void *second_backup_thread(void *arg) {
+    int *result = arg;
+    *result = backup_live_database(TEST_BACKUP_PATH ".second");
+    return NULL;
+}
+
+void setUp(void) {
+    g_config.db_backup_step_pages = 256;
+    g_config.db_backup_step_sleep_ms = 0;
+    g_config.db_backup_max_mb_per_sec = 0;
+    unlink(TEST_BACKUP_PATH);
+    unlink(TEST_GZ_PATH);
+    sqlite3_exec(get_db_handle(), "DELETE FROM backup_probe;", NULL, NULL, NULL);
+}
+void tearDown(void) {}
+
+/* Every committed row ends up in the copy */
+void test_live_backup_copies_committed_rows(void) {
+    insert_probe_rows(TEST_ROWS);
+
+    TEST_ASSERT_EQUAL_INT(0, backup_live_database(TEST_BACKUP_PATH));
+    TEST_ASSERT_EQUAL_INT(TEST_ROWS, count_backup_rows(TEST_BACKUP_PATH));
+    TEST_ASSERT_NOT_EQUAL(0, access(TEST_BACKUP_PATH ".tmp", F_OK));
+}
+
+/* Writers commit between steps and the backup still completes */
+void test_writers_progress_during_backup(void) {
+    insert_probe_rows(TEST_ROWS);
+    g_config.db_backup_step_pages = 1;
+    g_config.db_backup_step_sleep_ms = 1;
+
+    pthread_t writer;
+    rows_written_during_backup = 0;
+    writer_running = 1;
+    TEST_ASSERT_EQUAL_INT(0, pthread_create(&writer, NULL, writer_thread, NULL));
+
+    int rc = backup_live_database(TEST_BACKUP_PATH);
+    writer_running = 0;
+    pthread_join(writer, NULL);
+
+    TEST_ASSERT_EQUAL_INT(0, rc);
+    TEST_ASSERT_GREATER_THAN_INT(0, rows_written_during_backup);
+    int copied = count_backup_rows(TEST_BACKUP_PATH);
+    TEST_ASSERT_GREATER_OR_EQUAL_INT(TEST_ROWS, copied);
+    TEST_ASSERT_LESS_OR_EQUAL_INT(count_rows(get_db_handle()), copied);
+}
+
+/* Only one backup runs at a time */
+void test_concurrent_backup_is_refused(void) {
+    insert_probe_rows(TEST_ROWS);
+    g_config.db_backup_step_pages = 1;
+    g_config.db_backup_step_sleep_ms = 2;
+
+    pthread_t second;
+    int second_rc = 0;
+    TEST_ASSERT_EQUAL_INT(0, pthread_create(&second, NULL, second_backup_thread, &second_rc));
+    struct timespec ts = {0, 50000000L};
+    nanosleep(&ts, NULL);
+
+    int first_rc = backup_live_database(TEST_BACKUP_PATH);
+    pthread_join(second, NULL);
+
+    // Whichever started first wins; the other is turned away
+    TEST_ASSERT_TRUE((first_rc == 0) != (second_rc == 0));
+    unlink(TEST_BACKUP_PATH ".second");
+}
+
+/* A compressed backup inflates back to the same bytes */
+void test_compressed_backup_round_trips(void) {
+#ifdef LIGHTNVR_HAVE_ZLIB
+    insert_probe_rows(TEST_ROWS);
+    TEST_ASSERT_EQUAL_INT(0, backup_live_database(TEST_BACKUP_PATH));
+    TEST_ASSERT_EQUAL_INT(0, compress_backup_file(TEST_BACKUP_PATH, TEST_GZ_PATH));
+
+    FILE *plain = fopen(TEST_BACKUP_PATH, "rb");
+    gzFile gz = gzopen(TEST_GZ_PATH, "rb");
+    TEST_ASSERT_NOT_NULL(plain);
+    TEST_ASSERT_NOT_NULL(gz);
+
+    char a[4096];
+    char b[4096];
+    size_t total = 0;
+    while (1) {
+        size_t n = fread(a, 1, sizeof(a), plain);
+        int m = gzread(gz, b, sizeof(b));
+        TEST_ASSERT_EQUAL_INT((int)n, m);
+        if (n == 0) {
+            break;
+        }
+        TEST_ASSERT_EQUAL_MEMORY(a, b, n);
+        total += n;
+    }
+    fclose(plain);
+    gzclose(gz);
+    TEST_ASSERT_GREATER_THAN(0, total);
+#else
+    TEST_ASSERT_NOT_EQUAL(0, compress_backup_file(TEST_BACKUP_PATH, TEST_GZ_PATH));
+#endif
+}
+
+int main(void) {
+    unlink(TEST_DB_PATH);
+    if (init_database(TEST_DB_PATH) != 0) {
+        fprintf(stderr, "FATAL: init_database failed\n");
+        return 1;
+    }
+    sqlite3_exec(get_db_handle(),
+                 "CREATE TABLE backup_probe (id INTEGER PRIMARY KEY, payload TEXT);",
+                 NULL, NULL, NULL);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_live_backup_copies_committed_rows);
+    RUN_TEST(test_writers_progress_during_backup);
+    RUN_TEST(test_concurrent_backup_is_refused);
+    RUN_TEST(test_compressed_backup_round_trips);
+    int result = UNITY_END();
+    shutdown_database();
+    unlink(TEST_DB_PATH);
+    unlink(TEST_BACKUP_PATH);
+    unlink(TEST_GZ_PATH);
+    return result;
+}
@@ -5,7 +5,8 @@
  * Tests store_detections_in_db, get_detections_from_db,
  * get_detections_from_db_time_range, has_detections_in_time_range,
  * delete_old_detections, get_detection_labels_summary,
- * and update_detections_recording_id.
+ * update_detections_recording_id, the per-recording detection summary and
+ * the minute/hour detection rollups.
  */
 
 #define _POSIX_C_SOURCE 200809L
@@ -38,8 +39,47 @@ static detection_result_t make_result(const char *label, float conf) {
     return r;
 }
 
+static uint64_t add_recording(const char *stream, time_t start, time_t end, bool complete) {
+    recording_metadata_t rec;
+    memset(&rec, 0, sizeof(rec));
+    safe_strcpy(rec.stream_name, stream,      sizeof(rec.stream_name),  0);
+    safe_strcpy(rec.file_path,   "/tmp/s.mp4", sizeof(rec.file_path),   0);
+    safe_strcpy(rec.trigger_type,"scheduled", sizeof(rec.trigger_type), 0);
+    rec.start_time  = start;
+    rec.end_time    = end;
+    rec.is_complete = complete;
+    rec.retention_override_days = -1;
+    rec.retention_tier = RETENTION_TIER_STANDARD;
+    return add_recording_metadata(&rec);
+}
+
+static int recording_detection_count(uint64_t id) {
+    sqlite3_stmt *stmt = NULL;
+    int count = -1;
+    sqlite3_prepare_v2(get_db_handle(), "SELECT detection_count FROM recordings WHERE id = ?;",
+                       -1, &stmt, NULL);
+    sqlite3_bind_int64(stmt, 1, (sqlite3_int64)id);
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        count = sqlite3_column_int(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+    return count;
+}
+
+static int count_sql(const char *sql) {
+    sqlite3_stmt *stmt = NULL;
+    int count = -1;
+    if (sqlite3_prepare_v2(get_db_handle(), sql, -1, &stmt, NULL) == SQLITE_OK &&
+        sqlite3_step(stmt) == SQLITE_ROW) {
+        count = sqlite3_column_int(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+    return count;
+}
+
 static void clear_detections(void) {
     sqlite3_exec(get_db_handle(), "DELETE FROM detections;", NULL, NULL, NULL);
+    sqlite3_exec(get_db_handle(), "DELETE FROM detection_rollups;", NULL, NULL, NULL);
 }
 
 void setUp(void)    { clear_detections(); }
@@ -153,6 +193,131 @@ void test_store_max_detections(void) {
     TEST_ASSERT_EQUAL_INT(0, rc);
 }
 
+/* Stored detections count for linked and covering recordings */
+void test_detection_summary_counts_linked_and_range(void) {
+    time_t now = time(NULL);
+    uint64_t rec_id = add_recording("cam8", now - 100, now, true);
+    TEST_ASSERT_NOT_EQUAL(0, rec_id);
+
+    detection_result_t r = make_result("person", 0.6f);
+    r.count = 2;
+    r.detections[1] = r.detections[0];
+    r.detections[1].confidence = 0.9f;
+    TEST_ASSERT_EQUAL_INT(0, store_detections_in_db("cam8", &r, now - 50, rec_id));
+    detection_result_t car = make_result("car", 0.7f);
+    TEST_ASSERT_EQUAL_INT(0, store_detections_in_db("cam8", &car, now - 40, 0));
+    detection_result_t outside = make_result("dog", 0.7f);
+    TEST_ASSERT_EQUAL_INT(0, store_detections_in_db("cam8", &outside, now - 500, 0));
+
+    TEST_ASSERT_EQUAL_INT(3, recording_detection_count(rec_id));
+
+    detection_label_summary_t labels[MAX_DETECTION_LABELS];
+    int n = get_recording_detection_labels(rec_id, labels, MAX_DETECTION_LABELS);
+    TEST_ASSERT_EQUAL_INT(2, n);
+    TEST_ASSERT_EQUAL_STRING("person", labels[0].label);
+    TEST_ASSERT_EQUAL_INT(2, labels[0].count);
+    TEST_ASSERT_EQUAL_STRING("car", labels[1].label);
+
+    TEST_ASSERT_EQUAL_INT(1, get_recording_count(0, 0, "cam8", 1, "car", -1, NULL, 0, NULL, NULL));
+    TEST_ASSERT_EQUAL_INT(0, get_recording_count(0, 0, "cam8", -1, NULL, -1, NULL, 0, NULL, NULL));
+}
+
+/* A recording is recounted over its final time range when it completes */
+void test_detection_summary_recounted_on_completion(void) {
+    time_t now = time(NULL);
+    uint64_t rec_id = add_recording("cam9", now - 100, 0, false);
+
+    detection_result_t r = make_result("cat", 0.8f);
+    TEST_ASSERT_EQUAL_INT(0, store_detections_in_db("cam9", &r, now - 20, 0));
+    TEST_ASSERT_EQUAL_INT(0, recording_detection_count(rec_id));
+
+    TEST_ASSERT_EQUAL_INT(0, update_recording_metadata(rec_id, now, 1000, true));
+    TEST_ASSERT_EQUAL_INT(1, recording_detection_count(rec_id));
+    TEST_ASSERT_EQUAL_INT(1, get_recording_count(0, 0, "cam9", 1, NULL, -1, NULL, 0, NULL, NULL));
+}
+
+/* Stored detections are counted per minute and per hour */
+void test_detection_rollups_follow_inserts(void) {
+    time_t hour = (time(NULL) / 3600 - 2) * 3600;
+    detection_result_t r = make_result("person", 0.6f);
+    r.count = 2;
+    r.detections[1] = r.detections[0];
+    r.detections[1].confidence = 0.9f;
+    TEST_ASSERT_EQUAL_INT(0, store_detections_in_db("cam10", &r, hour + 10, 0));
+    detection_result_t car = make_result("car", 0.7f);
+    TEST_ASSERT_EQUAL_INT(0, store_detections_in_db("cam10", &car, hour + 70, 0));
+
+    detection_bucket_t buckets[8];
+    int n = get_detection_density("cam10", hour, hour + 3599, DETECTION_ROLLUP_MINUTE, NULL, buckets, 8);
+    TEST_ASSERT_EQUAL_INT(2, n);
+    TEST_ASSERT_EQUAL_INT64(hour, buckets[0].bucket_start);
+    TEST_ASSERT_EQUAL_INT(2, buckets[0].count);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.9f, buckets[0].max_confidence);
+    TEST_ASSERT_EQUAL_INT64(hour + 60, buckets[1].bucket_start);
+    TEST_ASSERT_EQUAL_INT(1, buckets[1].count);
+
+    n = get_detection_density("cam10", hour, hour + 3599, DETECTION_ROLLUP_HOUR, NULL, buckets, 8);
+    TEST_ASSERT_EQUAL_INT(1, n);
+    TEST_ASSERT_EQUAL_INT(3, buckets[0].count);
+
+    n = get_detection_density("cam10", hour, hour + 3599, DETECTION_ROLLUP_HOUR, "car", buckets, 8);
+    TEST_ASSERT_EQUAL_INT(1, n);
+    TEST_ASSERT_EQUAL_INT(1, buckets[0].count);
+}
+
+/* Label summaries over partial minutes and hours match the detections table */
+void test_labels_summary_matches_detections_across_buckets(void) {
+    time_t hour = (time(NULL) / 3600 - 4) * 3600;
+    static const int offsets[] = { 5, 59, 61, 600, 3599, 3600, 3661, 7199, 7200, 7265 };
+    for (size_t i = 0; i < sizeof(offsets) / sizeof(offsets[0]); i++) {
+        detection_result_t r = make_result(i % 3 == 0 ? "car" : "person", 0.5f);
+        TEST_ASSERT_EQUAL_INT(0, store_detections_in_db("cam11", &r, hour + offsets[i], 0));
+    }
+
+    static const int ranges[][2] = { {30, 7230}, {0, 7199}, {59, 61}, {62, 599}, {3599, 3600} };
+    for (size_t i = 0; i < sizeof(ranges) / sizeof(ranges[0]); i++) {
+        time_t start = hour + ranges[i][0];
+        time_t end = hour + ranges[i][1];
+        char sql[256];
+        snprintf(sql, sizeof(sql),
+                 "SELECT COUNT(*) FROM detections WHERE stream_name = 'cam11' "
+                 "AND label = 'person' AND timestamp >= %lld AND timestamp <= %lld;",
+                 (long long)start, (long long)end);
+        int expected = count_sql(sql);
+
+        detection_label_summary_t labels[MAX_DETECTION_LABELS];
+        int n = get_detection_labels_summary("cam11", start, end, labels, MAX_DETECTION_LABELS);
+        int got = 0;
+        for (int j = 0; j < n; j++) {
+            if (strcmp(labels[j].label, "person") == 0) {
+                got = labels[j].count;
+            }
+        }
+        TEST_ASSERT_EQUAL_INT_MESSAGE(expected, got, "person count");
+
+        snprintf(sql, sizeof(sql),
+                 "SELECT COUNT(*) > 0 FROM detections WHERE stream_name = 'cam11' "
+                 "AND timestamp >= %lld AND timestamp <= %lld;",
+                 (long long)start, (long long)end);
+        TEST_ASSERT_EQUAL_INT(count_sql(sql), has_detections_in_time_range("cam11", start, end));
+    }
+    TEST_ASSERT_EQUAL_INT(0, has_detections_in_time_range("cam11", hour + 62, hour + 599));
+}
+
+/* Retention trims the rollups along with the detections */
+void test_delete_old_detections_trims_rollups(void) {
+    time_t now = time(NULL);
+    detection_result_t r = make_result("bird", 0.6f);
+    store_detections_in_db("cam12", &r, now - 10000, 0);
+    store_detections_in_db("cam12", &r, now - 20, 0);
+
+    TEST_ASSERT_EQUAL_INT(1, delete_old_detections(100));
+    TEST_ASSERT_EQUAL_INT(1, count_sql("SELECT COALESCE(SUM(count), 0) FROM detection_rollups "
+                                       "WHERE stream_name = 'cam12' AND bucket_seconds = 60;"));
+    TEST_ASSERT_EQUAL_INT(1, count_sql("SELECT COALESCE(SUM(count), 0) FROM detection_rollups "
+                                       "WHERE stream_name = 'cam12' AND bucket_seconds = 3600;"));
+}
+
 int main(void) {
     unlink(TEST_DB_PATH);
     if (init_database(TEST_DB_PATH) != 0) {
@@ -168,6 +333,11 @@ int main(void) {
     RUN_TEST(test_get_detection_labels_summary);
     RUN_TEST(test_update_detections_recording_id);
     RUN_TEST(test_store_max_detections);
+    RUN_TEST(test_detection_summary_counts_linked_and_range);
+    RUN_TEST(test_detection_summary_recounted_on_completion);
+    RUN_TEST(test_detection_rollups_follow_inserts);
+    RUN_TEST(test_labels_summary_matches_detections_across_buckets);
+    RUN_TEST(test_delete_old_detections_trims_rollups);
     int result = UNITY_END();
     shutdown_database();
     unlink(TEST_DB_PATH);
@@ -2,7 +2,9 @@
  * @file test_db_maintenance.c
  * @brief Layer 2 — database maintenance functions
  *
- * Tests get_database_size, vacuum_database, check_database_integrity.
+ * Tests get_database_size, vacuum_database, check_database_integrity,
+ * incremental_vacuum_database and the scheduled checkpoint in
+ * maybe_run_database_maintenance.
  */
 
 #define _POSIX_C_SOURCE 200809L
@@ -15,6 +17,7 @@
 #include <sqlite3.h>
 
 #include "unity.h"
+#include "core/config.h"
 #include "utils/strings.h"
 #include "database/db_core.h"
 #include "database/db_maintenance.h"
@@ -85,6 +88,127 @@ void test_check_integrity_after_vacuum(void) {
     TEST_ASSERT_EQUAL_INT(0, rc);
 }
 
+static int64_t pragma_int(const char *sql) {
+    sqlite3_stmt *stmt = NULL;
+    int64_t value = -1;
+    if (sqlite3_prepare_v2(get_db_handle(), sql, -1, &stmt, NULL) == SQLITE_OK) {
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            value = sqlite3_column_int64(stmt, 0);
+        }
+        sqlite3_finalize(stmt);
+    }
+    return value;
+}
+
+/* Fill a scratch table and drop it, leaving free pages behind */
+static void create_free_pages(void) {
+    sqlite3 *db = get_db_handle();
+    sqlite3_exec(db, "CREATE TABLE IF NOT EXISTS scratch (payload BLOB);", NULL, NULL, NULL);
+    sqlite3_exec(db, "BEGIN;", NULL, NULL, NULL);
+    for (int i = 0; i < 200; i++) {
+        sqlite3_exec(db, "INSERT INTO scratch VALUES (randomblob(4000));", NULL, NULL, NULL);
+    }
+    sqlite3_exec(db, "COMMIT;", NULL, NULL, NULL);
+    sqlite3_exec(db, "DROP TABLE scratch;", NULL, NULL, NULL);
+}
+
+/* The first scheduled run checkpoints, and truncates a WAL above the limit */
+void test_maintenance_checkpoints_when_idle(void) {
+    g_config.db_checkpoint_interval_seconds = 1;
+    g_config.db_checkpoint_idle_writes = 1000000;
+    g_config.db_wal_truncate_mb = 0;
+    g_config.db_incremental_vacuum_pages = 0;
+
+    db_maintenance_stats_t before;
+    db_maintenance_get_stats(&before);
+    TEST_ASSERT_EQUAL_INT(0, maybe_run_database_maintenance());
+
+    db_maintenance_stats_t after;
+    db_maintenance_get_stats(&after);
+    TEST_ASSERT_EQUAL_UINT64(before.truncate + 1, after.truncate);
+    TEST_ASSERT_EQUAL_INT64(0, after.wal_bytes);
+
+    /* Not due again until the interval has passed */
+    TEST_ASSERT_EQUAL_INT(0, maybe_run_database_maintenance());
+    db_maintenance_get_stats(&before);
+    TEST_ASSERT_EQUAL_UINT64(after.truncate, before.truncate);
+}
+
+/* A run after heavy writes is skipped */
+void test_maintenance_skips_busy_periods(void) {
+    g_config.db_checkpoint_interval_seconds = 1;
+    g_config.db_checkpoint_idle_writes = 10;
+    g_config.db_checkpoint_max_deferrals = 10;
+    g_config.db_wal_truncate_mb = 64;
+
+    create_free_pages();
+    sleep(2);
+
+    db_maintenance_stats_t before;
+    db_maintenance_get_stats(&before);
+    TEST_ASSERT_EQUAL_INT(0, maybe_run_database_maintenance());
+
+    db_maintenance_stats_t after;
+    db_maintenance_get_stats(&after);
+    TEST_ASSERT_EQUAL_UINT64(before.skipped + 1, after.skipped);
+    TEST_ASSERT_EQUAL_UINT64(before.passive, after.passive);
+
+    /* Quiet again: a PASSIVE checkpoint runs */
+    sleep(2);
+    TEST_ASSERT_EQUAL_INT(0, maybe_run_database_maintenance());
+    db_maintenance_get_stats(&before);
+    TEST_ASSERT_EQUAL_UINT64(after.passive + 1, before.passive);
+}
+
+/* A database that is never quiet still gets a run after max deferrals */
+void test_maintenance_runs_after_max_deferrals(void) {
+    g_config.db_checkpoint_interval_seconds = 1;
+    g_config.db_checkpoint_idle_writes = 10;
+    g_config.db_checkpoint_max_deferrals = 2;
+    g_config.db_wal_truncate_mb = 64;
+    g_config.db_incremental_vacuum_pages = 0;
+
+    db_maintenance_stats_t before;
+    db_maintenance_get_stats(&before);
+
+    for (int i = 0; i < 3; i++) {
+        create_free_pages();
+        sleep(2);
+        TEST_ASSERT_EQUAL_INT(0, maybe_run_database_maintenance());
+    }
+
+    db_maintenance_stats_t after;
+    db_maintenance_get_stats(&after);
+    TEST_ASSERT_EQUAL_UINT64(before.skipped + 2, after.skipped);
+    TEST_ASSERT_EQUAL_UINT64(before.passive + 1, after.passive);
+}
+
+/* Incremental vacuum releases at most the requested number of pages */
+void test_incremental_vacuum_is_bounded(void) {
+    TEST_ASSERT_EQUAL_INT64(2, pragma_int("PRAGMA auto_vacuum;"));
+    create_free_pages();
+    int64_t free_before = pragma_int("PRAGMA freelist_count;");
+    TEST_ASSERT_GREATER_THAN(20, free_before);
+
+    TEST_ASSERT_EQUAL_INT(20, incremental_vacuum_database(20));
+    TEST_ASSERT_EQUAL_INT64(free_before - 20, pragma_int("PRAGMA freelist_count;"));
+
+    TEST_ASSERT_EQUAL_INT((int)(free_before - 20), incremental_vacuum_database(100000));
+    TEST_ASSERT_EQUAL_INT64(0, pragma_int("PRAGMA freelist_count;"));
+    TEST_ASSERT_EQUAL_INT(0, incremental_vacuum_database(20));
+}
+
+/* checkpoint_database is counted as a FULL checkpoint */
+void test_checkpoint_database_counts_full(void) {
+    db_maintenance_stats_t before;
+    db_maintenance_get_stats(&before);
+    TEST_ASSERT_EQUAL_INT(0, checkpoint_database());
+
+    db_maintenance_stats_t after;
+    db_maintenance_get_stats(&after);
+    TEST_ASSERT_EQUAL_UINT64(before.full + 1, after.full);
+}
+
 int main(void) {
     unlink(TEST_DB_PATH);
     if (init_database(TEST_DB_PATH) != 0) {
@@ -92,6 +216,11 @@ int main(void) {
         return 1;
     }
     UNITY_BEGIN();
+    RUN_TEST(test_maintenance_checkpoints_when_idle);
+    RUN_TEST(test_maintenance_skips_busy_periods);
+    RUN_TEST(test_maintenance_runs_after_max_deferrals);
+    RUN_TEST(test_incremental_vacuum_is_bounded);
+    RUN_TEST(test_checkpoint_database_counts_full);
     RUN_TEST(test_get_database_size_positive);
     RUN_TEST(test_get_database_size_increases_after_insert);
     RUN_TEST(test_vacuum_database_succeeds);
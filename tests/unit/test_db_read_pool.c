@@ -0,0 +1,172 @@
+/**
+ * @file test_db_read_pool.c
+ * @brief Layer 2 — read-only connection pool and writer lock in db_core
+ *
+ * Tests:
+ *   - db_reader_acquire hands out read-only connections separate from the writer
+ *   - readers see committed writes and do not wait for a held writer lock
+ *   - an exhausted pool blocks until a connection is released
+ *   - a pool that stays exhausted falls back to the writer connection
+ *   - writer and reader lock waits are counted in db_pool_get_stats
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sqlite3.h>
+
+#include "unity.h"
+#include "core/config.h"
+#include "database/db_core.h"
+
+#define TEST_DB_PATH "/tmp/lightnvr_unit_read_pool_test.db"
+#define TEST_READ_CONNECTIONS 2
+
+static void sleep_ms(int ms) {
+    struct timespec ts = {ms / 1000, (long)(ms % 1000) * 1000000L};
+    nanosleep(&ts, NULL);
+}
+
+static db_pool_stats_t stats_now(void) {
+    db_pool_stats_t s;
+    db_pool_get_stats(&s);
+    return s;
+}
+
+static int count_rows(sqlite3 *conn) {
+    sqlite3_stmt *stmt = NULL;
+    int count = -1;
+    if (sqlite3_prepare_v2(conn, "SELECT COUNT(*) FROM pool_t;", -1, &stmt, NULL) == SQLITE_OK &&
+        sqlite3_step(stmt) == SQLITE_ROW) {
+        count = sqlite3_column_int(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+    return count;
+}
+
+static void *reader_thread(void *arg) {
+    (void)arg;
+    sqlite3 *conn = db_reader_acquire();
+    db_reader_release(conn);
+    return conn;
+}
+
+static void *writer_thread(void *arg) {
+    (void)arg;
+    db_writer_lock();
+    db_writer_unlock();
+    return NULL;
+}
+
+void setUp(void) {
+    sqlite3_exec(get_db_handle(), "DELETE FROM pool_t;", NULL, NULL, NULL);
+}
+void tearDown(void) {}
+
+/* Readers get their own read-only connections */
+void test_reader_is_separate_read_only_connection(void) {
+    TEST_ASSERT_EQUAL_INT(TEST_READ_CONNECTIONS, stats_now().read_connections);
+
+    sqlite3 *conn = db_reader_acquire();
+    TEST_ASSERT_NOT_NULL(conn);
+    TEST_ASSERT_TRUE(conn != get_db_handle());
+    TEST_ASSERT_EQUAL_INT(1, stats_now().read_connections_busy);
+
+    int rc = sqlite3_exec(conn, "INSERT INTO pool_t (v) VALUES (1);", NULL, NULL, NULL);
+    TEST_ASSERT_EQUAL_INT(SQLITE_READONLY, rc & 0xff);
+
+    db_reader_release(conn);
+    TEST_ASSERT_EQUAL_INT(0, stats_now().read_connections_busy);
+}
+
+/* Committed writes are visible, and a held writer lock does not block readers */
+void test_reader_sees_writes_without_writer_lock(void) {
+    db_writer_lock();
+    sqlite3_exec(get_db_handle(), "INSERT INTO pool_t (v) VALUES (1), (2);", NULL, NULL, NULL);
+
+    sqlite3 *conn = db_reader_acquire();
+    TEST_ASSERT_EQUAL_INT(2, count_rows(conn));
+    db_reader_release(conn);
+
+    db_writer_unlock();
+}
+
+/* With every connection busy, the next reader waits for a release */
+void test_exhausted_pool_waits_for_release(void) {
+    db_pool_stats_t before = stats_now();
+    sqlite3 *a = db_reader_acquire();
+    sqlite3 *b = db_reader_acquire();
+    TEST_ASSERT_TRUE(a != b);
+
+    pthread_t thread;
+    pthread_create(&thread, NULL, reader_thread, NULL);
+    sleep_ms(50);
+    db_reader_release(a);
+
+    void *got = NULL;
+    pthread_join(thread, &got);
+    TEST_ASSERT_EQUAL_PTR(a, got);
+    db_reader_release(b);
+
+    db_pool_stats_t after = stats_now();
+    TEST_ASSERT_EQUAL_UINT64(before.reader.acquires + 3, after.reader.acquires);
+    TEST_ASSERT_EQUAL_UINT64(before.reader.waits + 1, after.reader.waits);
+    TEST_ASSERT_TRUE(after.reader.wait_us - before.reader.wait_us >= 40000);
+}
+
+/* A reader that cannot get a read connection shares the writer instead */
+void test_exhausted_pool_falls_back_to_writer(void) {
+    sqlite3 *a = db_reader_acquire();
+    sqlite3 *b = db_reader_acquire();
+
+    sqlite3 *conn = db_reader_acquire();
+    TEST_ASSERT_EQUAL_PTR(get_db_handle(), conn);
+    TEST_ASSERT_EQUAL_INT(0, count_rows(conn));
+    db_reader_release(conn);
+
+    db_reader_release(a);
+    db_reader_release(b);
+    TEST_ASSERT_EQUAL_INT(0, stats_now().read_connections_busy);
+}
+
+/* Time spent waiting for the writer is counted */
+void test_writer_wait_is_counted(void) {
+    db_pool_stats_t before = stats_now();
+
+    db_writer_lock();
+    pthread_t thread;
+    pthread_create(&thread, NULL, writer_thread, NULL);
+    sleep_ms(50);
+    db_writer_unlock();
+    pthread_join(thread, NULL);
+
+    db_pool_stats_t after = stats_now();
+    TEST_ASSERT_EQUAL_UINT64(before.writer.acquires + 2, after.writer.acquires);
+    TEST_ASSERT_EQUAL_UINT64(before.writer.waits + 1, after.writer.waits);
+    TEST_ASSERT_TRUE(after.writer.wait_us - before.writer.wait_us >= 40000);
+}
+
+int main(void) {
+    unlink(TEST_DB_PATH);
+    g_config.db_read_connections = TEST_READ_CONNECTIONS;
+    if (init_database(TEST_DB_PATH) != 0) {
+        fprintf(stderr, "FATAL: init_database failed\n");
+        return 1;
+    }
+    sqlite3_exec(get_db_handle(), "CREATE TABLE pool_t (v INTEGER);", NULL, NULL, NULL);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_reader_is_separate_read_only_connection);
+    RUN_TEST(test_reader_sees_writes_without_writer_lock);
+    RUN_TEST(test_exhausted_pool_waits_for_release);
+    RUN_TEST(test_exhausted_pool_falls_back_to_writer);
+    RUN_TEST(test_writer_wait_is_counted);
+    int result = UNITY_END();
+    shutdown_database();
+    unlink(TEST_DB_PATH);
+    return result;
+}
@@ -1,6 +1,6 @@
 /**
  * @file test_db_recordings_extended.c
- * @brief Layer 2 — recording metadata CRUD, tiers, retention, storage bytes
+ * @brief Layer 2 — recording metadata CRUD, tiers, retention, storage bytes and counters
  */
 
 #define _POSIX_C_SOURCE 200809L
@@ -196,6 +196,61 @@ void test_get_recording_metadata_paginated_supports_multi_value_detection_labels
     TEST_ASSERT_EQUAL_STRING("cam2", out[1].stream_name);
 }
 
+/* get_recording_metadata_after */
+void test_keyset_pages_cover_every_row_once(void) {
+    time_t now = time(NULL);
+    uint64_t ids[7];
+    for (int i = 0; i < 7; i++) {
+        char path[64];
+        snprintf(path, sizeof(path), "/rec/keyset%d.mp4", i);
+        /* Pairs of recordings share a start time */
+        recording_metadata_t m = make_rec("cam1", path, now - (i / 2) * 100);
+        ids[i] = add_recording_metadata(&m);
+    }
+
+    /* Newest first; within a start time, highest id first */
+    static const int order[7] = {1, 0, 3, 2, 5, 4, 6};
+    recording_metadata_t out[3];
+    recording_cursor_t cursor;
+    const recording_cursor_t *after = NULL;
+    int seen = 0;
+    for (int page = 0; page < 5; page++) {
+        int n = get_recording_metadata_after(0, 0, "cam1", 0, NULL, -1,
+                                             "start_time", "desc", after, out, 3,
+                                             NULL, 0, NULL, NULL);
+        TEST_ASSERT_TRUE(n >= 0);
+        for (int i = 0; i < n; i++) {
+            TEST_ASSERT_EQUAL_UINT64(ids[order[seen]], out[i].id);
+            seen++;
+        }
+        if (n < 3) break;
+
+        char token[RECORDING_CURSOR_TOKEN_SIZE];
+        TEST_ASSERT_EQUAL_INT(0, recording_cursor_encode(&out[n - 1], "start_time", "desc",
+                                                         token, sizeof(token)));
+        TEST_ASSERT_EQUAL_INT(0, recording_cursor_decode(token, "start_time", "desc", &cursor));
+        after = &cursor;
+    }
+    TEST_ASSERT_EQUAL_INT(7, seen);
+}
+
+void test_recording_cursor_rejects_other_sort_and_garbage(void) {
+    recording_metadata_t m = make_rec("cam:1", "/rec/cursor.mp4", 1000);
+    m.id = 42;
+
+    char token[RECORDING_CURSOR_TOKEN_SIZE];
+    recording_cursor_t cursor;
+    TEST_ASSERT_EQUAL_INT(0, recording_cursor_encode(&m, "stream_name", "asc", token, sizeof(token)));
+    TEST_ASSERT_EQUAL_INT(0, recording_cursor_decode(token, "stream_name", "asc", &cursor));
+    TEST_ASSERT_EQUAL_UINT64(42, cursor.id);
+    TEST_ASSERT_EQUAL_STRING("cam:1", cursor.sort_text);
+
+    TEST_ASSERT_EQUAL_INT(-1, recording_cursor_decode(token, "stream_name", "desc", &cursor));
+    TEST_ASSERT_EQUAL_INT(-1, recording_cursor_decode(token, "start_time", "asc", &cursor));
+    TEST_ASSERT_EQUAL_INT(-1, recording_cursor_decode("zz", "start_time", "desc", &cursor));
+    TEST_ASSERT_EQUAL_INT(-1, recording_cursor_decode("", "start_time", "desc", &cursor));
+}
+
 /* set_recording_retention_tier */
 void test_set_recording_retention_tier(void) {
     time_t now = time(NULL);
@@ -238,6 +293,97 @@ void test_get_stream_storage_bytes(void) {
     TEST_ASSERT_GREATER_THAN(0, bytes);
 }
 
+/* Counters follow inserts, completion, deletes and stream changes */
+void test_storage_stats_follow_recording_writes(void) {
+    time_t now = time(NULL);
+    recording_metadata_t a = make_rec("cam_ss", "/rec/ss_a.mp4", now);
+    recording_metadata_t b = make_rec("cam_ss", "/rec/ss_b.mp4", now + 60);
+    b.is_complete = false;
+    b.size_bytes = 0;
+    recording_metadata_t c = make_rec("cam_ss2", "/rec/ss_c.mp4", now);
+    uint64_t id_a = add_recording_metadata(&a);
+    uint64_t id_b = add_recording_metadata(&b);
+    add_recording_metadata(&c);
+
+    stream_storage_stats_t stats;
+    TEST_ASSERT_EQUAL_INT(0, get_stream_storage_stats("cam_ss", &stats));
+    TEST_ASSERT_EQUAL_INT64(1, stats.recording_count);
+    TEST_ASSERT_EQUAL_INT64(1024 * 1024, stats.total_bytes);
+
+    TEST_ASSERT_EQUAL_INT(0, update_recording_metadata(id_b, now + 120, 2048, true));
+    TEST_ASSERT_EQUAL_INT(0, get_stream_storage_stats("cam_ss", &stats));
+    TEST_ASSERT_EQUAL_INT64(2, stats.recording_count);
+    TEST_ASSERT_EQUAL_INT64(1024 * 1024 + 2048, stats.total_bytes);
+
+    TEST_ASSERT_EQUAL_INT(0, delete_recording_metadata(id_a));
+    TEST_ASSERT_EQUAL_INT(0, get_stream_storage_stats("cam_ss", &stats));
+    TEST_ASSERT_EQUAL_INT64(1, stats.recording_count);
+    TEST_ASSERT_EQUAL_INT64(2048, stats.total_bytes);
+
+    sqlite3_exec(get_db_handle(), "UPDATE recordings SET stream_name = 'cam_ss2' WHERE stream_name = 'cam_ss';",
+                 NULL, NULL, NULL);
+    TEST_ASSERT_EQUAL_INT(0, get_stream_storage_stats("cam_ss", &stats));
+    TEST_ASSERT_EQUAL_INT64(0, stats.recording_count);
+    TEST_ASSERT_EQUAL_INT64(0, stats.total_bytes);
+    TEST_ASSERT_EQUAL_INT(0, get_stream_storage_stats("cam_ss2", &stats));
+    TEST_ASSERT_EQUAL_INT64(2, stats.recording_count);
+
+    TEST_ASSERT_EQUAL_INT(0, get_stream_storage_stats(NULL, &stats));
+    TEST_ASSERT_EQUAL_INT64(2, stats.recording_count);
+    TEST_ASSERT_EQUAL_INT64(1024 * 1024 + 2048, stats.total_bytes);
+    TEST_ASSERT_EQUAL_INT(0, reconcile_stream_storage_stats());
+}
+
+/* Batch deletes remove every listed row and detach their detections */
+void test_delete_recordings_metadata_batch(void) {
+    time_t now = time(NULL);
+    uint64_t ids[4];
+    for (int i = 0; i < 4; i++) {
+        char path[64];
+        snprintf(path, sizeof(path), "/rec/batch_%d.mp4", i);
+        recording_metadata_t m = make_rec("cam_batch", path, now + i * 60);
+        ids[i] = add_recording_metadata(&m);
+        TEST_ASSERT_NOT_EQUAL(0, ids[i]);
+    }
+    detection_result_t person = make_detection_result("person");
+    TEST_ASSERT_EQUAL_INT(0, store_detections_in_db("cam_batch", &person, now + 1, ids[0]));
+
+    uint64_t victims[] = {ids[0], ids[2], 999999};
+    TEST_ASSERT_EQUAL_INT(2, delete_recordings_metadata_batch(victims, 3));
+
+    recording_metadata_t got;
+    TEST_ASSERT_NOT_EQUAL(0, get_recording_metadata_by_id(ids[0], &got));
+    TEST_ASSERT_EQUAL_INT(0, get_recording_metadata_by_id(ids[1], &got));
+    TEST_ASSERT_NOT_EQUAL(0, get_recording_metadata_by_id(ids[2], &got));
+    TEST_ASSERT_EQUAL_INT(0, get_recording_metadata_by_id(ids[3], &got));
+
+    stream_storage_stats_t stats;
+    TEST_ASSERT_EQUAL_INT(0, get_stream_storage_stats("cam_batch", &stats));
+    TEST_ASSERT_EQUAL_INT64(2, stats.recording_count);
+    TEST_ASSERT_EQUAL_INT(0, delete_recordings_metadata_batch(NULL, 0));
+}
+
+/* Reconciliation rebuilds counters that no longer match the recordings */
+void test_reconcile_stream_storage_stats_fixes_drift(void) {
+    time_t now = time(NULL);
+    recording_metadata_t m = make_rec("cam_rc", "/rec/rc.mp4", now);
+    add_recording_metadata(&m);
+    sqlite3_exec(get_db_handle(),
+                 "UPDATE stream_storage_stats SET total_bytes = 1 WHERE stream_name = 'cam_rc';"
+                 "INSERT OR REPLACE INTO stream_storage_stats VALUES ('cam_gone', 3, 300);",
+                 NULL, NULL, NULL);
+
+    TEST_ASSERT_EQUAL_INT(2, reconcile_stream_storage_stats());
+
+    stream_storage_stats_t stats;
+    TEST_ASSERT_EQUAL_INT(0, get_stream_storage_stats("cam_rc", &stats));
+    TEST_ASSERT_EQUAL_INT64(1, stats.recording_count);
+    TEST_ASSERT_EQUAL_INT64(1024 * 1024, stats.total_bytes);
+    TEST_ASSERT_EQUAL_INT(0, get_stream_storage_stats("cam_gone", &stats));
+    TEST_ASSERT_EQUAL_INT64(0, stats.recording_count);
+    TEST_ASSERT_EQUAL_INT(0, reconcile_stream_storage_stats());
+}
+
 int main(void) {
     unlink(TEST_DB_PATH);
     if (init_database(TEST_DB_PATH) != 0) {
@@ -253,10 +399,15 @@ int main(void) {
     RUN_TEST(test_get_recording_count_supports_multi_value_stream_tag_and_capture_filters);
     RUN_TEST(test_get_recording_metadata_paginated);
     RUN_TEST(test_get_recording_metadata_paginated_supports_multi_value_detection_labels_and_tags);
+    RUN_TEST(test_keyset_pages_cover_every_row_once);
+    RUN_TEST(test_recording_cursor_rejects_other_sort_and_garbage);
     RUN_TEST(test_set_recording_retention_tier);
     RUN_TEST(test_set_recording_disk_pressure_eligible);
     RUN_TEST(test_set_recording_retention_override);
     RUN_TEST(test_get_stream_storage_bytes);
+    RUN_TEST(test_storage_stats_follow_recording_writes);
+    RUN_TEST(test_delete_recordings_metadata_batch);
+    RUN_TEST(test_reconcile_stream_storage_stats_fixes_drift);
     int result = UNITY_END();
     shutdown_database();
     unlink(TEST_DB_PATH);
@@ -0,0 +1,142 @@
+/**
+ * @file test_db_stmt_cache.c
+ * @brief Layer 2 — prepared statement cache in db_core
+ *
+ * Tests:
+ *   - db_prepare_cached reuses a released statement for the same SQL
+ *   - statements come back reset with cleared bindings
+ *   - concurrent checkouts of one SQL text get separate statements
+ *   - db_stmt_cache_invalidate finalizes idle and released statements
+ *   - cached queries see schema changes after invalidation
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sqlite3.h>
+
+#include "unity.h"
+#include "database/db_core.h"
+
+#define TEST_DB_PATH "/tmp/lightnvr_unit_stmt_cache_test.db"
+
+static const char *SQL_ONE = "SELECT ?1 + 1;";
+
+static db_stmt_cache_stats_t stats_now(void) {
+    db_stmt_cache_stats_t s;
+    db_stmt_cache_get_stats(&s);
+    return s;
+}
+
+void setUp(void)    { db_stmt_cache_invalidate(); }
+void tearDown(void) {}
+
+/* A released statement is handed out again without a new prepare */
+void test_release_then_prepare_reuses(void) {
+    db_stmt_cache_stats_t before = stats_now();
+
+    sqlite3_stmt *a = db_prepare_cached(SQL_ONE);
+    TEST_ASSERT_NOT_NULL(a);
+    db_release_cached(a);
+    sqlite3_stmt *b = db_prepare_cached(SQL_ONE);
+    TEST_ASSERT_EQUAL_PTR(a, b);
+    db_release_cached(b);
+
+    db_stmt_cache_stats_t after = stats_now();
+    TEST_ASSERT_EQUAL_UINT64(before.prepares + 1, after.prepares);
+    TEST_ASSERT_EQUAL_UINT64(before.reuses + 1, after.reuses);
+    TEST_ASSERT_EQUAL_INT(1, after.cached);
+}
+
+/* Bindings from the previous user do not leak into the next one */
+void test_statement_is_reset_and_unbound(void) {
+    sqlite3_stmt *a = db_prepare_cached(SQL_ONE);
+    sqlite3_bind_int(a, 1, 41);
+    TEST_ASSERT_EQUAL_INT(SQLITE_ROW, sqlite3_step(a));
+    TEST_ASSERT_EQUAL_INT(42, sqlite3_column_int(a, 0));
+    db_release_cached(a);   /* released mid-result */
+
+    sqlite3_stmt *b = db_prepare_cached(SQL_ONE);
+    TEST_ASSERT_EQUAL_INT(SQLITE_ROW, sqlite3_step(b));
+    TEST_ASSERT_EQUAL_INT(SQLITE_NULL, sqlite3_column_type(b, 0));
+    db_release_cached(b);
+}
+
+/* A statement in use is never handed out twice */
+void test_concurrent_checkouts_get_copies(void) {
+    sqlite3_stmt *a = db_prepare_cached(SQL_ONE);
+    sqlite3_stmt *b = db_prepare_cached(SQL_ONE);
+    TEST_ASSERT_NOT_NULL(a);
+    TEST_ASSERT_NOT_NULL(b);
+    TEST_ASSERT_TRUE(a != b);
+
+    sqlite3_bind_int(a, 1, 1);
+    sqlite3_bind_int(b, 1, 10);
+    TEST_ASSERT_EQUAL_INT(SQLITE_ROW, sqlite3_step(a));
+    TEST_ASSERT_EQUAL_INT(SQLITE_ROW, sqlite3_step(b));
+    TEST_ASSERT_EQUAL_INT(2, sqlite3_column_int(a, 0));
+    TEST_ASSERT_EQUAL_INT(11, sqlite3_column_int(b, 0));
+
+    db_release_cached(a);
+    db_release_cached(b);
+    TEST_ASSERT_EQUAL_INT(2, stats_now().cached);
+}
+
+/* Invalidation empties the cache, including statements still checked out */
+void test_invalidate_finalizes_statements(void) {
+    sqlite3_stmt *idle = db_prepare_cached(SQL_ONE);
+    db_release_cached(idle);
+    sqlite3_stmt *held = db_prepare_cached("SELECT 2;");
+
+    uint64_t invalidations = stats_now().invalidations;
+    db_stmt_cache_invalidate();
+    TEST_ASSERT_EQUAL_UINT64(invalidations + 1, stats_now().invalidations);
+
+    /* The held statement stays usable until it is released */
+    TEST_ASSERT_EQUAL_INT(SQLITE_ROW, sqlite3_step(held));
+    TEST_ASSERT_EQUAL_INT(2, sqlite3_column_int(held, 0));
+    db_release_cached(held);
+    TEST_ASSERT_EQUAL_INT(0, stats_now().cached);
+
+    /* Nothing the cache prepared is left open on the connection */
+    TEST_ASSERT_NULL(sqlite3_next_stmt(get_db_handle(), NULL));
+}
+
+/* A query prepared before a schema change sees the new schema afterwards */
+void test_schema_change_after_invalidate(void) {
+    sqlite3 *db = get_db_handle();
+    const char *sql = "SELECT * FROM stmt_cache_t;";
+
+    sqlite3_exec(db, "DROP TABLE IF EXISTS stmt_cache_t;"
+                     "CREATE TABLE stmt_cache_t (a INTEGER);", NULL, NULL, NULL);
+    sqlite3_stmt *s = db_prepare_cached(sql);
+    TEST_ASSERT_EQUAL_INT(1, sqlite3_column_count(s));
+    db_release_cached(s);
+
+    sqlite3_exec(db, "ALTER TABLE stmt_cache_t ADD COLUMN b INTEGER;", NULL, NULL, NULL);
+    db_stmt_cache_invalidate();
+
+    s = db_prepare_cached(sql);
+    TEST_ASSERT_EQUAL_INT(2, sqlite3_column_count(s));
+    db_release_cached(s);
+}
+
+int main(void) {
+    unlink(TEST_DB_PATH);
+    if (init_database(TEST_DB_PATH) != 0) {
+        fprintf(stderr, "FATAL: init_database failed\n");
+        return 1;
+    }
+    UNITY_BEGIN();
+    RUN_TEST(test_release_then_prepare_reuses);
+    RUN_TEST(test_statement_is_reset_and_unbound);
+    RUN_TEST(test_concurrent_checkouts_get_copies);
+    RUN_TEST(test_invalidate_finalizes_statements);
+    RUN_TEST(test_schema_change_after_invalidate);
+    int result = UNITY_END();
+    shutdown_database();
+    unlink(TEST_DB_PATH);
+    return result;
+}
@@ -0,0 +1,306 @@
+/**
+ * @file test_db_stream_cache.c
+ * @brief Layer 2 — in-memory stream configuration cache
+ *
+ * Tests:
+ *   - writes through db_streams.c are visible in the cache and bump its version
+ *   - subscribers receive the field groups that changed
+ *   - adding and deleting a stream is reported as ADDED / REMOVED
+ *   - unsubscribed listeners are no longer called
+ *   - readers running concurrently with publishes always see a whole configuration
+ *   - stream_config_diff classifies fields into groups
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sqlite3.h>
+
+#include "unity.h"
+#include "core/config.h"
+#include "database/db_core.h"
+#include "database/db_streams.h"
+#include "database/db_stream_cache.h"
+#include "utils/strings.h"
+
+#define TEST_DB_PATH "/tmp/lightnvr_unit_stream_cache_test.db"
+#define MAX_RECORDED 16
+
+typedef struct {
+    int calls;
+    char names[MAX_RECORDED][MAX_STREAM_NAME];
+    uint32_t changed[MAX_RECORDED];
+    bool had_old[MAX_RECORDED];
+    bool had_new[MAX_RECORDED];
+} recorder_t;
+
+static void record_change(const char *name, const stream_config_t *old_config,
+                          const stream_config_t *new_config, uint32_t changed, void *user_data) {
+    recorder_t *r = user_data;
+    if (r->calls < MAX_RECORDED) {
+        safe_strcpy(r->names[r->calls], name, MAX_STREAM_NAME, 0);
+        r->changed[r->calls] = changed;
+        r->had_old[r->calls] = old_config != NULL;
+        r->had_new[r->calls] = new_config != NULL;
+    }
+    r->calls++;
+}
+
+static stream_config_t make_stream(const char *name) {
+    stream_config_t s;
+    memset(&s, 0, sizeof(s));
+    safe_strcpy(s.name, name, sizeof(s.name), 0);
+    safe_strcpy(s.url, "rtsp://camera/stream", sizeof(s.url), 0);
+    safe_strcpy(s.codec, "h264", sizeof(s.codec), 0);
+    s.enabled = true;
+    s.width = 1920;
+    s.height = 1080;
+    s.fps = 25;
+    s.priority = 5;
+    s.segment_duration = 60;
+    s.streaming_enabled = true;
+    s.detection_threshold = 0.5f;
+    safe_strcpy(s.detection_object_filter, "none", sizeof(s.detection_object_filter), 0);
+    s.tier_critical_multiplier = 3.0;
+    s.tier_important_multiplier = 2.0;
+    s.tier_ephemeral_multiplier = 0.25;
+    s.storage_priority = 5;
+    return s;
+}
+
+void setUp(void) {
+    sqlite3_exec(get_db_handle(), "DELETE FROM streams;", NULL, NULL, NULL);
+    load_stream_config_cache();
+}
+void tearDown(void) {}
+
+/* Writes go to the database and the cache; reads come from the cache */
+void test_write_is_visible_in_cache(void) {
+    TEST_ASSERT_TRUE(stream_config_cache_loaded());
+    uint64_t before = stream_config_cache_version();
+
+    stream_config_t s = make_stream("front");
+    TEST_ASSERT_TRUE(add_stream_config(&s) > 0);
+    TEST_ASSERT_TRUE(stream_config_cache_version() > before);
+    TEST_ASSERT_EQUAL_INT(1, stream_config_cache_count());
+
+    s.segment_duration = 120;
+    uint64_t after_add = stream_config_cache_version();
+    TEST_ASSERT_EQUAL_INT(0, update_stream_config("front", &s));
+    TEST_ASSERT_TRUE(stream_config_cache_version() > after_add);
+
+    stream_config_t got;
+    TEST_ASSERT_EQUAL_INT(0, stream_config_cache_get("front", &got));
+    TEST_ASSERT_EQUAL_INT(120, got.segment_duration);
+
+    /* The cache matches what is stored */
+    sqlite3_exec(get_db_handle(), "UPDATE streams SET segment_duration = 30 WHERE name = 'front';",
+                 NULL, NULL, NULL);
+    TEST_ASSERT_EQUAL_INT(0, get_stream_config_by_name("front", &got));
+    TEST_ASSERT_EQUAL_INT(120, got.segment_duration);
+    TEST_ASSERT_EQUAL_INT(0, reload_stream_config("front"));
+    TEST_ASSERT_EQUAL_INT(0, get_stream_config_by_name("front", &got));
+    TEST_ASSERT_EQUAL_INT(30, got.segment_duration);
+
+    /* Rewriting identical values does not publish */
+    uint64_t unchanged = stream_config_cache_version();
+    TEST_ASSERT_EQUAL_INT(0, reload_stream_config("front"));
+    TEST_ASSERT_EQUAL_UINT64(unchanged, stream_config_cache_version());
+}
+
+/* Subscribers see only the groups that changed */
+void test_subscriber_gets_changed_groups(void) {
+    stream_config_t s = make_stream("yard");
+    TEST_ASSERT_TRUE(add_stream_config(&s) > 0);
+
+    recorder_t r;
+    memset(&r, 0, sizeof(r));
+    int id = stream_config_subscribe(STREAM_CONFIG_CHANGED_ALL, record_change, &r);
+    TEST_ASSERT_TRUE(id > 0);
+
+    s.privacy_mode = true;
+    s.retention_days = 14;
+    TEST_ASSERT_EQUAL_INT(0, update_stream_config("yard", &s));
+
+    TEST_ASSERT_EQUAL_INT(1, r.calls);
+    TEST_ASSERT_EQUAL_STRING("yard", r.names[0]);
+    TEST_ASSERT_EQUAL_HEX32(STREAM_CONFIG_CHANGED_STATE | STREAM_CONFIG_CHANGED_RETENTION, r.changed[0]);
+    TEST_ASSERT_TRUE(r.had_old[0]);
+    TEST_ASSERT_TRUE(r.had_new[0]);
+
+    stream_retention_config_t rc = {.retention_days = 7, .detection_retention_days = 30, .max_storage_mb = 0};
+    TEST_ASSERT_EQUAL_INT(0, set_stream_retention_config("yard", &rc));
+    TEST_ASSERT_EQUAL_INT(2, r.calls);
+    TEST_ASSERT_EQUAL_HEX32(STREAM_CONFIG_CHANGED_RETENTION, r.changed[1]);
+
+    stream_config_unsubscribe(id);
+}
+
+/* A listener only hears about the groups in its mask */
+void test_subscriber_mask_filters_changes(void) {
+    stream_config_t s = make_stream("porch");
+    TEST_ASSERT_TRUE(add_stream_config(&s) > 0);
+
+    recorder_t r;
+    memset(&r, 0, sizeof(r));
+    int id = stream_config_subscribe(STREAM_CONFIG_CHANGED_VIDEO, record_change, &r);
+    TEST_ASSERT_TRUE(id > 0);
+
+    s.record_audio = true;
+    TEST_ASSERT_EQUAL_INT(0, update_stream_config("porch", &s));
+    TEST_ASSERT_EQUAL_INT(0, r.calls);
+
+    TEST_ASSERT_EQUAL_INT(0, update_stream_video_params("porch", 1280, 720, 15, "h265"));
+    TEST_ASSERT_EQUAL_INT(1, r.calls);
+    TEST_ASSERT_EQUAL_HEX32(STREAM_CONFIG_CHANGED_VIDEO, r.changed[0]);
+
+    stream_config_unsubscribe(id);
+}
+
+/* Adding and permanently deleting a stream */
+void test_add_and_remove_are_reported(void) {
+    recorder_t r;
+    memset(&r, 0, sizeof(r));
+    int id = stream_config_subscribe(STREAM_CONFIG_CHANGED_ADDED | STREAM_CONFIG_CHANGED_REMOVED,
+                                     record_change, &r);
+
+    stream_config_t s = make_stream("garage");
+    TEST_ASSERT_TRUE(add_stream_config(&s) > 0);
+    TEST_ASSERT_EQUAL_INT(1, r.calls);
+    TEST_ASSERT_EQUAL_HEX32(STREAM_CONFIG_CHANGED_ADDED, r.changed[0]);
+    TEST_ASSERT_FALSE(r.had_old[0]);
+
+    TEST_ASSERT_EQUAL_INT(0, delete_stream_config_internal("garage", true));
+    TEST_ASSERT_EQUAL_INT(2, r.calls);
+    TEST_ASSERT_EQUAL_HEX32(STREAM_CONFIG_CHANGED_REMOVED, r.changed[1]);
+    TEST_ASSERT_FALSE(r.had_new[1]);
+
+    stream_config_t got;
+    TEST_ASSERT_NOT_EQUAL(0, get_stream_config_by_name("garage", &got));
+    TEST_ASSERT_EQUAL_INT(0, count_stream_configs());
+
+    stream_config_unsubscribe(id);
+}
+
+/* No calls after unsubscribe */
+void test_unsubscribe_stops_notifications(void) {
+    recorder_t r;
+    memset(&r, 0, sizeof(r));
+    int id = stream_config_subscribe(STREAM_CONFIG_CHANGED_ALL, record_change, &r);
+    stream_config_unsubscribe(id);
+
+    stream_config_t s = make_stream("side");
+    TEST_ASSERT_TRUE(add_stream_config(&s) > 0);
+    TEST_ASSERT_EQUAL_INT(0, r.calls);
+}
+
+typedef struct {
+    atomic_bool stop;
+    atomic_int torn;
+    atomic_int reads;
+} reader_state_t;
+
+/* width and height are always published together, so width * 9 == height * 16 */
+static void check_aspect(const stream_config_t *config, void *user_data) {
+    reader_state_t *st = user_data;
+    if (config->width * 9 != config->height * 16) {
+        atomic_fetch_add(&st->torn, 1);
+    }
+}
+
+static void *reader_thread(void *arg) {
+    reader_state_t *st = arg;
+    stream_config_t copy;
+    while (!atomic_load(&st->stop)) {
+        if (stream_config_cache_get("race", &copy) == 0) {
+            check_aspect(&copy, st);
+        }
+        stream_config_cache_read("race", check_aspect, st);
+        atomic_fetch_add(&st->reads, 1);
+    }
+    return NULL;
+}
+
+/* Readers never see a freed or half-written configuration */
+void test_concurrent_readers_during_publish(void) {
+    stream_config_t s = make_stream("race");
+    s.width = 1600;
+    s.height = 900;
+    TEST_ASSERT_EQUAL_INT(0, stream_config_cache_publish("race", &s));
+
+    reader_state_t st;
+    atomic_init(&st.stop, false);
+    atomic_init(&st.torn, 0);
+    atomic_init(&st.reads, 0);
+
+    pthread_t readers[4];
+    for (int i = 0; i < 4; i++) {
+        pthread_create(&readers[i], NULL, reader_thread, &st);
+    }
+
+    for (int i = 1; i <= 2000; i++) {
+        s.width = 16 * (i % 200 + 1);
+        s.height = 9 * (i % 200 + 1);
+        TEST_ASSERT_EQUAL_INT(0, stream_config_cache_publish("race", &s));
+    }
+
+    atomic_store(&st.stop, true);
+    for (int i = 0; i < 4; i++) {
+        pthread_join(readers[i], NULL);
+    }
+
+    TEST_ASSERT_EQUAL_INT(0, atomic_load(&st.torn));
+    TEST_ASSERT_TRUE(atomic_load(&st.reads) > 0);
+}
+
+/* Field groups */
+void test_diff_classifies_fields(void) {
+    stream_config_t a = make_stream("diff");
+    stream_config_t b = a;
+
+    TEST_ASSERT_EQUAL_HEX32(0, stream_config_diff(&a, &b));
+    TEST_ASSERT_EQUAL_HEX32(STREAM_CONFIG_CHANGED_ADDED, stream_config_diff(NULL, &b));
+    TEST_ASSERT_EQUAL_HEX32(STREAM_CONFIG_CHANGED_REMOVED, stream_config_diff(&a, NULL));
+
+    safe_strcpy(b.url, "rtsp://camera/other", sizeof(b.url), 0);
+    TEST_ASSERT_EQUAL_HEX32(STREAM_CONFIG_CHANGED_SOURCE, stream_config_diff(&a, &b));
+
+    b = a;
+    b.recording_schedule[30] = 1;
+    TEST_ASSERT_EQUAL_HEX32(STREAM_CONFIG_CHANGED_RECORDING, stream_config_diff(&a, &b));
+
+    b = a;
+    b.detection_threshold = 0.7f;
+    b.ptz_enabled = true;
+    TEST_ASSERT_EQUAL_HEX32(STREAM_CONFIG_CHANGED_DETECTION | STREAM_CONFIG_CHANGED_PTZ,
+                            stream_config_diff(&a, &b));
+
+    b = a;
+    safe_strcpy(b.tags, "outdoor", sizeof(b.tags), 0);
+    TEST_ASSERT_EQUAL_HEX32(STREAM_CONFIG_CHANGED_OTHER, stream_config_diff(&a, &b));
+}
+
+int main(void) {
+    unlink(TEST_DB_PATH);
+    if (init_database(TEST_DB_PATH) != 0) {
+        fprintf(stderr, "FATAL: init_database failed\n");
+        return 1;
+    }
+
+    UNITY_BEGIN();
+    RUN_TEST(test_write_is_visible_in_cache);
+    RUN_TEST(test_subscriber_gets_changed_groups);
+    RUN_TEST(test_subscriber_mask_filters_changes);
+    RUN_TEST(test_add_and_remove_are_reported);
+    RUN_TEST(test_unsubscribe_stops_notifications);
+    RUN_TEST(test_concurrent_readers_during_publish);
+    RUN_TEST(test_diff_classifies_fields);
+    int result = UNITY_END();
+    shutdown_database();
+    unlink(TEST_DB_PATH);
+    return result;
+}
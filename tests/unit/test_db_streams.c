@@ -21,6 +21,7 @@
 #include "database/db_core.h"
 #include "database/db_streams.h"
 #include "utils/strings.h"
+#include "test_stream_fixtures.h"
 
 #define TEST_DB_PATH "/tmp/lightnvr_unit_streams_test.db"
 
@@ -50,11 +51,6 @@ static stream_config_t make_stream(const char *name, bool enabled) {
     return s;
 }
 
-static void clear_streams(void) {
-    sqlite3 *db = get_db_handle();
-    sqlite3_exec(db, "DELETE FROM streams;", NULL, NULL, NULL);
-}
-
 static void exec_sql_or_fail(sqlite3 *db, const char *sql) {
     char *err = NULL;
     int rc = sqlite3_exec(db, sql, NULL, NULL, &err);
@@ -66,7 +62,7 @@ static void exec_sql_or_fail(sqlite3 *db, const char *sql) {
 }
 
 /* ---- Unity boilerplate ---- */
-void setUp(void)    { clear_streams(); }
+void setUp(void)    { test_clear_streams(); }
 void tearDown(void) {}
 
 /* ================================================================
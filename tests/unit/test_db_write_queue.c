@@ -0,0 +1,234 @@
+/**
+ * @file test_db_write_queue.c
+ * @brief Layer 2 — write-behind queue for detections, events and recording updates
+ *
+ * Tests:
+ *   - queued writes commit on flush, not on the caller's thread
+ *   - a full batch commits without waiting for the interval
+ *   - a failing write is rolled back without losing the rest of its batch
+ *   - keyed recording progress updates merge into one queued write
+ *   - completions commit at once and stale progress updates cannot reopen them
+ *   - queue_event timestamps the event when it is queued
+ *   - shutdown commits pending writes, and writes are synchronous afterwards
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sqlite3.h>
+
+#include "unity.h"
+#include "core/config.h"
+#include "database/db_core.h"
+#include "database/db_events.h"
+#include "database/db_recordings.h"
+#include "database/db_write_queue.h"
+
+#define TEST_DB_PATH "/tmp/lightnvr_unit_write_queue_test.db"
+#define TEST_BATCH_ROWS 8
+
+static void sleep_ms(int ms) {
+    struct timespec ts = {ms / 1000, (long)(ms % 1000) * 1000000L};
+    nanosleep(&ts, NULL);
+}
+
+static db_write_queue_stats_t stats_now(void) {
+    db_write_queue_stats_t s;
+    db_write_queue_get_stats(&s);
+    return s;
+}
+
+static int count_sql(const char *sql) {
+    sqlite3_stmt *stmt = NULL;
+    int count = -1;
+    if (sqlite3_prepare_v2(get_db_handle(), sql, -1, &stmt, NULL) == SQLITE_OK &&
+        sqlite3_step(stmt) == SQLITE_ROW) {
+        count = sqlite3_column_int(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+    return count;
+}
+
+/* Inserts its payload into queue_t; negative values fail after inserting */
+static int insert_value(sqlite3 *db, const void *payload) {
+    int v = *(const int *)payload;
+    char sql[64];
+    snprintf(sql, sizeof(sql), "INSERT INTO queue_t (v) VALUES (%d);", v);
+    if (sqlite3_exec(db, sql, NULL, NULL, NULL) != SQLITE_OK) {
+        return -1;
+    }
+    return v < 0 ? -1 : 0;
+}
+
+static void submit_value(int v) {
+    TEST_ASSERT_EQUAL_INT(0, db_write_queue_submit(insert_value, &v, sizeof(v)));
+}
+
+void setUp(void) {
+    db_write_queue_flush();
+    sqlite3_exec(get_db_handle(), "DELETE FROM queue_t;", NULL, NULL, NULL);
+}
+void tearDown(void) {}
+
+/* Writes wait for the batch interval unless flushed */
+void test_flush_commits_queued_writes(void) {
+    db_write_queue_stats_t before = stats_now();
+
+    submit_value(1);
+    submit_value(2);
+    TEST_ASSERT_EQUAL_INT(0, count_sql("SELECT COUNT(*) FROM queue_t;"));
+    TEST_ASSERT_EQUAL_INT(2, stats_now().depth);
+
+    db_write_queue_flush();
+    TEST_ASSERT_EQUAL_INT(2, count_sql("SELECT COUNT(*) FROM queue_t;"));
+
+    db_write_queue_stats_t after = stats_now();
+    TEST_ASSERT_EQUAL_INT(0, after.depth);
+    TEST_ASSERT_EQUAL_UINT64(before.committed + 2, after.committed);
+    TEST_ASSERT_EQUAL_UINT64(before.batches + 1, after.batches);
+}
+
+/* Reaching write_batch_max_rows commits without a flush */
+void test_full_batch_commits_early(void) {
+    for (int i = 0; i < TEST_BATCH_ROWS; i++) {
+        submit_value(i);
+    }
+    for (int i = 0; i < 100 && count_sql("SELECT COUNT(*) FROM queue_t;") < TEST_BATCH_ROWS; i++) {
+        sleep_ms(10);
+    }
+    TEST_ASSERT_EQUAL_INT(TEST_BATCH_ROWS, count_sql("SELECT COUNT(*) FROM queue_t;"));
+}
+
+/* Only the failing write is rolled back */
+void test_failed_write_keeps_rest_of_batch(void) {
+    db_write_queue_stats_t before = stats_now();
+
+    submit_value(1);
+    submit_value(-1);
+    submit_value(3);
+    db_write_queue_flush();
+
+    TEST_ASSERT_EQUAL_INT(2, count_sql("SELECT COUNT(*) FROM queue_t;"));
+    TEST_ASSERT_EQUAL_INT(0, count_sql("SELECT COUNT(*) FROM queue_t WHERE v < 0;"));
+    TEST_ASSERT_EQUAL_UINT64(before.failed + 1, stats_now().failed);
+}
+
+static uint64_t add_test_recording(const char *path) {
+    recording_metadata_t m;
+    memset(&m, 0, sizeof(m));
+    strcpy(m.stream_name, "front");
+    strcpy(m.file_path, path);
+    strcpy(m.trigger_type, "scheduled");
+    m.start_time = 1000;
+    m.retention_override_days = -1;
+    uint64_t id = add_recording_metadata(&m);
+    TEST_ASSERT_TRUE(id > 0);
+    return id;
+}
+
+/* Progress updates for one recording merge into one queued write */
+void test_recording_updates_coalesce(void) {
+    uint64_t id = add_test_recording("/tmp/front.mp4");
+
+    db_write_queue_stats_t before = stats_now();
+    update_recording_metadata(id, 1010, 100, false);
+    update_recording_metadata(id, 1020, 200, false);
+    update_recording_metadata(id, 0, 300, false);     // Size only, end time unknown
+
+    db_write_queue_stats_t queued = stats_now();
+    TEST_ASSERT_EQUAL_UINT64(before.coalesced + 2, queued.coalesced);
+    TEST_ASSERT_EQUAL_INT(1, queued.depth);
+
+    db_write_queue_flush();
+    recording_metadata_t got;
+    TEST_ASSERT_EQUAL_INT(0, get_recording_metadata_by_id(id, &got));
+    TEST_ASSERT_EQUAL_INT64(1020, got.end_time);
+    TEST_ASSERT_EQUAL_UINT64(300, got.size_bytes);
+    TEST_ASSERT_FALSE(got.is_complete);
+}
+
+/* A completion commits at once and a stale size sync cannot reopen it */
+void test_completion_survives_stale_size_sync(void) {
+    uint64_t id = add_test_recording("/tmp/front_complete.mp4");
+
+    update_recording_metadata(id, 1010, 100, false);
+    TEST_ASSERT_EQUAL_INT(1, stats_now().depth);
+
+    /* Stale view of the row, as the size sync thread reads it before completion */
+    recording_metadata_t stale;
+    TEST_ASSERT_EQUAL_INT(0, get_recording_metadata_by_id(id, &stale));
+    TEST_ASSERT_FALSE(stale.is_complete);
+
+    TEST_ASSERT_EQUAL_INT(0, update_recording_metadata(id, 1060, 500, true));
+    TEST_ASSERT_EQUAL_INT(0, stats_now().depth);
+
+    recording_metadata_t got;
+    TEST_ASSERT_EQUAL_INT(0, get_recording_metadata_by_id(id, &got));
+    TEST_ASSERT_TRUE(got.is_complete);
+    TEST_ASSERT_EQUAL_INT64(1060, got.end_time);
+
+    /* The sync writes back what it read, with the size it found on disk */
+    update_recording_metadata(id, stale.end_time, 600, stale.is_complete);
+    db_write_queue_flush();
+
+    TEST_ASSERT_EQUAL_INT(0, get_recording_metadata_by_id(id, &got));
+    TEST_ASSERT_TRUE(got.is_complete);
+    TEST_ASSERT_EQUAL_INT64(1060, got.end_time);
+    TEST_ASSERT_EQUAL_UINT64(600, got.size_bytes);
+}
+
+/* The event keeps the time it was queued, not the time it was committed */
+void test_queue_event_keeps_timestamp(void) {
+    time_t queued_at = time(NULL);
+    TEST_ASSERT_EQUAL_INT(0, queue_event(EVENT_RECORDING_START, "front", "Recording started", NULL));
+    db_write_queue_flush();
+
+    event_info_t events[4];
+    int n = get_events(queued_at - 1, queued_at + 1, EVENT_RECORDING_START, "front", events, 4);
+    TEST_ASSERT_EQUAL_INT(1, n);
+    TEST_ASSERT_EQUAL_STRING("Recording started", events[0].description);
+    TEST_ASSERT_TRUE(events[0].timestamp >= queued_at && events[0].timestamp <= queued_at + 1);
+}
+
+/* Stopping the queue commits what is pending; later writes are synchronous */
+void test_shutdown_commits_pending(void) {
+    submit_value(1);
+    submit_value(2);
+    db_write_queue_shutdown();
+    TEST_ASSERT_EQUAL_INT(2, count_sql("SELECT COUNT(*) FROM queue_t;"));
+
+    submit_value(3);
+    TEST_ASSERT_EQUAL_INT(3, count_sql("SELECT COUNT(*) FROM queue_t;"));
+    TEST_ASSERT_EQUAL_INT(0, stats_now().depth);
+
+    TEST_ASSERT_EQUAL_INT(0, db_write_queue_init());
+}
+
+int main(void) {
+    unlink(TEST_DB_PATH);
+    g_config.db_write_queue = true;
+    g_config.db_write_batch_interval_ms = 10000;
+    g_config.db_write_batch_max_rows = TEST_BATCH_ROWS;
+    g_config.db_write_queue_capacity = 64;
+    if (init_database(TEST_DB_PATH) != 0) {
+        fprintf(stderr, "FATAL: init_database failed\n");
+        return 1;
+    }
+    sqlite3_exec(get_db_handle(), "CREATE TABLE queue_t (v INTEGER);", NULL, NULL, NULL);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_flush_commits_queued_writes);
+    RUN_TEST(test_full_batch_commits_early);
+    RUN_TEST(test_failed_write_keeps_rest_of_batch);
+    RUN_TEST(test_recording_updates_coalesce);
+    RUN_TEST(test_completion_survives_stale_size_sync);
+    RUN_TEST(test_queue_event_keeps_timestamp);
+    RUN_TEST(test_shutdown_commits_pending);
+    int result = UNITY_END();
+    shutdown_database();
+    unlink(TEST_DB_PATH);
+    return result;
+}
@@ -19,6 +19,7 @@
 #include "database/db_core.h"
 #include "database/db_zones.h"
 #include "database/db_streams.h"
+#include "test_stream_fixtures.h"
 
 #define TEST_DB_PATH "/tmp/lightnvr_unit_zones_test.db"
 
@@ -61,7 +62,7 @@ static void ensure_test_stream(const char *stream_name) {
 
 void setUp(void) {
     sqlite3_exec(get_db_handle(), "DELETE FROM detection_zones;", NULL, NULL, NULL);
-    sqlite3_exec(get_db_handle(), "DELETE FROM streams;",         NULL, NULL, NULL);
+    test_clear_streams();
     ensure_test_stream("cam1");
 }
 void tearDown(void) {}
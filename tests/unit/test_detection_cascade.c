@@ -0,0 +1,171 @@
+/**
+ * @file test_detection_cascade.c
+ * @brief Layer 2 unit tests — multi-stage detection cascades
+ *
+ * Tests:
+ *   detection_cascade_parse             — stage kinds, ordering rules, paths
+ *   detection_cascade_filter_by_regions — gating by previous-stage regions
+ *   detection_cascade_record_run/hit    — per-stage counters
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <string.h>
+
+#include "unity.h"
+#include "core/config.h"
+#include "utils/strings.h"
+#include "video/detection_cascade.h"
+
+/* ---- helpers ---- */
+
+static void add_det(detection_result_t *r, float x, float y, float w, float h) {
+    detection_t *d = &r->detections[r->count++];
+    memset(d, 0, sizeof(*d));
+    safe_strcpy(d->label, "person", MAX_LABEL_LENGTH, 0);
+    d->x = x;
+    d->y = y;
+    d->width = w;
+    d->height = h;
+    d->confidence = 0.9f;
+}
+
+/* ---- Unity boilerplate ---- */
+void setUp(void) {
+    detection_cascade_reset_stats(NULL);
+}
+void tearDown(void) {}
+
+/* ================================================================
+ * detection_cascade_parse
+ * ================================================================ */
+
+void test_parse_three_stage_cascade(void) {
+    detection_cascade_t c;
+    TEST_ASSERT_TRUE(is_detection_cascade("cascade:motion,tiny.sod,api-detection"));
+    TEST_ASSERT_EQUAL_INT(0, detection_cascade_parse("cascade:motion, tiny.sod ,api-detection",
+                                                     "/var/lib/lightnvr/models", &c));
+    TEST_ASSERT_EQUAL_INT(3, c.stage_count);
+    TEST_ASSERT_EQUAL_INT(CASCADE_STAGE_MOTION, c.stages[0].kind);
+    TEST_ASSERT_EQUAL_INT(CASCADE_STAGE_MODEL, c.stages[1].kind);
+    TEST_ASSERT_EQUAL_STRING("/var/lib/lightnvr/models/tiny.sod", c.stages[1].model_path);
+    TEST_ASSERT_EQUAL_STRING("tiny.sod", c.stages[1].name);
+    TEST_ASSERT_EQUAL_INT(CASCADE_STAGE_API, c.stages[2].kind);
+    TEST_ASSERT_EQUAL_STRING("api-detection", c.stages[2].model_path);
+    TEST_ASSERT_TRUE(detection_cascade_has_stage(&c, CASCADE_STAGE_MOTION));
+    TEST_ASSERT_FALSE(detection_cascade_has_stage(&c, CASCADE_STAGE_FRAME_BUS));
+}
+
+void test_parse_absolute_model_and_frame_bus(void) {
+    detection_cascade_t c;
+    TEST_ASSERT_EQUAL_INT(0, detection_cascade_parse("cascade:/opt/m/a.sod,frame-bus", "/models", &c));
+    TEST_ASSERT_EQUAL_INT(2, c.stage_count);
+    TEST_ASSERT_EQUAL_STRING("/opt/m/a.sod", c.stages[0].model_path);
+    TEST_ASSERT_EQUAL_STRING("a.sod", c.stages[0].name);
+    TEST_ASSERT_EQUAL_INT(CASCADE_STAGE_FRAME_BUS, c.stages[1].kind);
+}
+
+void test_parse_url_stage(void) {
+    detection_cascade_t c;
+    TEST_ASSERT_EQUAL_INT(0, detection_cascade_parse("cascade:motion,http://det:9001/detect", "/models", &c));
+    TEST_ASSERT_EQUAL_INT(CASCADE_STAGE_API, c.stages[1].kind);
+    TEST_ASSERT_EQUAL_STRING("http://det:9001/detect", c.stages[1].model_path);
+}
+
+void test_parse_rejects_invalid(void) {
+    detection_cascade_t c;
+    TEST_ASSERT_FALSE(is_detection_cascade("motion"));
+    TEST_ASSERT_EQUAL_INT(-1, detection_cascade_parse("motion", "/models", &c));
+    TEST_ASSERT_EQUAL_INT(-1, detection_cascade_parse("cascade:motion", "/models", &c));
+    TEST_ASSERT_EQUAL_INT(-1, detection_cascade_parse("cascade:a.sod,motion", "/models", &c));
+    TEST_ASSERT_EQUAL_INT(-1, detection_cascade_parse("cascade:api-detection,a.sod", "/models", &c));
+    TEST_ASSERT_EQUAL_INT(-1, detection_cascade_parse("cascade:motion,onvif", "/models", &c));
+    TEST_ASSERT_EQUAL_INT(-1, detection_cascade_parse("cascade:motion,a,b,c,d", "/models", &c));
+    TEST_ASSERT_EQUAL_INT(-1, detection_cascade_parse("cascade: , ,", "/models", &c));
+}
+
+/* ================================================================
+ * detection_cascade_filter_by_regions
+ * ================================================================ */
+
+void test_filter_keeps_overlapping_detections(void) {
+    detection_result_t regions = {0};
+    detection_result_t result = {0};
+    add_det(&regions, 0.0f, 0.0f, 0.25f, 0.25f);
+    add_det(&result, 0.1f, 0.1f, 0.2f, 0.2f);    /* mostly inside */
+    add_det(&result, 0.6f, 0.6f, 0.2f, 0.2f);    /* outside */
+    add_det(&result, 0.24f, 0.24f, 0.2f, 0.2f);  /* sliver: < 10% overlap */
+
+    TEST_ASSERT_EQUAL_INT(1, detection_cascade_filter_by_regions(&result, &regions));
+    TEST_ASSERT_EQUAL_INT(1, result.count);
+    TEST_ASSERT_EQUAL_FLOAT(0.1f, result.detections[0].x);
+}
+
+void test_filter_empty_regions_drops_all(void) {
+    detection_result_t regions = {0};
+    detection_result_t result = {0};
+    add_det(&result, 0.1f, 0.1f, 0.2f, 0.2f);
+    TEST_ASSERT_EQUAL_INT(0, detection_cascade_filter_by_regions(&result, &regions));
+}
+
+/* ================================================================
+ * Stage counters
+ * ================================================================ */
+
+void test_stats_record_and_get(void) {
+    detection_cascade_t c;
+    TEST_ASSERT_EQUAL_INT(0, detection_cascade_parse("cascade:motion,tiny.sod", "/models", &c));
+
+    detection_cascade_record_run("cam1", &c, 0, true, 100);
+    detection_cascade_record_run("cam1", &c, 0, false, 50);
+    detection_cascade_record_run("cam1", &c, 1, false, 2000);
+    detection_cascade_record_hit("cam1", 1);
+
+    cascade_stage_stats_t st[DETECTION_CASCADE_MAX_STAGES];
+    TEST_ASSERT_EQUAL_INT(2, detection_cascade_get_stats("cam1", st, DETECTION_CASCADE_MAX_STAGES));
+    TEST_ASSERT_EQUAL_STRING("motion", st[0].name);
+    TEST_ASSERT_EQUAL_UINT64(2, st[0].runs);
+    TEST_ASSERT_EQUAL_UINT64(1, st[0].hits);
+    TEST_ASSERT_EQUAL_UINT64(150, st[0].total_us);
+    TEST_ASSERT_EQUAL_STRING("tiny.sod", st[1].name);
+    TEST_ASSERT_EQUAL_UINT64(1, st[1].runs);
+    TEST_ASSERT_EQUAL_UINT64(1, st[1].hits);
+
+    TEST_ASSERT_EQUAL_INT(0, detection_cascade_get_stats("cam2", st, DETECTION_CASCADE_MAX_STAGES));
+}
+
+void test_stats_reset_when_cascade_changes(void) {
+    detection_cascade_t a;
+    detection_cascade_t b;
+    TEST_ASSERT_EQUAL_INT(0, detection_cascade_parse("cascade:motion,tiny.sod", "/models", &a));
+    TEST_ASSERT_EQUAL_INT(0, detection_cascade_parse("cascade:motion,big.sod", "/models", &b));
+
+    detection_cascade_record_run("cam1", &a, 0, true, 10);
+    detection_cascade_record_run("cam1", &b, 1, true, 10);
+
+    cascade_stage_stats_t st[DETECTION_CASCADE_MAX_STAGES];
+    TEST_ASSERT_EQUAL_INT(2, detection_cascade_get_stats("cam1", st, DETECTION_CASCADE_MAX_STAGES));
+    TEST_ASSERT_EQUAL_STRING("big.sod", st[1].name);
+    TEST_ASSERT_EQUAL_UINT64(0, st[0].runs);
+    TEST_ASSERT_EQUAL_UINT64(1, st[1].runs);
+
+    detection_cascade_reset_stats("cam1");
+    TEST_ASSERT_EQUAL_INT(0, detection_cascade_get_stats("cam1", st, DETECTION_CASCADE_MAX_STAGES));
+}
+
+/* ================================================================
+ * main
+ * ================================================================ */
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_parse_three_stage_cascade);
+    RUN_TEST(test_parse_absolute_model_and_frame_bus);
+    RUN_TEST(test_parse_url_stage);
+    RUN_TEST(test_parse_rejects_invalid);
+    RUN_TEST(test_filter_keeps_overlapping_detections);
+    RUN_TEST(test_filter_empty_regions_drops_all);
+    RUN_TEST(test_stats_record_and_get);
+    RUN_TEST(test_stats_reset_when_cascade_changes);
+    return UNITY_END();
+}
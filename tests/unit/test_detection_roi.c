@@ -0,0 +1,182 @@
+/**
+ * @file test_detection_roi.c
+ * @brief Layer 2 unit tests — region-of-interest cropping for detection models
+ *
+ * Tests:
+ *   detection_roi_plan         — padding, minimum size, merging, coverage fallback
+ *   detection_roi_crop         — pixel copy
+ *   detection_roi_map_to_frame — crop to frame coordinates
+ *   detection_roi_merge        — duplicate suppression across crops
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <string.h>
+
+#include "unity.h"
+#include "core/config.h"
+#include "utils/strings.h"
+#include "video/detection_roi.h"
+
+/* ---- helpers ---- */
+
+static void add_det(detection_result_t *r, const char *label, float conf,
+                    float x, float y, float w, float h) {
+    detection_t *d = &r->detections[r->count++];
+    memset(d, 0, sizeof(*d));
+    safe_strcpy(d->label, label, MAX_LABEL_LENGTH, 0);
+    d->confidence = conf;
+    d->x = x;
+    d->y = y;
+    d->width = w;
+    d->height = h;
+}
+
+/* ---- Unity boilerplate ---- */
+void setUp(void) {
+    g_config.roi_cropping = true;
+    g_config.roi_max_regions = 4;
+    g_config.roi_padding = 0;
+    g_config.roi_max_coverage = 60;
+}
+void tearDown(void) {}
+
+/* ================================================================
+ * detection_roi_plan
+ * ================================================================ */
+
+void test_plan_single_region(void) {
+    detection_result_t regions = {0};
+    detection_roi_t rois[DETECTION_ROI_MAX_REGIONS];
+    add_det(&regions, "zone", 1.0f, 0.5f, 0.5f, 0.25f, 0.25f);
+
+    TEST_ASSERT_EQUAL_INT(1, detection_roi_plan(&regions, 1920, 1080, rois));
+    TEST_ASSERT_EQUAL_INT(960, rois[0].x);
+    TEST_ASSERT_EQUAL_INT(540, rois[0].y);
+    TEST_ASSERT_EQUAL_INT(480, rois[0].width);
+    TEST_ASSERT_EQUAL_INT(270, rois[0].height);
+}
+
+void test_plan_padding_is_clamped_to_frame(void) {
+    detection_result_t regions = {0};
+    detection_roi_t rois[DETECTION_ROI_MAX_REGIONS];
+    g_config.roi_padding = 50;
+    add_det(&regions, "zone", 1.0f, 0.0f, 0.0f, 0.2f, 0.2f);
+
+    TEST_ASSERT_EQUAL_INT(1, detection_roi_plan(&regions, 1000, 1000, rois));
+    TEST_ASSERT_EQUAL_INT(0, rois[0].x);
+    TEST_ASSERT_EQUAL_INT(0, rois[0].y);
+    TEST_ASSERT_EQUAL_INT(300, rois[0].width);
+    TEST_ASSERT_EQUAL_INT(300, rois[0].height);
+}
+
+void test_plan_grows_tiny_regions(void) {
+    detection_result_t regions = {0};
+    detection_roi_t rois[DETECTION_ROI_MAX_REGIONS];
+    add_det(&regions, "motion", 1.0f, 0.995f, 0.5f, 0.005f, 0.005f);
+
+    TEST_ASSERT_EQUAL_INT(1, detection_roi_plan(&regions, 1920, 1080, rois));
+    TEST_ASSERT_EQUAL_INT(135, rois[0].width);   /* 1080 / 8 */
+    TEST_ASSERT_EQUAL_INT(135, rois[0].height);
+    TEST_ASSERT_EQUAL_INT(1920, rois[0].x + rois[0].width);  /* shifted back inside */
+}
+
+void test_plan_merges_overlapping_regions(void) {
+    detection_result_t regions = {0};
+    detection_roi_t rois[DETECTION_ROI_MAX_REGIONS];
+    add_det(&regions, "motion", 1.0f, 0.1f, 0.1f, 0.2f, 0.2f);
+    add_det(&regions, "motion", 1.0f, 0.2f, 0.2f, 0.2f, 0.2f);
+    add_det(&regions, "motion", 1.0f, 0.7f, 0.7f, 0.1f, 0.1f);
+
+    TEST_ASSERT_EQUAL_INT(2, detection_roi_plan(&regions, 1000, 1000, rois));
+}
+
+void test_plan_respects_max_regions(void) {
+    detection_result_t regions = {0};
+    detection_roi_t rois[DETECTION_ROI_MAX_REGIONS];
+    g_config.roi_max_regions = 2;
+    g_config.roi_max_coverage = 100;
+    add_det(&regions, "motion", 1.0f, 0.0f, 0.0f, 0.1f, 0.1f);
+    add_det(&regions, "motion", 1.0f, 0.15f, 0.0f, 0.1f, 0.1f);
+    add_det(&regions, "motion", 1.0f, 0.8f, 0.8f, 0.1f, 0.1f);
+
+    TEST_ASSERT_EQUAL_INT(2, detection_roi_plan(&regions, 1000, 1000, rois));
+}
+
+void test_plan_falls_back_to_full_frame(void) {
+    detection_result_t regions = {0};
+    detection_roi_t rois[DETECTION_ROI_MAX_REGIONS];
+
+    /* Nothing to crop to */
+    TEST_ASSERT_EQUAL_INT(0, detection_roi_plan(&regions, 1000, 1000, rois));
+
+    /* Crops would cover most of the frame */
+    add_det(&regions, "zone", 1.0f, 0.0f, 0.0f, 0.9f, 0.9f);
+    TEST_ASSERT_EQUAL_INT(0, detection_roi_plan(&regions, 1000, 1000, rois));
+
+    /* Disabled */
+    regions.count = 0;
+    add_det(&regions, "zone", 1.0f, 0.1f, 0.1f, 0.2f, 0.2f);
+    g_config.roi_cropping = false;
+    TEST_ASSERT_EQUAL_INT(0, detection_roi_plan(&regions, 1000, 1000, rois));
+}
+
+/* ================================================================
+ * Crop, map and merge
+ * ================================================================ */
+
+void test_crop_copies_rows(void) {
+    uint8_t frame[4 * 3 * 3];
+    for (int i = 0; i < (int)sizeof(frame); i++) frame[i] = (uint8_t)i;
+    detection_roi_t roi = {1, 1, 2, 2};
+    uint8_t crop[2 * 2 * 3];
+
+    detection_roi_crop(frame, 4, 3, &roi, crop);
+    TEST_ASSERT_EQUAL_UINT8(15, crop[0]);   /* row 1, col 1 */
+    TEST_ASSERT_EQUAL_UINT8(20, crop[5]);   /* row 1, col 2, last channel */
+    TEST_ASSERT_EQUAL_UINT8(27, crop[6]);   /* row 2, col 1 */
+}
+
+void test_map_to_frame(void) {
+    detection_result_t r = {0};
+    detection_roi_t roi = {500, 250, 500, 250};
+    add_det(&r, "person", 0.9f, 0.5f, 0.0f, 0.5f, 1.0f);
+
+    detection_roi_map_to_frame(&r, &roi, 1000, 1000);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 0.75f, r.detections[0].x);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 0.25f, r.detections[0].y);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 0.25f, r.detections[0].width);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 0.25f, r.detections[0].height);
+}
+
+void test_merge_suppresses_duplicates(void) {
+    detection_result_t dst = {0};
+    detection_result_t src = {0};
+    add_det(&dst, "person", 0.6f, 0.40f, 0.40f, 0.10f, 0.20f);
+    add_det(&src, "person", 0.8f, 0.41f, 0.40f, 0.10f, 0.20f);  /* same object */
+    add_det(&src, "car", 0.7f, 0.41f, 0.40f, 0.10f, 0.20f);     /* other label */
+    add_det(&src, "person", 0.5f, 0.80f, 0.10f, 0.10f, 0.20f);  /* elsewhere */
+
+    detection_roi_merge(&dst, &src);
+    TEST_ASSERT_EQUAL_INT(3, dst.count);
+    TEST_ASSERT_EQUAL_FLOAT(0.8f, dst.detections[0].confidence);
+    TEST_ASSERT_EQUAL_STRING("car", dst.detections[1].label);
+}
+
+/* ================================================================
+ * main
+ * ================================================================ */
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_plan_single_region);
+    RUN_TEST(test_plan_padding_is_clamped_to_frame);
+    RUN_TEST(test_plan_grows_tiny_regions);
+    RUN_TEST(test_plan_merges_overlapping_regions);
+    RUN_TEST(test_plan_respects_max_regions);
+    RUN_TEST(test_plan_falls_back_to_full_frame);
+    RUN_TEST(test_crop_copies_rows);
+    RUN_TEST(test_map_to_frame);
+    RUN_TEST(test_merge_suppresses_duplicates);
+    return UNITY_END();
+}
@@ -0,0 +1,383 @@
+/**
+ * @file test_frame_bus.c
+ * @brief Layer 2 unit tests — shared-memory frame bus for local detectors
+ *
+ * Tests:
+ *   frame_bus_publish / _set_result_handler — against an in-process stub
+ *   detector that attaches over the Unix socket, reads frames from the
+ *   memfd ring and posts results back
+ */
+
+#define _GNU_SOURCE
+
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#include "unity.h"
+#include "core/config.h"
+#include "video/frame_bus.h"
+
+#define TEST_SLOTS 3
+#define TEST_MAX_FRAME_BYTES (64 * 48 * 3)
+
+static char socket_path[108];
+
+/* ---- stub detector ---- */
+
+typedef struct {
+    int sock;
+    int event_fd;
+    uint8_t *ring;
+    size_t ring_size;
+    int slot_count;
+    size_t slot_stride;
+    pthread_t thread;
+    atomic_int stop;
+    atomic_int frames_seen;
+} stub_detector_t;
+
+static int stub_attach(stub_detector_t *d, const char *stream) {
+    memset(d, 0, sizeof(*d));
+    d->sock = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+    if (d->sock < 0) return -1;
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, socket_path);
+    if (connect(d->sock, (struct sockaddr *)&addr, sizeof(addr)) != 0) return -1;
+
+    char msg[128];
+    snprintf(msg, sizeof(msg), "ATTACH %s", stream);
+    if (send(d->sock, msg, strlen(msg), 0) < 0) return -1;
+
+    char reply[256];
+    union {
+        struct cmsghdr align;
+        char buf[CMSG_SPACE(sizeof(int) * 2)];
+    } control;
+    struct iovec iov = { .iov_base = reply, .iov_len = sizeof(reply) - 1 };
+    struct msghdr mh;
+    memset(&mh, 0, sizeof(mh));
+    mh.msg_iov = &iov;
+    mh.msg_iovlen = 1;
+    mh.msg_control = control.buf;
+    mh.msg_controllen = sizeof(control.buf);
+
+    ssize_t n = recvmsg(d->sock, &mh, 0);
+    if (n <= 0) return -1;
+    reply[n] = '\0';
+    if (strncmp(reply, "OK ", 3) != 0) return -1;
+
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&mh);
+    if (!cmsg || cmsg->cmsg_type != SCM_RIGHTS) return -1;
+    int fds[2];
+    memcpy(fds, CMSG_DATA(cmsg), sizeof(fds));
+    d->event_fd = fds[1];
+
+    unsigned long max_bytes = 0;
+    if (sscanf(reply, "OK %d %zu %lu", &d->slot_count, &d->slot_stride, &max_bytes) != 3) return -1;
+
+    struct stat st;
+    fstat(fds[0], &st);
+    d->ring_size = (size_t)st.st_size;
+    d->ring = mmap(NULL, d->ring_size, PROT_READ, MAP_SHARED, fds[0], 0);
+    close(fds[0]);
+    return d->ring == MAP_FAILED ? -1 : 0;
+}
+
+/* Copy the newest frame with the seqlock protocol; returns its seq or 0 */
+static uint64_t stub_read_newest(stub_detector_t *d, uint8_t *pixels, frame_bus_slot_t *meta) {
+    const frame_bus_header_t *hdr = (const frame_bus_header_t *)d->ring;
+    uint64_t seq = __atomic_load_n(&hdr->write_seq, __ATOMIC_ACQUIRE);
+    if (seq == 0) return 0;
+
+    const frame_bus_slot_t *slot = (const frame_bus_slot_t *)
+        (d->ring + FRAME_BUS_HEADER_SIZE + (seq % (uint64_t)d->slot_count) * d->slot_stride);
+    uint32_t gen = __atomic_load_n(&slot->gen, __ATOMIC_ACQUIRE);
+    if (gen & 1) return 0;
+    memcpy(meta, slot, sizeof(*meta));
+    memcpy(pixels, (const uint8_t *)slot + sizeof(frame_bus_slot_t), meta->size);
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (__atomic_load_n(&slot->gen, __ATOMIC_RELAXED) != gen) return 0;
+    return meta->seq;
+}
+
+/* Answers every frame with its pixel sum as the label */
+static void *stub_detector_thread(void *arg) {
+    stub_detector_t *d = arg;
+    uint8_t *pixels = malloc(TEST_MAX_FRAME_BYTES);
+
+    while (!atomic_load(&d->stop)) {
+        struct pollfd pfd = { .fd = d->event_fd, .events = POLLIN };
+        if (poll(&pfd, 1, 50) <= 0) continue;
+
+        uint64_t count;
+        if (read(d->event_fd, &count, sizeof(count)) != sizeof(count)) continue;
+
+        frame_bus_slot_t meta;
+        uint64_t seq = stub_read_newest(d, pixels, &meta);
+        if (seq == 0) continue;
+        atomic_fetch_add(&d->frames_seen, 1);
+
+        unsigned long sum = 0;
+        for (uint32_t i = 0; i < meta.size; i++) sum += pixels[i];
+
+        char msg[256];
+        snprintf(msg, sizeof(msg),
+                 "RESULT %llu {\"detections\":[{\"label\":\"sum%lu\",\"confidence\":0.9,"
+                 "\"x_min\":0.1,\"y_min\":0.1,\"x_max\":0.2,\"y_max\":0.2}]}",
+                 (unsigned long long)seq, sum);
+        send(d->sock, msg, strlen(msg), 0);
+    }
+
+    free(pixels);
+    return NULL;
+}
+
+static void stub_start(stub_detector_t *d) {
+    pthread_create(&d->thread, NULL, stub_detector_thread, d);
+}
+
+static void stub_close(stub_detector_t *d) {
+    atomic_store(&d->stop, 1);
+    if (d->thread) pthread_join(d->thread, NULL);
+    if (d->ring && d->ring != MAP_FAILED) munmap(d->ring, d->ring_size);
+    if (d->event_fd > 0) close(d->event_fd);
+    if (d->sock >= 0) close(d->sock);
+}
+
+/* ---- result handler ---- */
+
+static pthread_mutex_t result_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t result_cond = PTHREAD_COND_INITIALIZER;
+static int results_received;
+static uint64_t last_seq;
+static char last_json[512];
+
+static void on_result(const char *stream_name, uint64_t seq, const char *json,
+                      size_t json_len, void *user_data) {
+    (void)stream_name;
+    (void)json_len;
+    pthread_mutex_lock(&result_mutex);
+    last_seq = seq;
+    snprintf(last_json, sizeof(last_json), "%s", json);
+    results_received++;
+    (*(int *)user_data)++;
+    pthread_cond_broadcast(&result_cond);
+    pthread_mutex_unlock(&result_mutex);
+}
+
+static int wait_for_results(int count, int timeout_ms) {
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    pthread_mutex_lock(&result_mutex);
+    while (results_received < count) {
+        if (pthread_cond_timedwait(&result_cond, &result_mutex, &deadline) != 0) break;
+    }
+    int received = results_received;
+    pthread_mutex_unlock(&result_mutex);
+    return received;
+}
+
+static void wait_for_subscriber(const char *stream, bool expected) {
+    for (int i = 0; i < 200 && frame_bus_has_subscriber(stream) != expected; i++) {
+        usleep(5000);
+    }
+}
+
+static void fill_frame(uint8_t *rgb, int width, int height, uint8_t value) {
+    memset(rgb, value, (size_t)width * height * 3);
+}
+
+/* ---- Unity boilerplate ---- */
+void setUp(void) {
+    snprintf(socket_path, sizeof(socket_path), "/tmp/lightnvr_test_frame_bus_%d.sock", (int)getpid());
+    results_received = 0;
+    last_seq = 0;
+    last_json[0] = '\0';
+    TEST_ASSERT_EQUAL_INT(0, frame_bus_init(socket_path, TEST_SLOTS, TEST_MAX_FRAME_BYTES));
+}
+void tearDown(void) {
+    frame_bus_shutdown();
+}
+
+/* ================================================================
+ * No detector attached — nothing is copied
+ * ================================================================ */
+
+void test_publish_without_subscriber_is_skipped(void) {
+    uint8_t rgb[16 * 16 * 3];
+    fill_frame(rgb, 16, 16, 1);
+
+    TEST_ASSERT_FALSE(frame_bus_has_subscriber("cam_idle"));
+    TEST_ASSERT_EQUAL_INT(FRAME_BUS_NO_SUBSCRIBER, frame_bus_publish("cam_idle", rgb, 16, 16, NULL));
+}
+
+/* ================================================================
+ * End to end — frame through shared memory, result over the socket
+ * ================================================================ */
+
+void test_detector_receives_frame_and_posts_result(void) {
+    int calls = 0;
+    TEST_ASSERT_EQUAL_INT(0, frame_bus_set_result_handler("cam_e2e", on_result, &calls));
+
+    stub_detector_t d;
+    TEST_ASSERT_EQUAL_INT(0, stub_attach(&d, "cam_e2e"));
+    TEST_ASSERT_EQUAL_INT(TEST_SLOTS, d.slot_count);
+    wait_for_subscriber("cam_e2e", true);
+    TEST_ASSERT_TRUE(frame_bus_has_subscriber("cam_e2e"));
+
+    const frame_bus_header_t *hdr = (const frame_bus_header_t *)d.ring;
+    TEST_ASSERT_EQUAL_HEX32(FRAME_BUS_MAGIC, hdr->magic);
+    TEST_ASSERT_EQUAL_UINT32(FRAME_BUS_VERSION, hdr->version);
+    TEST_ASSERT_EQUAL_STRING("cam_e2e", hdr->stream_name);
+
+    stub_start(&d);
+
+    uint8_t rgb[32 * 24 * 3];
+    fill_frame(rgb, 32, 24, 2);
+    uint64_t seq = 0;
+    TEST_ASSERT_EQUAL_INT(0, frame_bus_publish("cam_e2e", rgb, 32, 24, &seq));
+    TEST_ASSERT_EQUAL_UINT64(1, seq);
+
+    TEST_ASSERT_EQUAL_INT(1, wait_for_results(1, 2000));
+    TEST_ASSERT_EQUAL_UINT64(1, last_seq);
+    /* 32 * 24 * 3 bytes of value 2 */
+    TEST_ASSERT_NOT_NULL(strstr(last_json, "\"label\":\"sum4608\""));
+    TEST_ASSERT_EQUAL_INT(1, calls);
+
+    stub_close(&d);
+    wait_for_subscriber("cam_e2e", false);
+    TEST_ASSERT_FALSE(frame_bus_has_subscriber("cam_e2e"));
+    frame_bus_clear_result_handler("cam_e2e");
+}
+
+/* ================================================================
+ * Ring wrap-around — the newest frame is always readable
+ * ================================================================ */
+
+void test_ring_wraps_and_keeps_newest_frame(void) {
+    stub_detector_t d;
+    TEST_ASSERT_EQUAL_INT(0, stub_attach(&d, "cam_wrap"));
+    wait_for_subscriber("cam_wrap", true);
+
+    uint8_t rgb[8 * 8 * 3];
+    for (int i = 1; i <= TEST_SLOTS * 2 + 1; i++) {
+        fill_frame(rgb, 8, 8, (uint8_t)i);
+        TEST_ASSERT_EQUAL_INT(0, frame_bus_publish("cam_wrap", rgb, 8, 8, NULL));
+    }
+
+    uint8_t pixels[TEST_MAX_FRAME_BYTES];
+    frame_bus_slot_t meta;
+    TEST_ASSERT_EQUAL_UINT64(TEST_SLOTS * 2 + 1, stub_read_newest(&d, pixels, &meta));
+    TEST_ASSERT_EQUAL_UINT32(8, meta.width);
+    TEST_ASSERT_EQUAL_UINT32(8 * 3, meta.stride);
+    TEST_ASSERT_EQUAL_UINT32(FRAME_BUS_FORMAT_RGB24, meta.format);
+    TEST_ASSERT_EQUAL_UINT8(TEST_SLOTS * 2 + 1, pixels[0]);
+    /* Not caught mid-write */
+    TEST_ASSERT_EQUAL_UINT32(0, meta.gen & 1);
+
+    /* The eventfd counted every publish */
+    uint64_t count = 0;
+    TEST_ASSERT_EQUAL_INT((int)sizeof(count), (int)read(d.event_fd, &count, sizeof(count)));
+    TEST_ASSERT_EQUAL_UINT64(TEST_SLOTS * 2 + 1, count);
+
+    stub_close(&d);
+}
+
+/* ================================================================
+ * Oversized frames and bad requests
+ * ================================================================ */
+
+void test_oversized_frame_is_rejected(void) {
+    stub_detector_t d;
+    TEST_ASSERT_EQUAL_INT(0, stub_attach(&d, "cam_big"));
+    wait_for_subscriber("cam_big", true);
+
+    uint8_t *rgb = calloc(128 * 96 * 3, 1);
+    TEST_ASSERT_EQUAL_INT(-1, frame_bus_publish("cam_big", rgb, 128, 96, NULL));
+    free(rgb);
+
+    stub_close(&d);
+}
+
+void test_result_before_attach_is_refused(void) {
+    int sock = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, socket_path);
+    TEST_ASSERT_EQUAL_INT(0, connect(sock, (struct sockaddr *)&addr, sizeof(addr)));
+
+    const char *msg = "RESULT 1 {\"detections\":[]}";
+    send(sock, msg, strlen(msg), 0);
+
+    char reply[128];
+    ssize_t n = recv(sock, reply, sizeof(reply) - 1, 0);
+    TEST_ASSERT_TRUE(n > 0);
+    reply[n] = '\0';
+    TEST_ASSERT_EQUAL_STRING("ERR not attached", reply);
+    close(sock);
+}
+
+/* ================================================================
+ * Clearing the handler stops result delivery
+ * ================================================================ */
+
+void test_cleared_handler_gets_no_results(void) {
+    int calls = 0;
+    TEST_ASSERT_EQUAL_INT(0, frame_bus_set_result_handler("cam_clear", on_result, &calls));
+
+    stub_detector_t d;
+    TEST_ASSERT_EQUAL_INT(0, stub_attach(&d, "cam_clear"));
+    wait_for_subscriber("cam_clear", true);
+    stub_start(&d);
+
+    frame_bus_clear_result_handler("cam_clear");
+
+    uint8_t rgb[8 * 8 * 3];
+    fill_frame(rgb, 8, 8, 5);
+    TEST_ASSERT_EQUAL_INT(0, frame_bus_publish("cam_clear", rgb, 8, 8, NULL));
+
+    /* The detector sees the frame, but its answer goes nowhere */
+    for (int i = 0; i < 200 && atomic_load(&d.frames_seen) == 0; i++) usleep(5000);
+    TEST_ASSERT_EQUAL_INT(1, atomic_load(&d.frames_seen));
+    TEST_ASSERT_EQUAL_INT(0, wait_for_results(1, 200));
+    TEST_ASSERT_EQUAL_INT(0, calls);
+
+    stub_close(&d);
+}
+
+/* ================================================================
+ * main
+ * ================================================================ */
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_publish_without_subscriber_is_skipped);
+    RUN_TEST(test_detector_receives_frame_and_posts_result);
+    RUN_TEST(test_ring_wraps_and_keeps_newest_frame);
+    RUN_TEST(test_oversized_frame_is_rejected);
+    RUN_TEST(test_result_before_attach_is_refused);
+    RUN_TEST(test_cleared_handler_gets_no_results);
+    return UNITY_END();
+}
@@ -33,6 +33,7 @@
 #include "core/config.h"
 #include "utils/strings.h"
 #include "database/db_auth.h"
+#include "database/db_auth_cache.h"
 #include "database/db_core.h"
 
 /* ---- external globals from lightnvr_lib ---- */
@@ -77,6 +78,9 @@ static void clear_auth_data(void) {
         }
         TEST_FAIL_MESSAGE("Failed to clear auth data");
     }
+
+    /* Raw DELETEs bypass db_auth.c, so drop cached credentials explicitly */
+    db_auth_cache_clear();
 }
 
 /* ---- Unity boilerplate ---- */
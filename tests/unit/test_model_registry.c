@@ -0,0 +1,257 @@
+/**
+ * @file test_model_registry.c
+ * @brief Layer 2 unit tests — shared detection model versions
+ *
+ * Tests:
+ *   model_registry_acquire       — single load per (path, threshold), sharing
+ *   model_registry_release       — last handle frees the model
+ *   model_version_claim          — exclusive use of the shared instance
+ *   model_registry_check_update  — hot reload on file change or request
+ *   model_registry_get_stats     — handles, versions, generations
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "unity.h"
+#include "core/config.h"
+#include "video/model_registry.h"
+
+/* ---- helpers ---- */
+
+static int g_loads;
+static int g_frees;
+static bool g_fail_load;
+static char g_path[64];
+
+/* Shared part: the first byte of the file */
+static void *fake_load(const char *path, float threshold) {
+    (void)threshold;
+    g_loads++;
+    if (g_fail_load) {
+        return NULL;
+    }
+    FILE *fp = fopen(path, "r");
+    if (!fp) {
+        return NULL;
+    }
+    int *value = malloc(sizeof(int));
+    *value = fgetc(fp);
+    fclose(fp);
+    return value;
+}
+
+static void fake_free(void *shared) {
+    g_frees++;
+    free(shared);
+}
+
+/* Replace the model file by renaming a new one over it */
+static void write_model(char c) {
+    char tmp[80];
+    snprintf(tmp, sizeof(tmp), "%s.new", g_path);
+    FILE *fp = fopen(tmp, "w");
+    fputc(c, fp);
+    fclose(fp);
+    rename(tmp, g_path);
+}
+
+static int shared_value(model_version_t *v) {
+    return *(int *)model_version_shared(v);
+}
+
+/* ---- Unity boilerplate ---- */
+void setUp(void) {
+    g_loads = 0;
+    g_frees = 0;
+    g_fail_load = false;
+    g_config.model_reload_interval = 0;
+    snprintf(g_path, sizeof(g_path), "/tmp/test_model_registry_%d.bin", (int)getpid());
+    write_model('a');
+}
+void tearDown(void) {
+    unlink(g_path);
+}
+
+/* ================================================================
+ * Acquire and release
+ * ================================================================ */
+
+void test_acquire_loads_once_and_shares(void) {
+    model_version_t *a = model_registry_acquire(g_path, 0.5f, fake_load, fake_free);
+    model_version_t *b = model_registry_acquire(g_path, 0.5f, fake_load, fake_free);
+
+    TEST_ASSERT_NOT_NULL(a);
+    TEST_ASSERT_EQUAL_PTR(a, b);
+    TEST_ASSERT_EQUAL_INT(1, g_loads);
+    TEST_ASSERT_EQUAL_INT('a', shared_value(a));
+    TEST_ASSERT_EQUAL_UINT(1, model_version_generation(a));
+
+    model_registry_release(a);
+    TEST_ASSERT_EQUAL_INT(0, g_frees);
+    model_registry_release(b);
+    TEST_ASSERT_EQUAL_INT(1, g_frees);
+}
+
+void test_threshold_is_part_of_the_key(void) {
+    model_version_t *a = model_registry_acquire(g_path, 0.5f, fake_load, fake_free);
+    model_version_t *b = model_registry_acquire(g_path, 0.7f, fake_load, fake_free);
+
+    TEST_ASSERT_TRUE(a != b);
+    TEST_ASSERT_EQUAL_INT(2, g_loads);
+
+    model_registry_release(a);
+    model_registry_release(b);
+    TEST_ASSERT_EQUAL_INT(2, g_frees);
+}
+
+void test_failed_load_is_not_registered(void) {
+    g_fail_load = true;
+    TEST_ASSERT_NULL(model_registry_acquire(g_path, 0.5f, fake_load, fake_free));
+
+    model_registry_stats_t stats[MODEL_REGISTRY_MAX_ENTRIES];
+    TEST_ASSERT_EQUAL_INT(0, model_registry_get_stats(stats, MODEL_REGISTRY_MAX_ENTRIES));
+
+    g_fail_load = false;
+    model_version_t *v = model_registry_acquire(g_path, 0.5f, fake_load, fake_free);
+    TEST_ASSERT_NOT_NULL(v);
+    model_registry_release(v);
+}
+
+void test_claim_is_exclusive(void) {
+    model_version_t *v = model_registry_acquire(g_path, 0.5f, fake_load, fake_free);
+
+    TEST_ASSERT_TRUE(model_version_claim(v));
+    TEST_ASSERT_FALSE(model_version_claim(v));
+    model_version_unclaim(v);
+    TEST_ASSERT_TRUE(model_version_claim(v));
+    model_version_unclaim(v);
+
+    model_registry_release(v);
+}
+
+/* ================================================================
+ * Hot reload
+ * ================================================================ */
+
+void test_no_update_while_file_unchanged(void) {
+    g_config.model_reload_interval = 1;
+    model_version_t *v = model_registry_acquire(g_path, 0.5f, fake_load, fake_free);
+
+    TEST_ASSERT_NULL(model_registry_check_update(v));   /* interval not elapsed */
+    sleep(1);
+    TEST_ASSERT_NULL(model_registry_check_update(v));   /* same file */
+    TEST_ASSERT_EQUAL_INT(1, g_loads);
+
+    model_registry_release(v);
+}
+
+void test_changed_file_moves_handles_to_new_version(void) {
+    model_version_t *a = model_registry_acquire(g_path, 0.5f, fake_load, fake_free);
+    model_version_t *b = model_registry_acquire(g_path, 0.5f, fake_load, fake_free);
+
+    write_model('b');
+    model_registry_reload(g_path);
+
+    /* First handle loads the new version */
+    model_version_t *na = model_registry_check_update(a);
+    TEST_ASSERT_NOT_NULL(na);
+    TEST_ASSERT_EQUAL_INT('b', shared_value(na));
+    TEST_ASSERT_EQUAL_UINT(2, model_version_generation(na));
+    TEST_ASSERT_EQUAL_INT('a', shared_value(a));        /* old version still valid */
+    model_registry_release(a);
+    TEST_ASSERT_EQUAL_INT(0, g_frees);                  /* b still uses it */
+
+    /* Second handle follows without another load */
+    model_version_t *nb = model_registry_check_update(b);
+    TEST_ASSERT_EQUAL_PTR(na, nb);
+    TEST_ASSERT_EQUAL_INT(2, g_loads);
+    model_registry_release(b);
+    TEST_ASSERT_EQUAL_INT(1, g_frees);
+
+    TEST_ASSERT_NULL(model_registry_check_update(na));
+
+    model_registry_release(na);
+    model_registry_release(nb);
+    TEST_ASSERT_EQUAL_INT(2, g_frees);
+}
+
+void test_failed_reload_keeps_old_version(void) {
+    g_config.model_reload_interval = 1;
+    model_version_t *v = model_registry_acquire(g_path, 0.5f, fake_load, fake_free);
+
+    write_model('c');
+    g_fail_load = true;
+    sleep(1);
+    TEST_ASSERT_NULL(model_registry_check_update(v));
+    TEST_ASSERT_EQUAL_INT(2, g_loads);
+
+    /* The broken revision is not retried until the file changes again */
+    sleep(1);
+    TEST_ASSERT_NULL(model_registry_check_update(v));
+    TEST_ASSERT_EQUAL_INT(2, g_loads);
+
+    model_registry_stats_t stats[MODEL_REGISTRY_MAX_ENTRIES];
+    TEST_ASSERT_EQUAL_INT(1, model_registry_get_stats(stats, MODEL_REGISTRY_MAX_ENTRIES));
+    TEST_ASSERT_EQUAL_UINT64(1, stats[0].reload_failures);
+    TEST_ASSERT_EQUAL_UINT(1, stats[0].generation);
+    TEST_ASSERT_EQUAL_INT('a', shared_value(v));
+
+    model_registry_release(v);
+}
+
+/* ================================================================
+ * Statistics
+ * ================================================================ */
+
+void test_stats_track_handles_and_versions(void) {
+    model_version_t *a = model_registry_acquire(g_path, 0.5f, fake_load, fake_free);
+    model_version_t *b = model_registry_acquire(g_path, 0.5f, fake_load, fake_free);
+    model_registry_stats_t stats[MODEL_REGISTRY_MAX_ENTRIES];
+
+    TEST_ASSERT_EQUAL_INT(1, model_registry_get_stats(stats, MODEL_REGISTRY_MAX_ENTRIES));
+    TEST_ASSERT_EQUAL_STRING(g_path, stats[0].path);
+    TEST_ASSERT_EQUAL_INT(2, stats[0].handles);
+    TEST_ASSERT_EQUAL_INT(1, stats[0].versions);
+
+    write_model('d');
+    model_registry_reload(g_path);
+    model_version_t *na = model_registry_check_update(a);
+    model_registry_release(a);
+
+    /* b still holds the old version while a runs on the new one */
+    model_registry_get_stats(stats, MODEL_REGISTRY_MAX_ENTRIES);
+    TEST_ASSERT_EQUAL_INT(2, stats[0].handles);
+    TEST_ASSERT_EQUAL_INT(2, stats[0].versions);
+    TEST_ASSERT_EQUAL_UINT(2, stats[0].generation);
+    TEST_ASSERT_EQUAL_UINT64(1, stats[0].reloads);
+
+    model_registry_release(b);
+    model_registry_get_stats(stats, MODEL_REGISTRY_MAX_ENTRIES);
+    TEST_ASSERT_EQUAL_INT(1, stats[0].handles);
+    TEST_ASSERT_EQUAL_INT(1, stats[0].versions);
+
+    model_registry_release(na);
+    TEST_ASSERT_EQUAL_INT(0, model_registry_get_stats(stats, MODEL_REGISTRY_MAX_ENTRIES));
+}
+
+/* ================================================================
+ * main
+ * ================================================================ */
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_acquire_loads_once_and_shares);
+    RUN_TEST(test_threshold_is_part_of_the_key);
+    RUN_TEST(test_failed_load_is_not_registered);
+    RUN_TEST(test_claim_is_exclusive);
+    RUN_TEST(test_no_update_while_file_unchanged);
+    RUN_TEST(test_changed_file_moves_handles_to_new_version);
+    RUN_TEST(test_failed_reload_keeps_old_version);
+    RUN_TEST(test_stats_track_handles_and_versions);
+    return UNITY_END();
+}
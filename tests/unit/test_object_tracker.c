@@ -0,0 +1,225 @@
+/**
+ * @file test_object_tracker.c
+ * @brief Layer 2 unit tests — per-stream SORT-style object tracker
+ *
+ * Tests:
+ *   object_tracker_process — track_id assignment and start/update/end events
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <string.h>
+
+#include "unity.h"
+#include "core/config.h"
+#include "utils/strings.h"
+#include "video/object_tracker.h"
+
+/* ---- helpers ---- */
+
+static void add_det(detection_result_t *r, const char *label,
+                    float x, float y, float w, float h) {
+    detection_t *d = &r->detections[r->count++];
+    memset(d, 0, sizeof(*d));
+    safe_strcpy(d->label, label, MAX_LABEL_LENGTH, 0);
+    d->x = x;
+    d->y = y;
+    d->width = w;
+    d->height = h;
+    d->confidence = 0.9f;
+    d->track_id = -1;
+}
+
+static int count_events(const detection_result_t *ev, track_event_t type) {
+    int n = 0;
+    for (int i = 0; i < ev->count; i++) {
+        if (ev->detections[i].track_event == type) n++;
+    }
+    return n;
+}
+
+/* ---- Unity boilerplate ---- */
+void setUp(void) {
+    g_config.tracking_enabled = true;
+    g_config.track_update_interval = 10;
+    g_config.track_max_misses = 2;
+    object_tracker_reset(NULL);
+}
+void tearDown(void) {}
+
+/* ================================================================
+ * Stationary object — one start, then periodic updates only
+ * ================================================================ */
+
+void test_stationary_object_emits_start_then_periodic_updates(void) {
+    detection_result_t r, ev;
+    int track_id = -1;
+    int starts = 0, updates = 0;
+
+    for (int t = 0; t < 60; t++) {
+        memset(&r, 0, sizeof(r));
+        add_det(&r, "car", 0.40f, 0.40f, 0.20f, 0.10f);
+        TEST_ASSERT_EQUAL_INT(0, object_tracker_process("cam_park", &r, 1000 + t, &ev));
+
+        if (track_id < 0) track_id = r.detections[0].track_id;
+        TEST_ASSERT_TRUE(track_id >= 0);
+        TEST_ASSERT_EQUAL_INT(track_id, r.detections[0].track_id);
+
+        starts += count_events(&ev, TRACK_EVENT_START);
+        updates += count_events(&ev, TRACK_EVENT_UPDATE);
+    }
+
+    /* 60 frames one second apart, heartbeat every 10 s */
+    TEST_ASSERT_EQUAL_INT(1, starts);
+    TEST_ASSERT_EQUAL_INT(5, updates);
+}
+
+/* ================================================================
+ * Moving object keeps its id and is stored as it moves
+ * ================================================================ */
+
+void test_moving_object_keeps_track_id(void) {
+    detection_result_t r, ev;
+    int track_id = -1;
+    int updates = 0;
+
+    for (int t = 0; t < 20; t++) {
+        memset(&r, 0, sizeof(r));
+        add_det(&r, "person", 0.05f + 0.01f * (float)t, 0.30f, 0.08f, 0.20f);
+        object_tracker_process("cam_walk", &r, 2000 + t, &ev);
+
+        if (track_id < 0) track_id = r.detections[0].track_id;
+        TEST_ASSERT_EQUAL_INT(track_id, r.detections[0].track_id);
+        updates += count_events(&ev, TRACK_EVENT_UPDATE);
+    }
+
+    /* Walks 2.5 box widths in 20 s: stored as it moves, not every frame */
+    TEST_ASSERT_TRUE(updates >= 3);
+    TEST_ASSERT_TRUE(updates < 19);
+}
+
+/* ================================================================
+ * Lost object — end event after track_max_misses empty frames
+ * ================================================================ */
+
+void test_lost_track_emits_end_with_last_box(void) {
+    detection_result_t r, ev;
+
+    memset(&r, 0, sizeof(r));
+    add_det(&r, "dog", 0.10f, 0.60f, 0.10f, 0.10f);
+    object_tracker_process("cam_lost", &r, 3000, &ev);
+    int track_id = r.detections[0].track_id;
+
+    /* Two misses are tolerated ... */
+    for (int t = 1; t <= 2; t++) {
+        memset(&r, 0, sizeof(r));
+        object_tracker_process("cam_lost", &r, 3000 + t, &ev);
+        TEST_ASSERT_EQUAL_INT(0, ev.count);
+    }
+
+    /* ... the third ends the track */
+    memset(&r, 0, sizeof(r));
+    object_tracker_process("cam_lost", &r, 3003, &ev);
+    TEST_ASSERT_EQUAL_INT(1, ev.count);
+    TEST_ASSERT_EQUAL_INT(TRACK_EVENT_END, ev.detections[0].track_event);
+    TEST_ASSERT_EQUAL_INT(track_id, ev.detections[0].track_id);
+    TEST_ASSERT_EQUAL_STRING("dog", ev.detections[0].label);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.10f, ev.detections[0].x);
+
+    /* Reappearing later starts a new track */
+    memset(&r, 0, sizeof(r));
+    add_det(&r, "dog", 0.10f, 0.60f, 0.10f, 0.10f);
+    object_tracker_process("cam_lost", &r, 3004, &ev);
+    TEST_ASSERT_EQUAL_INT(TRACK_EVENT_START, ev.detections[0].track_event);
+    TEST_ASSERT_NOT_EQUAL(track_id, r.detections[0].track_id);
+}
+
+/* ================================================================
+ * Labels — overlapping boxes of different classes stay separate
+ * ================================================================ */
+
+void test_different_labels_get_separate_tracks(void) {
+    detection_result_t r, ev;
+
+    memset(&r, 0, sizeof(r));
+    add_det(&r, "person", 0.30f, 0.30f, 0.20f, 0.40f);
+    add_det(&r, "bicycle", 0.30f, 0.35f, 0.20f, 0.35f);
+    object_tracker_process("cam_bike", &r, 4000, &ev);
+
+    TEST_ASSERT_EQUAL_INT(2, count_events(&ev, TRACK_EVENT_START));
+    TEST_ASSERT_NOT_EQUAL(r.detections[0].track_id, r.detections[1].track_id);
+    int person_id = r.detections[0].track_id;
+    int bike_id = r.detections[1].track_id;
+
+    /* Same objects, listed in the other order */
+    memset(&r, 0, sizeof(r));
+    add_det(&r, "bicycle", 0.31f, 0.35f, 0.20f, 0.35f);
+    add_det(&r, "person", 0.31f, 0.30f, 0.20f, 0.40f);
+    object_tracker_process("cam_bike", &r, 4001, &ev);
+
+    TEST_ASSERT_EQUAL_INT(bike_id, r.detections[0].track_id);
+    TEST_ASSERT_EQUAL_INT(person_id, r.detections[1].track_id);
+    TEST_ASSERT_EQUAL_INT(0, ev.count);
+}
+
+/* ================================================================
+ * External track ids and disabled tracking
+ * ================================================================ */
+
+void test_external_track_id_is_kept(void) {
+    detection_result_t r, ev;
+
+    memset(&r, 0, sizeof(r));
+    add_det(&r, "car", 0.10f, 0.10f, 0.10f, 0.10f);
+    r.detections[0].track_id = 4242;
+    object_tracker_process("cam_ext", &r, 5000, &ev);
+    TEST_ASSERT_EQUAL_INT(4242, r.detections[0].track_id);
+    TEST_ASSERT_EQUAL_INT(TRACK_EVENT_START, ev.detections[0].track_event);
+
+    /* The external tracker's id wins even after a large jump */
+    memset(&r, 0, sizeof(r));
+    add_det(&r, "car", 0.70f, 0.70f, 0.10f, 0.10f);
+    r.detections[0].track_id = 4242;
+    object_tracker_process("cam_ext", &r, 5001, &ev);
+    TEST_ASSERT_EQUAL_INT(1, ev.count);
+    TEST_ASSERT_EQUAL_INT(TRACK_EVENT_UPDATE, ev.detections[0].track_event);
+    TEST_ASSERT_EQUAL_INT(4242, ev.detections[0].track_id);
+}
+
+void test_tracking_disabled_passes_everything_through(void) {
+    g_config.tracking_enabled = false;
+    detection_result_t r, ev;
+
+    for (int t = 0; t < 3; t++) {
+        memset(&r, 0, sizeof(r));
+        add_det(&r, "car", 0.40f, 0.40f, 0.20f, 0.10f);
+        add_det(&r, "person", 0.10f, 0.10f, 0.05f, 0.20f);
+        object_tracker_process("cam_off", &r, 6000 + t, &ev);
+        TEST_ASSERT_EQUAL_INT(2, ev.count);
+        TEST_ASSERT_EQUAL_INT(-1, ev.detections[0].track_id);
+        TEST_ASSERT_EQUAL_INT(TRACK_EVENT_NONE, ev.detections[0].track_event);
+    }
+}
+
+void test_track_event_names(void) {
+    TEST_ASSERT_EQUAL_STRING("start", track_event_name(TRACK_EVENT_START));
+    TEST_ASSERT_EQUAL_STRING("update", track_event_name(TRACK_EVENT_UPDATE));
+    TEST_ASSERT_EQUAL_STRING("end", track_event_name(TRACK_EVENT_END));
+    TEST_ASSERT_NULL(track_event_name(TRACK_EVENT_NONE));
+}
+
+/* ================================================================
+ * main
+ * ================================================================ */
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_stationary_object_emits_start_then_periodic_updates);
+    RUN_TEST(test_moving_object_keeps_track_id);
+    RUN_TEST(test_lost_track_emits_end_with_last_box);
+    RUN_TEST(test_different_labels_get_separate_tracks);
+    RUN_TEST(test_external_track_id_is_kept);
+    RUN_TEST(test_tracking_disabled_passes_everything_through);
+    RUN_TEST(test_track_event_names);
+    return UNITY_END();
+}
@@ -0,0 +1,222 @@
+/**
+ * @file test_snapshot_cache.c
+ * @brief Layer 2 unit tests — per-stream snapshot cache
+ *
+ * Tests:
+ *   snapshot_cache_get    — reuse within max age, refetch when stale, failures
+ *   single-flight         — concurrent requests share one go2rtc fetch
+ *   snapshot_cache_put    — locally encoded frames are served
+ *   snapshot_release      — replaced snapshots stay valid until released
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "unity.h"
+#include "core/config.h"
+#include "video/go2rtc/go2rtc_snapshot.h"
+#include "video/snapshot_cache.h"
+
+/* ---- fake go2rtc ---- */
+
+static int g_fetches;
+static bool g_fail;
+static int g_delay_ms;
+static pthread_mutex_t g_fetch_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void sleep_ms(int ms) {
+    struct timespec ts = {ms / 1000, (long)(ms % 1000) * 1000000L};
+    nanosleep(&ts, NULL);
+}
+
+/* Returns "<stream>:<fetch number>" as the JPEG */
+bool go2rtc_get_snapshot(const char *stream_name, unsigned char **jpeg_data, size_t *jpeg_size) {
+    pthread_mutex_lock(&g_fetch_mutex);
+    int n = ++g_fetches;
+    pthread_mutex_unlock(&g_fetch_mutex);
+
+    if (g_delay_ms > 0) {
+        sleep_ms(g_delay_ms);
+    }
+    if (g_fail) {
+        return false;
+    }
+    char buf[128];
+    int len = snprintf(buf, sizeof(buf), "%s:%d", stream_name, n);
+    *jpeg_data = malloc((size_t)len + 1);
+    memcpy(*jpeg_data, buf, (size_t)len + 1);
+    *jpeg_size = (size_t)len + 1;
+    return true;
+}
+
+void go2rtc_snapshot_cleanup_thread(void) {}
+
+static void *get_thread(void *arg) {
+    return snapshot_cache_get((const char *)arg, -1);
+}
+
+/* ---- Unity boilerplate ---- */
+void setUp(void) {
+    snapshot_cache_cleanup();
+    g_fetches = 0;
+    g_fail = false;
+    g_delay_ms = 0;
+    g_config.go2rtc_snapshot_max_age_ms = 60000;
+}
+void tearDown(void) {}
+
+/* ================================================================
+ * snapshot_cache_get
+ * ================================================================ */
+
+void test_get_reuses_fresh_snapshot(void) {
+    snapshot_t *a = snapshot_cache_get("front", -1);
+    snapshot_t *b = snapshot_cache_get("front", -1);
+
+    TEST_ASSERT_NOT_NULL(a);
+    TEST_ASSERT_EQUAL_PTR(a, b);
+    TEST_ASSERT_EQUAL_STRING("front:1", (const char *)a->data);
+    TEST_ASSERT_EQUAL_INT(1, g_fetches);
+
+    snapshot_release(a);
+    snapshot_release(b);
+}
+
+void test_get_refetches_stale_snapshot(void) {
+    snapshot_t *a = snapshot_cache_get("front", -1);
+    sleep_ms(20);
+    snapshot_t *b = snapshot_cache_get("front", 10);
+
+    TEST_ASSERT_EQUAL_INT(2, g_fetches);
+    TEST_ASSERT_EQUAL_STRING("front:2", (const char *)b->data);
+    TEST_ASSERT_EQUAL_STRING("front:1", (const char *)a->data);  /* still valid */
+
+    snapshot_release(a);
+    snapshot_release(b);
+}
+
+void test_streams_are_cached_separately(void) {
+    snapshot_t *a = snapshot_cache_get("front", -1);
+    snapshot_t *b = snapshot_cache_get("back", -1);
+
+    TEST_ASSERT_EQUAL_INT(2, g_fetches);
+    TEST_ASSERT_EQUAL_STRING("back:2", (const char *)b->data);
+
+    snapshot_release(a);
+    snapshot_release(b);
+}
+
+void test_failed_fetch_returns_null(void) {
+    g_fail = true;
+    TEST_ASSERT_NULL(snapshot_cache_get("front", -1));
+
+    g_fail = false;
+    snapshot_t *s = snapshot_cache_get("front", -1);
+    TEST_ASSERT_NOT_NULL(s);
+    snapshot_release(s);
+
+    snapshot_cache_stats_t stats;
+    snapshot_cache_get_stats(&stats);
+    TEST_ASSERT_TRUE(stats.fetch_failures >= 1);
+}
+
+/* ================================================================
+ * Single-flight
+ * ================================================================ */
+
+void test_concurrent_requests_share_one_fetch(void) {
+    pthread_t threads[4];
+    snapshot_t *results[4];
+    g_delay_ms = 100;
+
+    for (int i = 0; i < 4; i++) {
+        pthread_create(&threads[i], NULL, get_thread, "front");
+    }
+    for (int i = 0; i < 4; i++) {
+        pthread_join(threads[i], (void **)&results[i]);
+    }
+
+    TEST_ASSERT_EQUAL_INT(1, g_fetches);
+    for (int i = 0; i < 4; i++) {
+        TEST_ASSERT_EQUAL_PTR(results[0], results[i]);
+        snapshot_release(results[i]);
+    }
+}
+
+void test_concurrent_requests_share_a_failure(void) {
+    pthread_t threads[3];
+    void *results[3];
+    g_delay_ms = 100;
+    g_fail = true;
+
+    for (int i = 0; i < 3; i++) {
+        pthread_create(&threads[i], NULL, get_thread, "front");
+    }
+    for (int i = 0; i < 3; i++) {
+        pthread_join(threads[i], &results[i]);
+        TEST_ASSERT_NULL(results[i]);
+    }
+    TEST_ASSERT_EQUAL_INT(1, g_fetches);
+}
+
+/* ================================================================
+ * snapshot_cache_put and removal
+ * ================================================================ */
+
+void test_put_is_served_without_fetch(void) {
+    snapshot_cache_put("front", (const unsigned char *)"local", 6);
+
+    snapshot_t *s = snapshot_cache_get("front", -1);
+    TEST_ASSERT_EQUAL_STRING("local", (const char *)s->data);
+    TEST_ASSERT_EQUAL_INT(0, g_fetches);
+    snapshot_release(s);
+}
+
+void test_put_replaces_while_old_is_held(void) {
+    snapshot_t *a = snapshot_cache_get("front", -1);
+    snapshot_cache_put("front", (const unsigned char *)"local", 6);
+    snapshot_t *b = snapshot_cache_get("front", -1);
+
+    TEST_ASSERT_EQUAL_STRING("front:1", (const char *)a->data);
+    TEST_ASSERT_EQUAL_STRING("local", (const char *)b->data);
+
+    snapshot_release(a);
+    snapshot_release(b);
+}
+
+void test_remove_forces_refetch(void) {
+    snapshot_t *a = snapshot_cache_get("front", -1);
+    snapshot_cache_remove("front");
+    snapshot_t *b = snapshot_cache_get("front", -1);
+
+    TEST_ASSERT_EQUAL_INT(2, g_fetches);
+    TEST_ASSERT_TRUE(a != b);
+
+    snapshot_release(a);
+    snapshot_release(b);
+}
+
+/* ================================================================
+ * main
+ * ================================================================ */
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_get_reuses_fresh_snapshot);
+    RUN_TEST(test_get_refetches_stale_snapshot);
+    RUN_TEST(test_streams_are_cached_separately);
+    RUN_TEST(test_failed_fetch_returns_null);
+    RUN_TEST(test_concurrent_requests_share_one_fetch);
+    RUN_TEST(test_concurrent_requests_share_a_failure);
+    RUN_TEST(test_put_is_served_without_fetch);
+    RUN_TEST(test_put_replaces_while_old_is_held);
+    RUN_TEST(test_remove_forces_refetch);
+    snapshot_cache_cleanup();
+    return UNITY_END();
+}
@@ -0,0 +1,318 @@
+/**
+ * @file test_sod_quantize.c
+ * @brief Layer 1 unit tests — SOD CNN INT8 quantized inference
+ *
+ * Builds a small region-detector network with deterministic weights,
+ * quantizes it with sod_cnn_quantize() on a set of synthetic fixture frames,
+ * and checks that:
+ *  - the INT8 file loads in place of the float weights
+ *  - the raw network output stays close to the float output
+ *  - the strongest float detection on every fixture is also found by
+ *    the INT8 network (same class, overlapping box, close score)
+ *  - quantizing an already quantized network is refused
+ *  - an INT8 file is rejected for a different architecture
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "unity.h"
+#include "sod/sod.h"
+
+/* Tiny YOLOv2-style network: 64x64 input, 2 anchors, 4 classes */
+static const char k_arch[] =
+    "[net]\n"
+    "batch=1\n"
+    "subdivisions=1\n"
+    "width=64\n"
+    "height=64\n"
+    "channels=3\n"
+    "\n"
+    "[convolutional]\n"
+    "batch_normalize=1\n"
+    "filters=8\n"
+    "size=3\n"
+    "stride=1\n"
+    "pad=1\n"
+    "activation=leaky\n"
+    "\n"
+    "[maxpool]\n"
+    "size=2\n"
+    "stride=2\n"
+    "\n"
+    "[convolutional]\n"
+    "batch_normalize=1\n"
+    "filters=16\n"
+    "size=3\n"
+    "stride=1\n"
+    "pad=1\n"
+    "activation=leaky\n"
+    "\n"
+    "[maxpool]\n"
+    "size=2\n"
+    "stride=2\n"
+    "\n"
+    "[convolutional]\n"
+    "batch_normalize=1\n"
+    "filters=32\n"
+    "size=3\n"
+    "stride=1\n"
+    "pad=1\n"
+    "activation=leaky\n"
+    "\n"
+    "[maxpool]\n"
+    "size=2\n"
+    "stride=2\n"
+    "\n"
+    "[convolutional]\n"
+    "size=1\n"
+    "stride=1\n"
+    "pad=1\n"
+    "filters=18\n"
+    "activation=linear\n"
+    "\n"
+    "[region]\n"
+    "anchors = 1.5,1.5,  4.0,3.0\n"
+    "bias_match=1\n"
+    "classes=4\n"
+    "coords=4\n"
+    "num=2\n"
+    "softmax=1\n"
+    "absolute=1\n"
+    "thresh = .6\n";
+
+/* Convolution shapes of k_arch, in order: filters, channels, size, batch_normalize */
+static const int k_conv[][4] = {
+    { 8, 3, 3, 1 },
+    { 16, 8, 3, 1 },
+    { 32, 16, 3, 1 },
+    { 18, 32, 1, 0 },
+};
+
+#define NUM_FIXTURES 8
+#define FIXTURE_W 96
+#define FIXTURE_H 80
+
+static char g_dir[64];
+static char g_float_path[128];
+static char g_int8_path[128];
+static sod_img g_fixtures[NUM_FIXTURES];
+
+static unsigned int g_seed;
+
+static float next_uniform(void) {
+    g_seed = g_seed * 1664525u + 1013904223u;
+    return (float)(g_seed >> 8) / (float)(1u << 24);
+}
+
+/* Write a darknet-format weights file for k_arch */
+static void write_float_weights(const char *path) {
+    FILE *fp = fopen(path, "wb");
+    TEST_ASSERT_NOT_NULL(fp);
+
+    int header[3] = { 0, 2, 0 };
+    uint64_t seen = 0;
+    fwrite(header, sizeof(int), 3, fp);
+    fwrite(&seen, sizeof(seen), 1, fp);
+
+    g_seed = 12345;
+    for (size_t l = 0; l < sizeof(k_conv) / sizeof(k_conv[0]); l++) {
+        int n = k_conv[l][0];
+        int num = n * k_conv[l][1] * k_conv[l][2] * k_conv[l][2];
+        float fan_in = (float)(k_conv[l][1] * k_conv[l][2] * k_conv[l][2]);
+        for (int i = 0; i < n; i++) {
+            float bias = (next_uniform() - 0.5f) * 0.2f;
+            fwrite(&bias, sizeof(float), 1, fp);
+        }
+        if (k_conv[l][3]) {
+            for (int i = 0; i < n; i++) {  /* scales */
+                float v = 0.8f + 0.4f * next_uniform();
+                fwrite(&v, sizeof(float), 1, fp);
+            }
+            for (int i = 0; i < n; i++) {  /* rolling mean */
+                float v = (next_uniform() - 0.5f) * 0.1f;
+                fwrite(&v, sizeof(float), 1, fp);
+            }
+            for (int i = 0; i < n; i++) {  /* rolling variance */
+                float v = 0.5f + next_uniform();
+                fwrite(&v, sizeof(float), 1, fp);
+            }
+        }
+        for (int i = 0; i < num; i++) {
+            float w = (next_uniform() - 0.5f) * 2.0f * sqrtf(3.0f / fan_in);
+            fwrite(&w, sizeof(float), 1, fp);
+        }
+    }
+    fclose(fp);
+}
+
+/* Synthetic scenes: a colour gradient with a few solid rectangles */
+static void make_fixtures(void) {
+    g_seed = 777;
+    for (int f = 0; f < NUM_FIXTURES; f++) {
+        sod_img img = sod_make_image(FIXTURE_W, FIXTURE_H, 3);
+        for (int c = 0; c < 3; c++) {
+            for (int y = 0; y < FIXTURE_H; y++) {
+                for (int x = 0; x < FIXTURE_W; x++) {
+                    img.data[(c * FIXTURE_H + y) * FIXTURE_W + x] =
+                        0.2f + 0.3f * (float)((x * (c + 1) + y * (f + 1)) % FIXTURE_W) / FIXTURE_W;
+                }
+            }
+        }
+        for (int r = 0; r < 3; r++) {
+            int rw = 10 + (int)(next_uniform() * 30);
+            int rh = 10 + (int)(next_uniform() * 30);
+            int rx = (int)(next_uniform() * (FIXTURE_W - rw));
+            int ry = (int)(next_uniform() * (FIXTURE_H - rh));
+            for (int c = 0; c < 3; c++) {
+                float v = next_uniform();
+                for (int y = ry; y < ry + rh; y++) {
+                    for (int x = rx; x < rx + rw; x++) {
+                        img.data[(c * FIXTURE_H + y) * FIXTURE_W + x] = v;
+                    }
+                }
+            }
+        }
+        g_fixtures[f] = img;
+    }
+}
+
+static sod_cnn *create_net(const char *weights) {
+    sod_cnn *net = NULL;
+    const char *err = NULL;
+    int rc = sod_cnn_create(&net, k_arch, weights, &err);
+    TEST_ASSERT_EQUAL_INT_MESSAGE(SOD_OK, rc, err ? err : "sod_cnn_create failed");
+    TEST_ASSERT_NOT_NULL(net);
+    sod_cnn_config(net, SOD_CNN_DETECTION_THRESHOLD, 0.05);
+    return net;
+}
+
+/* Run one fixture, copying the raw output; boxes stay valid until the next predict */
+static int predict(sod_cnn *net, const sod_img *img, float *out, int max_out,
+                   sod_box **boxes, int *count) {
+    float *raw = NULL;
+    int nraw = 0;
+
+    TEST_ASSERT_EQUAL_INT(SOD_OK, sod_cnn_predict(net, sod_cnn_prepare_image(net, *img), boxes, count));
+    sod_cnn_config(net, SOD_CNN_NETWORK_OUTPUT, &raw, &nraw);
+    TEST_ASSERT_TRUE(nraw <= max_out);
+    memcpy(out, raw, sizeof(float) * nraw);
+    return nraw;
+}
+
+static sod_box strongest_box(const sod_box *boxes, int count) {
+    sod_box best;
+    memset(&best, 0, sizeof(best));
+    for (int i = 0; i < count; i++) {
+        if (boxes[i].score > best.score) {
+            best = boxes[i];
+        }
+    }
+    return best;
+}
+
+static float box_iou(const sod_box *a, const sod_box *b) {
+    int x0 = a->x > b->x ? a->x : b->x;
+    int y0 = a->y > b->y ? a->y : b->y;
+    int x1 = (a->x + a->w) < (b->x + b->w) ? (a->x + a->w) : (b->x + b->w);
+    int y1 = (a->y + a->h) < (b->y + b->h) ? (a->y + a->h) : (b->y + b->h);
+    float inter = (x1 > x0 && y1 > y0) ? (float)(x1 - x0) * (y1 - y0) : 0.0f;
+    float uni = (float)a->w * a->h + (float)b->w * b->h - inter;
+    return uni > 0 ? inter / uni : 0.0f;
+}
+
+/* ---- Unity boilerplate ---- */
+void setUp(void) {
+    snprintf(g_dir, sizeof(g_dir), "/tmp/lightnvr_sodq_XXXXXX");
+    TEST_ASSERT_NOT_NULL(mkdtemp(g_dir));
+    snprintf(g_float_path, sizeof(g_float_path), "%s/tiny.sod", g_dir);
+    snprintf(g_int8_path, sizeof(g_int8_path), "%s/tiny.int8.sod", g_dir);
+    write_float_weights(g_float_path);
+    make_fixtures();
+}
+
+void tearDown(void) {
+    for (int f = 0; f < NUM_FIXTURES; f++) {
+        sod_free_image(g_fixtures[f]);
+    }
+    unlink(g_float_path);
+    unlink(g_int8_path);
+    rmdir(g_dir);
+}
+
+/* ================================================================
+ * Quantize + compare
+ * ================================================================ */
+
+void test_int8_output_matches_float(void) {
+    sod_cnn *fnet = create_net(g_float_path);
+    TEST_ASSERT_EQUAL_INT(SOD_OK, sod_cnn_quantize(fnet, g_fixtures, NUM_FIXTURES, g_int8_path));
+    sod_cnn *qnet = create_net(g_int8_path);
+
+    static float fout[8192], qout[8192];
+    for (int f = 0; f < NUM_FIXTURES; f++) {
+        sod_box *fboxes, *qboxes;
+        int fcount, qcount;
+        int n = predict(fnet, &g_fixtures[f], fout, 8192, &fboxes, &fcount);
+        int nq = predict(qnet, &g_fixtures[f], qout, 8192, &qboxes, &qcount);
+        TEST_ASSERT_EQUAL_INT(n, nq);
+
+        double err = 0, ref = 0;
+        for (int i = 0; i < n; i++) {
+            err += (double)(fout[i] - qout[i]) * (fout[i] - qout[i]);
+            ref += (double)fout[i] * fout[i];
+        }
+        /* Relative L2 error of the raw detector output */
+        TEST_ASSERT_TRUE_MESSAGE(sqrt(err / ref) < 0.05, "INT8 output diverges from float");
+
+        /* Near-ties may reorder, so look for the float winner anywhere in the INT8 set */
+        sod_box fbest = strongest_box(fboxes, fcount);
+        TEST_ASSERT_TRUE(fbest.score > 0);
+        int matched = 0;
+        for (int i = 0; i < qcount && !matched; i++) {
+            matched = strcmp(fbest.zName, qboxes[i].zName) == 0 &&
+                      fabsf(fbest.score - qboxes[i].score) < 0.05f &&
+                      box_iou(&fbest, &qboxes[i]) > 0.7f;
+        }
+        TEST_ASSERT_TRUE_MESSAGE(matched, "INT8 network lost the strongest float detection");
+    }
+
+    sod_cnn_destroy(qnet);
+    sod_cnn_destroy(fnet);
+}
+
+void test_quantized_network_not_requantized(void) {
+    sod_cnn *fnet = create_net(g_float_path);
+    TEST_ASSERT_EQUAL_INT(SOD_OK, sod_cnn_quantize(fnet, g_fixtures, NUM_FIXTURES, g_int8_path));
+    sod_cnn_destroy(fnet);
+
+    /* A quantized network refuses to be quantized again */
+    sod_cnn *qnet = create_net(g_int8_path);
+    TEST_ASSERT_EQUAL_INT(SOD_UNSUPPORTED, sod_cnn_quantize(qnet, g_fixtures, 1, g_int8_path));
+    sod_cnn_destroy(qnet);
+}
+
+void test_int8_file_rejected_for_other_architecture(void) {
+    sod_cnn *fnet = create_net(g_float_path);
+    TEST_ASSERT_EQUAL_INT(SOD_OK, sod_cnn_quantize(fnet, g_fixtures, 2, g_int8_path));
+    sod_cnn_destroy(fnet);
+
+    sod_cnn *net = NULL;
+    const char *err = NULL;
+    TEST_ASSERT_NOT_EQUAL(SOD_OK, sod_cnn_create(&net, ":face", g_int8_path, &err));
+    TEST_ASSERT_NULL(net);
+    TEST_ASSERT_NOT_NULL(err);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_int8_output_matches_float);
+    RUN_TEST(test_quantized_network_not_requantized);
+    RUN_TEST(test_int8_file_rejected_for_other_architecture);
+    return UNITY_END();
+}
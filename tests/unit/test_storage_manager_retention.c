@@ -19,7 +19,9 @@
 #include "database/db_recordings.h"
 #include "database/db_streams.h"
 #include "storage/storage_manager.h"
+#include "storage/storage_cleanup_pool.h"
 #include "utils/strings.h"
+#include "test_stream_fixtures.h"
 
 #define TEST_DB_PATH "/tmp/lightnvr_unit_storage_manager_retention.db"
 
@@ -28,7 +30,7 @@ static char g_storage_root[PATH_MAX];
 static void clear_tables(void) {
     sqlite3 *db = get_db_handle();
     sqlite3_exec(db, "DELETE FROM recordings;", NULL, NULL, NULL);
-    sqlite3_exec(db, "DELETE FROM streams;", NULL, NULL, NULL);
+    test_clear_streams();
 }
 
 static void remove_tree(const char *path) {
@@ -193,6 +195,95 @@ void test_apply_retention_policy_preserves_metadata_when_file_delete_fails(void)
     TEST_ASSERT_EQUAL_INT(0, get_recording_metadata_by_path(blocked_path, &meta));
 }
 
+void test_apply_retention_policy_batches_deletes_through_cleanup_pool(void) {
+    time_t now = time(NULL);
+    char blocked_path[PATH_MAX];
+    char paths[4][PATH_MAX];
+    recording_metadata_t rec, meta;
+    cleanup_pool_stats_t before, after;
+
+    create_mp4_dir();
+    add_stream_with_quota("pool_cam", 2);
+    mp4_path(blocked_path, sizeof(blocked_path), "pool-blocked.mp4");
+    TEST_ASSERT_EQUAL_INT(0, ensure_dir(blocked_path));
+    rec = make_recording("pool_cam", blocked_path, now - 500, 1024 * 1024);
+    TEST_ASSERT_NOT_EQUAL(0, add_recording_metadata(&rec));
+
+    for (int i = 0; i < 4; i++) {
+        char name[32];
+        snprintf(name, sizeof(name), "pool-%02d.mp4", i);
+        mp4_path(paths[i], sizeof(paths[i]), name);
+        create_file(paths[i], 1024 * 1024);
+        rec = make_recording("pool_cam", paths[i], now - (400 - i * 100), 1024 * 1024);
+        TEST_ASSERT_NOT_EQUAL(0, add_recording_metadata(&rec));
+    }
+
+    TEST_ASSERT_EQUAL_INT(0, cleanup_pool_start(3, CLEANUP_IO_PRIORITY_NORMAL));
+    cleanup_pool_get_stats(&before);
+    int deleted = apply_retention_policy();
+    cleanup_pool_get_stats(&after);
+    cleanup_pool_stop();
+
+    /* 5 MB against a 2 MB quota: the blocked entry stays, so the next three go */
+    TEST_ASSERT_EQUAL_INT(3, deleted);
+    TEST_ASSERT_EQUAL_UINT64(3 * 1024 * 1024, after.bytes_freed - before.bytes_freed);
+    TEST_ASSERT_EQUAL_UINT64(1, after.failures - before.failures);
+    TEST_ASSERT_EQUAL_INT(0, get_recording_metadata_by_path(blocked_path, &meta));
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT_EQUAL_INT(-1, access(paths[i], F_OK));
+        TEST_ASSERT_NOT_EQUAL(0, get_recording_metadata_by_path(paths[i], &meta));
+    }
+    TEST_ASSERT_EQUAL_INT(0, access(paths[3], F_OK));
+    TEST_ASSERT_EQUAL_INT(0, get_recording_metadata_by_path(paths[3], &meta));
+}
+
+void test_apply_retention_policy_counts_unlinked_bytes_when_metadata_delete_fails(void) {
+    time_t now = time(NULL);
+    char paths[4][PATH_MAX];
+    char thumb_dir[PATH_MAX], thumb_path[PATH_MAX];
+    uint64_t ids[4];
+    recording_metadata_t rec, meta;
+
+    create_mp4_dir();
+    add_stream_with_quota("txn_cam", 2);
+    safe_strcpy(g_config.storage_path, g_storage_root, sizeof(g_config.storage_path), 0);
+    snprintf(thumb_dir, sizeof(thumb_dir), "%s/thumbnails", g_storage_root);
+    TEST_ASSERT_EQUAL_INT(0, ensure_dir(thumb_dir));
+
+    for (int i = 0; i < 4; i++) {
+        char name[32];
+        snprintf(name, sizeof(name), "txn-%02d.mp4", i);
+        mp4_path(paths[i], sizeof(paths[i]), name);
+        create_file(paths[i], 1024 * 1024);
+        rec = make_recording("txn_cam", paths[i], now - (400 - i * 100), 1024 * 1024);
+        ids[i] = add_recording_metadata(&rec);
+        TEST_ASSERT_NOT_EQUAL(0, ids[i]);
+    }
+    snprintf(thumb_path, sizeof(thumb_path), "%s/%llu_0.jpg", thumb_dir, (unsigned long long)ids[0]);
+    create_file(thumb_path, 16);
+
+    sqlite3_exec(get_db_handle(),
+                 "CREATE TEMP TRIGGER fail_recording_delete BEFORE DELETE ON recordings "
+                 "BEGIN SELECT RAISE(ABORT, 'test'); END;", NULL, NULL, NULL);
+    int deleted = apply_retention_policy();
+    sqlite3_exec(get_db_handle(), "DROP TRIGGER fail_recording_delete;", NULL, NULL, NULL);
+
+    /* The two oldest files are gone and count as freed, so nothing newer is removed */
+    TEST_ASSERT_EQUAL_INT(0, deleted);
+    for (int i = 0; i < 2; i++) {
+        TEST_ASSERT_EQUAL_INT(-1, access(paths[i], F_OK));
+        TEST_ASSERT_EQUAL_INT(0, get_recording_metadata_by_path(paths[i], &meta));
+    }
+    TEST_ASSERT_EQUAL_INT(0, access(paths[2], F_OK));
+    TEST_ASSERT_EQUAL_INT(0, access(paths[3], F_OK));
+
+    /* Thumbnails stay until the metadata is gone */
+    TEST_ASSERT_EQUAL_INT(0, access(thumb_path, F_OK));
+    TEST_ASSERT_EQUAL_INT(2, apply_retention_policy());
+    TEST_ASSERT_EQUAL_INT(-1, access(thumb_path, F_OK));
+    TEST_ASSERT_EQUAL_INT(2, count_recordings());
+}
+
 void test_apply_retention_policy_skips_orphan_cleanup_when_ratio_is_too_high(void) {
     time_t now = time(NULL);
     create_mp4_dir();
@@ -265,6 +356,8 @@ int main(void) {
     UNITY_BEGIN();
     RUN_TEST(test_apply_retention_policy_enforces_quota_with_oldest_eligible_first);
     RUN_TEST(test_apply_retention_policy_preserves_metadata_when_file_delete_fails);
+    RUN_TEST(test_apply_retention_policy_batches_deletes_through_cleanup_pool);
+    RUN_TEST(test_apply_retention_policy_counts_unlinked_bytes_when_metadata_delete_fails);
     RUN_TEST(test_apply_retention_policy_skips_orphan_cleanup_when_ratio_is_too_high);
     RUN_TEST(test_apply_retention_policy_cleans_low_ratio_orphans_when_storage_is_healthy);
     RUN_TEST(test_apply_retention_policy_skips_orphans_when_mp4_storage_is_inaccessible);
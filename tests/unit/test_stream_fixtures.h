@@ -0,0 +1,27 @@
+/**
+ * @file test_stream_fixtures.h
+ * @brief Shared fixtures for tests that reset the streams table
+ *
+ * Stream configurations are served from the cache in db_stream_cache.c,
+ * which db_streams.c republishes after each of its writes. Tests that clear
+ * the table with raw SQL bypass db_streams.c and must reload the cache, or
+ * later reads still return the deleted streams.
+ */
+
+#ifndef LIGHTNVR_TEST_STREAM_FIXTURES_H
+#define LIGHTNVR_TEST_STREAM_FIXTURES_H
+
+#include <sqlite3.h>
+
+#include "database/db_core.h"
+#include "database/db_streams.h"
+
+/**
+ * Delete every stream and reload the configuration cache
+ */
+static inline void test_clear_streams(void) {
+    sqlite3_exec(get_db_handle(), "DELETE FROM streams;", NULL, NULL, NULL);
+    load_stream_config_cache();
+}
+
+#endif /* LIGHTNVR_TEST_STREAM_FIXTURES_H */
@@ -5,6 +5,8 @@
  * Tests:
  *   filter_detections_by_zones     — zone polygon + class/confidence gate
  *   filter_detections_by_stream_objects — include/exclude object list
+ *   compiled zone cache            — rebuilt after db_zones.c writes
+ *   get_zone_bounding_boxes        — crop regions for detection models
  *
  * Both functions query SQLite (zones / streams tables) so we use a real DB.
  */
@@ -25,6 +27,7 @@
 #include "database/db_streams.h"
 #include "video/zone_filter.h"
 #include "video/detection_result.h"
+#include "test_stream_fixtures.h"
 
 #define TEST_DB_PATH "/tmp/lightnvr_unit_zone_filter_test.db"
 
@@ -83,7 +86,9 @@ static void ensure_stream(const char *name) {
 static void clear_all(void) {
     sqlite3 *db = get_db_handle();
     sqlite3_exec(db, "DELETE FROM detection_zones;", NULL, NULL, NULL);
-    sqlite3_exec(db, "DELETE FROM streams;", NULL, NULL, NULL);
+    /* Raw DELETEs bypass db_zones.c, so drop the zone cache explicitly */
+    invalidate_zone_filter_cache(NULL);
+    test_clear_streams();
 }
 
 /* ---- Unity boilerplate ---- */
@@ -213,6 +218,106 @@ void test_confidence_filter_passes_sufficient_confidence(void) {
     TEST_ASSERT_EQUAL_INT(1, r.count);
 }
 
+/* ================================================================
+ * Compiled zone cache — picks up writes made through db_zones.c
+ * ================================================================ */
+
+void test_cache_rebuilt_after_zones_saved(void) {
+    ensure_stream("cam_cache");
+    detection_zone_t z = make_square_zone("cam_cache", "zone8", true, NULL, 0.0f);
+    save_detection_zones("cam_cache", &z, 1);
+
+    detection_result_t r = make_result_1det("car", 0.7f, 0.7f, 0.1f, 0.1f, 0.9f);
+    filter_detections_by_zones("cam_cache", &r);
+    TEST_ASSERT_EQUAL_INT(0, r.count);
+
+    /* Move the zone to the bottom-right quadrant */
+    uint64_t gen = get_detection_zones_generation();
+    for (int i = 0; i < z.polygon_count; i++) {
+        z.polygon[i].x += 0.5f;
+        z.polygon[i].y += 0.5f;
+    }
+    TEST_ASSERT_EQUAL_INT(0, save_detection_zones("cam_cache", &z, 1));
+    TEST_ASSERT_TRUE(get_detection_zones_generation() > gen);
+
+    r = make_result_1det("car", 0.7f, 0.7f, 0.1f, 0.1f, 0.9f);
+    filter_detections_by_zones("cam_cache", &r);
+    TEST_ASSERT_EQUAL_INT(1, r.count);
+    TEST_ASSERT_EQUAL_STRING("zone-test-1", r.detections[0].zone_id);
+}
+
+void test_cache_rebuilt_after_zone_disabled(void) {
+    ensure_stream("cam_toggle");
+    detection_zone_t z = make_square_zone("cam_toggle", "zone9", true, NULL, 0.0f);
+    safe_strcpy(z.id, "zone-toggle", sizeof(z.id), 0);
+    save_detection_zones("cam_toggle", &z, 1);
+
+    detection_result_t r = make_result_1det("dog", 0.7f, 0.7f, 0.1f, 0.1f, 0.9f);
+    filter_detections_by_zones("cam_toggle", &r);
+    TEST_ASSERT_EQUAL_INT(0, r.count);
+
+    /* With its only zone disabled the stream is unfiltered again */
+    TEST_ASSERT_EQUAL_INT(0, update_zone_enabled("zone-toggle", false));
+    r = make_result_1det("dog", 0.7f, 0.7f, 0.1f, 0.1f, 0.9f);
+    filter_detections_by_zones("cam_toggle", &r);
+    TEST_ASSERT_EQUAL_INT(1, r.count);
+
+    TEST_ASSERT_EQUAL_INT(0, update_zone_enabled("zone-toggle", true));
+    TEST_ASSERT_EQUAL_INT(0, delete_detection_zone("zone-toggle"));
+    r = make_result_1det("dog", 0.7f, 0.7f, 0.1f, 0.1f, 0.9f);
+    filter_detections_by_zones("cam_toggle", &r);
+    TEST_ASSERT_EQUAL_INT(1, r.count);
+}
+
+void test_first_matching_zone_sets_zone_id(void) {
+    ensure_stream("cam_multi");
+    detection_zone_t zones[2];
+    /* Zone A only takes people, zone B (same square) takes anything */
+    zones[0] = make_square_zone("cam_multi", "zoneA", true, "person", 0.0f);
+    safe_strcpy(zones[0].id, "zone-a", sizeof(zones[0].id), 0);
+    zones[1] = make_square_zone("cam_multi", "zoneB", true, NULL, 0.0f);
+    safe_strcpy(zones[1].id, "zone-b", sizeof(zones[1].id), 0);
+    save_detection_zones("cam_multi", zones, 2);
+
+    detection_result_t r = make_result_1det("person", 0.1f, 0.1f, 0.1f, 0.1f, 0.9f);
+    filter_detections_by_zones("cam_multi", &r);
+    TEST_ASSERT_EQUAL_INT(1, r.count);
+    TEST_ASSERT_EQUAL_STRING("zone-a", r.detections[0].zone_id);
+
+    r = make_result_1det("car", 0.1f, 0.1f, 0.1f, 0.1f, 0.9f);
+    filter_detections_by_zones("cam_multi", &r);
+    TEST_ASSERT_EQUAL_INT(1, r.count);
+    TEST_ASSERT_EQUAL_STRING("zone-b", r.detections[0].zone_id);
+}
+
+void test_motion_zone_mask_matches_zone(void) {
+    ensure_stream("cam_mask");
+    detection_zone_t z = make_square_zone("cam_mask", "zone10", true, NULL, 0.0f);
+    save_detection_zones("cam_mask", &z, 1);
+
+    bool mask[4 * 4];
+    TEST_ASSERT_EQUAL_INT(1, build_motion_zone_mask("cam_mask", 4, mask));
+    for (int gy = 0; gy < 4; gy++) {
+        for (int gx = 0; gx < 4; gx++) {
+            TEST_ASSERT_EQUAL(gx < 2 && gy < 2, mask[gy * 4 + gx]);
+        }
+    }
+}
+
+void test_zone_bounding_boxes(void) {
+    ensure_stream("cam_bbox");
+    detection_result_t boxes;
+    TEST_ASSERT_EQUAL_INT(0, get_zone_bounding_boxes("cam_bbox", &boxes));
+
+    detection_zone_t z = make_square_zone("cam_bbox", "zone11", true, NULL, 0.0f);
+    save_detection_zones("cam_bbox", &z, 1);
+    TEST_ASSERT_EQUAL_INT(1, get_zone_bounding_boxes("cam_bbox", &boxes));
+    TEST_ASSERT_EQUAL_STRING("zone-test-1", boxes.detections[0].zone_id);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, boxes.detections[0].x);
+    TEST_ASSERT_EQUAL_FLOAT(0.5f, boxes.detections[0].width);
+    TEST_ASSERT_EQUAL_FLOAT(0.5f, boxes.detections[0].height);
+}
+
 /* ================================================================
  * filter_detections_by_stream_objects — no filter configured
  * ================================================================ */
@@ -320,6 +425,11 @@ int main(void) {
     RUN_TEST(test_class_filter_rejects_wrong_class);
     RUN_TEST(test_confidence_filter_rejects_low_confidence);
     RUN_TEST(test_confidence_filter_passes_sufficient_confidence);
+    RUN_TEST(test_cache_rebuilt_after_zones_saved);
+    RUN_TEST(test_cache_rebuilt_after_zone_disabled);
+    RUN_TEST(test_first_matching_zone_sets_zone_id);
+    RUN_TEST(test_motion_zone_mask_matches_zone);
+    RUN_TEST(test_zone_bounding_boxes);
     RUN_TEST(test_stream_object_filter_none_allows_all);
     RUN_TEST(test_stream_object_include_keeps_matching_label);
     RUN_TEST(test_stream_object_include_drops_unmatched_label);